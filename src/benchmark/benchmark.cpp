@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "benchmark.hpp"
+#include "../lattice/D3Q19.hpp"
+#include "../lattice/D3Q27.hpp"
+
+
+/**\fn        BenchmarkHints
+ * \brief     Benchmark a vectorised collision kernel with all memory access hints: regular and
+ *            non-temporal stores, each without and with software prefetching
+ *
+ * \tparam    K             the collision kernel
+ * \tparam    NX            simulation domain resolution in x-direction
+ * \tparam    NY            simulation domain resolution in y-direction
+ * \tparam    NZ            simulation domain resolution in z-direction
+ * \tparam    LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP            streaming policy of the populations
+ * \tparam    LY            memory layout policy of the populations
+ * \param[in] file          the file the results should be written to
+ * \param[in] threads       numbers of threads (ascending, starting with a single thread, empty = verify only)
+ * \param[in] roofline      STREAM triad bandwidth for each number of threads in GiB/s
+ * \param[in] steps         number of time steps that are timed per repetition
+ * \param[in] repetitions   number of repetitions of the timed time steps
+ * \param[in] isJson        write JSON instead of comma-separated values (Boolean true/false)
+ * \return    number of kernels that failed the verification
+*/
+template <Kernel K, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class SP, class LY>
+unsigned int BenchmarkHints(FILE* const file, std::vector<int> const& threads, std::vector<double> const& roofline,
+                            unsigned int const steps, unsigned int const repetitions, bool const isJson)
+{
+    constexpr unsigned int PD = BENCH_PREFETCH_DISTANCE;
+    unsigned int failures = 0;
+
+    failures += BenchmarkSweep<K,NX,NY,NZ,LT,SP,LY,hint::Cached>               (file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<K,NX,NY,NZ,LT,SP,LY,hint::Streaming>            (file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<K,NX,NY,NZ,LT,SP,LY,hint::Prefetch<PD>>         (file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<K,NX,NY,NZ,LT,SP,LY,hint::StreamingPrefetch<PD>>(file, threads, roofline, steps, repetitions, isJson);
+
+    return failures;
+}
+
+/**\fn        BenchmarkStorage
+ * \brief     Benchmark a collision kernel with all storage policies of the populations that are reduced
+ *            in size: single precision and the deviation from the lattice weights in single and (if the
+ *            processor supports the conversion) half precision
+ *
+ * \tparam    K             the collision kernel
+ * \tparam    NX            simulation domain resolution in x-direction
+ * \tparam    NY            simulation domain resolution in y-direction
+ * \tparam    NZ            simulation domain resolution in z-direction
+ * \tparam    LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP            streaming policy of the populations
+ * \param[in] file          the file the results should be written to
+ * \param[in] threads       numbers of threads (ascending, starting with a single thread, empty = verify only)
+ * \param[in] roofline      STREAM triad bandwidth for each number of threads in GiB/s
+ * \param[in] steps         number of time steps that are timed per repetition
+ * \param[in] repetitions   number of repetitions of the timed time steps
+ * \param[in] isJson        write JSON instead of comma-separated values (Boolean true/false)
+ * \return    number of kernels that failed the verification
+*/
+template <Kernel K, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class SP>
+unsigned int BenchmarkStorage(FILE* const file, std::vector<int> const& threads, std::vector<double> const& roofline,
+                              unsigned int const steps, unsigned int const repetitions, bool const isJson)
+{
+    unsigned int failures = 0;
+
+    failures += BenchmarkSweep<K,NX,NY,NZ,LT,SP,layout::AoS,hint::Cached,storage::Single>   (file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<K,NX,NY,NZ,LT,SP,layout::AoS,hint::Cached,storage::Shifted<>>(file, threads, roofline, steps, repetitions, isJson);
+    #ifdef __F16C__
+        failures += BenchmarkSweep<K,NX,NY,NZ,LT,SP,layout::AoS,hint::Cached,storage::Half> (file, threads, roofline, steps, repetitions, isJson);
+    #endif
+
+    return failures;
+}
+
+/**\fn        BenchmarkLattice
+ * \brief     Benchmark all collision kernels for a given lattice, streaming policy and domain size
+ *
+ * \tparam    NX            simulation domain resolution in x-direction
+ * \tparam    NY            simulation domain resolution in y-direction
+ * \tparam    NZ            simulation domain resolution in z-direction
+ * \tparam    LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP            streaming policy of the populations
+ * \param[in] file          the file the results should be written to
+ * \param[in] threads       numbers of threads (ascending, starting with a single thread, empty = verify only)
+ * \param[in] roofline      STREAM triad bandwidth for each number of threads in GiB/s
+ * \param[in] steps         number of time steps that are timed per repetition
+ * \param[in] repetitions   number of repetitions of the timed time steps
+ * \param[in] isJson        write JSON instead of comma-separated values (Boolean true/false)
+ * \return    number of kernels that failed the verification
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class SP>
+unsigned int BenchmarkLattice(FILE* const file, std::vector<int> const& threads, std::vector<double> const& roofline,
+                              unsigned int const steps, unsigned int const repetitions, bool const isJson)
+{
+    unsigned int failures = 0;
+
+    failures += BenchmarkSweep<Kernel::BGK,            NX,NY,NZ,LT,SP>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::TRT,            NX,NY,NZ,LT,SP>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::BGK_Smagorinsky,NX,NY,NZ,LT,SP>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::Regularised,    NX,NY,NZ,LT,SP>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::Regularised_Smagorinsky,NX,NY,NZ,LT,SP>(file, threads, roofline, steps, repetitions, isJson);
+    failures += VerifySweeps<Kernel::BGK,                    LT,SP>();
+    failures += VerifySweeps<Kernel::TRT,                    LT,SP>();
+    failures += VerifySweeps<Kernel::BGK_Smagorinsky,        LT,SP>();
+    failures += VerifySweeps<Kernel::Regularised,            LT,SP>();
+    failures += VerifySweeps<Kernel::Regularised_Smagorinsky,LT,SP>();
+    failures += VerifyPassiveScalar<LT,SP>();
+    failures += VerifyEnsembleCases<LT,SP>();
+    failures += VerifyRestart<LT,SP>();
+    failures += VerifyRefinement<LT,SP>();
+
+    /// the generic solver with run-time strides only streams with the A-A pattern
+    if constexpr (std::is_same<SP,streaming::AA>::value == true)
+    {
+        failures += BenchmarkRuntime<NX,NY,NZ,LT>(file, threads, roofline, steps, repetitions, isJson);
+    }
+
+    failures += BenchmarkHints<Kernel::BGK_AVX2,       NX,NY,NZ,LT,SP,layout::AoS>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkStorage<Kernel::BGK,            NX,NY,NZ,LT,SP>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkStorage<Kernel::BGK_Smagorinsky,NX,NY,NZ,LT,SP>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkStorage<Kernel::BGK_AVX2,       NX,NY,NZ,LT,SP>(file, threads, roofline, steps, repetitions, isJson);
+
+    /// the AVX512 kernel requires a lattice padded to a multiple of eight populations
+    if constexpr (LT::ND % 8 == 0)
+    {
+        failures += BenchmarkHints<Kernel::BGK_AVX512, NX,NY,NZ,LT,SP,layout::AoS>(file, threads, roofline, steps, repetitions, isJson);
+    }
+
+    /// the cells of the structure-of-arrays layouts are not contiguous: no software prefetching
+    failures += BenchmarkSweep<Kernel::BGK_AVX2_SoA,   NX,NY,NZ,LT,SP,layout::SoA,     hint::Cached>   (file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::BGK_AVX2_SoA,   NX,NY,NZ,LT,SP,layout::SoA,     hint::Streaming>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::BGK_AVX2_SoA,   NX,NY,NZ,LT,SP,layout::AoSoA<4>,hint::Cached>   (file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::BGK_AVX2_SoA,   NX,NY,NZ,LT,SP,layout::AoSoA<4>,hint::Streaming>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::BGK_AVX512_SoA, NX,NY,NZ,LT,SP,layout::SoA,     hint::Cached>   (file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::BGK_AVX512_SoA, NX,NY,NZ,LT,SP,layout::SoA,     hint::Streaming>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::BGK_AVX512_SoA, NX,NY,NZ,LT,SP,layout::AoSoA<8>,hint::Cached>   (file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::BGK_AVX512_SoA, NX,NY,NZ,LT,SP,layout::AoSoA<8>,hint::Streaming>(file, threads, roofline, steps, repetitions, isJson);
+
+    return failures;
+}
+
+/**\fn        BenchmarkDomain
+ * \brief     Benchmark all collision kernels on both lattices with the A-A pattern and the esoteric
+ *            pull and the regularised kernel of the lattices stored in moment space in double and single
+ *            precision for a given domain size
+ *
+ * \tparam    NX            simulation domain resolution in x-direction
+ * \tparam    NY            simulation domain resolution in y-direction
+ * \tparam    NZ            simulation domain resolution in z-direction
+ * \param[in] file          the file the results should be written to
+ * \param[in] threads       numbers of threads (ascending, starting with a single thread, empty = verify only)
+ * \param[in] roofline      STREAM triad bandwidth for each number of threads in GiB/s
+ * \param[in] steps         number of time steps that are timed per repetition
+ * \param[in] repetitions   number of repetitions of the timed time steps
+ * \param[in] isJson        write JSON instead of comma-separated values (Boolean true/false)
+ * \return    number of kernels that failed the verification
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+unsigned int BenchmarkDomain(FILE* const file, std::vector<int> const& threads, std::vector<double> const& roofline,
+                             unsigned int const steps, unsigned int const repetitions, bool const isJson)
+{
+    typedef lattice::D3Q19<double> D3Q19;
+    typedef lattice::D3Q27<double> D3Q27;
+    unsigned int failures = 0;
+
+    failures += VerifyLattice<D3Q19>();
+    failures += VerifyLattice<D3Q27>();
+
+    failures += BenchmarkLattice<NX,NY,NZ,D3Q19,streaming::AA>          (file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkLattice<NX,NY,NZ,D3Q19,streaming::EsotericPull>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::Regularised_Moments,NX,NY,NZ,D3Q19,streaming::AA,layout::AoS,hint::Cached,storage::Native>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::Regularised_Moments,NX,NY,NZ,D3Q19,streaming::AA,layout::AoS,hint::Cached,storage::Single>(file, threads, roofline, steps, repetitions, isJson);
+
+    failures += BenchmarkLattice<NX,NY,NZ,D3Q27,streaming::AA>          (file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkLattice<NX,NY,NZ,D3Q27,streaming::EsotericPull>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::Regularised_Moments,NX,NY,NZ,D3Q27,streaming::AA,layout::AoS,hint::Cached,storage::Native>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkSweep<Kernel::Regularised_Moments,NX,NY,NZ,D3Q27,streaming::AA,layout::AoS,hint::Cached,storage::Single>(file, threads, roofline, steps, repetitions, isJson);
+
+    return failures;
+}
+
+int main(int argc, char** argv)
+{
+    /// benchmark settings -------------------------------------------------------------------------
+    std::string  fileName    = "benchmark.csv";
+    bool         isJson      = false;
+    bool         isAppend    = false;
+    bool         isVerify    = false;
+    unsigned int steps       = 20;
+    unsigned int repetitions = 1;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+        {
+            fileName = argv[++i];
+        }
+        else if ((strcmp(argv[i], "--steps") == 0) && (i + 1 < argc))
+        {
+            steps = static_cast<unsigned int>(std::stoul(argv[++i]));
+        }
+        else if ((strcmp(argv[i], "--repetitions") == 0) && (i + 1 < argc))
+        {
+            repetitions = std::max(static_cast<unsigned int>(std::stoul(argv[++i])), 1u);
+        }
+        else if (strcmp(argv[i], "--verify") == 0)
+        {
+            isVerify = true;
+        }
+        else if (strcmp(argv[i], "--json") == 0)
+        {
+            isJson = true;
+        }
+        else if (strcmp(argv[i], "--append") == 0)
+        {
+            isAppend = true;
+        }
+        else
+        {
+            std::cerr << "Usage: '--output'      <file> Write results to file (default = benchmark.csv)"       << std::endl;
+            std::cerr << "       '--steps'       <n>    Number of timed time steps per repetition (default = 20)" << std::endl;
+            std::cerr << "       '--repetitions' <n>    Number of timed repetitions per case (default = 1)"      << std::endl;
+            std::cerr << "       '--verify'             Only verify the kernels against the reference kernel"    << std::endl;
+            std::cerr << "       '--json'               Write JSON objects instead of comma-separated values"    << std::endl;
+            std::cerr << "       '--append'             Append to an existing file (without header)"             << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    /// verification only: the kernels are verified on a small domain independent of the domain size
+    if (isVerify == true)
+    {
+        unsigned int const failures = BenchmarkDomain<VERIFY_NX,VERIFY_NY,VERIFY_NZ>(stdout, {}, {}, steps, repetitions, isJson);
+        if (failures > 0)
+        {
+            std::cerr << "Fatal error: " << failures << " kernel(s) failed the verification." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        std::cerr << "All kernels passed the verification." << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    FILE* const file = fopen(fileName.c_str(), (isAppend == true) ? "a" : "w");
+    if (file == nullptr)
+    {
+        std::cerr << "Fatal error: Could not open '" << fileName << "'." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if ((isJson == false) && (isAppend == false))
+    {
+        BenchmarkHeader(file);
+    }
+
+    /// numbers of threads: powers of two and all processors ---------------------------------------
+    std::vector<int> threads;
+    int const threadsMax = omp_get_num_procs();
+    for(int t = 1; t < threadsMax; t *= 2)
+    {
+        threads.push_back(t);
+    }
+    threads.push_back(threadsMax);
+
+    std::vector<double> roofline;
+    for(int const t: threads)
+    {
+        roofline.push_back(StreamTriad(t));
+    }
+
+    /// domain sizes -------------------------------------------------------------------------------
+    unsigned int failures = 0;
+    failures += BenchmarkDomain< 64, 64, 64>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkDomain<128,128,128>(file, threads, roofline, steps, repetitions, isJson);
+    failures += BenchmarkDomain<192, 96, 96>(file, threads, roofline, steps, repetitions, isJson);
+
+    fclose(file);
+
+    if (failures > 0)
+    {
+        std::cerr << "Fatal error: " << failures << " kernel variant(s) failed the verification and were not timed." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
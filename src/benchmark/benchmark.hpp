@@ -0,0 +1,631 @@
+#ifndef BENCHMARK_HPP_INCLUDED
+#define BENCHMARK_HPP_INCLUDED
+
+/**
+ * \file     benchmark.hpp
+ * \mainpage Benchmark harness for the collision kernels
+ *
+ * \note     Every collision kernel is timed on its own (without boundaries and export) for different
+ *           lattices, domain sizes and numbers of threads. The speed is reported in million lattice
+ *           updates per second (Mlups) together with the achieved bandwidth of the in-place streaming
+ *           (every population is read and written once per update) in relation to a STREAM-style triad
+ *           roofline measured with the same number of threads, and the parallel efficiency with
+ *           respect to a single thread. The loop block size is a compile-time constant and is swept by
+ *           compiling the harness several times ('make bench'). Every kernel is run with the A-A
+ *           pattern and the esoteric pull so that the faster streaming policy can be chosen per machine.
+ *           The vectorised kernels are additionally run with non-temporal stores and software
+ *           prefetching (see memory_hints.hpp, prefetch distance BENCH_PREFETCH_DISTANCE) and the
+ *           kernel vectorised across cells with the structure-of-arrays layouts so that the layout, the
+ *           block size and the memory hints can be chosen together. The regularised kernel of the
+ *           lattices stored in moment space (see moments.hpp) is run once per lattice in double and
+ *           single precision, its bandwidth is given by the ten moments read and written per update.
+ *           Every kernel variant is verified against the scalar BGK kernel before it is timed (see
+ *           verification.hpp) and every case is timed for a number of repetitions: the median runtime is
+ *           reported together with the coefficient of variation of the repetitions. The BGK kernel with
+ *           run-time strides that the solver falls back to for domains that are not registered is timed
+ *           next to the compiled BGK kernel on the same domain.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+#include <string>
+#include <sys/stat.h>
+#include <type_traits>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../continuum/continuum.hpp"
+#include "../continuum/continuum_runtime.hpp"
+#include "../continuum/initialisation.hpp"
+#include "../general/memory_alignment.hpp"
+#include "../general/paths.hpp"
+#include "../general/timer.hpp"
+#include "../lattice/lattice_unit_test.hpp"
+#include "../population/collision/collision_bgk_runtime.hpp"
+#include "../population/initialisation.hpp"
+#include "../population/population_runtime.hpp"
+#include "kernels.hpp"
+#include "verification.hpp"
+
+
+/// prefetch distance in cells of the kernels with software prefetching
+#ifndef BENCH_PREFETCH_DISTANCE
+    #define BENCH_PREFETCH_DISTANCE 8
+#endif
+
+
+/**\struct benchmarkResult
+ * \brief  Result of a single benchmark case
+*/
+struct benchmarkResult
+{
+    std::string  kernel;
+    std::string  streaming;
+    std::string  layout;
+    std::string  precision;  ///< floating data type the populations or moments are stored in
+    std::string  stores;     ///< regular ("cached") or non-temporal stores
+    unsigned int prefetch;   ///< software prefetch distance in cells (0 = none)
+    unsigned int speeds;
+    unsigned int nx, ny, nz;
+    unsigned int blockSize;
+    int          threads;
+    unsigned int steps;
+    unsigned int repetitions; ///< number of timed repetitions
+    double       runtime;    ///< median runtime of the repetitions in seconds
+    double       variation;  ///< coefficient of variation of the runtime of the repetitions
+    double       mlups;      ///< million lattice updates per second
+    double       bandwidth;  ///< achieved bandwidth in GiB/s
+    double       roofline;   ///< STREAM triad bandwidth with the same number of threads in GiB/s
+    double       efficiency; ///< parallel efficiency with respect to a single thread
+};
+
+
+/**\fn        StreamTriad
+ * \brief     STREAM-style triad a = b + s*c as roofline of the memory bandwidth
+ *
+ * \param[in] threads   number of threads
+ * \param[in] length    number of values per array (should exceed the last-level caches)
+ * \param[in] repeat    number of repetitions (the fastest one is reported)
+ * \return    bandwidth in GiB/s (three arrays of doubles per iteration)
+*/
+inline double StreamTriad(int const threads, size_t const length = size_t(1) << 24, unsigned int const repeat = 5)
+{
+    constexpr double bytesPerGiB = 1024.0 * 1024.0 * 1024.0;
+
+    double* const a = static_cast<double*>(AllocateAligned(length*sizeof(double)));
+    double* const b = static_cast<double*>(AllocateAligned(length*sizeof(double)));
+    double* const c = static_cast<double*>(AllocateAligned(length*sizeof(double)));
+
+    if ((a == nullptr) || (b == nullptr) || (c == nullptr))
+    {
+        std::cerr << "Fatal error: Benchmark arrays could not be allocated." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    #pragma omp parallel for default(none) firstprivate(a, b, c, length) schedule(static) num_threads(threads)
+    for(size_t i = 0; i < length; ++i)
+    {
+        a[i] = 0.0;
+        b[i] = 1.0;
+        c[i] = 2.0;
+    }
+
+    double fastest = 1e30;
+    for(unsigned int r = 0; r < repeat; ++r)
+    {
+        Timer Stopwatch;
+        Stopwatch.Start();
+
+        #pragma omp parallel for default(none) firstprivate(a, b, c, length) schedule(static) num_threads(threads)
+        for(size_t i = 0; i < length; ++i)
+        {
+            a[i] = b[i] + 3.0*c[i];
+        }
+
+        fastest = std::min(fastest, Stopwatch.Stop());
+    }
+
+    FreeAligned(a);
+    FreeAligned(b);
+    FreeAligned(c);
+
+    return 3.0*length*sizeof(double)/(fastest*bytesPerGiB);
+}
+
+/**\fn        KernelDescription
+ * \brief     Benchmark result describing a kernel variant (names of the kernel, policies and hints)
+ *
+ * \tparam    K    the collision kernel
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP   streaming policy of the populations
+ * \tparam    LY   memory layout policy of the populations
+ * \tparam    MH   memory access hints of the vectorised kernels (hint::MemoryHints)
+ * \tparam    ST   storage policy of the populations or moments
+ * \tparam    S    floating data type the populations or moments are stored in
+ * \return    result with the description of the kernel variant (all measured values are zero)
+*/
+template <Kernel K, class LT, class SP, class LY, class MH, class ST, typename S>
+benchmarkResult KernelDescription()
+{
+    constexpr bool isMoments = (K == Kernel::Regularised_Moments);
+
+    benchmarkResult result = {};
+    result.kernel     = KernelName(K);
+    result.streaming  = (isMoments == true) ? "pull"    : SP::NAME;
+    result.layout     = (isMoments == true) ? "moments" : LY::NAME;
+    result.precision  = StorageName<ST,S>();
+    result.stores     = (MH::STREAM == true) ? "non-temporal" : "cached";
+    result.prefetch   = MH::PREFETCH;
+    result.speeds     = LT::SPEEDS;
+    result.blockSize  = LOOP_BLOCK_SIZE;
+    result.efficiency = 1.0;
+
+    return result;
+}
+
+/**\fn        RuntimeStatistics
+ * \brief     Median and coefficient of variation of the runtimes of the repetitions of a benchmark case
+ *
+ * \param[in]  runtimes    runtimes of the repetitions in seconds (at least one)
+ * \param[out] median      median runtime in seconds
+ * \param[out] variation   coefficient of variation of the runtimes
+*/
+inline void RuntimeStatistics(std::vector<double> const& runtimes, double& median, double& variation)
+{
+    std::vector<double> sorted(runtimes);
+    std::sort(sorted.begin(), sorted.end());
+    size_t const n = sorted.size();
+    median = (n % 2 == 1) ? sorted[n/2] : 0.5*(sorted[n/2 - 1] + sorted[n/2]);
+
+    double mean = 0.0;
+    for(double const r: runtimes)
+    {
+        mean += r/n;
+    }
+    double variance = 0.0;
+    for(double const r: runtimes)
+    {
+        variance += (r - mean)*(r - mean)/n;
+    }
+    variation = std::sqrt(variance)/mean;
+}
+
+/**\fn        BenchmarkKernel
+ * \brief     Time a collision kernel for a given lattice and domain size. The time steps are timed for a
+ *            number of repetitions and the median runtime is reported together with the coefficient of
+ *            variation of the repetitions.
+ *
+ * \tparam    K             the collision kernel
+ * \tparam    NX            simulation domain resolution in x-direction
+ * \tparam    NY            simulation domain resolution in y-direction
+ * \tparam    NZ            simulation domain resolution in z-direction
+ * \tparam    LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP            streaming policy of the populations
+ * \tparam    LY            memory layout policy of the populations
+ * \tparam    MH            memory access hints of the vectorised kernels (hint::MemoryHints)
+ * \tparam    ST            storage policy of the populations or moments
+ * \param[in] threads       number of threads
+ * \param[in] steps         number of time steps that are timed per repetition (rounded up to an even number)
+ * \param[in] repetitions   number of repetitions (default = 1)
+ * \return    result of the benchmark (without roofline and efficiency)
+*/
+template <Kernel K, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class SP, class LY, class MH, class ST>
+benchmarkResult BenchmarkKernel(int const threads, unsigned int const steps, unsigned int const repetitions = 1)
+{
+    constexpr double bytesPerGiB = 1024.0 * 1024.0 * 1024.0;
+    typedef KernelPopulation<K,NX,NY,NZ,LT,SP,LY,ST> POP;
+    typedef typename POP::T T;
+    typedef typename POP::S S;
+
+    omp_set_num_threads(threads);
+
+    Continuum<NX,NY,NZ,T> con;
+    typename POP::type pop(1000.0, 0.05, NY/5);
+    InitContinuum(con, 1.0, 0.05, 0.0, 0.0);
+    InitLattice<false>(con, pop);
+
+    /// warm up
+    CollideStream<K,false,MH>(con, pop);
+    CollideStream<K,true,MH>(con, pop);
+
+    unsigned int const NT = 2*((steps + 1)/2);
+    std::vector<double> runtimes(std::max(repetitions, 1u));
+    for(double& runtime: runtimes)
+    {
+        Timer Stopwatch;
+        Stopwatch.Start();
+        for(unsigned int i = 0; i < NT; i += 2)
+        {
+            CollideStream<K,false,MH>(con, pop);
+            CollideStream<K,true,MH>(con, pop);
+        }
+        runtime = Stopwatch.Stop();
+    }
+
+    double runtime   = 0.0;
+    double variation = 0.0;
+    RuntimeStatistics(runtimes, runtime, variation);
+
+    double const updates = static_cast<double>(NT)*NX*NY*NZ;
+
+    benchmarkResult result = KernelDescription<K,LT,SP,LY,MH,ST,S>();
+    result.nx          = NX;
+    result.ny          = NY;
+    result.nz          = NZ;
+    result.threads     = threads;
+    result.steps       = NT;
+    result.repetitions = static_cast<unsigned int>(runtimes.size());
+    result.runtime     = runtime;
+    result.variation   = variation;
+    result.mlups       = 1e-6*updates/runtime;
+    result.bandwidth   = updates*2*POP::VALUES*sizeof(S)/(runtime*bytesPerGiB);
+    result.roofline    = 0.0;
+    result.efficiency  = 1.0;
+
+    return result;
+}
+
+/**\fn        BenchmarkOutput
+ * \brief     Write the result of a benchmark case as a line of comma-separated values or as a JSON
+ *            object (one object per line)
+ *
+ * \param[in] file     the file the result should be written to
+ * \param[in] result   result of the benchmark case
+ * \param[in] isJson   write JSON instead of comma-separated values (Boolean true/false)
+*/
+inline void BenchmarkOutput(FILE* const file, benchmarkResult const& result, bool const isJson)
+{
+    if (isJson == true)
+    {
+        fprintf(file, "{\"kernel\": \"%s\", \"streaming\": \"%s\", \"layout\": \"%s\", \"precision\": \"%s\", \"stores\": \"%s\", \"prefetch\": %u, \"lattice\": \"D3Q%u\", \"nx\": %u, \"ny\": %u, \"nz\": %u, \"block_size\": %u, "
+                      "\"threads\": %i, \"steps\": %u, \"runtime_s\": %.6f, \"mlups\": %.3f, \"bandwidth_gib_s\": %.3f, "
+                      "\"roofline_gib_s\": %.3f, \"roofline_fraction\": %.3f, \"parallel_efficiency\": %.3f, \"repetitions\": %u, \"runtime_cv\": %.4f}\n",
+                result.kernel.c_str(), result.streaming.c_str(), result.layout.c_str(), result.precision.c_str(), result.stores.c_str(),
+                result.prefetch, result.speeds, result.nx, result.ny, result.nz, result.blockSize,
+                result.threads, result.steps, result.runtime, result.mlups, result.bandwidth,
+                result.roofline, result.bandwidth/result.roofline, result.efficiency, result.repetitions, result.variation);
+    }
+    else
+    {
+        fprintf(file, "%s,%s,%s,%s,%s,%u,D3Q%u,%u,%u,%u,%u,%i,%u,%.6f,%.3f,%.3f,%.3f,%.3f,%.3f,%u,%.4f\n",
+                result.kernel.c_str(), result.streaming.c_str(), result.layout.c_str(), result.precision.c_str(), result.stores.c_str(),
+                result.prefetch, result.speeds, result.nx, result.ny, result.nz, result.blockSize,
+                result.threads, result.steps, result.runtime, result.mlups, result.bandwidth,
+                result.roofline, result.bandwidth/result.roofline, result.efficiency, result.repetitions, result.variation);
+    }
+    fflush(file);
+}
+
+/**\fn        BenchmarkHeader
+ * \brief     Write the header of the comma-separated values
+ *
+ * \param[in] file     the file the header should be written to
+*/
+inline void BenchmarkHeader(FILE* const file)
+{
+    fprintf(file, "kernel,streaming,layout,precision,stores,prefetch,lattice,nx,ny,nz,block_size,threads,steps,runtime_s,mlups,bandwidth_gib_s,"
+                  "roofline_gib_s,roofline_fraction,parallel_efficiency,repetitions,runtime_cv\n");
+}
+
+/**\fn        BenchmarkSweep
+ * \brief     Verify a collision kernel (see verification.hpp) and benchmark it for a given lattice and
+ *            domain size for all numbers of threads. Kernels that fail the verification are not timed.
+ *
+ * \tparam    K             the collision kernel
+ * \tparam    NX            simulation domain resolution in x-direction
+ * \tparam    NY            simulation domain resolution in y-direction
+ * \tparam    NZ            simulation domain resolution in z-direction
+ * \tparam    LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP            streaming policy of the populations (default = AA)
+ * \tparam    LY            memory layout policy of the populations (default = AoS)
+ * \tparam    MH            memory access hints of the vectorised kernels (default = hint::Cached)
+ * \tparam    ST            storage policy of the populations or moments (default = storage::Native)
+ * \param[in] file          the file the results should be written to
+ * \param[in] threads       numbers of threads (ascending, starting with a single thread, empty = verify only)
+ * \param[in] roofline      STREAM triad bandwidth for each number of threads in GiB/s
+ * \param[in] steps         number of time steps that are timed per repetition
+ * \param[in] repetitions   number of repetitions of the timed time steps
+ * \param[in] isJson        write JSON instead of comma-separated values (Boolean true/false)
+ * \return    number of kernels that failed the verification (0 or 1)
+*/
+template <Kernel K, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class SP = streaming::AA, class LY = layout::AoS, class MH = hint::Cached,
+          class ST = storage::Native>
+unsigned int BenchmarkSweep(FILE* const file, std::vector<int> const& threads, std::vector<double> const& roofline,
+                            unsigned int const steps, unsigned int const repetitions, bool const isJson)
+{
+    if (IsKernelAvailable(K) == false)
+    {
+        return 0;
+    }
+
+    verificationResult const check = VerifyKernel<K,LT,SP,LY,MH,ST>();
+    benchmarkResult const description = KernelDescription<K,LT,SP,LY,MH,ST,typename KernelPopulation<K,NX,NY,NZ,LT,SP,LY,ST>::S>();
+    fprintf(stderr, "%19s %13s %7s %14s %12s prefetch %2u D3Q%u verification %s: deviation %8.2e%s, mass %8.2e, momentum %8.2e\n",
+            description.kernel.c_str(), description.streaming.c_str(), description.layout.c_str(), description.precision.c_str(),
+            description.stores.c_str(), description.prefetch, description.speeds, (check.isPassed == true) ? "passed" : "FAILED",
+            check.deviation, (check.isBitwise == true) ? " (bitwise)" : "", check.mass, check.momentum);
+
+    if (check.isPassed == false)
+    {
+        return 1;
+    }
+
+    double serial = 0.0;
+    for(size_t t = 0; t < threads.size(); ++t)
+    {
+        benchmarkResult result = BenchmarkKernel<K,NX,NY,NZ,LT,SP,LY,MH,ST>(threads[t], steps, repetitions);
+        serial = (t == 0) ? result.mlups : serial;
+
+        result.roofline   = roofline[t];
+        result.efficiency = result.mlups/(serial*threads[t]);
+        BenchmarkOutput(file, result, isJson);
+
+        fprintf(stderr, "%19s %13s %7s %14s %12s prefetch %2u D3Q%u %4ux%4ux%4u block %3u threads %3i: %9.2f Mlups (cv %5.1f%%)\n", result.kernel.c_str(),
+                result.streaming.c_str(), result.layout.c_str(), result.precision.c_str(), result.stores.c_str(), result.prefetch, result.speeds, NX, NY, NZ,
+                result.blockSize, result.threads, result.mlups, 100.0*result.variation);
+    }
+
+    return 0;
+}
+
+/**\fn        BenchmarkRuntimeKernel
+ * \brief     Time the BGK operator with run-time strides (see population_runtime.hpp) for a given lattice and
+ *            domain size, same warm up, repetitions and statistics as BenchmarkKernel
+ *
+ * \tparam    LT            static lattice::DdQq class containing discretisation parameters
+ * \param[in] NX            simulation domain resolution in x-direction
+ * \param[in] NY            simulation domain resolution in y-direction
+ * \param[in] NZ            simulation domain resolution in z-direction
+ * \param[in] threads       number of threads
+ * \param[in] steps         number of time steps that are timed per repetition (rounded up to an even number)
+ * \param[in] repetitions   number of repetitions (default = 1)
+ * \return    result of the benchmark (without roofline and efficiency)
+*/
+template <class LT>
+benchmarkResult BenchmarkRuntimeKernel(unsigned int const NX, unsigned int const NY, unsigned int const NZ,
+                                       int const threads, unsigned int const steps, unsigned int const repetitions = 1)
+{
+    constexpr double bytesPerGiB = 1024.0 * 1024.0 * 1024.0;
+    typedef typename RuntimePopulation<LT>::T T;
+
+    omp_set_num_threads(threads);
+
+    RuntimeContinuum<T> con(NX, NY, NZ);
+    RuntimePopulation<LT> pop(NX, NY, NZ, 1000.0, 0.05, NY/5);
+    InitContinuum(con, static_cast<T>(1.0), static_cast<T>(0.05), static_cast<T>(0.0), static_cast<T>(0.0));
+    InitLattice<false>(con, pop);
+
+    /// warm up
+    CollideStreamBGK<false>(con, pop);
+    CollideStreamBGK<true>(con, pop);
+
+    unsigned int const NT = 2*((steps + 1)/2);
+    std::vector<double> runtimes(std::max(repetitions, 1u));
+    for(double& runtime: runtimes)
+    {
+        Timer Stopwatch;
+        Stopwatch.Start();
+        for(unsigned int i = 0; i < NT; i += 2)
+        {
+            CollideStreamBGK<false>(con, pop);
+            CollideStreamBGK<true>(con, pop);
+        }
+        runtime = Stopwatch.Stop();
+    }
+
+    double runtime   = 0.0;
+    double variation = 0.0;
+    RuntimeStatistics(runtimes, runtime, variation);
+
+    double const updates = static_cast<double>(NT)*NX*NY*NZ;
+
+    benchmarkResult result = KernelDescription<Kernel::BGK,LT,streaming::AA,layout::AoS,hint::Cached,storage::Native,T>();
+    result.kernel      = "BGK_Runtime";
+    result.nx          = NX;
+    result.ny          = NY;
+    result.nz          = NZ;
+    result.threads     = threads;
+    result.steps       = NT;
+    result.repetitions = static_cast<unsigned int>(runtimes.size());
+    result.runtime     = runtime;
+    result.variation   = variation;
+    result.mlups       = 1e-6*updates/runtime;
+    result.bandwidth   = updates*2*LT::SPEEDS*sizeof(T)/(runtime*bytesPerGiB);
+    result.roofline    = 0.0;
+    result.efficiency  = 1.0;
+
+    return result;
+}
+
+/**\fn        BenchmarkRuntime
+ * \brief     Verify the BGK operator with run-time strides against the compiled BGK kernel (see VerifyRuntime)
+ *            and time both on the same domain for all numbers of threads: the ratio is the cost of falling back
+ *            to the generic solver for a domain that is not registered. Only the A-A pattern is available.
+ *
+ * \tparam    NX            simulation domain resolution in x-direction
+ * \tparam    NY            simulation domain resolution in y-direction
+ * \tparam    NZ            simulation domain resolution in z-direction
+ * \tparam    LT            static lattice::DdQq class containing discretisation parameters
+ * \param[in] file          the file the results should be written to
+ * \param[in] threads       numbers of threads (ascending, starting with a single thread, empty = verify only)
+ * \param[in] roofline      STREAM triad bandwidth for each number of threads in GiB/s
+ * \param[in] steps         number of time steps that are timed per repetition
+ * \param[in] repetitions   number of repetitions of the timed time steps
+ * \param[in] isJson        write JSON instead of comma-separated values (Boolean true/false)
+ * \return    number of kernels that failed the verification (0 or 1)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+unsigned int BenchmarkRuntime(FILE* const file, std::vector<int> const& threads, std::vector<double> const& roofline,
+                              unsigned int const steps, unsigned int const repetitions, bool const isJson)
+{
+    verificationResult const check = VerifyRuntime<LT>();
+    fprintf(stderr, "%19s %13s %7s D3Q%u verification %s: deviation %8.2e%s, mass %8.2e, momentum %8.2e\n", "BGK_Runtime",
+            streaming::AA::NAME, layout::AoS::NAME, LT::SPEEDS, (check.isPassed == true) ? "passed" : "FAILED",
+            check.deviation, (check.isBitwise == true) ? " (bitwise)" : "", check.mass, check.momentum);
+
+    if (check.isPassed == false)
+    {
+        return 1;
+    }
+
+    double serial = 0.0;
+    for(size_t t = 0; t < threads.size(); ++t)
+    {
+        benchmarkResult const compiled = BenchmarkKernel<Kernel::BGK,NX,NY,NZ,LT,streaming::AA,layout::AoS,hint::Cached,storage::Native>(threads[t], steps, repetitions);
+        benchmarkResult result = BenchmarkRuntimeKernel<LT>(NX, NY, NZ, threads[t], steps, repetitions);
+        serial = (t == 0) ? result.mlups : serial;
+
+        result.roofline   = roofline[t];
+        result.efficiency = result.mlups/(serial*threads[t]);
+        BenchmarkOutput(file, result, isJson);
+
+        fprintf(stderr, "%19s %13s %7s D3Q%u %4ux%4ux%4u block %3u threads %3i: %9.2f Mlups (cv %5.1f%%), compiled %9.2f Mlups (%5.1f%%)\n",
+                result.kernel.c_str(), result.streaming.c_str(), result.layout.c_str(), result.speeds, NX, NY, NZ, result.blockSize,
+                result.threads, result.mlups, 100.0*result.variation, compiled.mlups, 100.0*result.mlups/compiled.mlups);
+    }
+
+    return 0;
+}
+
+/**\fn        VerifySweeps
+ * \brief     Verify the sweeps of a scalar collision operator with fused boundaries (fluid cell list,
+ *            work-stealing scheduler, wavefront and pipeline) against the sweep over the full domain followed
+ *            by separate boundaries (see VerifySweep). The sweeps are not timed.
+ *
+ * \tparam    K    the collision kernel (scalar operator)
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP   streaming policy of the populations
+ * \return    number of sweeps that failed the verification
+*/
+template <Kernel K, class LT, class SP>
+unsigned int VerifySweeps()
+{
+    unsigned int failures = 0;
+
+    auto const report = [&failures](Sweep const sweep, verificationResult const& check)
+    {
+        fprintf(stderr, "%19s %13s %11s sweep D3Q%u verification %s: deviation %8.2e%s\n", KernelName(K),
+                SP::NAME, SweepName(sweep), LT::SPEEDS,
+                (check.isPassed == true) ? "passed" : "FAILED", check.deviation, (check.isBitwise == true) ? " (bitwise)" : "");
+        failures += (check.isPassed == true) ? 0 : 1;
+    };
+    report(Sweep::FluidCells, VerifySweep<K,Sweep::FluidCells,LT,SP>());
+    report(Sweep::Scheduler,  VerifySweep<K,Sweep::Scheduler, LT,SP>());
+    report(Sweep::Wavefront,  VerifySweep<K,Sweep::Wavefront, LT,SP>());
+    report(Sweep::Pipeline,   VerifySweep<K,Sweep::Pipeline,  LT,SP>());
+
+    return failures;
+}
+
+/**\fn        VerifyPassiveScalar
+ * \brief     Verify the fluid cell sweep coupled with a passive scalar: the flow has to be bitwise identical
+ *            to the BGK operator, the walls have to conserve the scalar and the flow and the scalar have to be
+ *            exported to their own files (see VerifyScalar). The export is skipped if the directory of the
+ *            *.vtk-files does not exist.
+ *
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP   streaming policy of the populations
+ * \return    number of failed verifications (0 or 1)
+*/
+template <class LT, class SP>
+unsigned int VerifyPassiveScalar()
+{
+    struct stat info;
+    bool const isExport = (stat(OUTPUT_VTK_PATH.c_str(), &info) == 0) && (S_ISDIR(info.st_mode) == true);
+
+    verificationResult const check = VerifyScalar<LT,SP>(isExport);
+    fprintf(stderr, "%19s %13s %11s sweep D3Q%u verification %s: deviation %8.2e%s, scalar mass %8.2e, export of flow and scalar %s\n", "BGK_Scalar",
+            SP::NAME, SweepName(Sweep::FluidCells), LT::SPEEDS,
+            (check.isPassed == true) ? "passed" : "FAILED", check.deviation, (check.isBitwise == true) ? " (bitwise)" : "", check.mass,
+            (isExport == false) ? "skipped" : ((check.isExported == true) ? "distinct" : "CLOBBERED"));
+
+    return (check.isPassed == true) ? 0 : 1;
+}
+
+/**\fn        VerifyEnsembleCases
+ * \brief     Verify the fluid cell sweep of an ensemble: every case has to reproduce the BGK operator with its
+ *            own Reynolds number on its own and has to be exported to its own files (see VerifyEnsemble). The
+ *            export is skipped if the directory of the *.vtk-files does not exist.
+ *
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP   streaming policy of the populations
+ * \return    number of failed verifications (0 or 1)
+*/
+template <class LT, class SP>
+unsigned int VerifyEnsembleCases()
+{
+    struct stat info;
+    bool const isExport = (stat(OUTPUT_VTK_PATH.c_str(), &info) == 0) && (S_ISDIR(info.st_mode) == true);
+
+    verificationResult const check = VerifyEnsemble<LT,SP>(isExport);
+    fprintf(stderr, "%19s %13s %11s sweep D3Q%u verification %s: deviation %8.2e%s, export of the cases %s\n", "BGK_Ensemble",
+            SP::NAME, SweepName(Sweep::FluidCells), LT::SPEEDS,
+            (check.isPassed == true) ? "passed" : "FAILED", check.deviation, (check.isBitwise == true) ? " (bitwise)" : "",
+            (isExport == false) ? "skipped" : ((check.isExported == true) ? "distinct" : "CLOBBERED"));
+
+    return (check.isPassed == true) ? 0 : 1;
+}
+
+/**\fn        VerifyRestart
+ * \brief     Verify the checkpoint and restart of the populations (see VerifyCheckpoint), skipped if the
+ *            directory of the checkpoints does not exist
+ *
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP   streaming policy of the populations
+ * \return    number of failed verifications (0 or 1)
+*/
+template <class LT, class SP>
+unsigned int VerifyRestart()
+{
+    struct stat info;
+    if ((stat(BACKUP_EXPORT_PATH.c_str(), &info) != 0) || (S_ISDIR(info.st_mode) == false))
+    {
+        fprintf(stderr, "%19s %13s D3Q%u verification skipped: directory '%s' not found\n", "Checkpoint", SP::NAME, LT::SPEEDS, BACKUP_EXPORT_PATH.c_str());
+        return 0;
+    }
+
+    checkpointVerification const check = VerifyCheckpoint<LT,SP>();
+    fprintf(stderr, "%19s %13s D3Q%u verification %s: restart deviation %8.2e%s, %zu corrupted chunk(s) found\n", "Checkpoint",
+            SP::NAME, LT::SPEEDS, (check.isPassed == true) ? "passed" : "FAILED", check.deviation,
+            (check.isBitwise == true) ? " (bitwise)" : "", check.corrupted);
+
+    return (check.isPassed == true) ? 0 : 1;
+}
+
+/**\fn        VerifyRefinement
+ * \brief     Verify that the mass of a closed periodic domain with a refined patch is conserved over many
+ *            coarse time steps (see VerifyRefinedPatch)
+ *
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP   streaming policy of the populations
+ * \return    number of failed verifications (0 or 1)
+*/
+template <class LT, class SP>
+unsigned int VerifyRefinement()
+{
+    verificationResult const check = VerifyRefinedPatch<LT,SP>();
+    fprintf(stderr, "%19s %13s D3Q%u verification %s: mass of the closed domain %8.2e\n", "Refinement",
+            SP::NAME, LT::SPEEDS, (check.isPassed == true) ? "passed" : "FAILED", check.mass);
+
+    return (check.isPassed == true) ? 0 : 1;
+}
+
+/**\fn        VerifyLattice
+ * \brief     Check the isotropy of the moments of the weights of a lattice that all kernels rely on
+ *
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \return    number of lattices that failed the check (0 or 1)
+*/
+template <class LT>
+unsigned int VerifyLattice()
+{
+    bool const isIsotropic = lattice::UnitTest<LT>::testIsotropy();
+    fprintf(stderr, "D3Q%u isotropy of the weights %s\n", LT::SPEEDS, (isIsotropic == true) ? "passed" : "FAILED");
+
+    return (isIsotropic == true) ? 0 : 1;
+}
+
+#endif // BENCHMARK_HPP_INCLUDED
@@ -0,0 +1,265 @@
+#ifndef KERNELS_HPP_INCLUDED
+#define KERNELS_HPP_INCLUDED
+
+/**
+ * \file     kernels.hpp
+ * \mainpage Collision kernels covered by the benchmark harness and the verification
+ *
+ * \note     Every kernel variant is selected at compile time by the kernel, the lattice, the streaming
+ *           and layout policies of the populations, the memory access hints and, for the lattices stored
+ *           in moment space, the storage policy of the moments. The benchmark (benchmark.hpp) and the
+ *           verification (verification.hpp) advance the same variants through CollideStream.
+*/
+
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "../continuum/continuum.hpp"
+#include "../general/cpu_dispatch.hpp"
+#include "../population/collision/collision_bgk.hpp"
+#include "../population/collision/collision_bgk-s.hpp"
+#include "../population/collision/collision_bgk_avx2.hpp"
+#include "../population/collision/collision_bgk_avx2_soa.hpp"
+#include "../population/collision/collision_bgk_avx512.hpp"
+#include "../population/collision/collision_bgk_avx512_soa.hpp"
+#include "../population/collision/collision_moments.hpp"
+#include "../population/collision/collision_regularised.hpp"
+#include "../population/collision/collision_regularised-s.hpp"
+#include "../population/collision/collision_trt.hpp"
+#include "../population/collision/memory_hints.hpp"
+#include "../population/moments.hpp"
+#include "../population/population.hpp"
+#include "../population/population_layout.hpp"
+#include "../population/population_storage.hpp"
+
+
+/**\enum   Kernel
+ * \brief  Collision kernels covered by the benchmark
+*/
+enum class Kernel { BGK, TRT, BGK_Smagorinsky, BGK_AVX2, BGK_AVX512, BGK_AVX2_SoA, BGK_AVX512_SoA, Regularised, Regularised_Smagorinsky, Regularised_Moments };
+
+/**\fn        KernelName
+ * \brief     Name of a collision kernel as used in the benchmark report
+ *
+ * \param[in] kernel   the collision kernel
+ * \return    name of the collision kernel
+*/
+inline char const* KernelName(Kernel const kernel)
+{
+    switch (kernel)
+    {
+        case Kernel::BGK:             return "BGK";
+        case Kernel::TRT:             return "TRT";
+        case Kernel::BGK_Smagorinsky: return "BGK_Smagorinsky";
+        case Kernel::BGK_AVX2:        return "BGK_AVX2";
+        case Kernel::BGK_AVX512:      return "BGK_AVX512";
+        case Kernel::BGK_AVX2_SoA:    return "BGK_AVX2_SoA";
+        case Kernel::BGK_AVX512_SoA:  return "BGK_AVX512_SoA";
+        case Kernel::Regularised:     return "Regularised";
+        case Kernel::Regularised_Smagorinsky: return "Regularised_Smagorinsky";
+        case Kernel::Regularised_Moments: return "Regularised_Moments";
+    }
+    return "unknown";
+}
+
+/**\fn        IsKernelAvailable
+ * \brief     Check if a collision kernel was compiled and is supported by the current processor
+ *
+ * \param[in] kernel   the collision kernel
+ * \return    Boolean true if the kernel is available, false otherwise
+*/
+inline bool IsKernelAvailable(Kernel const kernel)
+{
+    if ((kernel == Kernel::BGK_AVX2) || (kernel == Kernel::BGK_AVX2_SoA))
+    {
+        #ifdef ISA_TARGET_AVX2
+            return IsIsaSupported(Isa::AVX2);
+        #else
+            return false;
+        #endif
+    }
+    if ((kernel == Kernel::BGK_AVX512) || (kernel == Kernel::BGK_AVX512_SoA))
+    {
+        #ifdef ISA_TARGET_AVX512
+            return IsIsaSupported(Isa::AVX512);
+        #else
+            return false;
+        #endif
+    }
+
+    return true;
+}
+
+/**\class  KernelPopulation
+ * \brief  Microscopic values advanced by a collision kernel: populations or moments
+ *
+ * \tparam K    the collision kernel
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam SP   streaming policy of the populations
+ * \tparam LY   memory layout policy of the populations
+ * \tparam ST   storage policy of the populations or moments
+*/
+template <Kernel K, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class SP, class LY, class ST>
+class KernelPopulation
+{
+    public:
+        static constexpr bool IS_MOMENTS = (K == Kernel::Regularised_Moments);
+
+        /// moments can only be stored natively or in single precision: not instantiated for the other policies
+        typedef typename std::conditional<IS_MOMENTS, ST, storage::Native>::type MST;
+        typedef typename std::conditional<IS_MOMENTS, MomentPopulation<NX,NY,NZ,LT,MST>,
+                                                      Population<NX,NY,NZ,LT,1,LY,ST,SP>>::type type;
+        typedef typename type::T T; ///< floating data type of the simulation
+        typedef typename type::S S; ///< floating data type the populations or moments are stored in
+
+        /// values read and written per lattice update
+        static constexpr unsigned int VALUES = (IS_MOMENTS == true) ? MomentPopulation<NX,NY,NZ,LT,MST>::NM_ : LT::SPEEDS;
+};
+
+
+/**\fn        CollideStream
+ * \brief     Perform a single time step with the selected collision kernel
+ *
+ * \tparam    K      the collision kernel
+ * \tparam    odd    even (0, false) or odd (1, true) time step
+ * \tparam    MH     memory access hints of the vectorised kernels (hint::MemoryHints)
+ * \tparam    save   save the macroscopic values to the continuum (Boolean true/false, default = false)
+ * \param[out]    con   continuum object holding macroscopic variables
+ * \param[in,out] pop   population object holding microscopic variables
+*/
+template <Kernel K, bool odd, class MH, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, class ST, class SP, typename T>
+void CollideStream(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,1,LY,ST,SP>& pop)
+{
+    if constexpr (K == Kernel::BGK)
+    {
+        CollideStreamBGK<odd,save>(con, pop, 0);
+    }
+    else if constexpr (K == Kernel::TRT)
+    {
+        CollideStreamTRT<odd,save>(con, pop, 0);
+    }
+    else if constexpr (K == Kernel::BGK_Smagorinsky)
+    {
+        CollideStreamBGK_Smagorinsky<odd,save>(con, pop, 0);
+    }
+    else if constexpr (K == Kernel::Regularised)
+    {
+        CollideStreamRegularised<odd,save>(con, pop, 0);
+    }
+    else if constexpr (K == Kernel::Regularised_Smagorinsky)
+    {
+        CollideStreamRegularised_Smagorinsky<odd,save>(con, pop, 0);
+    }
+    #ifdef ISA_TARGET_AVX2
+    else if constexpr (K == Kernel::BGK_AVX2)
+    {
+        CollideStreamBGK_AVX2<odd,save,MH>(con, pop, 0);
+    }
+    #endif
+    #ifdef ISA_TARGET_AVX512
+    else if constexpr (K == Kernel::BGK_AVX512)
+    {
+        CollideStreamBGK_AVX512<odd,save,MH>(con, pop, 0);
+    }
+    #endif
+    #ifdef ISA_TARGET_AVX2
+    else if constexpr (K == Kernel::BGK_AVX2_SoA)
+    {
+        CollideStreamBGK_AVX2_SoA<odd,save,MH>(con, pop, 0);
+    }
+    #endif
+    #ifdef ISA_TARGET_AVX512
+    else if constexpr (K == Kernel::BGK_AVX512_SoA)
+    {
+        CollideStreamBGK_AVX512_SoA<odd,save,MH>(con, pop, 0);
+    }
+    #endif
+}
+
+/**\fn        CollideStreamOperator
+ * \brief     Call the scalar collision operator of a kernel on any of its sweeps (full domain, fluid cell
+ *            list, work-stealing scheduler, wavefront or pipeline) by forwarding all arguments
+ *
+ * \tparam    K      the collision kernel (BGK, TRT, BGK_Smagorinsky, Regularised or Regularised_Smagorinsky)
+ * \tparam    B      Boolean template arguments of the collision operator (odd and save or only save)
+ * \tparam    ARGS   types of the arguments
+ * \param[in] args   arguments of the collision operator (continuum, population, sweep, boundaries, ...)
+*/
+template <Kernel K, bool... B, class... ARGS>
+void CollideStreamOperator(ARGS&&... args)
+{
+    static_assert((K == Kernel::BGK) || (K == Kernel::TRT) || (K == Kernel::BGK_Smagorinsky) ||
+                  (K == Kernel::Regularised) || (K == Kernel::Regularised_Smagorinsky),
+                  "Only the scalar collision operators are available on all sweeps.");
+
+    if constexpr (K == Kernel::BGK)
+    {
+        CollideStreamBGK<B...>(std::forward<ARGS>(args)...);
+    }
+    else if constexpr (K == Kernel::TRT)
+    {
+        CollideStreamTRT<B...>(std::forward<ARGS>(args)...);
+    }
+    else if constexpr (K == Kernel::BGK_Smagorinsky)
+    {
+        CollideStreamBGK_Smagorinsky<B...>(std::forward<ARGS>(args)...);
+    }
+    else if constexpr (K == Kernel::Regularised)
+    {
+        CollideStreamRegularised<B...>(std::forward<ARGS>(args)...);
+    }
+    else if constexpr (K == Kernel::Regularised_Smagorinsky)
+    {
+        CollideStreamRegularised_Smagorinsky<B...>(std::forward<ARGS>(args)...);
+    }
+}
+
+/**\fn        CollideStream
+ * \brief     Perform a single time step with the regularised kernel of a lattice stored in moment space
+ *
+ * \tparam    K      the collision kernel (Kernel::Regularised_Moments)
+ * \tparam    odd    even (0, false) or odd (1, true) time step
+ * \tparam    MH     memory access hints (not used)
+ * \tparam    save   save the macroscopic values to the continuum (Boolean true/false, default = false)
+ * \param[out]    con   continuum object holding macroscopic variables
+ * \param[in,out] mom   moment population object holding microscopic variables
+*/
+template <Kernel K, bool odd, class MH, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST, typename T>
+void CollideStream(Continuum<NX,NY,NZ,T>& con, MomentPopulation<NX,NY,NZ,LT,ST>& mom)
+{
+    static_assert(K == Kernel::Regularised_Moments, "Lattices stored in moment space require the moment kernel.");
+
+    CollideStreamMoments<odd,save>(con, mom);
+}
+
+/**\fn        PrecisionName
+ * \brief     Name of the floating data type a lattice is stored in as used in the benchmark report
+ *
+ * \tparam    S   the floating data type the populations or moments are stored in
+ * \return    name of the floating data type
+*/
+template <typename S>
+constexpr char const* PrecisionName()
+{
+    return (sizeof(S) == sizeof(double)) ? "double" : ((sizeof(S) == sizeof(float)) ? "single" : "half");
+}
+
+/**\fn        StorageName
+ * \brief     Name of the storage of a lattice as used in the benchmark report: its floating data type,
+ *            preceded by "shifted" if only the deviation from the lattice weights is stored
+ *
+ * \tparam    ST   storage policy of the populations or moments
+ * \tparam    S    the floating data type the populations or moments are stored in
+ * \return    name of the storage
+*/
+template <class ST, typename S>
+inline std::string StorageName()
+{
+    return std::string((ST::IS_SHIFTED == true) ? "shifted " : "") + PrecisionName<S>();
+}
+
+#endif // KERNELS_HPP_INCLUDED
@@ -0,0 +1,1295 @@
+#ifndef VERIFICATION_HPP_INCLUDED
+#define VERIFICATION_HPP_INCLUDED
+
+/**
+ * \file     verification.hpp
+ * \mainpage Equivalence and conservation checks of the collision kernels
+ *
+ * \note     A faster kernel variant (layout, precision, vectorisation, memory hints) can only be adopted if
+ *           it computes the same flow. Every kernel variant is therefore run for a few time steps on a
+ *           small periodic domain that is initialised with a random density and velocity field (fixed
+ *           seed) and the macroscopic values of the last time step are compared to the ones of the scalar
+ *           kernel of its operator with the A-A pattern and array-of-structures (reference):
+ *           - the variants of the BGK operator (vectorised, structure-of-arrays, esoteric pull,
+ *             non-temporal stores, prefetching) are compared to the BGK kernel, the TRT kernel is run with
+ *             the magic parameter (tau - 1/2)^2 for which both relaxation rates coincide and it reduces to
+ *             the BGK operator, the regularised operators with populations and in moment space are
+ *             compared to an independent implementation of the regularised BGK operator with two buffers
+ *             and the pull scheme (the A-A pattern and the esoteric pull collide the initial equilibrium
+ *             without streaming it and lag one streaming step behind the pull scheme and the moment kernel,
+ *             their reference skips the first streaming step) and the Smagorinsky variants are compared
+ *             to their own kernel with the A-A pattern and native storage, all within a few units in the
+ *             last place of the storage type (vectorisation and fused multiply-add change the order of the
+ *             operations),
+ *           - all operators have to conserve mass and momentum of the periodic domain.
+ *           The sweeps of the scalar operators (fluid cell list with fused bounce-back and Guo boundaries,
+ *           work-stealing scheduler, wavefront and pipeline) are verified on a channel with a cylinder
+ *           against the sweep over the full domain followed by separate boundaries. The flow of the sweep
+ *           coupled with a passive scalar has to be bitwise identical to the one of the BGK operator on its
+ *           own, the walls must conserve the mass of the scalar and the flow and the scalar have to be
+ *           exported to their own files. Every case of an ensemble has to
+ *           reproduce the run of the BGK operator with its own Reynolds number on its own and the background
+ *           writers of the cases have to export every case to its own files. A run that is
+ *           interrupted by a checkpoint and restarted from it has to be bitwise identical to the
+ *           uninterrupted run and a damaged checkpoint has to be rejected. A closed periodic domain with a refined
+ *           patch has to conserve its mass over many coarse time steps. The BGK operator with run-time strides
+ *           (fallback for domains that are not registered) has to reproduce the compiled BGK kernel on the
+ *           periodic domain and on the channel with separate boundaries.
+ *           The benchmark harness verifies every kernel before it is timed and skips kernels that fail,
+ *           with '--verify' the kernels are only verified.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "../continuum/async_export.hpp"
+#include "../continuum/continuum.hpp"
+#include "../continuum/continuum_runtime.hpp"
+#include "../continuum/initialisation.hpp"
+#include "../geometry/cylinder.hpp"
+#include "../population/block_pipeline.hpp"
+#include "../population/block_scheduler.hpp"
+#include "../population/ensemble.hpp"
+#include "../population/boundary/boundary.hpp"
+#include "../population/boundary/boundary_bounceback.hpp"
+#include "../population/boundary/boundary_guo.hpp"
+#include "../population/boundary/boundary_orientation.hpp"
+#include "../population/boundary/boundary_runtime.hpp"
+#include "../population/boundary/boundary_type.hpp"
+#include "../population/collision/collision_bgk_ensemble.hpp"
+#include "../population/collision/collision_bgk_runtime.hpp"
+#include "../population/collision/collision_bgk_scalar.hpp"
+#include "../population/fluid_cells.hpp"
+#include "../population/initialisation.hpp"
+#include "../population/refinement.hpp"
+#include "../population/population_runtime.hpp"
+#include "../population/wavefront.hpp"
+#include "kernels.hpp"
+
+
+/// domain and number of time steps of the verification
+constexpr unsigned int VERIFY_NX    = 32;
+constexpr unsigned int VERIFY_NY    = 24;
+constexpr unsigned int VERIFY_NZ    = 16;
+constexpr unsigned int VERIFY_STEPS = 4;
+
+
+/**\struct verificationResult
+ * \brief  Result of the verification of a single kernel variant
+*/
+struct verificationResult
+{
+    double deviation; ///< maximum deviation of the macroscopic values from the reference
+    double mass;      ///< relative change of the mass of the domain
+    double momentum;  ///< change of the momentum of the domain relative to the sum of its magnitude
+    bool   isBitwise;  ///< the macroscopic values are bitwise identical to the reference
+    bool   isExported; ///< the fields exported at the same time hold their own values (if exported)
+    bool   isPassed;   ///< the kernel matches the reference and conserves mass and momentum
+};
+
+/**\enum   Sweep
+ * \brief  Sweeps of the scalar collision operators verified against the sweep over the full domain
+ *         followed by separate Guo boundaries and bounce-back
+ *         - FluidCells: fluid cell list with fused bounce-back and fused Guo boundaries
+ *         - Scheduler:  fluid cell list distributed by the work-stealing scheduler
+ *         - Wavefront:  pairs of time steps advanced plane by plane
+ *         - Pipeline:   all time steps advanced by the block pipeline
+*/
+enum class Sweep { FluidCells, Scheduler, Wavefront, Pipeline };
+
+
+/**\fn        SweepName
+ * \brief     Name of a sweep as used in the verification report
+ *
+ * \param[in] sweep   the sweep
+ * \return    name of the sweep
+*/
+inline char const* SweepName(Sweep const sweep)
+{
+    switch (sweep)
+    {
+        case Sweep::FluidCells: return "fluid cells";
+        case Sweep::Scheduler:  return "scheduler";
+        case Sweep::Wavefront:  return "wavefront";
+        case Sweep::Pipeline:   return "pipeline";
+    }
+    return "unknown";
+}
+
+/**\fn        IsBgkVariant
+ * \brief     Check if a collision kernel implements the BGK operator
+ *
+ * \param[in] kernel   the collision kernel
+ * \return    Boolean true if the kernel implements the BGK operator, false otherwise
+*/
+constexpr bool IsBgkVariant(Kernel const kernel)
+{
+    return (kernel == Kernel::BGK) || (kernel == Kernel::BGK_AVX2) || (kernel == Kernel::BGK_AVX512) ||
+           (kernel == Kernel::BGK_AVX2_SoA) || (kernel == Kernel::BGK_AVX512_SoA);
+}
+
+/**\fn        ReferenceKernel
+ * \brief     Scalar kernel a collision kernel is compared to: the BGK kernel for the variants of the BGK
+ *            operator and the TRT kernel (run with the magic parameter of the BGK operator) and the kernel
+ *            itself with the A-A pattern and native storage otherwise (Smagorinsky variants)
+ * \note      The regularised operators are not compared to a kernel but to RunRegularisedReference
+ *
+ * \param[in] kernel   the collision kernel
+ * \return    the reference kernel
+*/
+constexpr Kernel ReferenceKernel(Kernel const kernel)
+{
+    return ((IsBgkVariant(kernel) == true) || (kernel == Kernel::TRT)) ? Kernel::BGK : kernel;
+}
+
+/**\fn        EquivalenceTolerance
+ * \brief     Maximum deviation of the macroscopic values of a kernel variant from its reference and
+ *            maximum change of mass and momentum: a few units in the last place of the floating data type
+ *            the lattice is stored in
+ *
+ * \tparam    S   floating data type the populations or moments are stored in
+ * \return    tolerance
+*/
+template <typename S>
+constexpr double EquivalenceTolerance()
+{
+    return (sizeof(S) == sizeof(double)) ? 1.0e-12 : ((sizeof(S) == sizeof(float)) ? 1.0e-5 : 1.0e-3);
+}
+
+/**\fn        BgkLambda
+ * \brief     Magic parameter of the TRT operator for which the relaxation rate of the odd part equals the
+ *            one of the even part, the TRT operator then reduces to the BGK operator
+ *
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \param[in] Re   simulation Reynolds number
+ * \param[in] U    characteristic velocity of the simulation in lattice units
+ * \param[in] L    characteristic length of the simulation in lattice units
+ * \return    magic parameter (tau - 1/2)^2
+*/
+template <class LT>
+double BgkLambda(double const Re, double const U, unsigned int const L)
+{
+    double const tau = U*L/(Re*LT::CS*LT::CS) + 0.5;
+    return (tau - 0.5)*(tau - 0.5);
+}
+
+/**\fn        RandomContinuum
+ * \brief     Random density (1 +- 1%) and velocity (+- 0.02 in every direction) with a fixed seed
+ *
+ * \param[out] con    continuum object holding macroscopic variables
+ * \param[in]  seed   seed of the random number generator (default = 42)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void RandomContinuum(Continuum<NX,NY,NZ,T>& con, unsigned int const seed = 42)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        for(unsigned int y = 0; y < NY; ++y)
+        {
+            for(unsigned int x = 0; x < NX; ++x)
+            {
+                con(x, y, z, 0) = static_cast<T>(1.0 + 0.01*distribution(generator));
+                for(unsigned int m = 1; m < con.NM_; ++m)
+                {
+                    con(x, y, z, m) = static_cast<T>(0.02*distribution(generator));
+                }
+            }
+        }
+    }
+}
+
+/**\fn        RunKernel
+ * \brief     Initialise a lattice from the random field and advance it with a collision kernel, the
+ *            macroscopic values of the last time step are saved to the continuum
+ *
+ * \tparam    K         the collision kernel
+ * \tparam    NX        simulation domain resolution in x-direction
+ * \tparam    NY        simulation domain resolution in y-direction
+ * \tparam    NZ        simulation domain resolution in z-direction
+ * \tparam    LT        static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP        streaming policy of the populations
+ * \tparam    LY        memory layout policy of the populations
+ * \tparam    MH        memory access hints of the vectorised kernels (hint::MemoryHints)
+ * \tparam    ST        storage policy of the populations or moments
+ * \param[out] con      continuum object holding the macroscopic values of the last time step
+ * \param[in]  steps    number of time steps (rounded up to an even number)
+*/
+template <Kernel K, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class SP, class LY, class MH, class ST>
+void RunKernel(Continuum<NX,NY,NZ,typename KernelPopulation<K,NX,NY,NZ,LT,SP,LY,ST>::T>& con, unsigned int const steps)
+{
+    typedef typename KernelPopulation<K,NX,NY,NZ,LT,SP,LY,ST>::type POP;
+    auto const create = []()
+    {
+        if constexpr (K == Kernel::TRT)
+        {
+            return POP(1000.0, 0.05, NY/5, BgkLambda<LT>(1000.0, 0.05, NY/5));
+        }
+        else
+        {
+            return POP(1000.0, 0.05, NY/5);
+        }
+    };
+    POP pop = create();
+    RandomContinuum(con);
+    InitLattice<false>(con, pop);
+
+    for(unsigned int i = 2; i < 2*((steps + 1)/2); i += 2)
+    {
+        CollideStream<K,false,MH>(con, pop);
+        CollideStream<K,true,MH>(con, pop);
+    }
+    CollideStream<K,false,MH>(con, pop);
+    CollideStream<K,true,MH,true>(con, pop);
+}
+
+/**\fn        RunRegularisedReference
+ * \brief     Independent reference of the regularised BGK operator: the random field is advanced with two
+ *            buffers and the pull scheme f(x,t+1) = f*(x-c,t) where the post-collision populations
+ *            f* = feq + (1 - omega) W/(2 cs^4) (c c - cs^2 I) : P_neq
+ *            are evaluated with plain loops over the lattice velocities from the lattice constants only
+ *            (none of the routines of the kernels are used), the macroscopic values of the last time step
+ *            are saved to the continuum
+ * \note      The lattice is initialised with the equilibrium populations, the moment kernel streams them
+ *            right away while the first step of the A-A pattern (and the esoteric pull) collides without
+ *            streaming. The A-A pattern is therefore one streaming step behind the pull scheme and the
+ *            first step of its reference has to collide in place.
+ *
+ * \tparam    isShifted   the first time step collides without streaming (A-A pattern, esoteric pull)
+ * \tparam    LT          static lattice::DdQq class containing discretisation parameters
+ * \tparam    NX          simulation domain resolution in x-direction
+ * \tparam    NY          simulation domain resolution in y-direction
+ * \tparam    NZ          simulation domain resolution in z-direction
+ * \tparam    T           floating data type used for simulation
+ * \param[out] con        continuum object holding the macroscopic values of the last time step
+ * \param[in]  steps      number of time steps (rounded up to an even number like the kernels)
+*/
+template <bool isShifted, class LT, unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void RunRegularisedReference(Continuum<NX,NY,NZ,T>& con, unsigned int const steps)
+{
+    constexpr unsigned int ND = LT::ND;
+    constexpr double CS2 = static_cast<double>(LT::CS)*static_cast<double>(LT::CS);
+
+    /// same relaxation as the kernels: Re = 1000, U = 0.05, L = NY/5
+    double const nu    = 0.05*static_cast<double>(NY/5)/1000.0;
+    double const omega = 1.0/(nu/CS2 + 0.5);
+
+    size_t const cells = static_cast<size_t>(NX)*NY*NZ;
+    std::vector<double> post(cells*ND, 0.0);
+    std::vector<double> next(cells*ND, 0.0);
+
+    auto const cell = [](unsigned int const x, unsigned int const y, unsigned int const z)
+    {
+        return (static_cast<size_t>(z)*NY + y)*NX + x;
+    };
+    /// the padding of the lattice is masked out, its populations remain zero and do not contribute to the moments
+    auto const weight = [](unsigned int const q)
+    {
+        return static_cast<double>(LT::W[q])*static_cast<double>(LT::MASK[q]);
+    };
+    auto const equilibrium = [CS2,weight](double const rho, double const (&u)[3], unsigned int const q)
+    {
+        double const c[3] = { static_cast<double>(LT::DX[q]), static_cast<double>(LT::DY[q]), static_cast<double>(LT::DZ[q]) };
+        double const cu = c[0]*u[0] + c[1]*u[1] + c[2]*u[2];
+        double const uu = u[0]*u[0] + u[1]*u[1] + u[2]*u[2];
+        return weight(q)*rho*(1.0 + cu/CS2 + cu*cu/(2.0*CS2*CS2) - uu/(2.0*CS2));
+    };
+
+    /// the initial equilibrium populations take the place of the post-collision populations of step 0
+    RandomContinuum(con);
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        for(unsigned int y = 0; y < NY; ++y)
+        {
+            for(unsigned int x = 0; x < NX; ++x)
+            {
+                double const u[3] = { static_cast<double>(con(x, y, z, 1)), static_cast<double>(con(x, y, z, 2)), static_cast<double>(con(x, y, z, 3)) };
+                for(unsigned int q = 0; q < ND; ++q)
+                {
+                    post[cell(x, y, z)*ND + q] = equilibrium(static_cast<double>(con(x, y, z, 0)), u, q);
+                }
+            }
+        }
+    }
+
+    unsigned int const NT = 2*((steps + 1)/2);
+    for(unsigned int t = 1; t <= NT; ++t)
+    {
+        bool const isStreaming = (isShifted == false) || (t > 1);
+
+        for(unsigned int z = 0; z < NZ; ++z)
+        {
+            for(unsigned int y = 0; y < NY; ++y)
+            {
+                for(unsigned int x = 0; x < NX; ++x)
+                {
+                    /// pull the populations from the upstream neighbours
+                    double f[ND] = {0.0};
+                    for(unsigned int q = 0; q < ND; ++q)
+                    {
+                        int const cx = (isStreaming == true) ? static_cast<int>(LT::DX[q]) : 0;
+                        int const cy = (isStreaming == true) ? static_cast<int>(LT::DY[q]) : 0;
+                        int const cz = (isStreaming == true) ? static_cast<int>(LT::DZ[q]) : 0;
+                        f[q] = post[cell((NX + x - cx) % NX, (NY + y - cy) % NY, (NZ + z - cz) % NZ)*ND + q];
+                    }
+
+                    /// density, velocity and second order moments
+                    double rho = 0.0;
+                    double j[3] = {0.0, 0.0, 0.0};
+                    double P[3][3] = {{0.0}};
+                    for(unsigned int q = 0; q < ND; ++q)
+                    {
+                        double const c[3] = { static_cast<double>(LT::DX[q]), static_cast<double>(LT::DY[q]), static_cast<double>(LT::DZ[q]) };
+                        rho += f[q];
+                        for(unsigned int a = 0; a < 3; ++a)
+                        {
+                            j[a] += c[a]*f[q];
+                            for(unsigned int b = 0; b < 3; ++b)
+                            {
+                                P[a][b] += c[a]*c[b]*f[q];
+                            }
+                        }
+                    }
+                    double const u[3] = { j[0]/rho, j[1]/rho, j[2]/rho };
+
+                    if (t == NT)
+                    {
+                        con(x, y, z, 0) = static_cast<T>(rho);
+                        con(x, y, z, 1) = static_cast<T>(u[0]);
+                        con(x, y, z, 2) = static_cast<T>(u[1]);
+                        con(x, y, z, 3) = static_cast<T>(u[2]);
+                    }
+
+                    /// non-equilibrium part of the second order moments
+                    for(unsigned int a = 0; a < 3; ++a)
+                    {
+                        for(unsigned int b = 0; b < 3; ++b)
+                        {
+                            P[a][b] -= rho*(u[a]*u[b] + ((a == b) ? CS2 : 0.0));
+                        }
+                    }
+
+                    /// collision: relaxed Hermite reconstruction
+                    for(unsigned int q = 0; q < ND; ++q)
+                    {
+                        double const c[3] = { static_cast<double>(LT::DX[q]), static_cast<double>(LT::DY[q]), static_cast<double>(LT::DZ[q]) };
+                        double qp = 0.0;
+                        for(unsigned int a = 0; a < 3; ++a)
+                        {
+                            for(unsigned int b = 0; b < 3; ++b)
+                            {
+                                qp += (c[a]*c[b] - ((a == b) ? CS2 : 0.0))*P[a][b];
+                            }
+                        }
+                        next[cell(x, y, z)*ND + q] = equilibrium(rho, u, q) +
+                                                     (1.0 - omega)*weight(q)/(2.0*CS2*CS2)*qp;
+                    }
+                }
+            }
+        }
+        post.swap(next);
+    }
+}
+
+/**\fn        Conserved
+ * \brief     Mass, momentum and magnitude of the momentum of the domain
+ *
+ * \param[in] con   continuum object holding macroscopic variables
+ * \return    mass, momentum in x-, y- and z-direction and the sum of the magnitude of the momentum
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+std::array<double,5> Conserved(Continuum<NX,NY,NZ,T> const& con)
+{
+    std::array<double,5> sum = {0.0, 0.0, 0.0, 0.0, 0.0};
+
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        for(unsigned int y = 0; y < NY; ++y)
+        {
+            for(unsigned int x = 0; x < NX; ++x)
+            {
+                double const rho = con(x, y, z, 0);
+                sum[0] += rho;
+                for(unsigned int d = 1; d < con.NM_; ++d)
+                {
+                    sum[d] += rho*con(x, y, z, d);
+                    sum[4] += std::abs(rho*con(x, y, z, d));
+                }
+            }
+        }
+    }
+    return sum;
+}
+
+/**\fn        VerifyKernel
+ * \brief     Compare a kernel variant to the reference of its operator and check the conservation of mass
+ *            and momentum
+ *
+ * \tparam    K    the collision kernel
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP   streaming policy of the populations
+ * \tparam    LY   memory layout policy of the populations
+ * \tparam    MH   memory access hints of the vectorised kernels (hint::MemoryHints)
+ * \tparam    ST   storage policy of the populations or moments
+ * \return    result of the verification
+*/
+template <Kernel K, class LT, class SP, class LY, class MH, class ST>
+verificationResult VerifyKernel()
+{
+    constexpr unsigned int NX = VERIFY_NX;
+    constexpr unsigned int NY = VERIFY_NY;
+    constexpr unsigned int NZ = VERIFY_NZ;
+    typedef typename KernelPopulation<K,NX,NY,NZ,LT,SP,LY,ST>::T T;
+    typedef typename KernelPopulation<K,NX,NY,NZ,LT,SP,LY,ST>::S S;
+
+    /// tolerances: a few units in the last place of the macroscopic values and the sums
+    constexpr double equivalence  = EquivalenceTolerance<S>();
+    constexpr double conservation = EquivalenceTolerance<S>();
+
+    Continuum<NX,NY,NZ,T> initial;
+    Continuum<NX,NY,NZ,T> reference;
+    Continuum<NX,NY,NZ,T> con;
+    RandomContinuum(initial);
+    if constexpr (K == Kernel::Regularised_Moments)
+    {
+        RunRegularisedReference<false,LT>(reference, VERIFY_STEPS);
+    }
+    else if constexpr (K == Kernel::Regularised)
+    {
+        RunRegularisedReference<true,LT>(reference, VERIFY_STEPS);
+    }
+    else
+    {
+        RunKernel<ReferenceKernel(K),NX,NY,NZ,LT,streaming::AA,layout::AoS,hint::Cached,storage::Native>(reference, VERIFY_STEPS);
+    }
+    RunKernel<K,NX,NY,NZ,LT,SP,LY,MH,ST>(con, VERIFY_STEPS);
+
+    verificationResult result;
+    result.deviation = 0.0;
+    result.isBitwise = (memcmp(con.M_, reference.M_, con.MEM_SIZE_) == 0);
+    for(size_t i = 0; i < con.MEM_SIZE_/sizeof(T); ++i)
+    {
+        result.deviation = std::max(result.deviation, static_cast<double>(std::abs(con.M_[i] - reference.M_[i])));
+    }
+
+    std::array<double,5> const before = Conserved(initial);
+    std::array<double,5> const after  = Conserved(con);
+    result.mass     = std::abs(after[0] - before[0])/before[0];
+    result.momentum = std::max({std::abs(after[1] - before[1]), std::abs(after[2] - before[2]), std::abs(after[3] - before[3])})/before[4];
+
+    result.isPassed = (result.deviation <= equivalence) &&
+                      (result.mass <= conservation) && (result.momentum <= conservation) &&
+                      (std::isfinite(result.deviation) == true);
+
+    return result;
+}
+
+/**\fn        VerificationChannel
+ * \brief     Channel with a cylinder, velocity inlet and pressure outlet of the verification of the sweeps
+ *
+ * \tparam     NX       simulation domain resolution in x-direction
+ * \tparam     NY       simulation domain resolution in y-direction
+ * \tparam     NZ       simulation domain resolution in z-direction
+ * \tparam     T        floating data type used for simulation
+ * \param[out] wall     solid cells (channel walls and cylinder)
+ * \param[out] inlet    velocity boundary
+ * \param[out] outlet   pressure boundary
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void VerificationChannel(std::vector<boundaryElement<T>>& wall, std::vector<boundaryElement<T>>& inlet, std::vector<boundaryElement<T>>& outlet)
+{
+    Cylinder3D<NX,NY,NZ,T>(NY/5, {NX/4, NY/2, NZ/2}, "x", true, wall, inlet, outlet, 1.0, 0.05, 0.0, 0.0);
+}
+
+/**\fn        RunSweep
+ * \brief     Initialise a lattice from the random field and advance the channel with a collision
+ *            operator on a sweep, the macroscopic values of the last time step are saved to the continuum
+ *
+ * \tparam    K         the collision kernel (scalar operator)
+ * \tparam    SW        the sweep
+ * \tparam    isSweep   run the sweep (Boolean true) or the reference: the full domain followed by separate
+ *                      Guo boundaries and bounce-back (Boolean false)
+ * \tparam    NX        simulation domain resolution in x-direction
+ * \tparam    NY        simulation domain resolution in y-direction
+ * \tparam    NZ        simulation domain resolution in z-direction
+ * \tparam    LT        static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP        streaming policy of the populations
+ * \tparam    T         floating data type used for simulation
+ * \param[out] con      continuum object holding the macroscopic values of the last time step
+ * \param[in]  steps    number of time steps (rounded up to an even number)
+*/
+template <Kernel K, Sweep SW, bool isSweep, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class SP, typename T>
+void RunSweep(Continuum<NX,NY,NZ,T>& con, unsigned int const steps)
+{
+    std::vector<boundaryElement<T>> wall;
+    std::vector<boundaryElement<T>> inlet;
+    std::vector<boundaryElement<T>> outlet;
+    VerificationChannel<NX,NY,NZ>(wall, inlet, outlet);
+
+    Population<NX,NY,NZ,LT,1,layout::AoS,storage::Native,SP> pop(1000.0, 0.05, NY/5);
+    RandomContinuum(con);
+    InitLattice<false>(con, pop);
+
+    typedef FusedGuo<type::Velocity,orientation::Left, NX,NY,NZ,T> FusedInlet;
+    typedef FusedGuo<type::Pressure,orientation::Right,NX,NY,NZ,T> FusedOutlet;
+    FluidCells<NX,NY,NZ> const fluid(pop, wall);
+    unsigned int const NT = 2*((steps + 1)/2);
+
+    if constexpr (isSweep == false)
+    {
+        for(unsigned int i = 0; i < NT; i += 2)
+        {
+            Guo<false,type::Velocity,orientation::Left>(inlet,  pop);
+            Guo<false,type::Pressure,orientation::Right>(outlet, pop);
+            CollideStreamOperator<K,false,false>(con, pop, 0u);
+            BounceBackHalfway<false>(wall, pop);
+
+            Guo<true,type::Velocity,orientation::Left>(inlet,  pop);
+            Guo<true,type::Pressure,orientation::Right>(outlet, pop);
+            (i + 2 < NT) ? CollideStreamOperator<K,true,false>(con, pop, 0u) : CollideStreamOperator<K,true,true>(con, pop, 0u);
+            BounceBackHalfway<true>(wall, pop);
+        }
+    }
+    else if constexpr (SW == Sweep::Wavefront)
+    {
+        Wavefront<NX,NY,NZ> const tile(fluid, 2);
+        FusedInlet  const inletFused(tile, inlet);
+        FusedOutlet const outletFused(tile, outlet);
+        for(unsigned int i = 0; i < NT; i += 2)
+        {
+            (i + 2 < NT) ? CollideStreamOperator<K,false>(con, pop, tile, 0u, inletFused, outletFused) :
+                           CollideStreamOperator<K,true>(con, pop, tile, 0u, inletFused, outletFused);
+        }
+    }
+    else if constexpr (SW == Sweep::Pipeline)
+    {
+        BlockPipeline<NX,NY,NZ> pipeline(fluid);
+        FusedInlet  const inletFused(fluid, inlet);
+        FusedOutlet const outletFused(fluid, outlet);
+        CollideStreamOperator<K,true>(con, pop, pipeline, static_cast<size_t>(NT), 0u, inletFused, outletFused);
+    }
+    else
+    {
+        FusedInlet  const inletFused(fluid, inlet);
+        FusedOutlet const outletFused(fluid, outlet);
+        BlockScheduler<NX,NY,NZ> scheduler(fluid, inletFused, outletFused);
+
+        /// the elements that can not be fused are applied before the collision
+        auto const step = [&](auto const odd, auto const save)
+        {
+            Guo<decltype(odd)::value>(inletFused,  pop);
+            Guo<decltype(odd)::value>(outletFused, pop);
+            if constexpr (SW == Sweep::Scheduler)
+            {
+                CollideStreamOperator<K,decltype(odd)::value,decltype(save)::value>(con, pop, fluid, scheduler, 0u, inletFused, outletFused);
+            }
+            else
+            {
+                CollideStreamOperator<K,decltype(odd)::value,decltype(save)::value>(con, pop, fluid, 0u, inletFused, outletFused);
+            }
+        };
+        for(unsigned int i = 0; i < NT; i += 2)
+        {
+            step(std::false_type(), std::false_type());
+            (i + 2 < NT) ? step(std::true_type(), std::false_type()) : step(std::true_type(), std::true_type());
+        }
+    }
+
+    con.SetZero(wall);
+}
+
+/**\fn        VerifySweep
+ * \brief     Compare a sweep of a scalar collision operator with fused boundaries to the sweep over the full
+ *            domain followed by separate Guo boundaries and bounce-back
+ *
+ * \tparam    K    the collision kernel (scalar operator)
+ * \tparam    SW   the sweep
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP   streaming policy of the populations
+ * \return    result of the verification (mass and momentum are not conserved by the open channel)
+*/
+template <Kernel K, Sweep SW, class LT, class SP>
+verificationResult VerifySweep()
+{
+    constexpr unsigned int NX = VERIFY_NX;
+    constexpr unsigned int NY = VERIFY_NY;
+    constexpr unsigned int NZ = VERIFY_NZ;
+    typedef typename Population<NX,NY,NZ,LT>::T T;
+
+    Continuum<NX,NY,NZ,T> reference;
+    Continuum<NX,NY,NZ,T> con;
+    RunSweep<K,SW,false,NX,NY,NZ,LT,SP>(reference, VERIFY_STEPS);
+    RunSweep<K,SW,true, NX,NY,NZ,LT,SP>(con,       VERIFY_STEPS);
+
+    verificationResult result = {};
+    result.isBitwise = (memcmp(con.M_, reference.M_, con.MEM_SIZE_) == 0);
+    for(size_t i = 0; i < con.MEM_SIZE_/sizeof(T); ++i)
+    {
+        result.deviation = std::max(result.deviation, static_cast<double>(std::abs(con.M_[i] - reference.M_[i])));
+    }
+    result.isPassed = (result.deviation <= EquivalenceTolerance<T>()) && (std::isfinite(result.deviation) == true);
+
+    return result;
+}
+
+/**\fn        RunRuntime
+ * \brief     Initialise a lattice with run-time strides from the random field and advance it with the BGK
+ *            operator, either periodic or on the channel with separate Guo boundaries and bounce-back (same
+ *            order as the references of RunKernel and RunSweep). The macroscopic values of the last time step
+ *            are copied to the compiled continuum.
+ *
+ * \tparam    isChannel   channel with a cylinder (Boolean true) or periodic domain (Boolean false)
+ * \tparam    LT          static lattice::DdQq class containing discretisation parameters
+ * \tparam    NX          simulation domain resolution in x-direction
+ * \tparam    NY          simulation domain resolution in y-direction
+ * \tparam    NZ          simulation domain resolution in z-direction
+ * \tparam    T           floating data type used for simulation
+ * \param[out] con        continuum object holding the macroscopic values of the last time step
+ * \param[in]  steps      number of time steps (rounded up to an even number)
+*/
+template <bool isChannel, class LT, unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void RunRuntime(Continuum<NX,NY,NZ,T>& con, unsigned int const steps)
+{
+    std::vector<boundaryElement<T>> wall;
+    std::vector<boundaryElement<T>> inlet;
+    std::vector<boundaryElement<T>> outlet;
+    if constexpr (isChannel == true)
+    {
+        Cylinder3D<T>(NX, NY, NZ, NY/5, {NX/4, NY/2, NZ/2}, "x", true, wall, inlet, outlet, 1.0, 0.05, 0.0, 0.0);
+    }
+
+    RuntimeContinuum<T> macro(NX, NY, NZ);
+    RuntimePopulation<LT> pop(NX, NY, NZ, 1000.0, 0.05, NY/5);
+    RandomContinuum(con);
+    memcpy(macro.M_, con.M_, con.MEM_SIZE_);
+    InitLattice<false>(macro, pop);
+
+    auto const step = [&](auto const odd, auto const save)
+    {
+        if constexpr (isChannel == true)
+        {
+            Guo<decltype(odd)::value,type::Velocity,orientation::Left>(inlet,  pop);
+            Guo<decltype(odd)::value,type::Pressure,orientation::Right>(outlet, pop);
+        }
+        CollideStreamBGK<decltype(odd)::value,decltype(save)::value>(macro, pop);
+        if constexpr (isChannel == true)
+        {
+            BounceBackHalfway<decltype(odd)::value>(wall, pop);
+        }
+    };
+    unsigned int const NT = 2*((steps + 1)/2);
+    for(unsigned int i = 0; i < NT; i += 2)
+    {
+        step(std::false_type(), std::false_type());
+        (i + 2 < NT) ? step(std::true_type(), std::false_type()) : step(std::true_type(), std::true_type());
+    }
+
+    macro.SetZero(wall);
+    memcpy(con.M_, macro.M_, con.MEM_SIZE_);
+}
+
+/**\fn        VerifyRuntime
+ * \brief     Compare the BGK operator with run-time strides to the compiled BGK kernel on the periodic domain
+ *            and to the compiled full domain followed by separate boundaries on the channel, and check the
+ *            conservation of mass and momentum of the periodic domain
+ *
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \return    result of the verification (maximum deviation of both cases)
+*/
+template <class LT>
+verificationResult VerifyRuntime()
+{
+    constexpr unsigned int NX = VERIFY_NX;
+    constexpr unsigned int NY = VERIFY_NY;
+    constexpr unsigned int NZ = VERIFY_NZ;
+    typedef typename Population<NX,NY,NZ,LT>::T T;
+
+    Continuum<NX,NY,NZ,T> initial;
+    Continuum<NX,NY,NZ,T> reference;
+    Continuum<NX,NY,NZ,T> con;
+    Continuum<NX,NY,NZ,T> referenceChannel;
+    Continuum<NX,NY,NZ,T> channel;
+    RandomContinuum(initial);
+    RunKernel<Kernel::BGK,NX,NY,NZ,LT,streaming::AA,layout::AoS,hint::Cached,storage::Native>(reference, VERIFY_STEPS);
+    RunRuntime<false,LT>(con, VERIFY_STEPS);
+    RunSweep<Kernel::BGK,Sweep::FluidCells,false,NX,NY,NZ,LT,streaming::AA>(referenceChannel, VERIFY_STEPS);
+    RunRuntime<true,LT>(channel, VERIFY_STEPS);
+
+    verificationResult result = {};
+    result.isBitwise = (memcmp(con.M_, reference.M_, con.MEM_SIZE_) == 0) && (memcmp(channel.M_, referenceChannel.M_, channel.MEM_SIZE_) == 0);
+    for(size_t i = 0; i < con.MEM_SIZE_/sizeof(T); ++i)
+    {
+        result.deviation = std::max({result.deviation, static_cast<double>(std::abs(con.M_[i] - reference.M_[i])),
+                                     static_cast<double>(std::abs(channel.M_[i] - referenceChannel.M_[i]))});
+    }
+
+    std::array<double,5> const before = Conserved(initial);
+    std::array<double,5> const after  = Conserved(con);
+    result.mass     = std::abs(after[0] - before[0])/before[0];
+    result.momentum = std::max({std::abs(after[1] - before[1]), std::abs(after[2] - before[2]), std::abs(after[3] - before[3])})/before[4];
+
+    result.isPassed = (result.deviation <= EquivalenceTolerance<T>()) &&
+                      (result.mass <= EquivalenceTolerance<T>()) && (result.momentum <= EquivalenceTolerance<T>()) &&
+                      (std::isfinite(result.deviation) == true);
+
+    return result;
+}
+
+/**\fn        RefinementComposite
+ * \brief     Mass of a coarse population with a refined patch: the coarse cells that are not covered by the
+ *            patch and an eighth of the fine cells inside the ghost layer
+ *
+ * \tparam    RP       the refined patch (RefinedPatch)
+ * \param[in] coarse   coarse population before an even time step
+ * \param[in] fine     fine population of the patch before an even time step
+ * \param[in] patch    the refined patch coupling both populations
+ * \return    mass of the composite of both levels
+*/
+template <class RP, unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int NX_FINE, unsigned int NY_FINE, unsigned int NZ_FINE,
+          class LT, unsigned int NPOP, class LY, class ST, class SP>
+double RefinementComposite(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& coarse,
+                           Population<NX_FINE,NY_FINE,NZ_FINE,LT,NPOP,LY,ST,SP> const& fine, RP const& patch)
+{
+    double mass = -patch. template CoveredMass<false>(coarse) - patch. template GhostMass<false>(fine)/(RP::RATIO_*RP::RATIO_*RP::RATIO_);
+
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        for(unsigned int y = 0; y < NY; ++y)
+        {
+            for(unsigned int x = 0; x < NX; ++x)
+            {
+                mass += RefinementDensity<false>(coarse, x, y, z, 0);
+            }
+        }
+    }
+    for(unsigned int z = 0; z < NZ_FINE; ++z)
+    {
+        for(unsigned int y = 0; y < NY_FINE; ++y)
+        {
+            for(unsigned int x = 0; x < NX_FINE; ++x)
+            {
+                mass += RefinementDensity<false>(fine, x, y, z, 0)/(RP::RATIO_*RP::RATIO_*RP::RATIO_);
+            }
+        }
+    }
+    return mass;
+}
+
+/**\fn        VerifyRefinedPatch
+ * \brief     Advance the periodic domain without walls with a refined patch in its interior for many coarse
+ *            time steps and check that the mass of the composite of both levels (see RefinementComposite)
+ *            does not change. The domain is initialised with a smooth periodic shear flow and density wave
+ *            that cross the interface, the patch is initialised with the same fields at the positions of
+ *            the fine cells.
+ *
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP   streaming policy of the populations
+ * \return    result of the verification (relative change of the mass of the composite)
+*/
+template <class LT, class SP>
+verificationResult VerifyRefinedPatch()
+{
+    constexpr unsigned int NX = VERIFY_NX;
+    constexpr unsigned int NY = VERIFY_NY;
+    constexpr unsigned int NZ = VERIFY_NZ;
+    typedef typename Population<NX,NY,NZ,LT>::T T;
+    typedef RefinedPatch<NX,NY,NZ,NX/4,NY/4,NZ/4,NX/2,NY/2,NZ/2,T> Refinement;
+    constexpr unsigned int NX_FINE = Refinement::NX_FINE_;
+    constexpr unsigned int NY_FINE = Refinement::NY_FINE_;
+    constexpr unsigned int NZ_FINE = Refinement::NZ_FINE_;
+    constexpr unsigned int COARSE_STEPS = 100;
+
+    std::vector<boundaryElement<T>> const wall;
+    auto const field = [](double const x, double const y, double const z, std::array<double,4>& value)
+    {
+        constexpr double PI = 3.14159265358979323846;
+        value[0] = 1.0 + 0.01*std::cos(2.0*PI*x/NX);
+        value[1] = 0.02*std::sin(2.0*PI*y/NY);
+        value[2] = 0.02*std::sin(2.0*PI*z/NZ);
+        value[3] = 0.02*std::sin(2.0*PI*x/NX);
+    };
+
+    auto con = std::make_unique<Continuum<NX,NY,NZ,T>>();
+    auto pop = std::make_unique<Population<NX,NY,NZ,LT,1,layout::AoS,storage::Native,SP>>(1000.0, 0.05, NY/5);
+    auto conFine = std::make_unique<Continuum<NX_FINE,NY_FINE,NZ_FINE,T>>();
+    auto popFine = std::make_unique<Population<NX_FINE,NY_FINE,NZ_FINE,LT,1,layout::AoS,storage::Native,SP>>(1000.0, 0.05, Refinement::RATIO_*(NY/5));
+
+    std::array<double,4> value;
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        for(unsigned int y = 0; y < NY; ++y)
+        {
+            for(unsigned int x = 0; x < NX; ++x)
+            {
+                field(x, y, z, value);
+                for(unsigned int m = 0; m < 4; ++m)
+                {
+                    (*con)(x, y, z, m) = value[m];
+                }
+            }
+        }
+    }
+    std::array<double,3> const origin = Refinement::Origin();
+    for(unsigned int z = 0; z < NZ_FINE; ++z)
+    {
+        for(unsigned int y = 0; y < NY_FINE; ++y)
+        {
+            for(unsigned int x = 0; x < NX_FINE; ++x)
+            {
+                field(origin[0] + x*Refinement::Spacing(), origin[1] + y*Refinement::Spacing(), origin[2] + z*Refinement::Spacing(), value);
+                for(unsigned int m = 0; m < 4; ++m)
+                {
+                    (*conFine)(x, y, z, m) = value[m];
+                }
+            }
+        }
+    }
+    InitLattice<false>(*con, *pop);
+    InitLattice<false>(*conFine, *popFine);
+
+    FluidCells<NX,NY,NZ> const fluid(*pop, wall);
+    FluidCells<NX_FINE,NY_FINE,NZ_FINE> const fluidFine(*popFine, wall);
+    Refinement patch(*pop, fluid, *popFine, fluidFine);
+
+    double const before = RefinementComposite(*pop, *popFine, patch);
+
+    auto const fineStep = [&](auto const isOdd)
+    {
+        CollideStreamBGK<decltype(isOdd)::value,false>(*conFine, *popFine, fluidFine);
+    };
+    for(unsigned int i = 0; i < COARSE_STEPS; i += 2)
+    {
+        patch. template Advance<false>(*pop, *popFine, [&](auto const)
+        {
+            CollideStreamBGK<false,false>(*con, *pop, fluid);
+        }, fineStep);
+        patch. template Advance<true>(*pop, *popFine, [&](auto const)
+        {
+            CollideStreamBGK<true,false>(*con, *pop, fluid);
+        }, fineStep);
+    }
+    double const after = RefinementComposite(*pop, *popFine, patch);
+
+    verificationResult result = {};
+    result.mass     = std::abs(after - before)/before;
+    result.isPassed = (result.mass <= EquivalenceTolerance<T>()) && (std::isfinite(result.mass) == true);
+
+    return result;
+}
+
+/**\fn        ScalarMass
+ * \brief     Sum of the concentration of the passive scalar over all fluid cells
+ *
+ * \param[in] scalar  continuum object holding the concentration and scalar flux
+ * \param[in] fluid   fluid cell list holding all fluid cells
+ * \return    mass of the passive scalar
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+double ScalarMass(Continuum<NX,NY,NZ,T> const& scalar, FluidCells<NX,NY,NZ> const& fluid)
+{
+    double mass = 0.0;
+    for(fluidCell const& cell: fluid.cells_)
+    {
+        mass += scalar(cell.x_n[1], cell.y_n[1], cell.z_n[1], 0);
+    }
+    return mass;
+}
+
+/**\fn        ReadExportFile
+ * \brief     Read an exported file of the macroscopic values and remove it afterwards
+ *
+ * \param[in] name     the file name of the export
+ * \param[in] step     the time step of the export
+ * \param[in] format   file format of the export (ExportFormat::Vtk or ExportFormat::Vti)
+ * \return    content of the file (empty if it does not exist)
+*/
+inline std::vector<char> ReadExportFile(std::string const& name, unsigned int const step, ExportFormat const format)
+{
+    std::string const fileName = OUTPUT_VTK_PATH + std::string("/") + name + std::string("_") + std::to_string(step) +
+                                 ((format == ExportFormat::Vti) ? std::string(".vti") : std::string(".vtk"));
+    std::vector<char> content;
+
+    FILE* const file = fopen(fileName.c_str(), "rb");
+    if (file != nullptr)
+    {
+        char buffer[4096];
+        size_t length = 0;
+        while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            content.insert(content.end(), buffer, buffer + length);
+        }
+        fclose(file);
+        remove(fileName.c_str());
+    }
+
+    return content;
+}
+
+/**\fn        VerifyConcurrentExport
+ * \brief     Export several fields at the same time step with one background writer per field (as the
+ *            driver does for the cases of an ensemble or the flow and the passive scalar) and compare every
+ *            file to the synchronous export of its field. Writers that do not keep their file names apart
+ *            overwrite each other. The files are written to and removed from OUTPUT_VTK_PATH.
+ *
+ * \tparam    NX       simulation domain resolution in x-direction
+ * \tparam    NY       simulation domain resolution in y-direction
+ * \tparam    NZ       simulation domain resolution in z-direction
+ * \tparam    T        floating data type used for simulation
+ * \tparam    N        number of fields
+ * \param[in] fields   the fields to be exported
+ * \param[in] names    the file names of the writers of the fields (pairwise distinct)
+ * \param[in] format   file format of the export (ExportFormat::Vtk or ExportFormat::Vti)
+ * \return    number of files that do not hold their own field
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T, size_t N>
+unsigned int VerifyConcurrentExport(std::array<Continuum<NX,NY,NZ,T> const*,N> const& fields, std::array<std::string,N> const& names,
+                                    ExportFormat const format)
+{
+    constexpr unsigned int step = VERIFY_STEPS;
+
+    {
+        std::array<std::unique_ptr<AsyncExport<NX,NY,NZ,T>>,N> writers;
+        for(size_t k = 0; k < N; ++k)
+        {
+            writers[k].reset(new AsyncExport<NX,NY,NZ,T>(format, names[k]));
+        }
+        for(size_t k = 0; k < N; ++k)
+        {
+            writers[k]->Submit(*fields[k], step);
+        }
+    }
+
+    unsigned int failures = 0;
+    for(size_t k = 0; k < N; ++k)
+    {
+        std::string const reference = "verification_export";
+        (format == ExportFormat::Vti) ? fields[k]->ExportVti(step, false, reference) : fields[k]->ExportVtk(step, reference);
+
+        std::vector<char> const expected = ReadExportFile(reference, step, format);
+        std::vector<char> const written  = ReadExportFile(names[k],  step, format);
+        failures += ((expected.empty() == false) && (written == expected)) ? 0 : 1;
+    }
+
+    return failures;
+}
+
+/**\fn        VerifyScalar
+ * \brief     Compare the flow of the fluid cell sweep coupled with a passive scalar to the fluid cell sweep
+ *            of the BGK operator and check the conservation of the mass of the scalar. The channel with the
+ *            cylinder is periodic in flow direction (no inlet and outlet) so that only the walls bound the
+ *            scalar. Optionally the flow and the scalar are exported at the same time as *.vtk- and *.vti-files
+ *            by one writer each (see VerifyConcurrentExport).
+ *
+ * \tparam    LT         static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP         streaming policy of the populations
+ * \param[in] isExport   export the flow and the scalar and compare the files (default = false)
+ * \return    result of the verification (deviation of the flow and relative change of the scalar mass)
+*/
+template <class LT, class SP>
+verificationResult VerifyScalar(bool const isExport = false)
+{
+    constexpr unsigned int NX = VERIFY_NX;
+    constexpr unsigned int NY = VERIFY_NY;
+    constexpr unsigned int NZ = VERIFY_NZ;
+    typedef typename Population<NX,NY,NZ,LT>::T T;
+
+    std::vector<boundaryElement<T>> wall;
+    std::vector<boundaryElement<T>> inlet;
+    std::vector<boundaryElement<T>> outlet;
+    VerificationChannel<NX,NY,NZ>(wall, inlet, outlet);
+
+    /// flow on its own
+    Population<NX,NY,NZ,LT,1,layout::AoS,storage::Native,SP> flow(1000.0, 0.05, NY/5);
+    FluidCells<NX,NY,NZ> const flowCells(flow, wall);
+    Continuum<NX,NY,NZ,T> reference;
+    RandomContinuum(reference);
+    InitLattice<false>(reference, flow);
+
+    /// flow and scalar with random concentration advected with the same velocity
+    Population<NX,NY,NZ,LT,2,layout::AoS,storage::Native,SP> pop(1000.0, 0.05, NY/5);
+    FluidCells<NX,NY,NZ> const fluid(pop, wall);
+    Continuum<NX,NY,NZ,T> con;
+    Continuum<NX,NY,NZ,T> scalar;
+    RandomContinuum(con);
+    RandomContinuum(scalar, 7);
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        for(unsigned int y = 0; y < NY; ++y)
+        {
+            for(unsigned int x = 0; x < NX; ++x)
+            {
+                for(unsigned int m = 1; m < con.NM_; ++m)
+                {
+                    scalar(x, y, z, m) = con(x, y, z, m);
+                }
+            }
+        }
+    }
+    InitLattice<false>(con,    pop, 0);
+    InitLattice<false>(scalar, pop, 1);
+    double const before = ScalarMass(scalar, fluid);
+
+    T const omega_s = ScalarCollisionFrequency(pop, static_cast<T>(0.7));
+    unsigned int const NT = 2*((VERIFY_STEPS + 1)/2);
+    for(unsigned int i = 0; i < NT; i += 2)
+    {
+        CollideStreamBGK<false>(reference, flow, flowCells);
+        CollideStreamBGK_Scalar<false>(con, scalar, pop, fluid, omega_s);
+        if (i + 2 < NT)
+        {
+            CollideStreamBGK<true>(reference, flow, flowCells);
+            CollideStreamBGK_Scalar<true>(con, scalar, pop, fluid, omega_s);
+        }
+        else
+        {
+            CollideStreamBGK<true,true>(reference, flow, flowCells);
+            CollideStreamBGK_Scalar<true,true>(con, scalar, pop, fluid, omega_s);
+        }
+    }
+    reference.SetZero(wall);
+    con.SetZero(wall);
+
+    verificationResult result = {};
+    result.isBitwise = (memcmp(con.M_, reference.M_, con.MEM_SIZE_) == 0);
+    for(size_t i = 0; i < con.MEM_SIZE_/sizeof(T); ++i)
+    {
+        result.deviation = std::max(result.deviation, static_cast<double>(std::abs(con.M_[i] - reference.M_[i])));
+    }
+    result.mass     = std::abs(ScalarMass(scalar, fluid) - before)/before;
+
+    /// the writers of the flow and the scalar export at the same time as in the driver
+    result.isExported = true;
+    if (isExport == true)
+    {
+        std::array<Continuum<NX,NY,NZ,T> const*,2> const fields = {&con, &scalar};
+        std::array<std::string,2> const names = {"verification_step", "verification_scalar"};
+        result.isExported = (VerifyConcurrentExport(fields, names, ExportFormat::Vtk) == 0) &&
+                            (VerifyConcurrentExport(fields, names, ExportFormat::Vti) == 0);
+    }
+    result.isPassed = (result.isBitwise == true) && (result.mass <= EquivalenceTolerance<T>()) &&
+                      (std::isfinite(result.mass) == true) && (result.isExported == true);
+
+    return result;
+}
+
+/**\fn        VerifyEnsemble
+ * \brief     Compare every case of an ensemble advanced by the fluid cell sweep with fused boundaries to a run
+ *            of the BGK operator with the Reynolds number and the random initial field of the case on its own.
+ *            Optionally the cases are exported at the same time as *.vtk- and *.vti-files by one writer per
+ *            case (see VerifyConcurrentExport).
+ *
+ * \tparam    LT         static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP         streaming policy of the populations
+ * \param[in] isExport   export the cases and compare the files (default = false)
+ * \return    result of the verification (maximum deviation over all cases)
+*/
+template <class LT, class SP>
+verificationResult VerifyEnsemble(bool const isExport = false)
+{
+    constexpr unsigned int NX = VERIFY_NX;
+    constexpr unsigned int NY = VERIFY_NY;
+    constexpr unsigned int NZ = VERIFY_NZ;
+    constexpr unsigned int K  = 4;
+    typedef typename Population<NX,NY,NZ,LT>::T T;
+    typedef FusedGuo<type::Velocity,orientation::Left, NX,NY,NZ,T> FusedInlet;
+    typedef FusedGuo<type::Pressure,orientation::Right,NX,NY,NZ,T> FusedOutlet;
+
+    std::vector<boundaryElement<T>> wall;
+    std::vector<boundaryElement<T>> inlet;
+    std::vector<boundaryElement<T>> outlet;
+    VerificationChannel<NX,NY,NZ>(wall, inlet, outlet);
+
+    std::array<T,K> const Re = {50.0, 100.0, 400.0, 1000.0};
+    std::array<T,K> U;
+    U.fill(0.05);
+    EnsembleParameters<K,LT,T> const param(Re, U, NY/5);
+
+    /// ensemble: every case starts from its own random field
+    Population<NX,NY,NZ,LT,K,layout::Interleaved,storage::Native,SP> pop(Re[0], U[0], NY/5);
+    FluidCells<NX,NY,NZ> const fluid(pop, wall);
+    auto const inletFused  = MakeEnsembleArray<K>(FusedInlet(fluid, inlet));
+    auto const outletFused = MakeEnsembleArray<K>(FusedOutlet(fluid, outlet));
+    EnsembleArray<Continuum<NX,NY,NZ,T>,K> con;
+    for(unsigned int k = 0; k < K; ++k)
+    {
+        RandomContinuum(con[k], 42 + k);
+        InitLattice<false>(con[k], pop, k);
+    }
+
+    auto const step = [&](auto const odd, auto const save)
+    {
+        for(unsigned int k = 0; k < K; ++k)
+        {
+            Guo<decltype(odd)::value>(inletFused[k],  pop, k);
+            Guo<decltype(odd)::value>(outletFused[k], pop, k);
+        }
+        CollideStreamBGK_Ensemble<decltype(odd)::value,decltype(save)::value>(con, pop, fluid, param, inletFused, outletFused);
+    };
+    unsigned int const NT = 2*((VERIFY_STEPS + 1)/2);
+    for(unsigned int i = 0; i < NT; i += 2)
+    {
+        step(std::false_type(), std::false_type());
+        (i + 2 < NT) ? step(std::true_type(), std::false_type()) : step(std::true_type(), std::true_type());
+    }
+
+    /// every case on its own
+    verificationResult result = {};
+    result.isBitwise = true;
+    for(unsigned int k = 0; k < K; ++k)
+    {
+        Population<NX,NY,NZ,LT,1,layout::AoS,storage::Native,SP> single(Re[k], U[k], NY/5);
+        FluidCells<NX,NY,NZ> const singleFluid(single, wall);
+        FusedInlet  const singleInlet(singleFluid, inlet);
+        FusedOutlet const singleOutlet(singleFluid, outlet);
+        Continuum<NX,NY,NZ,T> reference;
+        RandomContinuum(reference, 42 + k);
+        InitLattice<false>(reference, single);
+
+        auto const singleStep = [&](auto const odd, auto const save)
+        {
+            Guo<decltype(odd)::value>(singleInlet,  single);
+            Guo<decltype(odd)::value>(singleOutlet, single);
+            CollideStreamBGK<decltype(odd)::value,decltype(save)::value>(reference, single, singleFluid, 0u, singleInlet, singleOutlet);
+        };
+        for(unsigned int i = 0; i < NT; i += 2)
+        {
+            singleStep(std::false_type(), std::false_type());
+            (i + 2 < NT) ? singleStep(std::true_type(), std::false_type()) : singleStep(std::true_type(), std::true_type());
+        }
+
+        con[k].SetZero(wall);
+        reference.SetZero(wall);
+        result.isBitwise = result.isBitwise && (memcmp(con[k].M_, reference.M_, reference.MEM_SIZE_) == 0);
+        for(size_t i = 0; i < reference.MEM_SIZE_/sizeof(T); ++i)
+        {
+            result.deviation = std::max(result.deviation, static_cast<double>(std::abs(con[k].M_[i] - reference.M_[i])));
+        }
+    }
+
+    /// the writers of the cases export at the same time as in the driver
+    result.isExported = true;
+    if (isExport == true)
+    {
+        std::array<Continuum<NX,NY,NZ,T> const*,K> fields;
+        std::array<std::string,K> names;
+        for(unsigned int k = 0; k < K; ++k)
+        {
+            fields[k] = &con[k];
+            names[k]  = "verification_case" + std::to_string(k);
+        }
+        result.isExported = (VerifyConcurrentExport(fields, names, ExportFormat::Vtk) == 0) &&
+                            (VerifyConcurrentExport(fields, names, ExportFormat::Vti) == 0);
+    }
+    result.isPassed = (result.deviation <= EquivalenceTolerance<T>()) && (std::isfinite(result.deviation) == true) &&
+                      (result.isExported == true);
+
+    return result;
+}
+
+/**\struct checkpointVerification
+ * \brief  Result of the verification of a checkpoint and restart
+*/
+struct checkpointVerification
+{
+    double deviation; ///< maximum deviation of the restarted run from the uninterrupted run
+    size_t corrupted; ///< number of corrupted chunks found in the damaged checkpoint
+    bool   isBitwise; ///< the restarted run is bitwise identical to the uninterrupted run
+    bool   isPassed;  ///< the restart resumes the time step and parity exactly and the damage is found
+};
+
+/**\fn        VerifyCheckpoint
+ * \brief     Interrupt a run on the random periodic domain after half of the time steps by a checkpoint,
+ *            restart a new population object from it and compare the last time step to the uninterrupted
+ *            run. Afterwards a single byte of the checkpoint is flipped and the import has to find the
+ *            corrupted chunk. The checkpoint is written to and removed from BACKUP_EXPORT_PATH.
+ *
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP   streaming policy of the populations
+ * \return    result of the verification
+*/
+template <class LT, class SP>
+checkpointVerification VerifyCheckpoint()
+{
+    constexpr unsigned int NX = VERIFY_NX;
+    constexpr unsigned int NY = VERIFY_NY;
+    constexpr unsigned int NZ = VERIFY_NZ;
+    typedef Population<NX,NY,NZ,LT,1,layout::AoS,storage::Native,SP> POP;
+    typedef typename POP::T T;
+
+    unsigned int const NT   = 4*((VERIFY_STEPS + 1)/2);
+    std::string const  name = "verification_checkpoint";
+
+    /// advance pairs of time steps, the macroscopic values of the last one are saved
+    auto const advance = [NT](Continuum<NX,NY,NZ,T>& con, POP& pop, size_t const begin, size_t const end)
+    {
+        for(size_t i = begin; i < end; i += 2)
+        {
+            CollideStreamBGK<false>(con, pop);
+            (i + 2 < NT) ? CollideStreamBGK<true>(con, pop) : CollideStreamBGK<true,true>(con, pop);
+        }
+    };
+
+    Continuum<NX,NY,NZ,T> reference;
+    POP uninterrupted(1000.0, 0.05, NY/5);
+    RandomContinuum(reference);
+    InitLattice<false>(reference, uninterrupted);
+    advance(reference, uninterrupted, 0, NT);
+
+    Continuum<NX,NY,NZ,T> con;
+    POP interrupted(1000.0, 0.05, NY/5);
+    RandomContinuum(con);
+    InitLattice<false>(con, interrupted);
+    advance(con, interrupted, 0, NT/2);
+    interrupted.Export(name, NT/2, false);
+
+    /// restart from the checkpoint with the time step and parity it was written with
+    checkpointVerification result = {};
+    size_t step = 0;
+    bool   odd  = true;
+    POP restarted(1000.0, 0.05, NY/5);
+    size_t const damaged = restarted.Import(name, step, odd, false);
+    advance(con, restarted, step, NT);
+
+    result.isBitwise = (memcmp(con.M_, reference.M_, con.MEM_SIZE_) == 0);
+    for(size_t i = 0; i < con.MEM_SIZE_/sizeof(T); ++i)
+    {
+        result.deviation = std::max(result.deviation, static_cast<double>(std::abs(con.M_[i] - reference.M_[i])));
+    }
+
+    /// flip a single bit in the middle of the populations of the checkpoint
+    std::string const fileName = BACKUP_EXPORT_PATH + std::string("/") + name + std::string("_0.bin");
+    FILE* const file = fopen(fileName.c_str(), "r+b");
+    checkpointHeader header;
+    unsigned char byte = 0;
+    long const offset = (file != nullptr) && (fread(&header, sizeof(header), 1, file) == 1) ?
+                        static_cast<long>(header.dataOffset + header.size/2) : -1;
+    if ((offset < 0) || (fseek(file, offset, SEEK_SET) != 0) || (fread(&byte, 1, 1, file) != 1))
+    {
+        std::cerr << "Fatal error: Could not damage checkpoint '" << fileName << "'." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    byte ^= 1u;
+    fseek(file, offset, SEEK_SET);
+    fwrite(&byte, 1, 1, file);
+    fclose(file);
+
+    POP corrupted(1000.0, 0.05, NY/5);
+    result.corrupted = corrupted.Import(name, step, odd, false);
+    remove(fileName.c_str());
+
+    result.isPassed = (damaged == 0) && (step == NT/2) && (odd == false) && (result.isBitwise == true) && (result.corrupted == 1);
+
+    return result;
+}
+
+#endif // VERIFICATION_HPP_INCLUDED
@@ -0,0 +1,243 @@
+#ifndef ASYNC_EXPORT_HPP_INCLUDED
+#define ASYNC_EXPORT_HPP_INCLUDED
+
+/**
+ * \file     async_export.hpp
+ * \mainpage Class for exporting macroscopic values in the background
+ *
+ * \note     Writing the macroscopic values to disk takes longer than many time steps. Instead of
+ *           stalling the solver the values are copied into one of two snapshot buffers and serialised
+ *           by a dedicated writer thread while the solver keeps on stepping (double buffering). If the
+ *           writer falls behind and both buffers are still waiting to be written, the next export
+ *           blocks until a buffer becomes free again (backpressure), limiting the additional memory
+ *           to two copies of the macroscopic values.
+ *           If the export is reduced (subregion, stride, precision or compression) the snapshots are
+ *           passed through an output stage (see output_stage.hpp) by the writer thread.
+ * \warning  The writer thread competes with the OpenMP threads for the cores: leave a core idle if the
+ *           export takes a significant share of the run time.
+*/
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "continuum.hpp"
+#include "output_stage.hpp"
+#include "../general/settings.hpp"
+
+
+/**\class  AsyncExport
+ * \brief  Double-buffered background export of the macroscopic values
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam T    floating data type used for simulation
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T = double>
+class AsyncExport
+{
+    public:
+        static constexpr unsigned int NUM_BUFFERS_ = 2; ///< number of snapshot buffers
+
+        /**\brief Class constructor: allocate the snapshot buffers and start the writer thread
+         * \param format   file format of the export (default = ExportFormat::Vtk)
+         * \param name     file name of the export (default = "step")
+         * \param compress compress *.vti-files of the full field with zlib (default = false)
+         * \param output   reduction of the exported values (default = full field)
+        */
+        AsyncExport(ExportFormat const format = ExportFormat::Vtk, std::string const name = "step", bool const compress = false,
+                    outputSettings const& output = outputSettings()):
+            format_(format), name_(name), compress_(compress), stage_((output.IsIdentity() == true) ? nullptr : new OutputStage<NX,NY,NZ,T>(output)),
+            buffers_(), isFree_(), pending_(), mutex_(), written_(), submitted_(), writer_()
+        {
+            for(unsigned int b = 0; b < NUM_BUFFERS_; ++b)
+            {
+                buffers_[b].reset(new Continuum<NX,NY,NZ,T>());
+                isFree_[b] = true;
+            }
+
+            writer_ = std::thread(&AsyncExport::Write, this);
+        }
+
+        /**\brief Class destructor: write all outstanding snapshots and stop the writer thread
+        */
+        ~AsyncExport()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            submitted_.notify_one();
+            writer_.join();
+        }
+
+        AsyncExport(AsyncExport const&) = delete;
+        AsyncExport& operator= (AsyncExport const&) = delete;
+
+        /// hand macroscopic values over to the writer thread and wait for outstanding snapshots
+        void   Submit(Continuum<NX,NY,NZ,T> const& con, unsigned int const step);
+        void   Finish();
+
+        /// time the solver had to wait for a free buffer
+        double GetStallTime() const;
+
+    private:
+        ExportFormat const format_;
+        std::string  const name_;
+        bool         const compress_;
+
+        /// reduction of the exported values (only accessed by the writer thread, nullptr = full field)
+        std::unique_ptr<OutputStage<NX,NY,NZ,T>> stage_;
+
+        /// snapshot buffers, their state and the queue of snapshots (buffer, time step) waiting to be written
+        std::array<std::unique_ptr<Continuum<NX,NY,NZ,T>>,NUM_BUFFERS_> buffers_;
+        std::array<bool,NUM_BUFFERS_>                                    isFree_;
+        std::deque<std::pair<unsigned int,unsigned int>>                 pending_;
+
+        /// synchronisation between solver and writer thread
+        mutable std::mutex      mutex_;
+        std::condition_variable written_;
+        std::condition_variable submitted_;
+        bool                    stop_  = false;
+        double                  stall_ = 0.0;
+        std::thread             writer_;
+
+        /// loop of the writer thread
+        void Write();
+};
+
+
+/**\fn        Submit
+ * \brief     Copy the macroscopic values into a free snapshot buffer and queue it for export. Blocks
+ *            if the writer thread is still busy with all buffers.
+ *
+ * \param[in] con    continuum object holding macroscopic variables
+ * \param[in] step   the current time step that will be used for the name
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void AsyncExport<NX,NY,NZ,T>::Submit(Continuum<NX,NY,NZ,T> const& con, unsigned int const step)
+{
+    unsigned int buffer = 0;
+
+    {
+        std::chrono::high_resolution_clock::time_point const start = std::chrono::high_resolution_clock::now();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        written_.wait(lock, [this]{ return std::find(isFree_.begin(), isFree_.end(), true) != isFree_.end(); });
+        buffer = static_cast<unsigned int>(std::find(isFree_.begin(), isFree_.end(), true) - isFree_.begin());
+        isFree_[buffer] = false;
+
+        stall_ += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    /// copy with all threads: the snapshot is not accessed by the writer thread until it is queued
+    size_t const length = con.MEM_SIZE_/sizeof(T);
+    T const* const source = con.M_;
+    T* const  destination = buffers_[buffer]->M_;
+
+    #pragma omp parallel for default(none) firstprivate(length, source, destination) schedule(static)
+    for(size_t i = 0; i < length; ++i)
+    {
+        destination[i] = source[i];
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(std::make_pair(buffer, step));
+    }
+    submitted_.notify_one();
+}
+
+/**\fn        Finish
+ * \brief     Wait until all queued snapshots have been written to disk
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void AsyncExport<NX,NY,NZ,T>::Finish()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    written_.wait(lock, [this]{ return std::find(isFree_.begin(), isFree_.end(), false) == isFree_.end(); });
+}
+
+/**\fn        GetStallTime
+ * \brief     Total time the solver had to wait for a free snapshot buffer
+ *
+ * \return    stall time in seconds
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+double AsyncExport<NX,NY,NZ,T>::GetStallTime() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stall_;
+}
+
+/**\fn        Write
+ * \brief     Loop of the writer thread: serialise queued snapshots in order of submission until the
+ *            export is stopped and all snapshots have been written
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void AsyncExport<NX,NY,NZ,T>::Write()
+{
+    while (true)
+    {
+        std::pair<unsigned int,unsigned int> snapshot;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            submitted_.wait(lock, [this]{ return (pending_.empty() == false) || (stop_ == true); });
+
+            if (pending_.empty() == true)
+            {
+                return;
+            }
+
+            snapshot = pending_.front();
+            pending_.pop_front();
+        }
+
+        if (stage_ != nullptr)
+        {
+            stage_->Gather(*buffers_[snapshot.first]);
+
+            if (format_ == ExportFormat::Bin)
+            {
+                stage_->Export(name_, snapshot.second);
+            }
+            else if (format_ == ExportFormat::Vti)
+            {
+                stage_->ExportVti(snapshot.second, name_);
+            }
+            else
+            {
+                stage_->ExportVtk(snapshot.second, name_);
+            }
+        }
+        else if (format_ == ExportFormat::Bin)
+        {
+            buffers_[snapshot.first]->Export(name_, snapshot.second);
+        }
+        else if (format_ == ExportFormat::Vti)
+        {
+            buffers_[snapshot.first]->ExportVti(snapshot.second, compress_, name_);
+        }
+        else
+        {
+            buffers_[snapshot.first]->ExportVtk(snapshot.second, name_);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            isFree_[snapshot.first] = true;
+        }
+        written_.notify_all();
+    }
+}
+
+#endif // ASYNC_EXPORT_HPP_INCLUDED
@@ -10,6 +10,8 @@
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
 #include <memory>
 #include <stdlib.h>
@@ -17,9 +19,19 @@
 #include <vector>
 
 #include "../population/boundary/boundary.hpp"
+#include "../general/constexpr_func.hpp"
 #include "../general/memory_alignment.hpp"
 
 
+/**\enum   ExportFormat
+ * \brief  File formats of the macroscopic values
+ *         - Bin: raw binary *.bin-file of all macroscopic values (fast, convert afterwards)
+ *         - Vtk: binary legacy *.vtk-file holding density and velocity vector
+ *         - Vti: XML image data *.vti-file with appended raw data (optionally zlib-compressed)
+*/
+enum class ExportFormat { Bin, Vtk, Vti };
+
+
 /**\class  Continuum
  * \brief  Class for the macroscopic variables
  *
@@ -35,8 +47,15 @@ class Continuum
         static constexpr unsigned int NM_ = 4; // number of macroscopic values: rho, ux, uy, uz
         static constexpr size_t MEM_SIZE_ = sizeof(T)*NZ*NY*NX*static_cast<size_t>(NM_); // size of array in byte
 
+        /// parallelism: 3D blocks (same as the ones of the populations)
+        static constexpr unsigned int   BLOCK_SIZE_ = LOOP_BLOCK_SIZE;                                  ///< loop block size
+        static constexpr unsigned int NUM_BLOCKS_Z_ = cef::ceil(static_cast<double>(NZ) / BLOCK_SIZE_); ///< number of blocks in each dimension
+        static constexpr unsigned int NUM_BLOCKS_Y_ = cef::ceil(static_cast<double>(NY) / BLOCK_SIZE_);
+        static constexpr unsigned int NUM_BLOCKS_X_ = cef::ceil(static_cast<double>(NX) / BLOCK_SIZE_);
+        static constexpr unsigned int   NUM_BLOCKS_ = NUM_BLOCKS_X_*NUM_BLOCKS_Y_*NUM_BLOCKS_Z_;        ///< total number of blocks
+
         /// population allocated in heap
-        T* const M_ = static_cast<T*>(aligned_alloc(CACHE_LINE, MEM_SIZE_));
+        T* const M_ = static_cast<T*>(AllocateAligned(MEM_SIZE_));
 
 
         /**\brief Class constructor
@@ -48,13 +67,15 @@ class Continuum
                 std::cerr << "Fatal error: Continuum could not be allocated." << std::endl;
                 exit(EXIT_FAILURE);
             }
+
+            FirstTouch();
         }
 
         /**\brief Class destructor
 		*/
         ~Continuum()
         {
-            free(M_);
+            FreeAligned(M_);
         }
 
         /// lattice indexing functions
@@ -69,12 +90,59 @@ class Continuum
         void SetZero(std::vector<boundaryElement<T>> const& boundary);
         void Export(std::string const name, unsigned int const step) const;
         void ExportScalarVtk(unsigned int const m, std::string const name, unsigned int const step) const;
-        void ExportVtk(unsigned int const step) const;
+        void ExportVtk(unsigned int const step, std::string const name = "Export") const;
+        void ExportVti(unsigned int const step, bool const compress = false, std::string const name = "Export") const;
 
         /// import time step from disk
         void Import(std::string const name, unsigned int const step);
+
+    private:
+        /// NUMA-aware placement of the macroscopic values
+        void FirstTouch();
+
+        /// binary encoding of the exported files
+        void ExportVtkHeader(FILE* const exportFile, std::string const title) const;
+        void ExportVtkData(FILE* const exportFile, unsigned int const first, unsigned int const components) const;
+        std::vector<unsigned char> VtiData(unsigned int const first, unsigned int const components, bool const compress) const;
+        static inline uint32_t BigEndianFloat(float const value);
 };
 
+
+/**\fn        FirstTouch
+ * \brief     Touch the macroscopic values for the first time with the same block-to-thread mapping as
+ *            the collision kernels so that every page is placed on the NUMA node of the thread working on it.
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void Continuum<NX,NY,NZ,T>::FirstTouch()
+{
+    #pragma omp parallel for default(none) schedule(static,1)
+    for(unsigned int block = 0; block < NUM_BLOCKS_; ++block)
+    {
+        unsigned int const z_start = BLOCK_SIZE_ * (block / (NUM_BLOCKS_X_*NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + BLOCK_SIZE_, NZ);
+
+        for(unsigned int z = z_start; z < z_end; ++z)
+        {
+            unsigned int const y_start = BLOCK_SIZE_*((block % (NUM_BLOCKS_X_*NUM_BLOCKS_Y_)) / NUM_BLOCKS_X_);
+            unsigned int const   y_end = std::min(y_start + BLOCK_SIZE_, NY);
+
+            for(unsigned int y = y_start; y < y_end; ++y)
+            {
+                unsigned int const x_start = BLOCK_SIZE_*(block % NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + BLOCK_SIZE_, NX);
+
+                for(unsigned int x = x_start; x < x_end; ++x)
+                {
+                    for(unsigned int m = 0; m < NM_; ++m)
+                    {
+                        M_[SpatialToLinear(x, y, z, m)] = 0.0;
+                    }
+                }
+            }
+        }
+    }
+}
+
 #include "continuum_indexing.hpp"
 #include "continuum_import.hpp"
 #include "continuum_export.hpp"
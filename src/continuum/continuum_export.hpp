@@ -6,12 +6,18 @@
  * \mainpage Class members for exporting macroscopic values
 */
 
+#include <array>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string.h>
 #include <sys/stat.h>
 #include <vector>
+#ifdef USE_ZLIB
+    #include <zlib.h>
+#endif
 
 #include "../population/boundary/boundary.hpp"
 #include "../general/paths.hpp"
@@ -63,12 +69,79 @@ void Continuum<NX,NY,NZ,T>::Export(std::string const name, unsigned int const st
 }
 
 
+/**\fn        ExportVtkData
+ * \brief     Write some of the macroscopic values of all cells as big-endian single precision binary
+ *            data of a legacy *.vtk-file. The values are converted plane by plane and written in
+ *            large contiguous chunks.
+ *
+ * \param[in] exportFile   the file the data should be written to
+ * \param[in] first        index of the first macroscopic value that should be written
+ * \param[in] components   number of consecutive macroscopic values per cell (e.g. 1 scalar, 3 vector)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void Continuum<NX,NY,NZ,T>::ExportVtkData(FILE* const exportFile, unsigned int const first, unsigned int const components) const
+{
+    size_t const planeLength = static_cast<size_t>(NX)*NY*components;
+    ArenaScope scratch(ScratchArena());
+    uint32_t* const plane = scratch.Allocate<uint32_t>(planeLength);
+
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        size_t i = 0;
+        for(unsigned int y = 0; y < NY; ++y)
+        {
+            for(unsigned int x = 0; x < NX; ++x)
+            {
+                for(unsigned int m = first; m < first + components; ++m)
+                {
+                    plane[i++] = BigEndianFloat(static_cast<float>(M_[SpatialToLinear(x, y, z, m)]));
+                }
+            }
+        }
+        fwrite(plane, sizeof(uint32_t), planeLength, exportFile);
+    }
+    fprintf(exportFile, "\n");
+}
+
+/**\fn        ExportVtkHeader
+ * \brief     Write the header and the coordinates of the rectilinear grid of a binary legacy *.vtk-file
+ *
+ * \param[in] exportFile   the file the header should be written to
+ * \param[in] title        title of the data set
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void Continuum<NX,NY,NZ,T>::ExportVtkHeader(FILE* const exportFile, std::string const title) const
+{
+    fprintf(exportFile, "# vtk DataFile Version 3.0\n");
+    fprintf(exportFile, "%s\n", title.c_str());
+    fprintf(exportFile, "BINARY\n");
+    fprintf(exportFile, "DATASET RECTILINEAR_GRID\n");
+    fprintf(exportFile, "DIMENSIONS %u %u %u\n", NX, NY, NZ);
+
+    std::array<unsigned int,3> const resolution = {NX, NY, NZ};
+    std::array<char,3>         const axis       = {'X', 'Y', 'Z'};
+    for(unsigned int a = 0; a < resolution.size(); ++a)
+    {
+        std::vector<uint32_t> coordinates(resolution[a]);
+        for(unsigned int i = 0; i < resolution[a]; ++i)
+        {
+            coordinates[i] = BigEndianFloat(static_cast<float>(i));
+        }
+
+        fprintf(exportFile, "%c_COORDINATES %u float\n", axis[a], resolution[a]);
+        fwrite(coordinates.data(), sizeof(uint32_t), coordinates.size(), exportFile);
+        fprintf(exportFile, "\n");
+    }
+
+    size_t const numberOfCells = static_cast<size_t>(NX)*static_cast<size_t>(NY)*static_cast<size_t>(NZ);
+    fprintf(exportFile, "POINT_DATA %zu\n", numberOfCells);
+}
+
 /**\fn        ExportScalarVtk
- * \brief     Export arbitrary scalar at current time step to a *.vtk-file that can then be read
+ * \brief     Export arbitrary scalar at current time step to a binary *.vtk-file that can then be read
  *            by visualisation applications like ParaView.
- * \warning   *.vtk export is comparably slow! Better export to .bin-files and then convert them
- *            to *.vtk-files with the external converter app afterwards.
  *
+ * \param[in] m      the index of the macroscopic value that should be exported
  * \param[in] name   the export file name of the scalar
  * \param[in] step   the current time step that will be used for the name
 */
@@ -80,48 +153,12 @@ void Continuum<NX,NY,NZ,T>::ExportScalarVtk(unsigned int const m, std::string co
     if (stat(OUTPUT_VTK_PATH.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
     {
         std::string const fileName = OUTPUT_VTK_PATH + std::string("/") + name + std::string("_") + std::to_string(step) + std::string(".vtk");
-        FILE * const exportFile = fopen(fileName.c_str(), "w");
-
-        fprintf(exportFile, "# vtk DataFile Version 3.0\n");
-        fprintf(exportFile, "LBM CFD simulation scalar %s\n", name.c_str());
-        fprintf(exportFile, "ASCII\n");
-        fprintf(exportFile, "DATASET RECTILINEAR_GRID\n");
-
-        fprintf(exportFile, "DIMENSIONS %u %u %u\n", NX, NY, NZ);
-        fprintf(exportFile, "X_COORDINATES %u float\n", NX);
-        for(unsigned int x = 0; x < NX; ++x)
-        {
-            fprintf(exportFile,"%u ", x);
-        }
-        fprintf(exportFile, "\n");
-        fprintf(exportFile, "Y_COORDINATES %u float\n", NY);
-        for(unsigned int y = 0; y < NY; ++y)
-        {
-            fprintf(exportFile,"%u ", y);
-        }
-        fprintf(exportFile, "\n");
-        fprintf(exportFile, "Z_COORDINATES %u float\n", NZ);
-        for(unsigned int z = 0; z < NZ; ++z)
-        {
-            fprintf(exportFile, "%u ", z);
-        }
-        fprintf(exportFile, "\n");
-
-        size_t const numberOfCells = static_cast<size_t>(NX)*static_cast<size_t>(NY)*static_cast<size_t>(NZ);
-        fprintf(exportFile, "POINT_DATA %zu\n", numberOfCells);
+        FILE * const exportFile = fopen(fileName.c_str(), "wb");
 
+        ExportVtkHeader(exportFile, std::string("LBM CFD simulation scalar ") + name);
         fprintf(exportFile, "SCALARS transport_scalar float 1\n");
         fprintf(exportFile, "LOOKUP_TABLE default\n");
-        for(unsigned int z = 0; z < NZ; ++z)
-        {
-            for(unsigned int y = 0; y < NY; ++y)
-            {
-                for(unsigned int x = 0; x < NX; ++x)
-                {
-                    fprintf(exportFile, "%f\n", M_[SpatialToLinear(x, y, z, m)]);
-                }
-            }
-        }
+        ExportVtkData(exportFile, m, 1);
 
         fclose(exportFile);
     }
@@ -133,77 +170,157 @@ void Continuum<NX,NY,NZ,T>::ExportScalarVtk(unsigned int const m, std::string co
 }
 
 /**\fn        ExportVtk
- * \brief     Export velocity and density at current time step to a *.vtk-file that can then be
+ * \brief     Export velocity and density at current time step to a binary *.vtk-file that can then be
  *            read by visualisation applications like ParaView.
- * \warning   *.vtk export is comparably slow! Better export to .bin-files and then convert them
- *            to *.vtk-files with the external converter app afterwards.
  *
  * \param[in] step   the current time step that will be used for the name
+ * \param[in] name   the export file name (default = "Export")
 */
 template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
-void Continuum<NX,NY,NZ,T>::ExportVtk(unsigned int const step) const
+void Continuum<NX,NY,NZ,T>::ExportVtk(unsigned int const step, std::string const name) const
 {
     struct stat info;
 
     if (stat(OUTPUT_VTK_PATH.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
     {
-        std::string const fileName = OUTPUT_VTK_PATH + std::string("/Export_") + std::to_string(step) + std::string(".vtk");
-        FILE * const exportFile = fopen(fileName.c_str(), "w");
+        std::string const fileName = OUTPUT_VTK_PATH + std::string("/") + name + std::string("_") + std::to_string(step) + std::string(".vtk");
+        FILE * const exportFile = fopen(fileName.c_str(), "wb");
 
-        fprintf(exportFile, "# vtk DataFile Version 3.0\n");
-        fprintf(exportFile, "LBM CFD simulation velocity\n");
-        fprintf(exportFile, "ASCII\n");
-        fprintf(exportFile, "DATASET RECTILINEAR_GRID\n");
+        ExportVtkHeader(exportFile, "LBM CFD simulation velocity");
+        fprintf(exportFile, "SCALARS density_variation float 1\n");
+        fprintf(exportFile, "LOOKUP_TABLE default\n");
+        ExportVtkData(exportFile, 0, 1);
+        fprintf(exportFile, "VECTORS velocity_vector float\n");
+        ExportVtkData(exportFile, 1, 3);
 
-        fprintf(exportFile, "DIMENSIONS %u %u %u\n", NX, NY, NZ);
-        fprintf(exportFile, "X_COORDINATES %u float\n", NX);
-        for(unsigned int x = 0; x < NX; ++x)
-        {
-            fprintf(exportFile,"%u ", x);
-        }
-        fprintf(exportFile, "\n");
-        fprintf(exportFile, "Y_COORDINATES %u float\n", NY);
-        for(unsigned int y = 0; y < NY; ++y)
-        {
-            fprintf(exportFile,"%u ", y);
-        }
-        fprintf(exportFile, "\n");
-        fprintf(exportFile, "Z_COORDINATES %u float\n", NZ);
-        for(unsigned int z = 0; z < NZ; ++z)
-        {
-            fprintf(exportFile, "%u ", z);
-        }
-        fprintf(exportFile, "\n");
+        fclose(exportFile);
+    }
+    else
+    {
+        std::cerr << "Fatal error: Directory '" << OUTPUT_VTK_PATH << "' not found." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
 
-        size_t const numberOfCells = static_cast<size_t>(NX)*static_cast<size_t>(NY)*static_cast<size_t>(NZ);
-        fprintf(exportFile, "POINT_DATA %zu\n", numberOfCells);
+/**\fn        VtiData
+ * \brief     Encode some of the macroscopic values of all cells as appended raw data of a *.vti-file:
+ *            a 64-bit byte count followed by the values in floating data type of the simulation or,
+ *            if compressed, a header of the zlib blocks (one per plane) followed by the blocks.
+ *
+ * \param[in] first        index of the first macroscopic value that should be encoded
+ * \param[in] components   number of consecutive macroscopic values per cell (e.g. 1 scalar, 3 vector)
+ * \param[in] compress     compress the data with zlib (Boolean true/false)
+ * \return    encoded data
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+std::vector<unsigned char> Continuum<NX,NY,NZ,T>::VtiData(unsigned int const first, unsigned int const components, bool const compress) const
+{
+    size_t const planeSize = static_cast<size_t>(NX)*NY*components*sizeof(T);
+    ArenaScope scratch(ScratchArena());
+    T* const plane = scratch.Allocate<T>(static_cast<size_t>(NX)*NY*components);
+    std::vector<unsigned char> data;
 
-        fprintf(exportFile, "SCALARS density_variation float 1\n");
-        fprintf(exportFile, "LOOKUP_TABLE default\n");
-        for(unsigned int z = 0; z < NZ; ++z)
+    /// header: byte count if uncompressed, number of blocks, block size, last block size and compressed sizes otherwise
+    std::vector<uint64_t> header;
+    if (compress == false)
+    {
+        header.push_back(static_cast<uint64_t>(planeSize)*NZ);
+    }
+    else
+    {
+        header.assign(3 + NZ, 0);
+        header[0] = NZ;
+        header[1] = planeSize;
+    }
+    data.resize(header.size()*sizeof(uint64_t));
+
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        size_t i = 0;
+        for(unsigned int y = 0; y < NY; ++y)
         {
-            for(unsigned int y = 0; y < NY; ++y)
+            for(unsigned int x = 0; x < NX; ++x)
             {
-                for(unsigned int x = 0; x < NX; ++x)
+                for(unsigned int m = first; m < first + components; ++m)
                 {
-                    fprintf(exportFile, "%f\n", M_[SpatialToLinear(x, y, z, 0)]);
+                    plane[i++] = M_[SpatialToLinear(x, y, z, m)];
                 }
             }
         }
 
-        fprintf(exportFile, "VECTORS velocity_vector float\n");
-        for(unsigned int z = 0; z < NZ; ++z)
-        {
-            for(unsigned int y = 0; y < NY; ++y)
+        unsigned char const* const raw = reinterpret_cast<unsigned char const*>(plane);
+
+        #ifdef USE_ZLIB
+            if (compress == true)
             {
-                for(unsigned int x = 0; x < NX; ++x)
-                {
-                    fprintf(exportFile, "%f %f %f\n", M_[SpatialToLinear(x, y, z, 1)],
-                                                      M_[SpatialToLinear(x, y, z, 2)],
-                                                      M_[SpatialToLinear(x, y, z, 3)]);
-                }
+                size_t const offset = data.size();
+                uLongf compressedSize = compressBound(planeSize);
+                data.resize(offset + compressedSize);
+                compress2(data.data() + offset, &compressedSize, raw, planeSize, Z_BEST_SPEED);
+                data.resize(offset + compressedSize);
+                header[3 + z] = compressedSize;
+                continue;
             }
-        }
+        #endif
+
+        data.insert(data.end(), raw, raw + planeSize);
+    }
+
+    memcpy(data.data(), header.data(), header.size()*sizeof(uint64_t));
+    return data;
+}
+
+/**\fn        ExportVti
+ * \brief     Export velocity and density at current time step to a XML image data *.vti-file with
+ *            appended raw data in the floating data type of the simulation that can be read by
+ *            visualisation applications like ParaView.
+ * \note      Compression requires zlib ('make ZLIB=true' defines USE_ZLIB), otherwise the data is
+ *            written uncompressed.
+ *
+ * \param[in] step       the current time step that will be used for the name
+ * \param[in] compress   compress the data with zlib (default = false)
+ * \param[in] name       the export file name (default = "Export")
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void Continuum<NX,NY,NZ,T>::ExportVti(unsigned int const step, bool const compress, std::string const name) const
+{
+    struct stat info;
+
+    if (stat(OUTPUT_VTK_PATH.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+    {
+        #ifdef USE_ZLIB
+            bool const isCompressed = compress;
+        #else
+            bool const isCompressed = false;
+            (void)compress;
+        #endif
+
+        std::vector<unsigned char> const density  = VtiData(0, 1, isCompressed);
+        std::vector<unsigned char> const velocity = VtiData(1, 3, isCompressed);
+
+        char const* const type = (sizeof(T) == sizeof(float)) ? "Float32" : "Float64";
+        char const* const byteOrder = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) ? "LittleEndian" : "BigEndian";
+
+        std::string const fileName = OUTPUT_VTK_PATH + std::string("/") + name + std::string("_") + std::to_string(step) + std::string(".vti");
+        FILE * const exportFile = fopen(fileName.c_str(), "wb");
+
+        fprintf(exportFile, "<?xml version=\"1.0\"?>\n");
+        fprintf(exportFile, "<VTKFile type=\"ImageData\" version=\"1.0\" byte_order=\"%s\" header_type=\"UInt64\"%s>\n",
+                byteOrder, (isCompressed == true) ? " compressor=\"vtkZLibDataCompressor\"" : "");
+        fprintf(exportFile, "  <ImageData WholeExtent=\"0 %u 0 %u 0 %u\" Origin=\"0 0 0\" Spacing=\"1 1 1\">\n", NX - 1, NY - 1, NZ - 1);
+        fprintf(exportFile, "    <Piece Extent=\"0 %u 0 %u 0 %u\">\n", NX - 1, NY - 1, NZ - 1);
+        fprintf(exportFile, "      <PointData Scalars=\"density_variation\" Vectors=\"velocity_vector\">\n");
+        fprintf(exportFile, "        <DataArray type=\"%s\" Name=\"density_variation\" NumberOfComponents=\"1\" format=\"appended\" offset=\"0\"/>\n", type);
+        fprintf(exportFile, "        <DataArray type=\"%s\" Name=\"velocity_vector\" NumberOfComponents=\"3\" format=\"appended\" offset=\"%zu\"/>\n", type, density.size());
+        fprintf(exportFile, "      </PointData>\n");
+        fprintf(exportFile, "    </Piece>\n");
+        fprintf(exportFile, "  </ImageData>\n");
+        fprintf(exportFile, "  <AppendedData encoding=\"raw\">\n");
+        fprintf(exportFile, "_");
+        fwrite(density.data(),  1, density.size(),  exportFile);
+        fwrite(velocity.data(), 1, velocity.size(), exportFile);
+        fprintf(exportFile, "\n  </AppendedData>\n");
+        fprintf(exportFile, "</VTKFile>\n");
 
         fclose(exportFile);
     }
@@ -214,4 +331,24 @@ void Continuum<NX,NY,NZ,T>::ExportVtk(unsigned int const step) const
     }
 }
 
+/**\fn        BigEndianFloat
+ * \brief     Bit pattern of a single precision value in big-endian byte order as required by
+ *            binary legacy *.vtk-files
+ *
+ * \param[in] value   the single precision value
+ * \return    bit pattern in big-endian byte order
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+inline uint32_t Continuum<NX,NY,NZ,T>::BigEndianFloat(float const value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+
+    #if (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        bits = __builtin_bswap32(bits);
+    #endif
+
+    return bits;
+}
+
 #endif // CONTINUUM_EXPORT_HPP_INCLUDED
@@ -0,0 +1,79 @@
+#ifndef CONTINUUM_GPU_HPP_INCLUDED
+#define CONTINUUM_GPU_HPP_INCLUDED
+
+/**
+ * \file     continuum_gpu.hpp
+ * \mainpage Class for continuum properties in device memory
+ *
+ * \note     The macroscopic values are written by the device kernels and only copied to the host on
+ *           export steps. The linear memory layout is identical to the one of Continuum.
+*/
+
+#include "continuum.hpp"
+#include "../general/gpu.hpp"
+
+
+/**\class  DeviceContinuum
+ * \brief  Class for the macroscopic variables in device memory
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam T    floating data type used for simulation
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T = double>
+class DeviceContinuum
+{
+    public:
+        static constexpr unsigned int NM_ = Continuum<NX,NY,NZ,T>::NM_;       // number of macroscopic values: rho, ux, uy, uz
+        static constexpr size_t MEM_SIZE_ = Continuum<NX,NY,NZ,T>::MEM_SIZE_; // size of array in byte
+
+        /// macroscopic values in device memory
+        T* M_ = nullptr;
+
+
+        /**\brief Class constructor
+        */
+        DeviceContinuum()
+        {
+            GPU_CHECK(gpuMalloc(reinterpret_cast<void**>(&M_), MEM_SIZE_));
+            GPU_CHECK(gpuMemset(M_, 0, MEM_SIZE_));
+        }
+
+        /**\brief Class destructor
+        */
+        ~DeviceContinuum()
+        {
+            gpuFree(M_);
+        }
+
+        DeviceContinuum(DeviceContinuum const&) = delete;
+        DeviceContinuum& operator= (DeviceContinuum const&) = delete;
+
+        /**\fn         CopyTo
+         * \brief      Copy the macroscopic values from the device to the host for export
+         *
+         * \param[out] con   continuum object holding macroscopic variables on the host
+        */
+        void CopyTo(Continuum<NX,NY,NZ,T>& con) const
+        {
+            GPU_CHECK(gpuMemcpy(con.M_, M_, MEM_SIZE_, gpuMemcpyDeviceToHost));
+        }
+
+        /**\fn        SpatialToLinear
+         * \brief     Convert 3D coordinates to scalar index (identical to Continuum::SpatialToLinear)
+         *
+         * \param[in] x   x coordinate of cell
+         * \param[in] y   y coordinate of cell
+         * \param[in] z   z coordinate of cell
+         * \param[in] m   macroscopic value (rho, ux, uy, uz)
+         * \return    requested linear index
+        */
+        static inline HOST_DEVICE size_t SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
+                                                         unsigned int const m)
+        {
+            return ((static_cast<size_t>(z)*NY + y)*NX + x)*NM_ + m;
+        }
+};
+
+#endif // CONTINUUM_GPU_HPP_INCLUDED
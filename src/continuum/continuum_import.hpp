@@ -25,10 +25,10 @@ void Continuum<NX,NY,NZ,T>::Import(std::string const name, unsigned int const st
 {
     std::string const fileName = OUTPUT_BIN_PATH + std::string("/") + name + std::string("_") + std::to_string(step) + std::string(".bin");
 
-    if(fopen(fileName.c_str(), "rb+") != nullptr)
+    FILE * const importFile = fopen(fileName.c_str(), "rb");
+
+    if((importFile != nullptr) && (fread(M_, 1, MEM_SIZE_, importFile) == MEM_SIZE_))
     {
-        FILE * const importFile = fopen(fileName.c_str(), "rb+");
-        fread(M_, 1, MEM_SIZE_, importFile);
         fclose(importFile);
     }
     else
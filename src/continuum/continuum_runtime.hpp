@@ -0,0 +1,362 @@
+#ifndef CONTINUUM_RUNTIME_HPP_INCLUDED
+#define CONTINUUM_RUNTIME_HPP_INCLUDED
+
+/**
+ * \file     continuum_runtime.hpp
+ * \mainpage Class for continuum properties of a domain whose size is only known at run time
+ *
+ * \note     Counterpart of Continuum for the populations of population_runtime.hpp: the same linear
+ *           layout of the macroscopic values and the same *.bin- and *.vtk-files, only the resolution
+ *           is a run-time value.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#include <sys/stat.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../population/boundary/boundary.hpp"
+#include "../general/memory_alignment.hpp"
+#include "../general/paths.hpp"
+
+
+/**\class  RuntimeContinuum
+ * \brief  Macroscopic variables of a domain whose resolution is given at run time
+ *
+ * \tparam T    floating data type used for simulation
+*/
+template <typename T = double>
+class RuntimeContinuum
+{
+    public:
+        static constexpr unsigned int NM_ = 4; // number of macroscopic values: rho, ux, uy, uz
+
+        /// resolution of the domain
+        unsigned int const NX_;
+        unsigned int const NY_;
+        unsigned int const NZ_;
+        size_t       const MEM_SIZE_; // size of array in byte
+
+        /// parallelism: 3D blocks (same as the ones of the populations)
+        static constexpr unsigned int BLOCK_SIZE_ = LOOP_BLOCK_SIZE; ///< loop block size
+        unsigned int const NUM_BLOCKS_Z_;                            ///< number of blocks in each dimension
+        unsigned int const NUM_BLOCKS_Y_;
+        unsigned int const NUM_BLOCKS_X_;
+        unsigned int const NUM_BLOCKS_;                              ///< total number of blocks
+
+        /// macroscopic values allocated in heap
+        T* const M_;
+
+
+        /**\brief Class constructor
+         * \param NX   simulation domain resolution in x-direction
+         * \param NY   simulation domain resolution in y-direction
+         * \param NZ   simulation domain resolution in z-direction
+        */
+        RuntimeContinuum(unsigned int const NX, unsigned int const NY, unsigned int const NZ):
+            NX_(NX), NY_(NY), NZ_(NZ), MEM_SIZE_(sizeof(T)*NZ*NY*NX*static_cast<size_t>(NM_)),
+            NUM_BLOCKS_Z_((NZ + BLOCK_SIZE_ - 1)/BLOCK_SIZE_), NUM_BLOCKS_Y_((NY + BLOCK_SIZE_ - 1)/BLOCK_SIZE_),
+            NUM_BLOCKS_X_((NX + BLOCK_SIZE_ - 1)/BLOCK_SIZE_), NUM_BLOCKS_(NUM_BLOCKS_X_*NUM_BLOCKS_Y_*NUM_BLOCKS_Z_),
+            M_(static_cast<T*>(AllocateAligned(MEM_SIZE_)))
+        {
+            if (M_ == nullptr)
+            {
+                std::cerr << "Fatal error: Continuum could not be allocated." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            FirstTouch();
+        }
+
+        /**\brief Class destructor
+        */
+        ~RuntimeContinuum()
+        {
+            FreeAligned(M_);
+        }
+
+        RuntimeContinuum(RuntimeContinuum const&) = delete;
+        RuntimeContinuum& operator= (RuntimeContinuum const&) = delete;
+
+        /// lattice indexing functions
+        inline size_t SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
+                                      unsigned int const m) const
+        {
+            return ((static_cast<size_t>(z)*NY_ + y)*NX_ + x)*NM_ + m;
+        }
+        inline T&       operator() (unsigned int const x, unsigned int const y, unsigned int const z, unsigned int const m)
+        {
+            return M_[SpatialToLinear(x, y, z, m)];
+        }
+        inline T const& operator() (unsigned int const x, unsigned int const y, unsigned int const z, unsigned int const m) const
+        {
+            return M_[SpatialToLinear(x, y, z, m)];
+        }
+
+        /// export to disk
+        void SetZero(std::vector<boundaryElement<T>> const& boundary);
+        void Export(std::string const name, unsigned int const step) const;
+        void ExportVtk(unsigned int const step, std::string const name = "Export") const;
+
+    private:
+        /// NUMA-aware placement of the macroscopic values
+        void FirstTouch();
+
+        /// binary encoding of the exported files
+        void ExportVtkHeader(FILE* const exportFile, std::string const title) const;
+        void ExportVtkData(FILE* const exportFile, unsigned int const first, unsigned int const components) const;
+        static inline uint32_t BigEndianFloat(float const value);
+};
+
+
+/**\fn        FirstTouch
+ * \brief     Touch the macroscopic values for the first time with the same block-to-thread mapping as
+ *            the collision kernels so that every page is placed on the NUMA node of the thread working on it.
+*/
+template <typename T>
+void RuntimeContinuum<T>::FirstTouch()
+{
+    #pragma omp parallel for default(none) schedule(static,1)
+    for(unsigned int block = 0; block < NUM_BLOCKS_; ++block)
+    {
+        unsigned int const z_start = BLOCK_SIZE_ * (block / (NUM_BLOCKS_X_*NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + BLOCK_SIZE_, NZ_);
+
+        for(unsigned int z = z_start; z < z_end; ++z)
+        {
+            unsigned int const y_start = BLOCK_SIZE_*((block % (NUM_BLOCKS_X_*NUM_BLOCKS_Y_)) / NUM_BLOCKS_X_);
+            unsigned int const   y_end = std::min(y_start + BLOCK_SIZE_, NY_);
+
+            for(unsigned int y = y_start; y < y_end; ++y)
+            {
+                unsigned int const x_start = BLOCK_SIZE_*(block % NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + BLOCK_SIZE_, NX_);
+
+                for(unsigned int x = x_start; x < x_end; ++x)
+                {
+                    for(unsigned int m = 0; m < NM_; ++m)
+                    {
+                        M_[SpatialToLinear(x, y, z, m)] = 0.0;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**\fn        SetZero
+ * \brief     Set not relevant nodes (e.g. boundary nodes) of a the hydrodynamic
+ *            field (velocities and density) to zero
+ *
+ * \param[in] boundary   the indices of all solid cells
+*/
+template <typename T>
+void RuntimeContinuum<T>::SetZero(std::vector<boundaryElement<T>> const& boundary)
+{
+    for(size_t i = 0; i < boundary.size(); ++i)
+    {
+        for (size_t m = 0; m < NM_; ++m)
+        {
+            M_[SpatialToLinear(boundary[i].x, boundary[i].y, boundary[i].z, m)] = static_cast<T>(0.0);
+        }
+    }
+}
+
+/**\fn        Export
+ * \brief     Export all macroscopic values at current time step to a raw *.bin-file (same file as
+ *            Continuum::Export, converted afterwards with '--convert')
+ *
+ * \param[in] name   the export file name of the scalar
+ * \param[in] step   the current time step that will be used for the name
+*/
+template <typename T>
+void RuntimeContinuum<T>::Export(std::string const name, unsigned int const step) const
+{
+    struct stat info;
+
+    if (stat(OUTPUT_BIN_PATH.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+    {
+        std::string const fileName = OUTPUT_BIN_PATH + std::string("/") + name + std::string("_") + std::to_string(step) + std::string(".bin");
+        FILE * const exportFile = fopen(fileName.c_str(), "wb+");
+        fwrite(M_, 1, MEM_SIZE_, exportFile);
+        fclose(exportFile);
+    }
+    else
+    {
+        std::cerr << "Fatal error: Directory '" << OUTPUT_BIN_PATH << "' not found." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**\fn        ExportVtkData
+ * \brief     Write some of the macroscopic values of all cells as big-endian single precision binary
+ *            data of a legacy *.vtk-file plane by plane
+ *
+ * \param[in] exportFile   the file the data should be written to
+ * \param[in] first        index of the first macroscopic value that should be written
+ * \param[in] components   number of consecutive macroscopic values per cell (e.g. 1 scalar, 3 vector)
+*/
+template <typename T>
+void RuntimeContinuum<T>::ExportVtkData(FILE* const exportFile, unsigned int const first, unsigned int const components) const
+{
+    size_t const planeLength = static_cast<size_t>(NX_)*NY_*components;
+    ArenaScope scratch(ScratchArena());
+    uint32_t* const plane = scratch.Allocate<uint32_t>(planeLength);
+
+    for(unsigned int z = 0; z < NZ_; ++z)
+    {
+        size_t i = 0;
+        for(unsigned int y = 0; y < NY_; ++y)
+        {
+            for(unsigned int x = 0; x < NX_; ++x)
+            {
+                for(unsigned int m = first; m < first + components; ++m)
+                {
+                    plane[i++] = BigEndianFloat(static_cast<float>(M_[SpatialToLinear(x, y, z, m)]));
+                }
+            }
+        }
+        fwrite(plane, sizeof(uint32_t), planeLength, exportFile);
+    }
+    fprintf(exportFile, "\n");
+}
+
+/**\fn        ExportVtkHeader
+ * \brief     Write the header and the coordinates of the rectilinear grid of a binary legacy *.vtk-file
+ *
+ * \param[in] exportFile   the file the header should be written to
+ * \param[in] title        title of the data set
+*/
+template <typename T>
+void RuntimeContinuum<T>::ExportVtkHeader(FILE* const exportFile, std::string const title) const
+{
+    fprintf(exportFile, "# vtk DataFile Version 3.0\n");
+    fprintf(exportFile, "%s\n", title.c_str());
+    fprintf(exportFile, "BINARY\n");
+    fprintf(exportFile, "DATASET RECTILINEAR_GRID\n");
+    fprintf(exportFile, "DIMENSIONS %u %u %u\n", NX_, NY_, NZ_);
+
+    std::array<unsigned int,3> const resolution = {NX_, NY_, NZ_};
+    std::array<char,3>         const axis       = {'X', 'Y', 'Z'};
+    for(unsigned int a = 0; a < resolution.size(); ++a)
+    {
+        std::vector<uint32_t> coordinates(resolution[a]);
+        for(unsigned int i = 0; i < resolution[a]; ++i)
+        {
+            coordinates[i] = BigEndianFloat(static_cast<float>(i));
+        }
+
+        fprintf(exportFile, "%c_COORDINATES %u float\n", axis[a], resolution[a]);
+        fwrite(coordinates.data(), sizeof(uint32_t), coordinates.size(), exportFile);
+        fprintf(exportFile, "\n");
+    }
+
+    size_t const numberOfCells = static_cast<size_t>(NX_)*static_cast<size_t>(NY_)*static_cast<size_t>(NZ_);
+    fprintf(exportFile, "POINT_DATA %zu\n", numberOfCells);
+}
+
+/**\fn        ExportVtk
+ * \brief     Export velocity and density at current time step to a binary *.vtk-file that can then be
+ *            read by visualisation applications like ParaView.
+ *
+ * \param[in] step   the current time step that will be used for the name
+ * \param[in] name   the export file name (default = "Export")
+*/
+template <typename T>
+void RuntimeContinuum<T>::ExportVtk(unsigned int const step, std::string const name) const
+{
+    struct stat info;
+
+    if (stat(OUTPUT_VTK_PATH.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+    {
+        std::string const fileName = OUTPUT_VTK_PATH + std::string("/") + name + std::string("_") + std::to_string(step) + std::string(".vtk");
+        FILE * const exportFile = fopen(fileName.c_str(), "wb");
+
+        ExportVtkHeader(exportFile, "LBM CFD simulation velocity");
+        fprintf(exportFile, "SCALARS density_variation float 1\n");
+        fprintf(exportFile, "LOOKUP_TABLE default\n");
+        ExportVtkData(exportFile, 0, 1);
+        fprintf(exportFile, "VECTORS velocity_vector float\n");
+        ExportVtkData(exportFile, 1, 3);
+
+        fclose(exportFile);
+    }
+    else
+    {
+        std::cerr << "Fatal error: Directory '" << OUTPUT_VTK_PATH << "' not found." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**\fn        BigEndianFloat
+ * \brief     Bit pattern of a single precision value in big-endian byte order as required by
+ *            binary legacy *.vtk-files
+ *
+ * \param[in] value   the single precision value
+ * \return    bit pattern in big-endian byte order
+*/
+template <typename T>
+inline uint32_t RuntimeContinuum<T>::BigEndianFloat(float const value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+
+    #if (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        bits = __builtin_bswap32(bits);
+    #endif
+
+    return bits;
+}
+
+
+/**\fn          InitContinuum
+ * \brief       Initialise continuum values density and velocities of a run-time sized domain
+ *
+ * \tparam      T       floating data type used for simulation
+ * \param[out]  con     the continuum object that should be initialised
+ * \param[in]   RHO_0   the uniform initial density across the flow field
+ * \param[in]   U_0     the uniform initial velocity in x-direction across the flow field
+ * \param[in]   V_0     the uniform initial velocity in y-direction across the flow field
+ * \param[in]   W_0     the uniform initial velocity in z-direction across the flow field
+*/
+template <typename T>
+void InitContinuum(RuntimeContinuum<T>& con, T const RHO_0, T const U_0, T const V_0, T const W_0)
+{
+    #pragma omp parallel for default(none) shared(con) firstprivate(RHO_0,U_0,V_0,W_0) schedule(static,1)
+    for(unsigned int block = 0; block < con.NUM_BLOCKS_; ++block)
+    {
+        unsigned int const z_start = con.BLOCK_SIZE_ * (block / (con.NUM_BLOCKS_X_*con.NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + con.BLOCK_SIZE_, con.NZ_);
+
+        for(unsigned int z = z_start; z < z_end; ++z)
+        {
+            unsigned int const y_start = con.BLOCK_SIZE_*((block % (con.NUM_BLOCKS_X_*con.NUM_BLOCKS_Y_)) / con.NUM_BLOCKS_X_);
+            unsigned int const   y_end = std::min(y_start + con.BLOCK_SIZE_, con.NY_);
+
+            for(unsigned int y = y_start; y < y_end; ++y)
+            {
+                unsigned int const x_start = con.BLOCK_SIZE_*(block % con.NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + con.BLOCK_SIZE_, con.NX_);
+
+                for(unsigned int x = x_start; x < x_end; ++x)
+                {
+                    con(x, y, z, 0) = RHO_0;
+                    con(x, y, z, 1) = U_0;
+                    con(x, y, z, 2) = V_0;
+                    con(x, y, z, 3) = W_0;
+                }
+            }
+        }
+    }
+}
+
+#endif // CONTINUUM_RUNTIME_HPP_INCLUDED
@@ -0,0 +1,129 @@
+#ifndef CONVERT_HPP_INCLUDED
+#define CONVERT_HPP_INCLUDED
+
+/**
+ * \file     convert.hpp
+ * \mainpage Conversion of exported *.bin-files to files for visualisation applications
+ *
+ * \note     Exporting raw *.bin-files during the simulation is significantly faster than writing
+ *           *.vtk-files. The binary files can be converted afterwards, several files in parallel.
+ *           Reduced exports of the output stage (*.lbz-files) are converted the same way and keep the
+ *           subregion, stride, precision and compression they were exported with.
+*/
+
+#include <dirent.h>
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "continuum.hpp"
+#include "output_stage.hpp"
+#include "../general/paths.hpp"
+
+
+/**\fn        ConvertBinaries
+ * \brief     Convert all *.bin-files named "<name>_<step>.bin" in the binary output directory that
+ *            match the resolution of the simulation domain as well as all reduced exports named
+ *            "<name>_<step>.lbz" to *.vtk- or *.vti-files in the visualisation output directory. Raw
+ *            files of different size are skipped.
+ *
+ * \tparam    NX         simulation domain resolution in x-direction
+ * \tparam    NY         simulation domain resolution in y-direction
+ * \tparam    NZ         simulation domain resolution in z-direction
+ * \tparam    T          floating data type used for simulation
+ * \param[in] format     output file format (ExportFormat::Vtk or ExportFormat::Vti)
+ * \param[in] compress   compress *.vti-files with zlib (default = false)
+ * \return    number of converted files
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+size_t ConvertBinaries(ExportFormat const format, bool const compress = false)
+{
+    DIR* const directory = opendir(OUTPUT_BIN_PATH.c_str());
+
+    if (directory == nullptr)
+    {
+        std::cerr << "Fatal error: Directory '" << OUTPUT_BIN_PATH << "' not found." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    /// collect names and time steps of all binary files of the right size
+    std::vector<std::string>  names;
+    std::vector<unsigned int> steps;
+    std::vector<bool>         isReduced;
+
+    for (dirent const* entry = readdir(directory); entry != nullptr; entry = readdir(directory))
+    {
+        std::string const fileName(entry->d_name);
+        size_t const separator = fileName.rfind('_');
+        bool   const isLbz     = (fileName.size() > 4) && (fileName.compare(fileName.size() - 4, 4, ".lbz") == 0);
+        size_t const extension = fileName.rfind((isLbz == true) ? ".lbz" : ".bin");
+
+        if ((separator == std::string::npos) || (extension == std::string::npos) ||
+            (extension + 4 != fileName.size()) || (extension <= separator + 1) ||
+            (fileName.find_first_not_of("0123456789", separator + 1) != extension))
+        {
+            continue;
+        }
+
+        struct stat info;
+        std::string const path = OUTPUT_BIN_PATH + std::string("/") + fileName;
+        if ((isLbz == false) && ((stat(path.c_str(), &info) != 0) || (static_cast<size_t>(info.st_size) != Continuum<NX,NY,NZ,T>::MEM_SIZE_)))
+        {
+            std::cerr << "Warning: Skipping '" << path << "' as it does not match the domain resolution." << std::endl;
+            continue;
+        }
+
+        names.push_back(fileName.substr(0, separator));
+        steps.push_back(static_cast<unsigned int>(std::stoul(fileName.substr(separator + 1, extension - separator - 1))));
+        isReduced.push_back(isLbz);
+    }
+    closedir(directory);
+
+    /// every thread converts whole files
+    size_t const numberOfFiles = names.size();
+
+    #pragma omp parallel default(none) shared(names, steps, isReduced) firstprivate(numberOfFiles, format, compress)
+    {
+        Continuum<NX,NY,NZ,T> con;
+        OutputStage<NX,NY,NZ,T> stage;
+
+        #pragma omp for schedule(dynamic,1)
+        for(size_t i = 0; i < numberOfFiles; ++i)
+        {
+            if (isReduced[i] == true)
+            {
+                stage.Import(names[i], steps[i]);
+
+                if (format == ExportFormat::Vti)
+                {
+                    stage.ExportVti(steps[i], names[i]);
+                }
+                else
+                {
+                    stage.ExportVtk(steps[i], names[i]);
+                }
+                continue;
+            }
+
+            con.Import(names[i], steps[i]);
+
+            if (format == ExportFormat::Vti)
+            {
+                con.ExportVti(steps[i], compress, names[i]);
+            }
+            else
+            {
+                con.ExportVtk(steps[i], names[i]);
+            }
+        }
+    }
+
+    return numberOfFiles;
+}
+
+#endif // CONVERT_HPP_INCLUDED
@@ -32,29 +32,21 @@
 template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
 void InitContinuum(Continuum<NX,NY,NZ,T>& con, T const RHO_0, T const U_0, T const V_0, T const W_0)
 {
-    /// parallelism: 3D blocks
-    //  each cell gets a block of cells instead of a single cell
-    constexpr unsigned int   BLOCK_SIZE = 32;
-    constexpr unsigned int NUM_BLOCKS_Z = cef::ceil(static_cast<double>(NZ) / BLOCK_SIZE);
-    constexpr unsigned int NUM_BLOCKS_Y = cef::ceil(static_cast<double>(NY) / BLOCK_SIZE);
-    constexpr unsigned int NUM_BLOCKS_X = cef::ceil(static_cast<double>(NX) / BLOCK_SIZE);
-    constexpr unsigned int   NUM_BLOCKS = NUM_BLOCKS_X*NUM_BLOCKS_Y*NUM_BLOCKS_Z;
-
     #pragma omp parallel for default(none) shared(con) firstprivate(RHO_0,U_0,V_0,W_0) schedule(static,1)
-    for(unsigned int block = 0; block < NUM_BLOCKS; ++block)
+    for(unsigned int block = 0; block < con.NUM_BLOCKS_; ++block)
     {
-        unsigned int const z_start = BLOCK_SIZE * (block / (NUM_BLOCKS_X*NUM_BLOCKS_Y));
-        unsigned int const   z_end = std::min(z_start + BLOCK_SIZE, NZ);
+        unsigned int const z_start = con.BLOCK_SIZE_ * (block / (con.NUM_BLOCKS_X_*con.NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + con.BLOCK_SIZE_, NZ);
 
         for(unsigned int z = z_start; z < z_end; ++z)
         {
-            unsigned int const y_start = BLOCK_SIZE*((block % (NUM_BLOCKS_X*NUM_BLOCKS_Y)) / NUM_BLOCKS_X);
-            unsigned int const   y_end = std::min(y_start + BLOCK_SIZE, NY);
+            unsigned int const y_start = con.BLOCK_SIZE_*((block % (con.NUM_BLOCKS_X_*con.NUM_BLOCKS_Y_)) / con.NUM_BLOCKS_X_);
+            unsigned int const   y_end = std::min(y_start + con.BLOCK_SIZE_, NY);
 
             for(unsigned int y = y_start; y < y_end; ++y)
             {
-                unsigned int const x_start = BLOCK_SIZE*(block % NUM_BLOCKS_X);
-                unsigned int const   x_end = std::min(x_start + BLOCK_SIZE, NX);
+                unsigned int const x_start = con.BLOCK_SIZE_*(block % con.NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + con.BLOCK_SIZE_, NX);
 
                 for(unsigned int x = x_start; x < x_end; ++x)
                 {
@@ -0,0 +1,332 @@
+#ifndef MONITOR_HPP_INCLUDED
+#define MONITOR_HPP_INCLUDED
+
+/**
+ * \file     monitor.hpp
+ * \mainpage In-situ reductions of integral quantities written as a time series
+ *
+ * \note     Integral quantities such as the drag on an obstacle, the mass flux through an outlet or the
+ *           kinetic energy would otherwise require exporting and post-processing full fields. They are
+ *           evaluated as parallel reductions on the time steps the macroscopic values are computed
+ *           anyway (see StepScheduler), appended to a small text file and used to stop the simulation
+ *           early once the velocity field has converged to a steady state. The force on the obstacle
+ *           is evaluated with the momentum exchange method from the populations that were reflected
+ *           by the bounce-back: only the fluid cells next to the obstacle are visited.
+*/
+
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#ifdef USE_MPI
+    #include <mpi.h>
+    #include "../general/distribution.hpp"
+#endif
+
+#include "continuum.hpp"
+#include "../general/memory_alignment.hpp"
+#include "../population/boundary/boundary.hpp"
+#include "../population/fluid_cells.hpp"
+#include "../population/population.hpp"
+
+
+/**\struct monitorRecord
+ * \brief  Integral quantities of a single time step
+*/
+template <typename T>
+struct monitorRecord
+{
+    size_t           step;      ///< time step of the evaluation
+    std::array<T,3>  force;     ///< force exerted by the fluid on the obstacle (momentum exchange)
+    T                mass;      ///< total mass of all fluid cells
+    std::array<T,3>  flux;      ///< mass flux through the outlet
+    T                energy;    ///< kinetic energy of all fluid cells
+    T                residual;  ///< relative L2 change of the velocity since the previous evaluation
+};
+
+
+/**\class  Monitor
+ * \brief  Parallel reductions of integral quantities (force on an obstacle, mass, outlet flux, kinetic
+ *         energy and convergence residual) every given number of time steps
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam T    floating data type used for simulation
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T = double>
+class Monitor
+{
+    public:
+        /// number of time steps between two evaluations
+        size_t const INTERVAL_;
+
+        /// relative L2 change of the velocity below which the flow is considered converged (0 = never)
+        T const      TOLERANCE_;
+
+        /**\brief Class constructor
+         * \param pop         population object holding microscopic variables (lattice of the links)
+         * \param fluid       fluid cell list of all cells owned by this process
+         * \param obstacle    solid cells of the obstacle the force is evaluated on (including ghost layers)
+         * \param outlet      boundary elements the mass flux is evaluated on
+         * \param interval    number of time steps between two evaluations
+         * \param tolerance   convergence tolerance of the relative L2 change of the velocity (0 = disabled)
+         * \param fileName    file the time series is appended to (empty: no file, e.g. on all but root)
+        */
+        template <class LT, unsigned int NPOP, class LY, class ST, class SP>
+        Monitor(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, FluidCells<NX,NY,NZ> const& fluid,
+                std::vector<boundaryElement<T>> const& obstacle, std::vector<boundaryElement<T>> const& outlet,
+                size_t const interval, T const tolerance = 0.0, std::string const& fileName = "");
+
+        Monitor(Monitor const&) = delete;
+        Monitor& operator= (Monitor const&) = delete;
+
+        /// evaluate all reductions after a time step with the given parity
+        template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+        monitorRecord<T> const& Evaluate(size_t const step, Continuum<NX,NY,NZ,T> const& con,
+                                         Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, unsigned int const p = 0);
+
+        /// access functions
+        inline bool IsConverged() const;
+        inline monitorRecord<T> const& GetRecord() const;
+
+    private:
+        FluidCells<NX,NY,NZ> const&      fluid_;
+
+        /// fluid cells next to the obstacle with the mask of their links towards the obstacle
+        std::vector<fluidCell, DefaultInitAllocator<fluidCell>> links_;
+
+        std::vector<boundaryElement<T>>  outlet_;
+
+        /// velocity of every fluid cell at the previous evaluation (order of the fluid cell list)
+        std::vector<T, DefaultInitAllocator<T>> previous_;
+        bool                             hasPrevious_;
+
+        monitorRecord<T>                 record_;
+        std::ofstream                    file_;
+
+        #ifdef USE_MPI
+            MPI_Comm const               comm_;
+        #endif
+};
+
+
+/**\fn        Monitor
+ * \brief     Collect the links of the fluid cells towards the obstacle and open the time series
+ * \warning   The fluid cell list has to be kept alive as long as the monitor is used.
+ *
+ * \tparam    LT          static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP        number of populations stored side by side in the lattice
+ * \tparam    LY          memory layout policy of the populations
+ * \tparam    ST          storage policy of the populations
+ * \tparam    SP          streaming policy of the populations
+ * \param[in] pop         population object holding microscopic variables (lattice of the links)
+ * \param[in] fluid       fluid cell list of all cells owned by this process
+ * \param[in] obstacle    solid cells of the obstacle the force is evaluated on (including ghost layers)
+ * \param[in] outlet      boundary elements the mass flux is evaluated on
+ * \param[in] interval    number of time steps between two evaluations
+ * \param[in] tolerance   convergence tolerance of the relative L2 change of the velocity (0 = disabled)
+ * \param[in] fileName    file the time series is appended to (empty: no file)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T> template <class LT, unsigned int NPOP, class LY, class ST, class SP>
+Monitor<NX,NY,NZ,T>::Monitor(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, FluidCells<NX,NY,NZ> const& fluid,
+                             std::vector<boundaryElement<T>> const& obstacle, std::vector<boundaryElement<T>> const& outlet,
+                             size_t const interval, T const tolerance, std::string const& fileName):
+    INTERVAL_(interval), TOLERANCE_(tolerance), fluid_(fluid), links_(), outlet_(outlet),
+    previous_(3*fluid.GetNumberOfCells()), hasPrevious_(false), record_(), file_()
+    #ifdef USE_MPI
+    , comm_(MPI_COMM_WORLD)
+    #endif
+{
+    (void)pop;
+
+    std::vector<bool> isObstacle(static_cast<size_t>(NZ)*NY*NX, false);
+    for(size_t i = 0; i < obstacle.size(); ++i)
+    {
+        isObstacle[(static_cast<size_t>(obstacle[i].z)*NY + obstacle[i].y)*NX + obstacle[i].x] = true;
+    }
+
+    for(size_t i = 0; i < fluid.GetNumberOfCells(); ++i)
+    {
+        fluidCell cell = fluid.cells_[i];
+        uint32_t mask = 0;
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            for(unsigned int d = 1; d < LT::HSPEED; ++d)
+            {
+                unsigned int const curr = n*LT::OFF + d;
+                if ((cell.solid >> curr) & 1u)
+                {
+                    unsigned int const x = cell.x_n[1 + static_cast<int>(LT::DX[curr])];
+                    unsigned int const y = cell.y_n[1 + static_cast<int>(LT::DY[curr])];
+                    unsigned int const z = cell.z_n[1 + static_cast<int>(LT::DZ[curr])];
+                    mask |= static_cast<uint32_t>(isObstacle[(static_cast<size_t>(z)*NY + y)*NX + x]) << curr;
+                }
+            }
+        }
+
+        if (mask != 0)
+        {
+            cell.solid = mask;
+            links_.push_back(cell);
+        }
+    }
+
+    if (fileName.empty() == false)
+    {
+        file_.open(fileName, std::ios::out | std::ios::trunc);
+        if (file_.is_open() == false)
+        {
+            std::cerr << "Fatal error: Monitor file " << fileName << " could not be opened." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        file_ << "step,force_x,force_y,force_z,mass,flux_x,flux_y,flux_z,energy,residual" << std::endl;
+    }
+}
+
+/**\fn        Evaluate
+ * \brief     Evaluate all reductions after a time step with the given parity: the force on the obstacle
+ *            from the populations reflected by the bounce-back, the mass and kinetic energy of all fluid
+ *            cells, the mass flux through the outlet and the relative L2 change of the velocity since the
+ *            previous evaluation. The result is appended to the time series.
+ * \warning   The macroscopic values have to be computed in the time step (see StepScheduler).
+ *
+ * \tparam    odd    parity of the time step that was just performed (even (0, false) or odd (1, true))
+ * \tparam    LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP   number of populations stored side by side in the lattice
+ * \tparam    LY     memory layout policy of the populations
+ * \tparam    ST     storage policy of the populations
+ * \tparam    SP     streaming policy of the populations
+ * \param[in] step   the current time step
+ * \param[in] con    continuum object holding macroscopic variables
+ * \param[in] pop    population object holding microscopic variables
+ * \param[in] p      relevant population (default = 0)
+ * \return    integral quantities of the current time step
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T> template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+monitorRecord<T> const& Monitor<NX,NY,NZ,T>::Evaluate(size_t const step, Continuum<NX,NY,NZ,T> const& con,
+                                                      Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, unsigned int const p)
+{
+    /// momentum exchange: every reflected population transfers twice its momentum to the obstacle
+    T fx = 0.0;
+    T fy = 0.0;
+    T fz = 0.0;
+    #pragma omp parallel for default(none) shared(pop) firstprivate(p) reduction(+:fx,fy,fz) schedule(static,32)
+    for(size_t i = 0; i < links_.size(); ++i)
+    {
+        fluidCell const& cell = links_[i];
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            for(unsigned int d = 1; d < LT::HSPEED; ++d)
+            {
+                unsigned int const curr = n*LT::OFF + d;
+                if ((cell.solid >> curr) & 1u)
+                {
+                    T const f = pop.Load(pop. template IndexRead<!odd>(cell.x_n, cell.y_n, cell.z_n, !n, d, p), !n, d);
+                    fx += 2*f*LT::DX[curr];
+                    fy += 2*f*LT::DY[curr];
+                    fz += 2*f*LT::DZ[curr];
+                }
+            }
+        }
+    }
+
+    /// field reductions over all fluid cells with the block-to-thread mapping of the collision kernels
+    T mass     = 0.0;
+    T energy   = 0.0;
+    T change   = 0.0;
+    T velocity = 0.0;
+    bool const hasPrevious = hasPrevious_;
+    #pragma omp parallel for default(none) shared(con) firstprivate(hasPrevious) reduction(+:mass,energy,change,velocity) schedule(static,1)
+    for(unsigned int block = 0; block < fluid_.NUM_BLOCKS_; ++block)
+    {
+        for(size_t i = fluid_.BlockBegin(block); i < fluid_.BlockEnd(block); ++i)
+        {
+            fluidCell const& cell = fluid_.cells_[i];
+            T const rho = con(cell.x_n[1], cell.y_n[1], cell.z_n[1], 0);
+            T const u   = con(cell.x_n[1], cell.y_n[1], cell.z_n[1], 1);
+            T const v   = con(cell.x_n[1], cell.y_n[1], cell.z_n[1], 2);
+            T const w   = con(cell.x_n[1], cell.y_n[1], cell.z_n[1], 3);
+
+            mass     += rho;
+            energy   += 0.5*rho*(u*u + v*v + w*w);
+            velocity += u*u + v*v + w*w;
+            if (hasPrevious == true)
+            {
+                T const du = u - previous_[3*i + 0];
+                T const dv = v - previous_[3*i + 1];
+                T const dw = w - previous_[3*i + 2];
+                change += du*du + dv*dv + dw*dw;
+            }
+            previous_[3*i + 0] = u;
+            previous_[3*i + 1] = v;
+            previous_[3*i + 2] = w;
+        }
+    }
+
+    /// mass flux through the outlet
+    T qx = 0.0;
+    T qy = 0.0;
+    T qz = 0.0;
+    #pragma omp parallel for default(none) shared(con) reduction(+:qx,qy,qz) schedule(static,32)
+    for(size_t i = 0; i < outlet_.size(); ++i)
+    {
+        T const rho = con(outlet_[i].x, outlet_[i].y, outlet_[i].z, 0);
+        qx += rho*con(outlet_[i].x, outlet_[i].y, outlet_[i].z, 1);
+        qy += rho*con(outlet_[i].x, outlet_[i].y, outlet_[i].z, 2);
+        qz += rho*con(outlet_[i].x, outlet_[i].y, outlet_[i].z, 3);
+    }
+
+    std::array<T,10> sums = { fx, fy, fz, mass, qx, qy, qz, energy, change, velocity };
+    #ifdef USE_MPI
+        MPI_Allreduce(MPI_IN_PLACE, sums.data(), static_cast<int>(sums.size()), MpiDatatype<T>(), MPI_SUM, comm_);
+    #endif
+
+    record_.step     = step;
+    record_.force    = { sums[0], sums[1], sums[2] };
+    record_.mass     = sums[3];
+    record_.flux     = { sums[4], sums[5], sums[6] };
+    record_.energy   = sums[7];
+    record_.residual = ((hasPrevious_ == true) && (sums[9] > 0)) ? std::sqrt(sums[8]/sums[9]) : std::numeric_limits<T>::infinity();
+    hasPrevious_ = true;
+
+    if (file_.is_open() == true)
+    {
+        file_ << record_.step << ","
+              << record_.force[0] << "," << record_.force[1] << "," << record_.force[2] << ","
+              << record_.mass << ","
+              << record_.flux[0] << "," << record_.flux[1] << "," << record_.flux[2] << ","
+              << record_.energy << "," << record_.residual << std::endl;
+    }
+
+    return record_;
+}
+
+/**\fn     IsConverged
+ * \brief  Check if the relative L2 change of the velocity between the last two evaluations dropped
+ *         below the tolerance
+ *
+ * \return Boolean true if the flow is converged, false otherwise or if the tolerance is disabled
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+inline bool Monitor<NX,NY,NZ,T>::IsConverged() const
+{
+    return (TOLERANCE_ > 0) && (record_.residual < TOLERANCE_);
+}
+
+/**\fn     GetRecord
+ * \brief  Integral quantities of the last evaluation
+ *
+ * \return the last record of the time series
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+inline monitorRecord<T> const& Monitor<NX,NY,NZ,T>::GetRecord() const
+{
+    return record_;
+}
+
+#endif // MONITOR_HPP_INCLUDED
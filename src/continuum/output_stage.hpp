@@ -0,0 +1,917 @@
+#ifndef OUTPUT_STAGE_HPP_INCLUDED
+#define OUTPUT_STAGE_HPP_INCLUDED
+
+/**
+ * \file     output_stage.hpp
+ * \mainpage Reduced export of the macroscopic values: subregion, stride, precision and compression
+ *
+ * \note     A full export writes four values in the floating data type of the simulation for every cell.
+ *           With frequent exports of a long transient this fills the file system and stalls on the I/O
+ *           bandwidth. The output stage reduces the exported data in three steps before it is written:
+ *           - a subregion of the domain sampled with a stride in every direction is gathered,
+ *           - the values are optionally downcast to single precision,
+ *           - every sampled plane (z-slab) is compressed on its own, all slabs in parallel.
+ *           The compression is either lossless (the bytes of the values are shuffled so that the bytes of
+ *           equal significance are adjacent and then compressed with zlib) or lossy with an absolute
+ *           error bound. The lossy compression of the *.lbz-files predicts every value from its three
+ *           reconstructed neighbours in the plane (Lorenzo predictor) and stores the deviation quantised
+ *           to twice the tolerance as variable-length integers, followed by zlib. Visualisation
+ *           applications can not decode the predictor, *.vti-files are therefore rounded to the largest
+ *           power of two not exceeding twice the tolerance instead, which zeros the trailing bits of the
+ *           mantissa and makes them compress well with zlib. The error of both is bounded by the
+ *           tolerance (plus the rounding to single precision if downcast).
+ *           Files written by the output stage:
+ *           - name_step.lbz: header (resolution, subregion, stride, precision, compression, tolerance,
+ *             sizes of the slabs) followed by the slabs, converted with '--convert' like raw *.bin-files,
+ *           - name_step.vtk: binary legacy file of the sampled cells (uncompressed),
+ *           - name_step.vti: XML image data with one (compressed) block per sampled plane.
+ *           zlib is only available with 'make ZLIB=true' (defines USE_ZLIB), otherwise the compression
+ *           stages of the lossless and lossy compression are skipped.
+ * \note     "SZ3: A modular framework for composing prediction-based error-bounded lossy compressors"
+ *           X. Liang, K. Zhao, S. Di, S. Li, R. Underwood, A.M. Gok, J. Tian, J. Deng, J.C. Calhoun,
+ *           D. Tao, Z. Chen, F. Cappello
+ *           IEEE Transactions on Big Data 9 (2) (2023)
+ *           DOI: 10.1109/TBDATA.2022.3201176
+*/
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <vector>
+#ifdef USE_ZLIB
+    #include <zlib.h>
+#endif
+
+#include "continuum.hpp"
+#include "../general/paths.hpp"
+#include "../general/settings.hpp"
+
+
+namespace codec
+{
+    /**\fn        Append
+     * \brief     Append the bytes of a value to a byte stream
+     *
+     * \param[in,out] stream   byte stream
+     * \param[in]     value    value that should be appended
+    */
+    template <typename V>
+    inline void Append(std::vector<unsigned char>& stream, V const value)
+    {
+        unsigned char const* const bytes = reinterpret_cast<unsigned char const*>(&value);
+        stream.insert(stream.end(), bytes, bytes + sizeof(V));
+    }
+
+    /**\fn        Extract
+     * \brief     Read a value from a byte stream and advance the position. Stops the program if the
+     *            stream is too short.
+     *
+     * \param[in]     stream     byte stream
+     * \param[in,out] position   position of the value in the stream
+     * \return    value read from the stream
+    */
+    template <typename V>
+    inline V Extract(std::vector<unsigned char> const& stream, size_t& position)
+    {
+        if (position + sizeof(V) > stream.size())
+        {
+            std::cerr << "Fatal error: Compressed export is truncated." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        V value;
+        memcpy(&value, stream.data() + position, sizeof(V));
+        position += sizeof(V);
+        return value;
+    }
+
+    /**\fn        AppendVarint
+     * \brief     Append a signed integer as zigzag-encoded variable-length integer (7 bits per byte) so
+     *            that small deviations of either sign take a single byte
+     *
+     * \param[in,out] stream   byte stream
+     * \param[in]     value    signed integer that should be appended
+    */
+    inline void AppendVarint(std::vector<unsigned char>& stream, int64_t const value)
+    {
+        uint64_t bits = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        while (bits >= 0x80)
+        {
+            stream.push_back(static_cast<unsigned char>(bits | 0x80));
+            bits >>= 7;
+        }
+        stream.push_back(static_cast<unsigned char>(bits));
+    }
+
+    /**\fn        ExtractVarint
+     * \brief     Read a zigzag-encoded variable-length integer from a byte stream and advance the position
+     *
+     * \param[in]     stream     byte stream
+     * \param[in,out] position   position of the integer in the stream
+     * \return    signed integer read from the stream
+    */
+    inline int64_t ExtractVarint(std::vector<unsigned char> const& stream, size_t& position)
+    {
+        uint64_t bits = 0;
+        for(unsigned int shift = 0; shift < 64; shift += 7)
+        {
+            uint64_t const byte = Extract<unsigned char>(stream, position);
+            bits |= (byte & 0x7F) << shift;
+            if (byte < 0x80)
+            {
+                break;
+            }
+        }
+        return static_cast<int64_t>(bits >> 1) ^ -static_cast<int64_t>(bits & 1);
+    }
+
+    /**\fn        Shuffle
+     * \brief     Reorder the bytes of consecutive values so that the bytes of equal significance are
+     *            adjacent (or restore the original order)
+     *
+     * \param[in] raw       bytes of the values
+     * \param[in] size      size of a single value in bytes
+     * \param[in] inverse   restore the original order (Boolean true/false)
+     * \return    reordered bytes
+    */
+    inline std::vector<unsigned char> Shuffle(std::vector<unsigned char> const& raw, size_t const size, bool const inverse)
+    {
+        size_t const number = raw.size()/size;
+        std::vector<unsigned char> shuffled(raw.size());
+
+        for(size_t b = 0; b < size; ++b)
+        {
+            for(size_t i = 0; i < number; ++i)
+            {
+                if (inverse == false)
+                {
+                    shuffled[b*number + i] = raw[i*size + b];
+                }
+                else
+                {
+                    shuffled[i*size + b] = raw[b*number + i];
+                }
+            }
+        }
+        return shuffled;
+    }
+
+    /**\fn        Deflate
+     * \brief     Compress a byte stream with zlib (unchanged without USE_ZLIB)
+     *
+     * \param[in] raw   uncompressed bytes
+     * \return    compressed bytes
+    */
+    inline std::vector<unsigned char> Deflate(std::vector<unsigned char> const& raw)
+    {
+        #ifdef USE_ZLIB
+            uLongf size = compressBound(raw.size());
+            std::vector<unsigned char> compressed(size);
+            compress2(compressed.data(), &size, raw.data(), raw.size(), Z_BEST_SPEED);
+            compressed.resize(size);
+            return compressed;
+        #else
+            return raw;
+        #endif
+    }
+
+    /**\fn        Inflate
+     * \brief     Decompress a byte stream compressed with zlib. Stops the program if it can not be decompressed.
+     *
+     * \param[in] compressed   compressed bytes
+     * \param[in] size         size of the uncompressed bytes
+     * \return    uncompressed bytes
+    */
+    inline std::vector<unsigned char> Inflate(std::vector<unsigned char> const& compressed, size_t const size)
+    {
+        #ifdef USE_ZLIB
+            std::vector<unsigned char> raw(size);
+            uLongf rawSize = size;
+            if ((uncompress(raw.data(), &rawSize, compressed.data(), compressed.size()) != Z_OK) || (rawSize != size))
+            {
+                std::cerr << "Fatal error: Compressed export could not be decompressed." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            return raw;
+        #else
+            (void)compressed;
+            (void)size;
+            std::cerr << "Fatal error: Decompression of the export requires zlib ('make ZLIB=true')." << std::endl;
+            exit(EXIT_FAILURE);
+        #endif
+    }
+
+    /**\fn        BigEndianFloat
+     * \brief     Bit pattern of a single precision value in big-endian byte order as required by
+     *            binary legacy *.vtk-files
+     *
+     * \param[in] value   the single precision value
+     * \return    bit pattern in big-endian byte order
+    */
+    inline uint32_t BigEndianFloat(float const value)
+    {
+        uint32_t bits = 0;
+        memcpy(&bits, &value, sizeof(bits));
+
+        #if (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+            bits = __builtin_bswap32(bits);
+        #endif
+
+        return bits;
+    }
+}
+
+
+/**\class  OutputStage
+ * \brief  Reduction and compression of the macroscopic values before they are written to disk
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam T    floating data type used for simulation
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T = double>
+class OutputStage
+{
+    public:
+        static constexpr unsigned int NM_ = Continuum<NX,NY,NZ,T>::NM_; ///< macroscopic values per cell
+        static constexpr uint32_t  MAGIC_ = 0x5A54424C;                  ///< identifier of *.lbz-files ("LBTZ")
+
+        /**\brief Class constructor
+         * \param output   subregion, stride, precision and compression of the export (default = full field)
+        */
+        OutputStage(outputSettings const& output = outputSettings()):
+            output_(output), number_(), values_(), written_(0)
+        {
+            Configure(output);
+        }
+
+        /// sample the macroscopic values or import them from a *.lbz-file
+        void Gather(Continuum<NX,NY,NZ,T> const& con);
+        void Import(std::string const name, unsigned int const step);
+
+        /// export the sampled values to disk
+        void Export(std::string const name, unsigned int const step);
+        void ExportVtk(unsigned int const step, std::string const name = "Export");
+        void ExportVti(unsigned int const step, std::string const name = "Export");
+
+        /// number of sampled cells and bytes written to disk so far
+        size_t GetNumberOfCells() const;
+        size_t GetBytesWritten() const;
+
+    private:
+        outputSettings             output_;
+        std::array<unsigned int,3> number_; ///< number of sampled cells in each direction
+        std::vector<T>             values_; ///< sampled macroscopic values: planes of rows of cells of NM_ values
+        size_t                     written_;
+
+        /// the encoded planes are compressed with zlib
+        bool IsDeflated() const;
+
+        /// check the settings and size the sampled values
+        void Configure(outputSettings const& output);
+
+        /// planes (z-slabs) of the sampled values as *.lbz- and *.vti-blocks
+        std::vector<unsigned char> EncodeSlab(unsigned int const z) const;
+        void DecodeSlab(std::vector<unsigned char> const& slab, unsigned int const z, bool const isDeflated);
+        std::vector<unsigned char> VtiData(unsigned int const first, unsigned int const components, bool const compress) const;
+
+        /// values of a plane in the exported precision
+        template <typename S>
+        std::vector<unsigned char> PlaneBytes(unsigned int const z, unsigned int const first, unsigned int const components) const;
+        template <typename S>
+        std::vector<unsigned char> EncodeLossy(unsigned int const z) const;
+        template <typename S>
+        void DecodeLossy(std::vector<unsigned char> const& stream, unsigned int const z);
+
+        /// write the file or stop the program if the directory does not exist
+        void Write(std::string const& directory, std::string const& fileName, std::vector<unsigned char> const& data);
+};
+
+
+/**\fn        Configure
+ * \brief     Check the subregion, stride and compression and size the sampled values. Stops the
+ *            program if the settings are invalid.
+ *
+ * \param[in] output   subregion, stride, precision and compression of the export
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void OutputStage<NX,NY,NZ,T>::Configure(outputSettings const& output)
+{
+    std::array<unsigned int,3> const resolution = {NX, NY, NZ};
+    output_ = output;
+
+    for(unsigned int d = 0; d < resolution.size(); ++d)
+    {
+        output_.upper[d] = (output.upper[d] == 0) ? resolution[d] : output.upper[d];
+
+        if ((output_.lower[d] >= output_.upper[d]) || (output_.upper[d] > resolution[d]))
+        {
+            std::cerr << "Fatal error: Export region exceeds the domain of " << NX << "x" << NY << "x" << NZ << " cells." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((output_.stride == 0) || ((output_.compression == OutputCompression::Lossy) && (output_.tolerance <= 0.0)))
+    {
+        std::cerr << "Fatal error: Export stride and tolerance of the lossy compression have to be positive." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    #ifndef USE_ZLIB
+        if (output_.compression == OutputCompression::Lossless)
+        {
+            std::cerr << "Warning: Lossless compression requires zlib ('make ZLIB=true'), export is not compressed." << std::endl;
+        }
+    #endif
+
+    for(unsigned int d = 0; d < resolution.size(); ++d)
+    {
+        number_[d] = (output_.upper[d] - output_.lower[d] + output_.stride - 1)/output_.stride;
+    }
+    values_.assign(GetNumberOfCells()*NM_, static_cast<T>(0.0));
+}
+
+/**\fn        Gather
+ * \brief     Sample the macroscopic values of the subregion with the stride, in parallel over the planes
+ *
+ * \param[in] con   continuum object holding macroscopic variables
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void OutputStage<NX,NY,NZ,T>::Gather(Continuum<NX,NY,NZ,T> const& con)
+{
+    unsigned int const nz = number_[2];
+
+    #pragma omp parallel for default(none) shared(con) firstprivate(nz) schedule(static)
+    for(unsigned int k = 0; k < nz; ++k)
+    {
+        size_t i = static_cast<size_t>(k)*number_[1]*number_[0]*NM_;
+        unsigned int const z = output_.lower[2] + k*output_.stride;
+
+        for(unsigned int j = 0; j < number_[1]; ++j)
+        {
+            unsigned int const y = output_.lower[1] + j*output_.stride;
+
+            for(unsigned int l = 0; l < number_[0]; ++l)
+            {
+                unsigned int const x = output_.lower[0] + l*output_.stride;
+
+                for(unsigned int m = 0; m < NM_; ++m)
+                {
+                    values_[i++] = con(x, y, z, m);
+                }
+            }
+        }
+    }
+}
+
+/**\fn        PlaneBytes
+ * \brief     Bytes of some of the sampled values of a plane in the exported precision
+ *
+ * \tparam    S            floating data type of the export
+ * \param[in] z            index of the sampled plane
+ * \param[in] first        index of the first macroscopic value
+ * \param[in] components   number of consecutive macroscopic values per cell
+ * \return    bytes of the values
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T> template <typename S>
+std::vector<unsigned char> OutputStage<NX,NY,NZ,T>::PlaneBytes(unsigned int const z, unsigned int const first, unsigned int const components) const
+{
+    size_t const cells = static_cast<size_t>(number_[1])*number_[0];
+    size_t const start = static_cast<size_t>(z)*cells*NM_;
+
+    /// power of two quantum for the rounding of lossy *.vti-files (0 = no rounding)
+    double const quantum = (output_.compression == OutputCompression::Lossy) ? std::exp2(std::floor(std::log2(2.0*output_.tolerance))) : 0.0;
+
+    std::vector<unsigned char> bytes(cells*components*sizeof(S));
+    S* const plane = reinterpret_cast<S*>(bytes.data());
+
+    for(size_t c = 0; c < cells; ++c)
+    {
+        for(unsigned int m = 0; m < components; ++m)
+        {
+            double const value = static_cast<double>(values_[start + c*NM_ + first + m]);
+            plane[c*components + m] = static_cast<S>((quantum > 0.0) ? quantum*std::nearbyint(value/quantum) : value);
+        }
+    }
+    return bytes;
+}
+
+/**\fn        EncodeLossy
+ * \brief     Error-bounded lossy encoding of a sampled plane: every macroscopic value is predicted from
+ *            the reconstructed left, lower and lower left neighbour and the deviation is quantised
+ *
+ * \tparam    S   floating data type of the export
+ * \param[in] z   index of the sampled plane
+ * \return    quantised deviations as variable-length integers
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T> template <typename S>
+std::vector<unsigned char> OutputStage<NX,NY,NZ,T>::EncodeLossy(unsigned int const z) const
+{
+    size_t const cells = static_cast<size_t>(number_[1])*number_[0];
+    size_t const start = static_cast<size_t>(z)*cells*NM_;
+    double const  step = 2.0*output_.tolerance;
+
+    std::vector<unsigned char> stream;
+    stream.reserve(cells*NM_);
+    std::vector<double> reconstructed(cells);
+
+    for(unsigned int m = 0; m < NM_; ++m)
+    {
+        for(unsigned int j = 0; j < number_[1]; ++j)
+        {
+            for(unsigned int l = 0; l < number_[0]; ++l)
+            {
+                size_t const c = static_cast<size_t>(j)*number_[0] + l;
+                double const prediction = ((l > 0) ? reconstructed[c - 1] : 0.0) + ((j > 0) ? reconstructed[c - number_[0]] : 0.0) -
+                                          (((l > 0) && (j > 0)) ? reconstructed[c - number_[0] - 1] : 0.0);
+
+                double const  value = static_cast<double>(static_cast<S>(values_[start + c*NM_ + m]));
+                int64_t const level = std::llround((value - prediction)/step);
+                reconstructed[c] = prediction + step*static_cast<double>(level);
+                codec::AppendVarint(stream, level);
+            }
+        }
+    }
+    return stream;
+}
+
+/**\fn        DecodeLossy
+ * \brief     Reconstruct a sampled plane from its quantised deviations (inverse of EncodeLossy)
+ *
+ * \tparam    S        floating data type of the export
+ * \param[in] stream   quantised deviations as variable-length integers
+ * \param[in] z        index of the sampled plane
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T> template <typename S>
+void OutputStage<NX,NY,NZ,T>::DecodeLossy(std::vector<unsigned char> const& stream, unsigned int const z)
+{
+    size_t const cells = static_cast<size_t>(number_[1])*number_[0];
+    size_t const start = static_cast<size_t>(z)*cells*NM_;
+    double const  step = 2.0*output_.tolerance;
+
+    size_t position = 0;
+    std::vector<double> reconstructed(cells);
+
+    for(unsigned int m = 0; m < NM_; ++m)
+    {
+        for(unsigned int j = 0; j < number_[1]; ++j)
+        {
+            for(unsigned int l = 0; l < number_[0]; ++l)
+            {
+                size_t const c = static_cast<size_t>(j)*number_[0] + l;
+                double const prediction = ((l > 0) ? reconstructed[c - 1] : 0.0) + ((j > 0) ? reconstructed[c - number_[0]] : 0.0) -
+                                          (((l > 0) && (j > 0)) ? reconstructed[c - number_[0] - 1] : 0.0);
+
+                reconstructed[c] = prediction + step*static_cast<double>(codec::ExtractVarint(stream, position));
+                values_[start + c*NM_ + m] = static_cast<T>(static_cast<S>(reconstructed[c]));
+            }
+        }
+    }
+}
+
+/**\fn        EncodeSlab
+ * \brief     Encode a sampled plane of a *.lbz-file: size of the uncompressed data followed by the values
+ *            (uncompressed), the shuffled values (lossless) or the quantised deviations (lossy), all but
+ *            the uncompressed ones compressed with zlib. The macroscopic values are stored one after
+ *            another (all densities of the plane followed by all velocities in x-direction and so on).
+ *
+ * \param[in] z   index of the sampled plane
+ * \return    encoded plane
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+std::vector<unsigned char> OutputStage<NX,NY,NZ,T>::EncodeSlab(unsigned int const z) const
+{
+    size_t const size = (output_.single == true) ? sizeof(float) : sizeof(T);
+    std::vector<unsigned char> raw;
+
+    if (output_.compression == OutputCompression::Lossy)
+    {
+        raw = (output_.single == true) ? EncodeLossy<float>(z) : EncodeLossy<T>(z);
+    }
+    else
+    {
+        for(unsigned int m = 0; m < NM_; ++m)
+        {
+            std::vector<unsigned char> const component = (output_.single == true) ? PlaneBytes<float>(z, m, 1) : PlaneBytes<T>(z, m, 1);
+            raw.insert(raw.end(), component.begin(), component.end());
+        }
+        if ((output_.compression == OutputCompression::Lossless) && (IsDeflated() == true))
+        {
+            raw = codec::Shuffle(raw, size, false);
+        }
+    }
+
+    std::vector<unsigned char> slab;
+    codec::Append<uint64_t>(slab, raw.size());
+
+    std::vector<unsigned char> const payload = (IsDeflated() == true) ? codec::Deflate(raw) : raw;
+    slab.insert(slab.end(), payload.begin(), payload.end());
+    return slab;
+}
+
+/**\fn        DecodeSlab
+ * \brief     Decode a sampled plane of a *.lbz-file (inverse of EncodeSlab)
+ *
+ * \param[in] slab         encoded plane
+ * \param[in] z            index of the sampled plane
+ * \param[in] isDeflated   the plane is compressed with zlib (Boolean true/false)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void OutputStage<NX,NY,NZ,T>::DecodeSlab(std::vector<unsigned char> const& slab, unsigned int const z, bool const isDeflated)
+{
+    size_t position = 0;
+    size_t const rawSize = static_cast<size_t>(codec::Extract<uint64_t>(slab, position));
+    std::vector<unsigned char> const payload(slab.begin() + position, slab.end());
+    std::vector<unsigned char> raw = (isDeflated == true) ? codec::Inflate(payload, rawSize) : payload;
+
+    if (output_.compression == OutputCompression::Lossy)
+    {
+        if (output_.single == true)
+        {
+            DecodeLossy<float>(raw, z);
+        }
+        else
+        {
+            DecodeLossy<T>(raw, z);
+        }
+        return;
+    }
+
+    size_t const size = (output_.single == true) ? sizeof(float) : sizeof(T);
+    size_t const cells = static_cast<size_t>(number_[1])*number_[0];
+    if (raw.size() != cells*NM_*size)
+    {
+        std::cerr << "Fatal error: Compressed export does not match its header." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if ((output_.compression == OutputCompression::Lossless) && (isDeflated == true))
+    {
+        raw = codec::Shuffle(raw, size, true);
+    }
+
+    for(unsigned int m = 0; m < NM_; ++m)
+    {
+        for(size_t c = 0; c < cells; ++c)
+        {
+            unsigned char const* const bytes = raw.data() + (m*cells + c)*size;
+            T& value = values_[(z*cells + c)*NM_ + m];
+
+            if (output_.single == true)
+            {
+                float single;
+                memcpy(&single, bytes, size);
+                value = static_cast<T>(single);
+            }
+            else
+            {
+                memcpy(&value, bytes, size);
+            }
+        }
+    }
+}
+
+/**\fn        Export
+ * \brief     Export the sampled values to a *.lbz-file, the planes are encoded in parallel
+ *
+ * \param[in] name   the export file name
+ * \param[in] step   the current time step that will be used for the name
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void OutputStage<NX,NY,NZ,T>::Export(std::string const name, unsigned int const step)
+{
+    unsigned int const nz = number_[2];
+    std::vector<std::vector<unsigned char>> slabs(nz);
+
+    #pragma omp parallel for default(none) shared(slabs) firstprivate(nz) schedule(dynamic,1)
+    for(unsigned int z = 0; z < nz; ++z)
+    {
+        slabs[z] = EncodeSlab(z);
+    }
+
+    /// header: identifier, resolution, subregion, stride, precision, compression, tolerance and sizes of the slabs
+    std::vector<unsigned char> data;
+    codec::Append<uint32_t>(data, MAGIC_);
+    for(unsigned int const n : {NX, NY, NZ})
+    {
+        codec::Append<uint32_t>(data, n);
+    }
+    for(unsigned int d = 0; d < 3; ++d)
+    {
+        codec::Append<uint32_t>(data, output_.lower[d]);
+        codec::Append<uint32_t>(data, output_.upper[d]);
+    }
+    codec::Append<uint32_t>(data, output_.stride);
+    codec::Append<uint32_t>(data, (output_.single == true) ? sizeof(float) : sizeof(T));
+    codec::Append<uint32_t>(data, static_cast<uint32_t>(output_.compression));
+    codec::Append<double>(data, output_.tolerance);
+    codec::Append<uint32_t>(data, (IsDeflated() == true) ? 1 : 0);
+    for(unsigned int z = 0; z < nz; ++z)
+    {
+        codec::Append<uint64_t>(data, slabs[z].size());
+    }
+    for(unsigned int z = 0; z < nz; ++z)
+    {
+        data.insert(data.end(), slabs[z].begin(), slabs[z].end());
+    }
+
+    std::string const fileName = name + std::string("_") + std::to_string(step) + std::string(".lbz");
+    Write(OUTPUT_BIN_PATH, fileName, data);
+}
+
+/**\fn        Import
+ * \brief     Import the sampled values from a *.lbz-file: the subregion, stride, precision and compression
+ *            are taken from the file, the planes are decoded in parallel. Stops the program if the file
+ *            can not be read or was written for a different domain.
+ *
+ * \param[in] name   the import file name
+ * \param[in] step   the time step that will be used for the name
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void OutputStage<NX,NY,NZ,T>::Import(std::string const name, unsigned int const step)
+{
+    std::string const fileName = OUTPUT_BIN_PATH + std::string("/") + name + std::string("_") + std::to_string(step) + std::string(".lbz");
+    FILE* const importFile = fopen(fileName.c_str(), "rb");
+    if (importFile == nullptr)
+    {
+        std::cerr << "Fatal error: Could not import '" << fileName << "'." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<unsigned char> data;
+    unsigned char buffer[1 << 16];
+    for (size_t read = fread(buffer, 1, sizeof(buffer), importFile); read > 0; read = fread(buffer, 1, sizeof(buffer), importFile))
+    {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+    fclose(importFile);
+
+    size_t position = 0;
+    bool isValid = (codec::Extract<uint32_t>(data, position) == MAGIC_);
+    for(unsigned int const n : {NX, NY, NZ})
+    {
+        isValid = (codec::Extract<uint32_t>(data, position) == n) && (isValid == true);
+    }
+    if (isValid == false)
+    {
+        std::cerr << "Fatal error: '" << fileName << "' was not exported for a domain of " << NX << "x" << NY << "x" << NZ << " cells." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    outputSettings output;
+    for(unsigned int d = 0; d < 3; ++d)
+    {
+        output.lower[d] = codec::Extract<uint32_t>(data, position);
+        output.upper[d] = codec::Extract<uint32_t>(data, position);
+    }
+    output.stride      = codec::Extract<uint32_t>(data, position);
+    uint32_t const size = codec::Extract<uint32_t>(data, position);
+    output.single      = (size == sizeof(float)) && (sizeof(T) != sizeof(float));
+    output.compression = static_cast<OutputCompression>(codec::Extract<uint32_t>(data, position));
+    output.tolerance   = codec::Extract<double>(data, position);
+    bool const isDeflated = (codec::Extract<uint32_t>(data, position) == 1);
+    if (((size != sizeof(float)) && (size != sizeof(T))) || (output.compression > OutputCompression::Lossy))
+    {
+        std::cerr << "Fatal error: Header of compressed export '" << fileName << "' is invalid." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    Configure(output);
+
+    unsigned int const nz = number_[2];
+    std::vector<size_t> offsets(nz + 1, 0);
+    offsets[0] = position + nz*sizeof(uint64_t);
+    for(unsigned int z = 0; z < nz; ++z)
+    {
+        offsets[z + 1] = offsets[z] + static_cast<size_t>(codec::Extract<uint64_t>(data, position));
+    }
+    if (offsets[nz] > data.size())
+    {
+        std::cerr << "Fatal error: Compressed export '" << fileName << "' is truncated." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    #pragma omp parallel for default(none) shared(data, offsets) firstprivate(nz, isDeflated) schedule(dynamic,1)
+    for(unsigned int z = 0; z < nz; ++z)
+    {
+        DecodeSlab(std::vector<unsigned char>(data.begin() + offsets[z], data.begin() + offsets[z + 1]), z, isDeflated);
+    }
+}
+
+/**\fn        ExportVtk
+ * \brief     Export density and velocity of the sampled cells to a binary legacy *.vtk-file (always
+ *            single precision and uncompressed as required by the format)
+ *
+ * \param[in] step   the current time step that will be used for the name
+ * \param[in] name   the export file name (default = "Export")
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void OutputStage<NX,NY,NZ,T>::ExportVtk(unsigned int const step, std::string const name)
+{
+    std::vector<unsigned char> data;
+    std::string const header = std::string("# vtk DataFile Version 3.0\nLBM CFD simulation velocity\nBINARY\nDATASET RECTILINEAR_GRID\n") +
+                               "DIMENSIONS " + std::to_string(number_[0]) + " " + std::to_string(number_[1]) + " " + std::to_string(number_[2]) + "\n";
+    data.insert(data.end(), header.begin(), header.end());
+
+    std::array<char,3> const axis = {'X', 'Y', 'Z'};
+    for(unsigned int d = 0; d < axis.size(); ++d)
+    {
+        std::string const coordinates = axis[d] + std::string("_COORDINATES ") + std::to_string(number_[d]) + " float\n";
+        data.insert(data.end(), coordinates.begin(), coordinates.end());
+        for(unsigned int i = 0; i < number_[d]; ++i)
+        {
+            codec::Append<uint32_t>(data, codec::BigEndianFloat(static_cast<float>(output_.lower[d] + i*output_.stride)));
+        }
+        data.push_back('\n');
+    }
+
+    std::array<std::string,2>  const fields     = {"POINT_DATA " + std::to_string(GetNumberOfCells()) + "\nSCALARS density_variation float 1\nLOOKUP_TABLE default\n",
+                                                   "VECTORS velocity_vector float\n"};
+    std::array<unsigned int,2> const first      = {0, 1};
+    std::array<unsigned int,2> const components = {1, 3};
+    for(unsigned int f = 0; f < fields.size(); ++f)
+    {
+        data.insert(data.end(), fields[f].begin(), fields[f].end());
+        for(size_t c = 0; c < GetNumberOfCells(); ++c)
+        {
+            for(unsigned int m = first[f]; m < first[f] + components[f]; ++m)
+            {
+                codec::Append<uint32_t>(data, codec::BigEndianFloat(static_cast<float>(values_[c*NM_ + m])));
+            }
+        }
+        data.push_back('\n');
+    }
+
+    std::string const fileName = name + std::string("_") + std::to_string(step) + std::string(".vtk");
+    Write(OUTPUT_VTK_PATH, fileName, data);
+}
+
+/**\fn        VtiData
+ * \brief     Encode some of the sampled values as appended raw data of a *.vti-file: a 64-bit byte count
+ *            followed by the values or, if compressed, a header of the zlib blocks (one per sampled plane,
+ *            compressed in parallel) followed by the blocks
+ *
+ * \param[in] first        index of the first macroscopic value that should be encoded
+ * \param[in] components   number of consecutive macroscopic values per cell (e.g. 1 scalar, 3 vector)
+ * \param[in] compress     compress the data with zlib (Boolean true/false)
+ * \return    encoded data
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+std::vector<unsigned char> OutputStage<NX,NY,NZ,T>::VtiData(unsigned int const first, unsigned int const components, bool const compress) const
+{
+    unsigned int const nz = number_[2];
+    std::vector<std::vector<unsigned char>> planes(nz);
+
+    #pragma omp parallel for default(none) shared(planes) firstprivate(nz, first, components, compress) schedule(dynamic,1)
+    for(unsigned int z = 0; z < nz; ++z)
+    {
+        planes[z] = (output_.single == true) ? PlaneBytes<float>(z, first, components) : PlaneBytes<T>(z, first, components);
+        if (compress == true)
+        {
+            planes[z] = codec::Deflate(planes[z]);
+        }
+    }
+
+    /// header: byte count if uncompressed, number of blocks, block size, last block size and compressed sizes otherwise
+    size_t const planeSize = static_cast<size_t>(number_[1])*number_[0]*components*((output_.single == true) ? sizeof(float) : sizeof(T));
+    std::vector<unsigned char> data;
+    if (compress == false)
+    {
+        codec::Append<uint64_t>(data, planeSize*nz);
+    }
+    else
+    {
+        codec::Append<uint64_t>(data, nz);
+        codec::Append<uint64_t>(data, planeSize);
+        codec::Append<uint64_t>(data, 0);
+        for(unsigned int z = 0; z < nz; ++z)
+        {
+            codec::Append<uint64_t>(data, planes[z].size());
+        }
+    }
+
+    for(unsigned int z = 0; z < nz; ++z)
+    {
+        data.insert(data.end(), planes[z].begin(), planes[z].end());
+    }
+    return data;
+}
+
+/**\fn        ExportVti
+ * \brief     Export density and velocity of the sampled cells to a XML image data *.vti-file with the
+ *            origin and spacing of the subregion. The data is compressed with zlib if the lossless or lossy
+ *            compression is selected and zlib is available.
+ *
+ * \param[in] step   the current time step that will be used for the name
+ * \param[in] name   the export file name (default = "Export")
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void OutputStage<NX,NY,NZ,T>::ExportVti(unsigned int const step, std::string const name)
+{
+    bool const isCompressed = IsDeflated();
+    std::vector<unsigned char> const density  = VtiData(0, 1, isCompressed);
+    std::vector<unsigned char> const velocity = VtiData(1, 3, isCompressed);
+
+    char const* const type = ((output_.single == true) || (sizeof(T) == sizeof(float))) ? "Float32" : "Float64";
+    char const* const byteOrder = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) ? "LittleEndian" : "BigEndian";
+
+    char header[2048];
+    int const length = snprintf(header, sizeof(header),
+        "<?xml version=\"1.0\"?>\n"
+        "<VTKFile type=\"ImageData\" version=\"1.0\" byte_order=\"%s\" header_type=\"UInt64\"%s>\n"
+        "  <ImageData WholeExtent=\"0 %u 0 %u 0 %u\" Origin=\"%u %u %u\" Spacing=\"%u %u %u\">\n"
+        "    <Piece Extent=\"0 %u 0 %u 0 %u\">\n"
+        "      <PointData Scalars=\"density_variation\" Vectors=\"velocity_vector\">\n"
+        "        <DataArray type=\"%s\" Name=\"density_variation\" NumberOfComponents=\"1\" format=\"appended\" offset=\"0\"/>\n"
+        "        <DataArray type=\"%s\" Name=\"velocity_vector\" NumberOfComponents=\"3\" format=\"appended\" offset=\"%zu\"/>\n"
+        "      </PointData>\n"
+        "    </Piece>\n"
+        "  </ImageData>\n"
+        "  <AppendedData encoding=\"raw\">\n"
+        "_",
+        byteOrder, (isCompressed == true) ? " compressor=\"vtkZLibDataCompressor\"" : "",
+        number_[0] - 1, number_[1] - 1, number_[2] - 1, output_.lower[0], output_.lower[1], output_.lower[2],
+        output_.stride, output_.stride, output_.stride, number_[0] - 1, number_[1] - 1, number_[2] - 1,
+        type, type, density.size());
+
+    std::string const footer = "\n  </AppendedData>\n</VTKFile>\n";
+    std::vector<unsigned char> data(header, header + length);
+    data.insert(data.end(), density.begin(),  density.end());
+    data.insert(data.end(), velocity.begin(), velocity.end());
+    data.insert(data.end(), footer.begin(),   footer.end());
+
+    std::string const fileName = name + std::string("_") + std::to_string(step) + std::string(".vti");
+    Write(OUTPUT_VTK_PATH, fileName, data);
+}
+
+/**\fn        Write
+ * \brief     Write an encoded file to disk. Stops the program if the directory does not exist.
+ *
+ * \param[in] directory   output directory
+ * \param[in] fileName    name of the file in the output directory
+ * \param[in] data        encoded file
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void OutputStage<NX,NY,NZ,T>::Write(std::string const& directory, std::string const& fileName, std::vector<unsigned char> const& data)
+{
+    struct stat info;
+
+    if (stat(directory.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+    {
+        std::string const path = directory + std::string("/") + fileName;
+        FILE* const exportFile = fopen(path.c_str(), "wb");
+        fwrite(data.data(), 1, data.size(), exportFile);
+        fclose(exportFile);
+        written_ += data.size();
+    }
+    else
+    {
+        std::cerr << "Fatal error: Directory '" << directory << "' not found." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**\fn        IsDeflated
+ * \brief     The planes are compressed with zlib: lossless or lossy compression selected and zlib available
+ *
+ * \return    Boolean true/false
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+bool OutputStage<NX,NY,NZ,T>::IsDeflated() const
+{
+    #ifdef USE_ZLIB
+        return (output_.compression != OutputCompression::None);
+    #else
+        return false;
+    #endif
+}
+
+/**\fn        GetNumberOfCells
+ * \brief     Number of sampled cells
+ *
+ * \return    number of cells of the subregion sampled with the stride
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+size_t OutputStage<NX,NY,NZ,T>::GetNumberOfCells() const
+{
+    return static_cast<size_t>(number_[0])*number_[1]*number_[2];
+}
+
+/**\fn        GetBytesWritten
+ * \brief     Total number of bytes written to disk by the output stage
+ *
+ * \return    bytes written
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+size_t OutputStage<NX,NY,NZ,T>::GetBytesWritten() const
+{
+    return written_;
+}
+
+#endif // OUTPUT_STAGE_HPP_INCLUDED
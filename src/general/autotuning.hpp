@@ -0,0 +1,426 @@
+#ifndef AUTOTUNING_HPP_INCLUDED
+#define AUTOTUNING_HPP_INCLUDED
+
+/**
+ * \file     autotuning.hpp
+ * \mainpage Startup autotuning of the loop blocks, the threads and the kernel variant
+ *
+ * \note     The ideal loop block shape, the number of threads (with or without simultaneous multithreading)
+ *           and their placement as well as the instruction set of the collision kernels depend on the
+ *           machine and on the case (domain size, lattice, geometry). With 'autotune = on' a few time steps
+ *           of the actual domain are timed for candidate configurations before the simulation starts: one
+ *           parameter after the other (instruction set, threads and placement, block shape) is varied
+ *           while the others are kept at the best value found so far (coordinate search). The block shapes
+ *           include non-cubic ones, e.g. blocks spanning the entire domain in x-direction.
+ *           The fastest configuration is cached per machine and case signature in TUNING_CACHE_PATH so that
+ *           later runs start with it right away ('autotune = force' tunes again and replaces the entry).
+ * \warning  The populations are advanced while the candidates are timed and have to be initialised again
+ *           afterwards. Changing the number of threads after the allocation may move the memory pages of
+ *           some blocks away from the NUMA node of the thread colliding them.
+*/
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <utility>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+#ifdef __linux__
+    #include <unistd.h>
+#endif
+
+#include "cpu_dispatch.hpp"
+#include "memory_alignment.hpp"
+#include "parallelism.hpp"
+#include "paths.hpp"
+#include "settings.hpp"
+#include "timer.hpp"
+
+
+/// minimum time each candidate configuration is timed for in seconds and number of repetitions
+/// (the fastest repetition is taken as it is the least disturbed by other processes)
+constexpr double       TUNING_TIME        = 0.1;
+constexpr unsigned int TUNING_REPETITIONS = 3;
+
+
+/**\struct tuningConfiguration
+ * \brief  Configuration of the solver found by the autotuner
+*/
+struct tuningConfiguration
+{
+    std::array<unsigned int,3> block = {LOOP_BLOCK_SIZE, LOOP_BLOCK_SIZE, LOOP_BLOCK_SIZE}; ///< loop block shape of the fluid cells
+    int    threads  = 0;            ///< number of threads (0 = all processors)
+    bool   isSpread = false;        ///< threads spread over the NUMA nodes instead of close to each other
+    Isa    isa      = DetectIsa();  ///< instruction set of the collision kernels
+    double mlups    = 0.0;          ///< measured speed in million fluid cell updates per second
+};
+
+
+/**\fn        SignatureToken
+ * \brief     Make a string usable as a single token of the cache (whitespace replaced by underscores)
+ *
+ * \param[in] text   the string
+ * \return    the string without whitespace
+*/
+inline std::string SignatureToken(std::string text)
+{
+    std::replace_if(text.begin(), text.end(), [](char const c){ return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'); }, '_');
+    return (text.empty() == true) ? "unknown" : text;
+}
+
+/**\fn        MachineSignature
+ * \brief     Signature of the machine: host name, processor model and number of processors
+ *
+ * \return    signature of the machine as a single token
+*/
+inline std::string MachineSignature()
+{
+    std::string host = "unknown";
+    #ifdef __linux__
+        char name[256] = {};
+        if (gethostname(name, sizeof(name) - 1) == 0)
+        {
+            host = name;
+        }
+    #endif
+
+    std::string model = "unknown";
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line))
+    {
+        if (line.compare(0, 10, "model name") == 0)
+        {
+            size_t const begin = line.find_first_not_of(" \t", line.find(':') + 1);
+            model = (begin == std::string::npos) ? model : line.substr(begin);
+            break;
+        }
+    }
+
+    #ifdef _OPENMP
+        int const processors = omp_get_num_procs();
+    #else
+        int const processors = 1;
+    #endif
+
+    return SignatureToken(host) + "/" + SignatureToken(model) + "/" + std::to_string(processors);
+}
+
+/**\fn        CaseSignature
+ * \brief     Signature of a case: domain size, lattice, streaming, storage, collision operator, time loop and
+ *            geometry
+ *
+ * \param[in] nx          domain resolution in x-direction
+ * \param[in] ny          domain resolution in y-direction
+ * \param[in] nz          domain resolution in z-direction
+ * \param[in] speeds      number of discrete velocities of the lattice
+ * \param[in] streaming   name of the streaming policy
+ * \param[in] storage     name of the storage policy of the populations
+ * \param[in] collision   name of the collision operator
+ * \param[in] timeloop    name of the parallel execution of the time steps (wavefront or pipeline)
+ * \param[in] geometry    geometry of the case (cylinder or file name)
+ * \return    signature of the case as a single token
+*/
+inline std::string CaseSignature(unsigned int const nx, unsigned int const ny, unsigned int const nz, unsigned int const speeds,
+                                 std::string const& streaming, std::string const& storage, std::string const& collision,
+                                 std::string const& timeloop, std::string const& geometry)
+{
+    return std::to_string(nx) + "x" + std::to_string(ny) + "x" + std::to_string(nz) + "/D3Q" + std::to_string(speeds) + "/" +
+           SignatureToken(streaming) + "/" + SignatureToken(storage) + "/" + SignatureToken(collision) + "/" + SignatureToken(timeloop) + "/" +
+           SignatureToken(geometry.substr(geometry.find_last_of('/') + 1));
+}
+
+/**\fn        DefaultTuning
+ * \brief     Compiled default configuration: cubic loop blocks, all processors close to each other and
+ *            the widest instruction set
+ *
+ * \return    default configuration
+*/
+inline tuningConfiguration DefaultTuning()
+{
+    tuningConfiguration tuning;
+    #ifdef _OPENMP
+        tuning.threads = GetParallelism().GetThreadsMax();
+    #endif
+    return tuning;
+}
+
+/**\fn        ApplyTuning
+ * \brief     Set the number of threads, their placement and the instruction set of a configuration
+ *            (the block shape is applied by the fluid cell list)
+ *
+ * \param[in] tuning   the configuration
+*/
+inline void ApplyTuning(tuningConfiguration const& tuning)
+{
+    SetIsa(tuning.isa);
+
+    #ifdef _OPENMP
+        Parallelism& parallelism = GetParallelism();
+        parallelism.SetThreadsNum((tuning.threads > 0) ? tuning.threads : parallelism.GetThreadsMax());
+        if ((getenv("OMP_PROC_BIND") == nullptr) && (getenv("OMP_PLACES") == nullptr))
+        {
+            parallelism.SetAffinity((tuning.isSpread == true) ? Affinity::Spread : Affinity::Close);
+        }
+    #endif
+}
+
+/**\fn        TuningOutput
+ * \brief     Output of a configuration to the console
+ *
+ * \param[in] tuning   the configuration
+ * \param[in] note     remark appended to the line
+*/
+inline void TuningOutput(tuningConfiguration const& tuning, char const* const note)
+{
+    printf("   block %3u x %3u x %3u, threads %3i %-6s, %-7s: %9.2f Mlups %s\n", tuning.block[0], tuning.block[1], tuning.block[2],
+           tuning.threads, (tuning.isSpread == true) ? "spread" : "close", IsaName(tuning.isa), tuning.mlups, note);
+    fflush(stdout);
+}
+
+/**\fn        ImportTuning
+ * \brief     Look up the configuration of a machine and a case in the cache
+ *
+ * \param[in]  fileName        name of the cache file
+ * \param[in]  machine         signature of the machine
+ * \param[in]  caseSignature   signature of the case
+ * \param[out] tuning          the cached configuration
+ * \return     Boolean true if a valid configuration was found, false otherwise
+*/
+inline bool ImportTuning(std::string const& fileName, std::string const& machine, std::string const& caseSignature,
+                         tuningConfiguration& tuning)
+{
+    std::ifstream file(fileName);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream stream(line);
+        std::string m, c, placement, isa;
+        tuningConfiguration cached;
+        if ((stream >> m >> c >> cached.block[0] >> cached.block[1] >> cached.block[2] >> cached.threads >> placement >> isa >> cached.mlups) &&
+            (m == machine) && (c == caseSignature))
+        {
+            cached.isSpread = (placement == "spread");
+            cached.isa = Isa::Generic;
+            for (Isa const i: {Isa::AVX2, Isa::AVX512, Isa::NEON, Isa::SVE})
+            {
+                cached.isa = (isa == IsaName(i)) ? i : cached.isa;
+            }
+
+            /// the binary may have been rebuilt for a different instruction set
+            if ((IsIsaSupported(cached.isa) == true) && (cached.threads > 0))
+            {
+                tuning = cached;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**\fn        ExportTuning
+ * \brief     Store the configuration of a machine and a case in the cache replacing a previous entry.
+ *            Only a warning is issued if the cache can not be written.
+ *
+ * \param[in] fileName        name of the cache file
+ * \param[in] machine         signature of the machine
+ * \param[in] caseSignature   signature of the case
+ * \param[in] tuning          the configuration
+*/
+inline void ExportTuning(std::string const& fileName, std::string const& machine, std::string const& caseSignature,
+                         tuningConfiguration const& tuning)
+{
+    std::vector<std::string> lines;
+    std::ifstream input(fileName);
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::istringstream stream(line);
+        std::string m, c;
+        if (((stream >> m >> c) && (m == machine) && (c == caseSignature)) == false)
+        {
+            lines.push_back(line);
+        }
+    }
+    input.close();
+
+    std::ostringstream entry;
+    entry << machine << " " << caseSignature << " " << tuning.block[0] << " " << tuning.block[1] << " " << tuning.block[2] << " "
+          << tuning.threads << " " << ((tuning.isSpread == true) ? "spread" : "close") << " " << IsaName(tuning.isa) << " " << tuning.mlups;
+    lines.push_back(entry.str());
+
+    std::ofstream output(fileName, std::ios::trunc);
+    for (std::string const& l: lines)
+    {
+        output << l << "\n";
+    }
+    if (output.good() == false)
+    {
+        std::cerr << "Warning: Could not write the autotuning cache '" << fileName << "'." << std::endl;
+    }
+}
+
+/**\fn        MeasureSpeed
+ * \brief     Speed of a function advancing the fluid cells for a number of time steps: after a warm-up
+ *            call the function is called repeatedly for TUNING_REPETITIONS repetitions of at least two
+ *            calls and TUNING_TIME/TUNING_REPETITIONS seconds each, the fastest repetition is reported
+ *
+ * \tparam    FUNC    callable advancing the fluid cells for a number of time steps
+ * \param[in] cells   number of fluid cells
+ * \param[in] steps   number of time steps per call
+ * \param[in] func    the function to be timed
+ * \return    speed in million fluid cell updates per second
+*/
+template <class FUNC>
+double MeasureSpeed(size_t const cells, unsigned int const steps, FUNC const& func)
+{
+    func();
+
+    double speed = 0.0;
+    for (unsigned int r = 0; r < TUNING_REPETITIONS; ++r)
+    {
+        Timer Stopwatch;
+        Stopwatch.Start();
+        size_t calls = 0;
+        double runtime = 0.0;
+        while ((calls < 2) || (runtime < TUNING_TIME/TUNING_REPETITIONS))
+        {
+            func();
+            ++calls;
+            runtime = Stopwatch.Stop();
+        }
+        speed = std::max(speed, 1e-6*static_cast<double>(cells)*steps*calls/runtime);
+    }
+
+    return speed;
+}
+
+/**\fn        Autotune
+ * \brief     Determine the fastest configuration of a case by a coordinate search over the instruction
+ *            sets, the threads and their placement and the loop block shapes or take it from the cache.
+ *            The configuration is applied (threads and instruction set) before it is returned.
+ *
+ * \tparam    MEASURE         callable returning the speed in Mlups of a configuration
+ *                            (threads and instruction set are already applied)
+ * \param[in] mode            autotuning mode (Off returns the default configuration without applying it)
+ * \param[in] caseSignature   signature of the case
+ * \param[in] domain          domain resolution in x-, y- and z-direction (upper bound of the block shape)
+ * \param[in] measure         the function timing a configuration
+ * \return    the fastest configuration
+*/
+template <class MEASURE>
+tuningConfiguration Autotune(Autotuning const mode, std::string const& caseSignature, std::array<unsigned int,3> const& domain,
+                             MEASURE const& measure)
+{
+    tuningConfiguration best = DefaultTuning();
+    if (mode == Autotuning::Off)
+    {
+        return best;
+    }
+
+    std::string const fileName = TUNING_CACHE_PATH + "/autotune.txt";
+    std::string const machine  = MachineSignature();
+    std::cout << "Autotuning: " << caseSignature << " on " << machine << std::endl;
+
+    if ((mode == Autotuning::Cached) && (ImportTuning(fileName, machine, caseSignature, best) == true))
+    {
+        ApplyTuning(best);
+        TuningOutput(best, "(cached)");
+        std::cout << std::endl;
+        return best;
+    }
+
+    auto const evaluate = [&best, &measure](tuningConfiguration candidate)
+    {
+        ApplyTuning(candidate);
+        candidate.mlups = measure(candidate);
+        TuningOutput(candidate, "");
+        best = (candidate.mlups > best.mlups) ? candidate : best;
+    };
+    evaluate(best);
+
+    /// kernel variants: all instruction sets supported by the processor and the binary
+    tuningConfiguration const isaBase = best;
+    for (Isa const isa: {Isa::Generic, Isa::AVX2, Isa::AVX512, Isa::NEON, Isa::SVE})
+    {
+        if ((IsIsaSupported(isa) == true) && (isa != isaBase.isa))
+        {
+            tuningConfiguration candidate = isaBase;
+            candidate.isa = isa;
+            evaluate(candidate);
+        }
+    }
+
+    /// threads: all processors, without simultaneous multithreading (half of them) and a quarter,
+    /// close to each other or spread over the NUMA nodes
+    #ifdef _OPENMP
+        int const threadsMax = GetParallelism().GetThreadsMax();
+        int const placements = (GetParallelism().GetNumaNodes() > 1) ? 2 : 1;
+        tuningConfiguration const threadsBase = best;
+        std::vector<std::pair<int,bool>> placed = {std::make_pair(threadsBase.threads, threadsBase.isSpread)};
+        for (int const threads: {threadsMax, threadsMax/2, threadsMax/4})
+        {
+            for (int p = 0; p < placements; ++p)
+            {
+                std::pair<int,bool> const placement = std::make_pair(threads, p == 1);
+                if ((threads > 0) && (std::find(placed.begin(), placed.end(), placement) == placed.end()))
+                {
+                    placed.push_back(placement);
+                    tuningConfiguration candidate = threadsBase;
+                    candidate.threads  = placement.first;
+                    candidate.isSpread = placement.second;
+                    evaluate(candidate);
+                }
+            }
+        }
+    #endif
+
+    /// loop block shapes: cubes and flat blocks elongated in x-direction (contiguous in memory)
+    tuningConfiguration const blockBase = best;
+    std::vector<std::array<unsigned int,3>> candidates;
+    for (unsigned int const b: {16u, 32u, 64u})
+    {
+        candidates.push_back({b, b, b});
+    }
+    for (unsigned int const bx: {16u, 32u, 64u, domain[0]})
+    {
+        for (unsigned int const by: {4u, 8u, 16u, 32u})
+        {
+            candidates.push_back({bx, by, blockBase.block[2]});
+        }
+    }
+
+    std::vector<std::array<unsigned int,3>> shapes = {blockBase.block};
+    for (std::array<unsigned int,3> const& c: candidates)
+    {
+        std::array<unsigned int,3> const shape = {std::min(c[0], domain[0]), std::min(c[1], domain[1]), std::min(c[2], domain[2])};
+        if (std::find(shapes.begin(), shapes.end(), shape) == shapes.end())
+        {
+            shapes.push_back(shape);
+        }
+    }
+    shapes.erase(shapes.begin());
+
+    for (std::array<unsigned int,3> const& shape: shapes)
+    {
+        tuningConfiguration candidate = blockBase;
+        candidate.block = shape;
+        evaluate(candidate);
+    }
+
+    ApplyTuning(best);
+    TuningOutput(best, "(fastest)");
+    std::cout << std::endl;
+    ExportTuning(fileName, machine, caseSignature, best);
+
+    return best;
+}
+
+#endif // AUTOTUNING_HPP_INCLUDED
@@ -0,0 +1,221 @@
+#ifndef CPU_DISPATCH_HPP_INCLUDED
+#define CPU_DISPATCH_HPP_INCLUDED
+
+/**
+ * \file     cpu_dispatch.hpp
+ * \mainpage Selection of the instruction set of the collision kernels at run time
+ *
+ * \note     A binary built with 'make ISA=portable' only assumes the baseline instruction set of the
+ *           architecture. Every collision operator compiles the loop over the cells of a block once
+ *           for every supported instruction set (the per-cell operators are inlined and vectorised
+ *           by the compiler for each of them) and the variant is chosen once at startup from the
+ *           features reported by the processor (CPUID on x86-64, HWCAP on AArch64). The parallel
+ *           regions themselves are not duplicated: the dispatch takes place once per block.
+ *           With 'make ISA=native' (default) all variants are compiled for the build machine.
+ * \warning  The variants may differ on the level of round-off errors as they may contract
+ *           multiplications and additions to fused multiply-add instructions differently.
+*/
+
+#include <cstdlib>
+#include <type_traits>
+#if defined(__aarch64__) && defined(__linux__)
+    #include <sys/auxv.h>
+#endif
+
+
+/// function attributes enabling additional instruction sets for a single function
+#if defined(__x86_64__) || defined(__i386__)
+    #define ISA_TARGET_AVX2      __attribute__((target("avx2,fma")))
+    #define ISA_TARGET_AVX512    __attribute__((target("avx512f,avx512cd,avx512vl,avx512dq,avx512bw,avx2,fma")))
+#elif defined(__aarch64__) && !defined(__clang__)
+    #define ISA_TARGET_SVE       __attribute__((target("+sve")))
+#endif
+
+
+/**\enum   Isa
+ * \brief  Instruction sets the collision kernels can be dispatched to
+ *         - Generic: baseline instruction set the binary was compiled for
+ *         - AVX2:    x86-64 with 256bit AVX2 and FMA (Haswell, Zen)
+ *         - AVX512:  x86-64 with 512bit AVX512 F, CD, VL, DQ and BW (Skylake-SP and newer)
+ *         - NEON:    AArch64 with 128bit Advanced SIMD (baseline of the architecture)
+ *         - SVE:     AArch64 with scalable vector extension (e.g. Graviton 3)
+*/
+enum class Isa { Generic, AVX2, AVX512, NEON, SVE };
+
+/**\fn        IsaName
+ * \brief     Name of an instruction set as used in the console output
+ *
+ * \param[in] isa   the instruction set
+ * \return    name of the instruction set
+*/
+inline char const* IsaName(Isa const isa)
+{
+    switch (isa)
+    {
+        case Isa::AVX2:   return "AVX2";
+        case Isa::AVX512: return "AVX512";
+        case Isa::NEON:   return "NEON";
+        case Isa::SVE:    return "SVE";
+        default:          return "Generic";
+    }
+}
+
+/**\fn        DetectIsa
+ * \brief     Determine the widest instruction set supported by the processor and by this binary
+ *
+ * \return    the widest supported instruction set
+*/
+inline Isa DetectIsa()
+{
+    #if defined(ISA_TARGET_AVX512)
+        __builtin_cpu_init();
+        if ((__builtin_cpu_supports("avx512f")  != 0) && (__builtin_cpu_supports("avx512cd") != 0) &&
+            (__builtin_cpu_supports("avx512vl") != 0) && (__builtin_cpu_supports("avx512dq") != 0) &&
+            (__builtin_cpu_supports("avx512bw") != 0))
+        {
+            return Isa::AVX512;
+        }
+        if ((__builtin_cpu_supports("avx2") != 0) && (__builtin_cpu_supports("fma") != 0))
+        {
+            return Isa::AVX2;
+        }
+        return Isa::Generic;
+    #elif defined(__aarch64__)
+        #if defined(ISA_TARGET_SVE) && defined(__linux__)
+            /// HWCAP_SVE (see asm/hwcap.h)
+            constexpr unsigned long HWCAP_SVE_ = 1ul << 22;
+            if ((getauxval(AT_HWCAP) & HWCAP_SVE_) != 0)
+            {
+                return Isa::SVE;
+            }
+        #endif
+        return Isa::NEON;
+    #else
+        return Isa::Generic;
+    #endif
+}
+
+/**\fn        IsIsaSupported
+ * \brief     Check if an instruction set can be used on the current processor
+ *
+ * \param[in] isa   the instruction set
+ * \return    Boolean true if the instruction set is supported, false otherwise
+*/
+inline bool IsIsaSupported(Isa const isa)
+{
+    static Isa const detected = DetectIsa();
+
+    switch (isa)
+    {
+        case Isa::Generic: return true;
+        case Isa::AVX2:    return (detected == Isa::AVX2) || (detected == Isa::AVX512);
+        case Isa::AVX512:  return (detected == Isa::AVX512);
+        case Isa::NEON:    return (detected == Isa::NEON) || (detected == Isa::SVE);
+        case Isa::SVE:     return (detected == Isa::SVE);
+        default:           return false;
+    }
+}
+
+/**\fn        ActiveIsa
+ * \brief     Instruction set the collision kernels are currently dispatched to (by default the
+ *            widest one supported by the processor)
+ *
+ * \return    Reference to the active instruction set
+*/
+inline Isa& ActiveIsa()
+{
+    static Isa isa = DetectIsa();
+    return isa;
+}
+
+/**\fn        SetIsa
+ * \brief     Dispatch the collision kernels to a given instruction set (e.g. for comparisons).
+ *            Must not be called while a kernel is running.
+ *
+ * \param[in] isa   the instruction set
+ * \return    Return exit success or failure (if the instruction set is not supported)
+*/
+inline int SetIsa(Isa const isa)
+{
+    if (IsIsaSupported(isa) == false)
+    {
+        return EXIT_FAILURE;
+    }
+
+    ActiveIsa() = isa;
+    return EXIT_SUCCESS;
+}
+
+
+/**\fn        IsaGeneric
+ * \brief     Variants of a function compiled for the different instruction sets: all calls inside
+ *            (in particular the collision of a single cell) are inlined and compiled for the
+ *            instruction set of the variant
+ *
+ * \tparam    FUNC   callable with (std::integral_constant<Isa,isa>)
+ * \param[in] func   the function to be called
+*/
+template <class FUNC>
+__attribute__((flatten)) void IsaGeneric(FUNC const& func)
+{
+    func(std::integral_constant<Isa,Isa::Generic>());
+}
+
+#ifdef ISA_TARGET_AVX2
+template <class FUNC>
+ISA_TARGET_AVX2 __attribute__((flatten)) void IsaAVX2(FUNC const& func)
+{
+    func(std::integral_constant<Isa,Isa::AVX2>());
+}
+#endif
+
+#ifdef ISA_TARGET_AVX512
+template <class FUNC>
+ISA_TARGET_AVX512 __attribute__((flatten)) void IsaAVX512(FUNC const& func)
+{
+    func(std::integral_constant<Isa,Isa::AVX512>());
+}
+#endif
+
+#ifdef ISA_TARGET_SVE
+template <class FUNC>
+ISA_TARGET_SVE __attribute__((flatten)) void IsaSVE(FUNC const& func)
+{
+    func(std::integral_constant<Isa,Isa::SVE>());
+}
+#endif
+
+/**\fn        DispatchIsa
+ * \brief     Call the variant of a function for the active instruction set
+ *
+ * \tparam    FUNC   callable with (std::integral_constant<Isa,isa>), e.g. a generic lambda that
+ *                   collides all cells of a block
+ * \param[in] func   the function to be called
+*/
+template <class FUNC>
+inline void DispatchIsa(FUNC const& func)
+{
+    switch (ActiveIsa())
+    {
+        #ifdef ISA_TARGET_AVX512
+        case Isa::AVX512:
+            IsaAVX512(func);
+            break;
+        #endif
+        #ifdef ISA_TARGET_AVX2
+        case Isa::AVX2:
+            IsaAVX2(func);
+            break;
+        #endif
+        #ifdef ISA_TARGET_SVE
+        case Isa::SVE:
+            IsaSVE(func);
+            break;
+        #endif
+        default:
+            IsaGeneric(func);
+            break;
+    }
+}
+
+#endif // CPU_DISPATCH_HPP_INCLUDED
@@ -12,6 +12,8 @@
 #endif
 #include <unordered_map>
 
+#include "cpu_dispatch.hpp"
+
 
 /**\fn    PrintDisclaimer
  * \brief Print small disclaimer and compiler settings to console
@@ -85,6 +87,7 @@ void PrintDisclaimer()
     #else
         std::cout << "not supported" << std::endl;
     #endif
+    std::cout << " Kernels dispatched to " << IsaName(ActiveIsa()) << " (selected at run time)" << std::endl;
 
     return;
 }
@@ -0,0 +1,42 @@
+#include "distribution.hpp"
+
+#include <iostream>
+#include <stdlib.h>
+
+
+#ifdef USE_MPI
+    Distribution::Distribution(int& argc, char**& argv)
+    {
+        int provided = MPI_THREAD_SINGLE;
+        MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+
+        if (provided < MPI_THREAD_FUNNELED)
+        {
+            std::cerr << "Fatal error: MPI implementation does not support funneled threading." << std::endl;
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank_);
+        MPI_Comm_size(MPI_COMM_WORLD, &size_);
+    }
+
+    Distribution::~Distribution()
+    {
+        MPI_Finalize();
+    }
+
+    int Distribution::GetRank() const
+    {
+        return rank_;
+    }
+
+    int Distribution::GetSize() const
+    {
+        return size_;
+    }
+
+    bool Distribution::IsRoot() const
+    {
+        return (rank_ == 0);
+    }
+#endif
@@ -0,0 +1,102 @@
+#ifndef DISTRIBUTION_HPP_INCLUDED
+#define DISTRIBUTION_HPP_INCLUDED
+
+/**
+ * \file     distribution.hpp
+ * \brief    Class for distributed memory parallelism settings
+ *
+ * \mainpage An artificial class that initialises and finalises the distributed memory parallel
+ *           environment MPI (RAII) and gives access to the rank of the current process
+ * \warning  Only available if compiled with MPI support ('make MPI=true' defines USE_MPI)
+*/
+
+#ifdef USE_MPI
+    #include <cstdint>
+    #include <mpi.h>
+
+    /**\class    Distribution
+     * \brief    Class for all variables regarding distributed memory parallelism
+     *           Variables as int instead of size_t because that way in MPI
+    */
+    class Distribution
+    {
+        private:
+            int rank_ = 0; ///< rank of the current process
+            int size_ = 1; ///< total number of processes
+
+        public:
+            /**\fn        Distribution
+             * \brief     Constructor of distribution class initialising MPI with funneled threading
+             *            (only the master thread of every OpenMP team communicates)
+             *
+             * \param[in] argc   number of command line arguments
+             * \param[in] argv   command line arguments
+            */
+            Distribution(int& argc, char**& argv);
+
+            /**\fn        ~Distribution
+             * \brief     Destructor of distribution class finalising MPI
+            */
+            ~Distribution();
+
+            Distribution(Distribution const&) = delete;
+            Distribution& operator= (Distribution const&) = delete;
+
+            /**\fn        GetRank
+             * \brief     Get rank of the current process
+             *
+             * \return    Return rank of the current process
+            */
+            int GetRank() const;
+
+            /**\fn        GetSize
+             * \brief     Get total number of processes
+             *
+             * \return    Return total number of processes
+            */
+            int GetSize() const;
+
+            /**\fn        IsRoot
+             * \brief     Check if the current process is the root process (e.g. for console output)
+             *
+             * \return    Return Boolean true if current process is root process, false otherwise
+            */
+            bool IsRoot() const;
+    };
+
+    /**\fn        MpiDatatype
+     * \brief     Corresponding MPI datatype of a floating data type used for simulation
+     *            or a storage data type of the populations
+     *
+     * \tparam    T   floating data type used for simulation or storage data type
+     * \return    Return corresponding MPI datatype
+    */
+    template <typename T>
+    inline MPI_Datatype MpiDatatype();
+
+    template <>
+    inline MPI_Datatype MpiDatatype<float>()
+    {
+        return MPI_FLOAT;
+    }
+
+    template <>
+    inline MPI_Datatype MpiDatatype<double>()
+    {
+        return MPI_DOUBLE;
+    }
+
+    template <>
+    inline MPI_Datatype MpiDatatype<long double>()
+    {
+        return MPI_LONG_DOUBLE;
+    }
+
+    template <>
+    inline MPI_Datatype MpiDatatype<uint16_t>()
+    {
+        return MPI_UINT16_T;
+    }
+#endif
+
+#endif // DISTRIBUTION_HPP_INCLUDED
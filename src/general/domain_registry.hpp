@@ -0,0 +1,130 @@
+#ifndef DOMAIN_REGISTRY_HPP_INCLUDED
+#define DOMAIN_REGISTRY_HPP_INCLUDED
+
+/**
+ * \file     domain_registry.hpp
+ * \mainpage Registry of the domain sizes and lattices the solver is compiled for
+ *
+ * \note     The resolution and the lattice are template parameters of all arrays and kernels so that
+ *           the indexing is constant-folded by the compiler. Instead of compiling a binary per case,
+ *           the simulation is compiled for a list of registered domains and the one matching the
+ *           settings read at run time is selected at startup. Adding a domain to the list in main.cpp
+ *           increases the compilation time but not the run time of the other domains.
+*/
+
+#include <iostream>
+
+#include "settings.hpp"
+
+
+/**\struct compiledDomain
+ * \brief  A domain size and lattice the simulation is compiled for
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam LT   static lattice::DdQq class containing discretisation parameters
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT>
+struct compiledDomain
+{
+    static constexpr unsigned int nx = NX;
+    static constexpr unsigned int ny = NY;
+    static constexpr unsigned int nz = NZ;
+    typedef LT lattice;
+
+    /**\fn        Matches
+     * \brief     Check if the domain corresponds to the settings of a simulation
+     *
+     * \param[in] settings   settings of the simulation
+     * \return    Boolean true if size and lattice match, false otherwise
+    */
+    static bool Matches(simulationSettings const& settings)
+    {
+        return (settings.nx == NX) && (settings.ny == NY) && (settings.nz == NZ) && (settings.speeds == LT::SPEEDS);
+    }
+};
+
+
+/**\class  DomainRegistry
+ * \brief  List of the domains the simulation is compiled for
+ *
+ * \tparam DOMAINS   compiledDomain types
+*/
+template <class... DOMAINS>
+class DomainRegistry
+{
+    public:
+        /**\fn        Dispatch
+         * \brief     Call a function with the compiled domain matching the settings of a simulation.
+         *            Stops the program with a list of the available domains if none matches.
+         *
+         * \tparam    FUNC       callable with (compiledDomain), e.g. a generic lambda that runs the
+         *                       simulation with the template arguments of decltype(domain)
+         * \param[in] settings   settings of the simulation
+         * \param[in] func       the function to be called
+         * \return    return value of the function
+        */
+        template <class FUNC>
+        static int Dispatch(simulationSettings const& settings, FUNC const& func)
+        {
+            int result = EXIT_FAILURE;
+            bool const isFound = ((DOMAINS::Matches(settings) && ((result = func(DOMAINS())), true)) || ...);
+
+            if (isFound == false)
+            {
+                std::cerr << "Fatal error: The solver was not compiled for a " << settings.nx << "x" << settings.ny << "x"
+                          << settings.nz << " domain with D3Q" << settings.speeds << " lattice." << std::endl;
+                Output(std::cerr);
+                std::cerr << "Add the domain to the registry in main.cpp and recompile." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            return result;
+        }
+
+        /**\fn        Dispatch
+         * \brief     Call a function with the compiled domain matching the settings of a simulation.
+         *            Falls back to a function without compiled domain (e.g. a generic solver with run-time
+         *            strides) if none matches.
+         *
+         * \tparam    FUNC       callable with (compiledDomain)
+         * \tparam    FALLBACK   callable without arguments
+         * \param[in] settings   settings of the simulation
+         * \param[in] func       the function to be called with the matching domain
+         * \param[in] fallback   the function to be called if no domain matches
+         * \return    return value of the function that was called
+        */
+        template <class FUNC, class FALLBACK>
+        static int Dispatch(simulationSettings const& settings, FUNC const& func, FALLBACK const& fallback)
+        {
+            int result = EXIT_FAILURE;
+            bool const isFound = ((DOMAINS::Matches(settings) && ((result = func(DOMAINS())), true)) || ...);
+
+            if (isFound == false)
+            {
+                std::cerr << "Warning: The solver was not compiled for a " << settings.nx << "x" << settings.ny << "x"
+                          << settings.nz << " domain with D3Q" << settings.speeds << " lattice." << std::endl;
+                Output(std::cerr);
+                std::cerr << "Falling back to the generic solver with run-time strides, add the domain to the registry "
+                          << "in main.cpp and recompile for full performance." << std::endl;
+                result = fallback();
+            }
+
+            return result;
+        }
+
+        /**\fn        Output
+         * \brief     Write a list of the compiled domains
+         *
+         * \param[in] stream   the stream the list should be written to
+        */
+        static void Output(std::ostream& stream)
+        {
+            stream << "Compiled domains:";
+            ((stream << " " << DOMAINS::nx << "x" << DOMAINS::ny << "x" << DOMAINS::nz << " D3Q" << DOMAINS::lattice::SPEEDS), ...);
+            stream << std::endl;
+        }
+};
+
+#endif // DOMAIN_REGISTRY_HPP_INCLUDED
@@ -0,0 +1,95 @@
+#ifndef GPU_HPP_INCLUDED
+#define GPU_HPP_INCLUDED
+
+/**
+ * \file     gpu.hpp
+ * \mainpage Portability layer for the CUDA and HIP device backend
+ *
+ * \note     The device backend is compiled with 'make GPU=cuda' (nvcc) or 'make GPU=hip' (hipcc).
+ *           All runtime calls are mapped to common gpu* names so that the kernels are written only
+ *           once. Without a device compiler only HOST_DEVICE is defined (empty) so that functions
+ *           shared between host and device (e.g. the memory layouts) can be compiled as usual.
+*/
+
+
+/**\def    HOST_DEVICE
+ * \brief  Qualifier for functions that are called on the host as well as on the device
+*/
+#if defined(__CUDACC__) || defined(__HIPCC__)
+    #define HOST_DEVICE    __host__ __device__
+#else
+    #define HOST_DEVICE
+#endif
+
+
+#if defined(__CUDACC__) || defined(__HIPCC__)
+
+    #include <iostream>
+    #include <stdlib.h>
+
+    #ifdef __HIPCC__
+        #include <hip/hip_runtime.h>
+
+        #define gpuError_t                hipError_t
+        #define gpuSuccess                hipSuccess
+        #define gpuGetErrorString         hipGetErrorString
+        #define gpuGetLastError           hipGetLastError
+        #define gpuMalloc                 hipMalloc
+        #define gpuFree                   hipFree
+        #define gpuMemcpy                 hipMemcpy
+        #define gpuMemset                 hipMemset
+        #define gpuMemcpyHostToDevice     hipMemcpyHostToDevice
+        #define gpuMemcpyDeviceToHost     hipMemcpyDeviceToHost
+        #define gpuDeviceSynchronize      hipDeviceSynchronize
+        #define gpuDeviceProp             hipDeviceProp_t
+        #define gpuGetDeviceProperties    hipGetDeviceProperties
+    #else
+        #include <cuda_runtime.h>
+
+        #define gpuError_t                cudaError_t
+        #define gpuSuccess                cudaSuccess
+        #define gpuGetErrorString         cudaGetErrorString
+        #define gpuGetLastError           cudaGetLastError
+        #define gpuMalloc                 cudaMalloc
+        #define gpuFree                   cudaFree
+        #define gpuMemcpy                 cudaMemcpy
+        #define gpuMemset                 cudaMemset
+        #define gpuMemcpyHostToDevice     cudaMemcpyHostToDevice
+        #define gpuMemcpyDeviceToHost     cudaMemcpyDeviceToHost
+        #define gpuDeviceSynchronize      cudaDeviceSynchronize
+        #define gpuDeviceProp             cudaDeviceProp
+        #define gpuGetDeviceProperties    cudaGetDeviceProperties
+    #endif
+
+    /// number of threads per thread block in x-direction (may be set by the compiler)
+    #ifndef GPU_BLOCK_SIZE
+        #define GPU_BLOCK_SIZE    128
+    #endif
+
+    /**\fn        GpuCheck
+     * \brief     Abort the simulation if a call to the device runtime failed
+     *
+     * \param[in] error   return value of the runtime call
+     * \param[in] file    source file of the call
+     * \param[in] line    line of the call
+    */
+    inline void GpuCheck(gpuError_t const error, char const* const file, int const line)
+    {
+        if (error != gpuSuccess)
+        {
+            std::cerr << "Fatal error: Device runtime error '" << gpuGetErrorString(error) << "' in "
+                      << file << ":" << line << "." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    /**\def       GPU_CHECK (call)
+     * \brief     Macro for checking the return value of a call to the device runtime
+     *
+     * \param[in] call   call to the device runtime (e.g. gpuMalloc(...))
+    */
+    #define GPU_CHECK(call)    GpuCheck((call), __FILE__, __LINE__)
+
+#endif
+
+#endif // GPU_HPP_INCLUDED
@@ -0,0 +1,538 @@
+#ifndef INSTRUMENTATION_HPP_INCLUDED
+#define INSTRUMENTATION_HPP_INCLUDED
+
+/**
+ * \file     instrumentation.hpp
+ * \mainpage Lightweight instrumentation of the phases of a time step (compiled with 'make PROFILE=true')
+ *
+ * \note     The time loop is split into named phases (e.g. boundaries, collision, export) with
+ *           PROFILE_PHASE("name") at the beginning of a scope. Within the parallel regions of the
+ *           kernels every thread brackets the work of a block with PROFILE_WORK() so that the busy
+ *           time of every thread is accumulated for the current phase: the remaining time until the
+ *           end of the phase is spent waiting at the barrier (load imbalance). With 'make PROFILE=perf'
+ *           the cycles, instructions and last level cache misses of every thread are additionally
+ *           counted with the Linux perf_event interface.
+ *           PROFILE_SUMMARY() prints a table of all phases at the end of the run and PROFILE_TRACE(path)
+ *           writes a timeline in the Chrome trace format (chrome://tracing, Perfetto). Phases must not be
+ *           nested and are only opened by the master thread outside of the parallel regions.
+ *           Without USE_PROFILING all macros are empty and the kernels are not affected at all.
+*/
+
+#ifdef USE_PROFILING
+
+    #include <algorithm>
+    #include <cstdint>
+    #include <fstream>
+    #include <iostream>
+    #include <stdio.h>
+    #include <string>
+    #include <vector>
+    #if __has_include (<omp.h>)
+        #include <omp.h>
+    #endif
+    #ifdef USE_PERF_EVENTS
+        #include <linux/perf_event.h>
+        #include <sys/ioctl.h>
+        #include <sys/syscall.h>
+        #include <unistd.h>
+    #endif
+
+    #include "memory_alignment.hpp"
+    #include "timer.hpp"
+
+
+    /// maximum number of events stored for the timeline (further events are only summarised)
+    #ifndef PROFILE_TRACE_LIMIT
+        #define PROFILE_TRACE_LIMIT    1000000
+    #endif
+
+    /// number of hardware counters per thread: cycles, instructions, last level cache misses
+    #define PROFILE_COUNTERS    3
+
+
+    /**\class  HardwareCounters
+     * \brief  Hardware counters of the calling thread (perf_event group, only with USE_PERF_EVENTS)
+    */
+    class HardwareCounters
+    {
+        public:
+            /// counters are opened once by every thread and are available if the kernel permits it
+            bool isAvailable_ = false;
+
+            HardwareCounters()
+            {
+                #ifdef USE_PERF_EVENTS
+                    uint64_t const config[PROFILE_COUNTERS] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES };
+                    for(unsigned int i = 0; i < PROFILE_COUNTERS; ++i)
+                    {
+                        perf_event_attr attr = {};
+                        attr.type           = PERF_TYPE_HARDWARE;
+                        attr.size           = sizeof(perf_event_attr);
+                        attr.config         = config[i];
+                        attr.disabled       = (i == 0);
+                        attr.exclude_kernel = 1;
+                        attr.exclude_hv     = 1;
+                        attr.read_format    = PERF_FORMAT_GROUP;
+                        fd_[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, (i == 0) ? -1 : fd_[0], 0));
+                        if (fd_[i] < 0)
+                        {
+                            return;
+                        }
+                    }
+                    ioctl(fd_[0], PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP);
+                    ioctl(fd_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+                    isAvailable_ = true;
+                #endif
+            }
+
+            ~HardwareCounters()
+            {
+                #ifdef USE_PERF_EVENTS
+                    for(unsigned int i = 0; i < PROFILE_COUNTERS; ++i)
+                    {
+                        if (fd_[i] >= 0)
+                        {
+                            close(fd_[i]);
+                        }
+                    }
+                #endif
+            }
+
+            HardwareCounters(HardwareCounters const&) = delete;
+            HardwareCounters& operator= (HardwareCounters const&) = delete;
+
+            /**\fn         Read
+             * \brief      Read the current values of all counters of the calling thread
+             *
+             * \param[out] values   current values (unchanged if the counters are not available)
+            */
+            inline void Read(uint64_t (&values)[PROFILE_COUNTERS]) const
+            {
+                #ifdef USE_PERF_EVENTS
+                    if (isAvailable_ == true)
+                    {
+                        uint64_t buffer[1 + PROFILE_COUNTERS] = {0};
+                        if (read(fd_[0], buffer, sizeof(buffer)) == static_cast<ssize_t>(sizeof(buffer)))
+                        {
+                            std::copy(buffer + 1, buffer + 1 + PROFILE_COUNTERS, values);
+                        }
+                    }
+                #else
+                    (void)values;
+                #endif
+            }
+
+        private:
+            #ifdef USE_PERF_EVENTS
+                int fd_[PROFILE_COUNTERS] = {-1, -1, -1};
+            #endif
+    };
+
+
+    /**\class  Profiler
+     * \brief  Accumulates the wall time of all phases, the busy and waiting time and hardware counters of
+     *         every thread per phase and the events of the timeline
+    */
+    class Profiler
+    {
+        public:
+            /**\struct threadRecord
+             * \brief  Work of a single thread within the current instance of a phase
+            */
+            struct alignas(CACHE_LINE) threadRecord
+            {
+                double   begin;                        ///< start of the first work item
+                double   end;                          ///< end of the last work item
+                double   busy;                         ///< accumulated time spent working
+                uint64_t counters[PROFILE_COUNTERS];   ///< accumulated hardware counters
+            };
+
+            /**\struct phaseRecord
+             * \brief  Accumulated statistics of a phase
+            */
+            struct phaseRecord
+            {
+                std::string           name;
+                size_t                calls;
+                double                wall;
+                std::vector<double>   busy;            ///< per thread
+                std::vector<double>   wait;            ///< per thread: time between last work item and end of phase
+                std::vector<uint64_t> counters;        ///< per thread and counter
+
+                phaseRecord(std::string const& phase, unsigned int const threads):
+                    name(phase), calls(0), wall(0.0), busy(threads, 0.0), wait(threads, 0.0),
+                    counters(static_cast<size_t>(threads)*PROFILE_COUNTERS, 0)
+                {
+                    return;
+                }
+            };
+
+            /**\struct traceEvent
+             * \brief  Complete event of the timeline (tid 0: phase, tid t+1: work of thread t)
+            */
+            struct traceEvent
+            {
+                unsigned int phase;
+                unsigned int tid;
+                double       begin;
+                double       duration;
+            };
+
+            unsigned int const THREADS_;
+            double const       START_;
+
+            std::vector<threadRecord> threads_;
+            std::vector<phaseRecord>  phases_;
+            std::vector<traceEvent>   events_;
+
+            /// currently active phase (0 outside of all phases)
+            unsigned int current_ = 0;
+
+
+            Profiler():
+                #ifdef _OPENMP
+                THREADS_(static_cast<unsigned int>(omp_get_max_threads())),
+                #else
+                THREADS_(1),
+                #endif
+                START_(Timer::Timestamp()), threads_(THREADS_), phases_(), events_()
+            {
+                phases_.emplace_back("(unassigned)", THREADS_);
+                ResetThreads();
+                events_.reserve(std::min<size_t>(PROFILE_TRACE_LIMIT, 1 << 16));
+            }
+
+            unsigned int Register(std::string const& name);
+            void         BeginPhase(unsigned int const phase);
+            void         EndPhase(unsigned int const phase, double const begin);
+
+            void Summary() const;
+            void ExportTrace(std::string const& fileName) const;
+
+        private:
+            inline void ResetThreads()
+            {
+                for(unsigned int t = 0; t < THREADS_; ++t)
+                {
+                    threads_[t] = { 0.0, 0.0, 0.0, {0} };
+                }
+            }
+    };
+
+    /**\fn     GetProfiler
+     * \brief  Profiler of the process (created on first use)
+     *
+     * \return reference to the profiler
+    */
+    inline Profiler& GetProfiler()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    /**\fn        Register
+     * \brief     Register a phase by its name (called once per call site)
+     *
+     * \param[in] name   name of the phase
+     * \return    index of the phase
+    */
+    inline unsigned int Profiler::Register(std::string const& name)
+    {
+        for(unsigned int i = 0; i < phases_.size(); ++i)
+        {
+            if (phases_[i].name == name)
+            {
+                return i;
+            }
+        }
+
+        phases_.emplace_back(name, THREADS_);
+        return static_cast<unsigned int>(phases_.size() - 1);
+    }
+
+    /**\fn        BeginPhase
+     * \brief     Set the current phase, all work items of the threads are accounted to it until EndPhase
+     *
+     * \param[in] phase   index of the phase
+    */
+    inline void Profiler::BeginPhase(unsigned int const phase)
+    {
+        current_ = phase;
+        ResetThreads();
+    }
+
+    /**\fn        EndPhase
+     * \brief     Close the current instance of a phase: accumulate the work of all threads and store the
+     *            events of the timeline
+     *
+     * \param[in] phase   index of the phase
+     * \param[in] begin   time stamp of the beginning of the phase
+    */
+    inline void Profiler::EndPhase(unsigned int const phase, double const begin)
+    {
+        double const end = Timer::Timestamp();
+
+        phaseRecord& record = phases_[phase];
+        ++record.calls;
+        record.wall += end - begin;
+
+        if (events_.size() < PROFILE_TRACE_LIMIT)
+        {
+            events_.push_back({ phase, 0, begin - START_, end - begin });
+        }
+
+        for(unsigned int t = 0; t < THREADS_; ++t)
+        {
+            threadRecord const& thread = threads_[t];
+            if (thread.busy > 0.0)
+            {
+                record.busy[t] += thread.busy;
+                record.wait[t] += end - thread.end;
+                for(unsigned int c = 0; c < PROFILE_COUNTERS; ++c)
+                {
+                    record.counters[t*PROFILE_COUNTERS + c] += thread.counters[c];
+                }
+
+                if (events_.size() < PROFILE_TRACE_LIMIT)
+                {
+                    events_.push_back({ phase, t + 1, thread.begin - START_, thread.end - thread.begin });
+                }
+            }
+        }
+
+        current_ = 0;
+        ResetThreads();
+    }
+
+    /**\fn        Summary
+     * \brief     Print a table with the wall time of all phases, the busy and waiting time of the threads and
+     *            the hardware counters (if available) to the console
+    */
+    inline void Profiler::Summary() const
+    {
+        double total = 0.0;
+        for(unsigned int i = 1; i < phases_.size(); ++i)
+        {
+            total += phases_[i].wall;
+        }
+
+        printf("\nProfile (%u threads)\n", THREADS_);
+        printf(" %-22s %8s %10s %6s %10s %10s %10s %9s\n", "phase", "calls", "wall (s)", "%", "busy (s)", "max (s)", "wait (s)", "imbalance");
+        for(unsigned int i = 0; i < phases_.size(); ++i)
+        {
+            phaseRecord const& record = phases_[i];
+            if ((record.calls == 0) && (i == 0))
+            {
+                continue;
+            }
+
+            double busy = 0.0, busyMax = 0.0, wait = 0.0;
+            unsigned int active = 0;
+            for(unsigned int t = 0; t < THREADS_; ++t)
+            {
+                busy   += record.busy[t];
+                wait   += record.wait[t];
+                busyMax = std::max(busyMax, record.busy[t]);
+                active += (record.busy[t] > 0.0);
+            }
+
+            if (active == 0)
+            {
+                printf(" %-22s %8zu %10.3f %6.1f %10s %10s %10s %9s\n", record.name.c_str(), record.calls, record.wall,
+                       (total > 0.0) ? 100.0*record.wall/total : 0.0, "-", "-", "-", "-");
+            }
+            else
+            {
+                printf(" %-22s %8zu %10.3f %6.1f %10.3f %10.3f %10.3f %9.2f\n", record.name.c_str(), record.calls, record.wall,
+                       (total > 0.0) ? 100.0*record.wall/total : 0.0, busy/active, busyMax, wait/active, busyMax*active/busy);
+            }
+        }
+
+        #ifdef USE_PERF_EVENTS
+            bool isCounted = false;
+            for(unsigned int i = 0; i < phases_.size(); ++i)
+            {
+                isCounted = isCounted || (std::count(phases_[i].counters.begin(), phases_[i].counters.end(), 0) != static_cast<long>(phases_[i].counters.size()));
+            }
+            if (isCounted == false)
+            {
+                printf("\n Hardware counters not available (see /proc/sys/kernel/perf_event_paranoid).\n");
+                return;
+            }
+
+            printf("\n %-22s %14s %14s %6s %14s\n", "phase", "cycles", "instructions", "IPC", "LLC misses");
+            for(unsigned int i = 0; i < phases_.size(); ++i)
+            {
+                phaseRecord const& record = phases_[i];
+                uint64_t counters[PROFILE_COUNTERS] = {0};
+                for(unsigned int t = 0; t < THREADS_; ++t)
+                {
+                    for(unsigned int c = 0; c < PROFILE_COUNTERS; ++c)
+                    {
+                        counters[c] += record.counters[t*PROFILE_COUNTERS + c];
+                    }
+                }
+
+                if (counters[0] > 0)
+                {
+                    printf(" %-22s %14llu %14llu %6.2f %14llu\n", record.name.c_str(), static_cast<unsigned long long>(counters[0]),
+                           static_cast<unsigned long long>(counters[1]), static_cast<double>(counters[1])/counters[0],
+                           static_cast<unsigned long long>(counters[2]));
+                }
+            }
+        #endif
+    }
+
+    /**\fn        ExportTrace
+     * \brief     Export the timeline in the Chrome trace event format (JSON, time stamps in microseconds)
+     *
+     * \param[in] fileName   name of the exported file (e.g. output/trace.json)
+    */
+    inline void Profiler::ExportTrace(std::string const& fileName) const
+    {
+        std::ofstream file(fileName);
+        if (file.is_open() == false)
+        {
+            std::cerr << "Fatal error: Trace file '" << fileName << "' could not be opened." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"phases\"}}";
+        for(unsigned int t = 0; t < THREADS_; ++t)
+        {
+            file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << t + 1 << ",\"args\":{\"name\":\"thread " << t << "\"}}";
+        }
+
+        file.precision(3);
+        file << std::fixed;
+        for(size_t i = 0; i < events_.size(); ++i)
+        {
+            traceEvent const& event = events_[i];
+            file << ",\n{\"name\":\"" << phases_[event.phase].name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.tid
+                 << ",\"ts\":" << 1e6*event.begin << ",\"dur\":" << 1e6*event.duration << "}";
+        }
+        file << "\n]}\n";
+
+        if (events_.size() >= PROFILE_TRACE_LIMIT)
+        {
+            std::cerr << "Warning: Timeline truncated to the first " << PROFILE_TRACE_LIMIT << " events." << std::endl;
+        }
+    }
+
+
+    /**\class  ProfilePhase
+     * \brief  Scope of a phase of the time step (see PROFILE_PHASE)
+    */
+    class ProfilePhase
+    {
+        public:
+            ProfilePhase(unsigned int const phase):
+                phase_(phase), begin_(Timer::Timestamp())
+            {
+                GetProfiler().BeginPhase(phase_);
+            }
+
+            ~ProfilePhase()
+            {
+                GetProfiler().EndPhase(phase_, begin_);
+            }
+
+            ProfilePhase(ProfilePhase const&) = delete;
+            ProfilePhase& operator= (ProfilePhase const&) = delete;
+
+        private:
+            unsigned int const phase_;
+            double const       begin_;
+    };
+
+
+    /**\class  ProfileWork
+     * \brief  Scope of a work item of a thread within a parallel region (see PROFILE_WORK)
+    */
+    class ProfileWork
+    {
+        public:
+            ProfileWork():
+                #ifdef _OPENMP
+                thread_(static_cast<unsigned int>(omp_get_thread_num())),
+                #else
+                thread_(0),
+                #endif
+                begin_(Timer::Timestamp())
+            {
+                Counters().Read(counters_);
+            }
+
+            ~ProfileWork()
+            {
+                Profiler& profiler = GetProfiler();
+                if (thread_ >= profiler.THREADS_)
+                {
+                    return;
+                }
+
+                uint64_t counters[PROFILE_COUNTERS] = {0};
+                Counters().Read(counters);
+                double const end = Timer::Timestamp();
+
+                Profiler::threadRecord& record = profiler.threads_[thread_];
+                record.begin = (record.busy > 0.0) ? record.begin : begin_;
+                record.end   = end;
+                record.busy += end - begin_;
+                for(unsigned int c = 0; c < PROFILE_COUNTERS; ++c)
+                {
+                    record.counters[c] += counters[c] - counters_[c];
+                }
+            }
+
+            ProfileWork(ProfileWork const&) = delete;
+            ProfileWork& operator= (ProfileWork const&) = delete;
+
+        private:
+            unsigned int const thread_;
+            double const       begin_;
+            uint64_t           counters_[PROFILE_COUNTERS] = {0};
+
+            static inline HardwareCounters& Counters()
+            {
+                thread_local HardwareCounters counters;
+                return counters;
+            }
+    };
+
+
+    #define PROFILE_CONCATENATE_(a, b)    a##b
+    #define PROFILE_CONCATENATE(a, b)     PROFILE_CONCATENATE_(a, b)
+
+    /**\def       PROFILE_PHASE (name)
+     * \brief     Account the remainder of the current scope to the phase with the given name
+    */
+    #define PROFILE_PHASE(name)    static unsigned int const PROFILE_CONCATENATE(profileId_, __LINE__) = GetProfiler().Register(name); \
+                                   ProfilePhase const PROFILE_CONCATENATE(profilePhase_, __LINE__)(PROFILE_CONCATENATE(profileId_, __LINE__))
+
+    /**\def       PROFILE_WORK ()
+     * \brief     Account the remainder of the current scope to the busy time of the calling thread
+    */
+    #define PROFILE_WORK()         ProfileWork const PROFILE_CONCATENATE(profileWork_, __LINE__)
+
+    /**\def       PROFILE_SUMMARY ()
+     * \brief     Print the table of all phases to the console
+    */
+    #define PROFILE_SUMMARY()      GetProfiler().Summary()
+
+    /**\def       PROFILE_TRACE (fileName)
+     * \brief     Export the timeline in the Chrome trace format
+    */
+    #define PROFILE_TRACE(fileName)    GetProfiler().ExportTrace(fileName)
+
+#else
+
+    #define PROFILE_PHASE(name)
+    #define PROFILE_WORK()
+    #define PROFILE_SUMMARY()
+    #define PROFILE_TRACE(fileName)
+
+#endif
+
+#endif // INSTRUMENTATION_HPP_INCLUDED
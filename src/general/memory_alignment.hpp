@@ -4,10 +4,572 @@
 /**
  * \file     align.hpp
  * \mainpage File for cache-related settings and macros
+ *
+ * \note     Large arrays are allocated with huge pages and an optional NUMA placement: the neighbours
+ *           of the A-A pattern are spread over many small pages which thrashes the TLB. Temporary
+ *           buffers are taken from a reusable arena instead of being allocated for every use.
 */
 
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdlib.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+
 /// size of the cache line of the architecture (typically 64 bytes)
 #define CACHE_LINE    64
 
+/// size of the 3D loop blocks shared by the initialisation and the collision kernels
+//  (memory is placed on NUMA nodes according to the thread touching it first, may be set by the compiler)
+#ifndef LOOP_BLOCK_SIZE
+    #define LOOP_BLOCK_SIZE    32
+#endif
+
+
+/**\class  DefaultInitAllocator
+ * \brief  Allocator that default-initialises instead of value-initialises elements
+ * \note   Resizing a std::vector of trivial types with the standard allocator zeroes the whole array
+ *         with a single thread and therefore places all its memory on the NUMA node of that thread.
+ *         With this allocator the elements remain untouched until they are written in parallel.
+ *
+ * \tparam T   data type of the elements
+ * \tparam A   underlying allocator (default = std::allocator)
+*/
+template <typename T, typename A = std::allocator<T>>
+class DefaultInitAllocator: public A
+{
+    typedef std::allocator_traits<A> AT;
+
+    public:
+        template <typename U>
+        struct rebind
+        {
+            using other = DefaultInitAllocator<U, typename AT::template rebind_alloc<U>>;
+        };
+
+        using A::A;
+
+        template <typename U>
+        void construct(U* ptr) noexcept(std::is_nothrow_default_constructible<U>::value)
+        {
+            ::new(static_cast<void*>(ptr)) U;
+        }
+
+        template <typename U, typename... Args>
+        void construct(U* ptr, Args&&... args)
+        {
+            AT::construct(static_cast<A&>(*this), ptr, std::forward<Args>(args)...);
+        }
+};
+
+
+/// page sizes of the huge pages (x86-64 and ARMv8 with 4 KiB base pages)
+#define HUGE_PAGE_2M    (static_cast<size_t>(1) << 21)
+#define HUGE_PAGE_1G    (static_cast<size_t>(1) << 30)
+
+/**\enum   Pages
+ * \brief  Page sizes of large allocations
+ *         - Small:       default pages of the operating system (4 KiB)
+ *         - Transparent: 2 MiB aligned mapping advised for transparent huge pages (falls back silently)
+ *         - Huge2M:      explicit 2 MiB pages of the reserved pool (vm.nr_hugepages), else Transparent
+ *         - Huge1G:      explicit 1 GiB pages of the reserved pool, else Huge2M
+ * \note   The A-A pattern accesses neighbours with strides of NX*ND and NX*NY*ND populations: with
+ *         small pages nearly every access in the z-direction requires another entry of the TLB.
+*/
+enum class Pages { Small, Transparent, Huge2M, Huge1G };
+
+/**\enum   NumaPolicy
+ * \brief  Placement of the pages of large allocations on the NUMA nodes
+ *         - Inherit:    policy of the process (first touch unless changed by Parallelism::SetPlacement)
+ *         - Local:      pages are placed on the NUMA node of the thread touching them first
+ *         - Interleave: pages are distributed round-robin over all NUMA nodes
+*/
+enum class NumaPolicy { Inherit, Local, Interleave };
+
+/**\struct memoryPolicy
+ * \brief  Page size and NUMA placement of an allocation
+*/
+struct memoryPolicy
+{
+    Pages      pages;
+    NumaPolicy numa;
+};
+
+/**\struct allocationHeader
+ * \brief  Bookkeeping of an allocation stored in the cache line in front of the returned pointer
+*/
+struct allocationHeader
+{
+    void*  base;   ///< start of the underlying allocation or mapping
+    size_t length; ///< length of the underlying allocation or mapping in bytes
+    Pages  pages;  ///< page size that was actually obtained
+};
+static_assert(sizeof(allocationHeader) <= CACHE_LINE, "Allocation header exceeds a cache line.");
+
+
+/**\fn        DefaultMemoryPolicy
+ * \brief     Policy used by all large arrays (populations, continuum, communication buffers).
+ *            Has to be changed before these are allocated.
+ *
+ * \return    Reference to the process-wide default policy
+*/
+inline memoryPolicy& DefaultMemoryPolicy()
+{
+    static memoryPolicy policy = { Pages::Transparent, NumaPolicy::Inherit };
+    return policy;
+}
+
+/**\fn        RoundUp
+ * \brief     Round a size up to a multiple of a given alignment
+ *
+ * \param[in] size        size in bytes
+ * \param[in] alignment   alignment in bytes (power of two)
+ * \return    smallest multiple of the alignment not smaller than the size
+*/
+constexpr size_t RoundUp(size_t const size, size_t const alignment)
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/**\fn        MapPages
+ * \brief     Map anonymous memory with the given page size
+ *
+ * \param[in] length   length of the mapping in bytes (multiple of the page size)
+ * \param[in] pages    page size (Transparent maps 2 MiB aligned memory and advises huge pages)
+ * \return    start of the mapping or nullptr if it failed
+*/
+inline void* MapPages(size_t const length, Pages const pages)
+{
+    #if defined(__linux__) && defined(MAP_ANONYMOUS)
+        if ((pages == Pages::Huge2M) || (pages == Pages::Huge1G))
+        {
+            #ifdef MAP_HUGETLB
+                /// the page size is encoded in the flags (see linux/mman.h)
+                constexpr int HUGE_SHIFT_ = 26;
+                int const size = (pages == Pages::Huge1G) ? 30 : 21;
+
+                void* const base = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (size << HUGE_SHIFT_), -1, 0);
+                return (base == MAP_FAILED) ? nullptr : base;
+            #else
+                return nullptr;
+            #endif
+        }
+
+        /// over-allocate and trim the mapping to a 2 MiB boundary so that it can be backed by huge pages
+        void* const raw = mmap(nullptr, length + HUGE_PAGE_2M, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+        {
+            return nullptr;
+        }
+
+        uintptr_t const start = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t const aligned = RoundUp(start, HUGE_PAGE_2M);
+        if (aligned > start)
+        {
+            munmap(raw, aligned - start);
+        }
+        munmap(reinterpret_cast<void*>(aligned + length), HUGE_PAGE_2M - (aligned - start));
+
+        void* const base = reinterpret_cast<void*>(aligned);
+        #ifdef MADV_HUGEPAGE
+            madvise(base, length, MADV_HUGEPAGE);
+        #endif
+        return base;
+    #else
+        return nullptr;
+    #endif
+}
+
+/**\fn        BindPages
+ * \brief     Set the NUMA placement of a mapping before its pages are touched. The allocation remains
+ *            valid if the placement fails (e.g. on a system without NUMA support).
+ *
+ * \param[in] base     start of the mapping
+ * \param[in] length   length of the mapping in bytes
+ * \param[in] numa     NUMA placement policy
+*/
+inline void BindPages(void* const base, size_t const length, NumaPolicy const numa)
+{
+    #if defined(__linux__) && defined(SYS_mbind)
+        /// memory policies of the Linux kernel (see numaif.h)
+        constexpr int MPOL_INTERLEAVE_ = 3;
+        constexpr int MPOL_LOCAL_      = 4;
+
+        if (numa == NumaPolicy::Local)
+        {
+            syscall(SYS_mbind, base, length, MPOL_LOCAL_, nullptr, 0, 0);
+        }
+        else if (numa == NumaPolicy::Interleave)
+        {
+            /// online NUMA nodes given as a list of ranges such as "0-1,3"
+            unsigned long mask = 0;
+            std::ifstream online("/sys/devices/system/node/online");
+            std::string range;
+            while (std::getline(online, range, ',') && !range.empty())
+            {
+                size_t const dash = range.find('-');
+                int const first = std::stoi(range.substr(0, dash));
+                int const last  = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+                for (int node = first; (node <= last) && (node < static_cast<int>(8*sizeof(mask))); ++node)
+                {
+                    mask |= (1ul << node);
+                }
+            }
+
+            if (mask != 0)
+            {
+                syscall(SYS_mbind, base, length, MPOL_INTERLEAVE_, &mask, 8*sizeof(mask) + 1, 0);
+            }
+        }
+    #else
+        static_cast<void>(base);
+        static_cast<void>(length);
+        static_cast<void>(numa);
+    #endif
+}
+
+/**\fn        AllocateAligned
+ * \brief     Allocate cache-line aligned memory. Allocations of at least a huge page are mapped with
+ *            the page size and NUMA placement of the policy, smaller ones use aligned_alloc. The pages
+ *            are not touched so that they are still placed by the parallel initialisation.
+ *
+ * \param[in] size     size of the allocation in bytes
+ * \param[in] policy   page size and NUMA placement (default = DefaultMemoryPolicy())
+ * \return    cache-line aligned pointer or nullptr if the memory could not be allocated
+*/
+inline void* AllocateAligned(size_t const size, memoryPolicy const policy = DefaultMemoryPolicy())
+{
+    size_t const total = size + CACHE_LINE;
+
+    allocationHeader header = { nullptr, 0, policy.pages };
+
+    if ((policy.pages != Pages::Small) && (total >= HUGE_PAGE_2M))
+    {
+        if (policy.pages == Pages::Huge1G)
+        {
+            header.length = RoundUp(total, HUGE_PAGE_1G);
+            header.base   = MapPages(header.length, Pages::Huge1G);
+            header.pages  = (header.base == nullptr) ? Pages::Huge2M : Pages::Huge1G;
+        }
+        if ((header.base == nullptr) && (header.pages == Pages::Huge2M))
+        {
+            header.length = RoundUp(total, HUGE_PAGE_2M);
+            header.base   = MapPages(header.length, Pages::Huge2M);
+            header.pages  = (header.base == nullptr) ? Pages::Transparent : Pages::Huge2M;
+        }
+        if (header.base == nullptr)
+        {
+            header.length = RoundUp(total, HUGE_PAGE_2M);
+            header.base   = MapPages(header.length, Pages::Transparent);
+            header.pages  = Pages::Transparent;
+        }
+        if (header.base != nullptr)
+        {
+            BindPages(header.base, header.length, policy.numa);
+        }
+    }
+
+    if (header.base == nullptr)
+    {
+        header.length = RoundUp(total, CACHE_LINE);
+        header.base   = aligned_alloc(CACHE_LINE, header.length);
+        header.pages  = Pages::Small;
+    }
+
+    if (header.base == nullptr)
+    {
+        return nullptr;
+    }
+
+    *static_cast<allocationHeader*>(header.base) = header;
+    return static_cast<char*>(header.base) + CACHE_LINE;
+}
+
+/**\fn        FreeAligned
+ * \brief     Release memory allocated with AllocateAligned
+ *
+ * \param[in] ptr   pointer returned by AllocateAligned (nullptr is ignored)
+*/
+inline void FreeAligned(void* const ptr)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+
+    allocationHeader const header = *reinterpret_cast<allocationHeader const*>(static_cast<char*>(ptr) - CACHE_LINE);
+
+    if (header.pages == Pages::Small)
+    {
+        free(header.base);
+    }
+    else
+    {
+        #if defined(__linux__) && defined(MAP_ANONYMOUS)
+            munmap(header.base, header.length);
+        #endif
+    }
+}
+
+/**\fn        GetPages
+ * \brief     Page size that was actually obtained for an allocation (huge pages fall back silently)
+ *
+ * \param[in] ptr   pointer returned by AllocateAligned
+ * \return    page size of the allocation
+*/
+inline Pages GetPages(void const* const ptr)
+{
+    return reinterpret_cast<allocationHeader const*>(static_cast<char const*>(ptr) - CACHE_LINE)->pages;
+}
+
+
+/**\class  AlignedAllocator
+ * \brief  Standard allocator routing containers (e.g. communication buffers) through AllocateAligned
+ *
+ * \tparam T   data type of the elements
+*/
+template <typename T>
+class AlignedAllocator
+{
+    public:
+        typedef T value_type;
+
+        AlignedAllocator() noexcept = default;
+
+        template <typename U>
+        AlignedAllocator(AlignedAllocator<U> const&) noexcept
+        {
+            return;
+        }
+
+        T* allocate(size_t const n)
+        {
+            void* const ptr = AllocateAligned(n*sizeof(T));
+            if (ptr == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(ptr);
+        }
+
+        void deallocate(T* const ptr, size_t const) noexcept
+        {
+            FreeAligned(ptr);
+        }
+};
+
+template <typename T, typename U>
+bool operator== (AlignedAllocator<T> const&, AlignedAllocator<U> const&) noexcept
+{
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!= (AlignedAllocator<T> const&, AlignedAllocator<U> const&) noexcept
+{
+    return false;
+}
+
+
+/**\struct arenaMarker
+ * \brief  State of an arena that allocations can be released to
+*/
+struct arenaMarker
+{
+    size_t offset;   ///< used bytes of the block
+    size_t overflow; ///< number of overflow allocations
+};
+
+/**\class  MemoryArena
+ * \brief  Reusable arena for temporary buffers (e.g. planes of the export)
+ * \note   Allocations are taken from a single block by incrementing an offset. Requests exceeding the
+ *         block are allocated separately and the block is enlarged to the peak demand as soon as the
+ *         arena is empty again, so that repeated use of the same buffers does not allocate any more.
+*/
+class MemoryArena
+{
+    public:
+        /**\brief Class constructor
+         * \param capacity   initial size of the block in bytes (default = 0, grows on demand)
+         * \param policy     page size and NUMA placement of the block (default = DefaultMemoryPolicy())
+        */
+        explicit MemoryArena(size_t const capacity = 0, memoryPolicy const policy = DefaultMemoryPolicy()):
+            policy_(policy), block_(nullptr), capacity_(0), offset_(0), peak_(0), overflowSize_(0), overflow_()
+        {
+            Reserve(capacity);
+        }
+
+        /**\brief Class destructor
+        */
+        ~MemoryArena()
+        {
+            for(void* const ptr: overflow_)
+            {
+                FreeAligned(ptr);
+            }
+            FreeAligned(block_);
+        }
+
+        MemoryArena(MemoryArena const&) = delete;
+        MemoryArena& operator= (MemoryArena const&) = delete;
+
+        /**\fn        Allocate
+         * \brief     Allocate a cache-line aligned buffer that is valid until the arena is released
+         *
+         * \tparam    T      data type of the elements
+         * \param[in] n      number of elements
+         * \return    pointer to the uninitialised buffer
+        */
+        template <typename T = unsigned char>
+        T* Allocate(size_t const n)
+        {
+            size_t const size = RoundUp(n*sizeof(T), CACHE_LINE);
+
+            void* ptr = nullptr;
+            if (offset_ + size <= capacity_)
+            {
+                ptr = block_ + offset_;
+                offset_ += size;
+            }
+            else
+            {
+                ptr = AllocateAligned(size, policy_);
+                if (ptr == nullptr)
+                {
+                    std::cerr << "Fatal error: Arena buffer could not be allocated." << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                overflow_.push_back(ptr);
+                overflowSize_ += size;
+            }
+
+            peak_ = std::max(peak_, offset_ + overflowSize_);
+            return static_cast<T*>(ptr);
+        }
+
+        /**\fn        Mark
+         * \brief     Current state of the arena
+         *
+         * \return    marker that all following allocations can be released to
+        */
+        arenaMarker Mark() const
+        {
+            return { offset_, overflow_.size() };
+        }
+
+        /**\fn        Release
+         * \brief     Release all allocations made after the marker. The block is enlarged to the peak
+         *            demand once the arena is empty.
+         *
+         * \param[in] marker   state of the arena returned by Mark
+        */
+        void Release(arenaMarker const& marker)
+        {
+            while (overflow_.size() > marker.overflow)
+            {
+                FreeAligned(overflow_.back());
+                overflow_.pop_back();
+            }
+            offset_ = marker.offset;
+
+            if ((offset_ == 0) && (overflow_.empty() == true))
+            {
+                overflowSize_ = 0;
+                Reserve(peak_);
+            }
+        }
+
+        /**\fn        GetCapacity
+         * \brief     Size of the block
+         *
+         * \return    capacity in bytes
+        */
+        size_t GetCapacity() const
+        {
+            return capacity_;
+        }
+
+    private:
+        memoryPolicy const policy_;
+        char*              block_;
+        size_t             capacity_;
+        size_t             offset_;
+        size_t             peak_;
+        size_t             overflowSize_;
+        std::vector<void*> overflow_;
+
+        /// replace the empty block by a larger one
+        void Reserve(size_t const capacity)
+        {
+            if (capacity > capacity_)
+            {
+                FreeAligned(block_);
+                block_ = static_cast<char*>(AllocateAligned(capacity, policy_));
+                capacity_ = (block_ == nullptr) ? 0 : capacity;
+            }
+        }
+};
+
+/**\class  ArenaScope
+ * \brief  Releases all allocations of an arena made during its lifetime
+*/
+class ArenaScope
+{
+    public:
+        /**\brief Class constructor
+         * \param arena   the arena the temporary buffers are taken from
+        */
+        explicit ArenaScope(MemoryArena& arena):
+            arena_(arena), marker_(arena.Mark())
+        {
+            return;
+        }
+
+        /**\brief Class destructor
+        */
+        ~ArenaScope()
+        {
+            arena_.Release(marker_);
+        }
+
+        ArenaScope(ArenaScope const&) = delete;
+        ArenaScope& operator= (ArenaScope const&) = delete;
+
+        template <typename T>
+        T* Allocate(size_t const n)
+        {
+            return arena_.template Allocate<T>(n);
+        }
+
+    private:
+        MemoryArena&      arena_;
+        arenaMarker const marker_;
+};
+
+/**\fn        ScratchArena
+ * \brief     Arena for temporary buffers of the calling thread (e.g. the solver or the export thread)
+ *
+ * \return    Reference to the arena of the calling thread
+*/
+inline MemoryArena& ScratchArena()
+{
+    thread_local MemoryArena arena;
+    return arena;
+}
+
 #endif // ALIGN_HPP_INCLUDED
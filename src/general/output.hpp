@@ -14,7 +14,10 @@
 #include <stdio.h>
 
 #include "../continuum/continuum.hpp"
+#include "../continuum/continuum_runtime.hpp"
+#include "../population/moments.hpp"
 #include "../population/population.hpp"
+#include "../population/population_runtime.hpp"
 
 
 /**\fn        InitialOutput
@@ -24,6 +27,10 @@
  * \tparam    NY    spatial resolution of the simulation domain in y-direction
  * \tparam    NZ    spatial resolution of the simulation domain in z-direction
  * \tparam    LT    static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP  number of populations stored side by side in the lattice
+ * \tparam    LY    memory layout policy of the populations
+ * \tparam    ST    storage policy of the populations
+ * \tparam    SP    streaming policy of the populations
  * \tparam    T     floating data type used for simulation
  * \param[in] pop   population object holding microscopic variables
  * \param[in] NT    number of simulation time steps
@@ -32,13 +39,56 @@
  * \param[in] U     characteristic velocity (measurement for temporal resolution)
  * \param[in] L     characteristic length scale of the problem
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void InitialOutput(Population<NX,NY,NZ,LT> const& pop, unsigned int const NT,
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void InitialOutput(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, unsigned int const NT,
                    T const Re, T const RHO, T const U, unsigned int const L)
 {
     printf("LBM simulation\n\n");
     printf("     domain size: %ux%ux%u\n", NX, NY, NZ);
     printf("         lattice: D%uQ%u\n", LT::DIM, LT::SPEEDS);
+    printf("         storage: %zu bytes per population\n", sizeof(pop.F_[0]));
+    printf("       streaming: %s\n", SP::NAME);
+
+    printf(" Reynolds number: %.2f\n", Re);
+    printf(" initial density: %.2g\n", RHO);
+    printf("    char. length: %.2u\n", L);
+    printf("  char. velocity: %.2g\n", U);
+    printf("\n");
+    printf("  kin. viscosity: %.2g\n", static_cast<double>(pop.NU_));
+    printf(" relaxation time: %.2g\n", static_cast<double>(pop.TAU_));
+    printf("\n");
+    printf("      #timesteps: %u\n", NT);
+    printf("\n");
+    #ifdef _OPENMP
+        printf("OpenMP\n");
+        printf("   #max. threads: %i\n", omp_get_num_procs());
+        printf("        #threads: %i\n", omp_get_max_threads());
+        printf("\n");
+    #endif
+}
+
+/**\fn        InitialOutput
+ * \brief     Simulation parameters and OpenMP settings output to console for a domain whose
+ *            resolution is only known at run time (see population_runtime.hpp).
+ *
+ * \tparam    LT    static lattice::DdQq class containing discretisation parameters
+ * \tparam    T     floating data type used for simulation
+ * \param[in] pop   population object holding microscopic variables
+ * \param[in] NT    number of simulation time steps
+ * \param[in] Re    Reynolds number of the simulation
+ * \param[in] RHO   simulation density
+ * \param[in] U     characteristic velocity (measurement for temporal resolution)
+ * \param[in] L     characteristic length scale of the problem
+*/
+template <class LT, typename T>
+void InitialOutput(RuntimePopulation<LT> const& pop, unsigned int const NT,
+                   T const Re, T const RHO, T const U, unsigned int const L)
+{
+    printf("LBM simulation\n\n");
+    printf("     domain size: %ux%ux%u (run-time strides)\n", pop.NX_, pop.NY_, pop.NZ_);
+    printf("         lattice: D%uQ%u\n", LT::DIM, LT::SPEEDS);
+    printf("         storage: %zu bytes per population\n", sizeof(pop.F_[0]));
+    printf("       streaming: %s\n", streaming::AA::NAME);
 
     printf(" Reynolds number: %.2f\n", Re);
     printf(" initial density: %.2g\n", RHO);
@@ -58,6 +108,51 @@ void InitialOutput(Population<NX,NY,NZ,LT> const& pop, unsigned int const NT,
     #endif
 }
 
+/**\fn        InitialOutput
+ * \brief     Simulation parameters and OpenMP settings output to console for a lattice stored in
+ *            moment space (see moments.hpp).
+ *
+ * \tparam    NX    spatial resolution of the simulation domain in x-direction
+ * \tparam    NY    spatial resolution of the simulation domain in y-direction
+ * \tparam    NZ    spatial resolution of the simulation domain in z-direction
+ * \tparam    LT    static lattice::DdQq class containing discretisation parameters
+ * \tparam    ST    storage policy of the moments
+ * \tparam    T     floating data type used for simulation
+ * \param[in] mom   moment population object holding microscopic variables
+ * \param[in] NT    number of simulation time steps
+ * \param[in] Re    Reynolds number of the simulation
+ * \param[in] RHO   simulation density
+ * \param[in] U     characteristic velocity (measurement for temporal resolution)
+ * \param[in] L     characteristic length scale of the problem
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST, typename T>
+void InitialOutput(MomentPopulation<NX,NY,NZ,LT,ST> const& mom, unsigned int const NT,
+                   T const Re, T const RHO, T const U, unsigned int const L)
+{
+    printf("LBM simulation\n\n");
+    printf("     domain size: %ux%ux%u\n", NX, NY, NZ);
+    printf("         lattice: D%uQ%u\n", LT::DIM, LT::SPEEDS);
+    printf("         storage: %zu bytes per moment (%u moments per cell)\n", sizeof(mom.M_[0]), mom.NM_);
+    printf("       streaming: pull (moments)\n");
+
+    printf(" Reynolds number: %.2f\n", Re);
+    printf(" initial density: %.2g\n", RHO);
+    printf("    char. length: %.2u\n", L);
+    printf("  char. velocity: %.2g\n", U);
+    printf("\n");
+    printf("  kin. viscosity: %.2g\n", static_cast<double>(mom.NU_));
+    printf(" relaxation time: %.2g\n", static_cast<double>(mom.TAU_));
+    printf("\n");
+    printf("      #timesteps: %u\n", NT);
+    printf("\n");
+    #ifdef _OPENMP
+        printf("OpenMP\n");
+        printf("   #max. threads: %i\n", omp_get_num_procs());
+        printf("        #threads: %i\n", omp_get_max_threads());
+        printf("\n");
+    #endif
+}
+
 /**\fn        StatusOutput
  * \brief     Output simulation status and progress in main loop.
  *
@@ -76,29 +171,36 @@ void StatusOutput(unsigned int const step, unsigned int NT)
  * \tparam    NY        spatial resolution of the simulation domain in y-direction
  * \tparam    NZ        spatial resolution of the simulation domain in z-direction
  * \tparam    LT        static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP      number of populations stored side by side in the lattice
+ * \tparam    LY        memory layout policy of the populations
+ * \tparam    ST        storage policy of the populations
+ * \tparam    SP        streaming policy of the populations
  * \tparam    T         floating data type used for simulation
  * \param[in] con       continuum object holding macroscopic variables
  * \param[in] pop       population object holding microscopic variables
  * \param[in] NT        number of time steps
  * \param[in] NT_PLOT   time between two plot time steps
  * \param[in] runtime   simulation runtime in seconds
+ * \param[in] processes number of processes the domain is distributed to (default = 1)
+ * \param[in] ghosts    number of ghost layers in z-direction of every process (default = 0)
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void PerformanceOutput(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT>& pop, unsigned int const NT, double NT_PLOT, double const runtime)
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void PerformanceOutput(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const NT, double NT_PLOT, double const runtime,
+                       unsigned int const processes = 1, unsigned int const ghosts = 0)
 {
     constexpr double bytesPerMiB = 1024.0 * 1024.0;
     constexpr double bytesPerGiB = bytesPerMiB * 1024.0;
 
-    size_t const memory = con.MEM_SIZE_ + pop.MEM_SIZE_;
+    size_t const memory = (con.MEM_SIZE_ + pop.MEM_SIZE_)*processes;
 
     unsigned int const  valuesRead = pop.SPEEDS_;
     unsigned int const valuesWrite = pop.SPEEDS_;
     unsigned int const valuesSaved = con.NM_;
 
-    size_t const nodesUpdated = static_cast<size_t>(NT)*NX*NY*static_cast<size_t>(NZ);
+    size_t const nodesUpdated = static_cast<size_t>(NT)*NX*NY*static_cast<size_t>(NZ - ghosts)*processes;
     size_t const   nodesSaved = nodesUpdated/NT_PLOT;
     double const        speed = 1e-6*nodesUpdated/runtime;
-    double const    bandwidth = (nodesUpdated*(valuesRead + valuesWrite) + nodesSaved*valuesSaved)*sizeof(T) / (runtime*bytesPerGiB);
+    double const    bandwidth = (nodesUpdated*(valuesRead + valuesWrite)*sizeof(pop.F_[0]) + nodesSaved*valuesSaved*sizeof(T)) / (runtime*bytesPerGiB);
 
     printf("\nPerformance\n");
     printf("   memory allocated: %.1f (MiB)\n", memory/bytesPerMiB);
@@ -108,4 +210,83 @@ void PerformanceOutput(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT>
     printf("    ideal bandwidth: %.1f (GiB/s)\n", bandwidth);
 }
 
+/**\fn        PerformanceOutput
+ * \brief     Output performance benchmark (simulation time, Mlups) at end of the simulation on a
+ *            domain whose resolution is only known at run time.
+ *
+ * \tparam    LT        static lattice::DdQq class containing discretisation parameters
+ * \tparam    T         floating data type used for simulation
+ * \param[in] con       continuum object holding macroscopic variables
+ * \param[in] pop       population object holding microscopic variables
+ * \param[in] NT        number of time steps
+ * \param[in] NT_PLOT   time between two plot time steps
+ * \param[in] runtime   simulation runtime in seconds
+*/
+template <class LT, typename T>
+void PerformanceOutput(RuntimeContinuum<T> const& con, RuntimePopulation<LT> const& pop, unsigned int const NT, double NT_PLOT, double const runtime)
+{
+    constexpr double bytesPerMiB = 1024.0 * 1024.0;
+    constexpr double bytesPerGiB = bytesPerMiB * 1024.0;
+
+    size_t const memory = con.MEM_SIZE_ + pop.MEM_SIZE_;
+
+    unsigned int const  valuesRead = pop.SPEEDS_;
+    unsigned int const valuesWrite = pop.SPEEDS_;
+    unsigned int const valuesSaved = con.NM_;
+
+    size_t const nodesUpdated = static_cast<size_t>(NT)*pop.NX_*pop.NY_*static_cast<size_t>(pop.NZ_);
+    size_t const   nodesSaved = nodesUpdated/NT_PLOT;
+    double const        speed = 1e-6*nodesUpdated/runtime;
+    double const    bandwidth = (nodesUpdated*(valuesRead + valuesWrite)*sizeof(pop.F_[0]) + nodesSaved*valuesSaved*sizeof(T)) / (runtime*bytesPerGiB);
+
+    printf("\nPerformance\n");
+    printf("   memory allocated: %.1f (MiB)\n", memory/bytesPerMiB);
+    printf("         #timesteps: %u\n", NT);
+    printf(" simulation runtime: %.2f (s)\n", runtime);
+    printf("              speed: %.2f (Mlups)\n", speed);
+    printf("    ideal bandwidth: %.1f (GiB/s)\n", bandwidth);
+}
+
+/**\fn        PerformanceOutput
+ * \brief     Output performance benchmark (simulation time, Mlups) at end of the simulation with a
+ *            lattice stored in moment space: every cell reads and writes its moments once.
+ *
+ * \tparam    NX        spatial resolution of the simulation domain in x-direction
+ * \tparam    NY        spatial resolution of the simulation domain in y-direction
+ * \tparam    NZ        spatial resolution of the simulation domain in z-direction
+ * \tparam    LT        static lattice::DdQq class containing discretisation parameters
+ * \tparam    ST        storage policy of the moments
+ * \tparam    T         floating data type used for simulation
+ * \param[in] con       continuum object holding macroscopic variables
+ * \param[in] mom       moment population object holding microscopic variables
+ * \param[in] NT        number of time steps
+ * \param[in] NT_PLOT   time between two plot time steps
+ * \param[in] runtime   simulation runtime in seconds
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST, typename T>
+void PerformanceOutput(Continuum<NX,NY,NZ,T> const& con, MomentPopulation<NX,NY,NZ,LT,ST> const& mom, unsigned int const NT, double NT_PLOT,
+                       double const runtime)
+{
+    constexpr double bytesPerMiB = 1024.0 * 1024.0;
+    constexpr double bytesPerGiB = bytesPerMiB * 1024.0;
+
+    size_t const memory = con.MEM_SIZE_ + mom.MEM_SIZE_;
+
+    unsigned int const  valuesRead = mom.NM_;
+    unsigned int const valuesWrite = mom.NM_;
+    unsigned int const valuesSaved = con.NM_;
+
+    size_t const nodesUpdated = static_cast<size_t>(NT)*NX*NY*static_cast<size_t>(NZ);
+    size_t const   nodesSaved = nodesUpdated/NT_PLOT;
+    double const        speed = 1e-6*nodesUpdated/runtime;
+    double const    bandwidth = (nodesUpdated*(valuesRead + valuesWrite)*sizeof(mom.M_[0]) + nodesSaved*valuesSaved*sizeof(T)) / (runtime*bytesPerGiB);
+
+    printf("\nPerformance\n");
+    printf("   memory allocated: %.1f (MiB)\n", memory/bytesPerMiB);
+    printf("         #timesteps: %u\n", NT);
+    printf(" simulation runtime: %.2f (s)\n", runtime);
+    printf("              speed: %.2f (Mlups)\n", speed);
+    printf("    ideal bandwidth: %.1f (GiB/s)\n", bandwidth);
+}
+
 #endif // OUTPUT_HPP_INCLUDED
@@ -1,15 +1,111 @@
 #include "parallelism.hpp"
-
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string>
+#include <utility>
+#include <vector>
 #if __has_include (<omp.h>)
     #include <omp.h>
 #endif
+#ifdef __linux__
+    #include <sched.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
 
-
 #ifdef _OPENMP
-    Parallelism::Parallelism()
+    /**\fn        ParseCpuList
+     * \brief     Parse a processor list of the Linux sysfs (e.g. "0-3,8-11")
+     *
+     * \param[in] list   string holding the processor list
+     * \return    vector holding all processors of the list
+    */
+    static std::vector<int> ParseCpuList(std::string const& list)
+    {
+        std::vector<int> cpus;
+        std::stringstream stream(list);
+        std::string range;
+
+        while (std::getline(stream, range, ','))
+        {
+            size_t const dash = range.find('-');
+            if (range.empty() == true)
+            {
+                continue;
+            }
+            else if (dash == std::string::npos)
+            {
+                cpus.push_back(std::stoi(range));
+            }
+            else
+            {
+                int const first = std::stoi(range.substr(0, dash));
+                int const last  = std::stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu)
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+
+        return cpus;
+    }
+
+    Parallelism::Parallelism():
+        cpus_(), nodes_(), thread_cpu_()
     {
         omp_set_num_threads(threads_max_);
+
+        #ifdef __linux__
+            /// processors this process may run on (e.g. restricted by a MPI launcher or taskset)
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            sched_getaffinity(0, sizeof(allowed), &allowed);
+
+            /// NUMA node of every processor: without sysfs information all processors belong to node 0
+            std::vector<std::pair<int,int>> nodeCpu;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &allowed))
+                {
+                    nodeCpu.push_back(std::make_pair(0, cpu));
+                }
+            }
+
+            for (int node = 0; node < CPU_SETSIZE; ++node)
+            {
+                std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                if (file.is_open() == false)
+                {
+                    continue;
+                }
+
+                std::string list;
+                std::getline(file, list);
+                std::vector<int> const cpus = ParseCpuList(list);
+
+                for (auto& nc: nodeCpu)
+                {
+                    if (std::find(cpus.begin(), cpus.end(), nc.second) != cpus.end())
+                    {
+                        nc.first = node;
+                    }
+                }
+            }
+
+            std::sort(nodeCpu.begin(), nodeCpu.end());
+            for (auto const& nc: nodeCpu)
+            {
+                nodes_.push_back(nc.first);
+                cpus_.push_back(nc.second);
+            }
+        #endif
     }
 
     void Parallelism::SetNestedParallelism(bool const nested)
@@ -24,6 +120,11 @@
             threads_num_ = threads_num;
             omp_set_num_threads(threads_num_);
 
+            if (affinity_ != Affinity::None)
+            {
+                return PinThreads();
+            }
+
             return EXIT_SUCCESS;
         }
         else
@@ -33,6 +134,113 @@
 
     }
 
+    int Parallelism::SetAffinity(Affinity const affinity)
+    {
+        if ((getenv("OMP_PROC_BIND") != nullptr) || (getenv("OMP_PLACES") != nullptr))
+        {
+            std::cerr << "Warning: Thread affinity controlled by environment (OMP_PROC_BIND/OMP_PLACES)." << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        affinity_ = affinity;
+        return PinThreads();
+    }
+
+    int Parallelism::PinThreads()
+    {
+        thread_cpu_.assign(threads_num_, -1);
+
+        #ifdef __linux__
+            int const numCpus  = static_cast<int>(cpus_.size());
+            int const numNodes = GetNumaNodes();
+
+            if (numCpus == 0)
+            {
+                return EXIT_FAILURE;
+            }
+
+            /// distinct NUMA nodes (processors are sorted by node)
+            std::vector<int> distinct(nodes_);
+            distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+            for (int thread = 0; thread < threads_num_; ++thread)
+            {
+                if (affinity_ == Affinity::Close)
+                {
+                    thread_cpu_[thread] = cpus_[thread % numCpus];
+                }
+                else if (affinity_ == Affinity::Spread)
+                {
+                    /// round-robin over the nodes, consecutive processors within a node
+                    int const node  = (thread % numNodes);
+                    auto const lo    = std::lower_bound(nodes_.begin(), nodes_.end(), distinct[node]);
+                    auto const hi    = std::upper_bound(nodes_.begin(), nodes_.end(), distinct[node]);
+                    int const first = static_cast<int>(std::distance(nodes_.begin(), lo));
+                    int const count = static_cast<int>(std::distance(lo, hi));
+                    thread_cpu_[thread] = cpus_[first + (thread / numNodes) % count];
+                }
+            }
+
+            int result = EXIT_SUCCESS;
+            int const threads = threads_num_;
+
+            #pragma omp parallel default(none) shared(result) firstprivate(threads) num_threads(threads)
+            {
+                int const thread = omp_get_thread_num();
+                cpu_set_t set;
+                CPU_ZERO(&set);
+
+                if (affinity_ == Affinity::None)
+                {
+                    for (int const cpu: cpus_)
+                    {
+                        CPU_SET(cpu, &set);
+                    }
+                }
+                else
+                {
+                    CPU_SET(thread_cpu_[thread], &set);
+                }
+
+                if (sched_setaffinity(0, sizeof(set), &set) != 0)
+                {
+                    #pragma omp atomic write
+                    result = EXIT_FAILURE;
+                }
+            }
+
+            return result;
+        #else
+            return EXIT_FAILURE;
+        #endif
+    }
+
+    int Parallelism::SetPlacement(Placement const placement)
+    {
+        #if defined(__linux__) && defined(SYS_set_mempolicy)
+            /// memory policies of the Linux kernel (see numaif.h)
+            constexpr int MPOL_DEFAULT_    = 0;
+            constexpr int MPOL_INTERLEAVE_ = 3;
+
+            unsigned long mask = 0;
+            for (int const node: nodes_)
+            {
+                if (node < static_cast<int>(8*sizeof(mask)))
+                {
+                    mask |= (1ul << node);
+                }
+            }
+
+            long const status = (placement == Placement::Interleave) ?
+                                syscall(SYS_set_mempolicy, MPOL_INTERLEAVE_, &mask, 8*sizeof(mask) + 1) :
+                                syscall(SYS_set_mempolicy, MPOL_DEFAULT_, nullptr, 0);
+
+            return (status == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+        #else
+            return (placement == Placement::FirstTouch) ? EXIT_SUCCESS : EXIT_FAILURE;
+        #endif
+    }
+
     int Parallelism::GetThreadsMax()
     {
         return threads_max_;
@@ -46,5 +254,45 @@
     int Parallelism::GetThreadsCurr()
     {
         return omp_get_num_threads();
+    }
+
+    int Parallelism::GetNumaNodes() const
+    {
+        std::vector<int> distinct(nodes_);
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+        return std::max(1, static_cast<int>(distinct.size()));
+    }
+
+    int Parallelism::GetThreadCpu(int const thread) const
+    {
+        if ((thread < 0) || (thread >= static_cast<int>(thread_cpu_.size())))
+        {
+            return -1;
+        }
+
+        return thread_cpu_[thread];
+    }
+
+    void Parallelism::AffinityOutput() const
+    {
+        printf("Affinity\n");
+        printf("     #NUMA nodes: %i\n", GetNumaNodes());
+        printf("   thread -> cpu:");
+        for (size_t thread = 0; thread < thread_cpu_.size(); ++thread)
+        {
+            printf(" %zu->%i", thread, thread_cpu_[thread]);
+        }
+        if (thread_cpu_.empty() == true)
+        {
+            printf(" not pinned");
+        }
+        printf("\n\n");
+    }
+
+    Parallelism& GetParallelism()
+    {
+        static Parallelism parallelism;
+        return parallelism;
     }
 #endif
+
\ No newline at end of file
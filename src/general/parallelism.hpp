@@ -7,13 +7,33 @@
  *
  * \mainpage An artificial class that allows for convenient changes of parameters that control
  *           the parallel environment OpenMP
+ * \note     On NUMA systems (e.g. dual-socket machines) memory pages are placed on the node of the
+ *           thread that touches them first. All arrays are therefore initialised with the same
+ *           block-to-thread mapping as the collision kernels. This is only effective if the threads
+ *           do not migrate between the nodes, which is why the threads can be pinned to cores.
 */
 
 #if __has_include (<omp.h>)
     #include <omp.h>
 #endif
+#include <vector>
 
 #ifdef _OPENMP
+    /**\enum     Affinity
+     * \brief    Thread affinity policies (similar to OMP_PROC_BIND)
+     *           - None:   threads may migrate freely (operating system default)
+     *           - Close:  consecutive threads are pinned to consecutive cores of the same NUMA node
+     *           - Spread: consecutive threads are distributed round-robin over the NUMA nodes
+    */
+    enum class Affinity { None, Close, Spread };
+
+    /**\enum     Placement
+     * \brief    Memory placement policies for all following allocations
+     *           - FirstTouch: pages are placed on the NUMA node of the thread touching them first
+     *           - Interleave: pages are distributed round-robin over all NUMA nodes
+    */
+    enum class Placement { FirstTouch, Interleave };
+
     /**\class    Parallelism
      * \brief    Class for all variables regarding parallelism
      *           Variables as int instead of size_t because that way in OpenMP
@@ -24,6 +44,18 @@
             int const threads_max_ = omp_get_num_procs(); ///< variable for maximum number of threads
             int       threads_num_ = omp_get_num_procs(); ///< number of currently used threads (default all)
 
+            Affinity         affinity_ = Affinity::None;  ///< current thread affinity policy
+            std::vector<int> cpus_;                       ///< processors available to this process sorted by NUMA node
+            std::vector<int> nodes_;                      ///< NUMA node of each available processor
+            std::vector<int> thread_cpu_;                 ///< processor each thread is pinned to (-1 if not pinned)
+
+            /**\fn        PinThreads
+             * \brief     Pin every thread of the current team to a processor according to the affinity policy
+             *
+             * \return    Return exit success or failure
+            */
+            int PinThreads();
+
         public:
             /**\fn        Parallelism
              * \brief     Default constructor of parallelism class
@@ -38,13 +70,31 @@
             void SetNestedParallelism(bool const nested);
 
             /**\fn        SetThreadsNum
-             * \brief     Change number of used threads.
+             * \brief     Change number of used threads. Threads are pinned again if an affinity is set.
              *
              * \param[in] threads_set  number of wished threads (max is given by threads_max)
              * \return    Return exit success or failure
             */
             int SetThreadsNum(int const threads_num);
 
+            /**\fn        SetAffinity
+             * \brief     Pin the threads to the processors available to this process. Ignored if the
+             *            affinity is already controlled by the environment (OMP_PROC_BIND or OMP_PLACES).
+             *
+             * \param[in] affinity  thread affinity policy
+             * \return    Return exit success or failure
+            */
+            int SetAffinity(Affinity const affinity);
+
+            /**\fn        SetPlacement
+             * \brief     Set the memory placement policy of all following allocations of this process.
+             *            Has to be called before large arrays are allocated.
+             *
+             * \param[in] placement  memory placement policy
+             * \return    Return exit success or failure
+            */
+            int SetPlacement(Placement const placement);
+
             /**\fn        GetThreadsMax
              * \brief     Get number of maximum number of possible threads.
              *
@@ -65,7 +115,36 @@
              * \return    Return number of threads currently active in parallel region
             */
             int GetThreadsCurr();
+
+            /**\fn        GetNumaNodes
+             * \brief     Get number of NUMA nodes the available processors belong to.
+             *
+             * \return    Return number of NUMA nodes
+            */
+            int GetNumaNodes() const;
+
+            /**\fn        GetThreadCpu
+             * \brief     Get processor a certain thread is pinned to.
+             *
+             * \param[in] thread  number of the thread
+             * \return    Return processor number or -1 if the thread is not pinned
+            */
+            int GetThreadCpu(int const thread) const;
+
+            /**\fn        AffinityOutput
+             * \brief     Output the thread affinity to the console.
+            */
+            void AffinityOutput() const;
     };
+
+    /**\fn        GetParallelism
+     * \brief     Parallel environment of this process shared by the set-up in main and the autotuner
+     *            (see autotuning.hpp), created on first use
+     *
+     * \return    Reference to the parallel environment
+    */
+    Parallelism& GetParallelism();
 #endif
 
 #endif // PARALLELISM_HPP_INCLUDED
+
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include <sys/stat.h>
 
 #include "../general/paths.hpp"
+#include "../population/moments.hpp"
 #include "../population/population.hpp"
 
 
@@ -23,6 +24,10 @@
  * \tparam    NY      spatial resolution of the simulation domain in y-direction
  * \tparam    NZ      spatial resolution of the simulation domain in z-direction
  * \tparam    LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP    number of populations stored side by side in the lattice
+ * \tparam    LY      memory layout policy of the populations
+ * \tparam    ST      storage policy of the populations
+ * \tparam    SP      streaming policy of the populations
  * \tparam    T       floating data type used for simulation
  * \param[in] pop     population object holding microscopic variables
  * \param[in] NT      number of simulation time steps
@@ -31,8 +36,8 @@
  * \param[in] L       characteristic length scale of the problem
  * \param[in] U       characteristic velocity (measurement for temporal resolution)
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void ExportParameters(Population<NX,NY,NZ,LT> const& pop, unsigned int const NT, T const Re, T const RHO_0, T const U, unsigned int const L)
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void ExportParameters(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, unsigned int const NT, T const Re, T const RHO_0, T const U, unsigned int const L)
 {
     struct stat info;
 
@@ -67,6 +72,7 @@ void ExportParameters(Population<NX,NY,NZ,LT> const& pop, unsigned int const NT,
         fprintf(exportFile, "\n");
         fprintf(exportFile, "~~~~~~~~~~~Lattice~~~~~~~~~~~\n");
         fprintf(exportFile, "lattice          D%uQ%u\n", LT::DIM, LT::SPEEDS);
+        fprintf(exportFile, "streaming        %s\n", SP::NAME);
         fprintf(exportFile, "nu               %f\n", pop.NU_);
         fprintf(exportFile, "tau              %f\n", pop.TAU_);
         fprintf(exportFile, "omega            %f\n", pop.OMEGA_);
@@ -82,4 +88,70 @@ void ExportParameters(Population<NX,NY,NZ,LT> const& pop, unsigned int const NT,
     }
 }
 
+/**\fn        ExportParameters
+ * \brief     Export parameters of a lattice stored in moment space to disk
+ *
+ * \tparam    NX      spatial resolution of the simulation domain in x-direction
+ * \tparam    NY      spatial resolution of the simulation domain in y-direction
+ * \tparam    NZ      spatial resolution of the simulation domain in z-direction
+ * \tparam    LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam    ST      storage policy of the moments
+ * \tparam    T       floating data type used for simulation
+ * \param[in] mom     moment population object holding microscopic variables
+ * \param[in] NT      number of simulation time steps
+ * \param[in] Re      Reynolds number of the simulation
+ * \param[in] RHO_0   simulation density
+ * \param[in] L       characteristic length scale of the problem
+ * \param[in] U       characteristic velocity (measurement for temporal resolution)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST, typename T>
+void ExportParameters(MomentPopulation<NX,NY,NZ,LT,ST> const& mom, unsigned int const NT, T const Re, T const RHO_0, T const U, unsigned int const L)
+{
+    struct stat info;
+
+    if (stat(OUTPUT_BIN_PATH.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+    {
+        std::string const fileName = OUTPUT_BIN_PATH + std::string("/parameters.txt");
+        FILE * const exportFile = fopen(fileName.c_str(), "w");
+
+        fprintf(exportFile, "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+        fprintf(exportFile, "~                           ~\n");
+        fprintf(exportFile, "~      LB-t                 ~\n");
+        fprintf(exportFile, "~      2019-2020            ~\n");
+        fprintf(exportFile, "~      Tobit Flatscher      ~\n");
+        fprintf(exportFile, "~      github.com/2b-t      ~\n");
+        fprintf(exportFile, "~      Parameter file       ~\n");
+        fprintf(exportFile, "~                           ~\n");
+        fprintf(exportFile, "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+        fprintf(exportFile, "\n");
+        fprintf(exportFile, "~~~~~Spatial resolution~~~~~~\n");
+        fprintf(exportFile, "NX               %u\n", NX);
+        fprintf(exportFile, "NY               %u\n", NY);
+        fprintf(exportFile, "NZ               %u\n", NZ);
+        fprintf(exportFile, "\n");
+        fprintf(exportFile, "~~~~~Temporal resolution~~~~~\n");
+        fprintf(exportFile, "NT               %u\n", NT);
+        fprintf(exportFile, "\n");
+        fprintf(exportFile, "~~~~~Physical parameters~~~~~\n");
+        fprintf(exportFile, "RE               %.2f\n", static_cast<double>(Re));
+        fprintf(exportFile, "RHO_0            %.2f\n", static_cast<double>(RHO_0));
+        fprintf(exportFile, "L                %u\n",   L);
+        fprintf(exportFile, "U                %.4f\n", static_cast<double>(U));
+        fprintf(exportFile, "\n");
+        fprintf(exportFile, "~~~~~~~~~~~Lattice~~~~~~~~~~~\n");
+        fprintf(exportFile, "lattice          D%uQ%u\n", LT::DIM, LT::SPEEDS);
+        fprintf(exportFile, "streaming        pull (moments)\n");
+        fprintf(exportFile, "nu               %f\n", mom.NU_);
+        fprintf(exportFile, "tau              %f\n", mom.TAU_);
+        fprintf(exportFile, "omega            %f\n", mom.OMEGA_);
+
+        fclose(exportFile);
+    }
+    else
+    {
+        std::cerr << "Fatal error: Directory '" << OUTPUT_BIN_PATH << "' not found." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
 #endif // PARAMETERS_EXPORT_HPP_INCLUDED
@@ -13,8 +13,23 @@
 std::string const BACKUP_IMPORT_PATH = "backup";
 std::string const BACKUP_EXPORT_PATH = "backup";
 
+/// Cache of voxelised geometries
+std::string const GEOMETRY_CACHE_PATH = "backup";
+
+/// Cache of the autotuned configurations (per machine and case)
+std::string const TUNING_CACHE_PATH = "backup";
+
 /// Export for visualisation
 std::string const OUTPUT_BIN_PATH = "output/bin";
 std::string const OUTPUT_VTK_PATH = "output/vtk";
 
+/// Time series of the in-situ monitors
+std::string const OUTPUT_MONITOR_PATH = "output";
+
+/// High-frequency time series of the probes
+std::string const OUTPUT_PROBE_PATH = "output";
+
+/// Timeline of the instrumentation
+std::string const OUTPUT_PROFILE_PATH = "output";
+
 #endif // PATHS_HPP_INCLUDED
@@ -0,0 +1,393 @@
+#ifndef SETTINGS_HPP_INCLUDED
+#define SETTINGS_HPP_INCLUDED
+
+/**
+ * \file     settings.hpp
+ * \mainpage Settings of a simulation that are read at run time from an input file or the command line
+ *
+ * \note     The input file holds one setting per line in the form 'key = value', lines starting with
+ *           '#' are ignored. The same keys can be given on the command line as '--key value' and
+ *           override the ones of the input file ('--input file'), e.g.
+ *               ./main.GCC --input case.txt --nx 96 --ny 48 --nz 48 --nt 2000
+ *           The domain size and the lattice select one of the compiled domains (see domain_registry.hpp).
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string.h>
+#include <vector>
+
+
+/**\enum   OutputCompression
+ * \brief  Compression of the exported macroscopic values (see output_stage.hpp)
+ *         - None:     values are written as they are
+ *         - Lossless: byte-shuffled values compressed with zlib
+ *         - Lossy:    error-bounded quantisation of the deviation from a predictor (absolute tolerance)
+*/
+enum class OutputCompression { None, Lossless, Lossy };
+
+/**\enum   Autotuning
+ * \brief  Startup autotuning of block shape, threads and kernel variant (see autotuning.hpp)
+ *         - Off:    compiled defaults (cubic loop blocks, all processors, widest instruction set)
+ *         - Cached: configuration from the cache of the machine and case, tuned only if missing
+ *         - Force:  tune again and replace the cached configuration
+*/
+enum class Autotuning { Off, Cached, Force };
+
+/**\enum   TimeLoop
+ * \brief  Parallel execution of the time steps on a single host (see wavefront.hpp and block_pipeline.hpp)
+ *         - Wavefront: every pair of time steps in a parallel region, planes synchronised with barriers
+ *         - Pipeline:  all time steps between two evaluations in a single parallel region, blocks only
+ *                      wait for their neighbouring blocks
+*/
+enum class TimeLoop { Wavefront, Pipeline };
+
+
+/**\struct outputSettings
+ * \brief  Reduction of the exported macroscopic values: subregion, stride, precision and compression
+*/
+struct outputSettings
+{
+    std::array<unsigned int,3> lower = {0, 0, 0}; ///< first cell of the exported subregion
+    std::array<unsigned int,3> upper = {0, 0, 0}; ///< cell past the end of the exported subregion (0 = end of domain)
+    unsigned int      stride      = 1;                       ///< export every stride-th cell in each direction
+    bool              single      = false;                   ///< downcast the values to single precision
+    OutputCompression compression = OutputCompression::None; ///< compression of the exported values
+    double            tolerance   = 1.0e-6;                  ///< absolute error bound of the lossy compression
+
+    /// the full field is exported unchanged
+    bool IsIdentity() const
+    {
+        return (lower == std::array<unsigned int,3>{0, 0, 0}) && (upper == std::array<unsigned int,3>{0, 0, 0}) &&
+               (stride == 1) && (single == false) && (compression == OutputCompression::None);
+    }
+};
+
+
+/**\struct simulationSettings
+ * \brief  Settings of a simulation (defaults correspond to the flow around a cylinder of main.cpp)
+*/
+struct simulationSettings
+{
+    unsigned int nx     = 192;    ///< domain resolution in x-direction
+    unsigned int ny     = 96;     ///< domain resolution in y-direction
+    unsigned int nz     = 96;     ///< domain resolution in z-direction
+    unsigned int speeds = 27;     ///< number of discrete velocities of the lattice (D3Q19 or D3Q27)
+    unsigned int nt     = 10000;  ///< number of time steps
+    double       re     = 1000.0; ///< Reynolds number
+    double       u      = 0.05;   ///< characteristic velocity in lattice units
+    unsigned int l      = 0;      ///< characteristic length in lattice units (0 = ny/5)
+    bool         save   = true;   ///< export the macroscopic values every nt/10 time steps
+    std::string  geometry = "cylinder"; ///< obstacle in the channel: cylinder, surface mesh (*.stl) or voxels (*.raw)
+    std::string  format   = "vtk";      ///< file format of the export: bin, vtk or vti
+    outputSettings output = {};         ///< reduction of the exported macroscopic values
+    Autotuning   autotune = Autotuning::Off; ///< startup autotuning: off, on (cached) or force
+    TimeLoop     timeloop = TimeLoop::Wavefront; ///< parallel execution of the time steps: wavefront or pipeline
+    double       schmidt  = 1.0;    ///< Schmidt number of the passive scalar (only with 'make SCALAR=true')
+    std::vector<double> ensemble = {}; ///< Reynolds numbers of the cases of an ensemble (only with 'make ENSEMBLE=K')
+    unsigned int checkpoint = 0;    ///< write a checkpoint of the populations every given number of time steps (0 = never)
+    std::string  restart    = "";   ///< checkpoint the simulation is restarted from (empty = initial conditions)
+};
+
+
+/**\fn        ParseUnsigned
+ * \brief     Convert the value of a setting to an unsigned integer. Stops the program if the value is invalid.
+ *
+ * \param[in] key     name of the setting (for the error message)
+ * \param[in] value   value of the setting
+ * \return    converted value
+*/
+inline unsigned int ParseUnsigned(std::string const& key, std::string const& value)
+{
+    char* end = nullptr;
+    unsigned long const result = strtoul(value.c_str(), &end, 10);
+
+    if ((value.empty() == true) || (value[0] == '-') || (*end != '\0'))
+    {
+        std::cerr << "Fatal error: Invalid value '" << value << "' of setting '" << key << "'." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return static_cast<unsigned int>(result);
+}
+
+/**\fn        ParseDouble
+ * \brief     Convert the value of a setting to a floating point number. Stops the program if the value is invalid.
+ *
+ * \param[in] key     name of the setting (for the error message)
+ * \param[in] value   value of the setting
+ * \return    converted value
+*/
+inline double ParseDouble(std::string const& key, std::string const& value)
+{
+    char* end = nullptr;
+    double const result = strtod(value.c_str(), &end);
+
+    if ((value.empty() == true) || (*end != '\0'))
+    {
+        std::cerr << "Fatal error: Invalid value '" << value << "' of setting '" << key << "'." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return result;
+}
+
+/**\fn        SetSetting
+ * \brief     Set a single setting by its name. Stops the program if the setting is unknown.
+ *
+ * \param[in,out] settings   settings of the simulation
+ * \param[in]     key        name of the setting (nx, ny, nz, lattice, nt, re, u, l, save, geometry, format,
+ *                           region, stride, precision, compression, tolerance, autotune, timeloop, schmidt,
+ *                           ensemble, checkpoint-every or restart)
+ * \param[in]     value      value of the setting
+*/
+inline void SetSetting(simulationSettings& settings, std::string const& key, std::string const& value)
+{
+    if (key == "nx")
+    {
+        settings.nx = ParseUnsigned(key, value);
+    }
+    else if (key == "ny")
+    {
+        settings.ny = ParseUnsigned(key, value);
+    }
+    else if (key == "nz")
+    {
+        settings.nz = ParseUnsigned(key, value);
+    }
+    else if (key == "lattice")
+    {
+        if ((value != "D3Q19") && (value != "D3Q27"))
+        {
+            std::cerr << "Fatal error: Unknown lattice '" << value << "' (D3Q19 or D3Q27)." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        settings.speeds = ParseUnsigned(key, value.substr(3));
+    }
+    else if (key == "nt")
+    {
+        settings.nt = ParseUnsigned(key, value);
+    }
+    else if (key == "re")
+    {
+        settings.re = ParseDouble(key, value);
+    }
+    else if (key == "u")
+    {
+        settings.u = ParseDouble(key, value);
+    }
+    else if (key == "l")
+    {
+        settings.l = ParseUnsigned(key, value);
+    }
+    else if (key == "save")
+    {
+        settings.save = (value == "true") || (value == "1");
+    }
+    else if (key == "geometry")
+    {
+        settings.geometry = value;
+    }
+    else if (key == "format")
+    {
+        if ((value != "bin") && (value != "vtk") && (value != "vti"))
+        {
+            std::cerr << "Fatal error: Unknown export format '" << value << "' (bin, vtk or vti)." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        settings.format = value;
+    }
+    else if (key == "region")
+    {
+        // lower and upper corner of the subregion 'x0,y0,z0,x1,y1,z1'
+        std::array<unsigned int,6> corners = {};
+        size_t begin = 0;
+        for(unsigned int i = 0; i < corners.size(); ++i)
+        {
+            size_t const end = value.find(',', begin);
+            if ((end == std::string::npos) != (i + 1 == corners.size()))
+            {
+                std::cerr << "Fatal error: Invalid value '" << value << "' of setting '" << key << "' (expected 'x0,y0,z0,x1,y1,z1')." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            corners[i] = ParseUnsigned(key, value.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        settings.output.lower = {corners[0], corners[1], corners[2]};
+        settings.output.upper = {corners[3], corners[4], corners[5]};
+    }
+    else if (key == "stride")
+    {
+        settings.output.stride = ParseUnsigned(key, value);
+    }
+    else if (key == "precision")
+    {
+        if ((value != "native") && (value != "single"))
+        {
+            std::cerr << "Fatal error: Unknown precision '" << value << "' (native or single)." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        settings.output.single = (value == "single");
+    }
+    else if (key == "compression")
+    {
+        if ((value != "none") && (value != "lossless") && (value != "lossy"))
+        {
+            std::cerr << "Fatal error: Unknown compression '" << value << "' (none, lossless or lossy)." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        settings.output.compression = (value == "lossless") ? OutputCompression::Lossless :
+                                      ((value == "lossy") ? OutputCompression::Lossy : OutputCompression::None);
+    }
+    else if (key == "tolerance")
+    {
+        settings.output.tolerance = ParseDouble(key, value);
+    }
+    else if (key == "autotune")
+    {
+        if ((value != "off") && (value != "on") && (value != "force"))
+        {
+            std::cerr << "Fatal error: Unknown autotuning '" << value << "' (off, on or force)." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        settings.autotune = (value == "on") ? Autotuning::Cached : ((value == "force") ? Autotuning::Force : Autotuning::Off);
+    }
+    else if (key == "timeloop")
+    {
+        if ((value != "wavefront") && (value != "pipeline"))
+        {
+            std::cerr << "Fatal error: Unknown time loop '" << value << "' (wavefront or pipeline)." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        settings.timeloop = (value == "pipeline") ? TimeLoop::Pipeline : TimeLoop::Wavefront;
+    }
+    else if (key == "schmidt")
+    {
+        settings.schmidt = ParseDouble(key, value);
+        if (settings.schmidt <= 0.0)
+        {
+            std::cerr << "Fatal error: Invalid value '" << value << "' of setting '" << key << "' (expected a positive Schmidt number)." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    else if (key == "ensemble")
+    {
+        // Reynolds numbers of the cases 'Re_0,Re_1,...'
+        settings.ensemble.clear();
+        size_t begin = 0;
+        while (begin <= value.size())
+        {
+            size_t const end = std::min(value.find(',', begin), value.size());
+            double const Re  = ParseDouble(key, value.substr(begin, end - begin));
+            if (Re <= 0.0)
+            {
+                std::cerr << "Fatal error: Invalid value '" << value << "' of setting '" << key << "' (expected positive Reynolds numbers 'Re_0,Re_1,...')." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            settings.ensemble.push_back(Re);
+            begin = end + 1;
+        }
+    }
+    else if (key == "checkpoint-every")
+    {
+        settings.checkpoint = ParseUnsigned(key, value);
+    }
+    else if (key == "restart")
+    {
+        settings.restart = value;
+    }
+    else
+    {
+        std::cerr << "Fatal error: Unknown setting '" << key << "'." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**\fn        ReadSettings
+ * \brief     Read the settings from an input file with one 'key = value' pair per line
+ *
+ * \param[in,out] settings   settings of the simulation (settings not given in the file remain unchanged)
+ * \param[in]     fileName   name of the input file
+*/
+inline void ReadSettings(simulationSettings& settings, std::string const& fileName)
+{
+    std::ifstream input(fileName);
+    if (input.is_open() == false)
+    {
+        std::cerr << "Fatal error: Input file '" << fileName << "' could not be opened." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::string const whitespace = " \t\r";
+    std::string line;
+    while (std::getline(input, line))
+    {
+        size_t const begin = line.find_first_not_of(whitespace);
+        if ((begin == std::string::npos) || (line[begin] == '#'))
+        {
+            continue;
+        }
+
+        size_t const separator = line.find('=');
+        if ((separator == std::string::npos) || (separator == begin))
+        {
+            std::cerr << "Fatal error: Invalid line '" << line << "' in input file '" << fileName << "'." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        std::string const key   = line.substr(begin, line.find_last_not_of(whitespace, separator - 1) + 1 - begin);
+        size_t const valueBegin = line.find_first_not_of(whitespace, separator + 1);
+        std::string const value = (valueBegin == std::string::npos) ? "" :
+                                  line.substr(valueBegin, line.find_last_not_of(whitespace) + 1 - valueBegin);
+        SetSetting(settings, key, value);
+    }
+}
+
+/**\fn        ParseSettings
+ * \brief     Read the settings from the command line: an input file given by '--input file' is read
+ *            first and all other settings given as '--key value' override it
+ *
+ * \param[in] argc    number of command line arguments
+ * \param[in] argv    command line arguments
+ * \param[in] first   index of the first command line argument holding settings
+ * \return    settings of the simulation
+*/
+inline simulationSettings ParseSettings(int const argc, char** const argv, int const first = 1)
+{
+    simulationSettings settings;
+
+    for (int i = first; i < argc; ++i)
+    {
+        if ((strcmp(argv[i], "--input") == 0) && (i + 1 < argc))
+        {
+            ReadSettings(settings, argv[i + 1]);
+        }
+    }
+
+    for (int i = first; i < argc; i += 2)
+    {
+        if ((strncmp(argv[i], "--", 2) != 0) || (i + 1 >= argc))
+        {
+            std::cerr << "Fatal error: Invalid command line argument '" << argv[i] << "' (expected '--key value')." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        if (strcmp(argv[i], "--input") != 0)
+        {
+            SetSetting(settings, argv[i] + 2, argv[i + 1]);
+        }
+    }
+
+    if (settings.l == 0)
+    {
+        settings.l = settings.ny/5;
+    }
+
+    return settings;
+}
+
+#endif // SETTINGS_HPP_INCLUDED
@@ -0,0 +1,121 @@
+#ifndef STEP_SCHEDULER_HPP_INCLUDED
+#define STEP_SCHEDULER_HPP_INCLUDED
+
+/**
+ * \file     step_scheduler.hpp
+ * \mainpage Scheduler that decides on which time steps the macroscopic values have to be evaluated
+ *
+ * \note     Writing the macroscopic values to the continuum adds four stores per cell and time step
+ *           although they are only needed by an export, probe or monitor every few hundred steps.
+ *           All consumers of the macroscopic values register their interval and the kernels are
+ *           instantiated with a compile-time flag so that the store is removed from all other steps.
+*/
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+
+/**\class StepScheduler
+ * \brief Collects the intervals of all consumers of the macroscopic values (export, probes, monitors)
+ *        and selects the kernel variant that evaluates the macroscopic values on the steps they are due
+*/
+class StepScheduler
+{
+    public:
+        /// intervals of all registered consumers
+        std::vector<size_t> intervals_;
+
+        /**\brief Class constructor: no consumers, no macroscopic values are evaluated
+        */
+        StepScheduler():
+            intervals_()
+        {
+            return;
+        }
+
+        /**\fn        Register
+         * \brief     Register a consumer that requires the macroscopic values every given number of steps
+         *
+         * \param[in] interval   number of time steps between two evaluations (0 = never)
+         * \return    identifier of the consumer
+        */
+        unsigned int Register(size_t const interval)
+        {
+            intervals_.push_back(interval);
+            return static_cast<unsigned int>(intervals_.size() - 1);
+        }
+
+        /**\fn        IsDue
+         * \brief     Check if a given consumer requires the macroscopic values of a time step
+         *
+         * \param[in] consumer   identifier of the consumer (see Register)
+         * \param[in] step       the time step of interest
+         * \return    Boolean true if the macroscopic values are required, else false
+        */
+        bool IsDue(unsigned int const consumer, size_t const step) const
+        {
+            return (intervals_[consumer] > 0) && (step % intervals_[consumer] == 0);
+        }
+
+        /**\fn        IsDue
+         * \brief     Check if any consumer requires the macroscopic values of a time step
+         *
+         * \param[in] step   the time step of interest
+         * \return    Boolean true if the macroscopic values are required, else false
+        */
+        bool IsDue(size_t const step) const
+        {
+            for(unsigned int consumer = 0; consumer < intervals_.size(); ++consumer)
+            {
+                if (IsDue(consumer, step) == true)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**\fn        NextDue
+         * \brief     Find the next time step on which any consumer requires the macroscopic values
+         *
+         * \param[in] step     the first time step of interest
+         * \param[in] stride   number of time steps between two candidates (e.g. 2 for pairs of time steps)
+         * \param[in] last     end of the range of interest (exclusive)
+         * \return    first candidate on which the macroscopic values are required, the last candidate
+         *            before the end of the range otherwise
+        */
+        size_t NextDue(size_t const step, size_t const stride, size_t const last) const
+        {
+            size_t candidate = step;
+            while ((candidate + stride < last) && (IsDue(candidate) == false))
+            {
+                candidate += stride;
+            }
+            return candidate;
+        }
+
+        /**\fn        Dispatch
+         * \brief     Call a function with a compile-time flag that signals if the macroscopic values
+         *            of a time step are required
+         *
+         * \tparam    FUNC   callable with (std::integral_constant<bool,save>), e.g. a generic lambda that
+         *                   calls a kernel with the template argument decltype(save)::value
+         * \param[in] step   the time step of interest
+         * \param[in] func   the function to be called
+        */
+        template <class FUNC>
+        void Dispatch(size_t const step, FUNC const& func) const
+        {
+            if (IsDue(step) == true)
+            {
+                func(std::true_type());
+            }
+            else
+            {
+                func(std::false_type());
+            }
+        }
+};
+
+#endif // STEP_SCHEDULER_HPP_INCLUDED
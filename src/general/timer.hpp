@@ -42,6 +42,16 @@ class Timer
             return runtime_;
         }
 
+        /**\fn     Timestamp
+         * \brief  Monotonic time stamp shared by all threads (e.g. for timelines)
+         *
+         * \return Time in seconds since an arbitrary but fixed point in time
+        */
+        static double Timestamp()
+        {
+            return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
         /**\fn     GetRuntime
          * \brief  Return runtime in seconds
          *
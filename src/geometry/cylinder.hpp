@@ -6,14 +6,18 @@
  * \mainpage 3D cylinder sample geometry import
 */
 
-#include <string.h>
+#include <array>
+#include <string>
 #include <vector>
 
 #include "../population/boundary/boundary.hpp"
+#include "voxeliser.hpp"
 
 
 /**\fn         Cylinder3D
- * \brief      Load pre-defined scenario of a three-dimensional flow around cylinder
+ * \brief      Load pre-defined scenario of a three-dimensional flow around cylinder. The axis of the
+ *             cylinder is normal to the flow direction: "x" (axis in z), "y" (axis in x) or "z" (axis
+ *             in y).
  *
  * \tparam     NX               simulation domain resolution in x-direction
  * \tparam     NY               simulation domain resolution in y-direction
@@ -22,7 +26,7 @@
  * \param[in]  radius           unsigned integer that holds the radius of the cylinder
  * \param[in]  position         array of unsigned integers that holds the position of the center of the
  *                              cylinder
- * \param[in]  orientation      std::string that holds the orientation
+ * \param[in]  orientation      std::string that holds the flow direction ("x", "y" or "z")
  * \param[in]  walls            a boolean variable that indicates if walls on the side should be
  *                              included (true) or not (wrong)
  * \param[out] wall             a pointer to a vector of relevant linear indices that correspond to a wall
@@ -33,54 +37,108 @@
  * \param[in]  RHO              simulation density
  * \param[in]  U                characteristic velocity (measurement for temporal resolution)
  * \param[in]  L                characteristic length scale of the problem
+ * \param[in]  origin           coordinates of the cell (0,0,0) in the units of radius and position
+ *                              (default = {0,0,0}, e.g. for the voxelisation of a refined patch)
+ * \param[in]  spacing          spacing of the cells in the units of radius and position (default = 1)
 */
 template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T = double>
 void Cylinder3D(unsigned int const radius, std::array<unsigned int,3> const& position,
+                std::string const& orientation, bool const walls,
+                std::vector<boundaryElement<T>>& wall,
+                std::vector<boundaryElement<T>>& inlet, std::vector<boundaryElement<T>>& outlet,
+                T const RHO, T const U, T const V, T const W,
+                std::array<double,3> const& origin = {0.0, 0.0, 0.0}, double const spacing = 1.0)
+{
+    /// cross-section spanned by the flow direction and the following axis
+    unsigned int const a = FlowAxis(orientation);
+    unsigned int const b = (a + 1) % 3;
+
+    Voxels<NX,NY,NZ> voxels;
+    voxels.Fill([&](unsigned int const x, unsigned int const y, unsigned int const z) -> bool
+    {
+        unsigned int const c[3] = {x, y, z};
+        double const da = origin[a] + spacing*c[a] - position[a];
+        double const db = origin[b] + spacing*c[b] - position[b];
+        return (da*da + db*db <= static_cast<double>(radius)*radius);
+    });
+
+    voxels.Boundaries(orientation, walls, wall, inlet, outlet, RHO, U, V, W);
+}
+
+/**\fn         Cylinder3D
+ * \brief      Load pre-defined scenario of a three-dimensional flow around cylinder on a domain whose
+ *             resolution is only known at run time (see population_runtime.hpp). Same cells and the same
+ *             order of the boundary elements as the compiled domains.
+ *
+ * \tparam     T                floating data type used for simulation
+ * \param[in]  NX               simulation domain resolution in x-direction
+ * \param[in]  NY               simulation domain resolution in y-direction
+ * \param[in]  NZ               simulation domain resolution in z-direction
+ * \param[in]  radius           unsigned integer that holds the radius of the cylinder
+ * \param[in]  position         array of unsigned integers that holds the position of the center of the
+ *                              cylinder
+ * \param[in]  orientation      std::string that holds the flow direction ("x", "y" or "z")
+ * \param[in]  walls            a boolean variable that indicates if walls on the side should be
+ *                              included (true) or not (wrong)
+ * \param[out] wall             vector of boundary elements that correspond to a wall
+ * \param[out] inlet            vector of boundary elements that correspond to the inlet
+ * \param[out] outlet           vector of boundary elements that correspond to the outlet
+ * \param[in]  RHO              density of the boundary elements
+ * \param[in]  U                velocity in x-direction of the boundary elements
+ * \param[in]  V                velocity in y-direction of the boundary elements
+ * \param[in]  W                velocity in z-direction of the boundary elements
+*/
+template <typename T = double>
+void Cylinder3D(unsigned int const NX, unsigned int const NY, unsigned int const NZ,
+                unsigned int const radius, std::array<unsigned int,3> const& position,
                 std::string const& orientation, bool const walls,
                 std::vector<boundaryElement<T>>& wall,
                 std::vector<boundaryElement<T>>& inlet, std::vector<boundaryElement<T>>& outlet,
                 T const RHO, T const U, T const V, T const W)
 {
-    if (orientation == "x")
+    /// cross-section spanned by the flow direction and the following axis
+    unsigned int const a = FlowAxis(orientation);
+    unsigned int const b = (a + 1) % 3;
+
+    unsigned int const n[3] = {NX, NY, NZ};
+    for(unsigned int z = 0; z < NZ; ++z)
     {
-        for(unsigned int z = 0; z < NZ; ++z)
+        for(unsigned int y = 0; y < NY; ++y)
         {
-            for(unsigned int y = 0; y < NY; ++y)
+            for(unsigned int x = 0; x < NX; ++x)
             {
-                for(unsigned int x = 0; x < NX; ++x)
+                unsigned int const c[3] = {x, y, z};
+                double const da = static_cast<double>(c[a]) - position[a];
+                double const db = static_cast<double>(c[b]) - position[b];
+
+                /// solid cells, then the faces parallel to the flow direction, then inlet and outlet
+                std::vector<boundaryElement<T>>* list = nullptr;
+                if (da*da + db*db <= static_cast<double>(radius)*radius)
+                {
+                    list = &wall;
+                }
+                else if (((a != 0) && ((x == 0) || (x == NX - 1))) ||
+                         ((a != 1) && ((y == 0) || (y == NY - 1))) ||
+                         ((a != 2) && ((z == 0) || (z == NZ - 1))))
                 {
-                    /// create element
-                    boundaryElement<T> const element = {x, y, z, RHO, U, V, W};
+                    list = (walls == true) ? &wall : nullptr;
+                }
+                else if (c[a] == 0)
+                {
+                    list = &inlet;
+                }
+                else if (c[a] == n[a] - 1)
+                {
+                    list = &outlet;
+                }
 
-                    /// add to corresponding boundary
-                    if ((x-position[0])*(x-position[0]) + (y-position[1])*(y-position[1]) <= radius*radius)
-                    {
-                        wall.push_back(element);
-                    }
-                    else if ((y == 0) || (y == NY-1) || (z == 0) || (z == NZ-1))
-                    {
-                        if (walls == true)
-                        {
-                            wall.push_back(element);
-                        }
-                    }
-                    else if (x == 0)
-                    {
-                        inlet.push_back(element);
-                    }
-                    else if (x == NX-1)
-                    {
-                        outlet.push_back(element);
-                    }
+                if (list != nullptr)
+                {
+                    list->push_back({x, y, z, RHO, U, V, W});
                 }
             }
         }
     }
-    else
-    {
-        std::cerr << "Warning: Geometry orientation " << orientation << " not found." << std::endl;
-        exit(EXIT_FAILURE);
-    }
 }
 
 #endif // CYLINDER_HPP_INCLUDED
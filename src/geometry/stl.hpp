@@ -0,0 +1,135 @@
+#ifndef STL_HPP_INCLUDED
+#define STL_HPP_INCLUDED
+
+/**
+ * \file     stl.hpp
+ * \mainpage Import of triangulated surfaces from binary and ASCII stereolithography (*.stl) files
+ *
+ * \note     Binary files are recognised by their size (80 byte header, number of triangles and 50 bytes
+ *           per triangle), all other files have to be ASCII files starting with 'solid'. Only the
+ *           vertices are imported: the normals are not required for the voxelisation, which relies on
+ *           the parity of the intersections (see voxeliser.hpp).
+*/
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string.h>
+#include <vector>
+
+
+/**\struct stlTriangle
+ * \brief  Triangle of a surface mesh
+*/
+struct stlTriangle
+{
+    float vertex[3][3]; ///< coordinates (x,y,z) of the three vertices
+};
+
+
+/**\fn        ReadGeometryFile
+ * \brief     Read a whole geometry file into memory. Stops the program if the file can not be read.
+ *
+ * \param[in] fileName   name of the file
+ * \return    content of the file
+*/
+inline std::string ReadGeometryFile(std::string const& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+    if (file.is_open() == false)
+    {
+        std::cerr << "Fatal error: Geometry file '" << fileName << "' could not be opened." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::string data(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    if ((data.empty() == false) && (file.read(&data[0], static_cast<std::streamsize>(data.size())).good() == false))
+    {
+        std::cerr << "Fatal error: Geometry file '" << fileName << "' could not be read." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return data;
+}
+
+/**\fn        ParseStl
+ * \brief     Extract the triangles of a binary or ASCII stereolithography file. Stops the program if the
+ *            content is not a valid stereolithography file.
+ *
+ * \param[in] data       content of the file
+ * \param[in] fileName   name of the file (for the error messages)
+ * \return    all triangles of the surface
+*/
+inline std::vector<stlTriangle> ParseStl(std::string const& data, std::string const& fileName)
+{
+    std::vector<stlTriangle> mesh;
+
+    /// binary: header, number of triangles, per triangle normal, three vertices and attributes
+    constexpr size_t HEADER   = 80;
+    constexpr size_t TRIANGLE = 50;
+    uint32_t count = 0;
+    if (data.size() >= HEADER + sizeof(count))
+    {
+        memcpy(&count, data.data() + HEADER, sizeof(count));
+    }
+
+    if ((data.size() >= HEADER + sizeof(count)) && (data.size() == HEADER + sizeof(count) + TRIANGLE*count))
+    {
+        mesh.resize(count);
+        for(size_t i = 0; i < count; ++i)
+        {
+            memcpy(mesh[i].vertex, data.data() + HEADER + sizeof(count) + TRIANGLE*i + 3*sizeof(float), sizeof(mesh[i].vertex));
+        }
+        return mesh;
+    }
+
+    /// ASCII: 'solid' followed by facets with three 'vertex x y z' lines each
+    if (data.compare(0, 5, "solid") != 0)
+    {
+        std::cerr << "Fatal error: Geometry file '" << fileName << "' is neither a binary nor an ASCII stereolithography file." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    char const* curr = data.c_str();
+    unsigned int vertices = 0;
+    stlTriangle triangle = {};
+    while ((curr = strstr(curr, "vertex")) != nullptr)
+    {
+        curr += strlen("vertex");
+        for(unsigned int c = 0; c < 3; ++c)
+        {
+            char* end = nullptr;
+            triangle.vertex[vertices][c] = strtof(curr, &end);
+            if (end == curr)
+            {
+                std::cerr << "Fatal error: Invalid vertex in geometry file '" << fileName << "'." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            curr = end;
+        }
+
+        if (++vertices == 3)
+        {
+            mesh.push_back(triangle);
+            vertices = 0;
+        }
+    }
+
+    return mesh;
+}
+
+/**\fn        ImportStl
+ * \brief     Import the triangles of a binary or ASCII stereolithography file
+ *
+ * \param[in] fileName   name of the file
+ * \return    all triangles of the surface
+*/
+inline std::vector<stlTriangle> ImportStl(std::string const& fileName)
+{
+    return ParseStl(ReadGeometryFile(fileName), fileName);
+}
+
+#endif // STL_HPP_INCLUDED
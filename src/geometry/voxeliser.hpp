@@ -0,0 +1,769 @@
+#ifndef VOXELISER_HPP_INCLUDED
+#define VOXELISER_HPP_INCLUDED
+
+/**
+ * \file     voxeliser.hpp
+ * \mainpage Parallel voxelisation of geometries and construction of the boundary lists
+ *
+ * \note     The solid cells of a geometry are held as one byte per cell. They are either given by a
+ *           predicate (e.g. an analytic obstacle), voxelised from a closed surface mesh or imported from
+ *           a raw voxel file. Surface meshes are voxelised by casting a ray in x-direction through the
+ *           centres of every row of cells: the triangles are binned by their bounding box in the y-z
+ *           plane, the intersections of every ray are sorted and the cells between pairs of
+ *           intersections are solid. Shared edges and vertices are assigned to a single triangle by a
+ *           top-left rule so that every crossing of the surface is counted exactly once.
+ *           The boundary lists (walls, inlet and outlet) are collected plane by plane in parallel:
+ *           every plane is counted before it is filled and the planes are concatenated in order into
+ *           vectors that are reserved once, which reproduces the order of a serial loop without
+ *           reallocations.
+ *           Voxelised meshes are cached to disk (bit-packed) together with a checksum of the mesh and of
+ *           its transformation so that subsequent runs of the same case only have to read the voxels.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../general/memory_alignment.hpp"
+#include "../general/paths.hpp"
+#include "../general/timer.hpp"
+#include "../population/boundary/boundary.hpp"
+#include "stl.hpp"
+
+
+/// cache format of voxelised geometries
+constexpr char     VOXEL_CACHE_MAGIC[8] = {'L','B','-','t','V','O','X','\0'};
+constexpr uint32_t VOXEL_CACHE_VERSION  = 1;
+
+/**\struct voxelCacheHeader
+ * \brief  Header of a cached voxelised geometry followed by the bit-packed voxels (64 cells per word)
+*/
+struct voxelCacheHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t nx, ny, nz; ///< resolution
+    uint64_t key;        ///< checksum of the source of the geometry and of its transformation
+};
+
+
+/**\fn        FlowAxis
+ * \brief     Axis of the main flow direction given by an orientation. Stops the program if the
+ *            orientation is unknown.
+ *
+ * \param[in] orientation   std::string that holds the orientation ("x", "y" or "z")
+ * \return    index of the axis (0, 1 or 2)
+*/
+inline unsigned int FlowAxis(std::string const& orientation)
+{
+    if ((orientation != "x") && (orientation != "y") && (orientation != "z"))
+    {
+        std::cerr << "Warning: Geometry orientation " << orientation << " not found." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return static_cast<unsigned int>(orientation[0] - 'x');
+}
+
+/**\fn        GeometryChecksum
+ * \brief     64-bit FNV-1a checksum of a memory region (e.g. the content of a geometry file)
+ *
+ * \param[in] data   pointer to the memory region
+ * \param[in] size   size of the memory region in bytes
+ * \param[in] hash   checksum of the preceding data (default = offset basis)
+ * \return    checksum of the memory region
+*/
+inline uint64_t GeometryChecksum(void const* const data, size_t const size, uint64_t hash = 0xcbf29ce484222325ull)
+{
+    constexpr uint64_t prime = 0x100000001b3ull;
+    unsigned char const* const bytes = static_cast<unsigned char const*>(data);
+
+    for(size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i])*prime;
+    }
+
+    return hash;
+}
+
+/**\fn        RayIntersection
+ * \brief     Intersection of a ray in positive x-direction with a triangle. Points on an edge or a
+ *            vertex are only assigned to the triangles owning them according to the top-left rule of
+ *            the projection onto the y-z plane, so that neighbouring triangles never count the same
+ *            crossing twice. Triangles parallel to the ray are never intersected.
+ *
+ * \param[in]  triangle   the triangle
+ * \param[in]  y          y coordinate of the ray
+ * \param[in]  z          z coordinate of the ray
+ * \param[out] x          x coordinate of the intersection
+ * \return     Boolean true if the ray intersects the triangle, false otherwise
+*/
+inline bool RayIntersection(stlTriangle const& triangle, double const y, double const z, double& x)
+{
+    float const (&v)[3][3] = triangle.vertex;
+
+    /// orientation of the projection (counter-clockwise positive)
+    double const area = (static_cast<double>(v[1][1]) - v[0][1])*(static_cast<double>(v[2][2]) - v[0][2]) -
+                        (static_cast<double>(v[1][2]) - v[0][2])*(static_cast<double>(v[2][1]) - v[0][1]);
+    if (std::abs(area) < std::numeric_limits<double>::min())
+    {
+        return false;
+    }
+    double const sign = (area > 0.0) ? 1.0 : -1.0;
+
+    double e[3] = {0.0, 0.0, 0.0};
+    for(unsigned int k = 0; k < 3; ++k)
+    {
+        /// edge opposite to vertex k, evaluated with its end points in a fixed order (exactly antisymmetric)
+        float const (&p)[3] = v[(k + 1) % 3];
+        float const (&q)[3] = v[(k + 2) % 3];
+        bool const isOrdered = (p[1] < q[1]) || ((!(p[1] > q[1])) && (p[2] < q[2]));
+        float const (&a)[3] = (isOrdered == true) ? p : q;
+        float const (&b)[3] = (isOrdered == true) ? q : p;
+        double const edge = (static_cast<double>(b[1]) - a[1])*(z - a[2]) - (static_cast<double>(b[2]) - a[2])*(y - a[1]);
+        e[k] = sign*((isOrdered == true) ? edge : -edge);
+
+        if (e[k] < 0.0)
+        {
+            return false;
+        }
+        else if (!(e[k] > 0.0))
+        {
+            /// top-left rule: an edge is owned if it points downwards or horizontally to the left
+            double const dy = sign*(static_cast<double>(q[1]) - p[1]);
+            double const dz = sign*(static_cast<double>(q[2]) - p[2]);
+            if (!((dz < 0.0) || ((!(dz > 0.0)) && (dy < 0.0))))
+            {
+                return false;
+            }
+        }
+    }
+
+    double const sum = e[0] + e[1] + e[2];
+    if (!(sum > 0.0))
+    {
+        return false;
+    }
+    x = (e[0]*v[0][0] + e[1]*v[1][0] + e[2]*v[2][0])/sum;
+
+    return true;
+}
+
+
+/**\class  Voxels
+ * \brief  Solid cells of a geometry on the simulation domain and the boundary lists derived from them
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+class Voxels
+{
+    public:
+        static constexpr size_t CELLS_ = static_cast<size_t>(NX)*NY*NZ;
+
+        /// solid (1) and fluid (0) cells (not initialised on resize, first touched plane by plane)
+        std::vector<uint8_t, DefaultInitAllocator<uint8_t>> solid_;
+
+
+        /**\brief Class constructor: all cells are fluid cells
+        */
+        Voxels();
+
+        /// access functions
+        inline bool   IsSolid(unsigned int const x, unsigned int const y, unsigned int const z) const;
+        inline size_t GetNumberOfSolidCells() const;
+
+        /// sources of the solid cells
+        template <class FUNC>
+        void Fill(FUNC const& isSolid);
+        void Voxelise(std::vector<stlTriangle> const& mesh, std::array<double,3> const& origin, double const spacing);
+        void ImportRaw(std::string const& fileName);
+
+        /// cache of voxelised geometries
+        bool ImportCache(std::string const& fileName, uint64_t const key);
+        void ExportCache(std::string const& fileName, uint64_t const key) const;
+
+        /// boundary lists (walls, inlet and outlet)
+        template <typename T>
+        void Boundaries(std::string const& orientation, bool const walls, std::vector<boundaryElement<T>>& wall,
+                        std::vector<boundaryElement<T>>& inlet, std::vector<boundaryElement<T>>& outlet,
+                        T const RHO, T const U, T const V, T const W) const;
+
+    private:
+        /// categories of the boundary lists
+        static constexpr unsigned int WALL_   = 0;
+        static constexpr unsigned int INLET_  = 1;
+        static constexpr unsigned int OUTLET_ = 2;
+        static constexpr unsigned int NONE_   = 3;
+
+        inline unsigned int Classify(unsigned int const x, unsigned int const y, unsigned int const z,
+                                     unsigned int const axis, bool const walls) const;
+};
+
+
+/**\fn        Voxels
+ * \brief     Allocate the voxels and mark all cells as fluid plane by plane in parallel
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+Voxels<NX,NY,NZ>::Voxels():
+    solid_(CELLS_)
+{
+    std::vector<uint8_t, DefaultInitAllocator<uint8_t>>& solid = solid_;
+
+    #pragma omp parallel for default(none) shared(solid) schedule(static)
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        memset(&solid[static_cast<size_t>(z)*NY*NX], 0, static_cast<size_t>(NY)*NX);
+    }
+}
+
+/**\fn        IsSolid
+ * \brief     Check if a cell is solid
+ *
+ * \param[in] x   x coordinate of the cell
+ * \param[in] y   y coordinate of the cell
+ * \param[in] z   z coordinate of the cell
+ * \return    Boolean true if the cell is solid, false otherwise
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline bool Voxels<NX,NY,NZ>::IsSolid(unsigned int const x, unsigned int const y, unsigned int const z) const
+{
+    return (solid_[(static_cast<size_t>(z)*NY + y)*NX + x] != 0);
+}
+
+/**\fn        GetNumberOfSolidCells
+ * \brief     Number of solid cells of the geometry
+ *
+ * \return    number of solid cells
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t Voxels<NX,NY,NZ>::GetNumberOfSolidCells() const
+{
+    return static_cast<size_t>(std::count(solid_.begin(), solid_.end(), uint8_t{1}));
+}
+
+/**\fn        Fill
+ * \brief     Mark all cells for which a predicate holds as solid (e.g. an analytic obstacle). Cells that
+ *            are already solid remain solid so that several obstacles can be combined.
+ *
+ * \tparam    FUNC      callable with (x, y, z) returning a Boolean
+ * \param[in] isSolid   predicate evaluated for every cell in parallel
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ> template <class FUNC>
+void Voxels<NX,NY,NZ>::Fill(FUNC const& isSolid)
+{
+    std::vector<uint8_t, DefaultInitAllocator<uint8_t>>& solid = solid_;
+
+    #pragma omp parallel for default(none) shared(solid, isSolid) schedule(static)
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        for(unsigned int y = 0; y < NY; ++y)
+        {
+            for(unsigned int x = 0; x < NX; ++x)
+            {
+                if (isSolid(x, y, z) == true)
+                {
+                    solid[(static_cast<size_t>(z)*NY + y)*NX + x] = 1;
+                }
+            }
+        }
+    }
+}
+
+/**\fn        Voxelise
+ * \brief     Mark all cells whose centre lies inside a closed surface mesh as solid. The centre of the
+ *            cell (x,y,z) is located at origin + spacing*(x,y,z) in the coordinates of the mesh. Rows of
+ *            cells with an odd number of intersections (surface not closed) are reported and their last
+ *            intersection is ignored.
+ *
+ * \param[in] mesh      triangles of the closed surface
+ * \param[in] origin    coordinates of the centre of the cell (0,0,0) in the coordinates of the mesh
+ * \param[in] spacing   spacing of the cells in the coordinates of the mesh
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+void Voxels<NX,NY,NZ>::Voxelise(std::vector<stlTriangle> const& mesh, std::array<double,3> const& origin, double const spacing)
+{
+    /// bins of BIN x BIN rows of cells in the y-z plane holding all triangles whose bounding box overlaps them
+    constexpr unsigned int    BIN = 8;
+    constexpr unsigned int BINS_Y = (NY + BIN - 1)/BIN;
+    constexpr unsigned int BINS_Z = (NZ + BIN - 1)/BIN;
+
+    auto const rows = [&origin, spacing](stlTriangle const& t, unsigned int const c, unsigned int const n,
+                                         unsigned int& first, unsigned int& last) -> bool
+    {
+        double const lower = std::ceil((std::min({t.vertex[0][c], t.vertex[1][c], t.vertex[2][c]}) - origin[c])/spacing);
+        double const upper = std::floor((std::max({t.vertex[0][c], t.vertex[1][c], t.vertex[2][c]}) - origin[c])/spacing);
+        if ((upper < 0.0) || (lower > n - 1.0) || (lower > upper))
+        {
+            return false;
+        }
+        first = static_cast<unsigned int>(std::max(lower, 0.0));
+        last  = static_cast<unsigned int>(std::min(upper, n - 1.0));
+        return true;
+    };
+
+    std::vector<size_t>       offsets(static_cast<size_t>(BINS_Y)*BINS_Z + 1, 0);
+    std::vector<unsigned int> triangles;
+    for(unsigned int pass = 0; pass <= 1; ++pass)
+    {
+        std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for(size_t i = 0; i < mesh.size(); ++i)
+        {
+            unsigned int y0 = 0, y1 = 0, z0 = 0, z1 = 0;
+            if ((rows(mesh[i], 1, NY, y0, y1) == false) || (rows(mesh[i], 2, NZ, z0, z1) == false))
+            {
+                continue;
+            }
+
+            for(unsigned int bz = z0/BIN; bz <= z1/BIN; ++bz)
+            {
+                for(unsigned int by = y0/BIN; by <= y1/BIN; ++by)
+                {
+                    size_t const bin = static_cast<size_t>(bz)*BINS_Y + by;
+                    if (pass == 0)
+                    {
+                        ++offsets[bin + 1];
+                    }
+                    else
+                    {
+                        triangles[cursor[bin]++] = static_cast<unsigned int>(i);
+                    }
+                }
+            }
+        }
+
+        if (pass == 0)
+        {
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+            triangles.resize(offsets.back());
+        }
+    }
+
+    /// cast a ray through every row of cells
+    std::vector<uint8_t, DefaultInitAllocator<uint8_t>>& solid = solid_;
+    size_t open = 0;
+
+    #pragma omp parallel default(none) shared(solid, mesh, origin, offsets, triangles) firstprivate(spacing) reduction(+:open)
+    {
+        std::vector<double> hits;
+
+        #pragma omp for schedule(dynamic,1)
+        for(unsigned int z = 0; z < NZ; ++z)
+        {
+            for(unsigned int y = 0; y < NY; ++y)
+            {
+                double const y_c = origin[1] + spacing*y;
+                double const z_c = origin[2] + spacing*z;
+                size_t const bin = static_cast<size_t>(z/BIN)*BINS_Y + y/BIN;
+
+                hits.clear();
+                for(size_t i = offsets[bin]; i < offsets[bin + 1]; ++i)
+                {
+                    double x_c = 0.0;
+                    if (RayIntersection(mesh[triangles[i]], y_c, z_c, x_c) == true)
+                    {
+                        hits.push_back(x_c);
+                    }
+                }
+
+                if (hits.size() % 2 != 0)
+                {
+                    ++open;
+                }
+                std::sort(hits.begin(), hits.end());
+
+                for(size_t i = 0; i + 1 < hits.size(); i += 2)
+                {
+                    double const lower = std::max(std::ceil((hits[i] - origin[0])/spacing), 0.0);
+                    double const upper = std::min(std::floor((hits[i + 1] - origin[0])/spacing), NX - 1.0);
+                    for(double x = lower; x <= upper; x += 1.0)
+                    {
+                        solid[(static_cast<size_t>(z)*NY + y)*NX + static_cast<size_t>(x)] = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    if (open > 0)
+    {
+        std::cerr << "Warning: Surface mesh is not closed (" << open << " rows of cells with an odd number of intersections)." << std::endl;
+    }
+}
+
+/**\fn        ImportRaw
+ * \brief     Import the solid cells from a raw voxel file holding one byte per cell (x fastest, then y
+ *            and z, non-zero = solid) as they are common for tomographies of porous media. Overwrites all
+ *            cells. Stops the program if the size of the file does not match the simulation domain.
+ *
+ * \param[in] fileName   name of the raw voxel file
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+void Voxels<NX,NY,NZ>::ImportRaw(std::string const& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+    if (file.is_open() == false)
+    {
+        std::cerr << "Fatal error: Geometry file '" << fileName << "' could not be opened." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (static_cast<size_t>(file.tellg()) != CELLS_)
+    {
+        std::cerr << "Fatal error: Raw voxel file '" << fileName << "' does not match the resolution "
+                  << NX << "x" << NY << "x" << NZ << "." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    file.seekg(0);
+    if (file.read(reinterpret_cast<char*>(solid_.data()), static_cast<std::streamsize>(CELLS_)).good() == false)
+    {
+        std::cerr << "Fatal error: Geometry file '" << fileName << "' could not be read." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<uint8_t, DefaultInitAllocator<uint8_t>>& solid = solid_;
+
+    #pragma omp parallel for default(none) shared(solid) schedule(static)
+    for(size_t i = 0; i < CELLS_; ++i)
+    {
+        solid[i] = (solid[i] != 0) ? 1 : 0;
+    }
+}
+
+/**\fn        ImportCache
+ * \brief     Import a voxelised geometry from the cache
+ *
+ * \param[in] fileName   name of the cache file
+ * \param[in] key        checksum of the source of the geometry and of its transformation
+ * \return    Boolean true if the cache exists and matches the key and the resolution, false otherwise
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+bool Voxels<NX,NY,NZ>::ImportCache(std::string const& fileName, uint64_t const key)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    voxelCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    if ((file.is_open() == false) || (file.read(reinterpret_cast<char*>(&header), sizeof(header)).good() == false))
+    {
+        return false;
+    }
+    if ((memcmp(header.magic, VOXEL_CACHE_MAGIC, sizeof(header.magic)) != 0) || (header.version != VOXEL_CACHE_VERSION) ||
+        (header.nx != NX) || (header.ny != NY) || (header.nz != NZ) || (header.key != key))
+    {
+        return false;
+    }
+
+    std::vector<uint64_t> words((CELLS_ + 63)/64, 0);
+    if (file.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(words.size()*sizeof(uint64_t))).good() == false)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t, DefaultInitAllocator<uint8_t>>& solid = solid_;
+
+    #pragma omp parallel for default(none) shared(solid, words) schedule(static)
+    for(size_t i = 0; i < CELLS_; ++i)
+    {
+        solid[i] = static_cast<uint8_t>((words[i/64] >> (i % 64)) & 1);
+    }
+
+    return true;
+}
+
+/**\fn        ExportCache
+ * \brief     Export the voxelised geometry to the cache (bit-packed). Only a warning is issued if the
+ *            cache can not be written.
+ *
+ * \param[in] fileName   name of the cache file
+ * \param[in] key        checksum of the source of the geometry and of its transformation
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+void Voxels<NX,NY,NZ>::ExportCache(std::string const& fileName, uint64_t const key) const
+{
+    voxelCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, VOXEL_CACHE_MAGIC, sizeof(header.magic));
+    header.version = VOXEL_CACHE_VERSION;
+    header.nx      = NX;
+    header.ny      = NY;
+    header.nz      = NZ;
+    header.key     = key;
+
+    std::vector<uint8_t, DefaultInitAllocator<uint8_t>> const& solid = solid_;
+    std::vector<uint64_t> words((CELLS_ + 63)/64, 0);
+
+    #pragma omp parallel for default(none) shared(solid, words) schedule(static)
+    for(size_t w = 0; w < words.size(); ++w)
+    {
+        uint64_t word = 0;
+        for(size_t i = 64*w; i < std::min(64*(w + 1), CELLS_); ++i)
+        {
+            word |= static_cast<uint64_t>(solid[i]) << (i % 64);
+        }
+        words[w] = word;
+    }
+
+    std::ofstream file(fileName, std::ios::binary);
+    if ((file.is_open() == false) ||
+        (file.write(reinterpret_cast<char const*>(&header), sizeof(header)).good() == false) ||
+        (file.write(reinterpret_cast<char const*>(words.data()), static_cast<std::streamsize>(words.size()*sizeof(uint64_t))).good() == false))
+    {
+        std::cerr << "Warning: Voxelised geometry could not be cached to '" << fileName << "'." << std::endl;
+    }
+}
+
+/**\fn        Classify
+ * \brief     Boundary list a cell belongs to: solid cells are walls, then the faces normal to the flow
+ *            direction are walls (if requested) or neither, then the first and last plane in flow
+ *            direction are inlet and outlet
+ *
+ * \param[in] x       x coordinate of the cell
+ * \param[in] y       y coordinate of the cell
+ * \param[in] z       z coordinate of the cell
+ * \param[in] axis    axis of the flow direction
+ * \param[in] walls   faces parallel to the flow direction are walls (true) or not (false)
+ * \return    category of the cell (WALL_, INLET_, OUTLET_ or NONE_)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline unsigned int Voxels<NX,NY,NZ>::Classify(unsigned int const x, unsigned int const y, unsigned int const z,
+                                               unsigned int const axis, bool const walls) const
+{
+    if (IsSolid(x, y, z) == true)
+    {
+        return WALL_;
+    }
+
+    unsigned int const c[3] = {x, y, z};
+    unsigned int const n[3] = {NX, NY, NZ};
+    for(unsigned int a = 0; a < 3; ++a)
+    {
+        if ((a != axis) && ((c[a] == 0) || (c[a] == n[a] - 1)))
+        {
+            return (walls == true) ? WALL_ : NONE_;
+        }
+    }
+
+    if (c[axis] == 0)
+    {
+        return INLET_;
+    }
+    else if (c[axis] == n[axis] - 1)
+    {
+        return OUTLET_;
+    }
+
+    return NONE_;
+}
+
+/**\fn         Boundaries
+ * \brief      Append the boundary elements of the geometry to the boundary lists: solid cells and
+ *             optionally the faces parallel to the flow direction are walls, the first and the last plane
+ *             in flow direction are inlet and outlet. The elements are sorted by z, y and x.
+ *
+ * \tparam     T             floating data type used for simulation
+ * \param[in]  orientation   std::string that holds the flow direction ("x", "y" or "z")
+ * \param[in]  walls         faces parallel to the flow direction are walls (true) or not (false)
+ * \param[out] wall          vector of boundary elements that correspond to a wall
+ * \param[out] inlet         vector of boundary elements that correspond to the inlet
+ * \param[out] outlet        vector of boundary elements that correspond to the outlet
+ * \param[in]  RHO           density of the boundary elements
+ * \param[in]  U             velocity in x-direction of the boundary elements
+ * \param[in]  V             velocity in y-direction of the boundary elements
+ * \param[in]  W             velocity in z-direction of the boundary elements
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ> template <typename T>
+void Voxels<NX,NY,NZ>::Boundaries(std::string const& orientation, bool const walls, std::vector<boundaryElement<T>>& wall,
+                                  std::vector<boundaryElement<T>>& inlet, std::vector<boundaryElement<T>>& outlet,
+                                  T const RHO, T const U, T const V, T const W) const
+{
+    unsigned int const axis = FlowAxis(orientation);
+
+    /// elements of every plane, counted before they are filled
+    std::vector<std::array<std::vector<boundaryElement<T>>,3>> planes(NZ);
+
+    #pragma omp parallel for default(none) shared(planes) firstprivate(axis, walls, RHO, U, V, W) schedule(dynamic,1)
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        std::array<size_t,3> count = {0, 0, 0};
+
+        for(unsigned int pass = 0; pass <= 1; ++pass)
+        {
+            for(unsigned int k = 0; (pass == 1) && (k < 3); ++k)
+            {
+                planes[z][k].reserve(count[k]);
+            }
+
+            for(unsigned int y = 0; y < NY; ++y)
+            {
+                for(unsigned int x = 0; x < NX; ++x)
+                {
+                    unsigned int const category = Classify(x, y, z, axis, walls);
+                    if (category == NONE_)
+                    {
+                        continue;
+                    }
+
+                    if (pass == 0)
+                    {
+                        ++count[category];
+                    }
+                    else
+                    {
+                        planes[z][category].push_back({x, y, z, RHO, U, V, W});
+                    }
+                }
+            }
+        }
+    }
+
+    /// concatenate the planes in order
+    std::vector<boundaryElement<T>>* const lists[3] = {&wall, &inlet, &outlet};
+    for(unsigned int k = 0; k < 3; ++k)
+    {
+        size_t size = lists[k]->size();
+        for(unsigned int z = 0; z < NZ; ++z)
+        {
+            size += planes[z][k].size();
+        }
+
+        lists[k]->reserve(size);
+        for(unsigned int z = 0; z < NZ; ++z)
+        {
+            for(auto const& element: planes[z][k])
+            {
+                lists[k]->push_back(element);
+            }
+        }
+    }
+}
+
+
+/**\fn         ImportGeometry
+ * \brief      Load a geometry from a file and build its boundary lists. Surface meshes (*.stl) are scaled
+ *             uniformly and centred so that they fit into the inner cells of the domain (one cell away
+ *             from all faces) and their voxelisation is cached in GEOMETRY_CACHE_PATH. Raw voxel files
+ *             (*.raw) have to match the resolution of the domain. Stops the program for other formats.
+ *
+ * \tparam     NX            simulation domain resolution in x-direction
+ * \tparam     NY            simulation domain resolution in y-direction
+ * \tparam     NZ            simulation domain resolution in z-direction
+ * \tparam     T             floating data type used for simulation
+ * \param[in]  fileName      name of the geometry file
+ * \param[in]  orientation   std::string that holds the flow direction ("x", "y" or "z")
+ * \param[in]  walls         faces parallel to the flow direction are walls (true) or not (false)
+ * \param[out] wall          vector of boundary elements that correspond to a wall
+ * \param[out] inlet         vector of boundary elements that correspond to the inlet
+ * \param[out] outlet        vector of boundary elements that correspond to the outlet
+ * \param[in]  RHO           density of the boundary elements
+ * \param[in]  U             velocity in x-direction of the boundary elements
+ * \param[in]  V             velocity in y-direction of the boundary elements
+ * \param[in]  W             velocity in z-direction of the boundary elements
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void ImportGeometry(std::string const& fileName, std::string const& orientation, bool const walls,
+                    std::vector<boundaryElement<T>>& wall,
+                    std::vector<boundaryElement<T>>& inlet, std::vector<boundaryElement<T>>& outlet,
+                    T const RHO, T const U, T const V, T const W)
+{
+    static_assert((NX > 3) && (NY > 3) && (NZ > 3), "Geometry import requires inner cells in every direction.");
+
+    Timer Stopwatch;
+    Stopwatch.Start();
+
+    Voxels<NX,NY,NZ> voxels;
+    std::string const extension = fileName.substr(fileName.find_last_of('.') + 1);
+
+    if ((extension == "stl") || (extension == "STL"))
+    {
+        std::string const data = ReadGeometryFile(fileName);
+        std::vector<stlTriangle> const mesh = ParseStl(data, fileName);
+        if (mesh.empty() == true)
+        {
+            std::cerr << "Fatal error: Geometry file '" << fileName << "' does not contain any triangles." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        /// bounding box of the mesh mapped to the inner cells [1, N-2]
+        double lower[3] = { std::numeric_limits<double>::max(),  std::numeric_limits<double>::max(),  std::numeric_limits<double>::max()};
+        double upper[3] = {-std::numeric_limits<double>::max(), -std::numeric_limits<double>::max(), -std::numeric_limits<double>::max()};
+        for(size_t i = 0; i < mesh.size(); ++i)
+        {
+            for(unsigned int k = 0; k < 3; ++k)
+            {
+                for(unsigned int c = 0; c < 3; ++c)
+                {
+                    lower[c] = std::min(lower[c], static_cast<double>(mesh[i].vertex[k][c]));
+                    upper[c] = std::max(upper[c], static_cast<double>(mesh[i].vertex[k][c]));
+                }
+            }
+        }
+
+        unsigned int const n[3] = {NX, NY, NZ};
+        double spacing = 0.0;
+        for(unsigned int c = 0; c < 3; ++c)
+        {
+            spacing = std::max(spacing, (upper[c] - lower[c])/(n[c] - 3));
+        }
+        if (!(spacing > 0.0))
+        {
+            std::cerr << "Fatal error: Surface mesh of geometry file '" << fileName << "' is degenerate." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        std::array<double,3> origin = {0.0, 0.0, 0.0};
+        for(unsigned int c = 0; c < 3; ++c)
+        {
+            origin[c] = 0.5*(lower[c] + upper[c]) - 0.5*spacing*(n[c] - 1);
+        }
+
+        /// cache identified by the content of the file and the transformation
+        uint64_t key = GeometryChecksum(data.data(), data.size());
+        key = GeometryChecksum(origin.data(), sizeof(origin), key);
+        key = GeometryChecksum(&spacing, sizeof(spacing), key);
+
+        std::string const baseName = fileName.substr(fileName.find_last_of('/') + 1);
+        std::string const cacheName = GEOMETRY_CACHE_PATH + "/" + baseName + "_" + std::to_string(NX) + "x" +
+                                      std::to_string(NY) + "x" + std::to_string(NZ) + ".vox";
+
+        if (voxels.ImportCache(cacheName, key) == true)
+        {
+            std::cout << "Geometry: " << fileName << " (" << mesh.size() << " triangles) imported from cache " << cacheName << std::endl;
+        }
+        else
+        {
+            voxels.Voxelise(mesh, origin, spacing);
+            voxels.ExportCache(cacheName, key);
+            std::cout << "Geometry: " << fileName << " (" << mesh.size() << " triangles) voxelised with spacing " << spacing << std::endl;
+        }
+    }
+    else if ((extension == "raw") || (extension == "RAW"))
+    {
+        voxels.ImportRaw(fileName);
+        std::cout << "Geometry: " << fileName << " imported" << std::endl;
+    }
+    else
+    {
+        std::cerr << "Fatal error: Unknown format of geometry file '" << fileName << "' (*.stl or *.raw)." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    voxels.Boundaries(orientation, walls, wall, inlet, outlet, RHO, U, V, W);
+
+    std::cout << "          " << voxels.GetNumberOfSolidCells() << " solid cells, set-up in " << Stopwatch.Stop() << " s" << std::endl;
+}
+
+#endif // VOXELISER_HPP_INCLUDED
@@ -0,0 +1,532 @@
+#ifndef EQUILIBRIUM_HPP_INCLUDED
+#define EQUILIBRIUM_HPP_INCLUDED
+
+/**
+ * \file     equilibrium.hpp
+ * \mainpage Moments and equilibrium distributions of arbitrary lattices reduced at compile time
+ *
+ * \note     All collision operators and boundaries evaluate the same moments and the same second-order
+ *           equilibrium. Instead of looping over the lattice velocities at run time the directions are
+ *           expanded with a std::integer_sequence so that every lattice velocity is a compile-time
+ *           constant: products with zero velocity components are dropped, unit components become
+ *           additions and subtractions and the weights are merged with the coefficients of the
+ *           expansion. Opposite directions d and OFF + d are treated as pairs as their projections
+ *           only differ in sign, which halves the work for the equilibrium and the moments.
+ * \warning  Requires lattice velocities with integer components (e.g. D3Q19 and D3Q27)
+*/
+
+#include <utility>
+
+#include "../general/gpu.hpp"
+
+
+namespace lattice
+{
+    /**\fn        Scale
+     * \brief     Multiply a value by an integer velocity component known at compile time
+     *
+     * \tparam    C   the integer velocity component
+     * \tparam    T   floating data type used for simulation
+     * \param[in] x   the value to be multiplied
+     * \return    the value multiplied by the velocity component
+    */
+    template <int C, typename T>
+    HOST_DEVICE inline constexpr T __attribute__((always_inline)) Scale(T const x)
+    {
+        if constexpr (C == 1)
+        {
+            return x;
+        }
+        else if constexpr (C == -1)
+        {
+            return -x;
+        }
+        else
+        {
+            return static_cast<T>(C)*x;
+        }
+    }
+
+    /**\fn        Project
+     * \brief     Projection of a vector onto a lattice velocity only containing its non-zero components
+     *
+     * \tparam    LT     static lattice::DdQq class containing discretisation parameters
+     * \tparam    curr   the lattice velocity of interest
+     * \tparam    T      floating data type used for simulation
+     * \param[in] u      x-component of the vector
+     * \param[in] v      y-component of the vector
+     * \param[in] w      z-component of the vector
+     * \return    the scalar product of the lattice velocity and the vector
+    */
+    template <class LT, unsigned int curr, typename T>
+    HOST_DEVICE inline constexpr T __attribute__((always_inline)) Project(T const u, T const v, T const w)
+    {
+        constexpr int CX = static_cast<int>(LT::DX[curr]);
+        constexpr int CY = static_cast<int>(LT::DY[curr]);
+        constexpr int CZ = static_cast<int>(LT::DZ[curr]);
+        static_assert((CX != 0) || (CY != 0) || (CZ != 0), "Projection onto the rest velocity is always zero.");
+
+        if constexpr (CX == 0)
+        {
+            if constexpr (CY == 0)
+            {
+                return Scale<CZ>(w);
+            }
+            else if constexpr (CZ == 0)
+            {
+                return Scale<CY>(v);
+            }
+            else
+            {
+                return Scale<CY>(v) + Scale<CZ>(w);
+            }
+        }
+        else if constexpr (CY == 0)
+        {
+            if constexpr (CZ == 0)
+            {
+                return Scale<CX>(u);
+            }
+            else
+            {
+                return Scale<CX>(u) + Scale<CZ>(w);
+            }
+        }
+        else if constexpr (CZ == 0)
+        {
+            return Scale<CX>(u) + Scale<CY>(v);
+        }
+        else
+        {
+            return Scale<CX>(u) + Scale<CY>(v) + Scale<CZ>(w);
+        }
+    }
+
+
+    /**\fn            MomentsPair
+     * \brief         Add the contribution of a pair of opposite lattice velocities to density and momentum
+     *
+     * \tparam        LT    static lattice::DdQq class containing discretisation parameters
+     * \tparam        d     index of the positive lattice velocity of the pair
+     * \tparam        F     array-like type of the distributions indexed by the lattice velocity (e.g. T[ND])
+     * \tparam        T     floating data type used for simulation
+     * \param[in]     f     distributions of the cell in the order of the lattice
+     * \param[in,out] rho   density
+     * \param[in,out] jx    momentum in x-direction
+     * \param[in,out] jy    momentum in y-direction
+     * \param[in,out] jz    momentum in z-direction
+    */
+    template <class LT, unsigned int d, class F, typename T>
+    HOST_DEVICE inline void __attribute__((always_inline)) MomentsPair(F const& f, T& rho, T& jx, T& jy, T& jz)
+    {
+        constexpr int CX = static_cast<int>(LT::DX[d]);
+        constexpr int CY = static_cast<int>(LT::DY[d]);
+        constexpr int CZ = static_cast<int>(LT::DZ[d]);
+
+        rho += f[d] + f[LT::OFF + d];
+
+        T const diff = f[d] - f[LT::OFF + d];
+        if constexpr (CX != 0)
+        {
+            jx += Scale<CX>(diff);
+        }
+        if constexpr (CY != 0)
+        {
+            jy += Scale<CY>(diff);
+        }
+        if constexpr (CZ != 0)
+        {
+            jz += Scale<CZ>(diff);
+        }
+    }
+
+    /// expansion of the pairs of opposite lattice velocities 1 ... HSPEED-1 for the density and momentum
+    template <class LT, class F, typename T, unsigned int... D>
+    HOST_DEVICE inline void __attribute__((always_inline)) MomentsPairs(F const& f, T& rho, T& jx, T& jy, T& jz, std::integer_sequence<unsigned int, D...>)
+    {
+        (MomentsPair<LT, D + 1>(f, rho, jx, jy, jz), ...);
+    }
+
+    /**\fn         Moments
+     * \brief      Density and momentum (zeroth and first order moments) of the distributions of a cell
+     * \warning    Returns the momentum, the velocity is obtained by dividing by the density
+     *
+     * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+     * \tparam     F     array-like type of the distributions indexed by the lattice velocity (e.g. T[ND])
+     * \tparam     T     floating data type used for simulation
+     * \param[in]  f     distributions of the cell in the order of the lattice
+     * \param[out] rho   density
+     * \param[out] jx    momentum in x-direction
+     * \param[out] jy    momentum in y-direction
+     * \param[out] jz    momentum in z-direction
+    */
+    template <class LT, class F, typename T>
+    HOST_DEVICE inline void __attribute__((always_inline)) Moments(F const& f, T& rho, T& jx, T& jy, T& jz)
+    {
+        rho = f[0];
+        jx  = 0.0;
+        jy  = 0.0;
+        jz  = 0.0;
+        MomentsPairs<LT>(f, rho, jx, jy, jz, std::make_integer_sequence<unsigned int, LT::HSPEED - 1>());
+    }
+
+    /**\fn         Velocity
+     * \brief      Density and velocity of the distributions of a cell
+     *
+     * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+     * \tparam     F     array-like type of the distributions indexed by the lattice velocity (e.g. T[ND])
+     * \tparam     T     floating data type used for simulation
+     * \param[in]  f     distributions of the cell in the order of the lattice
+     * \param[out] rho   density
+     * \param[out] u     velocity in x-direction
+     * \param[out] v     velocity in y-direction
+     * \param[out] w     velocity in z-direction
+    */
+    template <class LT, class F, typename T>
+    HOST_DEVICE inline void __attribute__((always_inline)) Velocity(F const& f, T& rho, T& u, T& v, T& w)
+    {
+        Moments<LT>(f, rho, u, v, w);
+        u /= rho;
+        v /= rho;
+        w /= rho;
+    }
+
+
+    /**\fn         EquilibriumPair
+     * \brief      Equilibrium distributions of a pair of opposite lattice velocities: the even part is
+     *             shared by both directions while the odd part changes its sign
+     *
+     * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+     * \tparam     d     index of the positive lattice velocity of the pair
+     * \tparam     F     array-like type of the distributions indexed by the lattice velocity (e.g. T[ND])
+     * \tparam     T     floating data type used for simulation
+     * \param[in]  rho   density
+     * \param[in]  r0    density corrected by the kinetic energy rho*(1 - |u|^2/(2 cs^2))
+     * \param[in]  u     velocity in x-direction
+     * \param[in]  v     velocity in y-direction
+     * \param[in]  w     velocity in z-direction
+     * \param[out] feq   equilibrium distributions in the order of the lattice
+    */
+    template <class LT, unsigned int d, class F, typename T>
+    HOST_DEVICE inline void __attribute__((always_inline)) EquilibriumPair(T const rho, T const r0, T const u, T const v, T const w, F& feq)
+    {
+        constexpr T W_0 = LT::W[d];
+        constexpr T W_1 = LT::W[d]/(LT::CS*LT::CS);
+        constexpr T W_2 = LT::W[d]/(2.0*LT::CS*LT::CS*LT::CS*LT::CS);
+
+        T const cu   = Project<LT,d>(u, v, w);
+        T const rcu  = rho*cu;
+        T const even = W_0*r0 + W_2*rcu*cu;
+        T const odd  = W_1*rcu;
+
+        feq[d]           = even + odd;
+        feq[LT::OFF + d] = even - odd;
+    }
+
+    /// expansion of the pairs of opposite lattice velocities 1 ... HSPEED-1 for the equilibrium distributions
+    template <class LT, class F, typename T, unsigned int... D>
+    HOST_DEVICE inline void __attribute__((always_inline)) EquilibriumPairs(T const rho, T const r0, T const u, T const v, T const w, F& feq,
+                                             std::integer_sequence<unsigned int, D...>)
+    {
+        (EquilibriumPair<LT, D + 1>(rho, r0, u, v, w, feq), ...);
+    }
+
+    /**\fn         Equilibrium
+     * \brief      Second-order equilibrium distributions of a cell
+     *             feq = W rho (1 + c.u/cs^2 + (c.u)^2/(2 cs^4) - |u|^2/(2 cs^2))
+     *
+     * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+     * \tparam     F     array-like type of the distributions indexed by the lattice velocity (e.g. T[ND])
+     * \tparam     T     floating data type used for simulation
+     * \param[in]  rho   density (or any other conserved scalar advected with the velocity)
+     * \param[in]  u     velocity in x-direction
+     * \param[in]  v     velocity in y-direction
+     * \param[in]  w     velocity in z-direction
+     * \param[out] feq   equilibrium distributions in the order of the lattice
+    */
+    template <class LT, class F, typename T>
+    HOST_DEVICE inline void __attribute__((always_inline)) Equilibrium(T const rho, T const u, T const v, T const w, F& feq)
+    {
+        constexpr T UU = 1.0/(2.0*LT::CS*LT::CS);
+
+        T const r0 = rho - UU*rho*(u*u + v*v + w*w);
+
+        feq[0] = LT::W[0]*r0;
+        EquilibriumPairs<LT>(rho, r0, u, v, w, feq, std::make_integer_sequence<unsigned int, LT::HSPEED - 1>());
+    }
+
+
+    /**\fn            StressPair
+     * \brief         Add the contribution of a pair of opposite lattice velocities to the second order moments
+     *
+     * \tparam        LT    static lattice::DdQq class containing discretisation parameters
+     * \tparam        d     index of the positive lattice velocity of the pair
+     * \tparam        F     array-like type of the distributions indexed by the lattice velocity (e.g. T[ND])
+     * \tparam        T     floating data type used for simulation
+     * \param[in]     f     (non-equilibrium) distributions of the cell in the order of the lattice
+     * \param[in,out] p     second order moments xx, yy, zz, xy, xz, yz
+    */
+    template <class LT, unsigned int d, class F, typename T>
+    HOST_DEVICE inline void __attribute__((always_inline)) StressPair(F const& f, T (&p)[6])
+    {
+        constexpr int CX = static_cast<int>(LT::DX[d]);
+        constexpr int CY = static_cast<int>(LT::DY[d]);
+        constexpr int CZ = static_cast<int>(LT::DZ[d]);
+
+        T const sum = f[d] + f[LT::OFF + d];
+        if constexpr (CX != 0)
+        {
+            p[0] += Scale<CX*CX>(sum);
+        }
+        if constexpr (CY != 0)
+        {
+            p[1] += Scale<CY*CY>(sum);
+        }
+        if constexpr (CZ != 0)
+        {
+            p[2] += Scale<CZ*CZ>(sum);
+        }
+        if constexpr (CX*CY != 0)
+        {
+            p[3] += Scale<CX*CY>(sum);
+        }
+        if constexpr (CX*CZ != 0)
+        {
+            p[4] += Scale<CX*CZ>(sum);
+        }
+        if constexpr (CY*CZ != 0)
+        {
+            p[5] += Scale<CY*CZ>(sum);
+        }
+    }
+
+    /// expansion of the pairs of opposite lattice velocities 1 ... HSPEED-1 for the second order moments
+    template <class LT, class F, typename T, unsigned int... D>
+    HOST_DEVICE inline void __attribute__((always_inline)) StressPairs(F const& f, T (&p)[6], std::integer_sequence<unsigned int, D...>)
+    {
+        (StressPair<LT, D + 1>(f, p), ...);
+    }
+
+    /**\fn         Stress
+     * \brief      Second order moments sum_i c_a c_b f_i of the distributions of a cell, e.g. of the
+     *             non-equilibrium part for the momentum flux of turbulence models
+     *
+     * \tparam     LT   static lattice::DdQq class containing discretisation parameters
+     * \tparam     F    array-like type of the distributions indexed by the lattice velocity (e.g. T[ND])
+     * \tparam     T    floating data type used for simulation
+     * \param[in]  f    (non-equilibrium) distributions of the cell in the order of the lattice
+     * \param[out] p    second order moments xx, yy, zz, xy, xz, yz
+    */
+    template <class LT, class F, typename T>
+    HOST_DEVICE inline void __attribute__((always_inline)) Stress(F const& f, T (&p)[6])
+    {
+        for(unsigned int i = 0; i < 6; ++i)
+        {
+            p[i] = 0.0;
+        }
+        StressPairs<LT>(f, p, std::make_integer_sequence<unsigned int, LT::HSPEED - 1>());
+    }
+
+    /**\fn         NonEquilibriumStress
+     * \brief      Non-equilibrium part of the second order moments of the distributions of a cell
+     *             P_neq = sum_i c c f_i - rho (cs^2 I + u u) without evaluating the equilibrium distributions
+     *
+     * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+     * \tparam     F     array-like type of the distributions indexed by the lattice velocity (e.g. T[ND])
+     * \tparam     T     floating data type used for simulation
+     * \param[in]  f     distributions of the cell in the order of the lattice
+     * \param[in]  rho   density
+     * \param[in]  u     velocity in x-direction
+     * \param[in]  v     velocity in y-direction
+     * \param[in]  w     velocity in z-direction
+     * \param[out] p     non-equilibrium part of the second order moments xx, yy, zz, xy, xz, yz
+    */
+    template <class LT, class F, typename T>
+    HOST_DEVICE inline void __attribute__((always_inline)) NonEquilibriumStress(F const& f, T const rho, T const u, T const v, T const w, T (&p)[6])
+    {
+        constexpr T CS2 = LT::CS*LT::CS;
+
+        Stress<LT>(f, p);
+        p[0] -= rho*(CS2 + u*u);
+        p[1] -= rho*(CS2 + v*v);
+        p[2] -= rho*(CS2 + w*w);
+        p[3] -= rho*u*v;
+        p[4] -= rho*u*w;
+        p[5] -= rho*v*w;
+    }
+
+    /**\fn         Regularised
+     * \brief      Population of a single lattice velocity reconstructed from density, velocity and the
+     *             non-equilibrium part of the second order moments (second-order Hermite expansion)
+     *             f = feq + W/(2 cs^4) (c c - cs^2 I) : P_neq
+     * \note       "Lattice Boltzmann method with regularized pre-collision distribution functions"
+     *             J. Latt, B. Chopard
+     *             Mathematics and Computers in Simulation 72 (2006)
+     *             DOI: 10.1016/j.matcom.2006.05.017
+     *
+     * \tparam     LT     static lattice::DdQq class containing discretisation parameters
+     * \tparam     curr   the lattice velocity of interest
+     * \tparam     T      floating data type used for simulation
+     * \param[in]  rho    density
+     * \param[in]  u      velocity in x-direction
+     * \param[in]  v      velocity in y-direction
+     * \param[in]  w      velocity in z-direction
+     * \param[in]  p      non-equilibrium part of the second order moments xx, yy, zz, xy, xz, yz
+     * \return     the reconstructed population
+    */
+    template <class LT, unsigned int curr, typename T>
+    HOST_DEVICE inline T __attribute__((always_inline)) Regularised(T const rho, T const u, T const v, T const w, T const (&p)[6])
+    {
+        constexpr int CX = static_cast<int>(LT::DX[curr]);
+        constexpr int CY = static_cast<int>(LT::DY[curr]);
+        constexpr int CZ = static_cast<int>(LT::DZ[curr]);
+
+        constexpr T CS2 = LT::CS*LT::CS;
+        constexpr T UU  = 1.0/(2.0*CS2);
+        constexpr T W_0 = LT::W[curr];
+        constexpr T W_1 = LT::W[curr]/CS2;
+        constexpr T W_2 = LT::W[curr]/(2.0*CS2*CS2);
+
+        T const r0 = rho - UU*rho*(u*u + v*v + w*w);
+        T qp = -CS2*(p[0] + p[1] + p[2]);
+
+        if constexpr ((CX == 0) && (CY == 0) && (CZ == 0))
+        {
+            return W_0*r0 + W_2*qp;
+        }
+        else
+        {
+            if constexpr (CX != 0)
+            {
+                qp += Scale<CX*CX>(p[0]);
+            }
+            if constexpr (CY != 0)
+            {
+                qp += Scale<CY*CY>(p[1]);
+            }
+            if constexpr (CZ != 0)
+            {
+                qp += Scale<CZ*CZ>(p[2]);
+            }
+            if constexpr (CX*CY != 0)
+            {
+                qp += Scale<2*CX*CY>(p[3]);
+            }
+            if constexpr (CX*CZ != 0)
+            {
+                qp += Scale<2*CX*CZ>(p[4]);
+            }
+            if constexpr (CY*CZ != 0)
+            {
+                qp += Scale<2*CY*CZ>(p[5]);
+            }
+
+            T const cu = Project<LT,curr>(u, v, w);
+            return W_0*r0 + W_1*rho*cu + W_2*(rho*cu*cu + qp);
+        }
+    }
+
+    /**\fn         RegularisedPair
+     * \brief      Populations of a pair of opposite lattice velocities reconstructed from density, velocity
+     *             and the non-equilibrium part of the second order moments (see Regularised): the
+     *             non-equilibrium part is even and is shared by both directions like the even part of the
+     *             equilibrium
+     *
+     * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+     * \tparam     d     index of the positive lattice velocity of the pair
+     * \tparam     F     array-like type of the distributions indexed by the lattice velocity (e.g. T[ND])
+     * \tparam     T     floating data type used for simulation
+     * \param[in]  rho   density
+     * \param[in]  r0    density corrected by the kinetic energy rho*(1 - |u|^2/(2 cs^2))
+     * \param[in]  qp    trace of the non-equilibrium second order moments multiplied by -cs^2
+     * \param[in]  u     velocity in x-direction
+     * \param[in]  v     velocity in y-direction
+     * \param[in]  w     velocity in z-direction
+     * \param[in]  p     non-equilibrium part of the second order moments xx, yy, zz, xy, xz, yz
+     * \param[out] f     reconstructed distributions in the order of the lattice
+    */
+    template <class LT, unsigned int d, class F, typename T>
+    HOST_DEVICE inline void __attribute__((always_inline)) RegularisedPair(T const rho, T const r0, T const qp, T const u, T const v, T const w,
+                                                                           T const (&p)[6], F& f)
+    {
+        constexpr int CX = static_cast<int>(LT::DX[d]);
+        constexpr int CY = static_cast<int>(LT::DY[d]);
+        constexpr int CZ = static_cast<int>(LT::DZ[d]);
+
+        constexpr T W_0 = LT::W[d];
+        constexpr T W_1 = LT::W[d]/(LT::CS*LT::CS);
+        constexpr T W_2 = LT::W[d]/(2.0*LT::CS*LT::CS*LT::CS*LT::CS);
+
+        T q = qp;
+        if constexpr (CX != 0)
+        {
+            q += Scale<CX*CX>(p[0]);
+        }
+        if constexpr (CY != 0)
+        {
+            q += Scale<CY*CY>(p[1]);
+        }
+        if constexpr (CZ != 0)
+        {
+            q += Scale<CZ*CZ>(p[2]);
+        }
+        if constexpr (CX*CY != 0)
+        {
+            q += Scale<2*CX*CY>(p[3]);
+        }
+        if constexpr (CX*CZ != 0)
+        {
+            q += Scale<2*CX*CZ>(p[4]);
+        }
+        if constexpr (CY*CZ != 0)
+        {
+            q += Scale<2*CY*CZ>(p[5]);
+        }
+
+        T const cu   = Project<LT,d>(u, v, w);
+        T const rcu  = rho*cu;
+        T const even = W_0*r0 + W_2*(rcu*cu + q);
+        T const odd  = W_1*rcu;
+
+        f[d]           = even + odd;
+        f[LT::OFF + d] = even - odd;
+    }
+
+    /// expansion of the pairs of opposite lattice velocities 1 ... HSPEED-1 for the regularised distributions
+    template <class LT, class F, typename T, unsigned int... D>
+    HOST_DEVICE inline void __attribute__((always_inline)) RegularisedPairs(T const rho, T const r0, T const qp, T const u, T const v, T const w,
+                                                                            T const (&p)[6], F& f, std::integer_sequence<unsigned int, D...>)
+    {
+        (RegularisedPair<LT, D + 1>(rho, r0, qp, u, v, w, p, f), ...);
+    }
+
+    /**\fn         RegularisedDistributions
+     * \brief      Distributions of a cell reconstructed from density, velocity and the non-equilibrium part of
+     *             the second order moments (see Regularised)
+     *
+     * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+     * \tparam     F     array-like type of the distributions indexed by the lattice velocity (e.g. T[ND])
+     * \tparam     T     floating data type used for simulation
+     * \param[in]  rho   density
+     * \param[in]  u     velocity in x-direction
+     * \param[in]  v     velocity in y-direction
+     * \param[in]  w     velocity in z-direction
+     * \param[in]  p     non-equilibrium part of the second order moments xx, yy, zz, xy, xz, yz
+     * \param[out] f     reconstructed distributions in the order of the lattice
+    */
+    template <class LT, class F, typename T>
+    HOST_DEVICE inline void __attribute__((always_inline)) RegularisedDistributions(T const rho, T const u, T const v, T const w, T const (&p)[6], F& f)
+    {
+        constexpr T CS2 = LT::CS*LT::CS;
+        constexpr T UU  = 1.0/(2.0*CS2);
+        constexpr T W_2 = LT::W[0]/(2.0*CS2*CS2);
+
+        T const r0 = rho - UU*rho*(u*u + v*v + w*w);
+        T const qp = -CS2*(p[0] + p[1] + p[2]);
+
+        f[0] = LT::W[0]*r0 + W_2*qp;
+        RegularisedPairs<LT>(rho, r0, qp, u, v, w, p, f, std::make_integer_sequence<unsigned int, LT::HSPEED - 1>());
+    }
+}
+
+#endif // EQUILIBRIUM_HPP_INCLUDED
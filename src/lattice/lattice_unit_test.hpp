@@ -7,6 +7,9 @@
 */
 
 #include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <numeric>
 
@@ -101,6 +104,49 @@ namespace lattice
                 std::cout << latticeClass::W << std::endl;
             }
 
+            /**\fn    testIsotropy
+             * \brief Test the isotropy of the moments of the weights up to fourth order that the
+             *        equilibrium distribution and the collision kernels rely on (within a tolerance as the
+             *        weights are not exactly representable)
+             *
+             * \return Boolean true if all moments match the ones of the Maxwell-Boltzmann distribution
+             *        (static: it is also called by the verification of the benchmark)
+            */
+            static bool testIsotropy()
+            {
+                constexpr double tolerance = 1.0e-12;
+                double const cs2 = static_cast<double>(latticeClass::CS)*static_cast<double>(latticeClass::CS);
+                std::array<std::array<double, latticeClass::ND>, 3> c = {};
+                for (unsigned int n = 0; n < latticeClass::ND; ++n)
+                {
+                    c[0][n] = latticeClass::DX[n];
+                    c[1][n] = latticeClass::DY[n];
+                    c[2][n] = latticeClass::DZ[n];
+                }
+
+                bool isIsotropic = true;
+                for (unsigned int i = 0; i < 3; ++i)
+                {
+                    for (unsigned int j = 0; j < 3; ++j)
+                    {
+                        double first  = 0.0;
+                        double second = 0.0;
+                        double fourth = 0.0;
+                        for (unsigned int n = 0; n < latticeClass::ND; ++n)
+                        {
+                            first  += latticeClass::W[n]*c[i][n];
+                            second += latticeClass::W[n]*c[i][n]*c[j][n];
+                            fourth += latticeClass::W[n]*c[i][n]*c[i][n]*c[j][n]*c[j][n];
+                        }
+                        /// sum w c_i = 0, sum w c_i c_j = cs^2 delta_ij, sum w c_i^2 c_j^2 = cs^4 (1 + 2 delta_ij)
+                        isIsotropic &= (std::abs(first) < tolerance);
+                        isIsotropic &= (std::abs(second - ((i == j) ? cs2 : 0.0)) < tolerance);
+                        isIsotropic &= (std::abs(fourth - cs2*cs2*((i == j) ? 3.0 : 1.0)) < tolerance);
+                    }
+                }
+                return isIsotropic;
+            }
+
             /**\fn    testClass
              * \brief test class for different properties
             */
@@ -117,6 +163,11 @@ namespace lattice
                 assert(alignof(latticeClass::DX) == CACHE_LINE);
                 assert(alignof(latticeClass::DY) == CACHE_LINE);
                 assert(alignof(latticeClass::DZ) == CACHE_LINE);
+                if (testIsotropy() == false)
+                {
+                    std::cerr << "Test failed: The moments of the weights are not isotropic." << std::endl;
+                    return EXIT_FAILURE;
+                }
                 std::cout << "Test passed" << std::endl;
                 return EXIT_SUCCESS;
             }
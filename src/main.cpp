@@ -1,107 +1,947 @@
+#include <algorithm>
 #include <array>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <stdlib.h>
+#include <string>
 #include <string.h>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "continuum/async_export.hpp"
 #include "continuum/continuum.hpp"
+#include "continuum/continuum_runtime.hpp"
+#include "continuum/convert.hpp"
 #include "continuum/initialisation.hpp"
+#include "continuum/monitor.hpp"
+#include "general/autotuning.hpp"
 #include "general/disclaimer.hpp"
+#include "general/distribution.hpp"
+#include "general/domain_registry.hpp"
+#include "general/instrumentation.hpp"
 #include "general/memory_alignment.hpp"
 #include "general/output.hpp"
 #include "general/parallelism.hpp"
 #include "general/parameters_export.hpp"
+#include "general/paths.hpp"
+#include "general/settings.hpp"
+#include "general/step_scheduler.hpp"
 #include "general/timer.hpp"
 #include "geometry/cylinder.hpp"
+#include "geometry/stl.hpp"
+#include "geometry/voxeliser.hpp"
+#include "lattice/D3Q19.hpp"
 #include "lattice/D3Q27.hpp"
+#include "population/block_pipeline.hpp"
+#include "population/block_scheduler.hpp"
 #include "population/boundary/boundary.hpp"
 #include "population/boundary/boundary_bounceback.hpp"
+#include "population/boundary/boundary_compact.hpp"
 #include "population/boundary/boundary_guo.hpp"
 #include "population/boundary/boundary_orientation.hpp"
+#include "population/boundary/boundary_runtime.hpp"
 #include "population/boundary/boundary_type.hpp"
 #include "population/collision/collision_bgk.hpp"
 #include "population/collision/collision_bgk-s.hpp"
 #include "population/collision/collision_bgk_avx2.hpp"
+#include "population/collision/collision_bgk_ensemble.hpp"
+#include "population/collision/collision_bgk_runtime.hpp"
+#include "population/collision/collision_bgk_scalar.hpp"
+#include "population/collision/collision_moments.hpp"
+#include "population/collision/collision_regularised.hpp"
+#include "population/collision/collision_regularised-s.hpp"
 #include "population/collision/collision_trt.hpp"
+#include "population/fluid_cells.hpp"
+#include "population/halo_exchange.hpp"
 #include "population/initialisation.hpp"
+#include "population/moments.hpp"
 #include "population/population.hpp"
+#include "population/population_runtime.hpp"
+#include "population/probes.hpp"
+#include "population/refinement.hpp"
+#include "population/subdomain.hpp"
+#include "population/wavefront.hpp"
+#ifdef USE_GPU
+    #include "continuum/continuum_gpu.hpp"
+    #include "population/boundary/boundary_gpu.hpp"
+    #include "population/collision/collision_gpu.hpp"
+    #include "population/population_gpu.hpp"
+#endif
 
-int main(int argc, char** argv)
+/**\fn        CollideStreamFlow
+ * \brief     Collision operator of the flow on the host selected at compile time: BGK with Smagorinsky subgrid
+ *            model, regularised BGK ('make COLLISION=regularised') or regularised BGK with Smagorinsky subgrid
+ *            model ('make COLLISION=regularised-smagorinsky'), forwarding to all of their overloads
+ *
+ * \tparam    B      time step and export flags of the collision operator (e.g. odd, save)
+ * \tparam    ARGS   types of the arguments of the collision operator
+ * \param[in] args   arguments of the collision operator (continuum, population, fluid cells, boundaries, ...)
+*/
+template <bool... B, class... ARGS>
+inline void CollideStreamFlow(ARGS&&... args)
 {
-    /// set up OpenMP ------------------------------------------------------------------------------
-    #ifdef _OPENMP
-        Parallelism OpenMP;
-        //OpenMP.SetThreadsNum(1);
+    #if defined(USE_REGULARISED)
+        CollideStreamRegularised<B...>(std::forward<ARGS>(args)...);
+    #elif defined(USE_REGULARISED_SMAGORINSKY)
+        CollideStreamRegularised_Smagorinsky<B...>(std::forward<ARGS>(args)...);
+    #else
+        CollideStreamBGK_Smagorinsky<B...>(std::forward<ARGS>(args)...);
     #endif
+}
 
-    /// print disclaimer ---------------------------------------------------------------------------
-    if (argc > 1)
+/**\fn        Simulation
+ * \brief     Flow around a cylinder in a channel on a compiled domain (see the registry in main)
+ *
+ * \tparam    NX         simulation domain resolution in x-direction
+ * \tparam    NY         simulation domain resolution in y-direction
+ * \tparam    NZ         simulation domain resolution in z-direction
+ * \tparam    DdQq       static lattice::DdQq class containing discretisation parameters
+ * \param[in] settings   settings of the simulation read at run time
+ * \param[in] MPI        distributed memory parallel environment (only with USE_MPI)
+ * \return    Return exit success or failure
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class DdQq>
+#ifdef USE_MPI
+int Simulation(simulationSettings const& settings, Distribution const& MPI)
+#else
+int Simulation(simulationSettings const& settings)
+#endif
+{
+    /// solver settings ---------------------------------------------------------------------------
+    // floating point accuracy of the lattice
+    typedef typename std::remove_const<decltype(DdQq::CS)>::type F_TYPE;
+
+    // memory layout of the populations (structure-of-arrays for coalesced memory access on the device, the cases
+    // of an ensemble innermost for vectorisation across the cases)
+    #if defined(USE_GPU)
+        typedef layout::SoA LAYOUT;
+    #elif defined(USE_ENSEMBLE)
+        typedef layout::Interleaved LAYOUT;
+    #else
+        typedef layout::AoS LAYOUT;
+    #endif
+
+    // in-place streaming of the populations: A-A pattern or esoteric pull ('make STREAMING=esoteric')
+    #ifdef USE_ESOTERIC_PULL
+        typedef streaming::EsotericPull STREAMING;
+    #else
+        typedef streaming::AA STREAMING;
+    #endif
+
+    // storage of the populations: lattice precision, single precision or deviation from the lattice weights
+    // in single or half precision ('make STORAGE=single', 'shifted' or 'half')
+    #if defined(USE_STORAGE_SINGLE)
+        typedef storage::Single STORAGE;
+    #elif defined(USE_STORAGE_SHIFTED)
+        typedef storage::Shifted<float> STORAGE;
+    #elif defined(USE_STORAGE_HALF)
+        typedef storage::Half STORAGE;
+    #else
+        typedef storage::Native STORAGE;
+    #endif
+
+    // populations per cell: the flow and optionally a passive scalar advected with it ('make SCALAR=true') or
+    // the flow of every case of an ensemble ('make ENSEMBLE=K')
+    #if defined(USE_SCALAR)
+        constexpr unsigned int NPOP = 2;
+    #elif defined(USE_ENSEMBLE)
+        constexpr unsigned int NPOP = USE_ENSEMBLE;
+    #else
+        constexpr unsigned int NPOP = 1;
+    #endif
+
+    // collision operator of the flow (see CollideStreamFlow): BGK or regularised BGK with or without Smagorinsky model
+    #if defined(USE_REGULARISED)
+        std::string const COLLISION = "regularised";
+    #elif defined(USE_REGULARISED_SMAGORINSKY)
+        std::string const COLLISION = "regularised-smagorinsky";
+    #else
+        std::string const COLLISION = "smagorinsky";
+    #endif
+
+    // temporal resolution
+    unsigned int const NT = settings.nt;
+
+    // physics
+    F_TYPE       const Re = settings.re;
+    F_TYPE       const  U = settings.u;
+    unsigned int const  L = settings.l;
+
+    // initial conditions
+    constexpr F_TYPE RHO_0 = 1.0;
+    F_TYPE const       U_0 = U;
+    constexpr F_TYPE   V_0 = 0.0;
+    constexpr F_TYPE   W_0 = 0.0;
+
+    // save values to disk every NT/10 time steps (disable for benchmark)
+    bool const save = settings.save;
+
+    // file format and reduction of the export (subregion, stride, precision and compression)
+    ExportFormat const format = (settings.format == "bin") ? ExportFormat::Bin : ((settings.format == "vti") ? ExportFormat::Vti : ExportFormat::Vtk);
+
+    // time steps on which the kernels evaluate the macroscopic values (export, probes, monitors)
+    StepScheduler Steps;
+    unsigned int const exportStep = Steps.Register((save == true) ? NT/10 : 0);
+
+    // in-situ monitors of drag, mass, outlet flux and kinetic energy (host only): stop once the velocity has converged
+    size_t const NT_MONITOR = NT/100;
+    constexpr F_TYPE TOLERANCE = 1.0e-6;
+    #ifndef USE_GPU
+        unsigned int const monitorStep = Steps.Register(NT_MONITOR);
+    #endif
+
+    // domain decomposition: number of planes in z-direction per process (start with NZ/NZ_SUB processes)
+    #ifdef USE_MPI
+        constexpr unsigned int NZ_SUB = NZ/2;
+        typedef Subdomain<NX,NY,NZ,NZ_SUB> Decomposition;
+        Decomposition Domain;
+        constexpr unsigned int NZ_LOCAL = Decomposition::NZ_LOCAL_;
+        bool const isRoot = MPI.IsRoot();
+    #else
+        constexpr unsigned int NZ_LOCAL = NZ;
+        bool const isRoot = true;
+    #endif
+
+    // the autotuner times the wavefront or the block pipeline, both are only used on the host for the flow alone
+    #if defined(USE_MPI) || defined(USE_GPU) || defined(USE_REFINEMENT) || defined(USE_SCALAR) || defined(USE_ENSEMBLE)
+        if ((settings.autotune != Autotuning::Off) && (isRoot == true))
+        {
+            std::cerr << "Warning: Autotuning is only available on a single host without refinement, scalar and ensemble, setting ignored." << std::endl;
+        }
+        if ((settings.timeloop != TimeLoop::Wavefront) && (isRoot == true))
+        {
+            std::cerr << "Warning: Block pipeline is only available on a single host without refinement, scalar and ensemble, setting ignored." << std::endl;
+        }
+    #endif
+    #ifndef USE_ENSEMBLE
+        if ((settings.ensemble.empty() == false) && (isRoot == true))
+        {
+            std::cerr << "Warning: Ensembles are only available with 'make ENSEMBLE=K', setting ignored." << std::endl;
+        }
+    #endif
+
+    // checkpoints of the populations after a pair of time steps every given number of time steps and restart from a
+    // checkpoint given by its name (e.g. 'checkpoint_1000'), every process exports its own subdomain
+    #if defined(USE_GPU) || defined(USE_REFINEMENT)
+        if (((settings.checkpoint > 0) || (settings.restart.empty() == false)) && (isRoot == true))
+        {
+            std::cerr << "Warning: Checkpoints are only available on the host without refinement, settings ignored." << std::endl;
+        }
+    #else
+        // registered like the evaluations so that they also end the segments of the block pipeline
+        unsigned int const checkpointStep = Steps.Register(settings.checkpoint);
+    #endif
+    #ifdef USE_MPI
+        std::string const CHECKPOINT_SUFFIX = "_r" + std::to_string(MPI.GetRank());
+    #else
+        std::string const CHECKPOINT_SUFFIX = "";
+    #endif
+
+    /// set up microscopic and macroscopic arrays --------------------------------------------------
+    Continuum<NX,NY,NZ_LOCAL,F_TYPE> Macro;
+    Population<NX,NY,NZ_LOCAL,DdQq,NPOP,LAYOUT,STORAGE,STREAMING> Micro(Re,U,L);
+    if (isRoot == true)
     {
-        if ((strcmp(argv[1], "--version") == 0) || (strcmp(argv[1], "--v") == 0))
+        InitialOutput(Micro, NT, Re, RHO_0, U, L);
+        ExportParameters(Micro, NT, Re, RHO_0, U, L);
+    }
+
+    /// define boundary conditions -----------------------------------------------------------------
+    alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> wall;
+    alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> inlet;
+    alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> outlet;
+
+    unsigned int const radius = L/2;
+    constexpr std::array<unsigned int,3> position = {NX/4, NY/2, NZ/2};
+    std::vector<boundaryElement<F_TYPE>> obstacle;
+    if (settings.geometry == "cylinder")
+    {
+        Cylinder3D<NX,NY,NZ>(radius, position, "x", true, wall, inlet, outlet, RHO_0, U_0, V_0, W_0);
+
+        // the cylinder without the channel walls for the evaluation of drag and lift
+        std::copy_if(wall.begin(), wall.end(), std::back_inserter(obstacle), [&position, radius](boundaryElement<F_TYPE> const& b)
+                     { return (b.x - position[0])*(b.x - position[0]) + (b.y - position[1])*(b.y - position[1]) <= radius*radius; });
+    }
+    else
+    {
+        // surface mesh (*.stl) or voxels (*.raw) in a channel: the obstacle are all walls apart from the channel walls
+        ImportGeometry<NX,NY,NZ>(settings.geometry, "x", true, wall, inlet, outlet, RHO_0, U_0, V_0, W_0);
+        std::copy_if(wall.begin(), wall.end(), std::back_inserter(obstacle), [](boundaryElement<F_TYPE> const& b)
+                     { return (b.y != 0) && (b.y != NY-1) && (b.z != 0) && (b.z != NZ-1); });
+    }
+
+    // probes in the wake sampled every time step for spectra (host only): a point and a line across the channel
+    std::vector<probePoint> wake;
+    if (save == true)
+    {
+        unsigned int const x_wake = std::min(position[0] + 2*L, NX - 2);
+        wake = ProbePoint(x_wake, NY/2 + radius/2, NZ/2);
+        std::vector<probePoint> const line = ProbeLine({x_wake, 1, NZ/2}, "y", NY - 2);
+        wake.insert(wake.end(), line.begin(), line.end());
+    }
+
+    #ifdef USE_MPI
+        // boundaries of the subdomain in local coordinates: walls are also required in the ghost layers
+        wall   = Domain.Distribute(wall,   true);
+        inlet  = Domain.Distribute(inlet,  false);
+        outlet = Domain.Distribute(outlet, false);
+        obstacle = Domain.Distribute(obstacle, true);
+
+        // cells next to the ghost layers are collided first so that the halo exchange overlaps with the inner cells
+        FluidCells<NX,NY,NZ_LOCAL> const fluidLower(Micro, wall, 1, 2);
+        FluidCells<NX,NY,NZ_LOCAL> const fluidUpper(Micro, wall, NZ_SUB, NZ_SUB + 1);
+        FluidCells<NX,NY,NZ_LOCAL> const fluidInner(Micro, wall, 2, NZ_SUB);
+
+        // boundaries fused with the collision sweep of each list, bounce-back of walls overwritten by the halo exchange
+        typedef FusedGuo<type::Velocity,orientation::Left, NX,NY,NZ_LOCAL,F_TYPE> FusedInlet;
+        typedef FusedGuo<type::Pressure,orientation::Right,NX,NY,NZ_LOCAL,F_TYPE> FusedOutlet;
+        FusedInlet  const inletLower(fluidLower, inlet),  inletUpper(fluidUpper, inlet),  inletInner(fluidInner, inlet);
+        FusedOutlet const outletLower(fluidLower, outlet), outletUpper(fluidUpper, outlet), outletInner(fluidInner, outlet);
+        CompactBounceBack<NX,NY,NZ_LOCAL> const wallHalo(Micro, Domain.HaloAdjacent(wall), wall);
+
+        // the blocks of the inner cells are balanced between the threads by work-stealing
+        BlockScheduler<NX,NY,NZ_LOCAL> schedulerInner(fluidInner, inletInner, outletInner);
+
+        HaloExchange<NX,NY,NZ_LOCAL,DdQq,NPOP,LAYOUT,STORAGE,STREAMING> Halo(Domain.comm_, Domain.lower_, Domain.upper_);
+
+        // monitors reduce over all owned cells of every process, only root writes the time series
+        FluidCells<NX,NY,NZ_LOCAL> const fluidOwned(Micro, wall, 1, NZ_SUB + 1);
+        Monitor<NX,NY,NZ_LOCAL,F_TYPE> Monitors(Micro, fluidOwned, obstacle, outlet, NT_MONITOR, TOLERANCE,
+                                                (isRoot == true) ? OUTPUT_MONITOR_PATH + "/monitor.csv" : "");
+
+        // global macroscopic values for export only on root
+        std::unique_ptr<Continuum<NX,NY,NZ,F_TYPE>> Global((isRoot == true) ? new Continuum<NX,NY,NZ,F_TYPE>() : nullptr);
+        std::unique_ptr<AsyncExport<NX,NY,NZ,F_TYPE>> Writer((isRoot == true) ? new AsyncExport<NX,NY,NZ,F_TYPE>(format, "step", false, settings.output) : nullptr);
+    #elif defined(USE_GPU)
+        // boundaries in device memory
+        DeviceBoundary<F_TYPE> const wallDevice(wall);
+        DeviceBoundary<F_TYPE> const inletDevice(inlet);
+        DeviceBoundary<F_TYPE> const outletDevice(outlet);
+
+        // macroscopic values are only copied to the host on export steps
+        DeviceContinuum<NX,NY,NZ,F_TYPE> MacroDevice;
+        AsyncExport<NX,NY,NZ,F_TYPE> Writer(format, "step", false, settings.output);
+    #elif defined(USE_REFINEMENT)
+        // indirect addressing: collide only the fluid cells
+        FluidCells<NX,NY,NZ> const fluid(Micro, wall);
+
+        // boundaries fused with the collision sweep
+        FusedGuo<type::Velocity,orientation::Left, NX,NY,NZ,F_TYPE> const inletFused(fluid, inlet);
+        FusedGuo<type::Pressure,orientation::Right,NX,NY,NZ,F_TYPE> const outletFused(fluid, outlet);
+
+        // refined patch around the cylinder and its near wake: boundary layer resolved with half the spacing
+        typedef RefinedPatch<NX,NY,NZ,NX/4 - NY/8,NY/2 - NY/8,NZ/4,NY/2,NY/4,NZ/2,F_TYPE> Refinement;
+        constexpr unsigned int NX_FINE = Refinement::NX_FINE_;
+        constexpr unsigned int NY_FINE = Refinement::NY_FINE_;
+        constexpr unsigned int NZ_FINE = Refinement::NZ_FINE_;
+        if (settings.geometry != "cylinder")
         {
-            PrintDisclaimer();
-            exit(EXIT_SUCCESS);
+            std::cerr << "Fatal error: Local grid refinement is only available for the cylinder." << std::endl;
+            exit(EXIT_FAILURE);
         }
-        else if (strcmp(argv[1], "--convert") == 0)
+        if (radius + 2 > NY/8)
         {
-            std::cerr << "Error: Feature not implemented yet." << std::endl;
+            std::cerr << "Fatal error: Cylinder of radius " << radius << " does not fit into the refined patch." << std::endl;
             exit(EXIT_FAILURE);
         }
-        else if ((strcmp(argv[1], "--info") == 0) || (strcmp(argv[1], "--help") == 0))
+
+        Continuum<NX_FINE,NY_FINE,NZ_FINE,F_TYPE> MacroFine;
+        Population<NX_FINE,NY_FINE,NZ_FINE,DdQq,1,LAYOUT,STORAGE,STREAMING> MicroFine(Re,U,Refinement::RATIO_*L);
+
+        // cylinder voxelised with the fine spacing, the faces of the patch are coupled to the coarse level
+        std::vector<boundaryElement<F_TYPE>> wallFine;
+        std::vector<boundaryElement<F_TYPE>> inletFine;
+        std::vector<boundaryElement<F_TYPE>> outletFine;
+        Cylinder3D<NX_FINE,NY_FINE,NZ_FINE>(radius, position, "x", false, wallFine, inletFine, outletFine,
+                                            RHO_0, U_0, V_0, W_0, Refinement::Origin(), Refinement::Spacing());
+        FluidCells<NX_FINE,NY_FINE,NZ_FINE> const fluidFine(MicroFine, wallFine);
+        Refinement Patch(Micro, fluid, MicroFine, fluidFine);
+
+        std::cout << "Refined patch: " << NX_FINE << "x" << NY_FINE << "x" << NZ_FINE << ", "
+                  << static_cast<size_t>(NX)*NY*NZ + Refinement::GetNumberOfCells() << " cells instead of "
+                  << static_cast<size_t>(NX)*NY*NZ*Refinement::RATIO_*Refinement::RATIO_*Refinement::RATIO_
+                  << " with uniform refinement" << std::endl;
+
+        AsyncExport<NX,NY,NZ,F_TYPE> Writer(format, "step", false, settings.output);
+
+        Monitor<NX,NY,NZ,F_TYPE> Monitors(Micro, fluid, obstacle, outlet, NT_MONITOR, TOLERANCE, OUTPUT_MONITOR_PATH + "/monitor.csv");
+        Probes<NX,NY,NZ,F_TYPE> WakeProbes(fluid, wake, OUTPUT_PROBE_PATH + "/probes_wake");
+    #elif defined(USE_SCALAR)
+        // indirect addressing: collide only the fluid cells
+        FluidCells<NX,NY,NZ> const fluid(Micro, wall);
+
+        // boundaries of the flow fused with the collision sweep
+        FusedGuo<type::Velocity,orientation::Left, NX,NY,NZ,F_TYPE> const inletFused(fluid, inlet);
+        FusedGuo<type::Pressure,orientation::Right,NX,NY,NZ,F_TYPE> const outletFused(fluid, outlet);
+
+        // passive scalar (p = 1) advected with the flow: the concentration of the inlet elements (their density) is
+        // imposed at the inlet, extrapolated at the outlet and the walls are impermeable
+        F_TYPE const OMEGA_S = ScalarCollisionFrequency(Micro, static_cast<F_TYPE>(settings.schmidt));
+        Continuum<NX,NY,NZ,F_TYPE> Scalar;
+        if (isRoot == true)
         {
-            std::cerr << "Usage: '--convert'             Convert *.bin files to *.vtk" << std::endl;
-            std::cerr << "       '--help'    or '--info' Show help"                    << std::endl;
-            std::cerr << "       '--version' or '--v'    Show build version"           << std::endl;
-            exit(EXIT_SUCCESS);
+            std::cout << "Passive scalar with Schmidt number " << settings.schmidt << " (relaxation time " << 1.0/OMEGA_S << ")." << std::endl;
         }
+
+        // export of the flow and of the concentration and the scalar flux
+        AsyncExport<NX,NY,NZ,F_TYPE> Writer(format, "step", false, settings.output);
+        AsyncExport<NX,NY,NZ,F_TYPE> ScalarWriter(format, "scalar", false, settings.output);
+
+        Monitor<NX,NY,NZ,F_TYPE> Monitors(Micro, fluid, obstacle, outlet, NT_MONITOR, TOLERANCE, OUTPUT_MONITOR_PATH + "/monitor.csv");
+        Probes<NX,NY,NZ,F_TYPE> WakeProbes(fluid, wake, OUTPUT_PROBE_PATH + "/probes_wake");
+    #elif defined(USE_ENSEMBLE)
+        // Reynolds numbers of the cases sharing the geometry, the characteristic velocity and the boundary values
+        if (settings.ensemble.size() != NPOP)
+        {
+            std::cerr << "Fatal error: The ensemble is compiled for " << NPOP << " cases but " << settings.ensemble.size()
+                      << " Reynolds numbers are given ('--ensemble Re_0,Re_1,...')." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        std::array<F_TYPE,NPOP> ReCases = {};
+        std::array<F_TYPE,NPOP> UCases  = {};
+        std::copy(settings.ensemble.begin(), settings.ensemble.end(), ReCases.begin());
+        UCases.fill(U);
+        EnsembleParameters<NPOP,DdQq,F_TYPE> const Cases(ReCases, UCases, L);
+        if (isRoot == true)
+        {
+            for(unsigned int k = 0; k < NPOP; ++k)
+            {
+                std::cout << "Ensemble case " << k << ": Reynolds number " << ReCases[k] << " (relaxation time " << Cases.TAU_[k] << ")." << std::endl;
+            }
+        }
+
+        // indirect addressing: collide only the fluid cells of the shared geometry
+        FluidCells<NX,NY,NZ> const fluid(Micro, wall);
+
+        // boundaries of every case fused with the collision sweep
+        auto const inletFused  = MakeEnsembleArray<NPOP>(FusedGuo<type::Velocity,orientation::Left, NX,NY,NZ,F_TYPE>(fluid, inlet));
+        auto const outletFused = MakeEnsembleArray<NPOP>(FusedGuo<type::Pressure,orientation::Right,NX,NY,NZ,F_TYPE>(fluid, outlet));
+
+        // macroscopic values, export and monitors of every case: the ensemble stops once all cases have converged
+        EnsembleArray<Continuum<NX,NY,NZ,F_TYPE>,NPOP> MacroCases;
+        std::vector<std::unique_ptr<AsyncExport<NX,NY,NZ,F_TYPE>>> Writers;
+        std::vector<std::unique_ptr<Monitor<NX,NY,NZ,F_TYPE>>> Monitors;
+        for(unsigned int k = 0; k < NPOP; ++k)
+        {
+            Writers.emplace_back(new AsyncExport<NX,NY,NZ,F_TYPE>(format, "case" + std::to_string(k), false, settings.output));
+            Monitors.emplace_back(new Monitor<NX,NY,NZ,F_TYPE>(Micro, fluid, obstacle, outlet, NT_MONITOR, TOLERANCE,
+                                                                OUTPUT_MONITOR_PATH + "/monitor_case" + std::to_string(k) + ".csv"));
+        }
+    #else
+        // time steps between two evaluations advanced in a single parallel region by a block pipeline
+        bool const isPipeline = (settings.timeloop == TimeLoop::Pipeline);
+
+        // startup autotuning of the loop block shape, the threads and the kernel variant on the actual domain
+        // (cached per machine and case): the populations are initialised again below
+        auto const tuneCase = [&](tuningConfiguration const& candidate)
+        {
+            FluidCells<NX,NY,NZ> const fluidCandidate(Micro, wall, 0, NZ, candidate.block);
+            if (isPipeline == true)
+            {
+                constexpr unsigned int PIPELINE_STEPS = 8;
+                BlockPipeline<NX,NY,NZ> pipelineCandidate(fluidCandidate);
+                FusedGuo<type::Velocity,orientation::Left, NX,NY,NZ,F_TYPE> const inletCandidate(fluidCandidate, inlet);
+                FusedGuo<type::Pressure,orientation::Right,NX,NY,NZ,F_TYPE> const outletCandidate(fluidCandidate, outlet);
+                return MeasureSpeed(fluidCandidate.GetNumberOfCells(), PIPELINE_STEPS, [&]()
+                {
+                    CollideStreamFlow(Macro, Micro, pipelineCandidate, PIPELINE_STEPS, 0, inletCandidate, outletCandidate);
+                });
+            }
+            Wavefront<NX,NY,NZ> const tileCandidate(fluidCandidate, 2);
+            FusedGuo<type::Velocity,orientation::Left, NX,NY,NZ,F_TYPE> const inletCandidate(tileCandidate, inlet);
+            FusedGuo<type::Pressure,orientation::Right,NX,NY,NZ,F_TYPE> const outletCandidate(tileCandidate, outlet);
+            return MeasureSpeed(fluidCandidate.GetNumberOfCells(), tileCandidate.STEPS_, [&]()
+            {
+                CollideStreamFlow(Macro, Micro, tileCandidate, 0, inletCandidate, outletCandidate);
+            });
+        };
+        if (settings.autotune != Autotuning::Off)
+        {
+            InitContinuum(Macro, RHO_0, U_0, V_0, W_0);
+            InitLattice<false>(Macro, Micro);
+        }
+        tuningConfiguration const tuning = Autotune(settings.autotune, CaseSignature(NX, NY, NZ, DdQq::SPEEDS, STREAMING::NAME, STORAGE::NAME, COLLISION,
+                                                                                     (isPipeline == true) ? "pipeline" : "wavefront", settings.geometry),
+                                                    {NX, NY, NZ}, tuneCase);
+
+        // indirect addressing: collide only the fluid cells
+        FluidCells<NX,NY,NZ> const fluid(Micro, wall, 0, NZ, tuning.block);
+
+        // temporal blocking: the even and the odd time step are advanced plane by plane in a single wavefront
+        Wavefront<NX,NY,NZ> const tile(fluid, 2);
+
+        // or all time steps up to the next evaluation by a pipeline of the loop blocks
+        BlockPipeline<NX,NY,NZ> pipeline(fluid);
+
+        // boundaries fused with the planes of the wavefront or the loop blocks of the pipeline
+        typedef FusedGuo<type::Velocity,orientation::Left, NX,NY,NZ,F_TYPE> FusedInlet;
+        typedef FusedGuo<type::Pressure,orientation::Right,NX,NY,NZ,F_TYPE> FusedOutlet;
+        FusedInlet  const inletFused  = (isPipeline == true) ? FusedInlet(fluid, inlet)   : FusedInlet(tile, inlet);
+        FusedOutlet const outletFused = (isPipeline == true) ? FusedOutlet(fluid, outlet) : FusedOutlet(tile, outlet);
+
+        // export in the background while the solver keeps on stepping
+        AsyncExport<NX,NY,NZ,F_TYPE> Writer(format, "step", false, settings.output);
+
+        Monitor<NX,NY,NZ,F_TYPE> Monitors(Micro, fluid, obstacle, outlet, NT_MONITOR, TOLERANCE, OUTPUT_MONITOR_PATH + "/monitor.csv");
+
+        // probes sampled within the planes of the wavefront or the loop blocks of the pipeline
+        Probes<NX,NY,NZ,F_TYPE> WakeProbes = (isPipeline == true) ? Probes<NX,NY,NZ,F_TYPE>(fluid, wake, OUTPUT_PROBE_PATH + "/probes_wake") :
+                                                                    Probes<NX,NY,NZ,F_TYPE>(tile,  wake, OUTPUT_PROBE_PATH + "/probes_wake");
+
+        // a pipeline segment ends on the next evaluation or before the probes could overrun their buffer
+        size_t const SEGMENT = std::max(size_t(2), 2*((WakeProbes.CAPACITY_/2)*WakeProbes.INTERVAL_/2));
+    #endif
+
+    /// define initial conditions ------------------------------------------------------------------
+    InitContinuum(Macro, RHO_0, U_0, V_0, W_0);
+    InitLattice<false>(Macro, Micro);
+
+    #ifdef USE_ENSEMBLE
+        // all cases start from the same uniform flow
+        for(unsigned int k = 1; k < NPOP; ++k)
+        {
+            InitLattice<false>(Macro, Micro, k);
+        }
+    #endif
+
+    #ifdef USE_SCALAR
+        // the channel is free of the scalar at the beginning
+        InitContinuum(Scalar, 0.0, U_0, V_0, W_0);
+        InitLattice<false>(Scalar, Micro, 1);
+    #endif
+
+    #ifdef USE_REFINEMENT
+        InitContinuum(MacroFine, RHO_0, U_0, V_0, W_0);
+        InitLattice<false>(MacroFine, MicroFine);
+    #endif
+
+    /// restart from a checkpoint ------------------------------------------------------------------
+    size_t start = 0;
+    #if !defined(USE_GPU) && !defined(USE_REFINEMENT)
+        if (settings.restart.empty() == false)
+        {
+            // the time loop advances pairs of time steps: the next time step has to be an even one
+            bool odd = false;
+            Micro.Import(settings.restart + CHECKPOINT_SUFFIX, start, odd);
+            if ((odd == true) || (start % 2 != 0))
+            {
+                std::cerr << "Fatal error: Checkpoint '" << settings.restart << "' does not end on a pair of time steps." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if (isRoot == true)
+            {
+                std::cout << "Restarted from checkpoint '" << settings.restart << "' after " << start << " time steps." << std::endl;
+            }
+        }
+    #endif
+
+    #ifdef USE_GPU
+        DevicePopulation<NX,NY,NZ,DdQq,LAYOUT> MicroDevice(Micro);
+    #endif
+
+    /// main loop ----------------------------------------------------------------------------------
+    if (isRoot == true)
+    {
+        std::cout << "Simulation started..." << std::endl;
+    }
+
+    Timer Stopwatch;
+    Stopwatch.Start();
+
+    size_t steps = NT;
+    for (size_t i = start; i < NT; i+=2)
+    {
+        #ifdef USE_MPI
+            // even time step: boundary planes are copied to the ghost layers of the neighbours
+            {
+                PROFILE_PHASE("guo");
+                Guo<false>(inletLower,  Micro, 0);
+                Guo<false>(inletUpper,  Micro, 0);
+                Guo<false>(inletInner,  Micro, 0);
+                Guo<false>(outletLower, Micro, 0);
+                Guo<false>(outletUpper, Micro, 0);
+                Guo<false>(outletInner, Micro, 0);
+            }
+            {
+                PROFILE_PHASE("collision halo");
+                CollideStreamFlow<false>(Macro, Micro, fluidLower, 0, inletLower, outletLower);
+                CollideStreamFlow<false>(Macro, Micro, fluidUpper, 0, inletUpper, outletUpper);
+                Halo.StartGhostUpdate(Micro);
+            }
+            {
+                PROFILE_PHASE("collision inner");
+                CollideStreamFlow<false>(Macro, Micro, fluidInner, schedulerInner, 0, inletInner, outletInner);
+            }
+            {
+                PROFILE_PHASE("halo exchange");
+                Halo.FinishGhostUpdate(Micro);
+                BounceBackHalfway<false>(wallHalo, Micro);
+            }
+
+            // odd time step: populations streamed into the ghost layers are sent back to their owners
+            {
+                PROFILE_PHASE("guo");
+                Guo<true>(inletLower,  Micro, 0);
+                Guo<true>(inletUpper,  Micro, 0);
+                Guo<true>(inletInner,  Micro, 0);
+                Guo<true>(outletLower, Micro, 0);
+                Guo<true>(outletUpper, Micro, 0);
+                Guo<true>(outletInner, Micro, 0);
+            }
+            Steps.Dispatch(i, [&](auto const isDue)
+            {
+                {
+                    PROFILE_PHASE("collision halo");
+                    CollideStreamFlow<true,decltype(isDue)::value>(Macro, Micro, fluidLower, 0, inletLower, outletLower);
+                    CollideStreamFlow<true,decltype(isDue)::value>(Macro, Micro, fluidUpper, 0, inletUpper, outletUpper);
+                    Halo.StartWriteBack(Micro);
+                }
+                {
+                    PROFILE_PHASE("collision inner");
+                    CollideStreamFlow<true,decltype(isDue)::value>(Macro, Micro, fluidInner, schedulerInner, 0, inletInner, outletInner);
+                }
+            });
+            {
+                PROFILE_PHASE("halo exchange");
+                Halo.FinishWriteBack(Micro);
+                BounceBackHalfway<true>(wallHalo, Micro);
+            }
+
+            if (Steps.IsDue(checkpointStep, i) == true)
+            {
+                PROFILE_PHASE("checkpoint");
+                Micro.Export("checkpoint_" + std::to_string(i + 2) + CHECKPOINT_SUFFIX, i + 2, false);
+            }
+
+            if (Steps.IsDue(exportStep, i) == true)
+            {
+                PROFILE_PHASE("export");
+                Macro.SetZero(wall);
+                Domain.Gather(Macro, Global.get());
+
+                if (isRoot == true)
+                {
+                    StatusOutput(i, NT);
+                    Writer->Submit(*Global, i);
+                }
+            }
+
+            if (Steps.IsDue(monitorStep, i) == true)
+            {
+                PROFILE_PHASE("monitor");
+                Monitors.template Evaluate<true>(i, Macro, Micro);
+                if (Monitors.IsConverged() == true)
+                {
+                    if (isRoot == true)
+                    {
+                        std::cout << "Converged after " << i + 2 << " time steps." << std::endl;
+                    }
+                    steps = i + 2;
+                    break;
+                }
+            }
+        #elif defined(USE_GPU)
+            bool const isExport = Steps.IsDue(exportStep, i);
+
+            // even time step
+            Guo<false,type::Velocity,orientation::Left>(inletDevice,  MicroDevice);
+            Guo<false,type::Pressure,orientation::Right>(outletDevice, MicroDevice);
+            CollideStreamBGK_Smagorinsky<false>(MacroDevice, MicroDevice);
+            BounceBackHalfway<false>(wallDevice, MicroDevice);
+
+            // odd time step
+            Guo<true,type::Velocity,orientation::Left>(inletDevice,  MicroDevice);
+            Guo<true,type::Pressure,orientation::Right>(outletDevice, MicroDevice);
+            Steps.Dispatch(i, [&](auto const isDue)
+            {
+                CollideStreamBGK_Smagorinsky<true,decltype(isDue)::value>(MacroDevice, MicroDevice);
+            });
+            BounceBackHalfway<true>(wallDevice, MicroDevice);
+
+            if (isExport == true)
+            {
+                StatusOutput(i, NT);
+                MacroDevice.CopyTo(Macro);
+                Macro.SetZero(wall);
+                Writer.Submit(Macro, i);
+            }
+        #else
+            // even and odd time step
+            {
+                PROFILE_PHASE("collision");
+                #if defined(USE_REFINEMENT)
+                    // every coarse time step is accompanied by two time steps of the refined patch
+                    auto const fineStep = [&](auto const isOdd)
+                    {
+                        CollideStreamFlow<decltype(isOdd)::value>(MacroFine, MicroFine, fluidFine, 0);
+                    };
+                    Patch.template Advance<false>(Micro, MicroFine, [&](auto const)
+                    {
+                        Guo<false>(inletFused,  Micro, 0);
+                        Guo<false>(outletFused, Micro, 0);
+                        CollideStreamFlow<false>(Macro, Micro, fluid, 0, inletFused, outletFused, WakeProbes);
+                    }, fineStep);
+                    Steps.Dispatch(i, [&](auto const isDue)
+                    {
+                        Patch.template Advance<true>(Micro, MicroFine, [&](auto const)
+                        {
+                            Guo<true>(inletFused,  Micro, 0);
+                            Guo<true>(outletFused, Micro, 0);
+                            CollideStreamFlow<true,decltype(isDue)::value>(Macro, Micro, fluid, 0, inletFused, outletFused, WakeProbes);
+                        }, fineStep);
+                    });
+                #elif defined(USE_SCALAR)
+                    // flow and scalar in a single sweep: the boundaries of the scalar are applied before the sweep
+                    auto const scalarStep = [&](auto const isOdd, auto const isDue)
+                    {
+                        constexpr bool odd = decltype(isOdd)::value;
+                        Guo<odd>(inletFused,  Micro, 0);
+                        Guo<odd>(outletFused, Micro, 0);
+                        GuoScalar<odd,type::Pressure,orientation::Left>(inlet,   Micro);
+                        GuoScalar<odd,type::Velocity,orientation::Right>(outlet, Micro);
+                        CollideStreamBGK_Scalar<odd,decltype(isDue)::value>(Macro, Scalar, Micro, fluid, OMEGA_S, inletFused, outletFused, WakeProbes);
+                    };
+                    scalarStep(std::false_type(), std::false_type());
+                    Steps.Dispatch(i, [&](auto const isDue)
+                    {
+                        scalarStep(std::true_type(), isDue);
+                    });
+                #elif defined(USE_ENSEMBLE)
+                    // all cases in a single sweep: the boundary elements that can not be fused are applied before the sweep
+                    auto const ensembleStep = [&](auto const isOdd, auto const isDue)
+                    {
+                        constexpr bool odd = decltype(isOdd)::value;
+                        for(unsigned int k = 0; k < NPOP; ++k)
+                        {
+                            Guo<odd>(inletFused[k],  Micro, k);
+                            Guo<odd>(outletFused[k], Micro, k);
+                        }
+                        CollideStreamBGK_Ensemble<odd,decltype(isDue)::value>(MacroCases, Micro, fluid, Cases, inletFused, outletFused);
+                    };
+                    ensembleStep(std::false_type(), std::false_type());
+                    Steps.Dispatch(i, [&](auto const isDue)
+                    {
+                        ensembleStep(std::true_type(), isDue);
+                    });
+                #else
+                    if (isPipeline == true)
+                    {
+                        // pairs of time steps i to last in a single parallel region, evaluations follow the last pair
+                        size_t const last = Steps.NextDue(i, 2, std::min(static_cast<size_t>(NT), i + SEGMENT));
+                        Steps.Dispatch(last, [&](auto const isDue)
+                        {
+                            CollideStreamFlow<decltype(isDue)::value>(Macro, Micro, pipeline, last - i + 2, 0, inletFused, outletFused, WakeProbes);
+                        });
+                        i = last;
+                    }
+                    else
+                    {
+                        Steps.Dispatch(i, [&](auto const isDue)
+                        {
+                            CollideStreamFlow<decltype(isDue)::value>(Macro, Micro, tile, 0, inletFused, outletFused, WakeProbes);
+                        });
+                    }
+                #endif
+            }
+
+            #ifndef USE_ENSEMBLE
+                if (WakeProbes.IsFlushDue() == true)
+                {
+                    PROFILE_PHASE("probes");
+                    WakeProbes.Flush();
+                }
+            #endif
+
+            #ifndef USE_REFINEMENT
+                if (Steps.IsDue(checkpointStep, i) == true)
+                {
+                    PROFILE_PHASE("checkpoint");
+                    Micro.Export("checkpoint_" + std::to_string(i + 2), i + 2, false);
+                }
+            #endif
+
+            if (Steps.IsDue(exportStep, i) == true)
+            {
+                PROFILE_PHASE("export");
+                StatusOutput(i, NT);
+                #ifdef USE_ENSEMBLE
+                    for(unsigned int k = 0; k < NPOP; ++k)
+                    {
+                        MacroCases[k].SetZero(wall);
+                        Writers[k]->Submit(MacroCases[k], i);
+                    }
+                #else
+                    Macro.SetZero(wall);
+                    Writer.Submit(Macro, i);
+                #endif
+                #ifdef USE_SCALAR
+                    Scalar.SetZero(wall);
+                    ScalarWriter.Submit(Scalar, i);
+                #endif
+            }
+
+            if (Steps.IsDue(monitorStep, i) == true)
+            {
+                PROFILE_PHASE("monitor");
+                #ifdef USE_ENSEMBLE
+                    bool isConverged = true;
+                    for(unsigned int k = 0; k < NPOP; ++k)
+                    {
+                        Monitors[k]->template Evaluate<true>(i, MacroCases[k], Micro, k);
+                        isConverged = isConverged && Monitors[k]->IsConverged();
+                    }
+                #else
+                    Monitors.template Evaluate<true>(i, Macro, Micro);
+                    bool const isConverged = Monitors.IsConverged();
+                #endif
+                if (isConverged == true)
+                {
+                    if (isRoot == true)
+                    {
+                        std::cout << "Converged after " << i + 2 << " time steps." << std::endl;
+                    }
+                    steps = i + 2;
+                    break;
+                }
+            }
+        #endif
     }
 
+    #ifdef USE_GPU
+        GPU_CHECK(gpuDeviceSynchronize());
+    #endif
+    Stopwatch.Stop();
+
+    #ifdef USE_MPI
+        double runtime = Stopwatch.GetRuntime();
+        MPI_Allreduce(MPI_IN_PLACE, &runtime, 1, MPI_DOUBLE, MPI_MAX, Domain.comm_);
+        if (isRoot == true)
+        {
+            PerformanceOutput(Macro, Micro, steps - start, NT, runtime, MPI.GetSize(), NZ_LOCAL - NZ_SUB);
+            std::cout << "Export stalled the solver for " << Writer->GetStallTime() << " s." << std::endl;
+            Writer->Finish();
+            PROFILE_SUMMARY();
+        }
+        PROFILE_TRACE(OUTPUT_PROFILE_PATH + "/trace_" + std::to_string(MPI.GetRank()) + ".json");
+    #else
+        PerformanceOutput(Macro, Micro, steps - start, NT, Stopwatch.GetRuntime());
+        #ifdef USE_ENSEMBLE
+            for(unsigned int k = 0; k < NPOP; ++k)
+            {
+                std::cout << "Export of case " << k << " stalled the solver for " << Writers[k]->GetStallTime() << " s." << std::endl;
+                Writers[k]->Finish();
+            }
+        #else
+            std::cout << "Export stalled the solver for " << Writer.GetStallTime() << " s." << std::endl;
+            Writer.Finish();
+        #endif
+        #ifdef USE_SCALAR
+            ScalarWriter.Finish();
+        #endif
+        PROFILE_SUMMARY();
+        PROFILE_TRACE(OUTPUT_PROFILE_PATH + "/trace.json");
+    #endif
+
+    /// final export -------------------------------------------------------------------------------
+    /*Macro.SetZero(wall);
+    Macro.Export("step",NT);
+    Macro.ExportVtk(NT);
+    Macro.ExportScalarVtk(0,"rho",NT);*/
+
+    return EXIT_SUCCESS;
+}
+
+#ifdef USE_MOMENTS
+/**\fn        MomentSimulation
+ * \brief     Flow around a cylinder (or an imported geometry) in a channel on a compiled domain with the
+ *            lattice stored in moment space (see moments.hpp): density, velocity and the non-equilibrium
+ *            second order moments of every cell are kept in two buffers, the populations are reconstructed
+ *            within the regularised BGK sweep over the fluid cells (halfway bounce-back of the links towards
+ *            solid cells) and the inlet and outlet are imposed with the Guo boundaries in moment space.
+ *
+ * \tparam    NX         simulation domain resolution in x-direction
+ * \tparam    NY         simulation domain resolution in y-direction
+ * \tparam    NZ         simulation domain resolution in z-direction
+ * \tparam    DdQq       static lattice::DdQq class containing discretisation parameters
+ * \param[in] settings   settings of the simulation read at run time
+ * \return    Return exit success or failure
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class DdQq>
+int MomentSimulation(simulationSettings const& settings)
+{
     /// solver settings ---------------------------------------------------------------------------
-    // floating point accuracy
-    typedef double F_TYPE;
+    // floating point accuracy of the lattice
+    typedef typename std::remove_const<decltype(DdQq::CS)>::type F_TYPE;
 
-    // lattice
-    typedef lattice::D3Q27<F_TYPE> DdQq;
+    // storage of the moments: lattice precision or single precision ('make STORAGE=single')
+    #if defined(USE_STORAGE_SINGLE)
+        typedef storage::Single STORAGE;
+    #else
+        typedef storage::Native STORAGE;
+    #endif
 
-    // spatial and temporal resolution
-    constexpr unsigned int NX = 192;
-    constexpr unsigned int NY = 96;
-    constexpr unsigned int NZ = 96;
-    constexpr unsigned int NT = 10000;
+    // temporal resolution
+    unsigned int const NT = settings.nt;
 
     // physics
-    constexpr F_TYPE      Re = 1000.0;
-    constexpr F_TYPE       U = 0.05;
-    constexpr unsigned int L = NY/5;
+    F_TYPE       const Re = settings.re;
+    F_TYPE       const  U = settings.u;
+    unsigned int const  L = settings.l;
 
     // initial conditions
     constexpr F_TYPE RHO_0 = 1.0;
-    constexpr F_TYPE   U_0 = U;
+    F_TYPE const       U_0 = U;
     constexpr F_TYPE   V_0 = 0.0;
     constexpr F_TYPE   W_0 = 0.0;
 
-    // save values to disk after each time step (disable for benchmark)
-    constexpr bool save = true;
+    // save density and velocity to disk every NT/10 time steps (disable for benchmark)
+    bool const save = settings.save;
+    ExportFormat const format = (settings.format == "bin") ? ExportFormat::Bin : ((settings.format == "vti") ? ExportFormat::Vti : ExportFormat::Vtk);
 
-    /// set up microscopic and macroscopic arrays --------------------------------------------------
+    // time steps on which the kernel evaluates the macroscopic values
+    StepScheduler Steps;
+    unsigned int const exportStep = Steps.Register((save == true) ? NT/10 : 0);
+
+    if ((settings.autotune != Autotuning::Off) || (settings.timeloop != TimeLoop::Wavefront) || (settings.checkpoint > 0) ||
+        (settings.restart.empty() == false) || (settings.ensemble.empty() == false))
+    {
+        std::cerr << "Warning: Lattices stored in moment space are advanced by the sweep over the fluid cells, "
+                  << "time loop, autotuning, checkpoints and ensembles ignored." << std::endl;
+    }
+
+    /// set up moments and macroscopic arrays ------------------------------------------------------
     Continuum<NX,NY,NZ,F_TYPE> Macro;
-    Population<NX,NY,NZ,DdQq>  Micro(Re,U,L);
-    InitialOutput(Micro, NT, Re, RHO_0, U, L);
-    ExportParameters(Micro, NT, Re, RHO_0, U, L);
+    MomentPopulation<NX,NY,NZ,DdQq,STORAGE> Moments(Re,U,L);
+    InitialOutput(Moments, NT, Re, RHO_0, U, L);
+    ExportParameters(Moments, NT, Re, RHO_0, U, L);
 
     /// define boundary conditions -----------------------------------------------------------------
     alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> wall;
     alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> inlet;
     alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> outlet;
 
-    constexpr unsigned int radius = L/2;
+    unsigned int const radius = L/2;
     constexpr std::array<unsigned int,3> position = {NX/4, NY/2, NZ/2};
-    Cylinder3D<NX,NY,NZ>(radius, position, "x", true, wall, inlet, outlet, RHO_0, U_0, V_0, W_0);
+    if (settings.geometry == "cylinder")
+    {
+        Cylinder3D<NX,NY,NZ>(radius, position, "x", true, wall, inlet, outlet, RHO_0, U_0, V_0, W_0);
+    }
+    else
+    {
+        ImportGeometry<NX,NY,NZ>(settings.geometry, "x", true, wall, inlet, outlet, RHO_0, U_0, V_0, W_0);
+    }
+
+    // indirect addressing: collide only the fluid cells, links towards the walls are bounced back within the sweep
+    FluidCells<NX,NY,NZ> const fluid(Moments, wall);
+
+    // export of density and velocity in the background while the solver keeps on stepping
+    AsyncExport<NX,NY,NZ,F_TYPE> Writer(format, "step", false, settings.output);
 
     /// define initial conditions ------------------------------------------------------------------
     InitContinuum(Macro, RHO_0, U_0, V_0, W_0);
-    InitLattice<false>(Macro, Micro);
+    InitLattice<false>(Macro, Moments);
 
     /// main loop ----------------------------------------------------------------------------------
     std::cout << "Simulation started..." << std::endl;
@@ -112,35 +952,281 @@ int main(int argc, char** argv)
     for (size_t i = 0; i < NT; i+=2)
     {
         // even time step
-        Guo<false,type::Velocity,orientation::Left>(inlet,  Micro, 0);
-        Guo<false,type::Pressure,orientation::Right>(outlet, Micro, 0);
-        CollideStreamBGK_Smagorinsky<false>(Macro, Micro, save, 0);
-        BounceBackHalfway<false>(wall, Micro, 0);
+        {
+            PROFILE_PHASE("guo");
+            Guo<false,type::Velocity,orientation::Left>(inlet,  Moments);
+            Guo<false,type::Pressure,orientation::Right>(outlet, Moments);
+        }
+        {
+            PROFILE_PHASE("collision");
+            CollideStreamMoments<false>(Macro, Moments, fluid);
+        }
 
         // odd time step
-        Guo<true,type::Velocity,orientation::Left>(inlet, Micro, 0);
-        Guo<true,type::Pressure,orientation::Right>(outlet, Micro, 0);
-        CollideStreamBGK_Smagorinsky<true>(Macro, Micro, save, 0);
-        BounceBackHalfway<true>(wall, Micro, 0);
+        {
+            PROFILE_PHASE("guo");
+            Guo<true,type::Velocity,orientation::Left>(inlet,  Moments);
+            Guo<true,type::Pressure,orientation::Right>(outlet, Moments);
+        }
+        {
+            PROFILE_PHASE("collision");
+            Steps.Dispatch(i, [&](auto const isDue)
+            {
+                CollideStreamMoments<true,decltype(isDue)::value>(Macro, Moments, fluid);
+            });
+        }
 
-        if ((save == true) && (i % (NT/10) == 0))
+        if (Steps.IsDue(exportStep, i) == true)
         {
+            PROFILE_PHASE("export");
             StatusOutput(i, NT);
+
+            // the boundary elements hold the values imposed by the Guo boundaries (read in the odd time step)
+            auto const imposed = [&](std::vector<boundaryElement<F_TYPE>> const& boundary)
+            {
+                for(boundaryElement<F_TYPE> const& b: boundary)
+                {
+                    F_TYPE m[Moments.NM_];
+                    Moments.template Load<true>(b.x, b.y, b.z, m);
+                    for(unsigned int d = 0; d < Macro.NM_; ++d)
+                    {
+                        Macro(b.x, b.y, b.z, d) = m[d];
+                    }
+                }
+            };
+            imposed(inlet);
+            imposed(outlet);
             Macro.SetZero(wall);
-            //Macro.Export("step",i);
-            Macro.ExportVtk(i);
+            Writer.Submit(Macro, i);
         }
     }
 
     Stopwatch.Stop();
+    PerformanceOutput(Macro, Moments, NT, NT, Stopwatch.GetRuntime());
+    std::cout << "Export stalled the solver for " << Writer.GetStallTime() << " s." << std::endl;
+    Writer.Finish();
+    PROFILE_SUMMARY();
+    PROFILE_TRACE(OUTPUT_PROFILE_PATH + "/trace.json");
 
-    PerformanceOutput(Macro, Micro, NT, NT, Stopwatch.GetRuntime());
+    return EXIT_SUCCESS;
+}
+#endif
 
-    /// final export -------------------------------------------------------------------------------
-    /*Macro.SetZero(wall);
-    Macro.Export("step",NT);
-    Macro.ExportVtk(NT);
-    Macro.ExportScalarVtk(0,"rho",NT);*/
+#if !defined(USE_MPI) && !defined(USE_GPU) && !defined(USE_REFINEMENT) && !defined(USE_SCALAR) && !defined(USE_ENSEMBLE) && !defined(USE_MOMENTS)
+/**\fn        RuntimeSimulation
+ * \brief     Flow around a cylinder in a channel on a domain that is not in the registry: BGK collision on
+ *            populations whose strides are run-time values (see population_runtime.hpp), the A-A pattern
+ *            and separate Guo and bounce-back boundaries. Slower than the compiled domains, meant for trying
+ *            out a resolution before adding it to the registry.
+ *
+ * \tparam    DdQq       static lattice::DdQq class containing discretisation parameters
+ * \param[in] settings   settings of the simulation read at run time
+ * \return    Return exit success or failure
+*/
+template <class DdQq>
+int RuntimeSimulation(simulationSettings const& settings)
+{
+    /// solver settings ---------------------------------------------------------------------------
+    typedef typename std::remove_const<decltype(DdQq::CS)>::type F_TYPE;
+
+    unsigned int const NX = settings.nx;
+    unsigned int const NY = settings.ny;
+    unsigned int const NZ = settings.nz;
+    unsigned int const NT = settings.nt;
+
+    F_TYPE       const Re = settings.re;
+    F_TYPE       const  U = settings.u;
+    unsigned int const  L = settings.l;
+
+    constexpr F_TYPE RHO_0 = 1.0;
+    F_TYPE const       U_0 = U;
+    constexpr F_TYPE   V_0 = 0.0;
+    constexpr F_TYPE   W_0 = 0.0;
+
+    // save values to disk every NT/10 time steps (synchronously, raw *.bin-files or *.vtk-files)
+    bool const save = settings.save;
+    unsigned int const NT_PLOT = (save == true) ? std::max(NT/10, 2u) : NT;
+    bool const isBin = (settings.format == "bin");
+
+    if (settings.geometry != "cylinder")
+    {
+        std::cerr << "Fatal error: The generic solver with run-time strides is only available for the cylinder." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::cerr << "Warning: The generic solver only supports BGK collision on the A-A pattern with the full export, "
+              << "time loop, autotuning, checkpoints, reduced or *.vti-export, monitors and probes ignored." << std::endl;
+
+    /// set up microscopic and macroscopic arrays --------------------------------------------------
+    RuntimeContinuum<F_TYPE> Macro(NX, NY, NZ);
+    RuntimePopulation<DdQq> Micro(NX, NY, NZ, Re, U, L);
+    InitialOutput(Micro, NT, Re, RHO_0, U, L);
+
+    /// define boundary conditions -----------------------------------------------------------------
+    alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> wall;
+    alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> inlet;
+    alignas(CACHE_LINE) std::vector<boundaryElement<F_TYPE>> outlet;
+
+    unsigned int const radius = L/2;
+    std::array<unsigned int,3> const position = {NX/4, NY/2, NZ/2};
+    Cylinder3D(NX, NY, NZ, radius, position, "x", true, wall, inlet, outlet, RHO_0, U_0, V_0, W_0);
+
+    /// initial conditions -------------------------------------------------------------------------
+    InitContinuum(Macro, RHO_0, U_0, V_0, W_0);
+    InitLattice<false>(Macro, Micro);
+
+    /// main loop ----------------------------------------------------------------------------------
+    std::cout << "Simulation started..." << std::endl;
+
+    Timer Stopwatch;
+    Stopwatch.Start();
+
+    for (size_t i = 0; i < NT; i+=2)
+    {
+        bool const isExport = (save == true) && (i % NT_PLOT == 0);
+
+        // even time step
+        Guo<false,type::Velocity,orientation::Left>(inlet,  Micro);
+        Guo<false,type::Pressure,orientation::Right>(outlet, Micro);
+        CollideStreamBGK<false>(Macro, Micro);
+        BounceBackHalfway<false>(wall, Micro);
+
+        // odd time step
+        Guo<true,type::Velocity,orientation::Left>(inlet,  Micro);
+        Guo<true,type::Pressure,orientation::Right>(outlet, Micro);
+        if (isExport == true)
+        {
+            CollideStreamBGK<true,true>(Macro, Micro);
+        }
+        else
+        {
+            CollideStreamBGK<true>(Macro, Micro);
+        }
+        BounceBackHalfway<true>(wall, Micro);
+
+        if (isExport == true)
+        {
+            StatusOutput(i, NT);
+            Macro.SetZero(wall);
+            if (isBin == true)
+            {
+                Macro.Export("step", i);
+            }
+            else
+            {
+                Macro.ExportVtk(i, "step");
+            }
+        }
+    }
+
+    Stopwatch.Stop();
+    PerformanceOutput(Macro, Micro, NT, NT_PLOT, Stopwatch.GetRuntime());
 
     return EXIT_SUCCESS;
 }
+#endif
+
+int main(int argc, char** argv)
+{
+    /// set up MPI ---------------------------------------------------------------------------------
+    #ifdef USE_MPI
+        Distribution MPI(argc, argv);
+        bool const isRoot = MPI.IsRoot();
+    #else
+        bool const isRoot = true;
+    #endif
+
+    /// set up OpenMP ------------------------------------------------------------------------------
+    #ifdef _OPENMP
+        Parallelism& OpenMP = GetParallelism();
+        //OpenMP.SetThreadsNum(1);
+        OpenMP.SetAffinity(Affinity::Close);
+    #endif
+
+    /// compiled domains ---------------------------------------------------------------------------
+    // floating point accuracy
+    typedef double F_TYPE;
+
+    // spatial resolutions and lattices the simulation is compiled for: the settings select one of them at startup
+    typedef DomainRegistry<compiledDomain< 96, 48, 48,lattice::D3Q27<F_TYPE>>,
+                           compiledDomain<192, 96, 96,lattice::D3Q27<F_TYPE>>,
+                           compiledDomain<384,192,192,lattice::D3Q27<F_TYPE>>,
+                           compiledDomain<192, 96, 96,lattice::D3Q19<F_TYPE>>> Domains;
+
+    /// print disclaimer ---------------------------------------------------------------------------
+    bool convert = false;
+    int  first   = 1; // first command line argument holding settings
+    if (argc > 1)
+    {
+        if ((strcmp(argv[1], "--version") == 0) || (strcmp(argv[1], "--v") == 0))
+        {
+            PrintDisclaimer();
+            Domains::Output(std::cout);
+            exit(EXIT_SUCCESS);
+        }
+        else if (strcmp(argv[1], "--convert") == 0)
+        {
+            convert = true;
+            first = ((argc > 2) && (strncmp(argv[2], "--", 2) != 0)) ? 3 : 2;
+        }
+        else if ((strcmp(argv[1], "--info") == 0) || (strcmp(argv[1], "--help") == 0))
+        {
+            std::cerr << "Usage: '--convert' [vtk|vti|vtz] Convert *.bin/*.lbz files to *.vtk, *.vti or compressed *.vti" << std::endl;
+            std::cerr << "       '--input'   file          Read the settings from an input file ('key = value' per line)" << std::endl;
+            std::cerr << "       '--<key>'   value         Override a setting (nx, ny, nz, lattice, nt, re, u, l, save, geometry," << std::endl;
+            std::cerr << "                                 format, region, stride, precision, compression, tolerance, autotune," << std::endl;
+            std::cerr << "                                 timeloop, schmidt, ensemble, checkpoint-every, restart)" << std::endl;
+            std::cerr << "       '--help'    or '--info'   Show help"                                          << std::endl;
+            std::cerr << "       '--version' or '--v'      Show build version"                                 << std::endl;
+            Domains::Output(std::cerr);
+            exit(EXIT_SUCCESS);
+        }
+    }
+
+    /// settings of the simulation -----------------------------------------------------------------
+    simulationSettings const settings = ParseSettings(argc, argv, first);
+
+    // convert exported binary files of the global domain
+    if (convert == true)
+    {
+        if (isRoot == true)
+        {
+            bool const isVti = (first == 3) && ((strcmp(argv[2], "vti") == 0) || (strcmp(argv[2], "vtz") == 0));
+            bool const isCompressed = (first == 3) && (strcmp(argv[2], "vtz") == 0);
+            return Domains::Dispatch(settings, [isVti, isCompressed](auto const domain)
+            {
+                typedef decltype(domain) D;
+                size_t const numberOfFiles = ConvertBinaries<D::nx,D::ny,D::nz,F_TYPE>((isVti == true) ? ExportFormat::Vti : ExportFormat::Vtk, isCompressed);
+                std::cout << "Converted " << numberOfFiles << " files." << std::endl;
+                return EXIT_SUCCESS;
+            });
+        }
+        return EXIT_SUCCESS;
+    }
+
+    /// simulation on the compiled domain matching the settings ------------------------------------
+    auto const simulation = [&](auto const domain)
+    {
+        typedef decltype(domain) D;
+        #if defined(USE_MPI)
+            return Simulation<D::nx,D::ny,D::nz,typename D::lattice>(settings, MPI);
+        #elif defined(USE_MOMENTS)
+            return MomentSimulation<D::nx,D::ny,D::nz,typename D::lattice>(settings);
+        #else
+            return Simulation<D::nx,D::ny,D::nz,typename D::lattice>(settings);
+        #endif
+    };
+
+    // domains that are not registered fall back to the generic solver with run-time strides (single host only)
+    #if defined(USE_MPI) || defined(USE_GPU) || defined(USE_REFINEMENT) || defined(USE_SCALAR) || defined(USE_ENSEMBLE) || defined(USE_MOMENTS)
+        return Domains::Dispatch(settings, simulation);
+    #else
+        return Domains::Dispatch(settings, simulation, [&settings]()
+        {
+            if (settings.speeds == 19)
+            {
+                return RuntimeSimulation<lattice::D3Q19<F_TYPE>>(settings);
+            }
+            return RuntimeSimulation<lattice::D3Q27<F_TYPE>>(settings);
+        });
+    #endif
+}
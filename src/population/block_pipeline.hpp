@@ -0,0 +1,341 @@
+#ifndef BLOCK_PIPELINE_HPP_INCLUDED
+#define BLOCK_PIPELINE_HPP_INCLUDED
+
+/**
+ * \file     block_pipeline.hpp
+ * \mainpage Persistent thread team advancing many time steps with point-to-point dependencies between blocks
+ *
+ * \note     Every collision sweep in its own parallel region forks and joins the team and ends with a
+ *           global barrier, which on small domains and in ensemble runs is a visible share of the runtime
+ *           and lets every thread wait for the slowest one in each time step. With the A-A pattern and the
+ *           esoteric pull a cell only accesses its direct neighbours, therefore time step t + 1 of a loop
+ *           block only has to wait until the block itself and its (periodic) neighbouring blocks have
+ *           completed time step t. The pipeline keeps a single parallel region alive for a whole sequence
+ *           of time steps: every thread collides its own blocks (block % threads, the mapping of the first
+ *           touch) step after step, publishes the number of completed steps of every block and only waits
+ *           for the neighbours of the block it collides next, so threads run ahead of slower threads that
+ *           are not their neighbours. A neighbour can never be more than one step ahead or behind, which
+ *           also rules out that a block overwrites populations a neighbour still has to read.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <stdlib.h>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../general/cpu_dispatch.hpp"
+#include "../general/instrumentation.hpp"
+#include "../general/memory_alignment.hpp"
+#include "boundary/boundary_bounceback.hpp"
+#include "fluid_cells.hpp"
+#include "population.hpp"
+
+
+/// number of polls of a neighbour before the waiting thread yields its processor
+constexpr unsigned int PIPELINE_SPIN = 1024;
+
+
+/**\class  BlockPipeline
+ * \brief  Class holding the neighbouring blocks of all loop blocks of a fluid cell list and the number of
+ *         completed time steps of every block for advancing a sequence of time steps in a single
+ *         parallel region
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+class BlockPipeline
+{
+    public:
+        /// the fluid cell list whose blocks are advanced
+        FluidCells<NX,NY,NZ> const& fluid_;
+
+        /// neighbouring blocks (including the block itself) of all blocks and the index of the first one of every block
+        std::vector<unsigned int> neighbours_;
+        std::vector<size_t>       offsets_;
+
+
+        /**\brief Class constructor
+         * \param fluid   fluid cell list of the full domain
+        */
+        BlockPipeline(FluidCells<NX,NY,NZ> const& fluid);
+
+        /// advance an even number of time steps starting with an even step
+        template <class LT, unsigned int NPOP, class LY, class ST, class SP, class NODE, class... BC>
+        void Advance(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, NODE const& node, size_t const steps, unsigned int const p,
+                     BC const&... boundaries);
+
+        /// access functions
+        inline size_t GetNumberOfCells() const;
+        inline size_t GetMemorySize() const;
+
+    private:
+        /**\struct counter
+         * \brief  Number of completed time steps of a block on a cache line of its own
+        */
+        struct alignas(CACHE_LINE) counter
+        {
+            std::atomic<size_t> steps;
+        };
+        std::vector<counter> progress_;
+
+        inline void Wait(unsigned int const block, size_t const step) const;
+
+        template <bool odd, bool isLast, class LT, unsigned int NPOP, class LY, class ST, class SP, class NODE, class... BC>
+        inline void CollideBlock(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, NODE const& node, unsigned int const block,
+                                 unsigned int const p, std::tuple<BC const&...> const& fused) const;
+        template <class LT, unsigned int NPOP, class LY, class ST, class SP, class NODE, class... BC>
+        inline void CollideBlock(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, NODE const& node, unsigned int const block,
+                                 bool const isOdd, bool const isLast, unsigned int const p, std::tuple<BC const&...> const& fused) const;
+};
+
+
+/**\fn        BlockPipeline
+ * \brief     Determine the neighbouring blocks of every block of a fluid cell list of the full domain: the
+ *            blocks of the 3x3x3 neighbourhood in the block grid with periodic wrap-around
+ *
+ * \param[in] fluid   fluid cell list of the full domain
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+BlockPipeline<NX,NY,NZ>::BlockPipeline(FluidCells<NX,NY,NZ> const& fluid):
+    fluid_(fluid), neighbours_(), offsets_(fluid.NUM_BLOCKS_ + 1, 0), progress_(fluid.NUM_BLOCKS_)
+{
+    if ((fluid.Z_MIN_ != 0) || (fluid.Z_MAX_ != NZ))
+    {
+        std::cerr << "Fatal error: Block pipeline requires a fluid cell list of the full domain." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned int const NBX = fluid.NUM_BLOCKS_X_;
+    unsigned int const NBY = fluid.NUM_BLOCKS_Y_;
+    unsigned int const NBZ = fluid.NUM_BLOCKS_Z_;
+
+    std::vector<unsigned int> around;
+    for(unsigned int block = 0; block < fluid.NUM_BLOCKS_; ++block)
+    {
+        unsigned int const bx = block % NBX;
+        unsigned int const by = (block / NBX) % NBY;
+        unsigned int const bz = block / (NBX*NBY);
+
+        around.clear();
+        for(unsigned int dz = 0; dz <= 2; ++dz)
+        {
+            for(unsigned int dy = 0; dy <= 2; ++dy)
+            {
+                for(unsigned int dx = 0; dx <= 2; ++dx)
+                {
+                    around.push_back(((bz + NBZ + dz - 1) % NBZ)*NBX*NBY + ((by + NBY + dy - 1) % NBY)*NBX + (bx + NBX + dx - 1) % NBX);
+                }
+            }
+        }
+        std::sort(around.begin(), around.end());
+        around.erase(std::unique(around.begin(), around.end()), around.end());
+
+        neighbours_.insert(neighbours_.end(), around.begin(), around.end());
+        offsets_[block + 1] = neighbours_.size();
+    }
+
+    for(unsigned int block = 0; block < fluid.NUM_BLOCKS_; ++block)
+    {
+        progress_[block].steps.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**\fn        Wait
+ * \brief     Wait until the block and all its neighbouring blocks have completed a given number of time steps
+ *
+ * \param[in] block   the block that should be collided next
+ * \param[in] step    number of time steps that have to be completed
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline void BlockPipeline<NX,NY,NZ>::Wait(unsigned int const block, size_t const step) const
+{
+    for(size_t i = offsets_[block]; i < offsets_[block + 1]; ++i)
+    {
+        unsigned int spin = 0;
+        while (progress_[neighbours_[i]].steps.load(std::memory_order_acquire) < step)
+        {
+            if (++spin > PIPELINE_SPIN)
+            {
+                std::this_thread::yield();
+            }
+            #if defined(__x86_64__) || defined(__i386__)
+            else
+            {
+                __builtin_ia32_pause();
+            }
+            #endif
+        }
+    }
+}
+
+/**\fn        CollideBlock
+ * \brief     Apply the fused boundaries of a block, collide all its fluid cells and apply the fused bounce-back
+ *
+ * \tparam    odd      even (0, false) or odd (1, true) time step
+ * \tparam    isLast   last time step of the sequence (Boolean true/false)
+ * \tparam    LT       static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP     number of populations stored side by side in the lattice
+ * \tparam    LY       memory layout policy of the populations
+ * \tparam    ST       storage policy of the populations
+ * \tparam    SP       streaming policy of the populations
+ * \tparam    NODE     collision operator for a single cell (see Advance)
+ * \tparam    BC       types of the fused boundaries (e.g. FusedGuo)
+ * \param[out] pop     population object holding microscopic variables
+ * \param[in] node     collision operator for a single cell
+ * \param[in] block    the block of interest
+ * \param[in] p        relevant population
+ * \param[in] fused    tuple holding references to all fused boundaries
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+template <bool odd, bool isLast, class LT, unsigned int NPOP, class LY, class ST, class SP, class NODE, class... BC>
+inline void BlockPipeline<NX,NY,NZ>::CollideBlock(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, NODE const& node, unsigned int const block,
+                                                  unsigned int const p, std::tuple<BC const&...> const& fused) const
+{
+    PROFILE_WORK();
+
+    ApplyBlockBoundaries<odd>(fused, pop, block, p);
+
+    DispatchIsa([&](auto const)
+    {
+        for(size_t i = fluid_.BlockBegin(block); i < fluid_.BlockEnd(block); ++i)
+        {
+            fluidCell const& cell = fluid_.cells_[i];
+            node(std::integral_constant<bool,odd>(), cell, std::integral_constant<bool,isLast>());
+            BounceBackLinks<odd>(cell, pop, p);
+        }
+    });
+}
+
+/**\fn        CollideBlock
+ * \brief     Dispatch the collision of a block to the variant for an even or odd and for the last or an
+ *            intermediate time step of the sequence
+ *
+ * \param[out] pop     population object holding microscopic variables
+ * \param[in] node     collision operator for a single cell
+ * \param[in] block    the block of interest
+ * \param[in] isOdd    odd time step (Boolean true/false)
+ * \param[in] isLast   last time step of the sequence (Boolean true/false)
+ * \param[in] p        relevant population
+ * \param[in] fused    tuple holding references to all fused boundaries
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+template <class LT, unsigned int NPOP, class LY, class ST, class SP, class NODE, class... BC>
+inline void BlockPipeline<NX,NY,NZ>::CollideBlock(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, NODE const& node, unsigned int const block,
+                                                  bool const isOdd, bool const isLast, unsigned int const p,
+                                                  std::tuple<BC const&...> const& fused) const
+{
+    if (isOdd == true)
+    {
+        if (isLast == true)
+        {
+            CollideBlock<true,true>(pop, node, block, p, fused);
+        }
+        else
+        {
+            CollideBlock<true,false>(pop, node, block, p, fused);
+        }
+    }
+    else
+    {
+        CollideBlock<false,false>(pop, node, block, p, fused);
+    }
+}
+
+/**\fn        Advance
+ * \brief     Advance an even number of consecutive time steps starting with an even time step in a single
+ *            parallel region. Every thread collides the blocks block % threads in every time step and
+ *            before each block only waits for the block and its neighbours to complete the previous step.
+ * \warning   All boundaries must be fused with the fluid cell list of the pipeline.
+ *
+ * \tparam    LT           static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP         number of populations stored side by side in the lattice
+ * \tparam    LY           memory layout policy of the populations
+ * \tparam    ST           storage policy of the populations
+ * \tparam    SP           streaming policy of the populations
+ * \tparam    NODE         collision operator for a single cell: callable with (std::integral_constant<bool,odd>,
+ *                         fluidCell const&, std::integral_constant<bool,isLast>) that collides the cell
+ * \tparam    BC           types of the fused boundaries (e.g. FusedGuo)
+ * \param[out] pop         population object holding microscopic variables
+ * \param[in] node         collision operator for a single cell
+ * \param[in] steps        number of time steps (even)
+ * \param[in] p            relevant population
+ * \param[in] boundaries   boundaries fused with the collision of the blocks
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ> template <class LT, unsigned int NPOP, class LY, class ST, class SP, class NODE, class... BC>
+void BlockPipeline<NX,NY,NZ>::Advance(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, NODE const& node, size_t const steps, unsigned int const p,
+                                      BC const&... boundaries)
+{
+    if ((steps == 0) || (steps % 2 != 0))
+    {
+        std::cerr << "Fatal error: Block pipeline requires an even number of time steps (" << steps << ")." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if ((boundaries.unfused_.empty() && ... && true) == false)
+    {
+        std::cerr << "Fatal error: Boundary elements that can not be applied within a block of the pipeline." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::tuple<BC const&...> const fused(boundaries...);
+    unsigned int const NUM_BLOCKS = fluid_.NUM_BLOCKS_;
+
+    for(unsigned int block = 0; block < NUM_BLOCKS; ++block)
+    {
+        progress_[block].steps.store(0, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    #pragma omp parallel default(none) shared(pop, node, fused) firstprivate(p, steps, NUM_BLOCKS)
+    {
+        #ifdef _OPENMP
+        unsigned int const thread  = static_cast<unsigned int>(omp_get_thread_num());
+        unsigned int const threads = static_cast<unsigned int>(omp_get_num_threads());
+        #else
+        unsigned int const thread  = 0;
+        unsigned int const threads = 1;
+        #endif
+
+        for(size_t step = 0; step < steps; ++step)
+        {
+            for(unsigned int block = thread; block < NUM_BLOCKS; block += threads)
+            {
+                Wait(block, step);
+                CollideBlock(pop, node, block, step % 2 != 0, step + 1 == steps, p, fused);
+                progress_[block].steps.store(step + 1, std::memory_order_release);
+            }
+        }
+    }
+}
+
+/**\fn     GetNumberOfCells
+ * \brief  Total number of fluid cells
+ *
+ * \return number of fluid cells
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t BlockPipeline<NX,NY,NZ>::GetNumberOfCells() const
+{
+    return fluid_.GetNumberOfCells();
+}
+
+/**\fn     GetMemorySize
+ * \brief  Memory occupied by the neighbouring blocks and the progress counters
+ *
+ * \return memory in bytes
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t BlockPipeline<NX,NY,NZ>::GetMemorySize() const
+{
+    return neighbours_.size()*sizeof(unsigned int) + offsets_.size()*sizeof(size_t) + progress_.size()*sizeof(counter);
+}
+
+#endif // BLOCK_PIPELINE_HPP_INCLUDED
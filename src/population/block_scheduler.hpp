@@ -0,0 +1,277 @@
+#ifndef BLOCK_SCHEDULER_HPP_INCLUDED
+#define BLOCK_SCHEDULER_HPP_INCLUDED
+
+/**
+ * \file     block_scheduler.hpp
+ * \mainpage Locality-preserving work-stealing scheduler for the loop blocks of a fluid cell list
+ *
+ * \note     With obstacles and porous media the loop blocks hold very different numbers of fluid and
+ *           boundary cells so that a static distribution of the blocks leaves some threads idle at the
+ *           barrier at the end of the collision sweep. Every thread keeps the blocks it touched first
+ *           (block % threads, see Population::FirstTouch) in a queue of its own sorted along a Morton
+ *           curve so that consecutive blocks are neighbours in space. Once its queue is empty a thread
+ *           steals blocks from the back of the queue with the largest remaining cost, preferring the
+ *           closest threads (with pinned threads on the same NUMA node) for equal cost. The cost of a
+ *           block is estimated from its number of fluid cells and boundary cells.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../general/memory_alignment.hpp"
+#include "fluid_cells.hpp"
+
+
+/**\fn        MortonCode
+ * \brief     Position of a block along a Morton (z-order) curve by interleaving the bits of its coordinates
+ *
+ * \param[in] x   block coordinate in x-direction (at most 10 bit)
+ * \param[in] y   block coordinate in y-direction (at most 10 bit)
+ * \param[in] z   block coordinate in z-direction (at most 10 bit)
+ * \return    Morton code of the block
+*/
+inline uint32_t MortonCode(uint32_t const x, uint32_t const y, uint32_t const z)
+{
+    uint32_t code = 0;
+    for(unsigned int i = 0; i < 10; ++i)
+    {
+        code |= (((x >> i) & 1u) << (3*i)) | (((y >> i) & 1u) << (3*i + 1)) | (((z >> i) & 1u) << (3*i + 2));
+    }
+    return code;
+}
+
+
+/**\class  BlockScheduler
+ * \brief  Work-stealing scheduler distributing the loop blocks of a fluid cell list to the threads
+ *         of a parallel region
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+class BlockScheduler
+{
+    public:
+        /// number of threads the blocks were distributed to
+        unsigned int const THREADS_;
+
+        /// blocks of all threads (Morton order within every thread), index of first block of every thread
+        std::vector<unsigned int> blocks_;
+        std::vector<size_t>       offsets_;
+
+        /// accumulated cost in the order of blocks_ (cost of blocks_[i] = cost_[i+1] - cost_[i])
+        std::vector<size_t>       cost_;
+
+
+        /**\brief Class constructor
+         * \param fluid        fluid cell list whose blocks should be scheduled
+         * \param boundaries   fused boundaries of the fluid cell list (e.g. FusedGuo, optional)
+        */
+        template <class... BC>
+        BlockScheduler(FluidCells<NX,NY,NZ> const& fluid, BC const&... boundaries);
+
+        /// reset all queues before each sweep (outside of the parallel region)
+        inline void Reset();
+
+        /// next block of the calling thread
+        inline bool Next(unsigned int& block);
+
+        /// access functions
+        inline size_t GetCost(unsigned int const thread) const;
+
+    private:
+        /**\struct queue
+         * \brief  Range [begin, end) of the remaining blocks of a thread packed into a single word so that
+         *         owner (front) and thieves (back) can take blocks with a single compare-and-swap
+        */
+        struct alignas(CACHE_LINE) queue
+        {
+            std::atomic<uint64_t> range;
+        };
+        std::vector<queue> queues_;
+
+        inline bool Take(unsigned int const thread, bool const isBack, unsigned int& block);
+};
+
+
+/**\fn        BlockScheduler
+ * \brief     Estimate the cost of every block, distribute the blocks to the threads with the same
+ *            mapping as the first touch and sort the blocks of every thread along a Morton curve.
+ *            The cost of a block is the number of its fluid cells plus the number of its boundary cells
+ *            (fluid cells with links towards solid cells and fused boundary elements).
+ * \warning   The fused boundaries have to be fused with the same fluid cell list.
+ *
+ * \tparam    BC           types of the fused boundaries (e.g. FusedGuo)
+ * \param[in] fluid        fluid cell list whose blocks should be scheduled
+ * \param[in] boundaries   fused boundaries of the fluid cell list
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ> template <class... BC>
+BlockScheduler<NX,NY,NZ>::BlockScheduler(FluidCells<NX,NY,NZ> const& fluid, BC const&... boundaries):
+    #ifdef _OPENMP
+    THREADS_(static_cast<unsigned int>(omp_get_max_threads())),
+    #else
+    THREADS_(1),
+    #endif
+    blocks_(), offsets_(THREADS_ + 1, 0), cost_(), queues_(THREADS_)
+{
+    /// cost estimation
+    std::vector<size_t> cost(fluid.NUM_BLOCKS_, 0);
+    for(unsigned int block = 0; block < fluid.NUM_BLOCKS_; ++block)
+    {
+        cost[block] = fluid.BlockEnd(block) - fluid.BlockBegin(block);
+        for(size_t i = fluid.BlockBegin(block); i < fluid.BlockEnd(block); ++i)
+        {
+            cost[block] += (fluid.cells_[i].solid != 0);
+        }
+        cost[block] += ((boundaries.blocks_[block + 1] - boundaries.blocks_[block]) + ... + 0);
+    }
+
+    /// blocks of every thread along a Morton curve
+    std::vector<uint32_t> code(fluid.NUM_BLOCKS_);
+    for(unsigned int block = 0; block < fluid.NUM_BLOCKS_; ++block)
+    {
+        code[block] = MortonCode(block % fluid.NUM_BLOCKS_X_, (block / fluid.NUM_BLOCKS_X_) % fluid.NUM_BLOCKS_Y_,
+                                 block / (fluid.NUM_BLOCKS_X_*fluid.NUM_BLOCKS_Y_));
+    }
+
+    blocks_.reserve(fluid.NUM_BLOCKS_);
+    cost_.reserve(fluid.NUM_BLOCKS_ + 1);
+    cost_.push_back(0);
+    for(unsigned int thread = 0; thread < THREADS_; ++thread)
+    {
+        offsets_[thread] = blocks_.size();
+        for(unsigned int block = thread; block < fluid.NUM_BLOCKS_; block += THREADS_)
+        {
+            blocks_.push_back(block);
+        }
+        std::sort(blocks_.begin() + offsets_[thread], blocks_.end(), [&code](unsigned int const a, unsigned int const b) { return code[a] < code[b]; });
+
+        for(size_t i = offsets_[thread]; i < blocks_.size(); ++i)
+        {
+            cost_.push_back(cost_.back() + cost[blocks_[i]]);
+        }
+    }
+    offsets_[THREADS_] = blocks_.size();
+
+    Reset();
+}
+
+/**\fn        Reset
+ * \brief     Refill the queues of all threads with their own blocks. Has to be called before every
+ *            sweep outside of the parallel region.
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline void BlockScheduler<NX,NY,NZ>::Reset()
+{
+    for(unsigned int thread = 0; thread < THREADS_; ++thread)
+    {
+        queues_[thread].range.store((static_cast<uint64_t>(offsets_[thread]) << 32) | offsets_[thread + 1], std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+/**\fn         Take
+ * \brief      Take a single block from the front (owner) or the back (thief) of the queue of a thread
+ *
+ * \param[in]  thread   thread that owns the queue
+ * \param[in]  isBack   take the block from the back of the queue (Boolean true/false)
+ * \param[out] block    the block taken from the queue
+ * \return     Boolean true if a block was taken, false if the queue was empty
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline bool BlockScheduler<NX,NY,NZ>::Take(unsigned int const thread, bool const isBack, unsigned int& block)
+{
+    std::atomic<uint64_t>& range = queues_[thread].range;
+    uint64_t current = range.load(std::memory_order_acquire);
+
+    while (true)
+    {
+        uint64_t const begin = current >> 32;
+        uint64_t const   end = current & 0xFFFFFFFFu;
+        if (begin >= end)
+        {
+            return false;
+        }
+
+        uint64_t const next = (isBack == true) ? ((begin << 32) | (end - 1)) : (((begin + 1) << 32) | end);
+        if (range.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire) == true)
+        {
+            block = blocks_[(isBack == true) ? end - 1 : begin];
+            return true;
+        }
+    }
+}
+
+/**\fn         Next
+ * \brief      Next block of the calling thread: its own blocks in Morton order followed by blocks stolen from
+ *             the back of the queue with the largest remaining cost (closest thread for equal cost)
+ *
+ * \param[out] block   the block that should be processed next
+ * \return     Boolean true if a block was assigned, false if all blocks have been processed
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline bool BlockScheduler<NX,NY,NZ>::Next(unsigned int& block)
+{
+    #ifdef _OPENMP
+    unsigned int const thread = static_cast<unsigned int>(omp_get_thread_num());
+    #else
+    unsigned int const thread = 0;
+    #endif
+
+    if ((thread < THREADS_) && (Take(thread, false, block) == true))
+    {
+        return true;
+    }
+
+    while (true)
+    {
+        unsigned int victim = THREADS_;
+        size_t maxCost = 0;
+        for(unsigned int distance = 1; distance <= THREADS_; ++distance)
+        {
+            for(unsigned int side = 0; side <= 1; ++side)
+            {
+                unsigned int const candidate = (side == 0) ? (thread + distance) % THREADS_ :
+                                                             (thread % THREADS_ + THREADS_ - distance % THREADS_) % THREADS_;
+                size_t const cost = GetCost(candidate);
+                if (cost > maxCost)
+                {
+                    maxCost = cost;
+                    victim  = candidate;
+                }
+            }
+        }
+
+        if (victim == THREADS_)
+        {
+            return false;
+        }
+        if (Take(victim, true, block) == true)
+        {
+            return true;
+        }
+    }
+}
+
+/**\fn        GetCost
+ * \brief     Estimated cost of the remaining blocks in the queue of a thread
+ *
+ * \param[in] thread   the thread of interest
+ * \return    remaining cost (fluid and boundary cells)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t BlockScheduler<NX,NY,NZ>::GetCost(unsigned int const thread) const
+{
+    uint64_t const current = queues_[thread].range.load(std::memory_order_acquire);
+    uint64_t const begin = current >> 32;
+    uint64_t const   end = current & 0xFFFFFFFFu;
+    return (begin < end) ? cost_[end] - cost_[begin] : 0;
+}
+
+#endif // BLOCK_SCHEDULER_HPP_INCLUDED
@@ -11,6 +11,7 @@
 #endif
 
 #include "boundary.hpp"
+#include "../fluid_cells.hpp"
 #include "../population.hpp"
 
 
@@ -27,13 +28,17 @@
  * \tparam     NY     simulation domain resolution in y-direction
  * \tparam     NZ     simulation domain resolution in z-direction
  * \tparam     LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP   number of populations stored side by side in the lattice
+ * \tparam     LY     memory layout policy of the populations
+ * \tparam     ST     storage policy of the populations
+ * \tparam     SP     streaming policy of the populations
  * \tparam     T      floating data type used for simulation
  * \param[in]  wall   vector holding all corresponding boundary condition elements
  * \param[out] pop    population object holding microscopic variables
  * \param[in]  p      relevant population (default = 0)
 */
-template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void BounceBackHalfway(std::vector<boundaryElement<T>> const& wall, Population<NX,NY,NZ,LT>& pop, unsigned int const p = 0)
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void BounceBackHalfway(std::vector<boundaryElement<T>> const& wall, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const p = 0)
 {
     #pragma omp parallel for default(none) shared(wall,pop,p) schedule(static,32)
     for(size_t i = 0; i < wall.size(); ++i)
@@ -45,10 +50,55 @@ void BounceBackHalfway(std::vector<boundaryElement<T>> const& wall, Population<N
         #pragma GCC unroll (2)
         for(unsigned int n = 0; n <= 1; ++n)
         {
+            /// opposite directions share the same lattice weight: stored values are copied without conversion
             #pragma GCC unroll (15)
             for(unsigned int d = 1; d < LT::HSPEED; ++d)
             {
-                pop.F_[pop. template AA_IndexWrite<odd>(x_n, y_n, z_n, !n, d, p)] = pop.F_[pop. template AA_IndexRead<!odd>(x_n, y_n, z_n, n, d, p)];
+                pop.F_[pop. template IndexWrite<odd>(x_n, y_n, z_n, !n, d, p)] = pop.F_[pop. template IndexRead<!odd>(x_n, y_n, z_n, n, d, p)];
+            }
+        }
+    }
+}
+
+/**\fn         BounceBackLinks
+ * \brief      Halfway bounce-back applied from the fluid side: the populations of a fluid cell that were
+ *             just streamed towards solid neighbours are reflected to the slots the cell reads them from
+ *             in the following time step. Called by the collision kernels directly after the collision of
+ *             the cell, this is equivalent to BounceBackHalfway over all wall cells after the collision.
+ * \warning    The populations written towards the solid cells are kept so that a subsequent
+ *             BounceBackHalfway (e.g. of the walls next to ghost layers after a halo exchange) yields
+ *             the same result.
+ *
+ * \tparam     odd    even (0, false) or odd (1, true) time step
+ * \tparam     NX     simulation domain resolution in x-direction
+ * \tparam     NY     simulation domain resolution in y-direction
+ * \tparam     NZ     simulation domain resolution in z-direction
+ * \tparam     LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP   number of populations stored side by side in the lattice
+ * \tparam     LY     memory layout policy of the populations
+ * \tparam     ST     storage policy of the populations
+ * \tparam     SP     streaming policy of the populations
+ * \param[in]  cell   collided fluid cell and the mask of its links towards solid neighbours
+ * \param[out] pop    population object holding microscopic variables
+ * \param[in]  p      relevant population (default = 0)
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+inline void BounceBackLinks(fluidCell const& cell, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const p = 0)
+{
+    if (cell.solid == 0)
+    {
+        return;
+    }
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (15)
+        for(unsigned int d = 1; d < LT::HSPEED; ++d)
+        {
+            if ((cell.solid >> (n*LT::OFF + d)) & 1u)
+            {
+                pop.F_[pop. template IndexRead<!odd>(cell.x_n, cell.y_n, cell.z_n, !n, d, p)] = pop.F_[pop. template IndexWrite<odd>(cell.x_n, cell.y_n, cell.z_n, n, d, p)];
             }
         }
     }
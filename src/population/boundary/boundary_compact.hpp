@@ -0,0 +1,418 @@
+#ifndef BOUNDARY_COMPACT_HPP_INCLUDED
+#define BOUNDARY_COMPACT_HPP_INCLUDED
+
+/**
+ * \file     boundary_compact.hpp
+ * \mainpage Pre-compiled boundary descriptors for boundaries applied in a separate pass
+ *
+ * \note     BounceBackHalfway and Guo derive the periodic neighbours and the linear population
+ *           indices of every element on every time step and store the macroscopic values with every
+ *           element. The descriptors in this file are built once for a given population object: they
+ *           hold the linear indices of both time steps as structure-of-arrays sorted by memory address
+ *           so that the boundary pass reduces to a streaming gather and scatter.
+ *           - CompactBounceBack: only the links of a wall cell pointing towards a non-solid cell
+ *                                are kept as pairs of source and destination index
+ *           - CompactGuo:        indices of the neighbouring and the boundary cell per population,
+ *                                the macroscopic values are shared by all elements unless they differ
+ *                                (e.g. a velocity profile), in which case they are stored per element
+ * \warning  The indices are only valid for populations with the same resolution, lattice, layout and
+ *           streaming pattern as the one the descriptor was built for.
+*/
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "boundary.hpp"
+#include "boundary_guo.hpp"
+#include "../population.hpp"
+
+
+/**\class  CompactBounceBack
+ * \brief  Halfway bounce-back of a list of wall cells as pairs of linear population indices
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+class CompactBounceBack
+{
+    public:
+        /// source and destination indices of all links for even (0) and odd (1) time steps sorted by source
+        std::vector<size_t> source_[2];
+        std::vector<size_t> destination_[2];
+
+
+        /**\brief Class constructor
+         * \param pop     population object the indices are computed for
+         * \param wall    vector holding all wall cells that should be bounced back
+         * \param solid   vector holding all solid cells (e.g. all wall boundary elements)
+         * \param p       relevant population (default = 0)
+        */
+        template <class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+        CompactBounceBack(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, std::vector<boundaryElement<T>> const& wall,
+                          std::vector<boundaryElement<T>> const& solid, unsigned int const p = 0);
+
+        /// access functions
+        inline size_t GetNumberOfLinks() const;
+        inline size_t GetMemorySize() const;
+
+    private:
+        template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+        void Compile(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, std::vector<boundaryElement<T>> const& wall,
+                     std::vector<bool> const& isSolid, unsigned int const p);
+};
+
+/**\fn        CompactBounceBack
+ * \brief     Collect the links of all wall cells towards non-solid neighbours for both time steps.
+ *            Links between two solid cells only carry populations that are never read by a fluid
+ *            cell and are dropped.
+ *
+ * \tparam    LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP    number of populations stored side by side in the lattice
+ * \tparam    LY      memory layout policy of the populations
+ * \tparam    ST      storage policy of the populations
+ * \tparam    SP      streaming policy of the populations
+ * \tparam    T       floating data type used for simulation
+ * \param[in] pop     population object the indices are computed for
+ * \param[in] wall    vector holding all wall cells that should be bounced back
+ * \param[in] solid   vector holding all solid cells (e.g. all wall boundary elements)
+ * \param[in] p       relevant population
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ> template <class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+CompactBounceBack<NX,NY,NZ>::CompactBounceBack(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, std::vector<boundaryElement<T>> const& wall,
+                                               std::vector<boundaryElement<T>> const& solid, unsigned int const p):
+    source_(), destination_()
+{
+    std::vector<bool> isSolid(static_cast<size_t>(NX)*NY*NZ, false);
+    for(size_t i = 0; i < solid.size(); ++i)
+    {
+        isSolid[(static_cast<size_t>(solid[i].z)*NY + solid[i].y)*NX + solid[i].x] = true;
+    }
+
+    Compile<false>(pop, wall, isSolid, p);
+    Compile<true>(pop, wall, isSolid, p);
+}
+
+/**\fn        Compile
+ * \brief     Collect the links of a single time step and sort them by their source index
+ *
+ * \tparam    odd       even (0, false) or odd (1, true) time step
+ * \param[in] pop       population object the indices are computed for
+ * \param[in] wall      vector holding all wall cells that should be bounced back
+ * \param[in] isSolid   solid cells of the full domain
+ * \param[in] p         relevant population
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ> template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void CompactBounceBack<NX,NY,NZ>::Compile(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, std::vector<boundaryElement<T>> const& wall,
+                                          std::vector<bool> const& isSolid, unsigned int const p)
+{
+    std::vector<std::pair<size_t,size_t>> links;
+    for(size_t i = 0; i < wall.size(); ++i)
+    {
+        unsigned int const x_n[3] = { (NX + wall[i].x - 1) % NX, wall[i].x, (wall[i].x + 1) % NX };
+        unsigned int const y_n[3] = { (NY + wall[i].y - 1) % NY, wall[i].y, (wall[i].y + 1) % NY };
+        unsigned int const z_n[3] = { (NZ + wall[i].z - 1) % NZ, wall[i].z, (wall[i].z + 1) % NZ };
+
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            for(unsigned int d = 1; d < LT::HSPEED; ++d)
+            {
+                /// the population arriving along (n,d) is reflected to the cell it came from
+                unsigned int const curr = (!n)*LT::OFF + d;
+                size_t const neighbour = (static_cast<size_t>(z_n[1 + static_cast<int>(LT::DZ[curr])])*NY +
+                                                              y_n[1 + static_cast<int>(LT::DY[curr])])*NX +
+                                                              x_n[1 + static_cast<int>(LT::DX[curr])];
+                if (isSolid[neighbour] == false)
+                {
+                    links.push_back({pop. template IndexRead<!odd>(x_n, y_n, z_n, n, d, p),
+                                     pop. template IndexWrite<odd>(x_n, y_n, z_n, !n, d, p)});
+                }
+            }
+        }
+    }
+    std::sort(links.begin(), links.end());
+
+    source_[odd].resize(links.size());
+    destination_[odd].resize(links.size());
+    for(size_t i = 0; i < links.size(); ++i)
+    {
+        source_[odd][i]      = links[i].first;
+        destination_[odd][i] = links[i].second;
+    }
+}
+
+/**\fn     GetNumberOfLinks
+ * \brief  Number of links bounced back per time step
+ *
+ * \return number of links of an even time step
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t CompactBounceBack<NX,NY,NZ>::GetNumberOfLinks() const
+{
+    return source_[0].size();
+}
+
+/**\fn     GetMemorySize
+ * \brief  Memory occupied by the indices of both time steps
+ *
+ * \return memory in bytes
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t CompactBounceBack<NX,NY,NZ>::GetMemorySize() const
+{
+    return (source_[0].size() + source_[1].size() + destination_[0].size() + destination_[1].size())*sizeof(size_t);
+}
+
+/**\fn         BounceBackHalfway
+ * \brief      Halfway bounce-back with a pre-compiled list of links: the stored values are copied
+ *             without conversion as opposite directions share the same lattice weight
+ *
+ * \tparam     odd    even (0, false) or odd (1, true) time step
+ * \tparam     NX     simulation domain resolution in x-direction
+ * \tparam     NY     simulation domain resolution in y-direction
+ * \tparam     NZ     simulation domain resolution in z-direction
+ * \tparam     LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP   number of populations stored side by side in the lattice
+ * \tparam     LY     memory layout policy of the populations
+ * \tparam     ST     storage policy of the populations
+ * \tparam     SP     streaming policy of the populations
+ * \param[in]  wall   pre-compiled links of the wall cells
+ * \param[out] pop    population object holding microscopic variables
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void BounceBackHalfway(CompactBounceBack<NX,NY,NZ> const& wall, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop)
+{
+    size_t const* const      source = wall.source_[odd].data();
+    size_t const* const destination = wall.destination_[odd].data();
+    size_t const              links = wall.source_[odd].size();
+
+    #pragma omp parallel for default(none) shared(pop) firstprivate(source, destination, links) schedule(static)
+    for(size_t i = 0; i < links; ++i)
+    {
+        pop.F_[destination[i]] = pop.F_[source[i]];
+    }
+}
+
+
+/**\class  CompactGuo
+ * \brief  Guo boundary of a list of boundary elements as linear population indices of the
+ *         neighbouring cell and the boundary cell, sorted by the memory address of the boundary cell
+ *
+ * \tparam Type          type of the boundary condition (type::Pressure or type::Velocity)
+ * \tparam Orientation   boundary orientation (orientation::Left, orientation::Right)
+ * \tparam NX            simulation domain resolution in x-direction
+ * \tparam NY            simulation domain resolution in y-direction
+ * \tparam NZ            simulation domain resolution in z-direction
+ * \tparam T             floating data type used for simulation
+*/
+template <template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+class CompactGuo
+{
+    public:
+        /// number of elements
+        size_t size_;
+
+        /// indices of population k of element i at k*size_ + i for even (0) and odd (1) time steps
+        std::vector<size_t> neighbour_[2];
+        std::vector<size_t> cell_[2];
+
+        /// macroscopic values (rho, u, v, w) shared by all elements or per element at k*size_ + i
+        std::array<double,4> values_;
+        std::vector<double>  profile_;
+
+
+        /**\brief Class constructor
+         * \param pop        population object the indices are computed for
+         * \param boundary   vector holding all corresponding boundary condition elements
+         * \param p          relevant population (default = 0)
+        */
+        template <class LT, unsigned int NPOP, class LY, class ST, class SP>
+        CompactGuo(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, std::vector<boundaryElement<T>> const& boundary,
+                   unsigned int const p = 0);
+
+        /// access functions
+        inline bool   HasProfile() const;
+        inline size_t GetMemorySize() const;
+};
+
+/**\fn        CompactGuo
+ * \brief     Compute the indices of all boundary elements for both time steps and check whether the
+ *            elements share the same macroscopic values
+ *
+ * \tparam    LT         static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP       number of populations stored side by side in the lattice
+ * \tparam    LY         memory layout policy of the populations
+ * \tparam    ST         storage policy of the populations
+ * \tparam    SP         streaming policy of the populations
+ * \param[in] pop        population object the indices are computed for
+ * \param[in] boundary   vector holding all corresponding boundary condition elements
+ * \param[in] p          relevant population
+*/
+template <template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+template <class LT, unsigned int NPOP, class LY, class ST, class SP>
+CompactGuo<Type,Orientation,NX,NY,NZ,T>::CompactGuo(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, std::vector<boundaryElement<T>> const& boundary,
+                                                    unsigned int const p):
+    size_(boundary.size()), neighbour_(), cell_(), values_(), profile_()
+{
+    /// populations in the order of the loops over n and d
+    constexpr unsigned int Q = 2*LT::HSPEED - 1;
+
+    auto const cell = [](boundaryElement<T> const& b, int const o, unsigned int (&x)[3], unsigned int (&y)[3], unsigned int (&z)[3])
+    {
+        x[0] = (NX + b.x + o*Orientation::x - 1) % NX; x[1] = b.x + o*Orientation::x; x[2] = (b.x + o*Orientation::x + 1) % NX;
+        y[0] = (NY + b.y + o*Orientation::y - 1) % NY; y[1] = b.y + o*Orientation::y; y[2] = (b.y + o*Orientation::y + 1) % NY;
+        z[0] = (NZ + b.z + o*Orientation::z - 1) % NZ; z[1] = b.z + o*Orientation::z; z[2] = (b.z + o*Orientation::z + 1) % NZ;
+    };
+
+    /// elements sorted by the address of their rest population
+    std::vector<size_t> order(size_);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<size_t> address(size_);
+    for(size_t i = 0; i < size_; ++i)
+    {
+        unsigned int x_c[3], y_c[3], z_c[3];
+        cell(boundary[i], 0, x_c, y_c, z_c);
+        address[i] = pop. template IndexRead<false>(x_c, y_c, z_c, 0, 0, p);
+    }
+    std::sort(order.begin(), order.end(), [&address](size_t const a, size_t const b) { return address[a] < address[b]; });
+
+    for(unsigned int odd = 0; odd <= 1; ++odd)
+    {
+        neighbour_[odd].resize(Q*size_);
+        cell_[odd].resize(Q*size_);
+    }
+    for(size_t i = 0; i < size_; ++i)
+    {
+        unsigned int x_n[3], y_n[3], z_n[3], x_c[3], y_c[3], z_c[3];
+        cell(boundary[order[i]], 1, x_n, y_n, z_n);
+        cell(boundary[order[i]], 0, x_c, y_c, z_c);
+
+        unsigned int k = 0;
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                neighbour_[0][k*size_ + i] = pop. template IndexRead<false>(x_n, y_n, z_n, n, d, p);
+                neighbour_[1][k*size_ + i] = pop. template IndexRead<true>(x_n, y_n, z_n, n, d, p);
+                cell_[0][k*size_ + i]      = pop. template IndexRead<false>(x_c, y_c, z_c, n, d, p);
+                cell_[1][k*size_ + i]      = pop. template IndexRead<true>(x_c, y_c, z_c, n, d, p);
+                ++k;
+            }
+        }
+    }
+
+    /// shared macroscopic values unless the elements differ
+    if (size_ > 0)
+    {
+        values_ = {boundary[0].rho, boundary[0].u, boundary[0].v, boundary[0].w};
+    }
+    bool const isUniform = std::all_of(boundary.begin(), boundary.end(), [this](boundaryElement<T> const& b)
+                           { return (b.rho == values_[0]) && (b.u == values_[1]) && (b.v == values_[2]) && (b.w == values_[3]); });
+    if (isUniform == false)
+    {
+        profile_.resize(4*size_);
+        for(size_t i = 0; i < size_; ++i)
+        {
+            boundaryElement<T> const& b = boundary[order[i]];
+            profile_[i]           = b.rho;
+            profile_[size_ + i]   = b.u;
+            profile_[2*size_ + i] = b.v;
+            profile_[3*size_ + i] = b.w;
+        }
+    }
+}
+
+/**\fn     HasProfile
+ * \brief  Check if the macroscopic values are stored per element
+ *
+ * \return Boolean true if the elements have individual values, false if they share the same values
+*/
+template <template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+inline bool CompactGuo<Type,Orientation,NX,NY,NZ,T>::HasProfile() const
+{
+    return (profile_.empty() == false);
+}
+
+/**\fn     GetMemorySize
+ * \brief  Memory occupied by the indices of both time steps and the macroscopic values
+ *
+ * \return memory in bytes
+*/
+template <template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+inline size_t CompactGuo<Type,Orientation,NX,NY,NZ,T>::GetMemorySize() const
+{
+    return (neighbour_[0].size() + neighbour_[1].size() + cell_[0].size() + cell_[1].size())*sizeof(size_t) +
+           profile_.size()*sizeof(double) + sizeof(values_);
+}
+
+/**\fn        Guo
+ * \brief     Guo boundary with pre-compiled indices: every element gathers the populations of its
+ *            neighbour, reconstructs its own populations and scatters them to the boundary cell
+ *
+ * \tparam    odd           even (0, false) or odd (1, true) time step
+ * \tparam    Type          type of the boundary condition (type::Pressure or type::Velocity)
+ * \tparam    Orientation   boundary orientation (orientation::Left, orientation::Right)
+ * \tparam    NX            simulation domain resolution in x-direction
+ * \tparam    NY            simulation domain resolution in y-direction
+ * \tparam    NZ            simulation domain resolution in z-direction
+ * \tparam    LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP          number of populations stored side by side in the lattice
+ * \tparam    LY            memory layout policy of the populations
+ * \tparam    ST            storage policy of the populations
+ * \tparam    SP            streaming policy of the populations
+ * \tparam    T             floating data type used for simulation
+ * \param[in] boundary      pre-compiled boundary
+ * \param[out] pop          population object holding microscopic variables
+*/
+template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void Guo(CompactGuo<Type,Orientation,NX,NY,NZ,T> const& boundary, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop)
+{
+    size_t const            size = boundary.size_;
+    size_t const* const neighbour = boundary.neighbour_[odd].data();
+    size_t const* const      cell = boundary.cell_[odd].data();
+    double const* const   profile = boundary.profile_.data();
+    bool const         hasProfile = boundary.HasProfile();
+    std::array<double,4> const& values = boundary.values_;
+
+    #pragma omp parallel for default(none) shared(pop, values) firstprivate(size, neighbour, cell, profile, hasProfile) schedule(static,32)
+    for(size_t i = 0; i < size; ++i)
+    {
+        alignas(CACHE_LINE) T f[LT::ND] = {0.0};
+
+        unsigned int k = 0;
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                f[n*LT::OFF + d] = pop.Load(neighbour[k*size + i], n, d);
+                ++k;
+            }
+        }
+
+        std::array<double,4> const bound = (hasProfile == true) ?
+                                           std::array<double,4>{profile[i], profile[size + i], profile[2*size + i], profile[3*size + i]} : values;
+        Guo_Reconstruct<Type,Orientation,LT>(bound, f);
+
+        k = 0;
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                pop.Store(cell[k*size + i], n, d, f[n*LT::OFF + d]);
+                ++k;
+            }
+        }
+    }
+}
+
+#endif // BOUNDARY_COMPACT_HPP_INCLUDED
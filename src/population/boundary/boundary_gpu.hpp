@@ -0,0 +1,296 @@
+#ifndef BOUNDARY_GPU_HPP_INCLUDED
+#define BOUNDARY_GPU_HPP_INCLUDED
+
+/**
+ * \file     boundary_gpu.hpp
+ * \mainpage Halfway bounce-back and Guo boundaries as device kernels
+ *
+ * \note     The boundary elements are copied to the device once. Every thread treats a single
+ *           boundary element, just like a single iteration of the OpenMP loops on the host.
+*/
+
+#include <array>
+#include <vector>
+
+#include "boundary.hpp"
+#include "boundary_orientation.hpp"
+#include "boundary_type.hpp"
+#include "../../general/gpu.hpp"
+#include "../../lattice/equilibrium.hpp"
+#include "../population_gpu.hpp"
+
+
+/**\class  DeviceBoundary
+ * \brief  Boundary elements in device memory
+ *
+ * \tparam T   floating data type used for simulation
+*/
+template <typename T = double>
+class DeviceBoundary
+{
+    public:
+        /// boundary elements in device memory and their number
+        boundaryElement<T>* elements_ = nullptr;
+        size_t const        size_;
+
+
+        /**\brief Class constructor: copy the boundary elements to the device
+         * \param boundary   vector holding all corresponding boundary condition elements
+        */
+        DeviceBoundary(std::vector<boundaryElement<T>> const& boundary):
+            size_(boundary.size())
+        {
+            if (size_ > 0)
+            {
+                GPU_CHECK(gpuMalloc(reinterpret_cast<void**>(&elements_), sizeof(boundaryElement<T>)*size_));
+                GPU_CHECK(gpuMemcpy(elements_, boundary.data(), sizeof(boundaryElement<T>)*size_, gpuMemcpyHostToDevice));
+            }
+        }
+
+        /**\brief Class destructor
+        */
+        ~DeviceBoundary()
+        {
+            gpuFree(elements_);
+        }
+
+        DeviceBoundary(DeviceBoundary const&) = delete;
+        DeviceBoundary& operator= (DeviceBoundary const&) = delete;
+};
+
+
+/**\fn         BounceBackHalfway_DeviceNode
+ * \brief      Solid wall boundary treatment with simple halfway bounce-back for a single wall element
+ *             (see BounceBackHalfway)
+ * \note       "Analytic solutions of simple flows and analysis of non-slip boundary conditions for
+ *             the lattice Boltzmann BGK model"
+ *             X. He, Q. Zou, L.S. Luo, M. Dembo
+ *             Journal of Statistical Physics 87 (1997)
+ *             DOI: 10.1007/BF02181482
+ *
+ * \tparam     odd       even (0, false) or odd (1, true) time step
+ * \tparam     NX        simulation domain resolution in x-direction
+ * \tparam     NY        simulation domain resolution in y-direction
+ * \tparam     NZ        simulation domain resolution in z-direction
+ * \tparam     LT        static lattice::DdQq class containing discretisation parameters
+ * \tparam     LY        memory layout policy of the populations
+ * \tparam     T         floating data type used for simulation
+ * \param[in]  b         wall element
+ * \param[out] F         populations in device memory
+ * \param[in]  lattice   lattice discretisation parameters
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+inline HOST_DEVICE void BounceBackHalfway_DeviceNode(boundaryElement<T> const& b, T* const F, latticeParameters<LT> const& lattice)
+{
+    typedef DevicePopulation<NX,NY,NZ,LT,LY> POP;
+
+    unsigned int const x_n[3] = { (NX + b.x - 1) % NX, b.x, (b.x + 1) % NX };
+    unsigned int const y_n[3] = { (NY + b.y - 1) % NY, b.y, (b.y + 1) % NY };
+    unsigned int const z_n[3] = { (NZ + b.z - 1) % NZ, b.z, (b.z + 1) % NZ };
+
+    #pragma unroll
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma unroll
+        for(unsigned int d = 1; d < LT::HSPEED; ++d)
+        {
+            F[POP::template AA_IndexWrite<odd>(lattice, x_n, y_n, z_n, !n, d)] = F[POP::template AA_IndexRead<!odd>(lattice, x_n, y_n, z_n, n, d)];
+        }
+    }
+}
+
+/**\fn      Guo_DeviceNode
+ * \brief   Interpolation velocity and pressure boundary conditions as proposed by Guo for a single
+ *          boundary element (see Guo_Node)
+ * \note    "Non-equilibrium extrapolation method for velocity and pressure boundary conditions in the
+ *          lattice Boltzmann method"
+ *          Z.L. Guo, C.G. Zheng, B.C. Shi
+ *          Chinese Physics, Volume 11, Number 4 (2002)
+ *          DOI: 10.1088/1009-1963/11/4/310
+ *
+ * \tparam     odd           even (0, false) or odd (1, true) time step
+ * \tparam     Type          type of the boundary condition (type::Pressure or type::Velocity)
+ * \tparam     Orientation   boundary orientation (orientation::Left, orientation::Right)
+ * \tparam     NX            simulation domain resolution in x-direction
+ * \tparam     NY            simulation domain resolution in y-direction
+ * \tparam     NZ            simulation domain resolution in z-direction
+ * \tparam     LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam     LY            memory layout policy of the populations
+ * \tparam     T             floating data type used for simulation
+ * \param[in]  b             boundary condition element
+ * \param[out] F             populations in device memory
+ * \param[in]  lattice       lattice discretisation parameters
+*/
+template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+inline HOST_DEVICE void Guo_DeviceNode(boundaryElement<T> const& b, T* const F, latticeParameters<LT> const& lattice)
+{
+    typedef DevicePopulation<NX,NY,NZ,LT,LY> POP;
+
+    /// for neighbouring cell
+    unsigned int const x_n[3] = { (NX + b.x + Orientation::x - 1) % NX,
+                                        b.x + Orientation::x,
+                                       (b.x + Orientation::x + 1) % NX };
+    unsigned int const y_n[3] = { (NY + b.y + Orientation::y - 1) % NY,
+                                        b.y + Orientation::y,
+                                       (b.y + Orientation::y + 1) % NY };
+    unsigned int const z_n[3] = { (NZ + b.z + Orientation::z - 1) % NZ,
+                                        b.z + Orientation::z,
+                                       (b.z + Orientation::z + 1) % NZ };
+
+    // load distributions
+    T f[LT::ND] = {0.0};
+
+    #pragma unroll
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma unroll
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            f[n*LT::OFF + d] = F[POP::template AA_IndexRead<odd>(lattice,x_n,y_n,z_n,n,d)];
+        }
+    }
+
+    // macroscopic values
+    T rho = 0.0;
+    T u   = 0.0;
+    T v   = 0.0;
+    T w   = 0.0;
+    lattice::Velocity<LT>(f, rho, u, v, w);
+
+    // non-equilibrium part of distributions
+    T feq[LT::ND]  = {0.0};
+    T fneq[LT::ND] = {0.0};
+
+    lattice::Equilibrium<LT>(rho, u, v, w, feq);
+
+    #pragma unroll
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma unroll
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr = n*LT::OFF + d;
+            fneq[curr] = f[curr] - feq[curr];
+        }
+    }
+
+    /// write to current node
+    // set new macroscopic values
+    std::array<double,4> const bound  = {b.rho,
+                                         b.u,
+                                         b.v,
+                                         b.w};
+    std::array<double,4> const interp = {rho, u, v, w};
+    std::array<double,4> res = Type<Orientation>::getMacroscopicValues(bound, interp);
+    rho = res[0];
+    u   = res[1];
+    v   = res[2];
+    w   = res[3];
+
+    // equilibrium distributions
+    lattice::Equilibrium<LT>(rho, u, v, w, feq);
+
+    // write new population values to cell: feq + fneq
+    unsigned int const x_c[3] = { (NX + b.x - 1) % NX, b.x, (b.x + 1) % NX };
+    unsigned int const y_c[3] = { (NY + b.y - 1) % NY, b.y, (b.y + 1) % NY };
+    unsigned int const z_c[3] = { (NZ + b.z - 1) % NZ, b.z, (b.z + 1) % NZ };
+
+    #pragma unroll
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma unroll
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr = n*LT::OFF + d;
+            F[POP::template AA_IndexRead<odd>(lattice,x_c,y_c,z_c,n,d)] = feq[curr] + fneq[curr];
+        }
+    }
+}
+
+
+#if defined(__CUDACC__) || defined(__HIPCC__)
+
+    /**\fn        BounceBackHalfway_Kernel
+     * \brief     Device kernel of the halfway bounce-back: a single wall element per thread
+    */
+    template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+    __global__ void __launch_bounds__(GPU_BLOCK_SIZE) BounceBackHalfway_Kernel(boundaryElement<T> const* const wall, size_t const size,
+                                                                               T* const F, latticeParameters<LT> const lattice)
+    {
+        size_t const i = static_cast<size_t>(blockIdx.x)*blockDim.x + threadIdx.x;
+
+        if (i < size)
+        {
+            BounceBackHalfway_DeviceNode<odd,NX,NY,NZ,LT,LY>(wall[i], F, lattice);
+        }
+    }
+
+    /**\fn        Guo_Kernel
+     * \brief     Device kernel of the Guo boundaries: a single boundary element per thread
+    */
+    template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+    __global__ void __launch_bounds__(GPU_BLOCK_SIZE) Guo_Kernel(boundaryElement<T> const* const boundary, size_t const size,
+                                                                 T* const F, latticeParameters<LT> const lattice)
+    {
+        size_t const i = static_cast<size_t>(blockIdx.x)*blockDim.x + threadIdx.x;
+
+        if (i < size)
+        {
+            Guo_DeviceNode<odd,Type,Orientation,NX,NY,NZ,LT,LY>(boundary[i], F, lattice);
+        }
+    }
+
+
+    /**\fn         BounceBackHalfway
+     * \brief      Solid wall boundary treatment with simple halfway bounce-back on the device
+     *
+     * \tparam     odd    even (0, false) or odd (1, true) time step
+     * \tparam     NX     simulation domain resolution in x-direction
+     * \tparam     NY     simulation domain resolution in y-direction
+     * \tparam     NZ     simulation domain resolution in z-direction
+     * \tparam     LT     static lattice::DdQq class containing discretisation parameters
+     * \tparam     LY     memory layout policy of the populations
+     * \tparam     T      floating data type used for simulation
+     * \param[in]  wall   all corresponding boundary condition elements in device memory
+     * \param[out] pop    population object holding microscopic variables in device memory
+    */
+    template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+    void BounceBackHalfway(DeviceBoundary<T> const& wall, DevicePopulation<NX,NY,NZ,LT,LY>& pop)
+    {
+        if (wall.size_ > 0)
+        {
+            unsigned int const blocks = static_cast<unsigned int>((wall.size_ + GPU_BLOCK_SIZE - 1)/GPU_BLOCK_SIZE);
+            BounceBackHalfway_Kernel<odd,NX,NY,NZ,LT,LY><<<blocks, GPU_BLOCK_SIZE>>>(wall.elements_, wall.size_, pop.F_, pop.LATTICE_);
+            GPU_CHECK(gpuGetLastError());
+        }
+    }
+
+    /**\fn         Guo
+     * \brief      Interpolation velocity and pressure boundary conditions as proposed by Guo on the device
+     *
+     * \tparam     odd           even (0, false) or odd (1, true) time step
+     * \tparam     Type          type of the boundary condition (type::Pressure or type::Velocity)
+     * \tparam     Orientation   boundary orientation (orientation::Left, orientation::Right)
+     * \tparam     NX            simulation domain resolution in x-direction
+     * \tparam     NY            simulation domain resolution in y-direction
+     * \tparam     NZ            simulation domain resolution in z-direction
+     * \tparam     LT            static lattice::DdQq class containing discretisation parameters
+     * \tparam     LY            memory layout policy of the populations
+     * \tparam     T             floating data type used for simulation
+     * \param[in]  boundary      all corresponding boundary condition elements in device memory
+     * \param[out] pop           population object holding microscopic variables in device memory
+    */
+    template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+    void Guo(DeviceBoundary<T> const& boundary, DevicePopulation<NX,NY,NZ,LT,LY>& pop)
+    {
+        if (boundary.size_ > 0)
+        {
+            unsigned int const blocks = static_cast<unsigned int>((boundary.size_ + GPU_BLOCK_SIZE - 1)/GPU_BLOCK_SIZE);
+            Guo_Kernel<odd,Type,Orientation,NX,NY,NZ,LT,LY><<<blocks, GPU_BLOCK_SIZE>>>(boundary.elements_, boundary.size_, pop.F_, pop.LATTICE_);
+            GPU_CHECK(gpuGetLastError());
+        }
+    }
+
+#endif
+
+#endif // BOUNDARY_GPU_HPP_INCLUDED
@@ -6,14 +6,156 @@
  * \mainpage Very robust Guo interpolation boundary condition for pressure and velocity
 */
 
+#include <algorithm>
 #include <array>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
 
 #include "boundary.hpp"
 #include "boundary_orientation.hpp"
 #include "boundary_type.hpp"
+#include "../../lattice/equilibrium.hpp"
+#include "../fluid_cells.hpp"
+#include "../moments.hpp"
 #include "../population.hpp"
 
 
+/**\fn         Guo_Reconstruct
+ * \brief      Reconstruct the populations of a boundary element from the populations of its
+ *             neighbouring cell: the non-equilibrium part of the neighbour is added to the equilibrium
+ *             of the macroscopic values prescribed by the boundary condition.
+ *
+ * \tparam        Type          type of the boundary condition (type::Pressure or type::Velocity)
+ * \tparam        Orientation   boundary orientation (orientation::Left, orientation::Right)
+ * \tparam        LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam        T             floating data type used for simulation
+ * \param[in]     bound         macroscopic values prescribed by the boundary element (rho, u, v, w)
+ * \param[in,out] f             populations of the neighbouring cell, overwritten by the populations of
+ *                              the boundary element
+*/
+template <template <class Orientation> class Type, class Orientation, class LT, typename T>
+inline void Guo_Reconstruct(std::array<double,4> const& bound, T (&f)[LT::ND])
+{
+    // macroscopic values
+    T rho = 0.0;
+    T u   = 0.0;
+    T v   = 0.0;
+    T w   = 0.0;
+    lattice::Velocity<LT>(f, rho, u, v, w);
+
+    // non-equilibrium part of distributions
+    alignas(CACHE_LINE) T feq[LT::ND]  = {0.0};
+    alignas(CACHE_LINE) T fneq[LT::ND] = {0.0};
+
+    lattice::Equilibrium<LT>(rho, u, v, w, feq);
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr = n*LT::OFF + d;
+            fneq[curr] = f[curr] - feq[curr];
+        }
+    }
+
+    /// set new macroscopic values
+    std::array<double,4> const interp = {rho, u, v, w};
+    std::array<double,4> res = Type<Orientation>::getMacroscopicValues(bound, interp);
+    rho = res[0];
+    u   = res[1];
+    v   = res[2];
+    w   = res[3];
+
+    // equilibrium distributions: feq + fneq
+    lattice::Equilibrium<LT>(rho, u, v, w, feq);
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr = n*LT::OFF + d;
+            f[curr] = feq[curr] + fneq[curr];
+        }
+    }
+}
+
+/**\fn      Guo_Node
+ * \brief   Interpolation velocity and pressure boundary conditions as proposed by Guo for a single
+ *          boundary element: the non-equilibrium part of the neighbouring cell is extrapolated.
+ * \note    "Non-equilibrium extrapolation method for velocity and pressure boundary conditions in the
+ *          lattice Boltzmann method"
+ *          Z.L. Guo, C.G. Zheng, B.C. Shi
+ *          Chinese Physics, Volume 11, Number 4 (2002)
+ *          DOI: 10.1088/1009-1963/11/4/310
+ *
+ * \tparam     odd           even (0, false) or odd (1, true) time step
+ * \tparam     Type          type of the boundary condition (type::Pressure or type::Velocity)
+ * \tparam     Orientation   boundary orientation (orientation::Left, orientation::Right)
+ * \tparam     NX            simulation domain resolution in x-direction
+ * \tparam     NY            simulation domain resolution in y-direction
+ * \tparam     NZ            simulation domain resolution in z-direction
+ * \tparam     LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP          number of populations stored side by side in the lattice
+ * \tparam     LY            memory layout policy of the populations
+ * \tparam     ST            storage policy of the populations
+ * \tparam     SP            streaming policy of the populations
+ * \tparam     T             floating data type used for simulation
+ * \param[in]  b             boundary condition element
+ * \param[out] pop           population object holding microscopic variables
+ * \param[in]  p             relevant population
+*/
+template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+inline void Guo_Node(boundaryElement<T> const& b, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const p)
+{
+    /// for neighbouring cell
+    unsigned int const x_n[3] = { (NX + b.x + Orientation::x - 1) % NX,
+                                        b.x + Orientation::x,
+                                       (b.x + Orientation::x + 1) % NX };
+    unsigned int const y_n[3] = { (NY + b.y + Orientation::y - 1) % NY,
+                                        b.y + Orientation::y,
+                                       (b.y + Orientation::y + 1) % NY };
+    unsigned int const z_n[3] = { (NZ + b.z + Orientation::z - 1) % NZ,
+                                        b.z + Orientation::z,
+                                       (b.z + Orientation::z + 1) % NZ };
+
+    // load distributions
+    alignas(CACHE_LINE) T f[LT::ND] = {0.0};
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            f[n*LT::OFF + d] = pop.Load(pop. template IndexRead<odd>(x_n,y_n,z_n,n,d,p), n, d);
+        }
+    }
+
+    std::array<double,4> const bound = {b.rho, b.u, b.v, b.w};
+    Guo_Reconstruct<Type,Orientation,LT>(bound, f);
+
+    /// write to current node
+    unsigned int const x_c[3] = { (NX + b.x - 1) % NX, b.x, (b.x + 1) % NX };
+    unsigned int const y_c[3] = { (NY + b.y - 1) % NY, b.y, (b.y + 1) % NY };
+    unsigned int const z_c[3] = { (NZ + b.z - 1) % NZ, b.z, (b.z + 1) % NZ };
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            pop.Store(pop. template IndexRead<odd>(x_c,y_c,z_c,n,d,p), n, d, f[n*LT::OFF + d]);
+        }
+    }
+}
+
 /**\fn      Guo
  * \brief   Interpolation velocity and pressure boundary conditions as proposed by Guo.
  *          Most stable boundary conditions in this implementation so far.
@@ -30,125 +172,208 @@
  * \tparam     NY            simulation domain resolution in y-direction
  * \tparam     NZ            simulation domain resolution in z-direction
  * \tparam     LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP          number of populations stored side by side in the lattice
+ * \tparam     LY            memory layout policy of the populations
+ * \tparam     ST            storage policy of the populations
+ * \tparam     SP            streaming policy of the populations
  * \tparam     T             floating data type used for simulation
  * \param[in]  boundary      vector holding all corresponding boundary condition elements
  * \param[out] pop           population object holding microscopic variables
  * \param[in]  p             relevant population (default = 0)
 */
-template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void Guo(std::vector<boundaryElement<T>> const& boundary, Population<NX,NY,NZ,LT>& pop, unsigned int const p = 0)
+template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void Guo(std::vector<boundaryElement<T>> const& boundary, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const p = 0)
 {
     #pragma omp parallel for default(none) shared(boundary,pop,p) schedule(static,32)
     for(size_t i = 0; i < boundary.size(); ++i)
     {
-        /// for neighbouring cell
-        unsigned int const x_n[3] = { (NX + boundary[i].x + Orientation::x - 1) % NX,
-                                            boundary[i].x + Orientation::x,
-                                           (boundary[i].x + Orientation::x + 1) % NX };
-        unsigned int const y_n[3] = { (NY + boundary[i].y + Orientation::y - 1) % NY,
-                                            boundary[i].y + Orientation::y,
-                                           (boundary[i].y + Orientation::y + 1) % NY };
-        unsigned int const z_n[3] = { (NZ + boundary[i].z + Orientation::z - 1) % NZ,
-                                            boundary[i].z + Orientation::z,
-                                           (boundary[i].z + Orientation::z + 1) % NZ };
-
-        // load distributions
-        alignas(CACHE_LINE) T f[LT::ND] = {0.0};
-
-        #pragma GCC unroll (2)
-        for(unsigned int n = 0; n <= 1; ++n)
-        {
-            #pragma GCC unroll (16)
-            for(unsigned int d = n; d < LT::HSPEED; ++d)
-            {
-                f[n*LT::OFF + d] = pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)];
-            }
-        }
+        Guo_Node<odd,Type,Orientation>(boundary[i], pop, p);
+    }
+}
 
-        // macroscopic values
-        T rho = 0.0;
-        T u   = 0.0;
-        T v   = 0.0;
-        T w   = 0.0;
-        #pragma GCC unroll (2)
-        for(unsigned int n = 0; n <= 1; ++n)
-        {
-            #pragma GCC unroll (16)
-            for(unsigned int d = n; d < LT::HSPEED; ++d)
-            {
-                unsigned int const curr = n*LT::OFF + d;
-                rho += f[curr];
-                u   += f[curr]*LT::DX[curr];
-                v   += f[curr]*LT::DY[curr];
-                w   += f[curr]*LT::DZ[curr];
-            }
-        }
-        u /= rho;
-        v /= rho;
-        w /= rho;
+/**\fn      Guo
+ * \brief   Interpolation velocity and pressure boundary conditions as proposed by Guo for a lattice
+ *          stored in moment space: the boundary element takes the macroscopic values prescribed by the
+ *          boundary condition and the non-equilibrium moments of its neighbouring cell.
+ * \note    "Non-equilibrium extrapolation method for velocity and pressure boundary conditions in the
+ *          lattice Boltzmann method"
+ *          Z.L. Guo, C.G. Zheng, B.C. Shi
+ *          Chinese Physics, Volume 11, Number 4 (2002)
+ *          DOI: 10.1088/1009-1963/11/4/310
+ *
+ * \tparam     odd           even (0, false) or odd (1, true) time step
+ * \tparam     Type          type of the boundary condition (type::Pressure or type::Velocity)
+ * \tparam     Orientation   boundary orientation (orientation::Left, orientation::Right)
+ * \tparam     NX            simulation domain resolution in x-direction
+ * \tparam     NY            simulation domain resolution in y-direction
+ * \tparam     NZ            simulation domain resolution in z-direction
+ * \tparam     LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam     ST            storage policy of the moments
+ * \tparam     T             floating data type used for simulation
+ * \param[in]  boundary      vector holding all corresponding boundary condition elements
+ * \param[out] mom           moment population object holding microscopic variables
+*/
+template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST, typename T>
+void Guo(std::vector<boundaryElement<T>> const& boundary, MomentPopulation<NX,NY,NZ,LT,ST>& mom)
+{
+    #pragma omp parallel for default(none) shared(boundary,mom) schedule(static,32)
+    for(size_t i = 0; i < boundary.size(); ++i)
+    {
+        boundaryElement<T> const& b = boundary[i];
 
-        // non-equilibrium part of distributions
-        alignas(CACHE_LINE) T fneq[LT::ND] = {0.0};
+        /// moments of the neighbouring cell read in the given time step
+        T m[MomentPopulation<NX,NY,NZ,LT,ST>::NM_];
+        mom. template Load<odd>(b.x + Orientation::x, b.y + Orientation::y, b.z + Orientation::z, m);
 
-        T uu = - 1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w);
+        std::array<double,4> const bound  = {b.rho, b.u, b.v, b.w};
+        std::array<double,4> const interp = {m[0], m[1], m[2], m[3]};
+        std::array<double,4> const res    = Type<Orientation>::getMacroscopicValues(bound, interp);
+        m[0] = res[0];
+        m[1] = res[1];
+        m[2] = res[2];
+        m[3] = res[3];
 
-        #pragma GCC unroll (2)
-        for(unsigned int n = 0; n <= 1; ++n)
-        {
-            #pragma GCC unroll (16)
-            for(unsigned int d = n; d < LT::HSPEED; ++d)
-            {
-                unsigned int const curr = n*LT::OFF + d;
-                T const cu = 1.0/(LT::CS*LT::CS)*(u*LT::DX[curr] + v*LT::DY[curr] + w*LT::DZ[curr]);
-                fneq[curr] = f[curr] - LT::W[curr]*(rho + rho*(cu*(1.0 + 0.5*cu) + uu));
-            }
-        }
+        /// overwrite the moments of the boundary element read in the given time step
+        mom. template Store<!odd>(b.x, b.y, b.z, m);
+    }
+}
+
+
+/**\class  FusedGuo
+ * \brief  Guo boundary elements sorted by the loop blocks of a fluid cell list so that they can be
+ *         applied by the collision kernels at the beginning of every block instead of in a separate
+ *         sweep before the collision. An element can only be fused if the boundary cell as well as
+ *         the neighbouring cell it interpolates from are fluid cells of the same block: the
+ *         neighbour must not be collided before and must not be overwritten by the fused bounce-back.
+ *         All other elements have to be applied before the collision with Guo(FusedGuo, ...).
+ *         The blocks may be the loop blocks of FluidCells or the planes of a Wavefront.
+ *
+ * \tparam Type          type of the boundary condition (type::Pressure or type::Velocity)
+ * \tparam Orientation   boundary orientation (orientation::Left, orientation::Right)
+ * \tparam NX            simulation domain resolution in x-direction
+ * \tparam NY            simulation domain resolution in y-direction
+ * \tparam NZ            simulation domain resolution in z-direction
+ * \tparam T             floating data type used for simulation
+*/
+template <template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+class FusedGuo
+{
+    public:
+        /// elements applied within the collision sweep sorted by block and index of first element of every block
+        std::vector<boundaryElement<T>> fused_;
+        std::vector<size_t>             blocks_;
+
+        /// elements that have to be applied before the collision
+        std::vector<boundaryElement<T>> unfused_;
+
+
+        /**\brief Class constructor
+         * \param fluid      fluid cell list whose collision the boundary should be fused with
+         * \param boundary   vector holding all corresponding boundary condition elements
+        */
+        template <class CL>
+        FusedGuo(CL const& fluid, std::vector<boundaryElement<T>> const& boundary);
 
-        /// write to current node
-        // set new macroscopic values
-        std::array<double,4> const bound  = {boundary[i].rho,
-                                             boundary[i].u,
-                                             boundary[i].v,
-                                             boundary[i].w};
-        std::array<double,4> const interp = {rho, u, v, w};
-        std::array<double,4> res = Type<Orientation>::getMacroscopicValues(bound, interp);
-        rho = res[0];
-        u   = res[1];
-        v   = res[2];
-        w   = res[3];
-
-        // equilibrium distributions
-        alignas(CACHE_LINE) T feq[LT::ND] = {0.0};
-
-        uu = - 1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w);
-
-        #pragma GCC unroll (2)
-        for(unsigned int n = 0; n <= 1; ++n)
+        /// apply fused elements of a single block
+        template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+        inline void ApplyBlock(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const block, unsigned int const p) const;
+};
+
+/**\fn        FusedGuo
+ * \brief     Sort the boundary elements that belong to the fluid cell list by block. Elements outside of
+ *            the range in z-direction of the list are ignored (they belong to another list).
+ *
+ * \tparam    CL         type of the fluid cell list (FluidCells or Wavefront)
+ * \param[in] fluid      fluid cell list whose collision the boundary should be fused with
+ * \param[in] boundary   vector holding all corresponding boundary condition elements
+*/
+template <template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, typename T> template <class CL>
+FusedGuo<Type,Orientation,NX,NY,NZ,T>::FusedGuo(CL const& fluid, std::vector<boundaryElement<T>> const& boundary):
+    fused_(), blocks_(fluid.NUM_BLOCKS_ + 1, 0), unfused_()
+{
+    std::vector<unsigned int> block(boundary.size(), fluid.NUM_BLOCKS_);
+    std::vector<size_t>       order;
+
+    for(size_t i = 0; i < boundary.size(); ++i)
+    {
+        boundaryElement<T> const& b = boundary[i];
+        if ((b.z < fluid.Z_MIN_) || (b.z >= fluid.Z_MAX_))
         {
-            #pragma GCC unroll (16)
-            for(unsigned int d = n; d < LT::HSPEED; ++d)
-            {
-                unsigned int const curr = n*LT::OFF + d;
-                T const cu = 1.0/(LT::CS*LT::CS)*(u*LT::DX[curr] + v*LT::DY[curr] + w*LT::DZ[curr]);
-                feq[curr] = LT::W[curr]*(rho + rho*(cu*(1.0 + 0.5*cu) + uu));
-            }
+            continue;
         }
 
-        // write new population values to cell: feq + fneq
-        unsigned int const x_c[3] = { (NX + boundary[i].x - 1) % NX, boundary[i].x, (boundary[i].x + 1) % NX };
-        unsigned int const y_c[3] = { (NY + boundary[i].y - 1) % NY, boundary[i].y, (boundary[i].y + 1) % NY };
-        unsigned int const z_c[3] = { (NZ + boundary[i].z - 1) % NZ, boundary[i].z, (boundary[i].z + 1) % NZ };
+        unsigned int const x = (NX + b.x + Orientation::x) % NX;
+        unsigned int const y = (NY + b.y + Orientation::y) % NY;
+        unsigned int const z = (NZ + b.z + Orientation::z) % NZ;
 
-        #pragma GCC unroll (2)
-        for(unsigned int n = 0; n <= 1; ++n)
+        if ((fluid.IsFluid(b.x, b.y, b.z) == true) && (fluid.IsFluid(x, y, z) == true) &&
+            (fluid.GetBlock(b.x, b.y, b.z) == fluid.GetBlock(x, y, z)))
         {
-            #pragma GCC unroll (16)
-            for(unsigned int d = n; d < LT::HSPEED; ++d)
-            {
-                unsigned int const curr = n*LT::OFF + d;
-                pop.F_[pop. template AA_IndexRead<odd>(x_c,y_c,z_c,n,d,p)] = feq[curr] + fneq[curr];
-            }
+            block[i] = fluid.GetBlock(b.x, b.y, b.z);
+            ++blocks_[block[i] + 1];
+            order.push_back(i);
         }
+        else
+        {
+            unfused_.push_back(b);
+        }
+    }
+
+    for(unsigned int k = 0; k < fluid.NUM_BLOCKS_; ++k)
+    {
+        blocks_[k + 1] += blocks_[k];
+    }
+
+    /// boundary elements are immutable: insert them in the order of the blocks
+    std::stable_sort(order.begin(), order.end(), [&block](size_t const a, size_t const b) { return block[a] < block[b]; });
+    fused_.reserve(order.size());
+    for(size_t i = 0; i < order.size(); ++i)
+    {
+        fused_.push_back(boundary[order[i]]);
+    }
+}
+
+/**\fn        ApplyBlock
+ * \brief     Apply the fused boundary elements of a single block (called by the collision kernels
+ *            before the first cell of the block is collided)
+ *
+ * \tparam    odd     even (0, false) or odd (1, true) time step
+ * \tparam    LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP    number of populations stored side by side in the lattice
+ * \tparam    LY      memory layout policy of the populations
+ * \tparam    ST      storage policy of the populations
+ * \tparam    SP      streaming policy of the populations
+ * \param[out] pop    population object holding microscopic variables
+ * \param[in] block   the current block
+ * \param[in] p       relevant population
+*/
+template <template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+inline void FusedGuo<Type,Orientation,NX,NY,NZ,T>::ApplyBlock(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const block, unsigned int const p) const
+{
+    for(size_t i = blocks_[block]; i < blocks_[block + 1]; ++i)
+    {
+        Guo_Node<odd,Type,Orientation>(fused_[i], pop, p);
+    }
+}
+
+/**\fn        Guo
+ * \brief     Apply those elements of a fused Guo boundary that can not be applied within the collision
+ *            sweep. Has to be called before the collision, returns immediately if there are none.
+ *
+ * \tparam    odd           even (0, false) or odd (1, true) time step
+ * \tparam    Type          type of the boundary condition (type::Pressure or type::Velocity)
+ * \tparam    Orientation   boundary orientation (orientation::Left, orientation::Right)
+ * \param[in] boundary      fused boundary
+ * \param[out] pop          population object holding microscopic variables
+ * \param[in] p             relevant population (default = 0)
+*/
+template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void Guo(FusedGuo<Type,Orientation,NX,NY,NZ,T> const& boundary, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const p = 0)
+{
+    if (boundary.unfused_.empty() == false)
+    {
+        Guo<odd,Type,Orientation>(boundary.unfused_, pop, p);
     }
 }
 
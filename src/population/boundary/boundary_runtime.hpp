@@ -0,0 +1,135 @@
+#ifndef BOUNDARY_RUNTIME_HPP_INCLUDED
+#define BOUNDARY_RUNTIME_HPP_INCLUDED
+
+/**
+ * \file     boundary_runtime.hpp
+ * \mainpage Bounce-back and Guo boundaries for domains whose size is only known at run time
+*/
+
+#include <array>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "boundary.hpp"
+#include "boundary_guo.hpp"
+#include "boundary_orientation.hpp"
+#include "boundary_type.hpp"
+#include "../population_runtime.hpp"
+
+
+/**\fn         BounceBackHalfway
+ * \brief      Solid wall boundary treatment with simple halfway bounce-back (run-time sized domain)
+ * \note       "Analytic solutions of simple flows and analysis of non-slip boundary conditions for
+ *             the lattice Boltzmann BGK model"
+ *             X. He, Q. Zou, L.S. Luo, M. Dembo
+ *             Journal of Statistical Physics 87 (1997)
+ *             DOI: 10.1007/BF02181482
+ *
+ * \tparam     odd    even (0, false) or odd (1, true) time step
+ * \tparam     LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam     T      floating data type used for simulation
+ * \param[in]  wall   vector holding all corresponding boundary condition elements
+ * \param[out] pop    population object holding microscopic variables
+*/
+template <bool odd, class LT, typename T>
+void BounceBackHalfway(std::vector<boundaryElement<T>> const& wall, RuntimePopulation<LT>& pop)
+{
+    unsigned int const NX = pop.NX_;
+    unsigned int const NY = pop.NY_;
+    unsigned int const NZ = pop.NZ_;
+
+    #pragma omp parallel for default(none) shared(wall,pop) firstprivate(NX,NY,NZ) schedule(static,32)
+    for(size_t i = 0; i < wall.size(); ++i)
+    {
+        unsigned int const x_n[3] = { (NX + wall[i].x - 1) % NX, wall[i].x, (wall[i].x + 1) % NX };
+        unsigned int const y_n[3] = { (NY + wall[i].y - 1) % NY, wall[i].y, (wall[i].y + 1) % NY };
+        unsigned int const z_n[3] = { (NZ + wall[i].z - 1) % NZ, wall[i].z, (wall[i].z + 1) % NZ };
+
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (15)
+            for(unsigned int d = 1; d < LT::HSPEED; ++d)
+            {
+                pop.F_[pop. template IndexWrite<odd>(x_n, y_n, z_n, !n, d)] = pop.F_[pop. template IndexRead<!odd>(x_n, y_n, z_n, n, d)];
+            }
+        }
+    }
+}
+
+/**\fn      Guo
+ * \brief   Interpolation velocity and pressure boundary conditions as proposed by Guo (run-time sized
+ *          domain, same reconstruction as the compiled domains)
+ * \note    "Non-equilibrium extrapolation method for velocity and pressure boundary conditions in the
+ *          lattice Boltzmann method"
+ *          Z.L. Guo, C.G. Zheng, B.C. Shi
+ *          Chinese Physics, Volume 11, Number 4 (2002)
+ *          DOI: 10.1088/1009-1963/11/4/310
+ *
+ * \tparam     odd           even (0, false) or odd (1, true) time step
+ * \tparam     Type          type of the boundary condition (type::Pressure or type::Velocity)
+ * \tparam     Orientation   boundary orientation (orientation::Left, orientation::Right)
+ * \tparam     LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam     T             floating data type used for simulation
+ * \param[in]  boundary      vector holding all corresponding boundary condition elements
+ * \param[out] pop           population object holding microscopic variables
+*/
+template <bool odd, template <class Orientation> class Type, class Orientation, class LT, typename T>
+void Guo(std::vector<boundaryElement<T>> const& boundary, RuntimePopulation<LT>& pop)
+{
+    unsigned int const NX = pop.NX_;
+    unsigned int const NY = pop.NY_;
+    unsigned int const NZ = pop.NZ_;
+
+    #pragma omp parallel for default(none) shared(boundary,pop) firstprivate(NX,NY,NZ) schedule(static,32)
+    for(size_t i = 0; i < boundary.size(); ++i)
+    {
+        boundaryElement<T> const& b = boundary[i];
+
+        /// for neighbouring cell
+        unsigned int const x_n[3] = { (NX + b.x + Orientation::x - 1) % NX,
+                                            b.x + Orientation::x,
+                                           (b.x + Orientation::x + 1) % NX };
+        unsigned int const y_n[3] = { (NY + b.y + Orientation::y - 1) % NY,
+                                            b.y + Orientation::y,
+                                           (b.y + Orientation::y + 1) % NY };
+        unsigned int const z_n[3] = { (NZ + b.z + Orientation::z - 1) % NZ,
+                                            b.z + Orientation::z,
+                                           (b.z + Orientation::z + 1) % NZ };
+
+        // load distributions
+        alignas(CACHE_LINE) T f[LT::ND] = {0.0};
+
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                f[n*LT::OFF + d] = pop.F_[pop. template IndexRead<odd>(x_n,y_n,z_n,n,d)];
+            }
+        }
+
+        std::array<double,4> const bound = {b.rho, b.u, b.v, b.w};
+        Guo_Reconstruct<Type,Orientation,LT>(bound, f);
+
+        /// write to current node
+        unsigned int const x_c[3] = { (NX + b.x - 1) % NX, b.x, (b.x + 1) % NX };
+        unsigned int const y_c[3] = { (NY + b.y - 1) % NY, b.y, (b.y + 1) % NY };
+        unsigned int const z_c[3] = { (NZ + b.z - 1) % NZ, b.z, (b.z + 1) % NZ };
+
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                pop.F_[pop. template IndexRead<odd>(x_c,y_c,z_c,n,d)] = f[n*LT::OFF + d];
+            }
+        }
+    }
+}
+
+#endif // BOUNDARY_RUNTIME_HPP_INCLUDED
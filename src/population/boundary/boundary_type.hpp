@@ -8,6 +8,8 @@
 
 #include <array>
 
+#include "../../general/gpu.hpp"
+
 
 /**\def       T_N (orient,t,n)
  * \brief     Macro for determining if the velocity is tangential of normal
@@ -38,7 +40,7 @@ namespace type
              * \return    an array that contains a mixture of enforced or interpolated values depending on the precise boundary
             */
             template <typename T>
-            static inline std::array<T,4> getMacroscopicValues(std::array<T,4> const& boundary, std::array<T,4> const& interp)
+            static inline HOST_DEVICE std::array<T,4> getMacroscopicValues(std::array<T,4> const& boundary, std::array<T,4> const& interp)
             {
                 return { interp[0], boundary[1], boundary[2], boundary[3] };
             }
@@ -53,7 +55,7 @@ namespace type
     {
         public:
             template <typename T>
-            static inline std::array<T,4> getMacroscopicValues(std::array<T,4> const& boundary, std::array<T,4> const& interp)
+            static inline HOST_DEVICE std::array<T,4> getMacroscopicValues(std::array<T,4> const& boundary, std::array<T,4> const& interp)
             {
                 return { boundary[0],
                          T_N(Orientation::x, boundary[1], interp[1]),
@@ -8,13 +8,101 @@
 
 #include <algorithm>
 #include <cmath>
+#include <tuple>
 #if __has_include (<omp.h>)
     #include <omp.h>
 #endif
 
+#include "../../general/cpu_dispatch.hpp"
+#include "../../general/instrumentation.hpp"
 #include "../../general/memory_alignment.hpp"
 #include "../../continuum/continuum.hpp"
+#include "../../lattice/equilibrium.hpp"
+#include "../block_pipeline.hpp"
+#include "../block_scheduler.hpp"
+#include "../boundary/boundary_bounceback.hpp"
+#include "../fluid_cells.hpp"
 #include "../population.hpp"
+#include "../wavefront.hpp"
+
+/**\fn            CollideStreamBGK_Node
+ * \brief         BGK collision operator for arbitrary lattice (single lattice node)
+ * \warning       Inline function! Has to be declared in header!
+ * \note          "A Model for Collision Processes in Gases. I. Small Amplitude Processes in Charged
+ *                and Neutral One-Component Systems"
+ *                P.L. Bhatnagar, E.P. Gross, M. Krook
+ *                Physical Review 94 (1954)
+ *                DOI: 10.1103/PhysRev.94.511
+ *
+ * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        NX     simulation domain resolution in x-direction
+ * \tparam        NY     simulation domain resolution in y-direction
+ * \tparam        NZ     simulation domain resolution in z-direction
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP   number of populations stored side by side in the lattice
+ * \tparam        LY     memory layout policy of the populations
+ * \tparam        ST     storage policy of the populations
+ * \tparam        SP     streaming policy of the populations
+ * \tparam        T      floating data type used for simulation
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] pop    population object holding microscopic variables
+ * \param[in]     x_n    x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]     y_n    y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]     z_n    z coordinates of current cell and its neighbours [z-1,z,z+1]
+ * \param[in]     p      relevant population
+*/
+template <bool odd, bool save, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+inline void __attribute__((always_inline)) CollideStreamBGK_Node(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop,
+                                                                 unsigned int const (&x_n)[3], unsigned int const (&y_n)[3], unsigned int const (&z_n)[3],
+                                                                 unsigned int const p)
+{
+    /// load distributions
+    alignas(CACHE_LINE) T f[LT::ND] = {0.0};
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            f[n*LT::OFF + d] = pop.Load(pop. template IndexRead<odd>(x_n,y_n,z_n,n,d,p), n, d);
+        }
+    }
+
+    /// macroscopic values
+    T rho = 0.0;
+    T u   = 0.0;
+    T v   = 0.0;
+    T w   = 0.0;
+    lattice::Velocity<LT>(f, rho, u, v, w);
+
+    if constexpr (save == true)
+    {
+        con(x_n[1], y_n[1], z_n[1], 0) = rho;
+        con(x_n[1], y_n[1], z_n[1], 1) = u;
+        con(x_n[1], y_n[1], z_n[1], 2) = v;
+        con(x_n[1], y_n[1], z_n[1], 3) = w;
+    }
+
+    /// equilibrium distributions
+    alignas(CACHE_LINE) T feq[LT::ND] = {0.0};
+
+    lattice::Equilibrium<LT>(rho, u, v, w, feq);
+
+    /// collision and streaming
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr = n*LT::OFF + d;
+            pop.Store(pop. template IndexWrite<odd>(x_n,y_n,z_n,n,d,p), n, d, f[curr] + pop.OMEGA_*(feq[curr] - f[curr]));
+        }
+    }
+}
+
 
 /**\fn            CollideStreamBGK
  * \brief         BGK collision operator for arbitrary lattice
@@ -25,118 +113,237 @@
  *                DOI: 10.1103/PhysRev.94.511
  *
  * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
  * \tparam        NX     simulation domain resolution in x-direction
  * \tparam        NY     simulation domain resolution in y-direction
  * \tparam        NZ     simulation domain resolution in z-direction
  * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP   number of populations stored side by side in the lattice
+ * \tparam        LY     memory layout policy of the populations
+ * \tparam        ST     storage policy of the populations
+ * \tparam        SP     streaming policy of the populations
  * \tparam        T      floating data type used for simulation
  * \param[out]    con    continuum object holding macroscopic variables
  * \param[in,out] pop    population object holding microscopic variables
- * \param[in]     save   save current macroscopic values to disk (Boolean true/false)
  * \param[in]     p      relevant population (default = 0)
 */
-template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void CollideStreamBGK(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT>& pop, bool const save = false, unsigned int const p = 0)
+template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void CollideStreamBGK(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const p = 0)
 {
-    #pragma omp parallel for default(none) shared(con, pop) firstprivate(save,p) schedule(static,1)
+    #pragma omp parallel for default(none) shared(con, pop) firstprivate(p) schedule(static,1)
     for(unsigned int block = 0; block < pop.NUM_BLOCKS_; ++block)
     {
+        PROFILE_WORK();
+
         unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
         unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
 
-        for(unsigned int z = z_start; z < z_end; ++z)
+        DispatchIsa([&](auto const)
         {
-            unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
-
-            unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
-            unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
-
-            for(unsigned int y = y_start; y < y_end; ++y)
+            for(unsigned int z = z_start; z < z_end; ++z)
             {
-                unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+                unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
 
-                unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
-                unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+                unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
 
-                for(unsigned int x = x_start; x < x_end; ++x)
+                for(unsigned int y = y_start; y < y_end; ++y)
                 {
-                    unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+                    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
 
-                    /// load distributions
-                    alignas(CACHE_LINE) T f[LT::ND] = {0.0};
+                    unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
+                    unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
 
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
+                    for(unsigned int x = x_start; x < x_end; ++x)
                     {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = n; d < LT::HSPEED; ++d)
-                        {
-                            f[n*LT::OFF + d] = pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)];
-                        }
-                    }
+                        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
 
-                    /// macroscopic values
-                    T rho = 0.0;
-                    T u   = 0.0;
-                    T v   = 0.0;
-                    T w   = 0.0;
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
-                    {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = n; d < LT::HSPEED; ++d)
-                        {
-                            unsigned int const curr = n*LT::OFF + d;
-                            rho += f[curr];
-                            u   += f[curr]*LT::DX[curr];
-                            v   += f[curr]*LT::DY[curr];
-                            w   += f[curr]*LT::DZ[curr];
-                        }
+                        CollideStreamBGK_Node<odd,save>(con, pop, x_n, y_n, z_n, p);
                     }
-                    u /= rho;
-                    v /= rho;
-                    w /= rho;
+                }
+            }
+        });
+    }
+}
 
-                    if (save == true)
-                    {
-                        con(x, y, z, 0) = rho;
-                        con(x, y, z, 1) = u;
-                        con(x, y, z, 2) = v;
-                        con(x, y, z, 3) = w;
-                    }
 
-                    /// equilibrium distributions
-                    alignas(CACHE_LINE) T feq[LT::ND] = {0.0};
+/**\fn            CollideStreamBGK
+ * \brief         BGK collision operator for arbitrary lattice
+ *                only sweeping over the fluid cells given by an indirect fluid cell list. Links towards
+ *                solid cells are bounced back directly after the collision of every cell and fused
+ *                boundaries are applied at the beginning of every block.
+ * \note          "A Model for Collision Processes in Gases. I. Small Amplitude Processes in Charged
+ *                and Neutral One-Component Systems"
+ *                P.L. Bhatnagar, E.P. Gross, M. Krook
+ *                Physical Review 94 (1954)
+ *                DOI: 10.1103/PhysRev.94.511
+ *
+ * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        NX     simulation domain resolution in x-direction
+ * \tparam        NY     simulation domain resolution in y-direction
+ * \tparam        NZ     simulation domain resolution in z-direction
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP   number of populations stored side by side in the lattice
+ * \tparam        LY     memory layout policy of the populations
+ * \tparam        ST     storage policy of the populations
+ * \tparam        SP     streaming policy of the populations
+ * \tparam        T      floating data type used for simulation
+ * \tparam        BC     types of the fused boundaries (e.g. FusedGuo)
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] pop    population object holding microscopic variables
+ * \param[in]     fluid  fluid cell list holding all fluid cells and their neighbours
+ * \param[in]     p      relevant population (default = 0)
+ * \param[in]     boundaries fused boundaries applied within the collision sweep (optional)
+*/
+template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T, class... BC>
+void CollideStreamBGK(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, FluidCells<NX,NY,NZ> const& fluid,
+                      unsigned int const p = 0, BC const&... boundaries)
+{
+    std::tuple<BC const&...> const fused(boundaries...);
+
+    #pragma omp parallel for default(none) shared(con, pop, fluid, fused) firstprivate(p) schedule(static,1)
+    for(unsigned int block = 0; block < fluid.NUM_BLOCKS_; ++block)
+    {
+        PROFILE_WORK();
 
-                    T const uu = - 1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w);
+        ApplyBlockBoundaries<odd>(fused, pop, block, p);
 
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
-                    {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = n; d < LT::HSPEED; ++d)
-                        {
-                            unsigned int const curr = n*LT::OFF + d;
-                            T const cu = 1.0/(LT::CS*LT::CS)*(u*LT::DX[curr] + v*LT::DY[curr] + w*LT::DZ[curr]);
-                            feq[curr] = LT::W[curr]*(rho + rho*(cu*(1.0 + 0.5*cu) + uu));
-                        }
-                    }
+        DispatchIsa([&](auto const)
+        {
+            for(size_t i = fluid.BlockBegin(block); i < fluid.BlockEnd(block); ++i)
+            {
+                fluidCell const& cell = fluid.cells_[i];
+                CollideStreamBGK_Node<odd,save>(con, pop, cell.x_n, cell.y_n, cell.z_n, p);
+                BounceBackLinks<odd>(cell, pop, p);
+            }
+        });
+    }
+}
 
-                    /// collision and streaming
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
-                    {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = n; d < LT::HSPEED; ++d)
-                        {
-                            unsigned int const curr = n*LT::OFF + d;
-                            pop.F_[pop. template AA_IndexWrite<odd>(x_n,y_n,z_n,n,d,p)] = f[curr] + pop.OMEGA_*(feq[curr] - f[curr]);
-                        }
-                    }
+/**\fn            CollideStreamBGK
+ * \brief         BGK collision operator for arbitrary lattice
+ *                only sweeping over the fluid cells given by an indirect fluid cell list with the blocks
+ *                distributed to the threads by a work-stealing scheduler. Links towards solid cells are
+ *                bounced back directly after the collision of every cell and fused boundaries are applied
+ *                at the beginning of every block.
+ *
+ * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        NX     simulation domain resolution in x-direction
+ * \tparam        NY     simulation domain resolution in y-direction
+ * \tparam        NZ     simulation domain resolution in z-direction
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP   number of populations stored side by side in the lattice
+ * \tparam        LY     memory layout policy of the populations
+ * \tparam        ST     storage policy of the populations
+ * \tparam        SP     streaming policy of the populations
+ * \tparam        T      floating data type used for simulation
+ * \tparam        BC     types of the fused boundaries (e.g. FusedGuo)
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] pop    population object holding microscopic variables
+ * \param[in]     fluid  fluid cell list holding all fluid cells and their neighbours
+ * \param[in,out] scheduler  work-stealing scheduler for the blocks of the fluid cell list
+ * \param[in]     p      relevant population (default = 0)
+ * \param[in]     boundaries fused boundaries applied within the collision sweep (optional)
+*/
+template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T, class... BC>
+void CollideStreamBGK(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, FluidCells<NX,NY,NZ> const& fluid,
+                      BlockScheduler<NX,NY,NZ>& scheduler, unsigned int const p = 0, BC const&... boundaries)
+{
+    std::tuple<BC const&...> const fused(boundaries...);
+    scheduler.Reset();
+
+    #pragma omp parallel default(none) shared(con, pop, fluid, scheduler, fused) firstprivate(p)
+    {
+        unsigned int block = 0;
+        while (scheduler.Next(block) == true)
+        {
+            PROFILE_WORK();
+
+            ApplyBlockBoundaries<odd>(fused, pop, block, p);
+
+            DispatchIsa([&](auto const)
+            {
+                for(size_t i = fluid.BlockBegin(block); i < fluid.BlockEnd(block); ++i)
+                {
+                    fluidCell const& cell = fluid.cells_[i];
+                    CollideStreamBGK_Node<odd,save>(con, pop, cell.x_n, cell.y_n, cell.z_n, p);
+                    BounceBackLinks<odd>(cell, pop, p);
                 }
-            }
+            });
         }
     }
 }
 
+/**\fn            CollideStreamBGK
+ * \brief         BGK collision operator for arbitrary lattice
+ *                advancing several consecutive time steps at once with a temporally blocked wavefront
+ *                (see Wavefront). Links towards solid cells are bounced back directly after the collision
+ *                of every cell and fused boundaries are applied at the beginning of every plane.
+ *
+ * \tparam        save   save macroscopic values of the last time step to disk (Boolean true/false)
+ * \tparam        NX     simulation domain resolution in x-direction
+ * \tparam        NY     simulation domain resolution in y-direction
+ * \tparam        NZ     simulation domain resolution in z-direction
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP   number of populations stored side by side in the lattice
+ * \tparam        LY     memory layout policy of the populations
+ * \tparam        ST     storage policy of the populations
+ * \tparam        SP     streaming policy of the populations
+ * \tparam        T      floating data type used for simulation
+ * \tparam        BC     types of the fused boundaries (e.g. FusedGuo)
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] pop    population object holding microscopic variables
+ * \param[in]     wavefront  fluid cells sorted by planes and number of time steps per tile
+ * \param[in]     p      relevant population (default = 0)
+ * \param[in]     boundaries fused boundaries applied within the wavefront (optional)
+*/
+template <bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T, class... BC>
+void CollideStreamBGK(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, Wavefront<NX,NY,NZ> const& wavefront,
+                      unsigned int const p = 0, BC const&... boundaries)
+{
+    auto const node = [&con, &pop, p](auto const odd, fluidCell const& cell, auto const isLast)
+    {
+        CollideStreamBGK_Node<decltype(odd)::value, save && decltype(isLast)::value>(con, pop, cell.x_n, cell.y_n, cell.z_n, p);
+    };
+    wavefront.Advance(pop, node, p, boundaries...);
+}
+
+/**\fn            CollideStreamBGK
+ * \brief         BGK collision operator for arbitrary lattice
+ *                advancing several consecutive time steps in a single parallel region with point-to-point
+ *                dependencies between neighbouring blocks (see BlockPipeline). Links towards solid cells are
+ *                bounced back directly after the collision of every cell and fused boundaries are applied at
+ *                the beginning of every block.
+ *
+ * \tparam        save   save macroscopic values of the last time step to disk (Boolean true/false)
+ * \tparam        NX     simulation domain resolution in x-direction
+ * \tparam        NY     simulation domain resolution in y-direction
+ * \tparam        NZ     simulation domain resolution in z-direction
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP   number of populations stored side by side in the lattice
+ * \tparam        LY     memory layout policy of the populations
+ * \tparam        ST     storage policy of the populations
+ * \tparam        SP     streaming policy of the populations
+ * \tparam        T      floating data type used for simulation
+ * \tparam        BC     types of the fused boundaries (e.g. FusedGuo)
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] pop    population object holding microscopic variables
+ * \param[in,out] pipeline   fluid cells and progress of their blocks
+ * \param[in]     steps  number of consecutive time steps (even)
+ * \param[in]     p      relevant population (default = 0)
+ * \param[in]     boundaries fused boundaries applied within the blocks (optional)
+*/
+template <bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T, class... BC>
+void CollideStreamBGK(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, BlockPipeline<NX,NY,NZ>& pipeline,
+                      size_t const steps, unsigned int const p = 0, BC const&... boundaries)
+{
+    auto const node = [&con, &pop, p](auto const odd, fluidCell const& cell, auto const isLast)
+    {
+        CollideStreamBGK_Node<decltype(odd)::value, save && decltype(isLast)::value>(con, pop, cell.x_n, cell.y_n, cell.z_n, p);
+    };
+    pipeline.Advance(pop, node, steps, p, boundaries...);
+}
+
 #endif //COLLISION_BGK_HPP_INCLUDED
@@ -9,16 +9,24 @@
 
 #include <algorithm>
 #include <cmath>
+#include <tuple>
+#include <type_traits>
 #if __has_include (<omp.h>)
     #include <omp.h>
 #endif
 
+#include "../../general/cpu_dispatch.hpp"
 #include "../../general/memory_alignment.hpp"
 #include "../../continuum/continuum.hpp"
+#include "../boundary/boundary_bounceback.hpp"
+#include "../fluid_cells.hpp"
 #include "../population.hpp"
+#include "../population_layout.hpp"
+#include "../population_streaming.hpp"
+#include "memory_hints.hpp"
 
 
-#ifdef __AVX2__
+#ifdef ISA_TARGET_AVX2
 
 #include <immintrin.h>
 
@@ -33,12 +41,153 @@
  * \param[in] _a: a 256bit AVX2 intrinsic with 4 double numbers
  * \return    The horizontally added intrinsic as a double number
 */
-static inline double __attribute__((always_inline)) _mm256_reduce_add_pd(__m256d const _a)
+static inline double ISA_TARGET_AVX2 __attribute__((always_inline)) _mm256_reduce_add_pd(__m256d const _a)
 {
     __m256d const _sum = _mm256_hadd_pd(_a, _a);
     return ((double*)&_sum)[0] + ((double*)&_sum)[2];
 }
 
+/**\fn            CollideStreamBGK_AVX2_Node
+ * \brief         BGK collision operator for arbitrary cache-aligned lattices with AVX2 intrinsics (single lattice node)
+ * \warning       Inline function! Has to be declared in header!
+ * \note          "A Model for Collision Processes in Gases. I. Small Amplitude Processes in Charged
+ *                and Neutral One-Component Systems"
+ *                P.L. Bhatnagar, E.P. Gross, M. Krook
+ *                Physical Review 94 (1954)
+ *                DOI: 10.1103/PhysRev.94.511
+ *
+ * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        MH     memory access hints: non-temporal stores and prefetch distance (hint::MemoryHints)
+ * \tparam        NX     simulation domain resolution in x-direction
+ * \tparam        NY     simulation domain resolution in y-direction
+ * \tparam        NZ     simulation domain resolution in z-direction
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP   number of populations stored side by side in the lattice
+ * \tparam        LY     memory layout policy of the populations
+ * \tparam        ST     storage policy of the populations
+ * \tparam        SP     streaming policy of the populations
+ * \tparam        T      floating data type used for simulation
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] pop    population object holding microscopic variables
+ * \param[in]     x_n    x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]     y_n    y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]     z_n    z coordinates of current cell and its neighbours [z-1,z,z+1]
+ * \param[in]     p      relevant population
+*/
+template <bool odd, bool save, class MH, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+inline void ISA_TARGET_AVX2 __attribute__((always_inline)) CollideStreamBGK_AVX2_Node(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop,
+                                                                      unsigned int const (&x_n)[3], unsigned int const (&y_n)[3], unsigned int const (&z_n)[3],
+                                                                      unsigned int const p)
+{
+    /// load distributions
+    alignas(CACHE_LINE) double f[LT::ND] = {0.0};
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            f[n*LT::OFF + d] = pop.Load(pop. template IndexRead<odd>(x_n,y_n,z_n,n,d,p), n, d);
+        }
+    }
+
+    /// macroscopic values
+    __m256d _rho = _mm256_setzero_pd();
+    __m256d _u   = _mm256_setzero_pd();
+    __m256d _v   = _mm256_setzero_pd();
+    __m256d _w   = _mm256_setzero_pd();
+
+    for (size_t i = 0; i < LT::ND; i += AVX2_REG_SIZE)
+    {
+        _rho = _mm256_add_pd(_mm256_load_pd(&f[i]), _rho);
+        _u   = _mm256_fmadd_pd(_mm256_load_pd(&LT::DX[i]), _mm256_load_pd(&f[i]), _u);
+        _v   = _mm256_fmadd_pd(_mm256_load_pd(&LT::DY[i]), _mm256_load_pd(&f[i]), _v);
+        _w   = _mm256_fmadd_pd(_mm256_load_pd(&LT::DZ[i]), _mm256_load_pd(&f[i]), _w);
+    }
+
+    double const rho = _mm256_reduce_add_pd(_rho);
+    double const u   = _mm256_reduce_add_pd(_u)/rho;
+    double const v   = _mm256_reduce_add_pd(_v)/rho;
+    double const w   = _mm256_reduce_add_pd(_w)/rho;
+
+    if constexpr (save == true)
+    {
+        con(x_n[1], y_n[1], z_n[1], 0) = rho;
+        con(x_n[1], y_n[1], z_n[1], 1) = u;
+        con(x_n[1], y_n[1], z_n[1], 2) = v;
+        con(x_n[1], y_n[1], z_n[1], 3) = w;
+    }
+
+    /// equilibrium distributions
+    alignas(CACHE_LINE) double feq[LT::ND] = {0.0};
+
+    __m256d const _uu = _mm256_set1_pd(-1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w));
+    _rho = _mm256_set1_pd(rho);
+    _u   = _mm256_set1_pd(u);
+    _v   = _mm256_set1_pd(v);
+    _w   = _mm256_set1_pd(w);
+
+    for (size_t i = 0; i < LT::ND; i += AVX2_REG_SIZE)
+    {
+        __m256d _cu = _mm256_mul_pd(_mm256_load_pd(&LT::DX[i]), _u);
+        _cu = _mm256_fmadd_pd(_mm256_load_pd(&LT::DY[i]), _v, _cu);
+        _cu = _mm256_fmadd_pd(_mm256_load_pd(&LT::DZ[i]), _w, _cu);
+        _cu = _mm256_mul_pd(_cu, _mm256_set1_pd(1.0/(LT::CS*LT::CS)));
+
+        __m256d _res = _mm256_fmadd_pd(_mm256_set1_pd(0.5), _cu, _mm256_set1_pd(1.0));
+        _res = _mm256_fmadd_pd(_cu, _res, _uu);
+
+        _res = _mm256_fmadd_pd(_res, _rho, _rho);
+        _res = _mm256_mul_pd(_mm256_load_pd(&LT::W[i]), _res);
+        _mm256_store_pd(&feq[i], _res);
+    }
+
+    /// collision
+    for (size_t i = 0; i < LT::ND; i += AVX2_REG_SIZE)
+    {
+        __m256d _res = _mm256_sub_pd(_mm256_load_pd(&feq[i]), _mm256_load_pd(&f[i]));
+        _res = _mm256_fmadd_pd(_mm256_set1_pd(pop.OMEGA_), _res, _mm256_load_pd(&f[i]));
+        _mm256_store_pd(&f[i], _mm256_mul_pd(_mm256_load_pd(&LT::MASK[i]), _res));
+    }
+
+    /// streaming: in even time steps of the A-A pattern the cell itself is a contiguous and aligned destination
+    constexpr bool isNative = std::is_same<ST, storage::Native>::value && std::is_same<T, double>::value;
+    constexpr bool isLocal  = (odd == false) && std::is_same<SP, streaming::AA>::value && std::is_same<LY, layout::AoS>::value && (NPOP == 1);
+
+    if constexpr ((MH::STREAM == true) && (isNative == true) && (isLocal == true))
+    {
+        static_assert(LT::ND % (AVX2_REG_SIZE) == 0, "Non-temporal stores require a padding to the size of the intrinsics.");
+        double* const address = &pop.F_[pop. template IndexWrite<odd>(x_n,y_n,z_n,0,0,p)];
+        for (size_t i = 0; i < LT::ND; i += AVX2_REG_SIZE)
+        {
+            _mm256_stream_pd(address + i, _mm256_load_pd(&f[i]));
+        }
+    }
+    else
+    {
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                size_t const curr = n*LT::OFF + d;
+                if constexpr ((MH::STREAM == true) && (isNative == true))
+                {
+                    StreamStore(&pop.F_[pop. template IndexWrite<odd>(x_n,y_n,z_n,n,d,p)], f[curr]);
+                }
+                else
+                {
+                    pop.Store(pop. template IndexWrite<odd>(x_n,y_n,z_n,n,d,p), n, d, f[curr]);
+                }
+            }
+        }
+    }
+}
+
+
 /**\fn            CollideStreamBGK_AVX2
  * \brief         BGK collision operator for arbitrary cache-aligned lattices with AVX2 intrinsics
  * \note          "A Model for Collision Processes in Gases. I. Small Amplitude Processes in Charged
@@ -48,20 +197,25 @@ static inline double __attribute__((always_inline)) _mm256_reduce_add_pd(__m256d
  *                DOI: 10.1103/PhysRev.94.511
  *
  * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        MH     memory access hints: non-temporal stores and prefetch distance (hint::MemoryHints)
  * \tparam        NX     simulation domain resolution in x-direction
  * \tparam        NY     simulation domain resolution in y-direction
  * \tparam        NZ     simulation domain resolution in z-direction
  * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP   number of populations stored side by side in the lattice
+ * \tparam        LY     memory layout policy of the populations
+ * \tparam        ST     storage policy of the populations
+ * \tparam        SP     streaming policy of the populations
  * \tparam        T      floating data type used for simulation
  * \param[out]    con    continuum object holding macroscopic variables
  * \param[in,out] pop    population object holding microscopic variables
- * \param[in]     save   save current macroscopic values to disk (Boolean true/false)
  * \param[in]     p      relevant population (default = 0)
 */
-template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void CollideStreamBGK_AVX2(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT>& pop, bool const save = false, unsigned int const p = 0)
+template <bool odd, bool save = false, class MH = hint::Cached, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void ISA_TARGET_AVX2 CollideStreamBGK_AVX2(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const p = 0)
 {
-    #pragma omp parallel for default(none) shared(con, pop) firstprivate(save,p) schedule(static,1)
+    #pragma omp parallel for default(none) shared(con, pop) firstprivate(p) schedule(static,1)
     for(unsigned int block = 0; block < pop.NUM_BLOCKS_; ++block)
     {
         unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
@@ -85,95 +239,84 @@ void CollideStreamBGK_AVX2(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT>&
                 {
                     unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
 
-                    /// load distributions
-                    alignas(CACHE_LINE) double f[LT::ND] = {0.0};
-
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
-                    {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = 0; d < LT::OFF; ++d)
-                        {
-                            f[n*LT::OFF + d] = pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)];
-                        }
-                    }
-
-                    /// macroscopic values
-                    __m256d _rho = _mm256_setzero_pd();
-                    __m256d _u   = _mm256_setzero_pd();
-                    __m256d _v   = _mm256_setzero_pd();
-                    __m256d _w   = _mm256_setzero_pd();
-
-                    for (size_t i = 0; i < LT::ND; i += AVX2_REG_SIZE)
-                    {
-                        _rho = _mm256_add_pd(_mm256_load_pd(&f[i]), _rho);
-                        _u   = _mm256_fmadd_pd(_mm256_load_pd(&LT::DX[i]), _mm256_load_pd(&f[i]), _u);
-                        _v   = _mm256_fmadd_pd(_mm256_load_pd(&LT::DY[i]), _mm256_load_pd(&f[i]), _v);
-                        _w   = _mm256_fmadd_pd(_mm256_load_pd(&LT::DZ[i]), _mm256_load_pd(&f[i]), _w);
-                    }
-
-                    double const rho = _mm256_reduce_add_pd(_rho);
-                    double const u   = _mm256_reduce_add_pd(_u)/rho;
-                    double const v   = _mm256_reduce_add_pd(_v)/rho;
-                    double const w   = _mm256_reduce_add_pd(_w)/rho;
-
-                    if (save == true)
-                    {
-                        con(x, y, z, 0) = rho;
-                        con(x, y, z, 1) = u;
-                        con(x, y, z, 2) = v;
-                        con(x, y, z, 3) = w;
-                    }
-
-                    /// equilibrium distributions
-                    alignas(CACHE_LINE) double feq[LT::ND] = {0.0};
-
-                    __m256d const _uu = _mm256_set1_pd(-1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w));
-                    _rho = _mm256_set1_pd(rho);
-                    _u   = _mm256_set1_pd(u);
-                    _v   = _mm256_set1_pd(v);
-                    _w   = _mm256_set1_pd(w);
-
-                    for (size_t i = 0; i < LT::ND; i += AVX2_REG_SIZE)
-                    {
-                        __m256d _cu = _mm256_mul_pd(_mm256_load_pd(&LT::DX[i]), _u);
-                        _cu = _mm256_fmadd_pd(_mm256_load_pd(&LT::DY[i]), _v, _cu);
-                        _cu = _mm256_fmadd_pd(_mm256_load_pd(&LT::DZ[i]), _w, _cu);
-                        _cu = _mm256_mul_pd(_cu, _mm256_set1_pd(1.0/(LT::CS*LT::CS)));
-
-                        __m256d _res = _mm256_fmadd_pd(_mm256_set1_pd(0.5), _cu, _mm256_set1_pd(1.0));
-                        _res = _mm256_fmadd_pd(_cu, _res, _uu);
-
-                        _res = _mm256_fmadd_pd(_res, _rho, _rho);
-                        _res = _mm256_mul_pd(_mm256_load_pd(&LT::W[i]), _res);
-                        _mm256_store_pd(&feq[i], _res);
-                    }
-
-                    /// collision
-                    for (size_t i = 0; i < LT::ND; i += AVX2_REG_SIZE)
-                    {
-                        __m256d _res = _mm256_sub_pd(_mm256_load_pd(&feq[i]), _mm256_load_pd(&f[i]));
-                        _res = _mm256_fmadd_pd(_mm256_set1_pd(pop.OMEGA_), _res, _mm256_load_pd(&f[i]));
-                        _mm256_store_pd(&f[i], _mm256_mul_pd(_mm256_load_pd(&LT::MASK[i]), _res));
-                    }
-
-                    /// streaming
-                    #pragma GCC unroll (2)
-                    for(unsigned int n = 0; n <= 1; ++n)
-                    {
-                        #pragma GCC unroll (16)
-                        for(unsigned int d = 0; d < LT::OFF; ++d)
-                        {
-                            size_t const curr = n*LT::OFF + d;
-                            pop.F_[pop. template AA_IndexWrite<odd>(x_n,y_n,z_n,n,d,p)] = f[curr];
-                        }
-                    }
+                    PrefetchCells<odd,MH>(pop, x + MH::PREFETCH, y_n, z_n, p);
+                    CollideStreamBGK_AVX2_Node<odd,save,MH>(con, pop, x_n, y_n, z_n, p);
+                }
+            }
+        }
+
+        if constexpr (MH::STREAM == true)
+        {
+            StreamFence();
+        }
+    }
+}
+
+
+/**\fn            CollideStreamBGK_AVX2
+ * \brief         BGK collision operator for arbitrary cache-aligned lattices with AVX2 intrinsics
+ *                only sweeping over the fluid cells given by an indirect fluid cell list. Links towards
+ *                solid cells are bounced back directly after the collision of every cell and fused
+ *                boundaries are applied at the beginning of every block.
+ * \note          "A Model for Collision Processes in Gases. I. Small Amplitude Processes in Charged
+ *                and Neutral One-Component Systems"
+ *                P.L. Bhatnagar, E.P. Gross, M. Krook
+ *                Physical Review 94 (1954)
+ *                DOI: 10.1103/PhysRev.94.511
+ *
+ * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        MH     memory access hints: non-temporal stores and prefetch distance (hint::MemoryHints)
+ * \tparam        NX     simulation domain resolution in x-direction
+ * \tparam        NY     simulation domain resolution in y-direction
+ * \tparam        NZ     simulation domain resolution in z-direction
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP   number of populations stored side by side in the lattice
+ * \tparam        LY     memory layout policy of the populations
+ * \tparam        ST     storage policy of the populations
+ * \tparam        SP     streaming policy of the populations
+ * \tparam        T      floating data type used for simulation
+ * \tparam        BC     types of the fused boundaries (e.g. FusedGuo)
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] pop    population object holding microscopic variables
+ * \param[in]     fluid  fluid cell list holding all fluid cells and their neighbours
+ * \param[in]     p      relevant population (default = 0)
+ * \param[in]     boundaries fused boundaries applied within the collision sweep (optional)
+*/
+template <bool odd, bool save = false, class MH = hint::Cached, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T, class... BC>
+void ISA_TARGET_AVX2 CollideStreamBGK_AVX2(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, FluidCells<NX,NY,NZ> const& fluid,
+                           unsigned int const p = 0, BC const&... boundaries)
+{
+    std::tuple<BC const&...> const fused(boundaries...);
+
+    #pragma omp parallel for default(none) shared(con, pop, fluid, fused) firstprivate(p) schedule(static,1)
+    for(unsigned int block = 0; block < fluid.NUM_BLOCKS_; ++block)
+    {
+        ApplyBlockBoundaries<odd>(fused, pop, block, p);
+
+        for(size_t i = fluid.BlockBegin(block); i < fluid.BlockEnd(block); ++i)
+        {
+            if constexpr (MH::PREFETCH > 0)
+            {
+                if (i + MH::PREFETCH < fluid.BlockEnd(block))
+                {
+                    fluidCell const& ahead = fluid.cells_[i + MH::PREFETCH];
+                    PrefetchCells<odd,MH>(pop, ahead.x_n[1], ahead.y_n, ahead.z_n, p);
                 }
             }
+
+            fluidCell const& cell = fluid.cells_[i];
+            CollideStreamBGK_AVX2_Node<odd,save,MH>(con, pop, cell.x_n, cell.y_n, cell.z_n, p);
+            BounceBackLinks<odd>(cell, pop, p);
+        }
+
+        if constexpr (MH::STREAM == true)
+        {
+            StreamFence();
         }
     }
 }
 
-#endif // __AVX2__
+#endif // ISA_TARGET_AVX2
 
 #endif // COLLISION_BGK_AVX2_HPP_INCLUDED
@@ -0,0 +1,402 @@
+#ifndef COLLISION_BGK_AVX512_SOA_HPP_INCLUDED
+#define COLLISION_BGK_AVX512_SOA_HPP_INCLUDED
+
+/**
+ * \file     collision_bgk_avx512_soa.hpp
+ * \mainpage BGK collision operator with AVX512 intrinsics vectorised across neighbouring cells
+ * \warning  Requires AVX512 (see IsIsaSupported), cache-aligned arrays and a population with structure-of-arrays
+ *           (layout::SoA) or array-of-structures-of-arrays (layout::AoSoA<8>) memory layout
+ * \note     Same scheme as the AVX2 kernel across cells but eight consecutive cells in x-direction are
+ *           processed at once. An AoSoA block of eight doubles fills exactly one cache line, the aligned
+ *           chunks are therefore loaded and stored as a whole and the chunks shifted by a neighbour are
+ *           assembled from two neighbouring blocks with a single two-source permutation.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../../general/cpu_dispatch.hpp"
+#include "../../general/memory_alignment.hpp"
+#include "../../continuum/continuum.hpp"
+#include "../population.hpp"
+#include "../population_layout.hpp"
+#include "../population_streaming.hpp"
+#include "collision_bgk.hpp"
+#include "memory_hints.hpp"
+
+
+#ifdef ISA_TARGET_AVX512
+
+#if __has_include (<zmmintrin.h>)
+    #include <zmmintrin.h>
+#else
+    #include <immintrin.h>
+#endif
+
+/// number of doubles in an AVX512 intrinsic and therefore number of cells collided at once
+#define AVX512_SOA_CELLS     8
+
+
+/**\fn        AVX512_SoA_Shift
+ * \brief     Shift in x-direction of the cells a direction is read from or written to with respect to
+ *            the current cells: the neighbours in odd time steps of the A-A pattern and the neighbours
+ *            in the positive directions with the esoteric pull
+ * \warning   Inline function! Has to be declared in header!
+ *
+ * \tparam    odd       even (0, false) or odd (1, true) time step
+ * \tparam    isWrite   shift after (true) or before (false) collision
+ * \tparam    LT        static lattice::DdQq class containing discretisation parameters
+ * \tparam    SP        streaming policy of the populations
+ * \param[in] n         positive (0) or negative (1) index/lattice velocity
+ * \param[in] d         relevant population index
+ * \return    shift in x-direction (-1, 0, +1)
+*/
+template <bool odd, bool isWrite, class LT, class SP>
+static inline int __attribute__((always_inline)) AVX512_SoA_Shift(unsigned int const n, unsigned int const d)
+{
+    if constexpr (std::is_same<SP, streaming::EsotericPull>::value == true)
+    {
+        bool const isNeighbour = (isWrite == true) ? (n == 0) : (n == 1);
+        return (isNeighbour == true) ? static_cast<int>(LT::DX[d]) : 0;
+    }
+    else
+    {
+        unsigned int const m = (isWrite == true) ? n : !n;
+        return (odd == true) ? static_cast<int>(LT::DX[m*LT::OFF + d]) : 0;
+    }
+}
+
+/**\fn        AVX512_SoA_Load
+ * \brief     Load a single direction of eight consecutive cells in x-direction starting at
+ *            a given address with a certain shift in x-direction
+ * \warning   Inline function! Has to be declared in header!
+ *
+ * \tparam    LY       memory layout policy of the populations
+ * \param[in] address  address of the population of the first of the eight cells
+ * \param[in] dx       shift of the first cell in x-direction (-1, 0, +1) with respect to the AoSoA block
+ * \param[in] stride   distance between two neighbouring AoSoA blocks in x-direction
+ * \return    intrinsic holding the direction of the eight cells
+*/
+template <class LY>
+static inline __m512d ISA_TARGET_AVX512 __attribute__((always_inline)) AVX512_SoA_Load(double const* const address, int const dx, size_t const stride)
+{
+    if (std::is_same<LY, layout::SoA>::value == true)
+    {
+        return _mm512_loadu_pd(address);
+    }
+
+    if (dx == 0)
+    {
+        return _mm512_load_pd(address);
+    }
+    else if (dx > 0)
+    {
+        /// lanes 1-7 of current and lane 0 of next block
+        __m512d const _curr = _mm512_load_pd(address - 1);
+        __m512d const _next = _mm512_load_pd(address - 1 + stride);
+        return _mm512_permutex2var_pd(_curr, _mm512_set_epi64(8, 7, 6, 5, 4, 3, 2, 1), _next);
+    }
+    else
+    {
+        /// lane 7 of previous and lanes 0-6 of current block
+        __m512d const _curr = _mm512_load_pd(address - (AVX512_SOA_CELLS - 1) + stride);
+        __m512d const _prev = _mm512_load_pd(address - (AVX512_SOA_CELLS - 1));
+        return _mm512_permutex2var_pd(_prev, _mm512_set_epi64(14, 13, 12, 11, 10, 9, 8, 7), _curr);
+    }
+}
+
+/**\fn        AVX512_SoA_Store
+ * \brief     Store a single direction of eight consecutive cells in x-direction starting at
+ *            a given address with a certain shift in x-direction
+ * \warning   Inline function! Has to be declared in header!
+ *
+ * \tparam    LY       memory layout policy of the populations
+ * \tparam    NT       use non-temporal stores for aligned chunks (Boolean true/false)
+ * \param[in] address  address of the population of the first of the eight cells
+ * \param[in] _f       intrinsic holding the direction of the eight cells
+ * \param[in] dx       shift of the first cell in x-direction (-1, 0, +1) with respect to the AoSoA block
+ * \param[in] stride   distance between two neighbouring AoSoA blocks in x-direction
+*/
+template <class LY, bool NT = false>
+static inline void ISA_TARGET_AVX512 __attribute__((always_inline)) AVX512_SoA_Store(double* const address, __m512d const _f, int const dx, size_t const stride)
+{
+    if (std::is_same<LY, layout::SoA>::value == true)
+    {
+        if ((NT == true) && (reinterpret_cast<uintptr_t>(address) % (AVX512_SOA_CELLS*sizeof(double)) == 0))
+        {
+            _mm512_stream_pd(address, _f);
+        }
+        else
+        {
+            _mm512_storeu_pd(address, _f);
+        }
+    }
+    else if (dx == 0)
+    {
+        if (NT == true)
+        {
+            _mm512_stream_pd(address, _f);
+        }
+        else
+        {
+            _mm512_store_pd(address, _f);
+        }
+    }
+    else if (dx > 0)
+    {
+        __m512d const _rot = _mm512_permutexvar_pd(_mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 7), _f);
+        _mm512_mask_store_pd(address - 1,                               0b11111110, _rot);
+        _mm512_mask_store_pd(address - 1 + stride,                      0b00000001, _rot);
+    }
+    else
+    {
+        __m512d const _rot = _mm512_permutexvar_pd(_mm512_set_epi64(0, 7, 6, 5, 4, 3, 2, 1), _f);
+        _mm512_mask_store_pd(address - (AVX512_SOA_CELLS - 1) + stride, 0b01111111, _rot);
+        _mm512_mask_store_pd(address - (AVX512_SOA_CELLS - 1),          0b10000000, _rot);
+    }
+}
+
+/**\fn            CollideStreamBGK_AVX512_SoA_Cells
+ * \brief         BGK collision operator for structure-of-arrays lattices with AVX512 intrinsics
+ *                (eight consecutive lattice nodes in x-direction)
+ * \warning       Inline function! Has to be declared in header!
+ *                The eight cells and their neighbours must not cross the periodic boundary in x-direction.
+ * \note          "A Model for Collision Processes in Gases. I. Small Amplitude Processes in Charged
+ *                and Neutral One-Component Systems"
+ *                P.L. Bhatnagar, E.P. Gross, M. Krook
+ *                Physical Review 94 (1954)
+ *                DOI: 10.1103/PhysRev.94.511
+ *
+ * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        MH     memory access hints: only the non-temporal stores are supported (hint::MemoryHints)
+ * \tparam        NX     simulation domain resolution in x-direction
+ * \tparam        NY     simulation domain resolution in y-direction
+ * \tparam        NZ     simulation domain resolution in z-direction
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP   number of populations stored side by side in the lattice
+ * \tparam        LY     memory layout policy of the populations
+ * \tparam        ST     storage policy of the populations
+ * \tparam        SP     streaming policy of the populations
+ * \tparam        T      floating data type used for simulation
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] pop    population object holding microscopic variables
+ * \param[in]     x      x coordinate of the first of the eight cells
+ * \param[in]     y_n    y coordinates of current cells and their neighbours [y-1,y,y+1]
+ * \param[in]     z_n    z coordinates of current cells and their neighbours [z-1,z,z+1]
+ * \param[in]     p      relevant population
+*/
+template <bool odd, bool save, class MH, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+inline void ISA_TARGET_AVX512 __attribute__((always_inline)) CollideStreamBGK_AVX512_SoA_Cells(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop,
+                                                                               unsigned int const x, unsigned int const (&y_n)[3], unsigned int const (&z_n)[3],
+                                                                               unsigned int const p)
+{
+    unsigned int const x_n[3] = { x - 1, x, x + 1 };
+
+    /// distance between neighbouring AoSoA blocks in x-direction
+    size_t const stride = static_cast<size_t>(NPOP)*LT::ND*AVX512_SOA_CELLS;
+
+    /// load distributions (padding is neither loaded nor stored)
+    __m512d _f[LT::ND];
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            size_t const curr = n*LT::OFF + d;
+            int    const   dx = AVX512_SoA_Shift<odd,false,LT,SP>(n, d);
+            _f[curr] = AVX512_SoA_Load<LY>(&pop.F_[pop. template IndexRead<odd>(x_n,y_n,z_n,n,d,p)], dx, stride);
+        }
+    }
+
+    /// macroscopic values
+    __m512d _rho = _mm512_setzero_pd();
+    __m512d _u   = _mm512_setzero_pd();
+    __m512d _v   = _mm512_setzero_pd();
+    __m512d _w   = _mm512_setzero_pd();
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            size_t const curr = n*LT::OFF + d;
+            _rho = _mm512_add_pd(_f[curr], _rho);
+            _u   = _mm512_fmadd_pd(_mm512_set1_pd(LT::DX[curr]), _f[curr], _u);
+            _v   = _mm512_fmadd_pd(_mm512_set1_pd(LT::DY[curr]), _f[curr], _v);
+            _w   = _mm512_fmadd_pd(_mm512_set1_pd(LT::DZ[curr]), _f[curr], _w);
+        }
+    }
+
+    __m512d const _invRho = _mm512_div_pd(_mm512_set1_pd(1.0), _rho);
+    _u = _mm512_mul_pd(_u, _invRho);
+    _v = _mm512_mul_pd(_v, _invRho);
+    _w = _mm512_mul_pd(_w, _invRho);
+
+    if constexpr (save == true)
+    {
+        alignas(AVX512_SOA_CELLS*sizeof(double)) double m[4][AVX512_SOA_CELLS];
+        _mm512_store_pd(m[0], _rho);
+        _mm512_store_pd(m[1], _u);
+        _mm512_store_pd(m[2], _v);
+        _mm512_store_pd(m[3], _w);
+
+        for(unsigned int l = 0; l < AVX512_SOA_CELLS; ++l)
+        {
+            con(x + l, y_n[1], z_n[1], 0) = m[0][l];
+            con(x + l, y_n[1], z_n[1], 1) = m[1][l];
+            con(x + l, y_n[1], z_n[1], 2) = m[2][l];
+            con(x + l, y_n[1], z_n[1], 3) = m[3][l];
+        }
+    }
+
+    /// equilibrium distributions and collision
+    __m512d _uu = _mm512_mul_pd(_u, _u);
+    _uu = _mm512_fmadd_pd(_v, _v, _uu);
+    _uu = _mm512_fmadd_pd(_w, _w, _uu);
+    _uu = _mm512_mul_pd(_mm512_set1_pd(-1.0/(2.0*LT::CS*LT::CS)), _uu);
+
+    __m512d const _omega = _mm512_set1_pd(pop.OMEGA_);
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            size_t const curr = n*LT::OFF + d;
+            __m512d _cu = _mm512_mul_pd(_mm512_set1_pd(LT::DX[curr]), _u);
+            _cu = _mm512_fmadd_pd(_mm512_set1_pd(LT::DY[curr]), _v, _cu);
+            _cu = _mm512_fmadd_pd(_mm512_set1_pd(LT::DZ[curr]), _w, _cu);
+            _cu = _mm512_mul_pd(_cu, _mm512_set1_pd(1.0/(LT::CS*LT::CS)));
+
+            __m512d _feq = _mm512_fmadd_pd(_mm512_set1_pd(0.5), _cu, _mm512_set1_pd(1.0));
+            _feq = _mm512_fmadd_pd(_cu, _feq, _uu);
+            _feq = _mm512_fmadd_pd(_feq, _rho, _rho);
+            _feq = _mm512_mul_pd(_mm512_set1_pd(LT::W[curr]), _feq);
+
+            _f[curr] = _mm512_fmadd_pd(_omega, _mm512_sub_pd(_feq, _f[curr]), _f[curr]);
+        }
+    }
+
+    /// streaming
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            size_t const curr = n*LT::OFF + d;
+            int    const   dx = AVX512_SoA_Shift<odd,true,LT,SP>(n, d);
+            AVX512_SoA_Store<LY,MH::STREAM>(&pop.F_[pop. template IndexWrite<odd>(x_n,y_n,z_n,n,d,p)], _f[curr], dx, stride);
+        }
+    }
+}
+
+/**\fn        AVX512_SoA_IsVectorisable
+ * \brief     Check if eight consecutive cells in x-direction starting at x can be collided with the
+ *            vectorised kernel (no periodic wrap-around and aligned to the AoSoA blocks)
+ *
+ * \tparam    NX   simulation domain resolution in x-direction
+ * \tparam    LY   memory layout policy of the populations
+ * \param[in] x    x coordinate of the first of the eight cells
+ * \return    Boolean true if the eight cells can be collided at once, false otherwise
+*/
+template <unsigned int NX, class LY>
+static inline bool ISA_TARGET_AVX512 __attribute__((always_inline)) AVX512_SoA_IsVectorisable(unsigned int const x)
+{
+    bool const isAligned = std::is_same<LY, layout::SoA>::value || (x % AVX512_SOA_CELLS == 0);
+    return (x > 0) && (x + AVX512_SOA_CELLS < NX) && isAligned;
+}
+
+
+/**\fn            CollideStreamBGK_AVX512_SoA
+ * \brief         BGK collision operator for structure-of-arrays lattices with AVX512 intrinsics
+ *                vectorised across eight consecutive cells in x-direction. Cells that can not be
+ *                collided in groups (periodic boundary in x-direction) fall back to the scalar kernel.
+ * \note          "A Model for Collision Processes in Gases. I. Small Amplitude Processes in Charged
+ *                and Neutral One-Component Systems"
+ *                P.L. Bhatnagar, E.P. Gross, M. Krook
+ *                Physical Review 94 (1954)
+ *                DOI: 10.1103/PhysRev.94.511
+ *
+ * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        MH     memory access hints: only the non-temporal stores are supported (hint::MemoryHints)
+ * \tparam        NX     simulation domain resolution in x-direction
+ * \tparam        NY     simulation domain resolution in y-direction
+ * \tparam        NZ     simulation domain resolution in z-direction
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP   number of populations stored side by side in the lattice
+ * \tparam        LY     memory layout policy of the populations (layout::SoA or layout::AoSoA<8>)
+ * \tparam        ST     storage policy of the populations
+ * \tparam        SP     streaming policy of the populations
+ * \tparam        T      floating data type used for simulation
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] pop    population object holding microscopic variables
+ * \param[in]     p      relevant population (default = 0)
+*/
+template <bool odd, bool save = false, class MH = hint::Cached, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void ISA_TARGET_AVX512 CollideStreamBGK_AVX512_SoA(Continuum<NX,NY,NZ,T>& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const p = 0)
+{
+    static_assert(std::is_same<LY, layout::SoA>::value || std::is_same<LY, layout::AoSoA<AVX512_SOA_CELLS>>::value,
+                  "AVX512 structure-of-arrays kernel requires layout::SoA or layout::AoSoA<8>.");
+    static_assert(std::is_same<T, double>::value, "AVX512 structure-of-arrays kernel requires double precision.");
+    static_assert(std::is_same<ST, storage::Native>::value, "AVX512 structure-of-arrays kernel requires native storage.");
+
+    #pragma omp parallel for default(none) shared(con, pop) firstprivate(p) schedule(static,1)
+    for(unsigned int block = 0; block < pop.NUM_BLOCKS_; ++block)
+    {
+        unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
+
+        for(unsigned int z = z_start; z < z_end; ++z)
+        {
+            unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+            unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
+            unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
+
+            for(unsigned int y = y_start; y < y_end; ++y)
+            {
+                unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+
+                unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+
+                unsigned int x = x_start;
+                while (x < x_end)
+                {
+                    if ((x + AVX512_SOA_CELLS <= x_end) && (AVX512_SoA_IsVectorisable<NX,LY>(x) == true))
+                    {
+                        CollideStreamBGK_AVX512_SoA_Cells<odd,save,MH>(con, pop, x, y_n, z_n, p);
+                        x += AVX512_SOA_CELLS;
+                    }
+                    else
+                    {
+                        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+                        CollideStreamBGK_Node<odd,save>(con, pop, x_n, y_n, z_n, p);
+                        ++x;
+                    }
+                }
+            }
+        }
+
+        if constexpr (MH::STREAM == true)
+        {
+            StreamFence();
+        }
+    }
+}
+
+#endif // ISA_TARGET_AVX512
+
+#endif // COLLISION_BGK_AVX512_SOA_HPP_INCLUDED
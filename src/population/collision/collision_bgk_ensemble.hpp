@@ -0,0 +1,268 @@
+#ifndef COLLISION_BGK_ENSEMBLE_HPP_INCLUDED
+#define COLLISION_BGK_ENSEMBLE_HPP_INCLUDED
+
+/**
+ * \file     collision_bgk_ensemble.hpp
+ * \mainpage BGK collision operator for an ensemble of independent simulations
+ *
+ * \note     The NPOP populations of a population object with the layout layout::Interleaved hold NPOP
+ *           independent cases of the same geometry (see ensemble.hpp). The neighbour indices are
+ *           evaluated once per lattice velocity and shared by all cases while the arithmetic is
+ *           vectorised across the cases. Each case relaxes with its own collision frequency.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <tuple>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../../general/cpu_dispatch.hpp"
+#include "../../general/instrumentation.hpp"
+#include "../../general/memory_alignment.hpp"
+#include "../../continuum/continuum.hpp"
+#include "../../lattice/equilibrium.hpp"
+#include "../boundary/boundary_bounceback.hpp"
+#include "../ensemble.hpp"
+#include "../fluid_cells.hpp"
+#include "../population.hpp"
+#include "../population_layout.hpp"
+
+
+/**\fn            CollideStreamBGK_Ensemble_Node
+ * \brief         BGK collision operator for all cases of an ensemble for arbitrary lattice (single lattice node)
+ * \warning       Inline function! Has to be declared in header!
+ *
+ * \tparam        odd     even (0, false) or odd (1, true) time step
+ * \tparam        save    save current macroscopic values to disk (Boolean true/false)
+ * \tparam        NX      simulation domain resolution in x-direction
+ * \tparam        NY      simulation domain resolution in y-direction
+ * \tparam        NZ      simulation domain resolution in z-direction
+ * \tparam        LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP    number of cases of the ensemble
+ * \tparam        ST      storage policy of the populations
+ * \tparam        SP      streaming policy of the populations
+ * \tparam        T       floating data type used for simulation
+ * \param[out]    con     continuum objects holding macroscopic variables of every case
+ * \param[in,out] pop     population object holding microscopic variables of all cases
+ * \param[in]     x_n     x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]     y_n     y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]     z_n     z coordinates of current cell and its neighbours [z-1,z,z+1]
+ * \param[in]     param   physical parameters of every case
+*/
+template <bool odd, bool save, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class ST, class SP, typename T>
+inline void __attribute__((always_inline)) CollideStreamBGK_Ensemble_Node(EnsembleArray<Continuum<NX,NY,NZ,T>,NPOP>& con,
+                                                                          Population<NX,NY,NZ,LT,NPOP,layout::Interleaved,ST,SP>& pop,
+                                                                          unsigned int const (&x_n)[3], unsigned int const (&y_n)[3], unsigned int const (&z_n)[3],
+                                                                          EnsembleParameters<NPOP,LT,T> const& param)
+{
+    /// load distributions of all cases from a single neighbour index per lattice velocity
+    alignas(CACHE_LINE) T f[LT::ND][NPOP] = {{0.0}};
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            size_t const index = pop. template IndexRead<odd>(x_n,y_n,z_n,n,d,0);
+
+            #pragma omp simd
+            for(unsigned int k = 0; k < NPOP; ++k)
+            {
+                f[n*LT::OFF + d][k] = pop.Load(index + k, n, d);
+            }
+        }
+    }
+
+    /// macroscopic values and equilibrium distributions: vectorised across the cases
+    alignas(CACHE_LINE) T feq[LT::ND][NPOP] = {{0.0}};
+    alignas(CACHE_LINE) T rho[NPOP] = {0.0};
+    alignas(CACHE_LINE) T u[NPOP]   = {0.0};
+    alignas(CACHE_LINE) T v[NPOP]   = {0.0};
+    alignas(CACHE_LINE) T w[NPOP]   = {0.0};
+
+    #pragma omp simd
+    for(unsigned int k = 0; k < NPOP; ++k)
+    {
+        ensembleLane<T,LT::ND,NPOP> const f_k   = {f,   k};
+        ensembleLane<T,LT::ND,NPOP> const feq_k = {feq, k};
+
+        lattice::Velocity<LT>(f_k, rho[k], u[k], v[k], w[k]);
+        lattice::Equilibrium<LT>(rho[k], u[k], v[k], w[k], feq_k);
+    }
+
+    if constexpr (save == true)
+    {
+        for(unsigned int k = 0; k < NPOP; ++k)
+        {
+            con[k](x_n[1], y_n[1], z_n[1], 0) = rho[k];
+            con[k](x_n[1], y_n[1], z_n[1], 1) = u[k];
+            con[k](x_n[1], y_n[1], z_n[1], 2) = v[k];
+            con[k](x_n[1], y_n[1], z_n[1], 3) = w[k];
+        }
+    }
+
+    /// collision and streaming of all cases
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr  = n*LT::OFF + d;
+            size_t       const index = pop. template IndexWrite<odd>(x_n,y_n,z_n,n,d,0);
+
+            #pragma omp simd
+            for(unsigned int k = 0; k < NPOP; ++k)
+            {
+                pop.Store(index + k, n, d, f[curr][k] + param.OMEGA_[k]*(feq[curr][k] - f[curr][k]));
+            }
+        }
+    }
+}
+
+/**\fn            ApplyEnsembleBoundaries
+ * \brief         Apply the fused boundaries of every case of an ensemble of a given block before the block is collided
+ *
+ * \tparam        odd          even (0, false) or odd (1, true) time step
+ * \tparam        NX           simulation domain resolution in x-direction
+ * \tparam        NY           simulation domain resolution in y-direction
+ * \tparam        NZ           simulation domain resolution in z-direction
+ * \tparam        LT           static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP         number of cases of the ensemble
+ * \tparam        ST           storage policy of the populations
+ * \tparam        SP           streaming policy of the populations
+ * \tparam        BC           types of the fused boundaries (e.g. FusedGuo)
+ * \param[in]     boundaries   tuple holding references to the fused boundaries of every case
+ * \param[in,out] pop          population object holding microscopic variables of all cases
+ * \param[in]     block        the block of interest
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class ST, class SP, class... BC>
+inline void ApplyEnsembleBoundaries(std::tuple<EnsembleArray<BC,NPOP> const&...> const& boundaries,
+                                    Population<NX,NY,NZ,LT,NPOP,layout::Interleaved,ST,SP>& pop, unsigned int const block)
+{
+    std::apply([&pop, block](EnsembleArray<BC,NPOP> const&... b)
+    {
+        (void)pop; (void)block;
+        for(unsigned int k = 0; k < NPOP; ++k)
+        {
+            (b[k]. template ApplyBlock<odd>(pop, block, k), ...);
+        }
+    }, boundaries);
+}
+
+
+/**\fn            CollideStreamBGK_Ensemble
+ * \brief         BGK collision operator for all cases of an ensemble for arbitrary lattice
+ *
+ * \tparam        odd     even (0, false) or odd (1, true) time step
+ * \tparam        save    save current macroscopic values to disk (Boolean true/false)
+ * \tparam        NX      simulation domain resolution in x-direction
+ * \tparam        NY      simulation domain resolution in y-direction
+ * \tparam        NZ      simulation domain resolution in z-direction
+ * \tparam        LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP    number of cases of the ensemble
+ * \tparam        ST      storage policy of the populations
+ * \tparam        SP      streaming policy of the populations
+ * \tparam        T       floating data type used for simulation
+ * \param[out]    con     continuum objects holding macroscopic variables of every case
+ * \param[in,out] pop     population object holding microscopic variables of all cases
+ * \param[in]     param   physical parameters of every case
+*/
+template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class ST, class SP, typename T>
+void CollideStreamBGK_Ensemble(EnsembleArray<Continuum<NX,NY,NZ,T>,NPOP>& con, Population<NX,NY,NZ,LT,NPOP,layout::Interleaved,ST,SP>& pop,
+                               EnsembleParameters<NPOP,LT,T> const& param)
+{
+    #pragma omp parallel for default(none) shared(con, pop, param) schedule(static,1)
+    for(unsigned int block = 0; block < pop.NUM_BLOCKS_; ++block)
+    {
+        PROFILE_WORK();
+
+        unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
+
+        DispatchIsa([&](auto const)
+        {
+            for(unsigned int z = z_start; z < z_end; ++z)
+            {
+                unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+                unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
+
+                for(unsigned int y = y_start; y < y_end; ++y)
+                {
+                    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+
+                    unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
+                    unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+
+                    for(unsigned int x = x_start; x < x_end; ++x)
+                    {
+                        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+
+                        CollideStreamBGK_Ensemble_Node<odd,save>(con, pop, x_n, y_n, z_n, param);
+                    }
+                }
+            }
+        });
+    }
+}
+
+/**\fn            CollideStreamBGK_Ensemble
+ * \brief         BGK collision operator for all cases of an ensemble for arbitrary lattice only sweeping over
+ *                the fluid cells of the shared geometry given by an indirect fluid cell list. Links towards
+ *                solid cells are bounced back for every case directly after the collision of every cell and
+ *                the fused boundaries of every case are applied at the beginning of every block.
+ *
+ * \tparam        odd     even (0, false) or odd (1, true) time step
+ * \tparam        save    save current macroscopic values to disk (Boolean true/false)
+ * \tparam        NX      simulation domain resolution in x-direction
+ * \tparam        NY      simulation domain resolution in y-direction
+ * \tparam        NZ      simulation domain resolution in z-direction
+ * \tparam        LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP    number of cases of the ensemble
+ * \tparam        ST      storage policy of the populations
+ * \tparam        SP      streaming policy of the populations
+ * \tparam        T       floating data type used for simulation
+ * \tparam        BC      types of the fused boundaries (e.g. FusedGuo)
+ * \param[out]    con     continuum objects holding macroscopic variables of every case
+ * \param[in,out] pop     population object holding microscopic variables of all cases
+ * \param[in]     fluid   fluid cell list holding all fluid cells of the shared geometry and their neighbours
+ * \param[in]     param   physical parameters of every case
+ * \param[in]     boundaries   fused boundaries with the boundary values of every case (optional)
+*/
+template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class ST, class SP, typename T, class... BC>
+void CollideStreamBGK_Ensemble(EnsembleArray<Continuum<NX,NY,NZ,T>,NPOP>& con, Population<NX,NY,NZ,LT,NPOP,layout::Interleaved,ST,SP>& pop,
+                               FluidCells<NX,NY,NZ> const& fluid, EnsembleParameters<NPOP,LT,T> const& param,
+                               EnsembleArray<BC,NPOP> const&... boundaries)
+{
+    std::tuple<EnsembleArray<BC,NPOP> const&...> const fused(boundaries...);
+
+    #pragma omp parallel for default(none) shared(con, pop, fluid, param, fused) schedule(static,1)
+    for(unsigned int block = 0; block < fluid.NUM_BLOCKS_; ++block)
+    {
+        PROFILE_WORK();
+
+        ApplyEnsembleBoundaries<odd>(fused, pop, block);
+
+        DispatchIsa([&](auto const)
+        {
+            for(size_t i = fluid.BlockBegin(block); i < fluid.BlockEnd(block); ++i)
+            {
+                fluidCell const& cell = fluid.cells_[i];
+                CollideStreamBGK_Ensemble_Node<odd,save>(con, pop, cell.x_n, cell.y_n, cell.z_n, param);
+
+                for(unsigned int k = 0; k < NPOP; ++k)
+                {
+                    BounceBackLinks<odd>(cell, pop, k);
+                }
+            }
+        });
+    }
+}
+
+#endif //COLLISION_BGK_ENSEMBLE_HPP_INCLUDED
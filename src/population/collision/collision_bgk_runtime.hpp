@@ -0,0 +1,142 @@
+#ifndef COLLISION_BGK_RUNTIME_HPP_INCLUDED
+#define COLLISION_BGK_RUNTIME_HPP_INCLUDED
+
+/**
+ * \file     collision_bgk_runtime.hpp
+ * \mainpage BGK collision operator for domains whose size is only known at run time
+*/
+
+#include <algorithm>
+#include <cmath>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../../general/cpu_dispatch.hpp"
+#include "../../general/instrumentation.hpp"
+#include "../../general/memory_alignment.hpp"
+#include "../../continuum/continuum_runtime.hpp"
+#include "../../lattice/equilibrium.hpp"
+#include "../population_runtime.hpp"
+
+
+/**\fn            CollideStreamBGK_Node
+ * \brief         BGK collision operator for arbitrary lattice (single lattice node of a run-time sized domain)
+ * \warning       Inline function! Has to be declared in header!
+ *
+ * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        T      floating data type used for simulation
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] pop    population object holding microscopic variables
+ * \param[in]     x_n    x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]     y_n    y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]     z_n    z coordinates of current cell and its neighbours [z-1,z,z+1]
+*/
+template <bool odd, bool save, class LT, typename T>
+inline void __attribute__((always_inline)) CollideStreamBGK_Node(RuntimeContinuum<T>& con, RuntimePopulation<LT>& pop,
+                                                                 unsigned int const (&x_n)[3], unsigned int const (&y_n)[3], unsigned int const (&z_n)[3])
+{
+    /// load distributions
+    alignas(CACHE_LINE) T f[LT::ND] = {0.0};
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            f[n*LT::OFF + d] = pop.F_[pop. template IndexRead<odd>(x_n,y_n,z_n,n,d)];
+        }
+    }
+
+    /// macroscopic values
+    T rho = 0.0;
+    T u   = 0.0;
+    T v   = 0.0;
+    T w   = 0.0;
+    lattice::Velocity<LT>(f, rho, u, v, w);
+
+    if constexpr (save == true)
+    {
+        con(x_n[1], y_n[1], z_n[1], 0) = rho;
+        con(x_n[1], y_n[1], z_n[1], 1) = u;
+        con(x_n[1], y_n[1], z_n[1], 2) = v;
+        con(x_n[1], y_n[1], z_n[1], 3) = w;
+    }
+
+    /// equilibrium distributions
+    alignas(CACHE_LINE) T feq[LT::ND] = {0.0};
+
+    lattice::Equilibrium<LT>(rho, u, v, w, feq);
+
+    /// collision and streaming
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr = n*LT::OFF + d;
+            pop.F_[pop. template IndexWrite<odd>(x_n,y_n,z_n,n,d)] = f[curr] + pop.OMEGA_*(feq[curr] - f[curr]);
+        }
+    }
+}
+
+/**\fn            CollideStreamBGK
+ * \brief         BGK collision operator for arbitrary lattice on a domain whose resolution is given at run
+ *                time. Same blocks and arithmetic as the kernel of the compiled domains, only the strides
+ *                of the indices are loaded from memory instead of being constant-folded.
+ *
+ * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        T      floating data type used for simulation
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] pop    population object holding microscopic variables
+*/
+template <bool odd, bool save = false, class LT, typename T>
+void CollideStreamBGK(RuntimeContinuum<T>& con, RuntimePopulation<LT>& pop)
+{
+    unsigned int const NX = pop.NX_;
+    unsigned int const NY = pop.NY_;
+    unsigned int const NZ = pop.NZ_;
+
+    #pragma omp parallel for default(none) shared(con, pop) firstprivate(NX, NY, NZ) schedule(static,1)
+    for(unsigned int block = 0; block < pop.NUM_BLOCKS_; ++block)
+    {
+        PROFILE_WORK();
+
+        unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
+
+        DispatchIsa([&](auto const)
+        {
+            for(unsigned int z = z_start; z < z_end; ++z)
+            {
+                unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+                unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
+
+                for(unsigned int y = y_start; y < y_end; ++y)
+                {
+                    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+
+                    unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
+                    unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+
+                    for(unsigned int x = x_start; x < x_end; ++x)
+                    {
+                        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+
+                        CollideStreamBGK_Node<odd,save>(con, pop, x_n, y_n, z_n);
+                    }
+                }
+            }
+        });
+    }
+}
+
+#endif // COLLISION_BGK_RUNTIME_HPP_INCLUDED
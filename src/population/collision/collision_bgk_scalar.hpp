@@ -0,0 +1,417 @@
+#ifndef COLLISION_BGK_SCALAR_HPP_INCLUDED
+#define COLLISION_BGK_SCALAR_HPP_INCLUDED
+
+/**
+ * \file     collision_bgk_scalar.hpp
+ * \mainpage BGK collision operator coupled with the advection-diffusion of a passive scalar
+ *
+ * \note     The distributions of the passive scalar (e.g. a concentration or temperature) are stored as
+ *           the second population (p = 1) of a population object with NPOP = 2 and are therefore
+ *           interleaved per cell with the ones of the flow (p = 0) and share their lattice. Both are
+ *           collided and streamed in the same sweep with the velocity of the flow so that the scalar
+ *           costs a single pass over the memory together with the flow. The scalar relaxes towards
+ *           the same second-order equilibrium as the flow with its concentration instead of the density.
+ *           Inlets and outlets of the scalar are handled by GuoScalar that imposes (type::Pressure) or
+ *           extrapolates (type::Velocity) the concentration with the velocity of the flow while the
+ *           bounce-back results in walls without scalar flux.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <tuple>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../../general/cpu_dispatch.hpp"
+#include "../../general/instrumentation.hpp"
+#include "../../general/memory_alignment.hpp"
+#include "../../continuum/continuum.hpp"
+#include "../../lattice/equilibrium.hpp"
+#include "../boundary/boundary.hpp"
+#include "../boundary/boundary_bounceback.hpp"
+#include "../boundary/boundary_orientation.hpp"
+#include "../boundary/boundary_type.hpp"
+#include "../fluid_cells.hpp"
+#include "../population.hpp"
+
+
+/**\fn        ScalarCollisionFrequency
+ * \brief     Collision frequency of the passive scalar for a given Schmidt (or Prandtl) number
+ *            from the diffusivity D = nu/Sc = cs^2 (tau_s - 1/2)
+ *
+ * \tparam    NX     simulation domain resolution in x-direction
+ * \tparam    NY     simulation domain resolution in y-direction
+ * \tparam    NZ     simulation domain resolution in z-direction
+ * \tparam    LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP   number of populations stored side by side in the lattice
+ * \tparam    LY     memory layout policy of the populations
+ * \tparam    ST     storage policy of the populations
+ * \tparam    SP     streaming policy of the populations
+ * \tparam    T      floating data type used for simulation
+ * \param[in] pop    population object holding microscopic variables (viscosity of the flow)
+ * \param[in] Sc     Schmidt number of the passive scalar
+ * \return    collision frequency of the passive scalar
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+inline T ScalarCollisionFrequency(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, T const Sc)
+{
+    return 1.0/(pop.NU_/(Sc*LT::CS*LT::CS) + 1.0/2.0);
+}
+
+/**\fn         GuoScalar_Node
+ * \brief      Non-equilibrium extrapolation boundary of the passive scalar for a single boundary element:
+ *             contrary to Guo applied to p = 1 the velocity is taken from the flow (p = 0) of the
+ *             neighbouring cell so that the boundary does not divide by a vanishing concentration.
+ * \note       "Non-equilibrium extrapolation method for velocity and pressure boundary conditions in the
+ *             lattice Boltzmann method"
+ *             Z.L. Guo, C.G. Zheng, B.C. Shi
+ *             Chinese Physics, Volume 11, Number 4 (2002)
+ *             DOI: 10.1088/1009-1963/11/4/310
+ *
+ * \tparam     odd           even (0, false) or odd (1, true) time step
+ * \tparam     Type          imposed (type::Pressure) or extrapolated (type::Velocity) concentration
+ * \tparam     Orientation   boundary orientation (orientation::Left, orientation::Right)
+ * \tparam     NX            simulation domain resolution in x-direction
+ * \tparam     NY            simulation domain resolution in y-direction
+ * \tparam     NZ            simulation domain resolution in z-direction
+ * \tparam     LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP          number of populations stored side by side in the lattice
+ * \tparam     LY            memory layout policy of the populations
+ * \tparam     ST            storage policy of the populations
+ * \tparam     SP            streaming policy of the populations
+ * \tparam     T             floating data type used for simulation
+ * \param[in]  b             boundary condition element of the flow (velocity)
+ * \param[out] pop           population object holding microscopic variables of flow (p = 0) and scalar (p = 1)
+ * \param[in]  concentration concentration imposed by type::Pressure
+*/
+template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+inline void GuoScalar_Node(boundaryElement<T> const& b, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, T const concentration)
+{
+    static_assert(NPOP >= 2, "Passive scalar requires a second population stored next to the flow.");
+
+    /// for neighbouring cell
+    unsigned int const x_n[3] = { (NX + b.x + Orientation::x - 1) % NX,
+                                        b.x + Orientation::x,
+                                       (b.x + Orientation::x + 1) % NX };
+    unsigned int const y_n[3] = { (NY + b.y + Orientation::y - 1) % NY,
+                                        b.y + Orientation::y,
+                                       (b.y + Orientation::y + 1) % NY };
+    unsigned int const z_n[3] = { (NZ + b.z + Orientation::z - 1) % NZ,
+                                        b.z + Orientation::z,
+                                       (b.z + Orientation::z + 1) % NZ };
+
+    // load distributions of flow and scalar
+    alignas(CACHE_LINE) T f[LT::ND] = {0.0};
+    alignas(CACHE_LINE) T g[LT::ND] = {0.0};
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            f[n*LT::OFF + d] = pop.Load(pop. template IndexRead<odd>(x_n,y_n,z_n,n,d,0), n, d);
+            g[n*LT::OFF + d] = pop.Load(pop. template IndexRead<odd>(x_n,y_n,z_n,n,d,1), n, d);
+        }
+    }
+
+    // velocity of the flow and concentration of the scalar
+    T rho = 0.0;
+    T u   = 0.0;
+    T v   = 0.0;
+    T w   = 0.0;
+    lattice::Velocity<LT>(f, rho, u, v, w);
+
+    T c  = 0.0;
+    T jx = 0.0;
+    T jy = 0.0;
+    T jz = 0.0;
+    lattice::Moments<LT>(g, c, jx, jy, jz);
+
+    // non-equilibrium part of distributions
+    alignas(CACHE_LINE) T geq[LT::ND]  = {0.0};
+    alignas(CACHE_LINE) T gneq[LT::ND] = {0.0};
+
+    lattice::Equilibrium<LT>(c, u, v, w, geq);
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr = n*LT::OFF + d;
+            gneq[curr] = g[curr] - geq[curr];
+        }
+    }
+
+    /// set new macroscopic values: concentration given by the type, velocity as the boundary of the flow
+    std::array<T,4> const bound  = {concentration, b.u, b.v, b.w};
+    std::array<T,4> const interp = {c, u, v, w};
+    std::array<T,4> const res = Type<Orientation>::getMacroscopicValues(bound, interp);
+
+    lattice::Equilibrium<LT>(res[0], res[1], res[2], res[3], geq);
+
+    /// write to current node
+    unsigned int const x_c[3] = { (NX + b.x - 1) % NX, b.x, (b.x + 1) % NX };
+    unsigned int const y_c[3] = { (NY + b.y - 1) % NY, b.y, (b.y + 1) % NY };
+    unsigned int const z_c[3] = { (NZ + b.z - 1) % NZ, b.z, (b.z + 1) % NZ };
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr = n*LT::OFF + d;
+            pop.Store(pop. template IndexRead<odd>(x_c,y_c,z_c,n,d,1), n, d, geq[curr] + gneq[curr]);
+        }
+    }
+}
+
+/**\fn         GuoScalar
+ * \brief      Non-equilibrium extrapolation boundary of the passive scalar (p = 1) with the velocity of
+ *             the flow (p = 0) for all elements of a boundary.
+ *
+ * \tparam     odd           even (0, false) or odd (1, true) time step
+ * \tparam     Type          imposed (type::Pressure) or extrapolated (type::Velocity) concentration
+ * \tparam     Orientation   boundary orientation (orientation::Left, orientation::Right)
+ * \tparam     NX            simulation domain resolution in x-direction
+ * \tparam     NY            simulation domain resolution in y-direction
+ * \tparam     NZ            simulation domain resolution in z-direction
+ * \tparam     LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP          number of populations stored side by side in the lattice
+ * \tparam     LY            memory layout policy of the populations
+ * \tparam     ST            storage policy of the populations
+ * \tparam     SP            streaming policy of the populations
+ * \tparam     T             floating data type used for simulation
+ * \param[in]  boundary      vector holding all corresponding boundary condition elements of the flow
+ * \param[out] pop           population object holding microscopic variables of flow (p = 0) and scalar (p = 1)
+ * \param[in]  concentration concentration imposed by type::Pressure (default = 1)
+*/
+template <bool odd, template <class Orientation> class Type, class Orientation, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void GuoScalar(std::vector<boundaryElement<T>> const& boundary, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, T const concentration = 1.0)
+{
+    #pragma omp parallel for default(none) shared(boundary,pop) firstprivate(concentration) schedule(static,32)
+    for(size_t i = 0; i < boundary.size(); ++i)
+    {
+        GuoScalar_Node<odd,Type,Orientation>(boundary[i], pop, concentration);
+    }
+}
+
+/**\fn            CollideStreamBGK_Scalar_Node
+ * \brief         BGK collision operator for the flow (p = 0) and the passive scalar (p = 1) for arbitrary
+ *                lattice (single lattice node)
+ * \warning       Inline function! Has to be declared in header!
+ * \note          "Lattice Boltzmann model for the convection-diffusion equation"
+ *                B. Shi, Z. Guo
+ *                Physical Review E 79 (2009)
+ *                DOI: 10.1103/PhysRevE.79.016701
+ *
+ * \tparam        odd     even (0, false) or odd (1, true) time step
+ * \tparam        save    save current macroscopic values to disk (Boolean true/false)
+ * \tparam        NX      simulation domain resolution in x-direction
+ * \tparam        NY      simulation domain resolution in y-direction
+ * \tparam        NZ      simulation domain resolution in z-direction
+ * \tparam        LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP    number of populations stored side by side in the lattice
+ * \tparam        LY      memory layout policy of the populations
+ * \tparam        ST      storage policy of the populations
+ * \tparam        SP      streaming policy of the populations
+ * \tparam        T       floating data type used for simulation
+ * \param[out]    con     continuum object holding macroscopic variables of the flow
+ * \param[out]    scalar  continuum object holding the concentration and scalar flux
+ * \param[in,out] pop     population object holding microscopic variables of flow and scalar
+ * \param[in]     x_n     x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]     y_n     y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]     z_n     z coordinates of current cell and its neighbours [z-1,z,z+1]
+ * \param[in]     omega_s collision frequency of the passive scalar (see ScalarCollisionFrequency)
+*/
+template <bool odd, bool save, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+inline void __attribute__((always_inline)) CollideStreamBGK_Scalar_Node(Continuum<NX,NY,NZ,T>& con, Continuum<NX,NY,NZ,T>& scalar,
+                                                                        Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop,
+                                                                        unsigned int const (&x_n)[3], unsigned int const (&y_n)[3], unsigned int const (&z_n)[3],
+                                                                        T const omega_s)
+{
+    static_assert(NPOP >= 2, "Passive scalar requires a second population stored next to the flow.");
+
+    /// load distributions of flow and scalar
+    alignas(CACHE_LINE) T f[LT::ND] = {0.0};
+    alignas(CACHE_LINE) T g[LT::ND] = {0.0};
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            f[n*LT::OFF + d] = pop.Load(pop. template IndexRead<odd>(x_n,y_n,z_n,n,d,0), n, d);
+            g[n*LT::OFF + d] = pop.Load(pop. template IndexRead<odd>(x_n,y_n,z_n,n,d,1), n, d);
+        }
+    }
+
+    /// macroscopic values: density and velocity of the flow, concentration and flux of the scalar
+    T rho = 0.0;
+    T u   = 0.0;
+    T v   = 0.0;
+    T w   = 0.0;
+    lattice::Velocity<LT>(f, rho, u, v, w);
+
+    T c  = 0.0;
+    T jx = 0.0;
+    T jy = 0.0;
+    T jz = 0.0;
+    lattice::Moments<LT>(g, c, jx, jy, jz);
+
+    if constexpr (save == true)
+    {
+        con(x_n[1], y_n[1], z_n[1], 0) = rho;
+        con(x_n[1], y_n[1], z_n[1], 1) = u;
+        con(x_n[1], y_n[1], z_n[1], 2) = v;
+        con(x_n[1], y_n[1], z_n[1], 3) = w;
+
+        scalar(x_n[1], y_n[1], z_n[1], 0) = c;
+        scalar(x_n[1], y_n[1], z_n[1], 1) = jx;
+        scalar(x_n[1], y_n[1], z_n[1], 2) = jy;
+        scalar(x_n[1], y_n[1], z_n[1], 3) = jz;
+    }
+
+    /// equilibrium distributions: the scalar is advected with the velocity of the flow
+    alignas(CACHE_LINE) T feq[LT::ND] = {0.0};
+    alignas(CACHE_LINE) T geq[LT::ND] = {0.0};
+
+    lattice::Equilibrium<LT>(rho, u, v, w, feq);
+    lattice::Equilibrium<LT>(c,   u, v, w, geq);
+
+    /// collision and streaming of both populations
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr = n*LT::OFF + d;
+            pop.Store(pop. template IndexWrite<odd>(x_n,y_n,z_n,n,d,0), n, d, f[curr] + pop.OMEGA_*(feq[curr] - f[curr]));
+            pop.Store(pop. template IndexWrite<odd>(x_n,y_n,z_n,n,d,1), n, d, g[curr] + omega_s*(geq[curr] - g[curr]));
+        }
+    }
+}
+
+
+/**\fn            CollideStreamBGK_Scalar
+ * \brief         BGK collision operator for the flow coupled with the advection-diffusion of a passive
+ *                scalar for arbitrary lattice
+ *
+ * \tparam        odd     even (0, false) or odd (1, true) time step
+ * \tparam        save    save current macroscopic values to disk (Boolean true/false)
+ * \tparam        NX      simulation domain resolution in x-direction
+ * \tparam        NY      simulation domain resolution in y-direction
+ * \tparam        NZ      simulation domain resolution in z-direction
+ * \tparam        LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP    number of populations stored side by side in the lattice
+ * \tparam        LY      memory layout policy of the populations
+ * \tparam        ST      storage policy of the populations
+ * \tparam        SP      streaming policy of the populations
+ * \tparam        T       floating data type used for simulation
+ * \param[out]    con     continuum object holding macroscopic variables of the flow
+ * \param[out]    scalar  continuum object holding the concentration and scalar flux
+ * \param[in,out] pop     population object holding microscopic variables of flow (p = 0) and scalar (p = 1)
+ * \param[in]     omega_s collision frequency of the passive scalar (see ScalarCollisionFrequency)
+*/
+template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void CollideStreamBGK_Scalar(Continuum<NX,NY,NZ,T>& con, Continuum<NX,NY,NZ,T>& scalar, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop,
+                             T const omega_s)
+{
+    #pragma omp parallel for default(none) shared(con, scalar, pop) firstprivate(omega_s) schedule(static,1)
+    for(unsigned int block = 0; block < pop.NUM_BLOCKS_; ++block)
+    {
+        PROFILE_WORK();
+
+        unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
+
+        DispatchIsa([&](auto const)
+        {
+            for(unsigned int z = z_start; z < z_end; ++z)
+            {
+                unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+                unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
+
+                for(unsigned int y = y_start; y < y_end; ++y)
+                {
+                    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+
+                    unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
+                    unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+
+                    for(unsigned int x = x_start; x < x_end; ++x)
+                    {
+                        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+
+                        CollideStreamBGK_Scalar_Node<odd,save>(con, scalar, pop, x_n, y_n, z_n, omega_s);
+                    }
+                }
+            }
+        });
+    }
+}
+
+/**\fn            CollideStreamBGK_Scalar
+ * \brief         BGK collision operator for the flow coupled with the advection-diffusion of a passive
+ *                scalar for arbitrary lattice only sweeping over the fluid cells given by an indirect fluid
+ *                cell list. Links towards solid cells of both populations are bounced back directly after
+ *                the collision of every cell and fused boundaries of the flow are applied at the beginning
+ *                of every block.
+ * \warning       The boundaries of the scalar have to be applied before the sweep (see GuoScalar).
+ *
+ * \tparam        odd     even (0, false) or odd (1, true) time step
+ * \tparam        save    save current macroscopic values to disk (Boolean true/false)
+ * \tparam        NX      simulation domain resolution in x-direction
+ * \tparam        NY      simulation domain resolution in y-direction
+ * \tparam        NZ      simulation domain resolution in z-direction
+ * \tparam        LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP    number of populations stored side by side in the lattice
+ * \tparam        LY      memory layout policy of the populations
+ * \tparam        ST      storage policy of the populations
+ * \tparam        SP      streaming policy of the populations
+ * \tparam        T       floating data type used for simulation
+ * \tparam        BC      types of the fused boundaries of the flow (e.g. FusedGuo)
+ * \param[out]    con     continuum object holding macroscopic variables of the flow
+ * \param[out]    scalar  continuum object holding the concentration and scalar flux
+ * \param[in,out] pop     population object holding microscopic variables of flow (p = 0) and scalar (p = 1)
+ * \param[in]     fluid   fluid cell list holding all fluid cells and their neighbours
+ * \param[in]     omega_s collision frequency of the passive scalar (see ScalarCollisionFrequency)
+ * \param[in]     boundaries fused boundaries of the flow applied within the collision sweep (optional)
+*/
+template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T, class... BC>
+void CollideStreamBGK_Scalar(Continuum<NX,NY,NZ,T>& con, Continuum<NX,NY,NZ,T>& scalar, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop,
+                             FluidCells<NX,NY,NZ> const& fluid, T const omega_s, BC const&... boundaries)
+{
+    std::tuple<BC const&...> const fused(boundaries...);
+
+    #pragma omp parallel for default(none) shared(con, scalar, pop, fluid, fused) firstprivate(omega_s) schedule(static,1)
+    for(unsigned int block = 0; block < fluid.NUM_BLOCKS_; ++block)
+    {
+        PROFILE_WORK();
+
+        ApplyBlockBoundaries<odd>(fused, pop, block, 0);
+
+        DispatchIsa([&](auto const)
+        {
+            for(size_t i = fluid.BlockBegin(block); i < fluid.BlockEnd(block); ++i)
+            {
+                fluidCell const& cell = fluid.cells_[i];
+                CollideStreamBGK_Scalar_Node<odd,save>(con, scalar, pop, cell.x_n, cell.y_n, cell.z_n, omega_s);
+                BounceBackLinks<odd>(cell, pop, 0);
+                BounceBackLinks<odd>(cell, pop, 1);
+            }
+        });
+    }
+}
+
+#endif //COLLISION_BGK_SCALAR_HPP_INCLUDED
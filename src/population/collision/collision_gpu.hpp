@@ -0,0 +1,415 @@
+#ifndef COLLISION_GPU_HPP_INCLUDED
+#define COLLISION_GPU_HPP_INCLUDED
+
+/**
+ * \file     collision_gpu.hpp
+ * \mainpage BGK, TRT and BGK-Smagorinsky collision operators as device kernels
+ *
+ * \note     Every thread collides and streams a single cell. Thread blocks are lines of cells in
+ *           x-direction so that neighbouring threads access contiguous memory with the SoA layout.
+ *           The kernels are launched asynchronously; a copy to the host synchronises implicitly.
+*/
+
+#include <cmath>
+
+#include "../../continuum/continuum_gpu.hpp"
+#include "../../general/gpu.hpp"
+#include "../../lattice/equilibrium.hpp"
+#include "../population_gpu.hpp"
+
+
+/**\fn            CollideStreamBGK_DeviceNode
+ * \brief         BGK collision operator for arbitrary lattice (single lattice node, see CollideStreamBGK_Node)
+ * \note          "A Model for Collision Processes in Gases. I. Small Amplitude Processes in Charged
+ *                and Neutral One-Component Systems"
+ *                P.L. Bhatnagar, E.P. Gross, M. Krook
+ *                Physical Review 94 (1954)
+ *                DOI: 10.1103/PhysRev.94.511
+ *
+ * \tparam        odd       even (0, false) or odd (1, true) time step
+ * \tparam        save      save current macroscopic values (Boolean true/false)
+ * \tparam        NX        simulation domain resolution in x-direction
+ * \tparam        NY        simulation domain resolution in y-direction
+ * \tparam        NZ        simulation domain resolution in z-direction
+ * \tparam        LT        static lattice::DdQq class containing discretisation parameters
+ * \tparam        LY        memory layout policy of the populations
+ * \tparam        T         floating data type used for simulation
+ * \param[out]    M         macroscopic values in device memory
+ * \param[in,out] F         populations in device memory
+ * \param[in]     lattice   lattice discretisation parameters
+ * \param[in]     omega     collision frequency
+ * \param[in]     x_n       x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]     y_n       y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]     z_n       z coordinates of current cell and its neighbours [z-1,z,z+1]
+*/
+template <bool odd, bool save, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+inline HOST_DEVICE void CollideStreamBGK_DeviceNode(T* const M, T* const F, latticeParameters<LT> const& lattice, T const omega,
+                                                    unsigned int const (&x_n)[3], unsigned int const (&y_n)[3], unsigned int const (&z_n)[3])
+{
+    typedef DevicePopulation<NX,NY,NZ,LT,LY> POP;
+    typedef DeviceContinuum<NX,NY,NZ,T>      CON;
+
+    /// load distributions
+    T f[LT::ND] = {0.0};
+
+    #pragma unroll
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma unroll
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            f[n*LT::OFF + d] = F[POP::template AA_IndexRead<odd>(lattice,x_n,y_n,z_n,n,d)];
+        }
+    }
+
+    /// macroscopic values
+    T rho = 0.0;
+    T u   = 0.0;
+    T v   = 0.0;
+    T w   = 0.0;
+    lattice::Velocity<LT>(f, rho, u, v, w);
+
+    if constexpr (save == true)
+    {
+        M[CON::SpatialToLinear(x_n[1], y_n[1], z_n[1], 0)] = rho;
+        M[CON::SpatialToLinear(x_n[1], y_n[1], z_n[1], 1)] = u;
+        M[CON::SpatialToLinear(x_n[1], y_n[1], z_n[1], 2)] = v;
+        M[CON::SpatialToLinear(x_n[1], y_n[1], z_n[1], 3)] = w;
+    }
+
+    /// equilibrium distributions
+    T feq[LT::ND] = {0.0};
+
+    lattice::Equilibrium<LT>(rho, u, v, w, feq);
+
+    /// collision and streaming
+    #pragma unroll
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma unroll
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr = n*LT::OFF + d;
+            F[POP::template AA_IndexWrite<odd>(lattice,x_n,y_n,z_n,n,d)] = f[curr] + omega*(feq[curr] - f[curr]);
+        }
+    }
+}
+
+/**\fn            CollideStreamTRT_DeviceNode
+ * \brief         TRT collision operator for arbitrary lattice (single lattice node, see CollideStreamTRT_Node)
+ * \note          "Two-relaxation-time Lattice Boltzmann scheme: about parametrization, velocity,
+ *                pressure and mixed boundary conditions"
+ *                I. Ginzburg, F. Verhaeghe, D. Humiéres
+ *                Communications in Computational Physics Vol. 3 (2008)
+ *                Online: http://global-sci.org/intro/article_detail/cicp/7862.html
+ *
+ * \tparam        odd       even (0, false) or odd (1, true) time step
+ * \tparam        save      save current macroscopic values (Boolean true/false)
+ * \tparam        NX        simulation domain resolution in x-direction
+ * \tparam        NY        simulation domain resolution in y-direction
+ * \tparam        NZ        simulation domain resolution in z-direction
+ * \tparam        LT        static lattice::DdQq class containing discretisation parameters
+ * \tparam        LY        memory layout policy of the populations
+ * \tparam        T         floating data type used for simulation
+ * \param[out]    M         macroscopic values in device memory
+ * \param[in,out] F         populations in device memory
+ * \param[in]     lattice   lattice discretisation parameters
+ * \param[in]     omega     collision frequency (positive populations)
+ * \param[in]     omega_m   collision frequency (negative populations)
+ * \param[in]     x_n       x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]     y_n       y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]     z_n       z coordinates of current cell and its neighbours [z-1,z,z+1]
+*/
+template <bool odd, bool save, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+inline HOST_DEVICE void CollideStreamTRT_DeviceNode(T* const M, T* const F, latticeParameters<LT> const& lattice, T const omega, T const omega_m,
+                                                    unsigned int const (&x_n)[3], unsigned int const (&y_n)[3], unsigned int const (&z_n)[3])
+{
+    typedef DevicePopulation<NX,NY,NZ,LT,LY> POP;
+    typedef DeviceContinuum<NX,NY,NZ,T>      CON;
+
+    /// load distributions
+    T f[LT::ND] = {0.0};
+
+    #pragma unroll
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma unroll
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            f[n*LT::OFF + d] = F[POP::template AA_IndexRead<odd>(lattice,x_n,y_n,z_n,n,d)];
+        }
+    }
+
+    /// macroscopic values
+    T rho = 0.0;
+    T u   = 0.0;
+    T v   = 0.0;
+    T w   = 0.0;
+    lattice::Velocity<LT>(f, rho, u, v, w);
+
+    if constexpr (save == true)
+    {
+        M[CON::SpatialToLinear(x_n[1], y_n[1], z_n[1], 0)] = rho;
+        M[CON::SpatialToLinear(x_n[1], y_n[1], z_n[1], 1)] = u;
+        M[CON::SpatialToLinear(x_n[1], y_n[1], z_n[1], 2)] = v;
+        M[CON::SpatialToLinear(x_n[1], y_n[1], z_n[1], 3)] = w;
+    }
+
+    /// equilibrium distributions
+    T feq[LT::ND] = {0.0};
+
+    lattice::Equilibrium<LT>(rho, u, v, w, feq);
+
+    /// odd and even part
+    T fp[LT::OFF] = {0.0};
+    T fm[LT::OFF] = {0.0};
+
+    #pragma unroll
+    for(unsigned int d = 1; d < LT::HSPEED; ++d)
+    {
+        fp[d] = 0.5*(f[d] + f[LT::OFF + d] - (feq[d] + feq[LT::OFF + d]));
+        fm[d] = 0.5*(f[d] - f[LT::OFF + d] - (feq[d] - feq[LT::OFF + d]));
+    }
+
+    /// collision and streaming
+    F[POP::template AA_IndexWrite<odd>(lattice,x_n,y_n,z_n,0,0)] = f[0] + omega*(feq[0] - f[0]);
+    #pragma unroll
+    for(unsigned int d = 1; d < LT::HSPEED; ++d)
+    {
+        F[POP::template AA_IndexWrite<odd>(lattice,x_n,y_n,z_n,0,d)] = f[d] - omega*fp[d] - omega_m*fm[d];
+    }
+    #pragma unroll
+    for(unsigned int d = 1; d < LT::HSPEED; ++d)
+    {
+        F[POP::template AA_IndexWrite<odd>(lattice,x_n,y_n,z_n,1,d)] = f[LT::OFF + d] - omega*fp[d] + omega_m*fm[d];
+    }
+}
+
+/**\fn            CollideStreamBGK_Smagorinsky_DeviceNode
+ * \brief         BGK collision operator with Smagorinsky turbulence model for arbitrary lattice
+ *                (single lattice node, see CollideStreamBGK_Smagorinsky_Node)
+ * \note          "A Lattice Boltzmann Subgrid Model for High Reynolds Number Flows"
+ *                S. Hou, J. Sterling, S. Chen, G.D. Doolen
+ *                (1994)
+ *                arXiv: arXiv:comp-gas/9401004
+ *
+ * \tparam        odd       even (0, false) or odd (1, true) time step
+ * \tparam        save      save current macroscopic values (Boolean true/false)
+ * \tparam        NX        simulation domain resolution in x-direction
+ * \tparam        NY        simulation domain resolution in y-direction
+ * \tparam        NZ        simulation domain resolution in z-direction
+ * \tparam        LT        static lattice::DdQq class containing discretisation parameters
+ * \tparam        LY        memory layout policy of the populations
+ * \tparam        T         floating data type used for simulation
+ * \param[out]    M         macroscopic values in device memory
+ * \param[in,out] F         populations in device memory
+ * \param[in]     lattice   lattice discretisation parameters
+ * \param[in]     tau       laminar relaxation time
+ * \param[in]     x_n       x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]     y_n       y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]     z_n       z coordinates of current cell and its neighbours [z-1,z,z+1]
+*/
+template <bool odd, bool save, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+inline HOST_DEVICE void CollideStreamBGK_Smagorinsky_DeviceNode(T* const M, T* const F, latticeParameters<LT> const& lattice, T const tau,
+                                                                unsigned int const (&x_n)[3], unsigned int const (&y_n)[3], unsigned int const (&z_n)[3])
+{
+    typedef DevicePopulation<NX,NY,NZ,LT,LY> POP;
+    typedef DeviceContinuum<NX,NY,NZ,T>      CON;
+
+    /// Smagorinsky constant
+    constexpr T CS = 0.15;
+
+    /// load distributions
+    T f[LT::ND] = {0.0};
+
+    #pragma unroll
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma unroll
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            f[n*LT::OFF + d] = F[POP::template AA_IndexRead<odd>(lattice,x_n,y_n,z_n,n,d)];
+        }
+    }
+
+    /// macroscopic values
+    T rho = 0.0;
+    T u   = 0.0;
+    T v   = 0.0;
+    T w   = 0.0;
+    lattice::Velocity<LT>(f, rho, u, v, w);
+
+    if constexpr (save == true)
+    {
+        M[CON::SpatialToLinear(x_n[1], y_n[1], z_n[1], 0)] = rho;
+        M[CON::SpatialToLinear(x_n[1], y_n[1], z_n[1], 1)] = u;
+        M[CON::SpatialToLinear(x_n[1], y_n[1], z_n[1], 2)] = v;
+        M[CON::SpatialToLinear(x_n[1], y_n[1], z_n[1], 3)] = w;
+    }
+
+    /// equilibrium distributions and non-equilibrium part
+    T feq[LT::ND]  = {0.0};
+    T fneq[LT::ND] = {0.0};
+
+    lattice::Equilibrium<LT>(rho, u, v, w, feq);
+
+    #pragma unroll
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma unroll
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr = n*LT::OFF + d;
+            fneq[curr] = f[curr] - feq[curr];
+        }
+    }
+
+    /// strain-rate tensor
+    T p_ab[6] = {0.0};
+    lattice::Stress<LT>(fneq, p_ab);
+    T const p_xx = p_ab[0];
+    T const p_yy = p_ab[1];
+    T const p_zz = p_ab[2];
+    T const p_xy = p_ab[3];
+    T const p_xz = p_ab[4];
+    T const p_yz = p_ab[5];
+
+    // calculate overall momentum flux
+    T const p_ij = sqrt(p_xx*p_xx + p_yy*p_yy + p_zz*p_zz + 2*p_xy*p_xy + 2*p_xz*p_xz + 2*p_yz*p_yz);
+
+    // calculate turbulent relaxation
+    T const tau_t = 0.5*(sqrt(tau*tau + 2*sqrt(2.0)*CS*CS*p_ij/(rho*LT::CS*LT::CS*LT::CS*LT::CS)) - tau);
+    T const omega = 1.0/(tau + tau_t);
+
+    /// collision and streaming
+    #pragma unroll
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma unroll
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            unsigned int const curr = n*LT::OFF + d;
+            F[POP::template AA_IndexWrite<odd>(lattice,x_n,y_n,z_n,n,d)] = f[curr] + omega*(feq[curr] - f[curr]);
+        }
+    }
+}
+
+
+#if defined(__CUDACC__) || defined(__HIPCC__)
+
+    /**\def    DEVICE_CELL_INDICES
+     * \brief  Macro for the coordinates of the cell of the current thread and its neighbours, returns
+     *         if the thread lies outside the domain
+    */
+    #define DEVICE_CELL_INDICES                                                                 \
+        unsigned int const x = blockIdx.x*blockDim.x + threadIdx.x;                             \
+        unsigned int const y = blockIdx.y;                                                      \
+        unsigned int const z = blockIdx.z;                                                      \
+        if (x >= NX)                                                                            \
+        {                                                                                       \
+            return;                                                                             \
+        }                                                                                       \
+        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };                     \
+        unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };                     \
+        unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+    /**\fn        CollideStreamBGK_Kernel
+     * \brief     Device kernel of the BGK collision operator: a single cell per thread
+    */
+    template <bool odd, bool save, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+    __global__ void __launch_bounds__(GPU_BLOCK_SIZE) CollideStreamBGK_Kernel(T* const M, T* const F, latticeParameters<LT> const lattice,
+                                                                              T const omega)
+    {
+        DEVICE_CELL_INDICES
+        CollideStreamBGK_DeviceNode<odd,save,NX,NY,NZ,LT,LY>(M, F, lattice, omega, x_n, y_n, z_n);
+    }
+
+    /**\fn        CollideStreamTRT_Kernel
+     * \brief     Device kernel of the TRT collision operator: a single cell per thread
+    */
+    template <bool odd, bool save, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+    __global__ void __launch_bounds__(GPU_BLOCK_SIZE) CollideStreamTRT_Kernel(T* const M, T* const F, latticeParameters<LT> const lattice,
+                                                                              T const omega, T const omega_m)
+    {
+        DEVICE_CELL_INDICES
+        CollideStreamTRT_DeviceNode<odd,save,NX,NY,NZ,LT,LY>(M, F, lattice, omega, omega_m, x_n, y_n, z_n);
+    }
+
+    /**\fn        CollideStreamBGK_Smagorinsky_Kernel
+     * \brief     Device kernel of the BGK collision operator with Smagorinsky turbulence model: a single cell per thread
+    */
+    template <bool odd, bool save, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+    __global__ void __launch_bounds__(GPU_BLOCK_SIZE) CollideStreamBGK_Smagorinsky_Kernel(T* const M, T* const F, latticeParameters<LT> const lattice,
+                                                                                          T const tau)
+    {
+        DEVICE_CELL_INDICES
+        CollideStreamBGK_Smagorinsky_DeviceNode<odd,save,NX,NY,NZ,LT,LY>(M, F, lattice, tau, x_n, y_n, z_n);
+    }
+
+
+    /**\fn            CollideStreamBGK
+     * \brief         BGK collision operator for arbitrary lattice on the device
+     *
+     * \tparam        odd    even (0, false) or odd (1, true) time step
+     * \tparam        save   save current macroscopic values (Boolean true/false, default = false)
+     * \tparam        NX     simulation domain resolution in x-direction
+     * \tparam        NY     simulation domain resolution in y-direction
+     * \tparam        NZ     simulation domain resolution in z-direction
+     * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+     * \tparam        LY     memory layout policy of the populations
+     * \tparam        T      floating data type used for simulation
+     * \param[out]    con    continuum object holding macroscopic variables in device memory
+     * \param[in,out] pop    population object holding microscopic variables in device memory
+    */
+    template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+    void CollideStreamBGK(DeviceContinuum<NX,NY,NZ,T>& con, DevicePopulation<NX,NY,NZ,LT,LY>& pop)
+    {
+        CollideStreamBGK_Kernel<odd,save,NX,NY,NZ,LT,LY><<<dim3(pop.NUM_BLOCKS_X_,NY,NZ), GPU_BLOCK_SIZE>>>(con.M_, pop.F_, pop.LATTICE_, pop.OMEGA_);
+        GPU_CHECK(gpuGetLastError());
+    }
+
+    /**\fn            CollideStreamTRT
+     * \brief         TRT collision operator for arbitrary lattice on the device
+     *
+     * \tparam        odd    even (0, false) or odd (1, true) time step
+     * \tparam        save   save current macroscopic values (Boolean true/false, default = false)
+     * \tparam        NX     simulation domain resolution in x-direction
+     * \tparam        NY     simulation domain resolution in y-direction
+     * \tparam        NZ     simulation domain resolution in z-direction
+     * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+     * \tparam        LY     memory layout policy of the populations
+     * \tparam        T      floating data type used for simulation
+     * \param[out]    con    continuum object holding macroscopic variables in device memory
+     * \param[in,out] pop    population object holding microscopic variables in device memory
+    */
+    template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+    void CollideStreamTRT(DeviceContinuum<NX,NY,NZ,T>& con, DevicePopulation<NX,NY,NZ,LT,LY>& pop)
+    {
+        CollideStreamTRT_Kernel<odd,save,NX,NY,NZ,LT,LY><<<dim3(pop.NUM_BLOCKS_X_,NY,NZ), GPU_BLOCK_SIZE>>>(con.M_, pop.F_, pop.LATTICE_, pop.OMEGA_, pop.OMEGA_M_);
+        GPU_CHECK(gpuGetLastError());
+    }
+
+    /**\fn            CollideStreamBGK_Smagorinsky
+     * \brief         BGK collision operator with Smagorinsky turbulence model for arbitrary lattice on the device
+     *
+     * \tparam        odd    even (0, false) or odd (1, true) time step
+     * \tparam        save   save current macroscopic values (Boolean true/false, default = false)
+     * \tparam        NX     simulation domain resolution in x-direction
+     * \tparam        NY     simulation domain resolution in y-direction
+     * \tparam        NZ     simulation domain resolution in z-direction
+     * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+     * \tparam        LY     memory layout policy of the populations
+     * \tparam        T      floating data type used for simulation
+     * \param[out]    con    continuum object holding macroscopic variables in device memory
+     * \param[in,out] pop    population object holding microscopic variables in device memory
+    */
+    template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY, typename T>
+    void CollideStreamBGK_Smagorinsky(DeviceContinuum<NX,NY,NZ,T>& con, DevicePopulation<NX,NY,NZ,LT,LY>& pop)
+    {
+        CollideStreamBGK_Smagorinsky_Kernel<odd,save,NX,NY,NZ,LT,LY><<<dim3(pop.NUM_BLOCKS_X_,NY,NZ), GPU_BLOCK_SIZE>>>(con.M_, pop.F_, pop.LATTICE_, pop.TAU_);
+        GPU_CHECK(gpuGetLastError());
+    }
+
+#endif
+
+#endif // COLLISION_GPU_HPP_INCLUDED
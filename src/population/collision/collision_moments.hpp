@@ -0,0 +1,258 @@
+#ifndef COLLISION_MOMENTS_HPP_INCLUDED
+#define COLLISION_MOMENTS_HPP_INCLUDED
+
+/**
+ * \file     collision_moments.hpp
+ * \mainpage Regularised collision operator for lattices stored in moment space
+ *
+ * \note     The populations of every cell are reconstructed on the fly from the moments of its
+ *           neighbours (pull), collided with the regularised BGK operator and reduced to their moments
+ *           again before they are stored. Links towards solid cells of a fluid cell list are bounced
+ *           back by reconstructing the opposite population of the cell itself (halfway bounce-back).
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../../general/cpu_dispatch.hpp"
+#include "../../general/instrumentation.hpp"
+#include "../../general/memory_alignment.hpp"
+#include "../../continuum/continuum.hpp"
+#include "../../lattice/equilibrium.hpp"
+#include "../fluid_cells.hpp"
+#include "../moments.hpp"
+
+
+/**\fn         PullMoments
+ * \brief      Reconstruct the post-collision population of a single lattice velocity that streams into the
+ *             current cell from the moments of the neighbour x - c or, if the neighbour is solid, reflect
+ *             the opposite population of the current cell
+ * \warning    Inline function! Has to be declared in header!
+ *
+ * \tparam     odd    even (0, false) or odd (1, true) time step
+ * \tparam     curr   the lattice velocity of interest
+ * \tparam     NX     simulation domain resolution in x-direction
+ * \tparam     NY     simulation domain resolution in y-direction
+ * \tparam     NZ     simulation domain resolution in z-direction
+ * \tparam     LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam     ST     storage policy of the moments
+ * \tparam     T      floating data type used for simulation
+ * \param[in]  mom    moment population object holding microscopic variables
+ * \param[in]  x_n    x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]  y_n    y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]  z_n    z coordinates of current cell and its neighbours [z-1,z,z+1]
+ * \param[in]  solid  links of the current cell pointing towards solid neighbours (bit mask)
+ * \param[in]  own    moments of the current cell (only used for links towards solid neighbours)
+ * \return     the population streaming into the current cell
+*/
+template <bool odd, unsigned int curr, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST, typename T>
+inline T __attribute__((always_inline)) PullMoments(MomentPopulation<NX,NY,NZ,LT,ST> const& mom,
+                                                    unsigned int const (&x_n)[3], unsigned int const (&y_n)[3], unsigned int const (&z_n)[3],
+                                                    uint32_t const solid, T const (&own)[MomentPopulation<NX,NY,NZ,LT,ST>::NM_])
+{
+    constexpr unsigned int opp = (curr < LT::OFF) ? curr + LT::OFF : curr - LT::OFF;
+
+    if (((solid >> opp) & 1u) != 0)
+    {
+        T const p[6] = { own[4], own[5], own[6], own[7], own[8], own[9] };
+        return lattice::Regularised<LT,opp>(own[0], own[1], own[2], own[3], p);
+    }
+
+    T m[MomentPopulation<NX,NY,NZ,LT,ST>::NM_];
+    mom. template Load<odd>(x_n[1 - static_cast<int>(LT::DX[curr])],
+                            y_n[1 - static_cast<int>(LT::DY[curr])],
+                            z_n[1 - static_cast<int>(LT::DZ[curr])], m);
+
+    T const p[6] = { m[4], m[5], m[6], m[7], m[8], m[9] };
+    return lattice::Regularised<LT,curr>(m[0], m[1], m[2], m[3], p);
+}
+
+/// expansion of the pairs of opposite lattice velocities 1 ... HSPEED-1 for the pull
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST, typename T, unsigned int... D>
+inline void __attribute__((always_inline)) PullMomentsPairs(MomentPopulation<NX,NY,NZ,LT,ST> const& mom,
+                                                            unsigned int const (&x_n)[3], unsigned int const (&y_n)[3], unsigned int const (&z_n)[3],
+                                                            uint32_t const solid, T const (&own)[MomentPopulation<NX,NY,NZ,LT,ST>::NM_],
+                                                            T (&f)[LT::ND], std::integer_sequence<unsigned int, D...>)
+{
+    ((f[D + 1]           = PullMoments<odd,D + 1>(mom, x_n, y_n, z_n, solid, own)), ...);
+    ((f[LT::OFF + D + 1] = PullMoments<odd,LT::OFF + D + 1>(mom, x_n, y_n, z_n, solid, own)), ...);
+}
+
+/**\fn            CollideStreamMoments_Node
+ * \brief         Regularised BGK collision operator for a lattice stored in moment space (single lattice node)
+ * \warning       Inline function! Has to be declared in header!
+ * \note          "Lattice Boltzmann method with regularized pre-collision distribution functions"
+ *                J. Latt, B. Chopard
+ *                Mathematics and Computers in Simulation 72 (2006)
+ *                DOI: 10.1016/j.matcom.2006.05.017
+ *
+ * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        NX     simulation domain resolution in x-direction
+ * \tparam        NY     simulation domain resolution in y-direction
+ * \tparam        NZ     simulation domain resolution in z-direction
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        ST     storage policy of the moments
+ * \tparam        T      floating data type used for simulation
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] mom    moment population object holding microscopic variables
+ * \param[in]     x_n    x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]     y_n    y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]     z_n    z coordinates of current cell and its neighbours [z-1,z,z+1]
+ * \param[in]     solid  links of the current cell pointing towards solid neighbours (bit mask)
+*/
+template <bool odd, bool save, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST, typename T>
+inline void __attribute__((always_inline)) CollideStreamMoments_Node(Continuum<NX,NY,NZ,T>& con, MomentPopulation<NX,NY,NZ,LT,ST>& mom,
+                                                                     unsigned int const (&x_n)[3], unsigned int const (&y_n)[3], unsigned int const (&z_n)[3],
+                                                                     uint32_t const solid)
+{
+    constexpr unsigned int NM = MomentPopulation<NX,NY,NZ,LT,ST>::NM_;
+    constexpr T CS2 = LT::CS*LT::CS;
+
+    /// moments of the current cell for bounce-back
+    T own[NM] = {0.0};
+    if (solid != 0)
+    {
+        mom. template Load<odd>(x_n[1], y_n[1], z_n[1], own);
+    }
+
+    /// reconstruct populations streaming into the current cell
+    alignas(CACHE_LINE) T f[LT::ND] = {0.0};
+
+    f[0] = PullMoments<odd,0>(mom, x_n, y_n, z_n, 0, own);
+    PullMomentsPairs<odd>(mom, x_n, y_n, z_n, solid, own, f, std::make_integer_sequence<unsigned int, LT::HSPEED - 1>());
+
+    /// macroscopic values
+    T rho = 0.0;
+    T u   = 0.0;
+    T v   = 0.0;
+    T w   = 0.0;
+    lattice::Velocity<LT>(f, rho, u, v, w);
+
+    if constexpr (save == true)
+    {
+        con(x_n[1], y_n[1], z_n[1], 0) = rho;
+        con(x_n[1], y_n[1], z_n[1], 1) = u;
+        con(x_n[1], y_n[1], z_n[1], 2) = v;
+        con(x_n[1], y_n[1], z_n[1], 3) = w;
+    }
+
+    /// non-equilibrium part of the second order moments relaxed by the collision
+    T p[6] = {0.0};
+    lattice::Stress<LT>(f, p);
+
+    T const relax = 1.0 - mom.OMEGA_;
+    T const m[NM] = { rho, u, v, w,
+                      relax*(p[0] - rho*(u*u + CS2)),
+                      relax*(p[1] - rho*(v*v + CS2)),
+                      relax*(p[2] - rho*(w*w + CS2)),
+                      relax*(p[3] - rho*u*v),
+                      relax*(p[4] - rho*u*w),
+                      relax*(p[5] - rho*v*w) };
+
+    mom. template Store<odd>(x_n[1], y_n[1], z_n[1], m);
+}
+
+
+/**\fn            CollideStreamMoments
+ * \brief         Regularised BGK collision operator for a lattice stored in moment space
+ * \note          "Lattice Boltzmann method with regularized pre-collision distribution functions"
+ *                J. Latt, B. Chopard
+ *                Mathematics and Computers in Simulation 72 (2006)
+ *                DOI: 10.1016/j.matcom.2006.05.017
+ *
+ * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        NX     simulation domain resolution in x-direction
+ * \tparam        NY     simulation domain resolution in y-direction
+ * \tparam        NZ     simulation domain resolution in z-direction
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        ST     storage policy of the moments
+ * \tparam        T      floating data type used for simulation
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] mom    moment population object holding microscopic variables
+*/
+template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST, typename T>
+void CollideStreamMoments(Continuum<NX,NY,NZ,T>& con, MomentPopulation<NX,NY,NZ,LT,ST>& mom)
+{
+    #pragma omp parallel for default(none) shared(con, mom) schedule(static,1)
+    for(unsigned int block = 0; block < mom.NUM_BLOCKS_; ++block)
+    {
+        PROFILE_WORK();
+
+        unsigned int const z_start = mom.BLOCK_SIZE_ * (block / (mom.NUM_BLOCKS_X_*mom.NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + mom.BLOCK_SIZE_, NZ);
+
+        DispatchIsa([&](auto const)
+        {
+            for(unsigned int z = z_start; z < z_end; ++z)
+            {
+                unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+                unsigned int const y_start = mom.BLOCK_SIZE_*((block % (mom.NUM_BLOCKS_X_*mom.NUM_BLOCKS_Y_)) / mom.NUM_BLOCKS_X_);
+                unsigned int const   y_end = std::min(y_start + mom.BLOCK_SIZE_, NY);
+
+                for(unsigned int y = y_start; y < y_end; ++y)
+                {
+                    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+
+                    unsigned int const x_start = mom.BLOCK_SIZE_*(block % mom.NUM_BLOCKS_X_);
+                    unsigned int const   x_end = std::min(x_start + mom.BLOCK_SIZE_, NX);
+
+                    for(unsigned int x = x_start; x < x_end; ++x)
+                    {
+                        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+
+                        CollideStreamMoments_Node<odd,save>(con, mom, x_n, y_n, z_n, 0);
+                    }
+                }
+            }
+        });
+    }
+}
+
+/**\fn            CollideStreamMoments
+ * \brief         Regularised BGK collision operator for a lattice stored in moment space
+ *                only sweeping over the fluid cells given by an indirect fluid cell list. Links towards
+ *                solid cells are bounced back while the populations are reconstructed.
+ * \note          "Lattice Boltzmann method with regularized pre-collision distribution functions"
+ *                J. Latt, B. Chopard
+ *                Mathematics and Computers in Simulation 72 (2006)
+ *                DOI: 10.1016/j.matcom.2006.05.017
+ *
+ * \tparam        odd    even (0, false) or odd (1, true) time step
+ * \tparam        save   save current macroscopic values to disk (Boolean true/false)
+ * \tparam        NX     simulation domain resolution in x-direction
+ * \tparam        NY     simulation domain resolution in y-direction
+ * \tparam        NZ     simulation domain resolution in z-direction
+ * \tparam        LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam        ST     storage policy of the moments
+ * \tparam        T      floating data type used for simulation
+ * \param[out]    con    continuum object holding macroscopic variables
+ * \param[in,out] mom    moment population object holding microscopic variables
+ * \param[in]     fluid  fluid cell list holding all fluid cells and their neighbours
+*/
+template <bool odd, bool save = false, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST, typename T>
+void CollideStreamMoments(Continuum<NX,NY,NZ,T>& con, MomentPopulation<NX,NY,NZ,LT,ST>& mom, FluidCells<NX,NY,NZ> const& fluid)
+{
+    #pragma omp parallel for default(none) shared(con, mom, fluid) schedule(static,1)
+    for(unsigned int block = 0; block < fluid.NUM_BLOCKS_; ++block)
+    {
+        PROFILE_WORK();
+
+        DispatchIsa([&](auto const)
+        {
+            for(size_t i = fluid.BlockBegin(block); i < fluid.BlockEnd(block); ++i)
+            {
+                fluidCell const& cell = fluid.cells_[i];
+                CollideStreamMoments_Node<odd,save>(con, mom, cell.x_n, cell.y_n, cell.z_n, cell.solid);
+            }
+        });
+    }
+}
+
+#endif //COLLISION_MOMENTS_HPP_INCLUDED
@@ -0,0 +1,150 @@
+#ifndef MEMORY_HINTS_HPP_INCLUDED
+#define MEMORY_HINTS_HPP_INCLUDED
+
+/**
+ * \file     memory_hints.hpp
+ * \mainpage Memory access hints of the vectorised collision kernels
+ *
+ * \note     The populations written by a collision kernel are not read again before the next sweep.
+ *           If the cache lines of the destination are not resident every store first reads the line
+ *           (read for ownership), which costs up to a third of the bandwidth of the in-place
+ *           streaming. Two optional hints can be given to the kernels as a policy:
+ *           - non-temporal stores: stores bypass the caches. Contiguous and aligned destinations (the
+ *             cell itself in even time steps of the A-A pattern with array-of-structures, aligned
+ *             chunks of array-of-structures-of-arrays) are written with vector streaming stores, all
+ *             other destinations with scalar streaming stores.
+ *           - prefetch distance: the populations of the cells a given number of cells ahead in the
+ *             current row and in the neighbouring rows (the planes z-1 and z+1 are the farthest away
+ *             in memory) are prefetched for writing.
+ *           Whether the hints pay off depends on the processor, the lattice, the layout and the loop
+ *           block size: they are selected by the benchmark harness ('make bench').
+*/
+
+#include <cstddef>
+#include <string.h>
+#include <type_traits>
+#if defined(__x86_64__)
+    #include <immintrin.h>
+#endif
+
+#include "../../general/memory_alignment.hpp"
+#include "../population.hpp"
+#include "../population_layout.hpp"
+#include "../population_streaming.hpp"
+
+
+namespace hint
+{
+    /**\class  MemoryHints
+     * \brief  Memory access hints of a collision kernel
+     *
+     * \tparam NT   use non-temporal stores (Boolean true/false)
+     * \tparam PD   prefetch distance in cells (0 = no software prefetching)
+    */
+    template <bool NT, unsigned int PD>
+    class MemoryHints
+    {
+        public:
+            static constexpr bool         STREAM   = NT;
+            static constexpr unsigned int PREFETCH = PD;
+    };
+
+    /// regular stores without software prefetching (default)
+    typedef MemoryHints<false,0> Cached;
+
+    /// non-temporal stores without software prefetching
+    typedef MemoryHints<true,0>  Streaming;
+
+    /// regular or non-temporal stores with software prefetching of a given distance
+    template <unsigned int PD> using Prefetch          = MemoryHints<false,PD>;
+    template <unsigned int PD> using StreamingPrefetch = MemoryHints<true,PD>;
+}
+
+
+/**\fn        StreamStore
+ * \brief     Scalar non-temporal store of a single population (regular store on architectures without
+ *            scalar streaming stores)
+ * \warning   Inline function! Has to be declared in header!
+ *
+ * \param[in] address   address of the population
+ * \param[in] value     value of the population
+*/
+static inline void __attribute__((always_inline)) StreamStore(double* const address, double const value)
+{
+    #if defined(__x86_64__)
+        long long bits = 0;
+        memcpy(&bits, &value, sizeof(bits));
+        _mm_stream_si64(reinterpret_cast<long long*>(address), bits);
+    #else
+        *address = value;
+    #endif
+}
+
+/**\fn        StreamFence
+ * \brief     Make the non-temporal stores of the current thread globally visible (has to be called
+ *            before another thread may read the populations, e.g. at the end of every block)
+ * \warning   Inline function! Has to be declared in header!
+*/
+static inline void __attribute__((always_inline)) StreamFence()
+{
+    #if defined(__x86_64__)
+        _mm_sfence();
+    #endif
+}
+
+/**\fn        PrefetchCells
+ * \brief     Prefetch the populations that will be accessed when a cell a prefetch distance ahead of the
+ *            current cell is collided: the cell itself in even time steps of the A-A pattern and the
+ *            leading cells (x+1) of the neighbouring rows otherwise. Only the populations of a cell stored
+ *            side by side (array-of-structures) are covered by a single prefetched range.
+ * \warning   Inline function! Has to be declared in header!
+ *
+ * \tparam    odd    even (0, false) or odd (1, true) time step
+ * \tparam    MH     memory access hints (hint::MemoryHints)
+ * \tparam    NX     simulation domain resolution in x-direction
+ * \tparam    NY     simulation domain resolution in y-direction
+ * \tparam    NZ     simulation domain resolution in z-direction
+ * \tparam    LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP   number of populations stored side by side in the lattice
+ * \tparam    LY     memory layout policy of the populations
+ * \tparam    ST     storage policy of the populations
+ * \tparam    SP     streaming policy of the populations
+ * \param[in] pop    population object holding microscopic variables
+ * \param[in] x      x coordinate of the cell a prefetch distance ahead
+ * \param[in] y_n    y coordinates of this cell and its neighbours [y-1,y,y+1]
+ * \param[in] z_n    z coordinates of this cell and its neighbours [z-1,z,z+1]
+ * \param[in] p      relevant population
+*/
+template <bool odd, class MH, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+static inline void __attribute__((always_inline)) PrefetchCells(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, unsigned int const x,
+                                                                unsigned int const (&y_n)[3], unsigned int const (&z_n)[3], unsigned int const p)
+{
+    if constexpr (MH::PREFETCH > 0)
+    {
+        constexpr bool isLocal = (odd == false) && (std::is_same<SP, streaming::AA>::value == true);
+        constexpr unsigned int first = (isLocal == true) ? 1 : 0;
+        constexpr unsigned int  last = (isLocal == true) ? 1 : 2;
+        constexpr size_t       bytes = static_cast<size_t>(LT::ND)*sizeof(pop.F_[0]);
+
+        unsigned int const x_p = x + ((isLocal == true) ? 0 : 1);
+        if (x_p >= NX)
+        {
+            return;
+        }
+
+        for(unsigned int k = first; k <= last; ++k)
+        {
+            for(unsigned int l = first; l <= last; ++l)
+            {
+                char const* const address = reinterpret_cast<char const*>(&pop.F_[pop.SpatialToLinear(x_p, y_n[l], z_n[k], 0, 0, p)]);
+                for(size_t b = 0; b < bytes; b += CACHE_LINE)
+                {
+                    __builtin_prefetch(address + b, 1, 3);
+                }
+                __builtin_prefetch(address + bytes - 1, 1, 3);
+            }
+        }
+    }
+}
+
+#endif // MEMORY_HINTS_HPP_INCLUDED
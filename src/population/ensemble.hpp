@@ -0,0 +1,115 @@
+#ifndef ENSEMBLE_HPP_INCLUDED
+#define ENSEMBLE_HPP_INCLUDED
+
+/**
+ * \file     ensemble.hpp
+ * \mainpage Parameters of an ensemble of independent simulations sharing a single population object
+ *
+ * \note     Parameter studies (e.g. Reynolds number or inlet velocity sweeps) on small grids are limited
+ *           by memory bandwidth and the setup of the geometry. An ensemble packs K independent cases of the
+ *           same geometry into the NPOP = K populations of a single population object with the layout
+ *           layout::Interleaved so that the cases are the innermost dimension and can be mapped to the
+ *           SIMD lanes. All cases share the geometry, the fluid cell list and the neighbour indices while
+ *           every case has its own collision frequency, boundary values and macroscopic values.
+*/
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <stdlib.h>
+#include <type_traits>
+#include <utility>
+
+
+/**\brief  Array holding an object for every case of an ensemble (e.g. the continuum or the boundaries)
+ * \note   The number of cases is not deduced from the array but from the population object
+ *
+ * \tparam C   type of the object of every case
+ * \tparam K   number of cases in the ensemble (NPOP of the population object)
+*/
+template <class C, unsigned int K>
+using EnsembleArray = std::array<C,static_cast<size_t>(K)>;
+
+/**\fn        MakeEnsembleArray
+ * \brief     Array holding a copy of an object for every case of an ensemble (e.g. the fused boundaries of
+ *            cases sharing their boundary values)
+ *
+ * \tparam    K        number of cases in the ensemble (NPOP of the population object)
+ * \tparam    C        type of the object of every case
+ * \tparam    I        indices of the cases
+ * \param[in] object   object copied to every case
+ * \return    array holding a copy for every case
+*/
+template <unsigned int K, class C, size_t... I>
+EnsembleArray<C,K> MakeEnsembleArray(C const& object, std::index_sequence<I...>)
+{
+    return {{ (static_cast<void>(I), object)... }};
+}
+
+template <unsigned int K, class C>
+EnsembleArray<C,K> MakeEnsembleArray(C const& object)
+{
+    return MakeEnsembleArray<K>(object, std::make_index_sequence<K>());
+}
+
+/**\struct ensembleLane
+ * \brief  View of the distributions of a single case of an ensemble stored direction by direction
+ *         for all cases ([ND][K]) that can be indexed by the lattice velocity like the array of a single
+ *         cell. Inside a SIMD loop over the cases the accesses of all lanes are contiguous.
+ *
+ * \tparam T    floating data type used for simulation
+ * \tparam ND   number of distributions of a cell including padding
+ * \tparam K    number of cases in the ensemble
+*/
+template <typename T, unsigned int ND, unsigned int K>
+struct ensembleLane
+{
+    T (&f)[ND][K];
+    unsigned int const k;
+
+    inline T& operator[] (unsigned int const i) const
+    {
+        return f[i][k];
+    }
+};
+
+/**\class  EnsembleParameters
+ * \brief  Physical parameters of every case of an ensemble
+ *
+ * \tparam K    number of cases in the ensemble (NPOP of the population object)
+ * \tparam LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam T    floating data type used for simulation
+*/
+template <unsigned int K, class LT, typename T = typename std::remove_const<decltype(LT::CS)>::type>
+class EnsembleParameters
+{
+    public:
+        /// physical parameters of every case
+        std::array<T,K> NU_;    // kinematic simulation viscosity
+        std::array<T,K> TAU_;   // laminar relaxation time
+        std::array<T,K> OMEGA_; // collision frequency
+
+        /**\brief Class constructor
+         * \param Re   simulation Reynolds number of every case
+         * \param U    characteristic velocity of every case in lattice units
+         * \param L    characteristic length of the simulation in lattice units (shared geometry)
+        */
+        EnsembleParameters(std::array<T,K> const& Re, std::array<T,K> const& U, unsigned int const L):
+            NU_(), TAU_(), OMEGA_()
+        {
+            for(unsigned int k = 0; k < K; ++k)
+            {
+                if (Re[k] <= 0.0)
+                {
+                    std::cerr << "Fatal error: Reynolds number of ensemble case " << k << " has to be positive." << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+
+                NU_[k]    = U[k]*static_cast<T>(L) / Re[k];
+                TAU_[k]   = NU_[k]/(LT::CS*LT::CS) + 1.0/2.0;
+                OMEGA_[k] = 1.0/TAU_[k];
+            }
+        }
+};
+
+#endif // ENSEMBLE_HPP_INCLUDED
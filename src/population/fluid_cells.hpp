@@ -0,0 +1,389 @@
+#ifndef FLUID_CELLS_HPP_INCLUDED
+#define FLUID_CELLS_HPP_INCLUDED
+
+/**
+ * \file     fluid_cells.hpp
+ * \mainpage Class for indirect addressing of the fluid cells of a geometry
+ *
+ * \note     Porous and complex geometries consist to a large extent of solid cells that are
+ *           collided only to be overwritten by the bounce-back boundaries afterwards. This class
+ *           holds a list of all fluid cells sorted by the loop blocks of the population together
+ *           with their pre-computed periodic neighbours so that the collision kernels only have
+ *           to sweep over the fluid cells.
+ *           Additionally every fluid cell carries a mask of its links towards solid neighbours so that
+ *           the halfway bounce-back can be applied by the collision kernels directly after the collision
+ *           of the cell while it is still in cache instead of a separate sweep over the wall cells.
+ *           By default the list uses the cubic loop blocks of the population but any other (also
+ *           non-cubic) block shape can be given at run time, e.g. the one found by the autotuner (see
+ *           autotuning.hpp). The collision kernels only depend on the blocks of the list.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../general/memory_alignment.hpp"
+#include "boundary/boundary.hpp"
+#include "moments.hpp"
+#include "population.hpp"
+
+
+/**\struct fluidCell
+ * \brief  Struct holding the coordinates of a fluid cell and of its periodic neighbours
+*/
+struct fluidCell
+{
+    unsigned int x_n[3]; ///< x coordinates of the cell and its neighbours [x-1,x,x+1]
+    unsigned int y_n[3]; ///< y coordinates of the cell and its neighbours [y-1,y,y+1]
+    unsigned int z_n[3]; ///< z coordinates of the cell and its neighbours [z-1,z,z+1]
+    uint32_t     solid;  ///< links n*OFF + d pointing towards solid neighbours (bit mask)
+};
+
+
+/**\class  FluidCells
+ * \brief  Class holding a list of all fluid cells and their neighbours sorted by loop blocks.
+ *         The solid cells are taken from the wall boundary vector generated by the geometry.
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+class FluidCells
+{
+    public:
+        /// block decomposition (by default the one of the corresponding population)
+        unsigned int const BLOCK_SIZE_X_;
+        unsigned int const BLOCK_SIZE_Y_;
+        unsigned int const BLOCK_SIZE_Z_;
+        unsigned int const NUM_BLOCKS_X_;
+        unsigned int const NUM_BLOCKS_Y_;
+        unsigned int const NUM_BLOCKS_Z_;
+        unsigned int const   NUM_BLOCKS_;
+
+        /// range of planes in z-direction covered by the list
+        unsigned int const Z_MIN_;
+        unsigned int const Z_MAX_;
+
+        /// fluid cells sorted by block and the index of the first fluid cell of every block
+        //  (not initialised on resize so that every block is first touched by the thread colliding it)
+        std::vector<fluidCell, DefaultInitAllocator<fluidCell>> cells_;
+        std::vector<size_t>    blocks_;
+
+        /// solid cells of the full domain
+        std::vector<bool>      isSolid_;
+
+
+        /**\brief Class constructor
+         * \param pop     population object whose block decomposition should be used
+         * \param solid   vector holding all solid cells (e.g. wall boundary elements)
+         * \param z_min   first plane in z-direction that should be included (default = 0)
+         * \param z_max   plane after the last plane in z-direction that should be included (default = NZ)
+         * \param block   loop block shape in x-, y- and z-direction (default = 0: cubic blocks of the population)
+        */
+        template <class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+        FluidCells(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, std::vector<boundaryElement<T>> const& solid,
+                   unsigned int const z_min = 0, unsigned int const z_max = NZ, std::array<unsigned int,3> const& block = {0, 0, 0});
+        template <class LT, class ST, typename T>
+        FluidCells(MomentPopulation<NX,NY,NZ,LT,ST> const& mom, std::vector<boundaryElement<T>> const& solid,
+                   unsigned int const z_min = 0, unsigned int const z_max = NZ, std::array<unsigned int,3> const& block = {0, 0, 0});
+
+        /// access functions
+        inline size_t BlockBegin(unsigned int const block) const;
+        inline size_t BlockEnd(unsigned int const block) const;
+        inline size_t GetNumberOfCells() const;
+        inline size_t GetMemorySize() const;
+        inline unsigned int GetBlock(unsigned int const x, unsigned int const y, unsigned int const z) const;
+        inline bool         IsFluid(unsigned int const x, unsigned int const y, unsigned int const z) const;
+
+    private:
+        /// block size in a direction: the given one (at most the domain size) or the one of the population
+        static unsigned int BlockSize(unsigned int const block, unsigned int const fallback, unsigned int const n);
+
+        /// mark solid cells and fill the list of fluid cells with their links towards solid neighbours
+        template <class LT, typename T>
+        void Classify(std::vector<boundaryElement<T>> const& solid, unsigned int const z_min, unsigned int const z_max);
+};
+
+
+/**\fn        FluidCells
+ * \brief     Build the fluid cell list from a vector of solid cells. Each block is counted and filled
+ *            by the thread that will later on collide it. Optionally the list can be restricted to a
+ *            range of planes in z-direction (e.g. to collide ghost layer neighbours separately).
+ *            The links of every fluid cell towards solid neighbours are marked for the fused bounce-back.
+ *
+ * \tparam    LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP    number of populations stored side by side in the lattice
+ * \tparam    LY      memory layout policy of the populations
+ * \tparam    ST      storage policy of the populations
+ * \tparam    SP      streaming policy of the populations
+ * \tparam    T       floating data type used for simulation
+ * \param[in] pop     population object whose block decomposition should be used
+ * \param[in] solid   vector holding all solid cells (e.g. wall boundary elements)
+ * \param[in] z_min   first plane in z-direction that should be included
+ * \param[in] z_max   plane after the last plane in z-direction that should be included
+ * \param[in] block   loop block shape in x-, y- and z-direction (0 = block size of the population)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ> template <class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+FluidCells<NX,NY,NZ>::FluidCells(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, std::vector<boundaryElement<T>> const& solid,
+                                 unsigned int const z_min, unsigned int const z_max, std::array<unsigned int,3> const& block):
+    BLOCK_SIZE_X_(BlockSize(block[0], pop.BLOCK_SIZE_, NX)), BLOCK_SIZE_Y_(BlockSize(block[1], pop.BLOCK_SIZE_, NY)),
+    BLOCK_SIZE_Z_(BlockSize(block[2], pop.BLOCK_SIZE_, NZ)), NUM_BLOCKS_X_((NX + BLOCK_SIZE_X_ - 1)/BLOCK_SIZE_X_),
+    NUM_BLOCKS_Y_((NY + BLOCK_SIZE_Y_ - 1)/BLOCK_SIZE_Y_), NUM_BLOCKS_Z_((NZ + BLOCK_SIZE_Z_ - 1)/BLOCK_SIZE_Z_),
+    NUM_BLOCKS_(NUM_BLOCKS_X_*NUM_BLOCKS_Y_*NUM_BLOCKS_Z_), Z_MIN_(z_min), Z_MAX_(z_max),
+    cells_(), blocks_(NUM_BLOCKS_ + 1, 0), isSolid_(static_cast<size_t>(NX)*NY*NZ, false)
+{
+    Classify<LT>(solid, z_min, z_max);
+}
+
+/**\fn        FluidCells
+ * \brief     Build the fluid cell list for a lattice stored in moment space (see moments.hpp). The
+ *            links of every fluid cell towards solid neighbours are used for the halfway bounce-back
+ *            when the populations are reconstructed from the moments of the neighbours.
+ *
+ * \tparam    LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam    ST      storage policy of the moments
+ * \tparam    T       floating data type used for simulation
+ * \param[in] mom     moment population object whose block decomposition should be used
+ * \param[in] solid   vector holding all solid cells (e.g. wall boundary elements)
+ * \param[in] z_min   first plane in z-direction that should be included
+ * \param[in] z_max   plane after the last plane in z-direction that should be included
+ * \param[in] block   loop block shape in x-, y- and z-direction (0 = block size of the moment population)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ> template <class LT, class ST, typename T>
+FluidCells<NX,NY,NZ>::FluidCells(MomentPopulation<NX,NY,NZ,LT,ST> const& mom, std::vector<boundaryElement<T>> const& solid,
+                                 unsigned int const z_min, unsigned int const z_max, std::array<unsigned int,3> const& block):
+    BLOCK_SIZE_X_(BlockSize(block[0], mom.BLOCK_SIZE_, NX)), BLOCK_SIZE_Y_(BlockSize(block[1], mom.BLOCK_SIZE_, NY)),
+    BLOCK_SIZE_Z_(BlockSize(block[2], mom.BLOCK_SIZE_, NZ)), NUM_BLOCKS_X_((NX + BLOCK_SIZE_X_ - 1)/BLOCK_SIZE_X_),
+    NUM_BLOCKS_Y_((NY + BLOCK_SIZE_Y_ - 1)/BLOCK_SIZE_Y_), NUM_BLOCKS_Z_((NZ + BLOCK_SIZE_Z_ - 1)/BLOCK_SIZE_Z_),
+    NUM_BLOCKS_(NUM_BLOCKS_X_*NUM_BLOCKS_Y_*NUM_BLOCKS_Z_), Z_MIN_(z_min), Z_MAX_(z_max),
+    cells_(), blocks_(NUM_BLOCKS_ + 1, 0), isSolid_(static_cast<size_t>(NX)*NY*NZ, false)
+{
+    Classify<LT>(solid, z_min, z_max);
+}
+
+/**\fn        BlockSize
+ * \brief     Block size in a single direction
+ *
+ * \param[in] block      the requested block size (0 = fallback)
+ * \param[in] fallback   block size of the population
+ * \param[in] n          domain resolution in this direction
+ * \return    block size between 1 and the domain resolution
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+unsigned int FluidCells<NX,NY,NZ>::BlockSize(unsigned int const block, unsigned int const fallback, unsigned int const n)
+{
+    return std::max(1u, std::min((block == 0) ? fallback : block, n));
+}
+
+/**\fn        Classify
+ * \brief     Mark the solid cells, count and fill the fluid cells of every block by the thread that will
+ *            later on collide it and mark the links of every fluid cell towards solid neighbours
+ *
+ * \tparam    LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam    T       floating data type used for simulation
+ * \param[in] solid   vector holding all solid cells (e.g. wall boundary elements)
+ * \param[in] z_min   first plane in z-direction that should be included
+ * \param[in] z_max   plane after the last plane in z-direction that should be included
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ> template <class LT, typename T>
+void FluidCells<NX,NY,NZ>::Classify(std::vector<boundaryElement<T>> const& solid, unsigned int const z_min, unsigned int const z_max)
+{
+    static_assert(LT::ND <= 32, "Link mask of fluid cells limited to 32 populations.");
+
+    /// mark solid cells (kept for the classification of boundary cells)
+    std::vector<bool>& isSolid = isSolid_;
+    for(size_t i = 0; i < solid.size(); ++i)
+    {
+        isSolid[(static_cast<size_t>(solid[i].z)*NY + solid[i].y)*NX + solid[i].x] = true;
+    }
+
+    /// count fluid cells per block
+    std::vector<size_t> count(NUM_BLOCKS_, 0);
+
+    #pragma omp parallel for default(none) shared(isSolid, count) firstprivate(z_min, z_max) schedule(static,1)
+    for(unsigned int block = 0; block < NUM_BLOCKS_; ++block)
+    {
+        unsigned int const z_block = BLOCK_SIZE_Z_ * (block / (NUM_BLOCKS_X_*NUM_BLOCKS_Y_));
+        unsigned int const z_start = std::max(z_block, z_min);
+        unsigned int const   z_end = std::min(std::min(z_block + BLOCK_SIZE_Z_, NZ), z_max);
+        unsigned int const y_start = BLOCK_SIZE_Y_*((block % (NUM_BLOCKS_X_*NUM_BLOCKS_Y_)) / NUM_BLOCKS_X_);
+        unsigned int const   y_end = std::min(y_start + BLOCK_SIZE_Y_, NY);
+        unsigned int const x_start = BLOCK_SIZE_X_*(block % NUM_BLOCKS_X_);
+        unsigned int const   x_end = std::min(x_start + BLOCK_SIZE_X_, NX);
+
+        size_t n = 0;
+        for(unsigned int z = z_start; z < z_end; ++z)
+        {
+            for(unsigned int y = y_start; y < y_end; ++y)
+            {
+                for(unsigned int x = x_start; x < x_end; ++x)
+                {
+                    n += !isSolid[(static_cast<size_t>(z)*NY + y)*NX + x];
+                }
+            }
+        }
+        count[block] = n;
+    }
+
+    for(unsigned int block = 0; block < NUM_BLOCKS_; ++block)
+    {
+        blocks_[block + 1] = blocks_[block] + count[block];
+    }
+    cells_.resize(blocks_[NUM_BLOCKS_]);
+
+    /// fill list with fluid cells and their periodic neighbours
+    #pragma omp parallel for default(none) shared(isSolid) firstprivate(z_min, z_max) schedule(static,1)
+    for(unsigned int block = 0; block < NUM_BLOCKS_; ++block)
+    {
+        unsigned int const z_block = BLOCK_SIZE_Z_ * (block / (NUM_BLOCKS_X_*NUM_BLOCKS_Y_));
+        unsigned int const z_start = std::max(z_block, z_min);
+        unsigned int const   z_end = std::min(std::min(z_block + BLOCK_SIZE_Z_, NZ), z_max);
+        unsigned int const y_start = BLOCK_SIZE_Y_*((block % (NUM_BLOCKS_X_*NUM_BLOCKS_Y_)) / NUM_BLOCKS_X_);
+        unsigned int const   y_end = std::min(y_start + BLOCK_SIZE_Y_, NY);
+        unsigned int const x_start = BLOCK_SIZE_X_*(block % NUM_BLOCKS_X_);
+        unsigned int const   x_end = std::min(x_start + BLOCK_SIZE_X_, NX);
+
+        size_t i = blocks_[block];
+        for(unsigned int z = z_start; z < z_end; ++z)
+        {
+            for(unsigned int y = y_start; y < y_end; ++y)
+            {
+                for(unsigned int x = x_start; x < x_end; ++x)
+                {
+                    if (isSolid[(static_cast<size_t>(z)*NY + y)*NX + x] == false)
+                    {
+                        cells_[i] = { { (NX + x - 1) % NX, x, (x + 1) % NX },
+                                      { (NY + y - 1) % NY, y, (y + 1) % NY },
+                                      { (NZ + z - 1) % NZ, z, (z + 1) % NZ }, 0 };
+
+                        fluidCell& cell = cells_[i];
+                        for(unsigned int n = 0; n <= 1; ++n)
+                        {
+                            for(unsigned int d = 1; d < LT::HSPEED; ++d)
+                            {
+                                unsigned int const curr = n*LT::OFF + d;
+                                size_t const neighbour = (static_cast<size_t>(cell.z_n[1 + static_cast<int>(LT::DZ[curr])])*NY +
+                                                                              cell.y_n[1 + static_cast<int>(LT::DY[curr])])*NX +
+                                                                              cell.x_n[1 + static_cast<int>(LT::DX[curr])];
+                                cell.solid |= static_cast<uint32_t>(isSolid[neighbour]) << curr;
+                            }
+                        }
+                        ++i;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**\fn     BlockBegin
+ * \brief  Index of the first fluid cell of a given block
+ *
+ * \param[in] block   the block of interest
+ * \return    index of the first fluid cell inside the block
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t FluidCells<NX,NY,NZ>::BlockBegin(unsigned int const block) const
+{
+    return blocks_[block];
+}
+
+/**\fn     BlockEnd
+ * \brief  Index after the last fluid cell of a given block
+ *
+ * \param[in] block   the block of interest
+ * \return    index after the last fluid cell inside the block
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t FluidCells<NX,NY,NZ>::BlockEnd(unsigned int const block) const
+{
+    return blocks_[block + 1];
+}
+
+/**\fn     GetNumberOfCells
+ * \brief  Total number of fluid cells
+ *
+ * \return number of fluid cells
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t FluidCells<NX,NY,NZ>::GetNumberOfCells() const
+{
+    return cells_.size();
+}
+
+/**\fn     GetMemorySize
+ * \brief  Memory occupied by the fluid cell list and the block indices
+ *
+ * \return memory in bytes
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t FluidCells<NX,NY,NZ>::GetMemorySize() const
+{
+    return cells_.size()*sizeof(fluidCell) + blocks_.size()*sizeof(size_t) + isSolid_.size()/8;
+}
+
+/**\fn     GetBlock
+ * \brief  Loop block a given cell belongs to
+ *
+ * \param[in] x   x coordinate of the cell
+ * \param[in] y   y coordinate of the cell
+ * \param[in] z   z coordinate of the cell
+ * \return    index of the corresponding block
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline unsigned int FluidCells<NX,NY,NZ>::GetBlock(unsigned int const x, unsigned int const y, unsigned int const z) const
+{
+    return ((z/BLOCK_SIZE_Z_)*NUM_BLOCKS_Y_ + y/BLOCK_SIZE_Y_)*NUM_BLOCKS_X_ + x/BLOCK_SIZE_X_;
+}
+
+/**\fn     IsFluid
+ * \brief  Check if a given cell is part of the fluid cell list
+ *
+ * \param[in] x   x coordinate of the cell
+ * \param[in] y   y coordinate of the cell
+ * \param[in] z   z coordinate of the cell
+ * \return    Boolean true if the cell is a fluid cell inside the range in z-direction, false otherwise
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline bool FluidCells<NX,NY,NZ>::IsFluid(unsigned int const x, unsigned int const y, unsigned int const z) const
+{
+    return (z >= Z_MIN_) && (z < Z_MAX_) && (isSolid_[(static_cast<size_t>(z)*NY + y)*NX + x] == false);
+}
+
+/**\fn            ApplyBlockBoundaries
+ * \brief         Apply all fused boundaries of a given block before the block is collided
+ *
+ * \tparam        odd          even (0, false) or odd (1, true) time step
+ * \tparam        NX           simulation domain resolution in x-direction
+ * \tparam        NY           simulation domain resolution in y-direction
+ * \tparam        NZ           simulation domain resolution in z-direction
+ * \tparam        LT           static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP         number of populations stored side by side in the lattice
+ * \tparam        LY           memory layout policy of the populations
+ * \tparam        ST           storage policy of the populations
+ * \tparam        SP           streaming policy of the populations
+ * \tparam        BC           types of the fused boundaries (e.g. FusedGuo)
+ * \param[in]     boundaries   tuple holding references to all fused boundaries
+ * \param[in,out] pop          population object holding microscopic variables
+ * \param[in]     block        the block of interest
+ * \param[in]     p            relevant population
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, class... BC>
+inline void ApplyBlockBoundaries(std::tuple<BC const&...> const& boundaries, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop,
+                                 unsigned int const block, unsigned int const p)
+{
+    std::apply([&pop, block, p](BC const&... b)
+    {
+        (void)pop; (void)block; (void)p;
+        (b. template ApplyBlock<odd>(pop, block, p), ...);
+    }, boundaries);
+}
+
+#endif // FLUID_CELLS_HPP_INCLUDED
@@ -0,0 +1,308 @@
+#ifndef HALO_EXCHANGE_HPP_INCLUDED
+#define HALO_EXCHANGE_HPP_INCLUDED
+
+/**
+ * \file     halo_exchange.hpp
+ * \mainpage Class for the exchange of populations across the faces of neighbouring subdomains
+ *
+ * \note     With the A-A access pattern only the odd time step accesses neighbouring cells: every cell
+ *           reads and writes exactly the same populations of its neighbours. Therefore only those
+ *           populations that cross a face have to be communicated, and this happens twice per double
+ *           time step:
+ *           - After the even collision the boundary planes are copied to the ghost layers of the
+ *             neighbouring processes (ghost update) as they will be read in the odd step.
+ *           - After the odd collision the values that were streamed into the ghost layers are sent
+ *             back to the processes owning them (write-back) as they will be read in the even step.
+ *           Both exchanges are non-blocking so that they can be overlapped with the collision of the
+ *           inner cells. Only the master thread communicates (MPI_THREAD_FUNNELED).
+ *           The esoteric pull accesses neighbouring cells in every time step and is not supported.
+ * \warning  Only available if compiled with MPI support ('make MPI=true' defines USE_MPI)
+*/
+
+#ifdef USE_MPI
+
+#include <type_traits>
+#include <vector>
+#include <mpi.h>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../general/distribution.hpp"
+#include "../general/memory_alignment.hpp"
+#include "population.hpp"
+
+
+/**\class  HaloExchange
+ * \brief  Class holding the communication buffers and the non-blocking requests of the halo exchange
+ *         of a subdomain with a ghost layer in z-direction at z = 0 and z = NZ - 1
+ *
+ * \tparam NX     simulation domain resolution in x-direction
+ * \tparam NY     simulation domain resolution in y-direction
+ * \tparam NZ     local simulation domain resolution in z-direction including both ghost layers
+ * \tparam LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam NPOP   number of populations stored side by side in the lattice (default = 1)
+ * \tparam LY     memory layout policy of the populations (default = AoS)
+ * \tparam ST     storage policy of the populations (default = Native)
+ * \tparam SP     streaming policy of the populations (default = AA)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP = 1, class LY = layout::AoS, class ST = storage::Native, class SP = streaming::AA>
+class HaloExchange
+{
+    public:
+        /// floating data type used for simulation
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+        /// populations are exchanged in their storage data type
+        typedef typename Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::S S;
+        /// communication buffers are allocated with the memory policy and remain untouched until they are packed
+        typedef std::vector<S,DefaultInitAllocator<S,AlignedAllocator<S>>> Buffer;
+
+        /// positions of ghost layers and boundary planes in z-direction
+        static constexpr unsigned int GHOST_LOWER_ = 0;
+        static constexpr unsigned int INNER_LOWER_ = 1;
+        static constexpr unsigned int INNER_UPPER_ = NZ - 2;
+        static constexpr unsigned int GHOST_UPPER_ = NZ - 1;
+
+        /// communicator and neighbouring processes
+        MPI_Comm const comm_;
+        int const      lower_;
+        int const      upper_;
+
+        /// populations crossing the lower and upper face (n and d of every population)
+        std::vector<unsigned int> lowerN_;
+        std::vector<unsigned int> lowerD_;
+        std::vector<unsigned int> upperN_;
+        std::vector<unsigned int> upperD_;
+
+        /// communication buffers in direction of the lower and upper neighbour
+        Buffer sendLower_;
+        Buffer sendUpper_;
+        Buffer recvLower_;
+        Buffer recvUpper_;
+
+        MPI_Request requests_[4];
+
+
+        /**\brief Class constructor
+         * \param comm    communicator of all processes sharing the domain
+         * \param lower   rank of the process holding the lower neighbouring subdomain
+         * \param upper   rank of the process holding the upper neighbouring subdomain
+        */
+        HaloExchange(MPI_Comm const comm, int const lower, int const upper);
+
+        HaloExchange(HaloExchange const&) = delete;
+        HaloExchange& operator= (HaloExchange const&) = delete;
+
+        /// exchange of boundary planes into the ghost layers (before odd time step)
+        void StartGhostUpdate(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop);
+        void FinishGhostUpdate(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop);
+
+        /// exchange of ghost layers back to the boundary planes (before even time step)
+        void StartWriteBack(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop);
+        void FinishWriteBack(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop);
+
+    private:
+        void Pack(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, unsigned int const z,
+                  std::vector<unsigned int> const& n, std::vector<unsigned int> const& d, Buffer& buffer) const;
+        void Unpack(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const z,
+                    std::vector<unsigned int> const& n, std::vector<unsigned int> const& d, Buffer const& buffer) const;
+        void Start(Buffer const& sendLower, Buffer const& sendUpper);
+};
+
+
+/**\fn        HaloExchange
+ * \brief     Determine the populations crossing each face and allocate the communication buffers.
+ *            A population (n,d) of a ghost cell is accessed by the inner cells in the odd time step
+ *            if the opposite lattice velocity (!n,d) points away from the inner cells.
+ *
+ * \param[in] comm    communicator of all processes sharing the domain
+ * \param[in] lower   rank of the process holding the lower neighbouring subdomain
+ * \param[in] upper   rank of the process holding the upper neighbouring subdomain
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+HaloExchange<NX,NY,NZ,LT,NPOP,LY,ST,SP>::HaloExchange(MPI_Comm const comm, int const lower, int const upper):
+    comm_(comm), lower_(lower), upper_(upper), lowerN_(), lowerD_(), upperN_(), upperD_(),
+    sendLower_(), sendUpper_(), recvLower_(), recvUpper_(), requests_()
+{
+    static_assert(NZ >= 4, "Subdomain requires at least two inner planes and two ghost layers in z-direction.");
+    static_assert(std::is_same<SP,streaming::AA>::value, "Halo exchange is only implemented for the A-A access pattern.");
+
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            T const dz = LT::DZ[(!n)*LT::OFF + d];
+
+            if (dz < 0)
+            {
+                lowerN_.push_back(n);
+                lowerD_.push_back(d);
+            }
+            else if (dz > 0)
+            {
+                upperN_.push_back(n);
+                upperD_.push_back(d);
+            }
+        }
+    }
+
+    size_t const plane = static_cast<size_t>(NX)*NY*NPOP;
+    sendLower_.resize(plane*upperN_.size());
+    recvLower_.resize(plane*lowerN_.size());
+    sendUpper_.resize(plane*lowerN_.size());
+    recvUpper_.resize(plane*upperN_.size());
+
+    for(unsigned int i = 0; i < 4; ++i)
+    {
+        requests_[i] = MPI_REQUEST_NULL;
+    }
+}
+
+/**\fn        Pack
+ * \brief     Copy the given populations of a plane in z-direction to a contiguous buffer
+ *
+ * \param[in]  pop      population object holding microscopic variables
+ * \param[in]  z        plane in z-direction
+ * \param[in]  n        positive (0) or negative (1) index of the populations to be copied
+ * \param[in]  d        population index of the populations to be copied
+ * \param[out] buffer   contiguous communication buffer
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void HaloExchange<NX,NY,NZ,LT,NPOP,LY,ST,SP>::Pack(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, unsigned int const z,
+                                               std::vector<unsigned int> const& n, std::vector<unsigned int> const& d, Buffer& buffer) const
+{
+    unsigned int const num = static_cast<unsigned int>(n.size());
+
+    #pragma omp parallel for default(none) shared(pop, n, d, buffer) firstprivate(z, num) schedule(static)
+    for(unsigned int y = 0; y < NY; ++y)
+    {
+        for(unsigned int x = 0; x < NX; ++x)
+        {
+            for(unsigned int p = 0; p < NPOP; ++p)
+            {
+                size_t const cell = ((static_cast<size_t>(y)*NX + x)*NPOP + p)*num;
+
+                for(unsigned int i = 0; i < num; ++i)
+                {
+                    buffer[cell + i] = pop.F_[pop.SpatialToLinear(x, y, z, n[i], d[i], p)];
+                }
+            }
+        }
+    }
+}
+
+/**\fn        Unpack
+ * \brief     Copy a contiguous buffer to the given populations of a plane in z-direction
+ *
+ * \param[out] pop      population object holding microscopic variables
+ * \param[in]  z        plane in z-direction
+ * \param[in]  n        positive (0) or negative (1) index of the populations to be copied
+ * \param[in]  d        population index of the populations to be copied
+ * \param[in]  buffer   contiguous communication buffer
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void HaloExchange<NX,NY,NZ,LT,NPOP,LY,ST,SP>::Unpack(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const z,
+                                                 std::vector<unsigned int> const& n, std::vector<unsigned int> const& d, Buffer const& buffer) const
+{
+    unsigned int const num = static_cast<unsigned int>(n.size());
+
+    #pragma omp parallel for default(none) shared(pop, n, d, buffer) firstprivate(z, num) schedule(static)
+    for(unsigned int y = 0; y < NY; ++y)
+    {
+        for(unsigned int x = 0; x < NX; ++x)
+        {
+            for(unsigned int p = 0; p < NPOP; ++p)
+            {
+                size_t const cell = ((static_cast<size_t>(y)*NX + x)*NPOP + p)*num;
+
+                for(unsigned int i = 0; i < num; ++i)
+                {
+                    pop.F_[pop.SpatialToLinear(x, y, z, n[i], d[i], p)] = buffer[cell + i];
+                }
+            }
+        }
+    }
+}
+
+/**\fn        Start
+ * \brief     Post the non-blocking receives and sends to both neighbours. Messages carrying the
+ *            populations of the lower face use tag 0, the ones of the upper face tag 1.
+ *
+ * \param[in] sendLower   buffer to be sent to the lower neighbour
+ * \param[in] sendUpper   buffer to be sent to the upper neighbour
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void HaloExchange<NX,NY,NZ,LT,NPOP,LY,ST,SP>::Start(Buffer const& sendLower, Buffer const& sendUpper)
+{
+    MPI_Irecv(recvLower_.data(), static_cast<int>(recvLower_.size()), MpiDatatype<S>(), lower_, 0, comm_, &requests_[0]);
+    MPI_Irecv(recvUpper_.data(), static_cast<int>(recvUpper_.size()), MpiDatatype<S>(), upper_, 1, comm_, &requests_[1]);
+    MPI_Isend(sendUpper.data(),  static_cast<int>(sendUpper.size()),  MpiDatatype<S>(), upper_, 0, comm_, &requests_[2]);
+    MPI_Isend(sendLower.data(),  static_cast<int>(sendLower.size()),  MpiDatatype<S>(), lower_, 1, comm_, &requests_[3]);
+}
+
+/**\fn        StartGhostUpdate
+ * \brief     Start copying the boundary planes after the even collision to the ghost layers of the
+ *            neighbouring processes. Has to be called after the cells next to the ghost layers have
+ *            been collided in the even time step.
+ *
+ * \param[in] pop   population object holding microscopic variables
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void HaloExchange<NX,NY,NZ,LT,NPOP,LY,ST,SP>::StartGhostUpdate(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop)
+{
+    Pack(pop, INNER_UPPER_, lowerN_, lowerD_, sendUpper_);
+    Pack(pop, INNER_LOWER_, upperN_, upperD_, sendLower_);
+    Start(sendLower_, sendUpper_);
+}
+
+/**\fn        FinishGhostUpdate
+ * \brief     Wait for the ghost layers and copy them to the population. Has to be called before the
+ *            bounce-back of the even time step.
+ *
+ * \param[out] pop   population object holding microscopic variables
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void HaloExchange<NX,NY,NZ,LT,NPOP,LY,ST,SP>::FinishGhostUpdate(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop)
+{
+    MPI_Waitall(4, requests_, MPI_STATUSES_IGNORE);
+    Unpack(pop, GHOST_LOWER_, lowerN_, lowerD_, recvLower_);
+    Unpack(pop, GHOST_UPPER_, upperN_, upperD_, recvUpper_);
+}
+
+/**\fn        StartWriteBack
+ * \brief     Start sending the populations streamed into the ghost layers during the odd time step
+ *            back to the processes owning them. Has to be called after the cells next to the ghost
+ *            layers have been collided in the odd time step.
+ *
+ * \param[in] pop   population object holding microscopic variables
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void HaloExchange<NX,NY,NZ,LT,NPOP,LY,ST,SP>::StartWriteBack(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop)
+{
+    /// buffers are reused with the same face: the lower ghost layer is sent to the lower neighbour
+    Pack(pop, GHOST_LOWER_, lowerN_, lowerD_, sendUpper_);
+    Pack(pop, GHOST_UPPER_, upperN_, upperD_, sendLower_);
+
+    MPI_Irecv(recvLower_.data(), static_cast<int>(recvLower_.size()), MpiDatatype<S>(), upper_, 0, comm_, &requests_[0]);
+    MPI_Irecv(recvUpper_.data(), static_cast<int>(recvUpper_.size()), MpiDatatype<S>(), lower_, 1, comm_, &requests_[1]);
+    MPI_Isend(sendUpper_.data(), static_cast<int>(sendUpper_.size()), MpiDatatype<S>(), lower_, 0, comm_, &requests_[2]);
+    MPI_Isend(sendLower_.data(), static_cast<int>(sendLower_.size()), MpiDatatype<S>(), upper_, 1, comm_, &requests_[3]);
+}
+
+/**\fn        FinishWriteBack
+ * \brief     Wait for the populations streamed over the faces by the neighbouring processes and copy
+ *            them to the boundary planes. Has to be called before the bounce-back of the odd time step.
+ *
+ * \param[out] pop   population object holding microscopic variables
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void HaloExchange<NX,NY,NZ,LT,NPOP,LY,ST,SP>::FinishWriteBack(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop)
+{
+    MPI_Waitall(4, requests_, MPI_STATUSES_IGNORE);
+    Unpack(pop, INNER_UPPER_, lowerN_, lowerD_, recvLower_);
+    Unpack(pop, INNER_LOWER_, upperN_, upperD_, recvUpper_);
+}
+
+#endif // USE_MPI
+
+#endif // HALO_EXCHANGE_HPP_INCLUDED
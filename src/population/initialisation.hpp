@@ -13,6 +13,9 @@
 #endif
 
 #include "../continuum/continuum.hpp"
+#include "../general/memory_alignment.hpp"
+#include "../lattice/equilibrium.hpp"
+#include "moments.hpp"
 #include "population.hpp"
 
 
@@ -24,13 +27,17 @@
  * \tparam     NY    simulation domain resolution in y-direction
  * \tparam     NZ    simulation domain resolution in z-direction
  * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP  number of populations stored side by side in the lattice
+ * \tparam     LY    memory layout policy of the populations
+ * \tparam     ST    storage policy of the populations
+ * \tparam     SP    streaming policy of the populations
  * \tparam     T     floating data type used for simulation
  * \param[in]  con   continuum object holding macroscopic variables
  * \param[out] pop   population object holding microscopic variables
  * \param[in]  p     relevant population (default = 0)
 */
-template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, typename T>
-void InitLattice(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT>& pop, unsigned int const p = 0)
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP, typename T>
+void InitLattice(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, unsigned int const p = 0)
 {
     #pragma omp parallel for default(none) shared(con, pop) firstprivate(p) schedule(static,1)
     for(unsigned int block = 0; block < pop.NUM_BLOCKS_; ++block)
@@ -61,7 +68,8 @@ void InitLattice(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT>& pop,
                     T const v   = con(x, y, z, 2);
                     T const w   = con(x, y, z, 3);
 
-                    T const uu = - 1.0/(2.0*LT::CS*LT::CS)*(u*u + v*v + w*w);
+                    alignas(CACHE_LINE) T feq[LT::ND] = {0.0};
+                    lattice::Equilibrium<LT>(rho, u, v, w, feq);
 
                     #pragma GCC unroll (2)
                     for(unsigned int n = 0; n <= 1; ++n)
@@ -69,9 +77,7 @@ void InitLattice(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT>& pop,
                         #pragma GCC unroll (16)
                         for(unsigned int d = n; d < LT::OFF; ++d)
                         {
-                            unsigned int const curr = n*LT::OFF + d;
-                            T const cu = 1.0/(LT::CS*LT::CS)*(u*LT::DX[curr] + v*LT::DY[curr] + w*LT::DZ[curr]);
-                            pop.F_[pop. template AA_IndexRead<odd>(x_n,y_n,z_n,n,d,p)] = LT::W[curr]*(rho + rho*(cu*(1.0 + 0.5*cu) + uu));
+                            pop.Store(pop. template IndexRead<odd>(x_n,y_n,z_n,n,d,p), n, d, feq[n*LT::OFF + d]);
                         }
                     }
                 }
@@ -80,4 +86,50 @@ void InitLattice(Continuum<NX,NY,NZ,T> const& con, Population<NX,NY,NZ,LT>& pop,
     }
 }
 
+/**\fn         InitLattice
+ * \brief      Initialise moments from continuum values: the populations are in equilibrium and the
+ *             non-equilibrium part of the second order moments vanishes
+ *
+ * \tparam     odd   even (0, false) or odd (1, true) time step
+ * \tparam     NX    simulation domain resolution in x-direction
+ * \tparam     NY    simulation domain resolution in y-direction
+ * \tparam     NZ    simulation domain resolution in z-direction
+ * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+ * \tparam     ST    storage policy of the moments
+ * \tparam     T     floating data type used for simulation
+ * \param[in]  con   continuum object holding macroscopic variables
+ * \param[out] mom   moment population object holding microscopic variables
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST, typename T>
+void InitLattice(Continuum<NX,NY,NZ,T> const& con, MomentPopulation<NX,NY,NZ,LT,ST>& mom)
+{
+    #pragma omp parallel for default(none) shared(con, mom) schedule(static,1)
+    for(unsigned int block = 0; block < mom.NUM_BLOCKS_; ++block)
+    {
+        unsigned int const z_start = mom.BLOCK_SIZE_ * (block / (mom.NUM_BLOCKS_X_*mom.NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + mom.BLOCK_SIZE_, NZ);
+
+        for(unsigned int z = z_start; z < z_end; ++z)
+        {
+            unsigned int const y_start = mom.BLOCK_SIZE_*((block % (mom.NUM_BLOCKS_X_*mom.NUM_BLOCKS_Y_)) / mom.NUM_BLOCKS_X_);
+            unsigned int const   y_end = std::min(y_start + mom.BLOCK_SIZE_, NY);
+
+            for(unsigned int y = y_start; y < y_end; ++y)
+            {
+                unsigned int const x_start = mom.BLOCK_SIZE_*(block % mom.NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + mom.BLOCK_SIZE_, NX);
+
+                for(unsigned int x = x_start; x < x_end; ++x)
+                {
+                    T const m[MomentPopulation<NX,NY,NZ,LT,ST>::NM_] = { con(x, y, z, 0), con(x, y, z, 1), con(x, y, z, 2), con(x, y, z, 3),
+                                                                       0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+                    /// moments read in the given time step
+                    mom. template Store<!odd>(x, y, z, m);
+                }
+            }
+        }
+    }
+}
+
 #endif // POPULATION_INITIALISATION_HPP_INCLUDED
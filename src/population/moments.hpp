@@ -0,0 +1,233 @@
+#ifndef MOMENTS_HPP_INCLUDED
+#define MOMENTS_HPP_INCLUDED
+
+/**
+ * \file     moments.hpp
+ * \mainpage Class for microscopic values stored in moment space
+ *
+ * \note     The populations after a regularised collision are fully determined by ten moments of every
+ *           cell: density, velocity and the non-equilibrium part of the second order moments. Instead of
+ *           all populations only these moments are stored and the populations are reconstructed from
+ *           the moments of the neighbours when they are streamed (pull) inside the fused collision
+ *           kernel (see collision_moments.hpp). As every cell pulls from its neighbours the moments are
+ *           held in two buffers that are swapped between even and odd time steps:
+ *           - even time steps read buffer 0 and write buffer 1,
+ *           - odd time steps read buffer 1 and write buffer 0.
+ *           The storage policy only decides on the precision the moments are stored in (storage::Native
+ *           or storage::Single) and the density is stored as the deviation from the reference density so
+ *           that single precision does not truncate the small density fluctuations. For D3Q27 a cell
+ *           requires 160 bytes in double and 80 bytes in single precision compared to 256 bytes of the
+ *           padded populations, while every update only reads and writes ten values instead of 27.
+ * \note     "Moment representation in the lattice Boltzmann method on massively parallel hardware"
+ *           M. Vardhan, J. Gounley, L. Hegele, E.W. Draeger, A. Randles
+ *           Proceedings of the International Conference for High Performance Computing, Networking,
+ *           Storage and Analysis (SC'19)
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+#include <type_traits>
+
+#include "../general/memory_alignment.hpp"
+#include "../general/constexpr_func.hpp"
+#include "population_storage.hpp"
+
+
+/**\class  MomentPopulation
+ * \brief  Class that holds the microscopic values of a lattice in moment space
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam ST   storage policy of the moments (storage::Native or storage::Single, default = Native)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST = storage::Native>
+class MomentPopulation
+{
+    public:
+        /// import current lattice floating data type
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+        /// data type the moments are stored in
+        typedef typename ST::template type<T> S;
+
+        static_assert(std::is_same<ST, storage::Native>::value || std::is_same<ST, storage::Single>::value,
+                      "Moments can only be stored with storage::Native or storage::Single.");
+
+        /// lattice characteristics
+        static constexpr unsigned int    DIM_ = LT::DIM;
+        static constexpr unsigned int SPEEDS_ = LT::SPEEDS;
+        static constexpr unsigned int HSPEED_ = LT::HSPEED;
+
+        /// moments per cell: density, velocity and non-equilibrium moments xx, yy, zz, xy, xz, yz
+        static constexpr unsigned int NM_ = 10;
+        static constexpr T       RHO_REF_ = 1.0; ///< reference density (density stored as deviation)
+
+        /// linear memory layout: two buffers of cells with NM_ consecutive moments each
+        static constexpr size_t  MEM_SIZE_ = sizeof(S)*2*NZ*NY*NX*static_cast<size_t>(NM_);
+
+        /// parallelism: 3D blocks (same decomposition as the populations)
+        static constexpr unsigned int   BLOCK_SIZE_ = LOOP_BLOCK_SIZE;
+        static constexpr unsigned int NUM_BLOCKS_Z_ = cef::ceil(static_cast<double>(NZ) / BLOCK_SIZE_);
+        static constexpr unsigned int NUM_BLOCKS_Y_ = cef::ceil(static_cast<double>(NY) / BLOCK_SIZE_);
+        static constexpr unsigned int NUM_BLOCKS_X_ = cef::ceil(static_cast<double>(NX) / BLOCK_SIZE_);
+        static constexpr unsigned int   NUM_BLOCKS_ = NUM_BLOCKS_X_*NUM_BLOCKS_Y_*NUM_BLOCKS_Z_;
+
+        /// pointer to moments
+        S* const M_ = static_cast<S*>(AllocateAligned(MEM_SIZE_));
+
+        /// physical parameters
+        T const NU_;    // kinematic simulation viscosity
+        T const TAU_;   // laminar relaxation time
+        T const OMEGA_; // collision frequency
+
+
+        /**\brief Class constructor
+         * \param Re   simulation Reynolds number
+         * \param U    characteristic velocity of the simulation in lattice units
+         * \param L    characteristic length of the simulation in lattice units
+        */
+        MomentPopulation(T const Re, T const U, unsigned int const L):
+            NU_(U*static_cast<T>(L) / Re), TAU_(NU_/(LT::CS*LT::CS) + 1.0/2.0), OMEGA_(1.0/TAU_)
+        {
+            if (M_ == nullptr)
+            {
+                std::cerr << "Fatal error: Moments could not be allocated." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            FirstTouch();
+        }
+
+        MomentPopulation(MomentPopulation const&) = delete;
+        MomentPopulation& operator= (MomentPopulation const&) = delete;
+
+        /**\brief Class destructor
+        */
+        ~MomentPopulation()
+        {
+            FreeAligned(M_);
+        }
+
+        /// indexing function
+        inline size_t SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
+                                      unsigned int const m, unsigned int const buffer) const;
+
+        /// moments read before (Load) and written after (Store) the collision of a time step
+        template <bool odd>
+        inline void Load(unsigned int const x, unsigned int const y, unsigned int const z, T (&m)[NM_]) const;
+        template <bool odd>
+        inline void Store(unsigned int const x, unsigned int const y, unsigned int const z, T const (&m)[NM_]);
+
+        /// memory footprint of the moments in bytes
+        static constexpr size_t GetMemorySize()
+        {
+            return MEM_SIZE_;
+        }
+
+    private:
+        /// NUMA-aware placement of the moments
+        void FirstTouch();
+};
+
+
+/**\fn        SpatialToLinear
+ * \brief     Convert the coordinates of a moment to its linear index
+ *
+ * \param[in] x        x coordinate of cell
+ * \param[in] y        y coordinate of cell
+ * \param[in] z        z coordinate of cell
+ * \param[in] m        index of the moment (0 = density, 1-3 = velocity, 4-9 = non-equilibrium moments)
+ * \param[in] buffer   buffer holding the moment (0 or 1)
+ * \return    linear index of the moment
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST>
+inline size_t MomentPopulation<NX,NY,NZ,LT,ST>::SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
+                                                                unsigned int const m, unsigned int const buffer) const
+{
+    return ((((static_cast<size_t>(buffer)*NZ + z)*NY + y)*NX + x)*NM_) + m;
+}
+
+/**\fn         Load
+ * \brief      Load the moments of a cell before the collision of a time step
+ *
+ * \tparam     odd   even (0, false) or odd (1, true) time step
+ * \param[in]  x     x coordinate of cell
+ * \param[in]  y     y coordinate of cell
+ * \param[in]  z     z coordinate of cell
+ * \param[out] m     moments of the cell in the floating data type of the lattice
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST> template <bool odd>
+inline void MomentPopulation<NX,NY,NZ,LT,ST>::Load(unsigned int const x, unsigned int const y, unsigned int const z, T (&m)[NM_]) const
+{
+    S const* const cell = &M_[SpatialToLinear(x, y, z, 0, odd)];
+
+    m[0] = RHO_REF_ + static_cast<T>(cell[0]);
+    #pragma GCC unroll (16)
+    for(unsigned int i = 1; i < NM_; ++i)
+    {
+        m[i] = static_cast<T>(cell[i]);
+    }
+}
+
+/**\fn        Store
+ * \brief     Store the moments of a cell after the collision of a time step
+ *
+ * \tparam    odd   even (0, false) or odd (1, true) time step
+ * \param[in] x     x coordinate of cell
+ * \param[in] y     y coordinate of cell
+ * \param[in] z     z coordinate of cell
+ * \param[in] m     moments of the cell in the floating data type of the lattice
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST> template <bool odd>
+inline void MomentPopulation<NX,NY,NZ,LT,ST>::Store(unsigned int const x, unsigned int const y, unsigned int const z, T const (&m)[NM_])
+{
+    S* const cell = &M_[SpatialToLinear(x, y, z, 0, !odd)];
+
+    cell[0] = static_cast<S>(m[0] - RHO_REF_);
+    #pragma GCC unroll (16)
+    for(unsigned int i = 1; i < NM_; ++i)
+    {
+        cell[i] = static_cast<S>(m[i]);
+    }
+}
+
+/**\fn        FirstTouch
+ * \brief     Touch both buffers for the first time with the same block-to-thread mapping as the
+ *            collision kernels. All moments are set to the fluid at rest with reference density.
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class ST>
+void MomentPopulation<NX,NY,NZ,LT,ST>::FirstTouch()
+{
+    #pragma omp parallel for default(none) schedule(static,1)
+    for(unsigned int block = 0; block < NUM_BLOCKS_; ++block)
+    {
+        unsigned int const z_start = BLOCK_SIZE_ * (block / (NUM_BLOCKS_X_*NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + BLOCK_SIZE_, NZ);
+
+        for(unsigned int z = z_start; z < z_end; ++z)
+        {
+            unsigned int const y_start = BLOCK_SIZE_*((block % (NUM_BLOCKS_X_*NUM_BLOCKS_Y_)) / NUM_BLOCKS_X_);
+            unsigned int const   y_end = std::min(y_start + BLOCK_SIZE_, NY);
+
+            for(unsigned int y = y_start; y < y_end; ++y)
+            {
+                unsigned int const x_start = BLOCK_SIZE_*(block % NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + BLOCK_SIZE_, NX);
+
+                for(unsigned int x = x_start; x < x_end; ++x)
+                {
+                    for(unsigned int buffer = 0; buffer <= 1; ++buffer)
+                    {
+                        for(unsigned int m = 0; m < NM_; ++m)
+                        {
+                            M_[SpatialToLinear(x, y, z, m, buffer)] = 0.0;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif // MOMENTS_HPP_INCLUDED
@@ -1,9 +1,9 @@
 #ifndef POPULATION_HPP_INCLUDED
 #define POPULATION_HPP_INCLUDED
 
-/**
- * \file     population.hpp
- * \mainpage Class for microscopic populations
+/**
+ * \file     population.hpp
+ * \mainpage Class for microscopic populations
 */
 
 #include <algorithm>
@@ -17,8 +17,14 @@
 
 #include "../general/memory_alignment.hpp"
 #include "../general/constexpr_func.hpp"
+#include "population_layout.hpp"
+#include "population_storage.hpp"
+#include "population_streaming.hpp"
 
 
+/// header of the checkpoint part files (see population_backup.hpp)
+struct checkpointHeader;
+
 /**\class  Population
  * \brief  Class that holds macroscopic values
  * \tparam NX     simulation domain resolution in x-direction
@@ -26,13 +32,18 @@
  * \tparam NZ     simulation domain resolution in z-direction
  * \tparam LT     static lattice::DdQq class containing discretisation parameters
  * \tparam NPOP   number of populations stored side by side in the lattice (default = 1)
+ * \tparam LY     memory layout policy of the populations (layout::AoS, layout::SoA, layout::AoSoA or layout::Interleaved, default = AoS)
+ * \tparam ST     storage policy of the populations (storage::Native, storage::Single, storage::Shifted or storage::Half, default = Native)
+ * \tparam SP     streaming policy of the populations (streaming::AA or streaming::EsotericPull, default = AA)
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP = 1>
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP = 1, class LY = layout::AoS, class ST = storage::Native, class SP = streaming::AA>
 class Population
 {
     public:
         /// import current lattice floating data type
         typedef typename std::remove_const<decltype(LT::CS)>::type T;
+        /// data type the populations are stored in
+        typedef typename ST::template type<T> S;
 
         /// lattice characteristics
         static constexpr unsigned int    DIM_ = LT::DIM;
@@ -43,18 +54,18 @@ class Population
         static constexpr unsigned int PAD_ = LT::PAD;
         static constexpr unsigned int  ND_ = LT::ND;
         static constexpr unsigned int OFF_ = LT::OFF;
-        static constexpr size_t  MEM_SIZE_ = sizeof(T)*NZ*NY*NX*NPOP*static_cast<size_t>(ND_);
+        static constexpr size_t  MEM_SIZE_ = sizeof(S)*NZ*NY*NX*NPOP*static_cast<size_t>(ND_);
 
         /// parallelism: 3D blocks
         //  each cell gets a block of cells instead of a single cell
-        static constexpr unsigned int   BLOCK_SIZE_ = 32;                                               ///< loop block size
+        static constexpr unsigned int   BLOCK_SIZE_ = LOOP_BLOCK_SIZE;                                  ///< loop block size
         static constexpr unsigned int NUM_BLOCKS_Z_ = cef::ceil(static_cast<double>(NZ) / BLOCK_SIZE_); ///< number of blocks in each dimension
         static constexpr unsigned int NUM_BLOCKS_Y_ = cef::ceil(static_cast<double>(NY) / BLOCK_SIZE_);
         static constexpr unsigned int NUM_BLOCKS_X_ = cef::ceil(static_cast<double>(NX) / BLOCK_SIZE_);
         static constexpr unsigned int   NUM_BLOCKS_ = NUM_BLOCKS_X_*NUM_BLOCKS_Y_*NUM_BLOCKS_Z_;        ///< total number of blocks
 
         /// pointer to population
-        T* const F_ = static_cast<T*>(aligned_alloc(CACHE_LINE, MEM_SIZE_));
+        S* const F_ = static_cast<S*>(AllocateAligned(MEM_SIZE_));
 
         /// physical parameters
         T const NU_;            // kinematic simulation viscosity
@@ -79,6 +90,8 @@ class Population
                 std::cerr << "Fatal error: Population could not be allocated." << std::endl;
                 exit(EXIT_FAILURE);
             }
+
+            FirstTouch();
         }
 
         /**\brief Class destructor
@@ -86,7 +99,7 @@ class Population
         ~Population()
         {
             std::cout << "See you, comrade!" << std::endl;
-            free(F_);
+            FreeAligned(F_);
         }
 
         /// indexing functions
@@ -97,31 +110,85 @@ class Population
                                       size_t const index) const;
 
         template <bool odd>
-        inline size_t AA_IndexRead(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                   unsigned int const n,       unsigned int const d,       unsigned int const p = 0) const;
+        inline size_t IndexRead(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                unsigned int const n,       unsigned int const d,       unsigned int const p = 0) const;
         template <bool odd>
-        inline size_t AA_IndexWrite(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                    unsigned int const n,       unsigned int const d,       unsigned int const p = 0) const;
+        inline size_t IndexWrite(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                 unsigned int const n,       unsigned int const d,       unsigned int const p = 0) const;
 
         template <bool odd>
-        inline auto&       AA_Read(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                   unsigned int const n,       unsigned int const d,       unsigned int const p = 0);
+        inline auto&       Read(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                unsigned int const n,       unsigned int const d,       unsigned int const p = 0);
         template <bool odd>
-        inline auto const& AA_Read(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                   unsigned int const n,       unsigned int const d,       unsigned int const p = 0) const;
+        inline auto const& Read(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                unsigned int const n,       unsigned int const d,       unsigned int const p = 0) const;
 
         template <bool odd>
-        inline auto&       AA_Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                    unsigned int const n,       unsigned int const d,       unsigned int const p = 0);
+        inline auto&       Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                 unsigned int const n,       unsigned int const d,       unsigned int const p = 0);
         template <bool odd>
-        inline auto const& AA_Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                    unsigned int const n,       unsigned int const d,       unsigned int const p = 0) const;
+        inline auto const& Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                 unsigned int const n,       unsigned int const d,       unsigned int const p = 0) const;
+
+        /// conversion between storage and lattice precision
+        inline T    Load(size_t const index, unsigned int const n, unsigned int const d) const;
+        inline void Store(size_t const index, unsigned int const n, unsigned int const d, T const f);
+
+        /// import and export: checkpoint of the populations
+        size_t Import(std::string const name, size_t& step, bool& odd, bool const isFatal = true);
+        void Export(std::string const name, size_t const step = 0, bool const odd = false, unsigned int const parts = 1) const;
 
-        /// import and export: population back-up
-        void Import(std::string const name);
-        void Export(std::string const name) const;
+    private:
+        /// NUMA-aware placement of the populations
+        void FirstTouch();
+
+        /// header describing the lattice of a checkpoint
+        checkpointHeader CheckpointHeader(size_t const step, bool const odd) const;
 };
 
+
+/**\fn        FirstTouch
+ * \brief     Touch the populations for the first time with the same block-to-thread mapping as the
+ *            collision kernels so that every page is placed on the NUMA node of the thread working on it.
+ *            All slots including padding and all populations are set to zero.
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::FirstTouch()
+{
+    #pragma omp parallel for default(none) schedule(static,1)
+    for(unsigned int block = 0; block < NUM_BLOCKS_; ++block)
+    {
+        unsigned int const z_start = BLOCK_SIZE_ * (block / (NUM_BLOCKS_X_*NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + BLOCK_SIZE_, NZ);
+
+        for(unsigned int z = z_start; z < z_end; ++z)
+        {
+            unsigned int const y_start = BLOCK_SIZE_*((block % (NUM_BLOCKS_X_*NUM_BLOCKS_Y_)) / NUM_BLOCKS_X_);
+            unsigned int const   y_end = std::min(y_start + BLOCK_SIZE_, NY);
+
+            for(unsigned int y = y_start; y < y_end; ++y)
+            {
+                unsigned int const x_start = BLOCK_SIZE_*(block % NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + BLOCK_SIZE_, NX);
+
+                for(unsigned int x = x_start; x < x_end; ++x)
+                {
+                    for(unsigned int p = 0; p < NPOP; ++p)
+                    {
+                        for(unsigned int n = 0; n <= 1; ++n)
+                        {
+                            for(unsigned int d = 0; d < OFF_; ++d)
+                            {
+                                F_[SpatialToLinear(x, y, z, n, d, p)] = 0.0;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 /// include related header files
 #include "population_indexing.hpp"
 #include "population_backup.hpp"
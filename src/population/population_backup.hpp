@@ -1,64 +1,356 @@
 #ifndef POPULATION_BACKUP_HPP_INCLUDED
 #define POPULATION_BACKUP_HPP_INCLUDED
 
-/**
- * \file     population_backup.hpp
- * \mainpage Class members for backing-up (export and import) microscopic populations
+/**
+ * \file     population_backup.hpp
+ * \mainpage Class members for backing-up (export and import) microscopic populations
+ *
+ * \note     A checkpoint consists of one or several part files "<name>_<part>.bin" that each hold a
+ *           contiguous range of chunks of the population array. Every part starts with a header that
+ *           describes the lattice (resolution, speeds, padding, layout, storage and streaming) and the time step
+ *           followed by one checksum per chunk. The chunks themselves start on a page boundary so that
+ *           the file can be mapped into memory: on restart the pages are faulted in lazily by the thread
+ *           that owns the corresponding loop block and only afterwards the checksums are verified.
 */
 
+#include <algorithm>
+#include <cstdint>
+#include <fcntl.h>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
 
 #include "../general/paths.hpp"
 
 
+/// checkpoint format
+constexpr char     CHECKPOINT_MAGIC[8] = {'L','B','-','t','C','K','P','\0'};
+constexpr uint32_t CHECKPOINT_VERSION  = 2;
+constexpr size_t   CHECKPOINT_CHUNK    = size_t(1) << 22; ///< bytes per checksummed chunk
+constexpr size_t   CHECKPOINT_PAGE     = 4096;            ///< alignment of the data within a part file
+
+/**\struct checkpointHeader
+ * \brief  Header at the beginning of every part file of a checkpoint
+*/
+struct checkpointHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t nx, ny, nz;           ///< resolution
+    uint32_t speeds, nd, npop;     ///< lattice speeds, padded populations per cell, number of populations
+    uint32_t sizeofS, sizeofT;     ///< size of storage and lattice floating data type
+    uint64_t strideX, strideD;     ///< linear index distance of neighbouring cells and populations (layout)
+    uint64_t storage;              ///< bit pattern of a stored unit population (storage policy)
+    uint64_t step;                 ///< time step of the populations
+    uint32_t odd;                  ///< parity of the next time step
+    uint32_t streaming;            ///< identifier of the streaming policy
+    uint32_t parts, part;          ///< number of part files and index of this part
+    uint64_t size;                 ///< total size of the population array in bytes
+    uint64_t chunkBegin, chunkEnd; ///< range of chunks stored in this part
+    uint64_t dataOffset;           ///< offset of the first chunk within the file
+};
+
+/**\fn        CheckpointChecksum
+ * \brief     64-bit FNV-1a checksum over 8-byte words of a memory region
+ *
+ * \param[in] data   pointer to the memory region
+ * \param[in] size   size of the memory region in bytes
+ * \return    checksum of the memory region
+*/
+inline uint64_t CheckpointChecksum(unsigned char const* const data, size_t const size)
+{
+    constexpr uint64_t prime = 0x100000001b3ull;
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    size_t i = 0;
+    for(; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        memcpy(&word, data + i, sizeof(uint64_t));
+        hash = (hash ^ word)*prime;
+    }
+    for(; i < size; ++i)
+    {
+        hash = (hash ^ data[i])*prime;
+    }
+
+    return hash;
+}
+
+
+/**\fn        CheckpointHeader
+ * \brief     Header describing the current population object
+ *
+ * \param[in] step    time step of the populations
+ * \param[in] odd     parity of the next time step (Boolean true/false)
+ * \return    header that all part files of a compatible checkpoint have to match
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+checkpointHeader Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::CheckpointHeader(size_t const step, bool const odd) const
+{
+    checkpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+
+    header.version = CHECKPOINT_VERSION;
+    header.nx      = NX;
+    header.ny      = NY;
+    header.nz      = NZ;
+    header.speeds  = SPEEDS_;
+    header.nd      = ND_;
+    header.npop    = NPOP;
+    header.sizeofS = sizeof(S);
+    header.sizeofT = sizeof(T);
+    header.strideX = (NX > 1) ? (SpatialToLinear(1, 0, 0, 0, 0, 0) - SpatialToLinear(0, 0, 0, 0, 0, 0)) : 0;
+    header.strideD = SpatialToLinear(0, 0, 0, 0, 1, 0) - SpatialToLinear(0, 0, 0, 0, 0, 0);
+
+    S const unit = ST::template Store<LT,T>(static_cast<T>(1.0), 0);
+    memcpy(&header.storage, &unit, sizeof(S));
+
+    header.step      = step;
+    header.odd       = (odd == true) ? 1 : 0;
+    header.streaming = SP::ID;
+    header.size      = MEM_SIZE_;
+
+    return header;
+}
+
 /**\fn          Import
- * \brief       Import populations from a *.bin file (initialisation)
- * \warning     Please make sure the correct resolution is selected and run the
- *              initialisation of populations afterwards.
+ * \brief       Restart from a checkpoint written by Export. All part files are mapped into memory and
+ *              copied with the block-to-thread mapping of the collision kernels, which faults in the
+ *              pages lazily on the NUMA node of the thread working on them. Aborts if the checkpoint
+ *              does not match the population object and, unless requested otherwise, if a checksum is wrong.
  *
- * \param[in]   name   the import file name of the scalar
+ * \param[in]   name      the import file name of the checkpoint (without part index)
+ * \param[out]  step      time step of the populations
+ * \param[out]  odd       parity of the next time step
+ * \param[in]   isFatal   abort if a chunk is corrupted (Boolean true, default) or return their number (false)
+ * \return      number of corrupted chunks
  */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
-void Population<NX,NY,NZ,LT,NPOP>::Import(std::string const name)
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+size_t Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::Import(std::string const name, size_t& step, bool& odd, bool const isFatal)
 {
-    std::string const fileName = BACKUP_IMPORT_PATH + std::string("/") + name + std::string(".bin");
-    FILE * const importFile;
+    checkpointHeader const expected = CheckpointHeader(0, false);
+    size_t const numberOfChunks = (MEM_SIZE_ + CHECKPOINT_CHUNK - 1)/CHECKPOINT_CHUNK;
 
-    if(fopen(fileName.c_str(), "rb+") != nullptr)
+    /// map all parts: chunks of the population array and their checksums
+    std::vector<unsigned char const*> chunks(numberOfChunks, nullptr);
+    std::vector<uint64_t>             checksums(numberOfChunks, 0);
+    std::vector<std::pair<void*,size_t>> mappings;
+
+    for(uint32_t part = 0, parts = 1; part < parts; ++part)
     {
-        importFile = fopen(fileName.c_str(), "rb+");
-        fread(F_, 1, MEM_SIZE_, importFile);
-        fclose(importFile);
+        std::string const fileName = BACKUP_IMPORT_PATH + std::string("/") + name + std::string("_") + std::to_string(part) + std::string(".bin");
+        int const file = open(fileName.c_str(), O_RDONLY);
+        struct stat info;
+        checkpointHeader header;
+
+        if ((file < 0) || (fstat(file, &info) != 0) || (pread(file, &header, sizeof(header), 0) != sizeof(header)))
+        {
+            std::cerr << "Fatal error: Could not import checkpoint '" << fileName << "' from disk." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        if ((memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0) || (header.version != expected.version) ||
+            (header.nx != expected.nx) || (header.ny != expected.ny) || (header.nz != expected.nz) ||
+            (header.speeds != expected.speeds) || (header.nd != expected.nd) || (header.npop != expected.npop) ||
+            (header.sizeofS != expected.sizeofS) || (header.sizeofT != expected.sizeofT) ||
+            (header.strideX != expected.strideX) || (header.strideD != expected.strideD) ||
+            (header.storage != expected.storage) || (header.streaming != expected.streaming) ||
+            (header.size != expected.size) || (header.part != part) ||
+            ((part > 0) && (header.parts != parts)) ||
+            (header.chunkEnd > numberOfChunks) || (header.chunkBegin > header.chunkEnd) ||
+            (static_cast<size_t>(info.st_size) < header.dataOffset + std::min(header.chunkEnd*CHECKPOINT_CHUNK, header.size) - header.chunkBegin*CHECKPOINT_CHUNK))
+        {
+            std::cerr << "Fatal error: Checkpoint '" << fileName << "' does not match the lattice." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        parts = header.parts;
+        step  = header.step;
+        odd   = (header.odd != 0);
+
+        size_t const chunksOfPart = header.chunkEnd - header.chunkBegin;
+        if (pread(file, &checksums[header.chunkBegin], chunksOfPart*sizeof(uint64_t), sizeof(header)) != static_cast<ssize_t>(chunksOfPart*sizeof(uint64_t)))
+        {
+            std::cerr << "Fatal error: Could not import checkpoint '" << fileName << "' from disk." << std::endl;
+            exit(EXIT_FAILURE);
+        }
 
+        void* const mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (mapping == MAP_FAILED)
+        {
+            std::cerr << "Fatal error: Could not map checkpoint '" << fileName << "' into memory." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        mappings.push_back(std::make_pair(mapping, static_cast<size_t>(info.st_size)));
+
+        for(size_t c = header.chunkBegin; c < header.chunkEnd; ++c)
+        {
+            chunks[c] = static_cast<unsigned char const*>(mapping) + header.dataOffset + (c - header.chunkBegin)*CHECKPOINT_CHUNK;
+        }
     }
-    else
+
+    if (std::find(chunks.begin(), chunks.end(), nullptr) != chunks.end())
+    {
+        std::cerr << "Fatal error: Checkpoint '" << name << "' is incomplete." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    /// copy with the block-to-thread mapping of the kernels
+    unsigned char* const destination = reinterpret_cast<unsigned char*>(F_);
+    size_t const chunkSize = CHECKPOINT_CHUNK;
+
+    #pragma omp parallel for default(none) shared(chunks) firstprivate(destination, chunkSize) schedule(static,1)
+    for(unsigned int block = 0; block < NUM_BLOCKS_; ++block)
+    {
+        unsigned int const z_start = BLOCK_SIZE_ * (block / (NUM_BLOCKS_X_*NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + BLOCK_SIZE_, NZ);
+
+        for(unsigned int z = z_start; z < z_end; ++z)
+        {
+            unsigned int const y_start = BLOCK_SIZE_*((block % (NUM_BLOCKS_X_*NUM_BLOCKS_Y_)) / NUM_BLOCKS_X_);
+            unsigned int const   y_end = std::min(y_start + BLOCK_SIZE_, NY);
+
+            for(unsigned int y = y_start; y < y_end; ++y)
+            {
+                unsigned int const x_start = BLOCK_SIZE_*(block % NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + BLOCK_SIZE_, NX);
+
+                for(unsigned int x = x_start; x < x_end; ++x)
+                {
+                    for(unsigned int p = 0; p < NPOP; ++p)
+                    {
+                        for(unsigned int n = 0; n <= 1; ++n)
+                        {
+                            for(unsigned int d = 0; d < OFF_; ++d)
+                            {
+                                size_t const byte = SpatialToLinear(x, y, z, n, d, p)*sizeof(S);
+                                memcpy(destination + byte, chunks[byte/chunkSize] + byte % chunkSize, sizeof(S));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for(auto const& mapping: mappings)
+    {
+        munmap(mapping.first, mapping.second);
+    }
+
+    /// verify the imported populations
+    size_t corrupted = 0;
+
+    #pragma omp parallel for default(none) shared(checksums) firstprivate(destination, numberOfChunks, chunkSize) reduction(+:corrupted) schedule(dynamic,1)
+    for(size_t c = 0; c < numberOfChunks; ++c)
+    {
+        size_t const size = std::min(chunkSize, MEM_SIZE_ - c*chunkSize);
+        if (CheckpointChecksum(destination + c*chunkSize, size) != checksums[c])
+        {
+            ++corrupted;
+        }
+    }
+
+    if ((corrupted > 0) && (isFatal == true))
     {
-        std::cerr << "Error: Could not import population from disk." << std::endl;
+        std::cerr << "Fatal error: Checkpoint '" << name << "' is corrupted (" << corrupted << " chunks)." << std::endl;
         exit(EXIT_FAILURE);
     }
+
+    return corrupted;
 }
 
 /**\fn          Export
- * \brief       Export populations at current time step to *.bin file
+ * \brief       Export populations at current time step to a checkpoint. The chunks are checksummed and
+ *              written in parallel, optionally distributed over several part files (e.g. for parallel
+ *              file systems).
  *
- * \param[in]   name   the export file name of the scalar
+ * \param[in]   name    the export file name of the checkpoint (without part index)
+ * \param[in]   step    time step of the populations (default = 0)
+ * \param[in]   odd     parity of the next time step (default = false)
+ * \param[in]   parts   number of part files (default = 1)
  */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
-void Population<NX,NY,NZ,LT,NPOP>::Export(std::string const name) const
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::Export(std::string const name, size_t const step, bool const odd, unsigned int const parts) const
 {
     struct stat info;
 
     if (stat(BACKUP_EXPORT_PATH.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
     {
-        std::string const fileName = BACKUP_EXPORT_PATH + std::string("/") + name + std::string(".bin");
-        FILE * const exportFile;
+        size_t const numberOfChunks = (MEM_SIZE_ + CHECKPOINT_CHUNK - 1)/CHECKPOINT_CHUNK;
+        unsigned int const numberOfParts = std::max(1u, std::min(parts, static_cast<unsigned int>(numberOfChunks)));
+
+        /// header and part file of every chunk
+        std::vector<checkpointHeader> headers(numberOfParts, CheckpointHeader(step, odd));
+        std::vector<int>              files(numberOfParts, -1);
+        std::vector<unsigned int>     partOfChunk(numberOfChunks, 0);
+        std::vector<uint64_t>         checksums(numberOfChunks, 0);
+
+        for(unsigned int part = 0; part < numberOfParts; ++part)
+        {
+            checkpointHeader& header = headers[part];
+            header.parts      = numberOfParts;
+            header.part       = part;
+            header.chunkBegin = (numberOfChunks*part)/numberOfParts;
+            header.chunkEnd   = (numberOfChunks*(part + 1))/numberOfParts;
+            header.dataOffset = ((sizeof(header) + (header.chunkEnd - header.chunkBegin)*sizeof(uint64_t) + CHECKPOINT_PAGE - 1)/CHECKPOINT_PAGE)*CHECKPOINT_PAGE;
+            std::fill(partOfChunk.begin() + header.chunkBegin, partOfChunk.begin() + header.chunkEnd, part);
+
+            std::string const fileName = BACKUP_EXPORT_PATH + std::string("/") + name + std::string("_") + std::to_string(part) + std::string(".bin");
+            files[part] = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (files[part] < 0)
+            {
+                std::cerr << "Fatal error: Could not export checkpoint '" << fileName << "' to disk." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        /// checksum and write all chunks in parallel
+        unsigned char const* const source = reinterpret_cast<unsigned char const*>(F_);
+        size_t const chunkSize = CHECKPOINT_CHUNK;
+        size_t failed = 0;
+
+        #pragma omp parallel for default(none) shared(headers, files, partOfChunk, checksums) firstprivate(source, numberOfChunks, chunkSize) reduction(+:failed) schedule(dynamic,1)
+        for(size_t c = 0; c < numberOfChunks; ++c)
+        {
+            checkpointHeader const& header = headers[partOfChunk[c]];
+            size_t const size = std::min(chunkSize, MEM_SIZE_ - c*chunkSize);
+            off_t const offset = static_cast<off_t>(header.dataOffset + (c - header.chunkBegin)*chunkSize);
+
+            checksums[c] = CheckpointChecksum(source + c*chunkSize, size);
+            if (pwrite(files[partOfChunk[c]], source + c*chunkSize, size, offset) != static_cast<ssize_t>(size))
+            {
+                ++failed;
+            }
+        }
+
+        for(unsigned int part = 0; part < numberOfParts; ++part)
+        {
+            checkpointHeader const& header = headers[part];
+            size_t const chunksOfPart = header.chunkEnd - header.chunkBegin;
+
+            if ((pwrite(files[part], &header, sizeof(header), 0) != sizeof(header)) ||
+                (pwrite(files[part], &checksums[header.chunkBegin], chunksOfPart*sizeof(uint64_t), sizeof(header)) != static_cast<ssize_t>(chunksOfPart*sizeof(uint64_t))) ||
+                (close(files[part]) != 0))
+            {
+                ++failed;
+            }
+        }
 
-        exportFile = fopen(fileName.c_str(), "wb+");
-        fwrite(F_, 1, MEM_SIZE_, exportFile);
-        fclose(exportFile);
+        if (failed > 0)
+        {
+            std::cerr << "Fatal error: Could not export checkpoint '" << name << "' to disk." << std::endl;
+            exit(EXIT_FAILURE);
+        }
     }
     else
     {
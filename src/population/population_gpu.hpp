@@ -0,0 +1,215 @@
+#ifndef POPULATION_GPU_HPP_INCLUDED
+#define POPULATION_GPU_HPP_INCLUDED
+
+/**
+ * \file     population_gpu.hpp
+ * \mainpage Class for microscopic populations in device memory
+ *
+ * \note     The A-A access pattern requires only a single population array and is therefore well
+ *           suited for the limited memory of graphic accelerators. The populations are stored with
+ *           the same layout policy as on the host (structure-of-arrays by default so that neighbouring
+ *           threads access contiguous memory) and are only transferred for initialisation and
+ *           checkpoints. Mixed-precision storage policies are not supported on the device.
+*/
+
+#include <type_traits>
+
+#include "../general/gpu.hpp"
+#include "population.hpp"
+#include "population_layout.hpp"
+#include "population_storage.hpp"
+
+
+/**\struct latticeParameters
+ * \brief  Discretisation parameters of a lattice that are passed to the device kernels by value
+ * \note   The static arrays of the lattice classes can't be accessed from device code. Kernel
+ *         arguments instead reside in the constant memory of the device and are broadcast to all
+ *         threads of a warp.
+ *
+ * \tparam LT   static lattice::DdQq class containing discretisation parameters
+*/
+template <class LT>
+struct latticeParameters
+{
+    typedef typename std::remove_const<decltype(LT::CS)>::type T;
+
+    T DX[LT::ND]; ///< discrete velocities
+    T DY[LT::ND];
+    T DZ[LT::ND];
+    T W[LT::ND];  ///< corresponding weights
+};
+
+/**\fn        LatticeParameters
+ * \brief     Copy the discretisation parameters of a lattice to a struct that can be passed to the device
+ *
+ * \tparam    LT   static lattice::DdQq class containing discretisation parameters
+ * \return    discretisation parameters of the lattice
+*/
+template <class LT>
+latticeParameters<LT> LatticeParameters()
+{
+    latticeParameters<LT> lattice;
+
+    for(unsigned int i = 0; i < LT::ND; ++i)
+    {
+        lattice.DX[i] = LT::DX[i];
+        lattice.DY[i] = LT::DY[i];
+        lattice.DZ[i] = LT::DZ[i];
+        lattice.W[i]  = LT::W[i];
+    }
+
+    return lattice;
+}
+
+
+/**\class  DevicePopulation
+ * \brief  Class that holds the microscopic populations in device memory
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam LT   static lattice::DdQq class containing discretisation parameters
+ * \tparam LY   memory layout policy of the populations (default = SoA)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY = layout::SoA>
+class DevicePopulation
+{
+    public:
+        /// import current lattice floating data type
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+        /// corresponding population on the host
+        typedef Population<NX,NY,NZ,LT,1,LY,storage::Native> HostPopulation;
+
+        /// lattice characteristics
+        static constexpr unsigned int HSPEED_ = LT::HSPEED;
+        static constexpr unsigned int     ND_ = LT::ND;
+        static constexpr unsigned int    OFF_ = LT::OFF;
+        static constexpr size_t     MEM_SIZE_ = sizeof(T)*NZ*NY*NX*static_cast<size_t>(ND_);
+
+        /// parallelism: every thread updates a single cell, thread blocks are lines in x-direction
+        static constexpr unsigned int NUM_BLOCKS_X_ = (NX + GPU_BLOCK_SIZE - 1)/GPU_BLOCK_SIZE;
+
+        /// pointer to population in device memory
+        T* F_ = nullptr;
+
+        /// physical parameters (see Population)
+        T const NU_;
+        T const TAU_;
+        T const OMEGA_;
+        T const LAMBDA_;
+        T const OMEGA_M_;
+
+        /// lattice discretisation parameters passed to the kernels
+        latticeParameters<LT> const LATTICE_;
+
+
+        /**\brief Class constructor: allocate the populations on the device and copy the host populations
+         * \param pop   population object holding the initialised microscopic variables on the host
+        */
+        DevicePopulation(HostPopulation const& pop):
+            NU_(pop.NU_), TAU_(pop.TAU_), OMEGA_(pop.OMEGA_), LAMBDA_(pop.LAMBDA_), OMEGA_M_(pop.OMEGA_M_),
+            LATTICE_(LatticeParameters<LT>())
+        {
+            GPU_CHECK(gpuMalloc(reinterpret_cast<void**>(&F_), MEM_SIZE_));
+            CopyFrom(pop);
+        }
+
+        /**\brief Class destructor
+        */
+        ~DevicePopulation()
+        {
+            gpuFree(F_);
+        }
+
+        DevicePopulation(DevicePopulation const&) = delete;
+        DevicePopulation& operator= (DevicePopulation const&) = delete;
+
+        /// transfer between host and device
+        void CopyFrom(HostPopulation const& pop);
+        void CopyTo(HostPopulation& pop) const;
+
+        /// indexing functions for host and device
+        template <bool odd>
+        static inline HOST_DEVICE size_t AA_IndexRead(latticeParameters<LT> const& lattice,
+                                                      unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                      unsigned int const n,       unsigned int const d);
+        template <bool odd>
+        static inline HOST_DEVICE size_t AA_IndexWrite(latticeParameters<LT> const& lattice,
+                                                       unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                       unsigned int const n,       unsigned int const d);
+};
+
+
+/**\fn        CopyFrom
+ * \brief     Copy the populations from the host to the device
+ *
+ * \param[in] pop   population object holding microscopic variables on the host
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY>
+void DevicePopulation<NX,NY,NZ,LT,LY>::CopyFrom(HostPopulation const& pop)
+{
+    GPU_CHECK(gpuMemcpy(F_, pop.F_, MEM_SIZE_, gpuMemcpyHostToDevice));
+}
+
+/**\fn         CopyTo
+ * \brief      Copy the populations from the device to the host (e.g. for a checkpoint)
+ *
+ * \param[out] pop   population object holding microscopic variables on the host
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY>
+void DevicePopulation<NX,NY,NZ,LT,LY>::CopyTo(HostPopulation& pop) const
+{
+    GPU_CHECK(gpuMemcpy(pop.F_, F_, MEM_SIZE_, gpuMemcpyDeviceToHost));
+}
+
+/**\fn         AA_IndexRead
+ * \brief      Linear index when reading values before collision depending on even and odd time step
+ *             (identical to Population::AA_IndexRead)
+ *
+ * \tparam     odd       even (0, false) or odd (1, true) time step
+ * \param[in]  lattice   lattice discretisation parameters
+ * \param[in]  x         x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]  y         y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]  z         z coordinates of current cell and its neighbours [z-1,z,z+1]
+ * \param[in]  n         positive (0) or negative (1) index/lattice velocity
+ * \param[in]  d         relevant population index
+ * \return     requested linear population index before collision
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY> template <bool odd>
+inline HOST_DEVICE size_t DevicePopulation<NX,NY,NZ,LT,LY>::AA_IndexRead(latticeParameters<LT> const& lattice,
+                                                                          unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                          unsigned int const n,       unsigned int const d)
+{
+    return LY::template SpatialToLinear<NX,NY,NZ,LT,1>(x[1 + O_E(odd, static_cast<int>(lattice.DX[!n*OFF_+d]), 0)],
+                                                        y[1 + O_E(odd, static_cast<int>(lattice.DY[!n*OFF_+d]), 0)],
+                                                        z[1 + O_E(odd, static_cast<int>(lattice.DZ[!n*OFF_+d]), 0)],
+                                                        O_E(odd, n, !n),
+                                                        d, 0);
+}
+
+/**\fn         AA_IndexWrite
+ * \brief      Linear index when writing values after collision depending on even and odd time step
+ *             (identical to Population::AA_IndexWrite)
+ *
+ * \tparam     odd       even (0, false) or odd (1, true) time step
+ * \param[in]  lattice   lattice discretisation parameters
+ * \param[in]  x         x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]  y         y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]  z         z coordinates of current cell and its neighbours [z-1,z,z+1]
+ * \param[in]  n         positive (0) or negative (1) index/lattice velocity
+ * \param[in]  d         relevant population index
+ * \return     requested linear population index after collision
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, class LY> template <bool odd>
+inline HOST_DEVICE size_t DevicePopulation<NX,NY,NZ,LT,LY>::AA_IndexWrite(latticeParameters<LT> const& lattice,
+                                                                           unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                           unsigned int const n,       unsigned int const d)
+{
+    return LY::template SpatialToLinear<NX,NY,NZ,LT,1>(x[1 + O_E(odd, static_cast<int>(lattice.DX[n*OFF_+d]), 0)],
+                                                        y[1 + O_E(odd, static_cast<int>(lattice.DY[n*OFF_+d]), 0)],
+                                                        z[1 + O_E(odd, static_cast<int>(lattice.DZ[n*OFF_+d]), 0)],
+                                                        O_E(odd, !n, n),
+                                                        d, 0);
+}
+
+#endif // POPULATION_GPU_HPP_INCLUDED
@@ -3,31 +3,13 @@
 
 /**
  * \file     population_indexing.hpp
- * \brief    Class members for indexing of populations with A-A access pattern
+ * \brief    Class members for indexing of populations
  *
- * \mainpage The A-A access pattern avoids the usage of two distinct populations before and
- *           after streaming by treating even and odd time steps differently: Even time steps
- *           perform only a local collision step with a reverse read of the populations and a
- *           regular write while odd steps perform a combined streaming-collision-streaming
- *           step with a regular read and a reverse write.
- *           This is implemented by different macros that determine the population indices for
- *           even and odd time steps.
- *
- * \note     "Accelerating Lattice Boltzmann Fluid Flow Simulations Using Graphics Processors"
- *           P. Bailey, J. Myre, S.D.C. Walsh, D.J. Lilja, M.O. Saar
- *           38th International Conference on Parallel Processing (ICPP), Vienna, Austria (2009)
- *           DOI: 10.1109/ICPP.2009.38
-*/
-
-
-/**\def       O_E (odd,a,b)
- * \brief     Macro for access in odd and even time steps
- *
- * \param[in] odd   boolean index for odd (1 = true) and even (0 = false) time steps
- * \param[in] a     index to be accessed at an odd time step
- * \param[in] b     index to be accessed at an even time step
+ * \mainpage The populations are streamed in place with a single population array: the indices of
+ *           the populations before and after collision for even and odd time steps are determined
+ *           by the streaming policy (A-A pattern or esoteric pull, see population_streaming.hpp) and
+ *           mapped to the linear memory by the layout policy of the population.
 */
-#define O_E(odd,a,b)    a*static_cast<decltype(a)>(odd) + b*static_cast<decltype(b)>(!odd)
 
 
 /**\fn         SpatialToLinear
@@ -42,11 +24,11 @@
  * \param[in]  p   relevant population (default = 0)
  * \return     requested linear population index
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
-inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
                                                                                            unsigned int const n, unsigned int const d, unsigned int const p) const
 {
-    return (((z*NY + y)*NX + x)*NPOP + p)*LT::ND + n*LT::OFF + d;
+    return LY::template SpatialToLinear<NX,NY,NZ,LT,NPOP>(x,y,z,n,d,p);
 }
 
 
@@ -61,38 +43,16 @@ inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::Spati
  * \param[out] d       return value number of relevant population index
  * \param[in]  index   current linear population index
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
-void Population<NX,NY,NZ,LT,NPOP>::LinearToSpatial(unsigned int& x, unsigned int& y, unsigned int& z,
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::LinearToSpatial(unsigned int& x, unsigned int& y, unsigned int& z,
                                                    unsigned int& p, unsigned int& n, unsigned int& d,
                                                    size_t const index) const
 {
-    size_t factor = LT::ND*NPOP*NX*NY;
-    size_t rest   = index%factor;
-
-    z      = index/factor;
-
-    factor = LT::ND*NPOP*NX;
-    y      = rest/factor;
-    rest   = rest%factor;
-
-    factor = LT::ND*NPOP;
-    x      = rest/factor;
-    rest   = rest%factor;
-
-    factor = LT::ND;
-    p      = rest/factor;
-    rest   = rest%factor;
-
-    factor = LT::OFF;
-    n      = rest/factor;
-    rest   = rest%factor;
-
-    factor = LT::SPEEDS;
-    d      = rest%factor;
+    LY::template LinearToSpatial<NX,NY,NZ,LT,NPOP>(x,y,z,p,n,d,index);
 }
 
 
-/**\fn         AA_IndexRead
+/**\fn         IndexRead
  * \brief      Function for determining linear index when reading/writing values before collision depending on even and odd time step.
  * \warning    Inline function! Has to be declared in header!
  *
@@ -105,18 +65,14 @@ void Population<NX,NY,NZ,LT,NPOP>::LinearToSpatial(unsigned int& x, unsigned int
  * \param[in]  p     relevant population (default = 0)
  * \return     requested linear population index before collision
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP> template <bool odd>
-inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_IndexRead(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                                                                        unsigned int const n,       unsigned int const d,       unsigned int const p) const
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP> template <bool odd>
+inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::IndexRead(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                                         unsigned int const n,       unsigned int const d,       unsigned int const p) const
 {
-    return SpatialToLinear(x[1 + O_E(odd, static_cast<int>(LT::DX[!n*OFF_+d]), 0)],
-                           y[1 + O_E(odd, static_cast<int>(LT::DY[!n*OFF_+d]), 0)],
-                           z[1 + O_E(odd, static_cast<int>(LT::DZ[!n*OFF_+d]), 0)],
-                           O_E(odd, n, !n),
-                           d, p);
+    return SP::template IndexRead<odd,NX,NY,NZ,LT,NPOP,LY>(x, y, z, n, d, p);
 }
 
-/**\fn         AA_IndexWrite
+/**\fn         IndexWrite
  * \brief      Function for determining linear index when reading/writing values after collision depending on even and odd time step.
  * \warning    Inline function! Has to be declared in header!
  *
@@ -129,19 +85,15 @@ inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_In
  * \param[in]  p     relevant population (default = 0)
  * \return     requested linear population index after collision
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP> template <bool odd>
-inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_IndexWrite(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
-                                                                                         unsigned int const n,       unsigned int const d,       unsigned int const p) const
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP> template <bool odd>
+inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::IndexWrite(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                                          unsigned int const n,       unsigned int const d,       unsigned int const p) const
 {
-    return SpatialToLinear(x[1 + O_E(odd, static_cast<int>(LT::DX[n*OFF_+d]), 0)],
-                           y[1 + O_E(odd, static_cast<int>(LT::DY[n*OFF_+d]), 0)],
-                           z[1 + O_E(odd, static_cast<int>(LT::DZ[n*OFF_+d]), 0)],
-                           O_E(odd, !n, n),
-                           d, p);
+    return SP::template IndexWrite<odd,NX,NY,NZ,LT,NPOP,LY>(x, y, z, n, d, p);
 }
 
 
-/**\fn         AA_Read
+/**\fn         Read
  * \brief      Function for accessing values before collision depending on even and odd time step.
  * \warning    Sloppy syntax: avoid usage, use the full expression below for indexing
  *
@@ -154,21 +106,21 @@ inline size_t __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_In
  * \param[in]  p     relevant population (default = 0)
  * \return     requested linear population index before collision (reading)
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP> template <bool odd>
-inline auto& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_Read(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP> template <bool odd>
+inline auto& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::Read(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
                                                                                   unsigned int const n,       unsigned int const d,       unsigned int const p)
 {
-    return F_[AA_IndexRead<odd>(x,y,z,n,d,p)];
+    return F_[IndexRead<odd>(x,y,z,n,d,p)];
 }
 
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP> template <bool odd>
-inline auto const& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_Read(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP> template <bool odd>
+inline auto const& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::Read(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
                                                                                         unsigned int const n,       unsigned int const d,       unsigned int const p) const
 {
-    return F_[AA_IndexRead<odd>(x,y,z,n,d,p)];
+    return F_[IndexRead<odd>(x,y,z,n,d,p)];
 }
 
-/**\fn         AA_Write
+/**\fn         Write
  * \brief      Function for accessing values after collision depending on even and odd time step.
  * \warning    Sloppy syntax: avoid usage, use the full expression below for indexing
  *
@@ -181,18 +133,48 @@ inline auto const& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::
  * \param[in]  p     relevant population (default = 0)
  * \return     requested linear population index after collision (writing)
 */
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP> template <bool odd>
-inline auto& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP> template <bool odd>
+inline auto& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
                                                                                    unsigned int const n,       unsigned int const d,       unsigned int const p)
 {
-    return F_[AA_IndexWrite<odd>(x,y,z,n,d,p)];
+    return F_[IndexWrite<odd>(x,y,z,n,d,p)];
 }
 
-template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP> template <bool odd>
-inline auto const& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP>::AA_Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP> template <bool odd>
+inline auto const& __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::Write(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
                                                                                          unsigned int const n,       unsigned int const d,       unsigned int const p) const
 {
-    return F_[AA_IndexWrite<odd>(x,y,z,n,d,p)];
+    return F_[IndexWrite<odd>(x,y,z,n,d,p)];
+}
+
+/**\fn         Load
+ * \brief      Load a population from memory and convert it from the storage data type to the floating data
+ *             type of the lattice (moments and equilibrium distributions are always evaluated in lattice precision)
+ *
+ * \param[in]  index   linear population index (e.g. IndexRead<odd>(x,y,z,n,d,p))
+ * \param[in]  n       positive (0) or negative (1) index/lattice velocity
+ * \param[in]  d       relevant population index
+ * \return     population in floating data type of the lattice
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+inline auto __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::Load(size_t const index, unsigned int const n, unsigned int const d) const -> T
+{
+    return ST::template Load<LT,T>(F_[index], n*OFF_ + d);
+}
+
+/**\fn         Store
+ * \brief      Convert a population from the floating data type of the lattice to the storage data type
+ *             and store it in memory
+ *
+ * \param[in]  index   linear population index (e.g. IndexWrite<odd>(x,y,z,n,d,p))
+ * \param[in]  n       positive (0) or negative (1) index/lattice velocity
+ * \param[in]  d       relevant population index
+ * \param[in]  f       population in floating data type of the lattice
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+inline void __attribute__((always_inline)) Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::Store(size_t const index, unsigned int const n, unsigned int const d, T const f)
+{
+    F_[index] = ST::template Store<LT,T>(f, n*OFF_ + d);
 }
 
 #endif // POPULATION_INDEXING_HPP_INCLUDED
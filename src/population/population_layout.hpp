@@ -0,0 +1,210 @@
+#ifndef POPULATION_LAYOUT_HPP_INCLUDED
+#define POPULATION_LAYOUT_HPP_INCLUDED
+
+/**
+ * \file     population_layout.hpp
+ * \mainpage Memory layout policies of the populations
+ *
+ * \note     The layout policy of a population determines how the 3D population coordinates are
+ *           mapped to the linear memory. The streaming policy on top of it is independent of the
+ *           layout so that all generic kernels and boundaries work with every layout.
+ *           - AoS:   all populations of a cell are contiguous (vectorisation across the directions)
+ *           - SoA:   a single direction of all cells is contiguous (vectorisation across cells)
+ *           - AoSoA: blocks of W neighbouring cells in x-direction are stored direction by direction
+ *                    (vectorisation across cells with aligned loads)
+ *           - Interleaved: the populations of a cell are stored side by side for every direction
+ *                    (vectorisation across independent populations, e.g. the cases of an ensemble)
+*/
+
+#include <cstddef>
+
+#include "../general/gpu.hpp"
+
+
+namespace layout
+{
+    /**\class  AoS
+     * \brief  Array-of-structures layout: (((z*NY + y)*NX + x)*NPOP + p)*ND + n*OFF + d
+    */
+    class AoS
+    {
+        public:
+            static constexpr char const* NAME = "AoS"; ///< name of the layout (e.g. in the benchmark report)
+
+            /**\fn        SpatialToLinear
+             * \brief     Convert 3D population coordinates to scalar index
+             *
+             * \tparam    NX     simulation domain resolution in x-direction
+             * \tparam    NY     simulation domain resolution in y-direction
+             * \tparam    NZ     simulation domain resolution in z-direction
+             * \tparam    LT     static lattice::DdQq class containing discretisation parameters
+             * \tparam    NPOP   number of populations stored side by side in the lattice
+             * \param[in] x      x coordinate of cell
+             * \param[in] y      y coordinate of cell
+             * \param[in] z      z coordinate of cell
+             * \param[in] n      positive (0) or negative (1) index/lattice velocity
+             * \param[in] d      relevant population index
+             * \param[in] p      relevant population
+             * \return    requested linear population index
+            */
+            template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
+            static inline HOST_DEVICE size_t __attribute__((always_inline)) SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
+                                                                                unsigned int const n, unsigned int const d, unsigned int const p)
+            {
+                return (((z*NY + y)*NX + x)*NPOP + p)*LT::ND + n*LT::OFF + d;
+            }
+
+            /**\fn         LinearToSpatial
+             * \brief      Generate 3D population coordinates from scalar index
+             *
+             * \param[out] x       return value x coordinate of cell
+             * \param[out] y       return value y coordinate of cell
+             * \param[out] z       return value z coordinate of cell
+             * \param[out] p       return value number of population
+             * \param[out] n       return positive (0) or negative (1) index
+             * \param[out] d       return value number of relevant population index
+             * \param[in]  index   current linear population index
+            */
+            template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
+            static void LinearToSpatial(unsigned int& x, unsigned int& y, unsigned int& z,
+                                        unsigned int& p, unsigned int& n, unsigned int& d,
+                                        size_t const index)
+            {
+                size_t factor = LT::ND*NPOP*NX*NY;
+                size_t rest   = index%factor;
+
+                z      = index/factor;
+
+                factor = LT::ND*NPOP*NX;
+                y      = rest/factor;
+                rest   = rest%factor;
+
+                factor = LT::ND*NPOP;
+                x      = rest/factor;
+                rest   = rest%factor;
+
+                factor = LT::ND;
+                p      = rest/factor;
+                rest   = rest%factor;
+
+                factor = LT::OFF;
+                n      = rest/factor;
+                rest   = rest%factor;
+
+                factor = LT::SPEEDS;
+                d      = rest%factor;
+            }
+    };
+
+    /**\class  SoA
+     * \brief  Structure-of-arrays layout: (((p*ND + n*OFF + d)*NZ + z)*NY + y)*NX + x
+    */
+    class SoA
+    {
+        public:
+            static constexpr char const* NAME = "SoA"; ///< name of the layout (e.g. in the benchmark report)
+
+            template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
+            static inline HOST_DEVICE size_t __attribute__((always_inline)) SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
+                                                                                unsigned int const n, unsigned int const d, unsigned int const p)
+            {
+                return ((static_cast<size_t>(p*LT::ND + n*LT::OFF + d)*NZ + z)*NY + y)*NX + x;
+            }
+
+            template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
+            static void LinearToSpatial(unsigned int& x, unsigned int& y, unsigned int& z,
+                                        unsigned int& p, unsigned int& n, unsigned int& d,
+                                        size_t const index)
+            {
+                size_t const cells = static_cast<size_t>(NX)*NY*NZ;
+                size_t const  cell = index%cells;
+                size_t const  slot = index/cells;
+
+                x = cell%NX;
+                y = (cell/NX)%NY;
+                z = cell/(static_cast<size_t>(NX)*NY);
+                p = slot/LT::ND;
+                n = (slot%LT::ND)/LT::OFF;
+                d = (slot%LT::ND)%LT::OFF;
+            }
+    };
+
+    /**\class  AoSoA
+     * \brief  Array-of-structures-of-arrays layout with an inner block of W cells in x-direction:
+     *         (((((z*NY + y)*NX/W + x/W)*NPOP + p)*ND + n*OFF + d)*W + x%W
+     * \warning The resolution in x-direction has to be a multiple of the block size W
+     *
+     * \tparam W   number of consecutive cells in x-direction in an inner block (typically the SIMD width)
+    */
+    template <unsigned int W>
+    class AoSoA
+    {
+        public:
+            static constexpr unsigned int SIZE = W; ///< number of neighbouring cells in x-direction stored contiguously
+            static constexpr char const* NAME = "AoSoA"; ///< name of the layout (e.g. in the benchmark report)
+
+            template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
+            static inline HOST_DEVICE size_t __attribute__((always_inline)) SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
+                                                                                unsigned int const n, unsigned int const d, unsigned int const p)
+            {
+                static_assert(NX % W == 0, "Resolution in x-direction has to be a multiple of the AoSoA block size.");
+                return ((((static_cast<size_t>(z)*NY + y)*(NX/W) + x/W)*NPOP + p)*LT::ND + n*LT::OFF + d)*W + x%W;
+            }
+
+            template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
+            static void LinearToSpatial(unsigned int& x, unsigned int& y, unsigned int& z,
+                                        unsigned int& p, unsigned int& n, unsigned int& d,
+                                        size_t const index)
+            {
+                size_t const  lane = index%W;
+                size_t       block = index/W;
+
+                d     = (block%LT::ND)%LT::OFF;
+                n     = (block%LT::ND)/LT::OFF;
+                block = block/LT::ND;
+                p     = block%NPOP;
+                block = block/NPOP;
+                x     = (block%(NX/W))*W + lane;
+                block = block/(NX/W);
+                y     = block%NY;
+                z     = block/NY;
+            }
+    };
+
+    /**\class  Interleaved
+     * \brief  Interleaved layout with the population as innermost index: (((z*NY + y)*NX + x)*ND + n*OFF + d)*NPOP + p
+     * \note   All populations of a direction of a cell are contiguous so that the populations p of a cell are
+     *         found at a single neighbour index plus p. Used for ensembles of independent simulations sharing
+     *         a geometry (see ensemble.hpp) where the SIMD lanes are mapped to the different cases.
+    */
+    class Interleaved
+    {
+        public:
+            static constexpr char const* NAME = "interleaved"; ///< name of the layout (e.g. in the benchmark report)
+
+            template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
+            static inline HOST_DEVICE size_t __attribute__((always_inline)) SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
+                                                                                unsigned int const n, unsigned int const d, unsigned int const p)
+            {
+                return (((static_cast<size_t>(z)*NY + y)*NX + x)*LT::ND + n*LT::OFF + d)*NPOP + p;
+            }
+
+            template <unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP>
+            static void LinearToSpatial(unsigned int& x, unsigned int& y, unsigned int& z,
+                                        unsigned int& p, unsigned int& n, unsigned int& d,
+                                        size_t const index)
+            {
+                size_t const slot = (index/NPOP)%LT::ND;
+                size_t const cell = (index/NPOP)/LT::ND;
+
+                p = index%NPOP;
+                n = slot/LT::OFF;
+                d = slot%LT::OFF;
+                x = cell%NX;
+                y = (cell/NX)%NY;
+                z = cell/(static_cast<size_t>(NX)*NY);
+            }
+    };
+}
+
+#endif // POPULATION_LAYOUT_HPP_INCLUDED
@@ -0,0 +1,290 @@
+#ifndef POPULATION_RUNTIME_HPP_INCLUDED
+#define POPULATION_RUNTIME_HPP_INCLUDED
+
+/**
+ * \file     population_runtime.hpp
+ * \mainpage Class for microscopic populations of a domain whose size is only known at run time
+ *
+ * \note     Population is templated on the resolution so that all strides are constant-folded. A domain
+ *           that is not in the registry of main.cpp is instead run on a population whose resolution is
+ *           a run-time value: the populations are stored with the array-of-structures layout in the
+ *           floating data type of the lattice and streamed in place with the A-A pattern, so the indices
+ *           are the ones of Population<NX,NY,NZ,LT> with the strides read from memory. Only the lattice
+ *           remains a template parameter, there are few of them and the dispatch over them is cheap.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <stdlib.h>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../continuum/continuum_runtime.hpp"
+#include "../general/memory_alignment.hpp"
+#include "../lattice/equilibrium.hpp"
+#include "population_streaming.hpp"
+
+
+/**\class  RuntimePopulation
+ * \brief  Populations of a domain whose resolution is given at run time (A-A pattern, array-of-structures
+ *         layout and native storage)
+ *
+ * \tparam LT   static lattice::DdQq class containing discretisation parameters
+*/
+template <class LT>
+class RuntimePopulation
+{
+    public:
+        /// import current lattice floating data type
+        typedef typename std::remove_const<decltype(LT::CS)>::type T;
+        /// data type the populations are stored in
+        typedef T S;
+
+        /// lattice characteristics
+        static constexpr unsigned int    DIM_ = LT::DIM;
+        static constexpr unsigned int SPEEDS_ = LT::SPEEDS;
+        static constexpr unsigned int HSPEED_ = LT::HSPEED;
+
+        /// linear memory layout
+        static constexpr unsigned int PAD_ = LT::PAD;
+        static constexpr unsigned int  ND_ = LT::ND;
+        static constexpr unsigned int OFF_ = LT::OFF;
+
+        /// resolution of the domain
+        unsigned int const NX_;
+        unsigned int const NY_;
+        unsigned int const NZ_;
+        size_t       const MEM_SIZE_;
+
+        /// parallelism: 3D blocks (same as the ones of Population)
+        static constexpr unsigned int BLOCK_SIZE_ = LOOP_BLOCK_SIZE; ///< loop block size
+        unsigned int const NUM_BLOCKS_Z_;                            ///< number of blocks in each dimension
+        unsigned int const NUM_BLOCKS_Y_;
+        unsigned int const NUM_BLOCKS_X_;
+        unsigned int const NUM_BLOCKS_;                              ///< total number of blocks
+
+        /// pointer to population
+        S* const F_;
+
+        /// physical parameters
+        T const NU_;    // kinematic simulation viscosity
+        T const TAU_;   // laminar relaxation time
+        T const OMEGA_; // collision frequency
+
+
+        /**\brief Class constructor
+         * \param NX   simulation domain resolution in x-direction
+         * \param NY   simulation domain resolution in y-direction
+         * \param NZ   simulation domain resolution in z-direction
+         * \param Re   simulation Reynolds number
+         * \param U    characteristic velocity of the simulation in lattice units
+         * \param L    characteristic length of the simulation in lattice units
+        */
+        RuntimePopulation(unsigned int const NX, unsigned int const NY, unsigned int const NZ, T const Re, T const U, unsigned int const L):
+            NX_(NX), NY_(NY), NZ_(NZ), MEM_SIZE_(sizeof(S)*NZ*NY*NX*static_cast<size_t>(ND_)),
+            NUM_BLOCKS_Z_((NZ + BLOCK_SIZE_ - 1)/BLOCK_SIZE_), NUM_BLOCKS_Y_((NY + BLOCK_SIZE_ - 1)/BLOCK_SIZE_),
+            NUM_BLOCKS_X_((NX + BLOCK_SIZE_ - 1)/BLOCK_SIZE_), NUM_BLOCKS_(NUM_BLOCKS_X_*NUM_BLOCKS_Y_*NUM_BLOCKS_Z_),
+            F_(static_cast<S*>(AllocateAligned(MEM_SIZE_))),
+            NU_(U*static_cast<T>(L) / Re), TAU_(NU_/(LT::CS*LT::CS) + 1.0/ 2.0), OMEGA_(1.0/TAU_)
+        {
+            if (F_ == nullptr)
+            {
+                std::cerr << "Fatal error: Population could not be allocated." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+
+            FirstTouch();
+        }
+
+        /**\brief Class destructor
+        */
+        ~RuntimePopulation()
+        {
+            std::cout << "See you, comrade!" << std::endl;
+            FreeAligned(F_);
+        }
+
+        RuntimePopulation(RuntimePopulation const&) = delete;
+        RuntimePopulation& operator= (RuntimePopulation const&) = delete;
+
+        /// indexing functions
+        inline size_t SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
+                                      unsigned int const n, unsigned int const d) const;
+
+        template <bool odd>
+        inline size_t IndexRead(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                unsigned int const n,       unsigned int const d) const;
+        template <bool odd>
+        inline size_t IndexWrite(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                 unsigned int const n,       unsigned int const d) const;
+
+    private:
+        /// NUMA-aware placement of the populations
+        void FirstTouch();
+};
+
+
+/**\fn        FirstTouch
+ * \brief     Touch the populations for the first time with the same block-to-thread mapping as the
+ *            collision kernel so that every page is placed on the NUMA node of the thread working on it
+*/
+template <class LT>
+void RuntimePopulation<LT>::FirstTouch()
+{
+    #pragma omp parallel for default(none) schedule(static,1)
+    for(unsigned int block = 0; block < NUM_BLOCKS_; ++block)
+    {
+        unsigned int const z_start = BLOCK_SIZE_ * (block / (NUM_BLOCKS_X_*NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + BLOCK_SIZE_, NZ_);
+
+        for(unsigned int z = z_start; z < z_end; ++z)
+        {
+            unsigned int const y_start = BLOCK_SIZE_*((block % (NUM_BLOCKS_X_*NUM_BLOCKS_Y_)) / NUM_BLOCKS_X_);
+            unsigned int const   y_end = std::min(y_start + BLOCK_SIZE_, NY_);
+
+            for(unsigned int y = y_start; y < y_end; ++y)
+            {
+                unsigned int const x_start = BLOCK_SIZE_*(block % NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + BLOCK_SIZE_, NX_);
+
+                for(unsigned int x = x_start; x < x_end; ++x)
+                {
+                    for(unsigned int n = 0; n <= 1; ++n)
+                    {
+                        for(unsigned int d = 0; d < OFF_; ++d)
+                        {
+                            F_[SpatialToLinear(x, y, z, n, d)] = 0.0;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**\fn         SpatialToLinear
+ * \brief      Inline function for converting 3D population coordinates to scalar index (array-of-structures)
+ * \warning    Inline function! Has to be declared in header!
+ *
+ * \param[in]  x   x coordinate of cell
+ * \param[in]  y   y coordinate of cell
+ * \param[in]  z   z coordinate of cell
+ * \param[in]  n   positive (0) or negative (1) index/lattice velocity
+ * \param[in]  d   relevant population index
+ * \return     requested linear population index
+*/
+template <class LT>
+inline size_t __attribute__((always_inline)) RuntimePopulation<LT>::SpatialToLinear(unsigned int const x, unsigned int const y, unsigned int const z,
+                                                                                      unsigned int const n, unsigned int const d) const
+{
+    return ((static_cast<size_t>(z)*NY_ + y)*NX_ + x)*ND_ + n*OFF_ + d;
+}
+
+/**\fn         IndexRead
+ * \brief      Linear index of a population before collision with the A-A pattern (see streaming::AA)
+ * \warning    Inline function! Has to be declared in header!
+ *
+ * \tparam     odd   even (0, false) or odd (1, true) time step
+ * \param[in]  x     x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]  y     y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]  z     z coordinates of current cell and its neighbours [z-1,z,z+1]
+ * \param[in]  n     positive (0) or negative (1) index/lattice velocity
+ * \param[in]  d     relevant population index
+ * \return     requested linear population index before collision
+*/
+template <class LT> template <bool odd>
+inline size_t __attribute__((always_inline)) RuntimePopulation<LT>::IndexRead(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                                unsigned int const n,       unsigned int const d) const
+{
+    return SpatialToLinear(x[1 + O_E(odd, static_cast<int>(LT::DX[!n*LT::OFF+d]), 0)],
+                           y[1 + O_E(odd, static_cast<int>(LT::DY[!n*LT::OFF+d]), 0)],
+                           z[1 + O_E(odd, static_cast<int>(LT::DZ[!n*LT::OFF+d]), 0)],
+                           O_E(odd, n, !n),
+                           d);
+}
+
+/**\fn         IndexWrite
+ * \brief      Linear index of a population after collision with the A-A pattern (see streaming::AA)
+ * \warning    Inline function! Has to be declared in header!
+ *
+ * \tparam     odd   even (0, false) or odd (1, true) time step
+ * \param[in]  x     x coordinates of current cell and its neighbours [x-1,x,x+1]
+ * \param[in]  y     y coordinates of current cell and its neighbours [y-1,y,y+1]
+ * \param[in]  z     z coordinates of current cell and its neighbours [z-1,z,z+1]
+ * \param[in]  n     positive (0) or negative (1) index/lattice velocity
+ * \param[in]  d     relevant population index
+ * \return     requested linear population index after collision
+*/
+template <class LT> template <bool odd>
+inline size_t __attribute__((always_inline)) RuntimePopulation<LT>::IndexWrite(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                                 unsigned int const n,       unsigned int const d) const
+{
+    return SpatialToLinear(x[1 + O_E(odd, static_cast<int>(LT::DX[n*LT::OFF+d]), 0)],
+                           y[1 + O_E(odd, static_cast<int>(LT::DY[n*LT::OFF+d]), 0)],
+                           z[1 + O_E(odd, static_cast<int>(LT::DZ[n*LT::OFF+d]), 0)],
+                           O_E(odd, !n, n),
+                           d);
+}
+
+
+/**\fn         InitLattice
+ * \brief      Initialise microscopic distributions of a run-time sized domain from continuum values
+ *
+ * \tparam     odd   even (0, false) or odd (1, true) time step
+ * \tparam     LT    static lattice::DdQq class containing discretisation parameters
+ * \tparam     T     floating data type used for simulation
+ * \param[in]  con   continuum object holding macroscopic variables
+ * \param[out] pop   population object holding microscopic variables
+*/
+template <bool odd, class LT, typename T>
+void InitLattice(RuntimeContinuum<T> const& con, RuntimePopulation<LT>& pop)
+{
+    unsigned int const NX = pop.NX_;
+    unsigned int const NY = pop.NY_;
+    unsigned int const NZ = pop.NZ_;
+
+    #pragma omp parallel for default(none) shared(con, pop) firstprivate(NX, NY, NZ) schedule(static,1)
+    for(unsigned int block = 0; block < pop.NUM_BLOCKS_; ++block)
+    {
+        unsigned int const z_start = pop.BLOCK_SIZE_ * (block / (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_));
+        unsigned int const   z_end = std::min(z_start + pop.BLOCK_SIZE_, NZ);
+
+        for(unsigned int z = z_start; z < z_end; ++z)
+        {
+            unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+            unsigned int const y_start = pop.BLOCK_SIZE_*((block % (pop.NUM_BLOCKS_X_*pop.NUM_BLOCKS_Y_)) / pop.NUM_BLOCKS_X_);
+            unsigned int const   y_end = std::min(y_start + pop.BLOCK_SIZE_, NY);
+
+            for(unsigned int y = y_start; y < y_end; ++y)
+            {
+                unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+
+                unsigned int const x_start = pop.BLOCK_SIZE_*(block % pop.NUM_BLOCKS_X_);
+                unsigned int const   x_end = std::min(x_start + pop.BLOCK_SIZE_, NX);
+
+                for(unsigned int x = x_start; x < x_end; ++x)
+                {
+                    unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+
+                    alignas(CACHE_LINE) T feq[LT::ND] = {0.0};
+                    lattice::Equilibrium<LT>(con(x, y, z, 0), con(x, y, z, 1), con(x, y, z, 2), con(x, y, z, 3), feq);
+
+                    #pragma GCC unroll (2)
+                    for(unsigned int n = 0; n <= 1; ++n)
+                    {
+                        #pragma GCC unroll (16)
+                        for(unsigned int d = n; d < LT::OFF; ++d)
+                        {
+                            pop.F_[pop. template IndexRead<odd>(x_n,y_n,z_n,n,d)] = feq[n*LT::OFF + d];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif // POPULATION_RUNTIME_HPP_INCLUDED
@@ -0,0 +1,162 @@
+#ifndef POPULATION_STORAGE_HPP_INCLUDED
+#define POPULATION_STORAGE_HPP_INCLUDED
+
+/**
+ * \file     population_storage.hpp
+ * \mainpage Storage policies of the populations
+ *
+ * \note     The collision of a cell only reads and writes its populations once per time step and is
+ *           therefore limited by the memory bandwidth. The storage policy of a population decouples the
+ *           data type the populations are stored in from the floating data type of the lattice that is
+ *           used for all moments and equilibrium distributions: populations are converted when being
+ *           loaded from and stored to memory, all arithmetic is performed in the lattice precision.
+ *           - Native:  populations are stored in the lattice precision (default)
+ *           - Single:  populations are stored in single precision
+ *           - Shifted: only the deviation f - w of the populations from the lattice weights w is stored
+ *                      (e.g. in single precision), which is several orders of magnitude smaller than the
+ *                      populations themselves and therefore less affected by the truncation
+ *           - Half:    deviation f - w stored in half precision (requires the F16C instruction set)
+ *           Only the populations are loaded and stored: the padding slots are skipped as their lattice
+ *           weights are not necessarily zero (e.g. the second rest slot of D3Q19).
+*/
+
+#include <cstddef>
+#include <cstdint>
+#ifdef __F16C__
+    #include <immintrin.h>
+#endif
+
+
+namespace storage
+{
+    /**\class  Native
+     * \brief  Populations are stored in the floating data type of the lattice
+    */
+    class Native
+    {
+        public:
+            static constexpr char const* NAME = "native"; ///< name of the storage (e.g. in the benchmark report)
+            static constexpr bool IS_SHIFTED  = false;    ///< only the deviation from the lattice weights is stored
+
+            /// storage data type for lattice floating data type T
+            template <typename T>
+            using type = T;
+
+            /**\fn        Load
+             * \brief     Convert a stored population to the floating data type of the lattice
+             *
+             * \tparam    LT     static lattice::DdQq class containing discretisation parameters
+             * \tparam    T      floating data type used for simulation
+             * \param[in] f      stored population
+             * \param[in] curr   linear index n*OFF + d of the population within the cell
+             * \return    population in floating data type of the lattice
+            */
+            template <class LT, typename T>
+            static inline T __attribute__((always_inline)) Load(type<T> const f, unsigned int const curr)
+            {
+                (void)curr;
+                return f;
+            }
+
+            /**\fn        Store
+             * \brief     Convert a population in the floating data type of the lattice to the storage data type
+             *
+             * \tparam    LT     static lattice::DdQq class containing discretisation parameters
+             * \tparam    T      floating data type used for simulation
+             * \param[in] f      population in floating data type of the lattice
+             * \param[in] curr   linear index n*OFF + d of the population within the cell
+             * \return    population in storage data type
+            */
+            template <class LT, typename T>
+            static inline type<T> __attribute__((always_inline)) Store(T const f, unsigned int const curr)
+            {
+                (void)curr;
+                return f;
+            }
+    };
+
+    /**\class  Single
+     * \brief  Populations are stored in single precision
+    */
+    class Single
+    {
+        public:
+            static constexpr char const* NAME = "single";
+            static constexpr bool IS_SHIFTED  = false;
+
+            template <typename T>
+            using type = float;
+
+            template <class LT, typename T>
+            static inline T __attribute__((always_inline)) Load(type<T> const f, unsigned int const curr)
+            {
+                (void)curr;
+                return static_cast<T>(f);
+            }
+
+            template <class LT, typename T>
+            static inline type<T> __attribute__((always_inline)) Store(T const f, unsigned int const curr)
+            {
+                (void)curr;
+                return static_cast<type<T>>(f);
+            }
+    };
+
+    /**\class  Shifted
+     * \brief  Only the deviation of the populations from the lattice weights is stored
+     *
+     * \tparam S   floating storage data type (default = float)
+    */
+    template <typename S = float>
+    class Shifted
+    {
+        public:
+            static constexpr char const* NAME = "shifted";
+            static constexpr bool IS_SHIFTED  = true;
+
+            template <typename T>
+            using type = S;
+
+            template <class LT, typename T>
+            static inline T __attribute__((always_inline)) Load(type<T> const f, unsigned int const curr)
+            {
+                return static_cast<T>(f) + LT::W[curr];
+            }
+
+            template <class LT, typename T>
+            static inline type<T> __attribute__((always_inline)) Store(T const f, unsigned int const curr)
+            {
+                return static_cast<type<T>>(f - LT::W[curr]);
+            }
+    };
+
+    #ifdef __F16C__
+    /**\class  Half
+     * \brief  Deviation of the populations from the lattice weights is stored in half precision
+     *         (IEEE 754 binary16 converted with F16C instructions)
+    */
+    class Half
+    {
+        public:
+            static constexpr char const* NAME = "half";
+            static constexpr bool IS_SHIFTED  = true;
+
+            template <typename T>
+            using type = uint16_t;
+
+            template <class LT, typename T>
+            static inline T __attribute__((always_inline)) Load(type<T> const f, unsigned int const curr)
+            {
+                return static_cast<T>(_cvtsh_ss(f)) + LT::W[curr];
+            }
+
+            template <class LT, typename T>
+            static inline type<T> __attribute__((always_inline)) Store(T const f, unsigned int const curr)
+            {
+                return _cvtss_sh(static_cast<float>(f - LT::W[curr]), _MM_FROUND_TO_NEAREST_INT);
+            }
+    };
+    #endif
+}
+
+#endif // POPULATION_STORAGE_HPP_INCLUDED
@@ -0,0 +1,181 @@
+#ifndef POPULATION_STREAMING_HPP_INCLUDED
+#define POPULATION_STREAMING_HPP_INCLUDED
+
+/**
+ * \file     population_streaming.hpp
+ * \mainpage In-place streaming policies of the populations
+ *
+ * \note     Both streaming policies store a single population array and stream in place: every cell
+ *           writes its post-collision populations to exactly the slots it has read its pre-collision
+ *           populations from. The slots of the positive and negative directions are swapped from one
+ *           time step to the next, so that all kernels are instantiated for even and odd time steps.
+ *           The policies only differ in the cells that are accessed:
+ *           - AA:           even time steps are purely local, odd time steps read from and write to all
+ *                           neighbours of a cell (non-uniform access pattern)
+ *           - EsotericPull: every time step accesses the cell itself and its neighbours in the
+ *                           positive directions only (9 for D3Q19, 13 for D3Q27): the positive
+ *                           directions are always streamed like the even A-A step and the negative
+ *                           ones like the odd A-A step. The accesses of all steps are alike and
+ *                           only touch the upper half of the neighbouring cells.
+ *           The layout policy of the population maps the resulting coordinates to the linear memory.
+ *
+ * \note     "Accelerating Lattice Boltzmann Fluid Flow Simulations Using Graphics Processors"
+ *           P. Bailey, J. Myre, S.D.C. Walsh, D.J. Lilja, M.O. Saar
+ *           38th International Conference on Parallel Processing (ICPP), Vienna, Austria (2009)
+ *           DOI: 10.1109/ICPP.2009.38
+ *
+ *           "Esoteric Twist: An Efficient in-Place Streaming Algorithmus for the Lattice Boltzmann
+ *           Method on Massively Parallel Hardware"
+ *           M. Geier, M. Schönherr
+ *           Computation 5 (2017)
+ *           DOI: 10.3390/computation5020019
+ *
+ *           "Esoteric Pull and Esoteric Push: Two Simple In-Place Streaming Schemes for the Lattice
+ *           Boltzmann Method on GPUs"
+ *           M. Lehmann
+ *           Computation 10 (2022)
+ *           DOI: 10.3390/computation10060092
+*/
+
+#include <cstddef>
+
+
+/**\def       O_E (odd,a,b)
+ * \brief     Macro for access in odd and even time steps
+ *
+ * \param[in] odd   boolean index for odd (1 = true) and even (0 = false) time steps
+ * \param[in] a     index to be accessed at an odd time step
+ * \param[in] b     index to be accessed at an even time step
+*/
+#define O_E(odd,a,b)    a*static_cast<decltype(a)>(odd) + b*static_cast<decltype(b)>(!odd)
+
+
+namespace streaming
+{
+    /**\class  AA
+     * \brief  A-A access pattern: even time steps perform only a local collision step with a reverse
+     *         read of the populations and a regular write while odd steps perform a combined
+     *         streaming-collision-streaming step with a regular read and a reverse write
+    */
+    class AA
+    {
+        public:
+            /// identifier of the policy (e.g. in the header of checkpoints)
+            static constexpr unsigned int ID = 0;
+            static constexpr char const* NAME = "A-A";
+
+            /**\fn        IndexRead
+             * \brief     Linear index of a population before collision
+             *
+             * \tparam    odd    even (0, false) or odd (1, true) time step
+             * \tparam    NX     simulation domain resolution in x-direction
+             * \tparam    NY     simulation domain resolution in y-direction
+             * \tparam    NZ     simulation domain resolution in z-direction
+             * \tparam    LT     static lattice::DdQq class containing discretisation parameters
+             * \tparam    NPOP   number of populations stored side by side in the lattice
+             * \tparam    LY     memory layout policy of the populations
+             * \param[in] x      x coordinates of current cell and its neighbours [x-1,x,x+1]
+             * \param[in] y      y coordinates of current cell and its neighbours [y-1,y,y+1]
+             * \param[in] z      z coordinates of current cell and its neighbours [z-1,z,z+1]
+             * \param[in] n      positive (0) or negative (1) index/lattice velocity
+             * \param[in] d      relevant population index
+             * \param[in] p      relevant population
+             * \return    requested linear population index before collision
+            */
+            template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY>
+            static inline size_t __attribute__((always_inline)) IndexRead(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                          unsigned int const n,       unsigned int const d,       unsigned int const p)
+            {
+                return LY::template SpatialToLinear<NX,NY,NZ,LT,NPOP>(x[1 + O_E(odd, static_cast<int>(LT::DX[!n*LT::OFF+d]), 0)],
+                                                                      y[1 + O_E(odd, static_cast<int>(LT::DY[!n*LT::OFF+d]), 0)],
+                                                                      z[1 + O_E(odd, static_cast<int>(LT::DZ[!n*LT::OFF+d]), 0)],
+                                                                      O_E(odd, n, !n),
+                                                                      d, p);
+            }
+
+            /**\fn        IndexWrite
+             * \brief     Linear index of a population after collision
+             *
+             * \tparam    odd    even (0, false) or odd (1, true) time step
+             * \param[in] x      x coordinates of current cell and its neighbours [x-1,x,x+1]
+             * \param[in] y      y coordinates of current cell and its neighbours [y-1,y,y+1]
+             * \param[in] z      z coordinates of current cell and its neighbours [z-1,z,z+1]
+             * \param[in] n      positive (0) or negative (1) index/lattice velocity
+             * \param[in] d      relevant population index
+             * \param[in] p      relevant population
+             * \return    requested linear population index after collision
+            */
+            template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY>
+            static inline size_t __attribute__((always_inline)) IndexWrite(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                           unsigned int const n,       unsigned int const d,       unsigned int const p)
+            {
+                return LY::template SpatialToLinear<NX,NY,NZ,LT,NPOP>(x[1 + O_E(odd, static_cast<int>(LT::DX[n*LT::OFF+d]), 0)],
+                                                                      y[1 + O_E(odd, static_cast<int>(LT::DY[n*LT::OFF+d]), 0)],
+                                                                      z[1 + O_E(odd, static_cast<int>(LT::DZ[n*LT::OFF+d]), 0)],
+                                                                      O_E(odd, !n, n),
+                                                                      d, p);
+            }
+    };
+
+    /**\class  EsotericPull
+     * \brief  Esoteric pull: the populations of the positive directions are read from the cell itself
+     *         and written to the neighbour they are streamed to, the ones of the negative directions
+     *         are read from the neighbour in the opposite (positive) direction and written to the cell
+     *         itself. The slots are swapped between even and odd time steps as with the A-A pattern.
+    */
+    class EsotericPull
+    {
+        public:
+            /// identifier of the policy (e.g. in the header of checkpoints)
+            static constexpr unsigned int ID = 1;
+            static constexpr char const* NAME = "esoteric pull";
+
+            /**\fn        IndexRead
+             * \brief     Linear index of a population before collision
+             *
+             * \tparam    odd    even (0, false) or odd (1, true) time step
+             * \param[in] x      x coordinates of current cell and its neighbours [x-1,x,x+1]
+             * \param[in] y      y coordinates of current cell and its neighbours [y-1,y,y+1]
+             * \param[in] z      z coordinates of current cell and its neighbours [z-1,z,z+1]
+             * \param[in] n      positive (0) or negative (1) index/lattice velocity
+             * \param[in] d      relevant population index
+             * \param[in] p      relevant population
+             * \return    requested linear population index before collision
+            */
+            template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY>
+            static inline size_t __attribute__((always_inline)) IndexRead(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                          unsigned int const n,       unsigned int const d,       unsigned int const p)
+            {
+                return LY::template SpatialToLinear<NX,NY,NZ,LT,NPOP>(x[1 + static_cast<int>(LT::DX[d])*static_cast<int>(n)],
+                                                                      y[1 + static_cast<int>(LT::DY[d])*static_cast<int>(n)],
+                                                                      z[1 + static_cast<int>(LT::DZ[d])*static_cast<int>(n)],
+                                                                      O_E(odd, n, !n),
+                                                                      d, p);
+            }
+
+            /**\fn        IndexWrite
+             * \brief     Linear index of a population after collision
+             *
+             * \tparam    odd    even (0, false) or odd (1, true) time step
+             * \param[in] x      x coordinates of current cell and its neighbours [x-1,x,x+1]
+             * \param[in] y      y coordinates of current cell and its neighbours [y-1,y,y+1]
+             * \param[in] z      z coordinates of current cell and its neighbours [z-1,z,z+1]
+             * \param[in] n      positive (0) or negative (1) index/lattice velocity
+             * \param[in] d      relevant population index
+             * \param[in] p      relevant population
+             * \return    requested linear population index after collision
+            */
+            template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY>
+            static inline size_t __attribute__((always_inline)) IndexWrite(unsigned int const (&x)[3], unsigned int const (&y)[3], unsigned int const (&z)[3],
+                                                                           unsigned int const n,       unsigned int const d,       unsigned int const p)
+            {
+                return LY::template SpatialToLinear<NX,NY,NZ,LT,NPOP>(x[1 + static_cast<int>(LT::DX[d])*static_cast<int>(!n)],
+                                                                      y[1 + static_cast<int>(LT::DY[d])*static_cast<int>(!n)],
+                                                                      z[1 + static_cast<int>(LT::DZ[d])*static_cast<int>(!n)],
+                                                                      O_E(odd, !n, n),
+                                                                      d, p);
+            }
+    };
+}
+
+#endif // POPULATION_STREAMING_HPP_INCLUDED
@@ -0,0 +1,426 @@
+#ifndef PROBES_HPP_INCLUDED
+#define PROBES_HPP_INCLUDED
+
+/**
+ * \file     probes.hpp
+ * \mainpage Point, line and plane probes sampled within the collision sweep
+ *
+ * \note     Spectra and shedding frequencies require the velocity at a few hundred points on every
+ *           time step, which is prohibitive with an export of the full field. The probes are registered
+ *           up front and sorted by the loop blocks of a fluid cell list (or the planes of a wavefront).
+ *           They are passed to the collision kernels like a fused boundary and sampled at the beginning
+ *           of every block from the populations the collision of the block is about to read, so that no
+ *           macroscopic values have to be written to the continuum (the sampled values are the ones the
+ *           collision evaluates). Every block keeps its own sample counter and writes to its own range of
+ *           a ring buffer: the planes of a wavefront that are at different time levels are sampled
+ *           consistently and no synchronisation between the threads is required. The ring buffer is
+ *           written to disk in large batches by Flush, outside of the collision kernels.
+ *           Output for a probe set called 'name':
+ *           - name_points.csv: coordinates of all sampled cells in the order of the records,
+ *           - name.bin: consecutive records, one every INTERVAL_ time steps, holding density and the
+ *             three velocity components of every sampled cell in the floating data type T.
+*/
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "../general/memory_alignment.hpp"
+#include "../lattice/equilibrium.hpp"
+#include "population.hpp"
+
+
+/// coordinates of a sampled cell
+typedef std::array<unsigned int,3> probePoint;
+
+/**\fn        ProbePoint
+ * \brief     Probe set consisting of a single cell
+ *
+ * \param[in] x   x coordinate of the cell
+ * \param[in] y   y coordinate of the cell
+ * \param[in] z   z coordinate of the cell
+ * \return    vector holding the cell
+*/
+inline std::vector<probePoint> ProbePoint(unsigned int const x, unsigned int const y, unsigned int const z)
+{
+    return { probePoint{x, y, z} };
+}
+
+/**\fn        ProbeLine
+ * \brief     Probe set consisting of equidistant cells on a line parallel to a coordinate axis
+ *
+ * \param[in] start    coordinates of the first cell
+ * \param[in] axis     direction of the line ("x", "y" or "z")
+ * \param[in] number   number of cells
+ * \param[in] stride   distance between two cells (default = 1)
+ * \return    vector holding the cells
+*/
+inline std::vector<probePoint> ProbeLine(probePoint const& start, std::string const& axis, unsigned int const number,
+                                         unsigned int const stride = 1)
+{
+    unsigned int const a = (axis == "x") ? 0 : ((axis == "y") ? 1 : 2);
+    if ((axis != "x") && (axis != "y") && (axis != "z"))
+    {
+        std::cerr << "Fatal error: Unknown axis '" << axis << "' of probe line." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<probePoint> points(number, start);
+    for(unsigned int i = 0; i < number; ++i)
+    {
+        points[i][a] += i*stride;
+    }
+    return points;
+}
+
+/**\fn        ProbePlane
+ * \brief     Probe set consisting of equidistant cells on a plane normal to a coordinate axis
+ *
+ * \tparam    NX         simulation domain resolution in x-direction
+ * \tparam    NY         simulation domain resolution in y-direction
+ * \tparam    NZ         simulation domain resolution in z-direction
+ * \param[in] axis       normal of the plane ("x", "y" or "z")
+ * \param[in] position   coordinate of the plane along its normal
+ * \param[in] stride     distance between two cells in both directions of the plane (default = 1)
+ * \return    vector holding the cells
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+std::vector<probePoint> ProbePlane(std::string const& axis, unsigned int const position, unsigned int const stride = 1)
+{
+    unsigned int const a = (axis == "x") ? 0 : ((axis == "y") ? 1 : 2);
+    if ((axis != "x") && (axis != "y") && (axis != "z"))
+    {
+        std::cerr << "Fatal error: Unknown axis '" << axis << "' of probe plane." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::array<unsigned int,3> const size = {NX, NY, NZ};
+    unsigned int const b = (a + 1) % 3;
+    unsigned int const c = (a + 2) % 3;
+
+    std::vector<probePoint> points;
+    for(unsigned int j = 0; j < size[c]; j += stride)
+    {
+        for(unsigned int i = 0; i < size[b]; i += stride)
+        {
+            probePoint point;
+            point[a] = position;
+            point[b] = i;
+            point[c] = j;
+            points.push_back(point);
+        }
+    }
+    return points;
+}
+
+
+/**\class  Probes
+ * \brief  Set of cells whose density and velocity are sampled within the collision sweep every given
+ *         number of time steps and buffered in a ring buffer, written to disk in batches
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+ * \tparam T    floating data type used for simulation
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T = double>
+class Probes
+{
+    public:
+        /// number of time steps between two samples
+        size_t const   INTERVAL_;
+        /// number of samples held by the ring buffer
+        size_t const   CAPACITY_;
+        /// values per sampled cell: density and velocity
+        static constexpr unsigned int NV_ = 4;
+
+        /// sampled cells sorted by block and index of the first sampled cell of every block
+        std::vector<probePoint> points_;
+        std::vector<size_t>     blocks_;
+
+        /// interface of the fused boundaries: probes are always sampled within the sweep
+        std::vector<probePoint> unfused_;
+
+
+        /**\brief Class constructor
+         * \param fluid      fluid cell list (or wavefront) whose collision the probes are sampled in
+         * \param points     cells to be sampled (see ProbePoint, ProbeLine, ProbePlane)
+         * \param fileName   file name of the samples without extension (empty: no file)
+         * \param interval   number of time steps between two samples (default = 1)
+         * \param capacity   number of samples per cell held in memory (default = 1024)
+        */
+        template <class CL>
+        Probes(CL const& fluid, std::vector<probePoint> const& points, std::string const& fileName,
+               size_t const interval = 1, size_t const capacity = 1024);
+
+        Probes(Probes const&) = delete;
+        Probes& operator= (Probes const&) = delete;
+
+        /**\brief Class destructor: write the remaining samples
+        */
+        ~Probes()
+        {
+            Flush();
+            if (file_ != nullptr)
+            {
+                fclose(file_);
+            }
+        }
+
+        /// sample the cells of a single block (called by the collision kernels)
+        template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+        inline void ApplyBlock(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, unsigned int const block, unsigned int const p) const;
+
+        /// write all samples that were taken in all blocks
+        void Flush();
+
+        /// access functions
+        inline bool   IsFlushDue() const;
+        inline size_t GetNumberOfPoints() const;
+        inline size_t GetNumberOfSamples() const;
+
+    private:
+        /// time steps the blocks were swept and number of samples written to disk (written within the sweep)
+        mutable std::vector<size_t> steps_;
+        size_t                      flushed_;
+
+        /// ring buffer [sample % CAPACITY_][point][value]
+        mutable std::vector<T, DefaultInitAllocator<T>> buffer_;
+
+        FILE*                       file_;
+
+        /// number of samples that have been taken in all blocks holding probes
+        inline size_t Completed() const;
+        /// largest number of samples taken in any block
+        inline size_t Taken() const;
+};
+
+
+/**\fn        Probes
+ * \brief     Sort the sampled cells by block and write their coordinates. Cells outside of the range in
+ *            z-direction of the list (they belong to another list) and solid cells are ignored.
+ *
+ * \tparam    CL         type of the fluid cell list (FluidCells or Wavefront)
+ * \param[in] fluid      fluid cell list (or wavefront) whose collision the probes are sampled in
+ * \param[in] points     cells to be sampled
+ * \param[in] fileName   file name of the samples without extension (empty: no file)
+ * \param[in] interval   number of time steps between two samples
+ * \param[in] capacity   number of samples per cell held in memory
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T> template <class CL>
+Probes<NX,NY,NZ,T>::Probes(CL const& fluid, std::vector<probePoint> const& points, std::string const& fileName,
+                           size_t const interval, size_t const capacity):
+    INTERVAL_(std::max(interval, size_t(1))), CAPACITY_(std::max(capacity, size_t(2))), points_(),
+    blocks_(fluid.NUM_BLOCKS_ + 1, 0), unfused_(), steps_(fluid.NUM_BLOCKS_, 0), flushed_(0), buffer_(), file_(nullptr)
+{
+    std::vector<unsigned int> block;
+    for(probePoint const& point: points)
+    {
+        if ((point[0] >= NX) || (point[1] >= NY) || (point[2] >= NZ))
+        {
+            std::cerr << "Fatal error: Probe (" << point[0] << "," << point[1] << "," << point[2] << ") outside of the domain." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (fluid.IsFluid(point[0], point[1], point[2]) == true)
+        {
+            points_.push_back(point);
+            block.push_back(fluid.GetBlock(point[0], point[1], point[2]));
+            ++blocks_[block.back() + 1];
+        }
+    }
+
+    for(unsigned int k = 0; k < fluid.NUM_BLOCKS_; ++k)
+    {
+        blocks_[k + 1] += blocks_[k];
+    }
+
+    /// stable counting sort by block
+    std::vector<size_t> next(blocks_.begin(), blocks_.end() - 1);
+    std::vector<probePoint> sorted(points_.size());
+    for(size_t i = 0; i < points_.size(); ++i)
+    {
+        sorted[next[block[i]]++] = points_[i];
+    }
+    points_.swap(sorted);
+
+    buffer_.resize(CAPACITY_*points_.size()*NV_);
+
+    if ((fileName.empty() == false) && (points_.empty() == false))
+    {
+        std::ofstream coordinates(fileName + "_points.csv", std::ios::out | std::ios::trunc);
+        if (coordinates.is_open() == false)
+        {
+            std::cerr << "Fatal error: Probe file " << fileName << "_points.csv could not be opened." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        coordinates << "point,x,y,z" << std::endl;
+        for(size_t i = 0; i < points_.size(); ++i)
+        {
+            coordinates << i << "," << points_[i][0] << "," << points_[i][1] << "," << points_[i][2] << "\n";
+        }
+
+        file_ = fopen((fileName + ".bin").c_str(), "wb");
+        if (file_ == nullptr)
+        {
+            std::cerr << "Fatal error: Probe file " << fileName << ".bin could not be opened." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/**\fn        ApplyBlock
+ * \brief     Sample the cells of a single block from the populations that the collision of the block
+ *            reads in the current time step (called by the collision kernels before the first cell of
+ *            the block is collided, after the fused boundaries that are passed before the probes)
+ *
+ * \tparam    odd     even (0, false) or odd (1, true) time step
+ * \tparam    LT      static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP    number of populations stored side by side in the lattice
+ * \tparam    LY      memory layout policy of the populations
+ * \tparam    ST      storage policy of the populations
+ * \tparam    SP      streaming policy of the populations
+ * \param[in] pop     population object holding microscopic variables
+ * \param[in] block   the block of interest
+ * \param[in] p       relevant population
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+inline void Probes<NX,NY,NZ,T>::ApplyBlock(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop, unsigned int const block, unsigned int const p) const
+{
+    if (blocks_[block] == blocks_[block + 1])
+    {
+        return;
+    }
+
+    size_t const step = steps_[block]++;
+    if (step % INTERVAL_ != 0)
+    {
+        return;
+    }
+
+    T* const sample = &buffer_[((step/INTERVAL_) % CAPACITY_)*points_.size()*NV_];
+
+    for(size_t i = blocks_[block]; i < blocks_[block + 1]; ++i)
+    {
+        probePoint const& point = points_[i];
+        unsigned int const x_n[3] = { (NX + point[0] - 1) % NX, point[0], (point[0] + 1) % NX };
+        unsigned int const y_n[3] = { (NY + point[1] - 1) % NY, point[1], (point[1] + 1) % NY };
+        unsigned int const z_n[3] = { (NZ + point[2] - 1) % NZ, point[2], (point[2] + 1) % NZ };
+
+        alignas(CACHE_LINE) T f[LT::ND] = {0.0};
+
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                f[n*LT::OFF + d] = pop.Load(pop. template IndexRead<odd>(x_n,y_n,z_n,n,d,p), n, d);
+            }
+        }
+
+        lattice::Velocity<LT>(f, sample[i*NV_ + 0], sample[i*NV_ + 1], sample[i*NV_ + 2], sample[i*NV_ + 3]);
+    }
+}
+
+/**\fn        Completed
+ * \brief     Number of samples that have been taken in all blocks holding probes
+ *
+ * \return    number of complete samples
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+inline size_t Probes<NX,NY,NZ,T>::Completed() const
+{
+    size_t completed = static_cast<size_t>(-1);
+    for(size_t block = 0; block < steps_.size(); ++block)
+    {
+        if (blocks_[block] != blocks_[block + 1])
+        {
+            completed = std::min(completed, (steps_[block] + INTERVAL_ - 1)/INTERVAL_);
+        }
+    }
+    return (points_.empty() == true) ? 0 : completed;
+}
+
+/**\fn        Taken
+ * \brief     Largest number of samples taken in any block
+ *
+ * \return    number of samples
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+inline size_t Probes<NX,NY,NZ,T>::Taken() const
+{
+    size_t taken = 0;
+    for(size_t block = 0; block < steps_.size(); ++block)
+    {
+        taken = std::max(taken, (steps_[block] + INTERVAL_ - 1)/INTERVAL_);
+    }
+    return taken;
+}
+
+/**\fn        Flush
+ * \brief     Write all samples that were taken in all blocks to disk (at most two contiguous ranges of
+ *            the ring buffer). Has to be called outside of the collision kernels at least every
+ *            CAPACITY_ samples (see IsFlushDue).
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+void Probes<NX,NY,NZ,T>::Flush()
+{
+    if (Taken() > flushed_ + CAPACITY_)
+    {
+        std::cerr << "Fatal error: Ring buffer of the probes overrun, flush more frequently." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    size_t const completed = Completed();
+    size_t const record    = points_.size()*NV_;
+
+    while ((file_ != nullptr) && (flushed_ < completed))
+    {
+        size_t const first = flushed_ % CAPACITY_;
+        size_t const count = std::min(completed - flushed_, CAPACITY_ - first);
+        fwrite(&buffer_[first*record], sizeof(T), count*record, file_);
+        flushed_ += count;
+    }
+    flushed_ = std::max(flushed_, completed);
+}
+
+/**\fn        IsFlushDue
+ * \brief     Check if half of the ring buffer is filled with samples that were not written yet
+ *
+ * \return    Boolean true if the probes should be flushed, else false
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+inline bool Probes<NX,NY,NZ,T>::IsFlushDue() const
+{
+    return Completed() >= flushed_ + CAPACITY_/2;
+}
+
+/**\fn        GetNumberOfPoints
+ * \brief     Number of sampled cells
+ *
+ * \return    number of sampled cells
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+inline size_t Probes<NX,NY,NZ,T>::GetNumberOfPoints() const
+{
+    return points_.size();
+}
+
+/**\fn        GetNumberOfSamples
+ * \brief     Number of samples written to disk so far
+ *
+ * \return    number of samples
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, typename T>
+inline size_t Probes<NX,NY,NZ,T>::GetNumberOfSamples() const
+{
+    return flushed_;
+}
+
+#endif // PROBES_HPP_INCLUDED
@@ -0,0 +1,852 @@
+#ifndef REFINEMENT_HPP_INCLUDED
+#define REFINEMENT_HPP_INCLUDED
+
+/**
+ * \file     refinement.hpp
+ * \mainpage Block-structured local grid refinement with local time stepping
+ *
+ * \note     A box of the coarse domain (e.g. around an obstacle and its near wake) is covered by a fine
+ *           patch with half the spacing and half the time step (acoustic scaling, refinement ratio 2).
+ *           The patch is an ordinary population with its own loop blocks so that the collision kernels,
+ *           the fluid cell lists and the fused bounce-back are used without modification while its
+ *           geometry is voxelised with the fine spacing. The patch carries a single layer of ghost
+ *           cells lying inside the coarse cells around the box. Every coarse time step
+ *           - the coarse cells covered by the patch are restricted from their eight fine cells (average
+ *             of density, momentum and non-equilibrium part of the fluid children),
+ *           - the coarse cells around the interface are sampled before and after the coarse step and
+ *           - the patch performs two fine time steps (even and odd). Before each of them the
+ *             pre-collision populations of the ghost cells are reconstructed from the coarse samples
+ *             interpolated tri-linearly in space and linearly in time (at t and t + 1/2).
+ *           - the mass defect of the interface is removed from the fine cells next to the ghost layer.
+ *           The non-equilibrium parts are rescaled by the ratio of the relaxation times so that the
+ *           viscous stress is continuous across the interface. Further levels are obtained by nesting
+ *           patches: the fine time step of one level advances the patch of the next level.
+ *           All transfers are formulated with IndexRead of the populations and are therefore valid for
+ *           all memory layouts, storage and streaming policies.
+ * \note     "Theory and applications of an alternative lattice Boltzmann grid refinement algorithm"
+ *           A. Dupuis, B. Chopard
+ *           Physical Review E 67 (2003)
+ *           DOI: 10.1103/PhysRevE.67.066707
+ * \note     Mass-defect correction: the flow is represented by the coarse cells that are not covered by
+ *           the patch and the fine cells inside the ghost layer (of an eighth of the volume). The covered
+ *           coarse cells and the ghost cells are overwritten by the transfers, so the mass this composite
+ *           gains through the interface during a coarse time step is the mass the covered cells lose
+ *           during the coarse step plus an eighth of the mass the ghost cells lose during the two fine
+ *           steps. The interpolated ghost cells in general do not provide the same flux as the coarse
+ *           level, this defect is therefore evaluated every coarse time step and removed from the fine
+ *           fluid cells next to the ghost layer at rest (without changing their momentum), which makes
+ *           the transfer conservative in mass while the boundaries of the coarse domain are unaffected.
+ *           Momentum is only conserved up to the interpolation error (second order in space, first order
+ *           in time).
+ * \warning  The rescaling only considers the laminar relaxation times (the eddy viscosity of a turbulence
+ *           model is not rescaled) and the patch has to lie at least one cell away from the faces of the
+ *           coarse domain.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <stdlib.h>
+#include <type_traits>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../general/memory_alignment.hpp"
+#include "../lattice/equilibrium.hpp"
+#include "fluid_cells.hpp"
+#include "population.hpp"
+
+
+/**\struct refinementGhost
+ * \brief  Ghost cell of a refined patch together with the coarse samples it is interpolated from
+ *
+ * \tparam T   floating data type used for simulation
+*/
+template <typename T>
+struct refinementGhost
+{
+    unsigned int x_n[3];    ///< x coordinates of the cell and its neighbours [x-1,x,x+1]
+    unsigned int y_n[3];    ///< y coordinates of the cell and its neighbours [y-1,y,y+1]
+    unsigned int z_n[3];    ///< z coordinates of the cell and its neighbours [z-1,z,z+1]
+    unsigned int sample[8]; ///< coarse samples of the tri-linear stencil
+    T            weight[8]; ///< weights of the samples (normalised over the fluid samples)
+};
+
+/**\struct refinementParent
+ * \brief  Coarse cell covered by a refined patch
+*/
+struct refinementParent
+{
+    unsigned int x;        ///< x coordinate of the coarse cell
+    unsigned int y;        ///< y coordinate of the coarse cell
+    unsigned int z;        ///< z coordinate of the coarse cell
+    uint32_t     children; ///< fluid fine cells of the coarse cell (bit (k*2 + j)*2 + i for the child i,j,k)
+};
+
+/**\struct refinementCell
+ * \brief  Fine fluid cell of a refined patch next to its ghost layer
+*/
+struct refinementCell
+{
+    unsigned int x; ///< x coordinate of the fine cell
+    unsigned int y; ///< y coordinate of the fine cell
+    unsigned int z; ///< z coordinate of the fine cell
+};
+
+
+/**\fn        RefinementDensity
+ * \brief     Density (sum of the pre-collision populations) of a single cell
+ *
+ * \tparam    odd    even (0, false) or odd (1, true) time step that will be performed next
+ * \tparam    NX     simulation domain resolution in x-direction
+ * \tparam    NY     simulation domain resolution in y-direction
+ * \tparam    NZ     simulation domain resolution in z-direction
+ * \tparam    LT     static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP   number of populations stored side by side in the lattice
+ * \tparam    LY     memory layout policy of the populations
+ * \tparam    ST     storage policy of the populations
+ * \tparam    SP     streaming policy of the populations
+ * \param[in] pop    population object holding microscopic variables
+ * \param[in] x      x coordinate of the cell
+ * \param[in] y      y coordinate of the cell
+ * \param[in] z      z coordinate of the cell
+ * \param[in] p      relevant population
+ * \return    density of the cell
+*/
+template <bool odd, unsigned int NX, unsigned int NY, unsigned int NZ, class LT, unsigned int NPOP, class LY, class ST, class SP>
+inline typename Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::T RefinementDensity(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& pop,
+                                                                           unsigned int const x, unsigned int const y, unsigned int const z,
+                                                                           unsigned int const p)
+{
+    unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+    unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+    unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+    typename Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>::T rho = 0.0;
+
+    #pragma GCC unroll (2)
+    for(unsigned int n = 0; n <= 1; ++n)
+    {
+        #pragma GCC unroll (16)
+        for(unsigned int d = n; d < LT::HSPEED; ++d)
+        {
+            rho += pop.Load(pop. template IndexRead<odd>(x_n,y_n,z_n,n,d,p), n, d);
+        }
+    }
+    return rho;
+}
+
+
+/**\class  RefinedPatch
+ * \brief  Fine patch covering the box [X0,X0+PX) x [Y0,Y0+PY) x [Z0,Z0+PZ) of a coarse domain and the
+ *         transfer of the populations across its interface
+ *
+ * \tparam NX   coarse simulation domain resolution in x-direction
+ * \tparam NY   coarse simulation domain resolution in y-direction
+ * \tparam NZ   coarse simulation domain resolution in z-direction
+ * \tparam X0   first coarse cell covered by the patch in x-direction
+ * \tparam Y0   first coarse cell covered by the patch in y-direction
+ * \tparam Z0   first coarse cell covered by the patch in z-direction
+ * \tparam PX   number of coarse cells covered by the patch in x-direction
+ * \tparam PY   number of coarse cells covered by the patch in y-direction
+ * \tparam PZ   number of coarse cells covered by the patch in z-direction
+ * \tparam T    floating data type used for simulation
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int X0, unsigned int Y0, unsigned int Z0,
+          unsigned int PX, unsigned int PY, unsigned int PZ, typename T>
+class RefinedPatch
+{
+    public:
+        static_assert((X0 >= 1) && (Y0 >= 1) && (Z0 >= 1), "Refined patch has to lie inside the coarse domain (lower faces).");
+        static_assert((X0 + PX < NX) && (Y0 + PY < NY) && (Z0 + PZ < NZ), "Refined patch has to lie inside the coarse domain (upper faces).");
+        static_assert((PX >= 2) && (PY >= 2) && (PZ >= 2), "Refined patch has to cover at least two coarse cells in each direction.");
+
+        /// refinement ratio in space and time and ghost layer around the patch
+        static constexpr unsigned int RATIO_ = 2;
+        static constexpr unsigned int GHOST_ = 1;
+
+        /// resolution of the fine population including the ghost layers
+        static constexpr unsigned int NX_FINE_ = RATIO_*PX + 2*GHOST_;
+        static constexpr unsigned int NY_FINE_ = RATIO_*PY + 2*GHOST_;
+        static constexpr unsigned int NZ_FINE_ = RATIO_*PZ + 2*GHOST_;
+
+        /// coarse cells the ghost cells are interpolated from: box [X0-1,X0+PX] x [Y0-1,Y0+PY] x [Z0-1,Z0+PZ]
+        static constexpr unsigned int BOX_X_ = PX + 2;
+        static constexpr unsigned int BOX_Y_ = PY + 2;
+        static constexpr unsigned int BOX_Z_ = PZ + 2;
+
+        /// rescaling of the non-equilibrium part from the coarse to the fine level and vice versa
+        T const COARSE_TO_FINE_;
+        T const FINE_TO_COARSE_;
+
+        /// number of values per sample: density, velocity and non-equilibrium part of all populations
+        unsigned int const STRIDE_;
+
+        /// ghost cells of the patch, coarse cells covered by the patch and fine cells next to the ghost layer
+        std::vector<refinementGhost<T>> ghosts_;
+        std::vector<refinementParent>   parents_;
+        std::vector<refinementCell>     interface_;
+
+        /// coarse cells sampled around the interface (linear index within the box) and their values
+        //  before and after the coarse time step
+        std::vector<unsigned int>       samples_;
+        std::vector<T>                  before_;
+        std::vector<T>                  after_;
+
+
+        /**\brief Class constructor
+         * \param coarse        coarse population
+         * \param coarseFluid   fluid cell list of the coarse population
+         * \param fine          fine population of the patch (characteristic length scaled by RATIO_)
+         * \param fineFluid     fluid cell list of the fine population
+        */
+        template <class LT, unsigned int NPOP, class LY, class ST, class SP>
+        RefinedPatch(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& coarse, FluidCells<NX,NY,NZ> const& coarseFluid,
+                     Population<NX_FINE_,NY_FINE_,NZ_FINE_,LT,NPOP,LY,ST,SP> const& fine,
+                     FluidCells<NX_FINE_,NY_FINE_,NZ_FINE_> const& fineFluid);
+
+        /// position of the fine cell (0,0,0) and spacing of the fine cells in coarse lattice units
+        static constexpr std::array<double,3> Origin();
+        static constexpr double               Spacing();
+
+        /// transfer between the levels
+        template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+        void Restrict(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& coarse,
+                      Population<NX_FINE_,NY_FINE_,NZ_FINE_,LT,NPOP,LY,ST,SP> const& fine, unsigned int const p = 0) const;
+        template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+        void Sample(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& coarse, std::vector<T>& values, unsigned int const p = 0) const;
+        template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+        void Prolongate(Population<NX_FINE_,NY_FINE_,NZ_FINE_,LT,NPOP,LY,ST,SP>& fine, T const alpha, unsigned int const p = 0) const;
+
+        /// mass-defect correction of the interface
+        template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+        T CoveredMass(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& coarse, unsigned int const p = 0) const;
+        template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+        T GhostMass(Population<NX_FINE_,NY_FINE_,NZ_FINE_,LT,NPOP,LY,ST,SP> const& fine, unsigned int const p = 0) const;
+        template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+        void Correct(Population<NX_FINE_,NY_FINE_,NZ_FINE_,LT,NPOP,LY,ST,SP>& fine, T const defect, unsigned int const p = 0) const;
+
+        /// single coarse time step with two fine time steps of the patch
+        template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP, class COARSE, class FINE>
+        void Advance(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& coarse, Population<NX_FINE_,NY_FINE_,NZ_FINE_,LT,NPOP,LY,ST,SP>& fine,
+                     COARSE const& coarseStep, FINE const& fineStep, unsigned int const p = 0);
+
+        /// number of fine cells including the ghost layers
+        static constexpr size_t GetNumberOfCells();
+};
+
+
+/**\fn        RefinedPatch
+ * \brief     Collect the coarse cells covered by the patch and the ghost cells of the patch together with
+ *            their interpolation stencils. Solid fine cells are neither restricted nor reconstructed and
+ *            solid coarse cells are excluded from the stencils (the remaining weights are renormalised).
+ *
+ * \tparam    LT            static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP          number of populations stored side by side in the lattice
+ * \tparam    LY            memory layout policy of the populations
+ * \tparam    ST            storage policy of the populations
+ * \tparam    SP            streaming policy of the populations
+ * \param[in] coarse        coarse population
+ * \param[in] coarseFluid   fluid cell list of the coarse population
+ * \param[in] fine          fine population of the patch (characteristic length scaled by RATIO_)
+ * \param[in] fineFluid     fluid cell list of the fine population
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int X0, unsigned int Y0, unsigned int Z0,
+          unsigned int PX, unsigned int PY, unsigned int PZ, typename T>
+template <class LT, unsigned int NPOP, class LY, class ST, class SP>
+RefinedPatch<NX,NY,NZ,X0,Y0,Z0,PX,PY,PZ,T>::RefinedPatch(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& coarse, FluidCells<NX,NY,NZ> const& coarseFluid,
+                                                         Population<NX_FINE_,NY_FINE_,NZ_FINE_,LT,NPOP,LY,ST,SP> const& fine,
+                                                         FluidCells<NX_FINE_,NY_FINE_,NZ_FINE_> const& fineFluid):
+    COARSE_TO_FINE_(fine.TAU_/(RATIO_*coarse.TAU_)), FINE_TO_COARSE_(RATIO_*coarse.TAU_/fine.TAU_), STRIDE_(4 + LT::ND),
+    ghosts_(), parents_(), interface_(), samples_(), before_(), after_()
+{
+    /// acoustic scaling: the viscosity in lattice units doubles with every level
+    if (std::abs((fine.TAU_ - 0.5) - RATIO_*(coarse.TAU_ - 0.5)) > 1.0e-10)
+    {
+        std::cerr << "Fatal error: Viscosity of the refined patch does not match the coarse level "
+                  << "(characteristic length has to be scaled by " << RATIO_ << ")." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    /// coarse cells covered by the patch with at least one fluid child
+    for(unsigned int z = Z0; z < Z0 + PZ; ++z)
+    {
+        for(unsigned int y = Y0; y < Y0 + PY; ++y)
+        {
+            for(unsigned int x = X0; x < X0 + PX; ++x)
+            {
+                if (coarseFluid.IsFluid(x, y, z) == false)
+                {
+                    continue;
+                }
+
+                uint32_t children = 0;
+                for(unsigned int k = 0; k < RATIO_; ++k)
+                {
+                    for(unsigned int j = 0; j < RATIO_; ++j)
+                    {
+                        for(unsigned int i = 0; i < RATIO_; ++i)
+                        {
+                            if (fineFluid.IsFluid(GHOST_ + RATIO_*(x - X0) + i, GHOST_ + RATIO_*(y - Y0) + j,
+                                                  GHOST_ + RATIO_*(z - Z0) + k) == true)
+                            {
+                                children |= uint32_t{1} << ((k*RATIO_ + j)*RATIO_ + i);
+                            }
+                        }
+                    }
+                }
+
+                if (children != 0)
+                {
+                    parents_.push_back({x, y, z, children});
+                }
+            }
+        }
+    }
+
+    /// ghost cells: tri-linear stencil of the coarse cells (in the box) around the centre of the fine cell
+    constexpr unsigned int NO_SAMPLE = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> slot(static_cast<size_t>(BOX_X_)*BOX_Y_*BOX_Z_, NO_SAMPLE);
+    std::vector<unsigned int> stencils;
+
+    std::array<double,3> const origin = Origin();
+    for(unsigned int z = 0; z < NZ_FINE_; ++z)
+    {
+        for(unsigned int y = 0; y < NY_FINE_; ++y)
+        {
+            for(unsigned int x = 0; x < NX_FINE_; ++x)
+            {
+                bool const isGhost = (x == 0) || (x == NX_FINE_ - 1) || (y == 0) || (y == NY_FINE_ - 1) ||
+                                     (z == 0) || (z == NZ_FINE_ - 1);
+                if ((isGhost == false) || (fineFluid.IsFluid(x, y, z) == false))
+                {
+                    continue;
+                }
+
+                double const position[3] = { origin[0] + Spacing()*x, origin[1] + Spacing()*y, origin[2] + Spacing()*z };
+                unsigned int lower[3] = {0, 0, 0};
+                double       upper[3] = {0.0, 0.0, 0.0};
+                for(unsigned int c = 0; c < 3; ++c)
+                {
+                    lower[c] = static_cast<unsigned int>(std::floor(position[c]));
+                    upper[c] = position[c] - std::floor(position[c]);
+                }
+
+                refinementGhost<T> ghost = { { (NX_FINE_ + x - 1) % NX_FINE_, x, (x + 1) % NX_FINE_ },
+                                             { (NY_FINE_ + y - 1) % NY_FINE_, y, (y + 1) % NY_FINE_ },
+                                             { (NZ_FINE_ + z - 1) % NZ_FINE_, z, (z + 1) % NZ_FINE_ },
+                                             {0, 0, 0, 0, 0, 0, 0, 0}, {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0} };
+                T sum = 0.0;
+                for(unsigned int s = 0; s < 8; ++s)
+                {
+                    unsigned int const dx = s % 2;
+                    unsigned int const dy = (s / 2) % 2;
+                    unsigned int const dz = s / 4;
+
+                    ghost.sample[s] = ((lower[2] + dz - (Z0 - 1))*BOX_Y_ + lower[1] + dy - (Y0 - 1))*BOX_X_ + lower[0] + dx - (X0 - 1);
+                    if (coarseFluid.IsFluid(lower[0] + dx, lower[1] + dy, lower[2] + dz) == true)
+                    {
+                        ghost.weight[s] = ((dx == 1) ? upper[0] : 1.0 - upper[0])*
+                                          ((dy == 1) ? upper[1] : 1.0 - upper[1])*
+                                          ((dz == 1) ? upper[2] : 1.0 - upper[2]);
+                        sum += ghost.weight[s];
+                    }
+                }
+
+                /// a ghost cell may only be entirely surrounded by solid coarse cells at concave walls
+                if (sum <= 0.0)
+                {
+                    continue;
+                }
+
+                for(unsigned int s = 0; s < 8; ++s)
+                {
+                    ghost.weight[s] /= sum;
+                    if (ghost.weight[s] > 0.0)
+                    {
+                        slot[ghost.sample[s]] = 0;
+                    }
+                }
+                ghosts_.push_back(ghost);
+            }
+        }
+    }
+
+    /// number the samples in the order of the box and replace the box indices of the stencils
+    for(size_t i = 0; i < slot.size(); ++i)
+    {
+        if (slot[i] != NO_SAMPLE)
+        {
+            slot[i] = static_cast<unsigned int>(samples_.size());
+            samples_.push_back(static_cast<unsigned int>(i));
+        }
+    }
+    for(size_t i = 0; i < ghosts_.size(); ++i)
+    {
+        for(unsigned int s = 0; s < 8; ++s)
+        {
+            refinementGhost<T>& ghost = ghosts_[i];
+            ghost.sample[s] = (ghost.weight[s] > 0.0) ? slot[ghost.sample[s]] : 0;
+        }
+    }
+
+    before_.resize(samples_.size()*STRIDE_, 0.0);
+    after_.resize(samples_.size()*STRIDE_, 0.0);
+
+    /// fine fluid cells next to the ghost layer that take up the mass defect of the interface
+    for(unsigned int z = GHOST_; z < NZ_FINE_ - GHOST_; ++z)
+    {
+        for(unsigned int y = GHOST_; y < NY_FINE_ - GHOST_; ++y)
+        {
+            for(unsigned int x = GHOST_; x < NX_FINE_ - GHOST_; ++x)
+            {
+                bool const isInterface = (x == GHOST_) || (x == NX_FINE_ - GHOST_ - 1) || (y == GHOST_) || (y == NY_FINE_ - GHOST_ - 1) ||
+                                         (z == GHOST_) || (z == NZ_FINE_ - GHOST_ - 1);
+                if ((isInterface == true) && (fineFluid.IsFluid(x, y, z) == true))
+                {
+                    interface_.push_back({x, y, z});
+                }
+            }
+        }
+    }
+}
+
+/**\fn        Origin
+ * \brief     Position of the centre of the fine cell (0,0,0) in coarse lattice units (the centre of the
+ *            coarse cell (x,y,z) is located at (x,y,z))
+ *
+ * \return    coordinates of the first fine (ghost) cell
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int X0, unsigned int Y0, unsigned int Z0,
+          unsigned int PX, unsigned int PY, unsigned int PZ, typename T>
+constexpr std::array<double,3> RefinedPatch<NX,NY,NZ,X0,Y0,Z0,PX,PY,PZ,T>::Origin()
+{
+    constexpr double offset = 0.5 + (GHOST_ - 0.5)/RATIO_;
+    return {X0 - offset, Y0 - offset, Z0 - offset};
+}
+
+/**\fn        Spacing
+ * \brief     Spacing of the fine cells in coarse lattice units
+ *
+ * \return    spacing of the fine cells
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int X0, unsigned int Y0, unsigned int Z0,
+          unsigned int PX, unsigned int PY, unsigned int PZ, typename T>
+constexpr double RefinedPatch<NX,NY,NZ,X0,Y0,Z0,PX,PY,PZ,T>::Spacing()
+{
+    return 1.0/RATIO_;
+}
+
+/**\fn        GetNumberOfCells
+ * \brief     Number of fine cells of the patch including the ghost layers
+ *
+ * \return    number of fine cells
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int X0, unsigned int Y0, unsigned int Z0,
+          unsigned int PX, unsigned int PY, unsigned int PZ, typename T>
+constexpr size_t RefinedPatch<NX,NY,NZ,X0,Y0,Z0,PX,PY,PZ,T>::GetNumberOfCells()
+{
+    return static_cast<size_t>(NX_FINE_)*NY_FINE_*NZ_FINE_;
+}
+
+/**\fn         Restrict
+ * \brief      Overwrite the pre-collision populations of the coarse cells covered by the patch with
+ *             the average of their fluid fine cells. Density and momentum are averaged so that both are
+ *             conserved by the transfer. Has to be called at the beginning of a coarse time step while
+ *             the fine level is at the beginning of its even time step.
+ *
+ * \tparam     odd      even (0, false) or odd (1, true) coarse time step
+ * \tparam     LT       static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP     number of populations stored side by side in the lattice
+ * \tparam     LY       memory layout policy of the populations
+ * \tparam     ST       storage policy of the populations
+ * \tparam     SP       streaming policy of the populations
+ * \param[out] coarse   coarse population
+ * \param[in]  fine     fine population of the patch
+ * \param[in]  p        relevant population (default = 0)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int X0, unsigned int Y0, unsigned int Z0,
+          unsigned int PX, unsigned int PY, unsigned int PZ, typename T>
+template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void RefinedPatch<NX,NY,NZ,X0,Y0,Z0,PX,PY,PZ,T>::Restrict(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& coarse,
+                                                          Population<NX_FINE_,NY_FINE_,NZ_FINE_,LT,NPOP,LY,ST,SP> const& fine,
+                                                          unsigned int const p) const
+{
+    std::vector<refinementParent> const& parents = parents_;
+    T const scale = FINE_TO_COARSE_;
+
+    #pragma omp parallel for default(none) shared(coarse, fine, parents) firstprivate(scale, p) schedule(static)
+    for(size_t i = 0; i < parents.size(); ++i)
+    {
+        refinementParent const& parent = parents[i];
+
+        alignas(CACHE_LINE) T f[LT::ND]    = {0.0};
+        alignas(CACHE_LINE) T feq[LT::ND]  = {0.0};
+        alignas(CACHE_LINE) T fneq[LT::ND] = {0.0};
+        T rho = 0.0;
+        T jx  = 0.0;
+        T jy  = 0.0;
+        T jz  = 0.0;
+        unsigned int count = 0;
+
+        for(unsigned int c = 0; c < RATIO_*RATIO_*RATIO_; ++c)
+        {
+            if ((parent.children & (uint32_t{1} << c)) == 0)
+            {
+                continue;
+            }
+
+            unsigned int const x = GHOST_ + RATIO_*(parent.x - X0) + c % RATIO_;
+            unsigned int const y = GHOST_ + RATIO_*(parent.y - Y0) + (c / RATIO_) % RATIO_;
+            unsigned int const z = GHOST_ + RATIO_*(parent.z - Z0) + c / (RATIO_*RATIO_);
+            unsigned int const x_n[3] = { x - 1, x, x + 1 };
+            unsigned int const y_n[3] = { y - 1, y, y + 1 };
+            unsigned int const z_n[3] = { z - 1, z, z + 1 };
+
+            #pragma GCC unroll (2)
+            for(unsigned int n = 0; n <= 1; ++n)
+            {
+                #pragma GCC unroll (16)
+                for(unsigned int d = n; d < LT::HSPEED; ++d)
+                {
+                    f[n*LT::OFF + d] = fine.Load(fine. template IndexRead<false>(x_n,y_n,z_n,n,d,p), n, d);
+                }
+            }
+
+            T r = 0.0;
+            T u = 0.0;
+            T v = 0.0;
+            T w = 0.0;
+            lattice::Velocity<LT>(f, r, u, v, w);
+            lattice::Equilibrium<LT>(r, u, v, w, feq);
+
+            rho += r;
+            jx  += r*u;
+            jy  += r*v;
+            jz  += r*w;
+
+            #pragma GCC unroll (2)
+            for(unsigned int n = 0; n <= 1; ++n)
+            {
+                #pragma GCC unroll (16)
+                for(unsigned int d = n; d < LT::HSPEED; ++d)
+                {
+                    unsigned int const curr = n*LT::OFF + d;
+                    fneq[curr] += f[curr] - feq[curr];
+                }
+            }
+            ++count;
+        }
+
+        /// averages of the children: equilibrium from mean density and momentum
+        rho /= count;
+        T const u = jx/(count*rho);
+        T const v = jy/(count*rho);
+        T const w = jz/(count*rho);
+        lattice::Equilibrium<LT>(rho, u, v, w, feq);
+
+        unsigned int const x_c[3] = { (NX + parent.x - 1) % NX, parent.x, (parent.x + 1) % NX };
+        unsigned int const y_c[3] = { (NY + parent.y - 1) % NY, parent.y, (parent.y + 1) % NY };
+        unsigned int const z_c[3] = { (NZ + parent.z - 1) % NZ, parent.z, (parent.z + 1) % NZ };
+
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                unsigned int const curr = n*LT::OFF + d;
+                coarse.Store(coarse. template IndexRead<odd>(x_c,y_c,z_c,n,d,p), n, d, feq[curr] + scale*fneq[curr]/count);
+            }
+        }
+    }
+}
+
+/**\fn         Sample
+ * \brief      Evaluate density, velocity and non-equilibrium part of the pre-collision populations of the
+ *             coarse cells the ghost cells are interpolated from
+ *
+ * \tparam     odd      even (0, false) or odd (1, true) coarse time step that will be performed next
+ * \tparam     LT       static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP     number of populations stored side by side in the lattice
+ * \tparam     LY       memory layout policy of the populations
+ * \tparam     ST       storage policy of the populations
+ * \tparam     SP       streaming policy of the populations
+ * \param[in]  coarse   coarse population
+ * \param[out] values   values of all samples (before_ or after_)
+ * \param[in]  p        relevant population (default = 0)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int X0, unsigned int Y0, unsigned int Z0,
+          unsigned int PX, unsigned int PY, unsigned int PZ, typename T>
+template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void RefinedPatch<NX,NY,NZ,X0,Y0,Z0,PX,PY,PZ,T>::Sample(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& coarse, std::vector<T>& values,
+                                                        unsigned int const p) const
+{
+    std::vector<unsigned int> const& samples = samples_;
+    unsigned int const stride = STRIDE_;
+
+    #pragma omp parallel for default(none) shared(coarse, values, samples) firstprivate(stride, p) schedule(static)
+    for(size_t i = 0; i < samples.size(); ++i)
+    {
+        unsigned int const x = samples[i] % BOX_X_ + X0 - 1;
+        unsigned int const y = (samples[i] / BOX_X_) % BOX_Y_ + Y0 - 1;
+        unsigned int const z = samples[i] / (BOX_X_*BOX_Y_) + Z0 - 1;
+        unsigned int const x_n[3] = { (NX + x - 1) % NX, x, (x + 1) % NX };
+        unsigned int const y_n[3] = { (NY + y - 1) % NY, y, (y + 1) % NY };
+        unsigned int const z_n[3] = { (NZ + z - 1) % NZ, z, (z + 1) % NZ };
+
+        alignas(CACHE_LINE) T f[LT::ND]   = {0.0};
+        alignas(CACHE_LINE) T feq[LT::ND] = {0.0};
+
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                f[n*LT::OFF + d] = coarse.Load(coarse. template IndexRead<odd>(x_n,y_n,z_n,n,d,p), n, d);
+            }
+        }
+
+        T* const value = &values[i*stride];
+        lattice::Velocity<LT>(f, value[0], value[1], value[2], value[3]);
+        lattice::Equilibrium<LT>(value[0], value[1], value[2], value[3], feq);
+
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                unsigned int const curr = n*LT::OFF + d;
+                value[4 + curr] = f[curr] - feq[curr];
+            }
+        }
+    }
+}
+
+/**\fn         Prolongate
+ * \brief      Reconstruct the pre-collision populations of the ghost cells of the patch from the coarse
+ *             samples interpolated in space and in time between the beginning (before_) and the end
+ *             (after_) of the coarse time step
+ * \note       The fluxes across the interface are not matched to the coarse level, the resulting mass
+ *             defect is removed by Correct (see the file description).
+ *
+ * \tparam     odd      even (0, false) or odd (1, true) fine time step that will be performed next
+ * \tparam     LT       static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP     number of populations stored side by side in the lattice
+ * \tparam     LY       memory layout policy of the populations
+ * \tparam     ST       storage policy of the populations
+ * \tparam     SP       streaming policy of the populations
+ * \param[out] fine     fine population of the patch
+ * \param[in]  alpha    fraction of the coarse time step (0 = beginning, 1 = end)
+ * \param[in]  p        relevant population (default = 0)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int X0, unsigned int Y0, unsigned int Z0,
+          unsigned int PX, unsigned int PY, unsigned int PZ, typename T>
+template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void RefinedPatch<NX,NY,NZ,X0,Y0,Z0,PX,PY,PZ,T>::Prolongate(Population<NX_FINE_,NY_FINE_,NZ_FINE_,LT,NPOP,LY,ST,SP>& fine, T const alpha,
+                                                            unsigned int const p) const
+{
+    std::vector<refinementGhost<T>> const& ghosts = ghosts_;
+    std::vector<T> const& before = before_;
+    std::vector<T> const& after  = after_;
+    unsigned int const stride = STRIDE_;
+    T const scale = COARSE_TO_FINE_;
+
+    #pragma omp parallel for default(none) shared(fine, ghosts, before, after) firstprivate(stride, scale, alpha, p) schedule(static)
+    for(size_t i = 0; i < ghosts.size(); ++i)
+    {
+        refinementGhost<T> const& ghost = ghosts[i];
+
+        alignas(CACHE_LINE) T value[4 + LT::ND] = {0.0};
+        for(unsigned int s = 0; s < 8; ++s)
+        {
+            T const w0 = (1.0 - alpha)*ghost.weight[s];
+            T const w1 = alpha*ghost.weight[s];
+            T const* const v0 = &before[ghost.sample[s]*stride];
+            T const* const v1 = &after[ghost.sample[s]*stride];
+
+            #pragma GCC unroll (16)
+            for(unsigned int k = 0; k < 4 + LT::ND; ++k)
+            {
+                value[k] += w0*v0[k] + w1*v1[k];
+            }
+        }
+
+        alignas(CACHE_LINE) T feq[LT::ND] = {0.0};
+        lattice::Equilibrium<LT>(value[0], value[1], value[2], value[3], feq);
+
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                unsigned int const curr = n*LT::OFF + d;
+                fine.Store(fine. template IndexRead<odd>(ghost.x_n,ghost.y_n,ghost.z_n,n,d,p), n, d, feq[curr] + scale*value[4 + curr]);
+            }
+        }
+    }
+}
+
+/**\fn         CoveredMass
+ * \brief      Mass of the coarse cells covered by the patch
+ *
+ * \tparam     odd      even (0, false) or odd (1, true) coarse time step that will be performed next
+ * \tparam     LT       static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP     number of populations stored side by side in the lattice
+ * \tparam     LY       memory layout policy of the populations
+ * \tparam     ST       storage policy of the populations
+ * \tparam     SP       streaming policy of the populations
+ * \param[in]  coarse   coarse population
+ * \param[in]  p        relevant population (default = 0)
+ * \return     sum of the densities of the covered coarse cells
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int X0, unsigned int Y0, unsigned int Z0,
+          unsigned int PX, unsigned int PY, unsigned int PZ, typename T>
+template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+T RefinedPatch<NX,NY,NZ,X0,Y0,Z0,PX,PY,PZ,T>::CoveredMass(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP> const& coarse, unsigned int const p) const
+{
+    std::vector<refinementParent> const& parents = parents_;
+    T mass = 0.0;
+
+    #pragma omp parallel for default(none) shared(coarse, parents) firstprivate(p) reduction(+:mass) schedule(static)
+    for(size_t i = 0; i < parents.size(); ++i)
+    {
+        mass += RefinementDensity<odd>(coarse, parents[i].x, parents[i].y, parents[i].z, p);
+    }
+    return mass;
+}
+
+/**\fn         GhostMass
+ * \brief      Mass of the ghost cells of the patch
+ *
+ * \tparam     odd      even (0, false) or odd (1, true) fine time step that will be performed next
+ * \tparam     LT       static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP     number of populations stored side by side in the lattice
+ * \tparam     LY       memory layout policy of the populations
+ * \tparam     ST       storage policy of the populations
+ * \tparam     SP       streaming policy of the populations
+ * \param[in]  fine     fine population of the patch
+ * \param[in]  p        relevant population (default = 0)
+ * \return     sum of the densities of the ghost cells
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int X0, unsigned int Y0, unsigned int Z0,
+          unsigned int PX, unsigned int PY, unsigned int PZ, typename T>
+template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+T RefinedPatch<NX,NY,NZ,X0,Y0,Z0,PX,PY,PZ,T>::GhostMass(Population<NX_FINE_,NY_FINE_,NZ_FINE_,LT,NPOP,LY,ST,SP> const& fine,
+                                                        unsigned int const p) const
+{
+    std::vector<refinementGhost<T>> const& ghosts = ghosts_;
+    T mass = 0.0;
+
+    #pragma omp parallel for default(none) shared(fine, ghosts) firstprivate(p) reduction(+:mass) schedule(static)
+    for(size_t i = 0; i < ghosts.size(); ++i)
+    {
+        mass += RefinementDensity<odd>(fine, ghosts[i].x_n[1], ghosts[i].y_n[1], ghosts[i].z_n[1], p);
+    }
+    return mass;
+}
+
+/**\fn         Correct
+ * \brief      Remove the mass defect of the interface from the fine fluid cells next to the ghost layer
+ *             by adding (or subtracting) an equal share of fluid at rest, leaving their momentum unchanged
+ *
+ * \tparam     odd      even (0, false) or odd (1, true) fine time step that will be performed next
+ * \tparam     LT       static lattice::DdQq class containing discretisation parameters
+ * \tparam     NPOP     number of populations stored side by side in the lattice
+ * \tparam     LY       memory layout policy of the populations
+ * \tparam     ST       storage policy of the populations
+ * \tparam     SP       streaming policy of the populations
+ * \param[out] fine     fine population of the patch
+ * \param[in]  defect   mass gained by the composite of both levels through the interface (in coarse cells)
+ * \param[in]  p        relevant population (default = 0)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int X0, unsigned int Y0, unsigned int Z0,
+          unsigned int PX, unsigned int PY, unsigned int PZ, typename T>
+template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP>
+void RefinedPatch<NX,NY,NZ,X0,Y0,Z0,PX,PY,PZ,T>::Correct(Population<NX_FINE_,NY_FINE_,NZ_FINE_,LT,NPOP,LY,ST,SP>& fine, T const defect,
+                                                         unsigned int const p) const
+{
+    std::vector<refinementCell> const& cells = interface_;
+    if (cells.empty() == true)
+    {
+        return;
+    }
+    T const drho = -defect*(RATIO_*RATIO_*RATIO_)/cells.size();
+
+    #pragma omp parallel for default(none) shared(fine, cells) firstprivate(drho, p) schedule(static)
+    for(size_t i = 0; i < cells.size(); ++i)
+    {
+        unsigned int const x_n[3] = { cells[i].x - 1, cells[i].x, cells[i].x + 1 };
+        unsigned int const y_n[3] = { cells[i].y - 1, cells[i].y, cells[i].y + 1 };
+        unsigned int const z_n[3] = { cells[i].z - 1, cells[i].z, cells[i].z + 1 };
+
+        #pragma GCC unroll (2)
+        for(unsigned int n = 0; n <= 1; ++n)
+        {
+            #pragma GCC unroll (16)
+            for(unsigned int d = n; d < LT::HSPEED; ++d)
+            {
+                size_t const index = fine. template IndexRead<odd>(x_n,y_n,z_n,n,d,p);
+                fine.Store(index, n, d, fine.Load(index, n, d) + drho*LT::W[n*LT::OFF + d]);
+            }
+        }
+    }
+}
+
+/**\fn            Advance
+ * \brief         Perform a single coarse time step and the two corresponding fine time steps of the
+ *                patch (local time stepping). The time steps of the levels are given as callables so
+ *                that every level can use its own collision operator, fluid cell list and boundaries;
+ *                nesting a further patch inside the fine time step results in additional levels.
+ *
+ * \tparam        odd          even (0, false) or odd (1, true) coarse time step
+ * \tparam        LT           static lattice::DdQq class containing discretisation parameters
+ * \tparam        NPOP         number of populations stored side by side in the lattice
+ * \tparam        LY           memory layout policy of the populations
+ * \tparam        ST           storage policy of the populations
+ * \tparam        SP           streaming policy of the populations
+ * \tparam        COARSE       callable with (std::integral_constant<bool,odd>) performing the coarse time step
+ * \tparam        FINE         callable with (std::integral_constant<bool,odd>) performing a fine time step
+ * \param[in,out] coarse       coarse population
+ * \param[in,out] fine         fine population of the patch
+ * \param[in]     coarseStep   the coarse time step (boundaries and collision)
+ * \param[in]     fineStep     a fine time step (boundaries and collision) called for the even and the odd step
+ * \param[in]     p            relevant population (default = 0)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int X0, unsigned int Y0, unsigned int Z0,
+          unsigned int PX, unsigned int PY, unsigned int PZ, typename T>
+template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP, class COARSE, class FINE>
+void RefinedPatch<NX,NY,NZ,X0,Y0,Z0,PX,PY,PZ,T>::Advance(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& coarse,
+                                                         Population<NX_FINE_,NY_FINE_,NZ_FINE_,LT,NPOP,LY,ST,SP>& fine,
+                                                         COARSE const& coarseStep, FINE const& fineStep, unsigned int const p)
+{
+    Restrict<odd>(coarse, fine, p);
+    Sample<odd>(coarse, before_, p);
+
+    /// the mass the covered cells and the ghost cells lose is gained by the rest of the levels
+    T covered = CoveredMass<odd>(coarse, p);
+    coarseStep(std::integral_constant<bool,odd>());
+    covered -= CoveredMass<!odd>(coarse, p);
+    Sample<!odd>(coarse, after_, p);
+
+    Prolongate<false>(fine, 0.0, p);
+    T ghost = GhostMass<false>(fine, p);
+    fineStep(std::integral_constant<bool,false>());
+    ghost -= GhostMass<true>(fine, p);
+    Prolongate<true>(fine, 1.0/RATIO_, p);
+    ghost += GhostMass<true>(fine, p);
+    fineStep(std::integral_constant<bool,true>());
+    ghost -= GhostMass<false>(fine, p);
+
+    Correct<false>(fine, covered + ghost/(RATIO_*RATIO_*RATIO_), p);
+}
+
+#endif // REFINEMENT_HPP_INCLUDED
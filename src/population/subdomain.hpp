@@ -0,0 +1,175 @@
+#ifndef SUBDOMAIN_HPP_INCLUDED
+#define SUBDOMAIN_HPP_INCLUDED
+
+/**
+ * \file     subdomain.hpp
+ * \mainpage Class for the decomposition of the simulation domain into slabs for distributed memory
+ *
+ * \note     The global domain is split in z-direction into slabs of equal size, one per MPI process.
+ *           Every slab is stored with an additional ghost layer below (z = 0) and above (z = NZ_SUB + 1)
+ *           so that the A-A access pattern of the inner cells can be used without modification and
+ *           the periodicity in z-direction never has to be resolved locally.
+ * \warning  Only available if compiled with MPI support ('make MPI=true' defines USE_MPI)
+*/
+
+#ifdef USE_MPI
+
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+#include <mpi.h>
+
+#include "../continuum/continuum.hpp"
+#include "../general/distribution.hpp"
+#include "boundary/boundary.hpp"
+
+
+/**\class  Subdomain
+ * \brief  Class holding the slab decomposition of the global domain in z-direction
+ *
+ * \tparam NX      simulation domain resolution in x-direction
+ * \tparam NY      simulation domain resolution in y-direction
+ * \tparam NZ      global simulation domain resolution in z-direction
+ * \tparam NZ_SUB  number of planes in z-direction of every process (without ghost layers)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int NZ_SUB>
+class Subdomain
+{
+    public:
+        static_assert(NZ % NZ_SUB == 0, "Global resolution in z-direction has to be a multiple of the subdomain resolution.");
+        static_assert(NZ_SUB >= 2, "Subdomains require at least two planes in z-direction.");
+
+        /// local resolution in z-direction including the two ghost layers
+        static constexpr unsigned int NZ_LOCAL_ = NZ_SUB + 2;
+        static constexpr unsigned int    GHOST_ = 1;
+
+        /// communicator and neighbouring processes (periodic in z-direction)
+        MPI_Comm const comm_;
+        int            rank_  = 0;
+        int            size_  = 1;
+        int            lower_ = 0;
+        int            upper_ = 0;
+
+        /// global z coordinate of the first inner plane
+        unsigned int   offset_ = 0;
+
+
+        /**\brief Class constructor
+         * \param comm   communicator of all processes sharing the domain (default = MPI_COMM_WORLD)
+        */
+        Subdomain(MPI_Comm const comm = MPI_COMM_WORLD):
+            comm_(comm)
+        {
+            MPI_Comm_rank(comm_, &rank_);
+            MPI_Comm_size(comm_, &size_);
+
+            if (static_cast<unsigned int>(size_) != NZ/NZ_SUB)
+            {
+                std::cerr << "Fatal error: Domain decomposition requires " << NZ/NZ_SUB << " processes but "
+                          << size_ << " were started." << std::endl;
+                MPI_Abort(comm_, EXIT_FAILURE);
+            }
+
+            lower_  = (size_ + rank_ - 1) % size_;
+            upper_  = (rank_ + 1) % size_;
+            offset_ = static_cast<unsigned int>(rank_)*NZ_SUB;
+        }
+
+        /// decompose global boundaries and gather macroscopic values
+        template <typename T>
+        std::vector<boundaryElement<T>> Distribute(std::vector<boundaryElement<T>> const& boundary, bool const ghosts) const;
+        template <typename T>
+        std::vector<boundaryElement<T>> HaloAdjacent(std::vector<boundaryElement<T>> const& local) const;
+        template <typename T>
+        void Gather(Continuum<NX,NY,NZ_LOCAL_,T> const& local, Continuum<NX,NY,NZ,T>* const global, int const root = 0) const;
+};
+
+
+/**\fn        Distribute
+ * \brief     Extract those boundary elements of the global domain that belong to the subdomain of the
+ *            current process and translate them to local coordinates. Solid walls are also
+ *            required in the ghost layers as their bounce-back affects the inner cells.
+ *
+ * \tparam    T          floating data type used for simulation
+ * \param[in] boundary   vector holding all boundary elements of the global domain
+ * \param[in] ghosts     include elements located in the ghost layers (Boolean true/false)
+ * \return    vector holding all boundary elements of the subdomain in local coordinates
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int NZ_SUB> template <typename T>
+std::vector<boundaryElement<T>> Subdomain<NX,NY,NZ,NZ_SUB>::Distribute(std::vector<boundaryElement<T>> const& boundary, bool const ghosts) const
+{
+    std::vector<boundaryElement<T>> local;
+
+    unsigned int const z_lower = (NZ + offset_ - 1) % NZ;
+    unsigned int const z_upper = (offset_ + NZ_SUB) % NZ;
+
+    for(size_t i = 0; i < boundary.size(); ++i)
+    {
+        boundaryElement<T> const& b = boundary[i];
+
+        /// a single process owns the whole domain and its ghost layers at the same time
+        if ((b.z >= offset_) && (b.z < offset_ + NZ_SUB))
+        {
+            local.push_back({b.x, b.y, b.z - offset_ + GHOST_, b.rho, b.u, b.v, b.w});
+        }
+        if ((ghosts == true) && (b.z == z_lower))
+        {
+            local.push_back({b.x, b.y, 0, b.rho, b.u, b.v, b.w});
+        }
+        if ((ghosts == true) && (b.z == z_upper))
+        {
+            local.push_back({b.x, b.y, NZ_SUB + GHOST_, b.rho, b.u, b.v, b.w});
+        }
+    }
+
+    return local;
+}
+
+/**\fn        HaloAdjacent
+ * \brief     Extract those local boundary elements that are located in the ghost layers or the planes
+ *            next to them. The halo exchange overwrites populations that their bounce-back fused with
+ *            the collision has already written, which is why it has to be repeated after the exchange.
+ *
+ * \tparam    T        floating data type used for simulation
+ * \param[in] local    vector holding all boundary elements of the subdomain in local coordinates
+ * \return    vector holding all boundary elements in the planes 0, 1, NZ_SUB and NZ_SUB + 1
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int NZ_SUB> template <typename T>
+std::vector<boundaryElement<T>> Subdomain<NX,NY,NZ,NZ_SUB>::HaloAdjacent(std::vector<boundaryElement<T>> const& local) const
+{
+    std::vector<boundaryElement<T>> halo;
+
+    for(size_t i = 0; i < local.size(); ++i)
+    {
+        if ((local[i].z <= GHOST_) || (local[i].z >= NZ_SUB))
+        {
+            halo.push_back(local[i]);
+        }
+    }
+
+    return halo;
+}
+
+/**\fn         Gather
+ * \brief      Collect the inner planes of the macroscopic values of all processes in a global
+ *             continuum on the root process (e.g. for export)
+ *
+ * \tparam     T        floating data type used for simulation
+ * \param[in]  local    continuum of the current process including ghost layers
+ * \param[out] global   continuum of the global domain (only relevant on root, may be nullptr otherwise)
+ * \param[in]  root     rank of the process that should receive the global continuum (default = 0)
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ, unsigned int NZ_SUB> template <typename T>
+void Subdomain<NX,NY,NZ,NZ_SUB>::Gather(Continuum<NX,NY,NZ_LOCAL_,T> const& local, Continuum<NX,NY,NZ,T>* const global, int const root) const
+{
+    /// inner planes are contiguous as z is the slowest index of the continuum
+    int const count = static_cast<int>(static_cast<size_t>(NX)*NY*NZ_SUB*local.NM_);
+    T const* const send = &local.M_[local.SpatialToLinear(0, 0, GHOST_, 0)];
+    T* const       recv = (rank_ == root) ? global->M_ : nullptr;
+
+    MPI_Gather(send, count, MpiDatatype<T>(), recv, count, MpiDatatype<T>(), root, comm_);
+}
+
+#endif // USE_MPI
+
+#endif // SUBDOMAIN_HPP_INCLUDED
@@ -0,0 +1,374 @@
+#ifndef WAVEFRONT_HPP_INCLUDED
+#define WAVEFRONT_HPP_INCLUDED
+
+/**
+ * \file     wavefront.hpp
+ * \mainpage Temporally blocked execution of several consecutive time steps (wavefront)
+ *
+ * \note     A regular time step sweeps over the entire domain so that every population is loaded from
+ *           and stored to main memory once per time step. The wavefront instead advances a number of
+ *           consecutive time steps (levels) plane by plane in z-direction: level k collides plane z
+ *           while level k-1 collides plane z+2, as the collision of a cell with the A-A pattern only
+ *           depends on the previous time step in the neighbouring planes. All levels of a sweep are
+ *           independent and are collided in parallel. Only the planes of the front (about two planes
+ *           per level) have to be kept in the last level cache. This holds for the esoteric pull as
+ *           well: neighbouring levels only share the plane between them and access it in different slots.
+ *           The periodic neighbours of the first and last planes are resolved by a trapezoidal wavefront
+ *           followed by the remaining planes around the periodic seam level by level.
+ *           Boundaries are handled inside the front: the bounce-back of the walls is fused with the
+ *           collision of the fluid cells and Guo boundaries are applied per plane (see FusedGuo),
+ *           which restricts the latter to boundaries in x- and y-direction.
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include "../general/cpu_dispatch.hpp"
+#include "../general/instrumentation.hpp"
+#include "../general/memory_alignment.hpp"
+#include "boundary/boundary_bounceback.hpp"
+#include "fluid_cells.hpp"
+#include "population.hpp"
+
+
+/**\class  Wavefront
+ * \brief  Class holding the fluid cells sorted by planes in z-direction for the temporally blocked
+ *         execution of an even number of consecutive time steps.
+ *
+ * \tparam NX   simulation domain resolution in x-direction
+ * \tparam NY   simulation domain resolution in y-direction
+ * \tparam NZ   simulation domain resolution in z-direction
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+class Wavefront
+{
+    public:
+        /// number of consecutive time steps advanced at once (even so that every tile starts with an even step)
+        unsigned int const STEPS_;
+
+        /// the planes in z-direction act as blocks for the fused boundaries
+        static constexpr unsigned int NUM_BLOCKS_ = NZ;
+        static constexpr unsigned int      Z_MIN_ = 0;
+        static constexpr unsigned int      Z_MAX_ = NZ;
+
+        /// fluid cells sorted by plane and the index of the first fluid cell of every plane
+        std::vector<fluidCell, DefaultInitAllocator<fluidCell>> cells_;
+        std::vector<size_t>    planes_;
+
+        /// solid cells of the full domain
+        std::vector<bool>      isSolid_;
+
+
+        /**\brief Class constructor
+         * \param fluid   fluid cell list of the full domain
+         * \param steps   number of consecutive time steps per tile (default = 2: a pair of even and odd step)
+        */
+        Wavefront(FluidCells<NX,NY,NZ> const& fluid, unsigned int const steps = 2);
+
+        /// advance STEPS_ time steps starting with an even step
+        template <class LT, unsigned int NPOP, class LY, class ST, class SP, class NODE, class... BC>
+        void Advance(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, NODE const& node, unsigned int const p, BC const&... boundaries) const;
+
+        /// access functions
+        inline size_t PlaneBegin(unsigned int const z) const;
+        inline size_t PlaneEnd(unsigned int const z) const;
+        inline size_t GetNumberOfCells() const;
+        inline size_t GetMemorySize() const;
+        inline unsigned int GetBlock(unsigned int const x, unsigned int const y, unsigned int const z) const;
+        inline bool         IsFluid(unsigned int const x, unsigned int const y, unsigned int const z) const;
+
+    private:
+        template <bool odd, bool isLast, class LT, unsigned int NPOP, class LY, class ST, class SP, class NODE>
+        inline void CollidePlane(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, NODE const& node, unsigned int const z,
+                                 unsigned int const p) const;
+        template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP, class NODE>
+        inline void CollidePlane(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, NODE const& node, unsigned int const z,
+                                 bool const isLast, unsigned int const p) const;
+};
+
+
+/**\fn        Wavefront
+ * \brief     Sort the fluid cells of a fluid cell list of the full domain by planes in z-direction.
+ *            Within a plane the order of the loop blocks is kept.
+ *
+ * \param[in] fluid   fluid cell list of the full domain
+ * \param[in] steps   number of consecutive time steps per tile
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+Wavefront<NX,NY,NZ>::Wavefront(FluidCells<NX,NY,NZ> const& fluid, unsigned int const steps):
+    STEPS_(steps), cells_(), planes_(NZ + 1, 0), isSolid_(fluid.isSolid_)
+{
+    if ((STEPS_ == 0) || (STEPS_ % 2 != 0) || (2*STEPS_ > NZ))
+    {
+        std::cerr << "Fatal error: Wavefront requires an even number of time steps of at most NZ/2 (" << STEPS_ << ")." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if ((fluid.Z_MIN_ != 0) || (fluid.Z_MAX_ != NZ))
+    {
+        std::cerr << "Fatal error: Wavefront requires a fluid cell list of the full domain." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    for(size_t i = 0; i < fluid.cells_.size(); ++i)
+    {
+        ++planes_[fluid.cells_[i].z_n[1] + 1];
+    }
+    for(unsigned int z = 0; z < NZ; ++z)
+    {
+        planes_[z + 1] += planes_[z];
+    }
+
+    cells_.resize(fluid.cells_.size());
+    std::vector<size_t> position(planes_.begin(), planes_.end() - 1);
+    for(size_t i = 0; i < fluid.cells_.size(); ++i)
+    {
+        cells_[position[fluid.cells_[i].z_n[1]]++] = fluid.cells_[i];
+    }
+}
+
+/**\fn        CollidePlane
+ * \brief     Collide all fluid cells of a single plane with the threads of the enclosing parallel region
+ *            and apply the fused bounce-back
+ *
+ * \tparam    odd      even (0, false) or odd (1, true) time step
+ * \tparam    isLast   last time step of the tile (Boolean true/false)
+ * \tparam    LT       static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP     number of populations stored side by side in the lattice
+ * \tparam    LY       memory layout policy of the populations
+ * \tparam    ST       storage policy of the populations
+ * \tparam    SP       streaming policy of the populations
+ * \tparam    NODE     collision operator for a single cell (see Advance)
+ * \param[out] pop     population object holding microscopic variables
+ * \param[in] node     collision operator for a single cell
+ * \param[in] z        the plane of interest
+ * \param[in] p        relevant population
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ> template <bool odd, bool isLast, class LT, unsigned int NPOP, class LY, class ST, class SP, class NODE>
+inline void Wavefront<NX,NY,NZ>::CollidePlane(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, NODE const& node, unsigned int const z,
+                                              unsigned int const p) const
+{
+    PROFILE_WORK();
+
+    DispatchIsa([&](auto const)
+    {
+        #pragma omp for schedule(static) nowait
+        for(size_t i = planes_[z]; i < planes_[z + 1]; ++i)
+        {
+            fluidCell const& cell = cells_[i];
+            node(std::integral_constant<bool,odd>(), cell, std::integral_constant<bool,isLast>());
+            BounceBackLinks<odd>(cell, pop, p);
+        }
+    });
+}
+
+/**\fn        CollidePlane
+ * \brief     Dispatch the collision of a plane to the variant for the last or an intermediate time step
+ *            of the tile so that the macroscopic values are only evaluated where they are needed
+ *
+ * \tparam    odd      even (0, false) or odd (1, true) time step
+ * \param[out] pop     population object holding microscopic variables
+ * \param[in] node     collision operator for a single cell
+ * \param[in] z        the plane of interest
+ * \param[in] isLast   last time step of the tile (Boolean true/false)
+ * \param[in] p        relevant population
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ> template <bool odd, class LT, unsigned int NPOP, class LY, class ST, class SP, class NODE>
+inline void Wavefront<NX,NY,NZ>::CollidePlane(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, NODE const& node, unsigned int const z,
+                                              bool const isLast, unsigned int const p) const
+{
+    if (isLast == true)
+    {
+        CollidePlane<odd,true>(pop, node, z, p);
+    }
+    else
+    {
+        CollidePlane<odd,false>(pop, node, z, p);
+    }
+}
+
+/**\fn        Advance
+ * \brief     Advance STEPS_ consecutive time steps starting with an even time step.
+ *            Level k (time step k of the tile) collides plane s - 2k in sweep s of the trapezoidal
+ *            wavefront, which covers the planes [k, NZ-1-k] of every level. The remaining planes
+ *            around the periodic seam are collided afterwards level by level. The fused boundaries
+ *            of a plane are applied before its collision.
+ * \warning   All boundaries must be fused with the wavefront (boundaries in z-direction are not supported).
+ *
+ * \tparam    LT           static lattice::DdQq class containing discretisation parameters
+ * \tparam    NPOP         number of populations stored side by side in the lattice
+ * \tparam    LY           memory layout policy of the populations
+ * \tparam    ST           storage policy of the populations
+ * \tparam    SP           streaming policy of the populations
+ * \tparam    NODE         collision operator for a single cell: callable with (std::integral_constant<bool,odd>,
+ *                         fluidCell const&, std::integral_constant<bool,isLast>) that collides the cell
+ * \tparam    BC           types of the fused boundaries (e.g. FusedGuo)
+ * \param[out] pop         population object holding microscopic variables
+ * \param[in] node         collision operator for a single cell
+ * \param[in] p            relevant population
+ * \param[in] boundaries   boundaries fused with the wavefront
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ> template <class LT, unsigned int NPOP, class LY, class ST, class SP, class NODE, class... BC>
+void Wavefront<NX,NY,NZ>::Advance(Population<NX,NY,NZ,LT,NPOP,LY,ST,SP>& pop, NODE const& node, unsigned int const p,
+                                  BC const&... boundaries) const
+{
+    if ((boundaries.unfused_.empty() && ... && true) == false)
+    {
+        std::cerr << "Fatal error: Boundary elements that can not be applied within a plane of the wavefront." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::tuple<BC const&...> const fused(boundaries...);
+    unsigned int const STEPS = STEPS_;
+
+    #pragma omp parallel default(none) shared(pop, node, fused) firstprivate(p, STEPS)
+    {
+        /// trapezoidal wavefront: level k is active in the sweeps [3k, NZ-1+k]
+        for(unsigned int s = 0; s + 1 < NZ + STEPS; ++s)
+        {
+            unsigned int const k_begin = (s + 1 > NZ) ? s + 1 - NZ : 0;
+            unsigned int const k_end   = std::min(s/3 + 1, STEPS);
+
+            #pragma omp single
+            for(unsigned int k = k_begin; k < k_end; ++k)
+            {
+                if (k % 2 == 0)
+                {
+                    ApplyBlockBoundaries<false>(fused, pop, s - 2*k, p);
+                }
+                else
+                {
+                    ApplyBlockBoundaries<true>(fused, pop, s - 2*k, p);
+                }
+            }
+
+            for(unsigned int k = k_begin; k < k_end; ++k)
+            {
+                if (k % 2 == 0)
+                {
+                    CollidePlane<false>(pop, node, s - 2*k, k + 1 == STEPS, p);
+                }
+                else
+                {
+                    CollidePlane<true>(pop, node, s - 2*k, k + 1 == STEPS, p);
+                }
+            }
+            #pragma omp barrier
+        }
+
+        /// periodic seam: planes [NZ-k, NZ-1] and [0, k-1] of every level
+        for(unsigned int k = 1; k < STEPS; ++k)
+        {
+            for(unsigned int j = 0; j < 2*k; ++j)
+            {
+                unsigned int const z = (NZ - k + j) % NZ;
+
+                #pragma omp single
+                {
+                    if (k % 2 == 0)
+                    {
+                        ApplyBlockBoundaries<false>(fused, pop, z, p);
+                    }
+                    else
+                    {
+                        ApplyBlockBoundaries<true>(fused, pop, z, p);
+                    }
+                }
+
+                if (k % 2 == 0)
+                {
+                    CollidePlane<false>(pop, node, z, k + 1 == STEPS, p);
+                }
+                else
+                {
+                    CollidePlane<true>(pop, node, z, k + 1 == STEPS, p);
+                }
+                #pragma omp barrier
+            }
+        }
+    }
+}
+
+/**\fn     PlaneBegin
+ * \brief  Index of the first fluid cell of a given plane
+ *
+ * \param[in] z   the plane of interest
+ * \return    index of the first fluid cell inside the plane
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t Wavefront<NX,NY,NZ>::PlaneBegin(unsigned int const z) const
+{
+    return planes_[z];
+}
+
+/**\fn     PlaneEnd
+ * \brief  Index after the last fluid cell of a given plane
+ *
+ * \param[in] z   the plane of interest
+ * \return    index after the last fluid cell inside the plane
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t Wavefront<NX,NY,NZ>::PlaneEnd(unsigned int const z) const
+{
+    return planes_[z + 1];
+}
+
+/**\fn     GetNumberOfCells
+ * \brief  Total number of fluid cells
+ *
+ * \return number of fluid cells
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t Wavefront<NX,NY,NZ>::GetNumberOfCells() const
+{
+    return cells_.size();
+}
+
+/**\fn     GetMemorySize
+ * \brief  Memory occupied by the fluid cell list and the plane indices
+ *
+ * \return memory in bytes
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline size_t Wavefront<NX,NY,NZ>::GetMemorySize() const
+{
+    return cells_.size()*sizeof(fluidCell) + planes_.size()*sizeof(size_t) + isSolid_.size()/8;
+}
+
+/**\fn     GetBlock
+ * \brief  Block (plane) a given cell belongs to
+ *
+ * \param[in] x   x coordinate of the cell
+ * \param[in] y   y coordinate of the cell
+ * \param[in] z   z coordinate of the cell
+ * \return    index of the corresponding plane
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline unsigned int Wavefront<NX,NY,NZ>::GetBlock(unsigned int const x, unsigned int const y, unsigned int const z) const
+{
+    (void)x; (void)y;
+    return z;
+}
+
+/**\fn     IsFluid
+ * \brief  Check if a given cell is a fluid cell
+ *
+ * \param[in] x   x coordinate of the cell
+ * \param[in] y   y coordinate of the cell
+ * \param[in] z   z coordinate of the cell
+ * \return    Boolean true if the cell is a fluid cell, false otherwise
+*/
+template <unsigned int NX, unsigned int NY, unsigned int NZ>
+inline bool Wavefront<NX,NY,NZ>::IsFluid(unsigned int const x, unsigned int const y, unsigned int const z) const
+{
+    return (isSolid_[(static_cast<size_t>(z)*NY + y)*NX + x] == false);
+}
+
+#endif // WAVEFRONT_HPP_INCLUDED